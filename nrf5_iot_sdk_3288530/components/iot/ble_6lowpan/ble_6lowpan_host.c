@@ -0,0 +1,597 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include "ble_6lowpan_host.h"
+#include "mem_manager.h"
+#include "nordic_common.h"
+#include "sdk_common.h"
+
+#define SRC_ADDR_OFFSET               8                                                              /**< Offset of the source address in the IPv6 header. */
+#define DEST_ADDR_OFFSET              24                                                             /**< Offset of the destination address in the IPv6 header. */
+
+#define PCAP_MAGIC                    0xA1B2C3D4                                                     /**< Magic number of captures with microsecond time stamps. */
+#define PCAP_MAGIC_NSEC               0xA1B23C4D                                                     /**< Magic number of captures with nanosecond time stamps. */
+#define PCAP_VERSION_MAJOR            2                                                              /**< Major version of the capture format. */
+#define PCAP_VERSION_MINOR            4                                                              /**< Minor version of the capture format. */
+#define PCAP_LINKTYPE_RAW             101                                                            /**< Raw IPv4 or IPv6 packets. */
+#define PCAP_LINKTYPE_IPV6            229                                                            /**< Raw IPv6 packets. */
+
+/**@brief Global header of a pcap file. */
+typedef struct
+{
+    uint32_t magic;                                                                                  /**< Magic number, also giving the byte order and time stamp resolution. */
+    uint16_t version_major;                                                                          /**< Major version of the format. */
+    uint16_t version_minor;                                                                          /**< Minor version of the format. */
+    int32_t  thiszone;                                                                               /**< Time zone correction, always 0. */
+    uint32_t sigfigs;                                                                                /**< Accuracy of time stamps, always 0. */
+    uint32_t snaplen;                                                                                /**< Maximum length of captured packets. */
+    uint32_t linktype;                                                                               /**< Link layer type. */
+} pcap_file_header_t;
+
+/**@brief Record header of a pcap file. */
+typedef struct
+{
+    uint32_t ts_sec;                                                                                 /**< Time stamp, seconds. */
+    uint32_t ts_frac;                                                                                /**< Time stamp, microseconds or nanoseconds. */
+    uint32_t incl_len;                                                                               /**< Number of bytes of the packet in the file. */
+    uint32_t orig_len;                                                                               /**< Length of the packet on the link. */
+} pcap_record_header_t;
+
+/**@brief Simulated peer on the loopback bus. */
+typedef struct
+{
+    eui64_t                         addr;                                                            /**< EUI-64 of the peer. */
+    ble_6lowpan_host_peer_handler_t handler;                                                         /**< Handler of packets routed to the peer. */
+} peer_t;
+
+/**@brief Packet queued towards the stack. */
+typedef struct
+{
+    uint8_t  * p_packet;                                                                             /**< Packet, allocated with nrf_malloc and owned by the stack once delivered. */
+    uint16_t   packet_len;                                                                           /**< Length of the packet. */
+} rx_entry_t;
+
+static ble_6lowpan_evt_handler_t m_evt_handler;                                                      /**< Handler of 6LoWPAN events, registered by the stack. */
+static iot_interface_t           m_interface;                                                        /**< The single 6LoWPAN interface. */
+static bool                      m_interface_up;                                                     /**< Indicates if the interface is up. */
+static peer_t                    m_peers[BLE_6LOWPAN_HOST_MAX_PEERS];                                /**< Simulated peers. The first one is the router. */
+static uint32_t                  m_peer_count;                                                       /**< Number of simulated peers. */
+static rx_entry_t                m_rx_queue[BLE_6LOWPAN_HOST_RX_QUEUE_SIZE];                         /**< Packets queued towards the stack. */
+static uint32_t                  m_rx_read;                                                          /**< Index of the oldest queued packet. */
+static uint32_t                  m_rx_count;                                                         /**< Number of queued packets. */
+static int                       m_tun_fd = -1;                                                      /**< File descriptor of the TUN device, -1 if not open. */
+static FILE                    * m_p_pcap;                                                           /**< Capture file, NULL if not capturing. */
+static ble_6lowpan_host_clock_t  m_pcap_clock;                                                       /**< Source of the time stamps of captured packets. */
+static ble_6lowpan_host_stats_t  m_stats;                                                            /**< Traffic counters. */
+
+
+static void pcap_write(const uint8_t * p_packet, uint16_t packet_len)
+{
+    if (m_p_pcap == NULL)
+    {
+        return;
+    }
+
+    const uint64_t       now    = (m_pcap_clock != NULL) ? m_pcap_clock() : 0;
+    pcap_record_header_t header =
+    {
+        .ts_sec   = (uint32_t)(now / 1000000),
+        .ts_frac  = (uint32_t)(now % 1000000),
+        .incl_len = packet_len,
+        .orig_len = packet_len
+    };
+
+    UNUSED_VARIABLE(fwrite(&header, sizeof(header), 1, m_p_pcap));
+    UNUSED_VARIABLE(fwrite(p_packet, packet_len, 1, m_p_pcap));
+}
+
+
+static void tun_write(const uint8_t * p_packet, uint16_t packet_len)
+{
+    if (write(m_tun_fd, p_packet, packet_len) != packet_len)
+    {
+        m_stats.tx_unroutable++;
+    }
+}
+
+
+/**@brief Function for finding the peer owning a link-local interface identifier. */
+static peer_t * peer_find_by_iid(const uint8_t * p_iid)
+{
+    for (uint32_t index = 0; index < m_peer_count; index++)
+    {
+        const uint8_t * p_eui64 = m_peers[index].addr.identifier;
+
+        if (((p_eui64[0] ^ IPV6_IID_FLIP_VALUE) == p_iid[0]) &&
+            (memcmp(&p_eui64[1], &p_iid[1], EUI_64_ADDR_SIZE - 1) == 0))
+        {
+            return &m_peers[index];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Function for delivering a packet sent by the stack to the peers it is routed to. */
+static void packet_route(const uint8_t * p_packet, uint16_t packet_len)
+{
+    ipv6_addr_t dest;
+    memcpy(dest.u8, &p_packet[DEST_ADDR_OFFSET], IPV6_ADDR_SIZE);
+
+    if (IPV6_ADDRESS_IS_MULTICAST(&dest))
+    {
+        for (uint32_t index = 0; index < m_peer_count; index++)
+        {
+            m_peers[index].handler(&m_peers[index].addr, p_packet, packet_len);
+        }
+        if (m_tun_fd >= 0)
+        {
+            tun_write(p_packet, packet_len);
+        }
+        return;
+    }
+
+    peer_t * p_peer = NULL;
+
+    if (IPV6_ADDRESS_IS_LINK_LOCAL(&dest))
+    {
+        p_peer = peer_find_by_iid(&dest.u8[8]);
+    }
+    else if ((m_tun_fd < 0) && (m_peer_count > 0))
+    {
+        p_peer = &m_peers[0];
+    }
+
+    if (p_peer != NULL)
+    {
+        p_peer->handler(&p_peer->addr, p_packet, packet_len);
+    }
+    else if (m_tun_fd >= 0)
+    {
+        tun_write(p_packet, packet_len);
+    }
+    else
+    {
+        m_stats.tx_unroutable++;
+    }
+}
+
+
+/**@brief Function for handing a packet to the stack, which takes ownership of the memory. */
+static void packet_deliver(uint8_t * p_packet, uint16_t packet_len)
+{
+    ble_6lowpan_event_t event;
+
+    memset(&event, 0, sizeof(event));
+    event.event_id                                             = BLE_6LO_EVT_INTERFACE_DATA_RX;
+    event.event_result                                         = NRF_SUCCESS;
+    event.event_param.rx_event_param.p_packet                  = p_packet;
+    event.event_param.rx_event_param.packet_len                = packet_len;
+    event.event_param.rx_event_param.rx_contexts.src_cntxt_id  = IPV6_CONTEXT_IDENTIFIER_NONE;
+    event.event_param.rx_event_param.rx_contexts.dest_cntxt_id = IPV6_CONTEXT_IDENTIFIER_NONE;
+
+    pcap_write(p_packet, packet_len);
+
+    m_stats.rx_packets++;
+    m_stats.rx_bytes += packet_len;
+
+    m_evt_handler(&m_interface, &event);
+}
+
+
+static void rx_queue_flush(void)
+{
+    while (m_rx_count > 0)
+    {
+        nrf_free(m_rx_queue[m_rx_read].p_packet);
+
+        m_rx_read = (m_rx_read + 1) % BLE_6LOWPAN_HOST_RX_QUEUE_SIZE;
+        m_rx_count--;
+    }
+}
+
+
+uint32_t ble_6lowpan_init(const ble_6lowpan_init_t * p_init)
+{
+    if ((p_init == NULL) || (p_init->p_eui64 == NULL) || (p_init->event_handler == NULL))
+    {
+        return (NRF_ERROR_NULL | BLE_6LOWPAN_ERR_BASE);
+    }
+
+    memset(&m_interface, 0, sizeof(m_interface));
+    memcpy(&m_interface.local_addr, p_init->p_eui64, sizeof(eui64_t));
+    m_interface.tx_contexts.src_cntxt_id  = IPV6_CONTEXT_IDENTIFIER_NONE;
+    m_interface.tx_contexts.dest_cntxt_id = IPV6_CONTEXT_IDENTIFIER_NONE;
+
+    m_evt_handler  = p_init->event_handler;
+    m_interface_up = false;
+    m_peer_count   = 0;
+    m_rx_read      = 0;
+    m_rx_count     = 0;
+
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_interface_disconnect(const iot_interface_t * p_interface)
+{
+    if (p_interface != &m_interface)
+    {
+        return (NRF_ERROR_NOT_FOUND | BLE_6LOWPAN_ERR_BASE);
+    }
+
+    return ble_6lowpan_host_link_down();
+}
+
+
+uint32_t ble_6lowpan_interface_send(const iot_interface_t * p_interface,
+                                    const uint8_t         * p_packet,
+                                    uint16_t                packet_len)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    if ((p_interface != &m_interface) || (!m_interface_up))
+    {
+        err_code = (NRF_ERROR_NOT_FOUND | BLE_6LOWPAN_ERR_BASE);
+    }
+    else if (packet_len < IPV6_IP_HEADER_SIZE)
+    {
+        err_code = (NRF_ERROR_INVALID_LENGTH | BLE_6LOWPAN_ERR_BASE);
+    }
+    else
+    {
+        m_stats.tx_packets++;
+        m_stats.tx_bytes += packet_len;
+
+        pcap_write(p_packet, packet_len);
+        packet_route(p_packet, packet_len);
+    }
+
+    // The memory is owned by the 6LoWPAN layer once handed over, unless the caller frees refused
+    // packets itself.
+    if ((err_code == NRF_SUCCESS) || BLE_6LOWPAN_HOST_FREE_REFUSED)
+    {
+        nrf_free((uint8_t *)p_packet);
+    }
+
+    return err_code;
+}
+
+
+uint32_t ble_6lowpan_host_link_up(const eui64_t * p_peer_addr)
+{
+    if ((m_evt_handler == NULL) || m_interface_up)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    ble_6lowpan_event_t event;
+
+    memcpy(&m_interface.peer_addr, p_peer_addr, sizeof(eui64_t));
+    m_interface_up = true;
+
+    memset(&event, 0, sizeof(event));
+    event.event_id = BLE_6LO_EVT_INTERFACE_ADD;
+    m_evt_handler(&m_interface, &event);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_host_link_down(void)
+{
+    if (!m_interface_up)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    ble_6lowpan_event_t event;
+
+    rx_queue_flush();
+    m_interface_up = false;
+
+    memset(&event, 0, sizeof(event));
+    event.event_id = BLE_6LO_EVT_INTERFACE_DELETE;
+    m_evt_handler(&m_interface, &event);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_host_peer_add(const eui64_t                 * p_peer_addr,
+                                   ble_6lowpan_host_peer_handler_t handler)
+{
+    if ((p_peer_addr == NULL) || (handler == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (m_peer_count == BLE_6LOWPAN_HOST_MAX_PEERS)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memcpy(&m_peers[m_peer_count].addr, p_peer_addr, sizeof(eui64_t));
+    m_peers[m_peer_count].handler = handler;
+    m_peer_count++;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_host_peer_send(const uint8_t * p_packet, uint16_t packet_len)
+{
+    if (!m_interface_up)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((packet_len < IPV6_IP_HEADER_SIZE) || (packet_len > BLE_6LOWPAN_HOST_MTU))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (m_rx_count == BLE_6LOWPAN_HOST_RX_QUEUE_SIZE)
+    {
+        m_stats.rx_dropped++;
+        return BLE_6LOWPAN_TX_FIFO_FULL;
+    }
+
+    uint8_t * p_copy = nrf_malloc(packet_len);
+
+    if (p_copy == NULL)
+    {
+        m_stats.rx_dropped++;
+        return NRF_ERROR_NO_MEM;
+    }
+
+    memcpy(p_copy, p_packet, packet_len);
+
+    rx_entry_t * p_entry = &m_rx_queue[(m_rx_read + m_rx_count) % BLE_6LOWPAN_HOST_RX_QUEUE_SIZE];
+
+    p_entry->p_packet   = p_copy;
+    p_entry->packet_len = packet_len;
+    m_rx_count++;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_host_process(void)
+{
+    uint32_t delivered = 0;
+
+    if (m_tun_fd >= 0)
+    {
+        static uint8_t tun_buffer[BLE_6LOWPAN_HOST_MTU];
+        ssize_t        length;
+
+        // Queue what the device holds, the stack is not re-entered while reading.
+        while ((length = read(m_tun_fd, tun_buffer, sizeof(tun_buffer))) > 0)
+        {
+            if ((tun_buffer[0] >> 4) == 6)
+            {
+                UNUSED_VARIABLE(ble_6lowpan_host_peer_send(tun_buffer, (uint16_t)length));
+            }
+        }
+    }
+
+    // Only packets queued before the call are delivered, so that peers responding from their
+    // handlers cannot keep the loop running forever.
+    for (uint32_t count = m_rx_count; (count > 0) && m_interface_up; count--)
+    {
+        rx_entry_t entry = m_rx_queue[m_rx_read];
+
+        m_rx_read = (m_rx_read + 1) % BLE_6LOWPAN_HOST_RX_QUEUE_SIZE;
+        m_rx_count--;
+
+        packet_deliver(entry.p_packet, entry.packet_len);
+        delivered++;
+    }
+
+    return delivered;
+}
+
+
+uint32_t ble_6lowpan_host_tun_open(const char * p_name)
+{
+    struct ifreq ifr;
+
+    int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+
+    if (fd < 0)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+    strncpy(ifr.ifr_name, p_name, IFNAMSIZ - 1);
+
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0)
+    {
+        UNUSED_VARIABLE(close(fd));
+        return NRF_ERROR_INTERNAL;
+    }
+
+    m_tun_fd = fd;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_6lowpan_host_pcap_open(const char * p_path, ble_6lowpan_host_clock_t clock)
+{
+    const pcap_file_header_t header =
+    {
+        .magic         = PCAP_MAGIC,
+        .version_major = PCAP_VERSION_MAJOR,
+        .version_minor = PCAP_VERSION_MINOR,
+        .thiszone      = 0,
+        .sigfigs       = 0,
+        .snaplen       = BLE_6LOWPAN_HOST_MTU,
+        .linktype      = PCAP_LINKTYPE_IPV6
+    };
+
+    FILE * p_file = fopen(p_path, "wb");
+
+    if (p_file == NULL)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+    if (fwrite(&header, sizeof(header), 1, p_file) != 1)
+    {
+        UNUSED_VARIABLE(fclose(p_file));
+        return NRF_ERROR_INTERNAL;
+    }
+
+    m_p_pcap     = p_file;
+    m_pcap_clock = clock;
+
+    return NRF_SUCCESS;
+}
+
+
+void ble_6lowpan_host_close(void)
+{
+    if (m_p_pcap != NULL)
+    {
+        UNUSED_VARIABLE(fclose(m_p_pcap));
+        m_p_pcap = NULL;
+    }
+    if (m_tun_fd >= 0)
+    {
+        UNUSED_VARIABLE(close(m_tun_fd));
+        m_tun_fd = -1;
+    }
+}
+
+
+/**@brief Function for checking if a captured packet was sent by the stack itself. */
+static bool source_is_local(const uint8_t * p_packet)
+{
+    const uint8_t * p_iid   = &p_packet[SRC_ADDR_OFFSET + 8];
+    const uint8_t * p_eui64 = m_interface.local_addr.identifier;
+
+    return (((p_eui64[0] ^ IPV6_IID_FLIP_VALUE) == p_iid[0]) &&
+            (memcmp(&p_eui64[1], &p_iid[1], EUI_64_ADDR_SIZE - 1) == 0));
+}
+
+
+static uint32_t pcap_u32(uint32_t value, bool swapped)
+{
+    if (swapped)
+    {
+        value = ((value & 0x000000FF) << 24) | ((value & 0x0000FF00) << 8) |
+                ((value & 0x00FF0000) >> 8)  | ((value & 0xFF000000) >> 24);
+    }
+
+    return value;
+}
+
+
+uint32_t ble_6lowpan_host_replay(const char                           * p_path,
+                                 ble_6lowpan_host_replay_time_handler_t time_handler)
+{
+    if (!m_interface_up)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    FILE * p_file = fopen(p_path, "rb");
+
+    if (p_file == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    pcap_file_header_t   header;
+    pcap_record_header_t record;
+    uint8_t              packet[BLE_6LOWPAN_HOST_MTU];
+    uint32_t             err_code = NRF_SUCCESS;
+    bool                 swapped  = false;
+    uint32_t             frac_div = 1;
+    uint64_t             last_us  = 0;
+    bool                 first    = true;
+
+    if (fread(&header, sizeof(header), 1, p_file) != 1)
+    {
+        err_code = NRF_ERROR_INVALID_DATA;
+    }
+    else
+    {
+        uint32_t magic = header.magic;
+
+        swapped  = (magic == pcap_u32(PCAP_MAGIC, true)) ||
+                   (magic == pcap_u32(PCAP_MAGIC_NSEC, true));
+        magic    = pcap_u32(magic, swapped);
+        frac_div = (magic == PCAP_MAGIC_NSEC) ? 1000 : 1;
+
+        uint32_t linktype = pcap_u32(header.linktype, swapped);
+
+        if (((magic != PCAP_MAGIC) && (magic != PCAP_MAGIC_NSEC)) ||
+            ((linktype != PCAP_LINKTYPE_IPV6) && (linktype != PCAP_LINKTYPE_RAW)))
+        {
+            err_code = NRF_ERROR_INVALID_DATA;
+        }
+    }
+
+    while ((err_code == NRF_SUCCESS) && (fread(&record, sizeof(record), 1, p_file) == 1))
+    {
+        const uint32_t incl_len = pcap_u32(record.incl_len, swapped);
+        const uint64_t now_us   = (uint64_t)pcap_u32(record.ts_sec, swapped) * 1000000 +
+                                  pcap_u32(record.ts_frac, swapped) / frac_div;
+
+        if ((incl_len > sizeof(packet)) || (fread(packet, incl_len, 1, p_file) != 1))
+        {
+            err_code = NRF_ERROR_INVALID_DATA;
+            break;
+        }
+
+        // Complete the exchanges triggered by the previous packet before the next one.
+        UNUSED_VARIABLE(ble_6lowpan_host_process());
+
+        if ((time_handler != NULL) && (!first) && (now_us > last_us))
+        {
+            time_handler((uint32_t)(now_us - last_us));
+        }
+
+        first   = false;
+        last_us = now_us;
+
+        if ((incl_len >= IPV6_IP_HEADER_SIZE) && ((packet[0] >> 4) == 6) &&
+            (!source_is_local(packet)))
+        {
+            if (ble_6lowpan_host_peer_send(packet, (uint16_t)incl_len) == NRF_SUCCESS)
+            {
+                UNUSED_VARIABLE(ble_6lowpan_host_process());
+            }
+        }
+    }
+
+    UNUSED_VARIABLE(fclose(p_file));
+
+    return err_code;
+}
+
+
+void ble_6lowpan_host_stats_get(ble_6lowpan_host_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
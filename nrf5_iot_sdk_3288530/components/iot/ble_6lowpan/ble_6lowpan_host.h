@@ -0,0 +1,203 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @defgroup ble_6lowpan_host 6LoWPAN loopback for host builds
+ * @{
+ * @ingroup iot_sdk_6lowpan
+ * @brief Host implementation of the @ref ble_6lowpan.h API.
+ *
+ * @details Link ble_6lowpan_host.c instead of the 6LoWPAN library to run the IPv6 stack as a
+ *          process on a host. The single 6LoWPAN interface connects the stack to a loopback bus
+ *          of simulated peers. Packets sent by the stack are delivered synchronously to the
+ *          handler of the peer they are routed to:
+ *          - Link-local unicast goes to the peer whose interface identifier matches the
+ *            destination address.
+ *          - Multicast goes to all peers.
+ *          - Any other destination goes to the first peer added, which acts as the router, or to
+ *            the TUN device if one is open.
+ *
+ *          As with the 6LoWPAN library, the module owns the memory of a packet handed to
+ *          ble_6lowpan_interface_send, and frees it once routed or refused. Callers that free a
+ *          refused packet themselves, as the lwIP port does, build with
+ *          BLE_6LOWPAN_HOST_FREE_REFUSED set to 0.
+ *
+ *          Packets injected by peers with @ref ble_6lowpan_host_peer_send are queued and handed
+ *          to the stack by @ref ble_6lowpan_host_process, so peer handlers may respond without
+ *          re-entering the stack.
+ *
+ *          Optionally, traffic is exchanged with a Linux TUN device, to connect several processes
+ *          or the host network, captured to a pcap file, and replayed from a pcap file.
+ */
+
+#ifndef BLE_6LOWPAN_HOST_H__
+#define BLE_6LOWPAN_HOST_H__
+
+#include <stdint.h>
+#include "ble_6lowpan.h"
+
+#ifndef BLE_6LOWPAN_HOST_MAX_PEERS
+#define BLE_6LOWPAN_HOST_MAX_PEERS          8                                                        /**< Maximum number of simulated peers on the loopback bus. */
+#endif // BLE_6LOWPAN_HOST_MAX_PEERS
+
+#ifndef BLE_6LOWPAN_HOST_RX_QUEUE_SIZE
+#define BLE_6LOWPAN_HOST_RX_QUEUE_SIZE      64                                                       /**< Maximum number of packets queued towards the stack. */
+#endif // BLE_6LOWPAN_HOST_RX_QUEUE_SIZE
+
+#ifndef BLE_6LOWPAN_HOST_FREE_REFUSED
+#define BLE_6LOWPAN_HOST_FREE_REFUSED       1                                                        /**< Free packets refused by ble_6lowpan_interface_send, as the IPv6 stack expects. */
+#endif // BLE_6LOWPAN_HOST_FREE_REFUSED
+
+#ifndef BLE_6LOWPAN_HOST_MTU
+#define BLE_6LOWPAN_HOST_MTU                1280                                                     /**< Largest IPv6 packet carried, as for the IPSP channel. */
+#endif // BLE_6LOWPAN_HOST_MTU
+
+/**@brief Handler of packets routed to a simulated peer.
+ *
+ * @param[in] p_peer_addr EUI-64 of the peer the packet is routed to.
+ * @param[in] p_packet    IPv6 packet. Only valid for the duration of the call.
+ * @param[in] packet_len  Length of the packet.
+ */
+typedef void (*ble_6lowpan_host_peer_handler_t)(const eui64_t * p_peer_addr,
+                                                const uint8_t * p_packet,
+                                                uint16_t        packet_len);
+
+/**@brief Handler of the time elapsed between packets replayed from a capture.
+ *
+ * @param[in] elapsed_us Microseconds elapsed since the previous packet.
+ */
+typedef void (*ble_6lowpan_host_replay_time_handler_t)(uint32_t elapsed_us);
+
+/**@brief Source of the time stamps of captured packets.
+ *
+ * @return Current time in microseconds.
+ */
+typedef uint64_t (*ble_6lowpan_host_clock_t)(void);
+
+/**@brief Traffic counters of the loopback. */
+typedef struct
+{
+    uint32_t tx_packets;                                                                             /**< Packets sent by the stack. */
+    uint32_t tx_bytes;                                                                               /**< Bytes sent by the stack. */
+    uint32_t tx_unroutable;                                                                          /**< Packets sent by the stack with no peer to route them to. */
+    uint32_t rx_packets;                                                                             /**< Packets handed to the stack. */
+    uint32_t rx_bytes;                                                                               /**< Bytes handed to the stack. */
+    uint32_t rx_dropped;                                                                             /**< Packets dropped because the queue was full or memory was unavailable. */
+} ble_6lowpan_host_stats_t;
+
+/**@brief Function for bringing the interface up.
+ *
+ * @details The stack is notified with @ref BLE_6LO_EVT_INTERFACE_ADD.
+ *
+ * @param[in] p_peer_addr EUI-64 of the peer the interface is connected to, typically the router.
+ *
+ * @retval NRF_SUCCESS             If the interface was added.
+ * @retval NRF_ERROR_INVALID_STATE If the module is not initialized or the interface is already up.
+ */
+uint32_t ble_6lowpan_host_link_up(const eui64_t * p_peer_addr);
+
+/**@brief Function for bringing the interface down.
+ *
+ * @details The stack is notified with @ref BLE_6LO_EVT_INTERFACE_DELETE. Queued packets are
+ *          dropped.
+ *
+ * @retval NRF_SUCCESS             If the interface was deleted.
+ * @retval NRF_ERROR_INVALID_STATE If the interface is not up.
+ */
+uint32_t ble_6lowpan_host_link_down(void);
+
+/**@brief Function for adding a simulated peer to the loopback bus.
+ *
+ * @param[in] p_peer_addr EUI-64 of the peer.
+ * @param[in] handler     Handler of packets routed to the peer.
+ *
+ * @retval NRF_SUCCESS      If the peer was added.
+ * @retval NRF_ERROR_NO_MEM If @ref BLE_6LOWPAN_HOST_MAX_PEERS peers are already added.
+ */
+uint32_t ble_6lowpan_host_peer_add(const eui64_t                 * p_peer_addr,
+                                   ble_6lowpan_host_peer_handler_t handler);
+
+/**@brief Function for queuing a packet towards the stack.
+ *
+ * @param[in] p_packet   IPv6 packet. Copied before the function returns.
+ * @param[in] packet_len Length of the packet.
+ *
+ * @retval NRF_SUCCESS              If the packet was queued.
+ * @retval NRF_ERROR_INVALID_STATE  If the interface is not up.
+ * @retval NRF_ERROR_INVALID_LENGTH If the packet is shorter than an IPv6 header or exceeds
+ *                                  @ref BLE_6LOWPAN_HOST_MTU.
+ * @retval BLE_6LOWPAN_TX_FIFO_FULL If the queue is full.
+ * @retval NRF_ERROR_NO_MEM         If no memory is available for the copy.
+ */
+uint32_t ble_6lowpan_host_peer_send(const uint8_t * p_packet, uint16_t packet_len);
+
+/**@brief Function for handing queued packets and packets read from the TUN device to the stack.
+ *
+ * @return Number of packets handed to the stack.
+ */
+uint32_t ble_6lowpan_host_process(void);
+
+/**@brief Function for exchanging traffic with a TUN device.
+ *
+ * @details Packets routed to no peer are written to the device, packets read from it are handed
+ *          to the stack by @ref ble_6lowpan_host_process.
+ *
+ * @param[in] p_name Name of the device, for example "tun0". Created if it does not exist.
+ *
+ * @retval NRF_SUCCESS        If the device was opened.
+ * @retval NRF_ERROR_INTERNAL If the device could not be opened or configured.
+ */
+uint32_t ble_6lowpan_host_tun_open(const char * p_name);
+
+/**@brief Function for capturing all packets to and from the stack.
+ *
+ * @param[in] p_path Path of the pcap file, with link type LINKTYPE_IPV6.
+ * @param[in] clock  Source of the time stamps of captured packets. May be NULL.
+ *
+ * @retval NRF_SUCCESS        If the capture was started.
+ * @retval NRF_ERROR_INTERNAL If the file could not be created.
+ */
+uint32_t ble_6lowpan_host_pcap_open(const char * p_path, ble_6lowpan_host_clock_t clock);
+
+/**@brief Function for stopping the capture and the TUN exchange. */
+void ble_6lowpan_host_close(void);
+
+/**@brief Function for handing the packets of a capture to the stack, in order.
+ *
+ * @details Each packet is handed to the stack once the previously queued packets are processed.
+ *          Packets sent by the stack itself, recognised by the interface identifier of their
+ *          source address, are skipped, so that a capture made by @ref ble_6lowpan_host_pcap_open
+ *          can be replayed as is.
+ *          The time elapsed between packets is reported to the handler before the packet, so
+ *          that the simulated clock can be advanced and timer-driven behaviour reproduced.
+ *
+ * @param[in] p_path       Path of a pcap file with link type LINKTYPE_IPV6 or LINKTYPE_RAW.
+ * @param[in] time_handler Handler of the time elapsed between packets. May be NULL.
+ *
+ * @retval NRF_SUCCESS             If all packets were replayed.
+ * @retval NRF_ERROR_INVALID_STATE If the interface is not up.
+ * @retval NRF_ERROR_NOT_FOUND     If the file could not be opened.
+ * @retval NRF_ERROR_INVALID_DATA  If the file is not a supported capture.
+ */
+uint32_t ble_6lowpan_host_replay(const char                           * p_path,
+                                 ble_6lowpan_host_replay_time_handler_t time_handler);
+
+/**@brief Function for getting the traffic counters.
+ *
+ * @param[out] p_stats Traffic counters.
+ */
+void ble_6lowpan_host_stats_get(ble_6lowpan_host_stats_t * p_stats);
+
+#endif // BLE_6LOWPAN_HOST_H__
+
+/** @} */
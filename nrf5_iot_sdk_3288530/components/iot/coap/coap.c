@@ -26,6 +26,7 @@
 #include "coap_resource.h"
 #include "coap_observe_api.h"
 #include "coap_observe.h"
+#include "coap_block.h"
 
 #define COAP_REQUEST_ENTITY_MAX_SIZE (BLE_IPSP_RX_BUFFER_SIZE - (IPV6_IP_HEADER_SIZE + \
                                                                  UDP_HEADER_SIZE))       /** Maximum request entity size. */
@@ -40,41 +41,50 @@ static coap_request_handler_t m_request_handler = NULL;
 
 #ifdef COAP_AUTOMODE
 
+#ifndef COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES
+#define COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES 16                                       /**< Maximum number of observable resources notified automatically. */
+#endif
+
+#ifndef COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE
+#define COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE 2                                     /**< Seconds before Max-Age runs out that an automatic notification is sent. */
+#endif
+
+#ifndef COAP_SERVER_PORT
+#define COAP_SERVER_PORT 5683                                                            /**< Local port that automatic notifications are sent from. CoAP default port number. */
+#endif
+
+#define COAP_OBSERVE_PERIOD_MAX 0x7FFFFFFF                                               /**< Longest notification period in ticks, keeping deadlines comparable across counter wrap-around. */
+
+/**@brief Observable resource scheduled for automatic notification. */
+typedef struct
+{
+    uint32_t          deadline;                                                          /**< Tick on which the next notification is due. */
+    coap_resource_t * p_resource;                                                        /**< Observable resource. */
+} coap_observe_deadline_t;
+
 static uint32_t m_observe_sequence_number = 99;
 
+static coap_observe_deadline_t m_observe_heap[COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES];  /**< Min-heap of observable resources, ordered on the next notification deadline. */
+static uint32_t                m_observe_heap_count;                                     /**< Number of resources in m_observe_heap. */
+static uint32_t                m_observe_tick;                                           /**< Number of observer ticks processed. */
+static uint32_t                m_observe_tree_revision;                                  /**< Revision of the resource tree when m_observe_heap was last updated. */
+
+static void observe_expire_time_update(coap_resource_t * p_resource);
+
 #endif //#ifdef COAP_AUTOMODE
 
-#define COAP_MESSAGE_ACK_SET(REMOTE, LOCAL_PORT, MID) {                    \
-    memcpy(&m_coap_empty_message.remote, (REMOTE), sizeof(coap_remote_t)); \
-    m_coap_empty_message.port.port_number = (LOCAL_PORT);                  \
-    m_coap_empty_message.header.id        = (MID);                         \
-    m_coap_empty_message.header.type      = COAP_TYPE_ACK;                 \
-}
-
-#define COAP_MESSAGE_RST_SET(REMOTE, LOCAL_PORT, MID) {                    \
-    memcpy(&m_coap_empty_message.remote, (REMOTE), sizeof(coap_remote_t)); \
-    m_coap_empty_message.port.port_number = (LOCAL_PORT);                  \
-    m_coap_empty_message.header.id        = (MID);                         \
-    m_coap_empty_message.header.type      = COAP_TYPE_RST;                 \
-}
-
-static coap_message_t m_coap_empty_message = {
-    .header.version    = 1,
-    .header.type       = COAP_TYPE_ACK,
-    .header.token_len  = 0,
-    .header.code       = COAP_CODE_EMPTY_MESSAGE,
-    .header.id         = 0,
-    .p_payload         = NULL,
-    .payload_len       = 0,
-    .options_count     = 0,
-    .p_arg             = NULL,
-    .response_callback = NULL,
-    .port.port_number  = 0,
-    .options_len       = 0,
-    .options_offset    = 0,
-    .p_data            = NULL,
-    .data_len          = 0  
-};
+#ifndef COAP_MESSAGE_POOL_SIZE
+#define COAP_MESSAGE_POOL_SIZE 2                                                         /**< Number of messages in the pool used for received messages and for the responses generated by CoAP. Messages are reserved from the memory manager when the pool is exhausted. */
+#endif
+
+#if (COAP_MESSAGE_POOL_SIZE > 32)
+#error "COAP_MESSAGE_POOL_SIZE can not be larger than 32."
+#endif
+
+#define COAP_EMPTY_MESSAGE_SIZE 4                                                        /**< Size of an empty message, consisting of the CoAP header only. */
+
+static coap_message_t m_message_pool[COAP_MESSAGE_POOL_SIZE];                            /**< Messages used for decoding received datagrams and for responses generated by CoAP. */
+static uint32_t       m_message_pool_in_use;                                             /**< Bitmap of the messages in m_message_pool that are in use. */
 
 static inline bool is_ping(coap_message_t * p_message)
 {
@@ -121,6 +131,72 @@ static inline void app_error_notify(uint32_t err_code, coap_message_t * p_messag
     }
 }
 
+/**@brief Get a message from the message pool.
+ *
+ * @details The message is not cleared. If the pool is exhausted, the message is reserved from the
+ *          memory manager.
+ *
+ * @retval Pointer to the message, or NULL if no message could be reserved.
+ */
+static coap_message_t * message_alloc(void)
+{
+    coap_message_t * p_message = NULL;
+
+    for (uint32_t index = 0; index < COAP_MESSAGE_POOL_SIZE; index++)
+    {
+        if ((m_message_pool_in_use & (1UL << index)) == 0)
+        {
+            m_message_pool_in_use |= (1UL << index);
+            return &m_message_pool[index];
+        }
+    }
+
+    uint32_t size = sizeof(coap_message_t);
+    if (nrf_mem_reserve_tagged((uint8_t **)&p_message, &size, NRF_MEM_TAG_COAP) != NRF_SUCCESS)
+    {
+        return NULL;
+    }
+    COAP_TRC("[COAP]: Alloc mem, p_message = %p\r\n", (uint8_t *)p_message);
+
+    return p_message;
+}
+
+/**@brief Return a message obtained by @ref message_alloc. */
+static void message_free(coap_message_t * p_message)
+{
+    if ((p_message >= &m_message_pool[0]) && (p_message < &m_message_pool[COAP_MESSAGE_POOL_SIZE]))
+    {
+        m_message_pool_in_use &= ~(1UL << (uint32_t)(p_message - &m_message_pool[0]));
+    }
+    else
+    {
+        COAP_TRC("[COAP]: Free mem, p_message = %p\r\n", (uint8_t *)p_message);
+        UNUSED_VARIABLE(nrf_free((uint8_t *)p_message));
+    }
+}
+
+/**@brief Send an empty message directly on the transport, without reserving any memory.
+ *
+ * @param[in] p_port      Local port to send the message from.
+ * @param[in] p_remote    Remote to send the message to.
+ * @param[in] type        Message type, COAP_TYPE_ACK or COAP_TYPE_RST.
+ * @param[in] message_id  Message ID to acknowledge or reset.
+ */
+static uint32_t empty_message_send(const coap_port_t   * p_port,
+                                   const coap_remote_t * p_remote,
+                                   coap_msg_type_t       type,
+                                   uint16_t              message_id)
+{
+    uint8_t header[COAP_EMPTY_MESSAGE_SIZE];
+
+    header[0] = (uint8_t)(((COAP_VERSION & 0x3) << 6) | ((type & 0x3) << 4));
+    header[1] = COAP_CODE_EMPTY_MESSAGE;
+    header[2] = (uint8_t)(message_id >> 8);
+    header[3] = (uint8_t)(message_id & 0xFF);
+
+    return coap_transport_write(p_port, p_remote, header, COAP_EMPTY_MESSAGE_SIZE);
+}
+
 uint32_t coap_init(uint32_t token_rand_seed, coap_transport_init_t * p_transport_param)
 {
     COAP_TRC("[COAP]: >> coap_init %lu.\r\n", token_rand_seed);
@@ -153,6 +229,11 @@ uint32_t coap_init(uint32_t token_rand_seed, coap_transport_init_t * p_transport
 
     err_code = coap_resource_init();
 
+#ifdef COAP_AUTOMODE
+    m_observe_heap_count    = 0;
+    m_observe_tree_revision = coap_resource_revision_get();
+#endif // COAP_AUTOMODE
+
     COAP_MUTEX_UNLOCK();
 
     COAP_TRC("[COAP]: << coap_init\r\n");
@@ -198,7 +279,7 @@ uint32_t internal_coap_message_send(uint32_t * p_handle, coap_message_t * p_mess
     // Allocate a buffer to serialize the message into.
     uint8_t * p_buffer;
     uint32_t request_length = expected_length;
-    err_code = nrf_mem_reserve(&p_buffer, &request_length);
+    err_code = nrf_mem_reserve_tagged(&p_buffer, &request_length, NRF_MEM_TAG_COAP);
     if (err_code != NRF_SUCCESS)
     {
         COAP_TRC("[COAP]: p_buffer alloc error = 0x%08lX!\r\n", err_code);
@@ -219,53 +300,72 @@ uint32_t internal_coap_message_send(uint32_t * p_handle, coap_message_t * p_mess
         return err_code;
     }
 
-    err_code = coap_transport_write(&p_message->port, &p_message->remote, p_buffer, buffer_length);
+    // A message waiting for a response is queued before it is written, so that it is not sent
+    // when the queue is full, and is matched even if the response arrives within the write.
+    coap_queue_item_t * p_queued = NULL;
 
-    if (err_code == NRF_SUCCESS)
-    {   
-        if (is_request(p_message->header.code) ||
-            is_con_response(p_message))
+    if (is_request(p_message->header.code) ||
+        is_con_response(p_message))
+    {
+        coap_queue_item_t item;
+        item.p_arg         = p_message->p_arg;
+        item.mid           = p_message->header.id;
+        item.callback      = p_message->response_callback;
+        item.p_buffer      = p_buffer;
+        item.buffer_len    = buffer_length;
+        item.timeout_val   = COAP_ACK_TIMEOUT * COAP_ACK_RANDOM_FACTOR;
+
+        if (p_message->header.type == COAP_TYPE_CON)
         {
-            coap_queue_item_t item;
-            item.p_arg         = p_message->p_arg;
-            item.mid           = p_message->header.id;
-            item.callback      = p_message->response_callback;
-            item.p_buffer      = p_buffer;
-            item.buffer_len    = buffer_length;
-            item.timeout_val   = COAP_ACK_TIMEOUT * COAP_ACK_RANDOM_FACTOR;
-
-            if (p_message->header.type == COAP_TYPE_CON)
-            {
-                item.timeout       = item.timeout_val;
-                item.retrans_count = 0;
-            }
-            else
-            {   
-                item.timeout       = COAP_MAX_TRANSMISSION_SPAN;
-                item.retrans_count = COAP_MAX_RETRANSMIT_COUNT;
-            }
-            
-            item.port          = p_message->port;
-            item.token_len     = p_message->header.token_len;
-            memcpy(&item.remote, &p_message->remote, sizeof(coap_remote_t));
-            memcpy(item.token, p_message->token, p_message->header.token_len);
-            err_code = coap_queue_add(&item);
-            if (err_code != NRF_SUCCESS)
-            {
-                COAP_TRC("[COAP]: Message queue error = 0x%08lX!\r\n", err_code);
-                return err_code;
-            }
-            *p_handle = item.handle;
+            item.timeout       = item.timeout_val;
+            item.retrans_count = 0;
         }
         else
+        {   
+            item.timeout       = COAP_MAX_TRANSMISSION_SPAN;
+            item.retrans_count = COAP_MAX_RETRANSMIT_COUNT;
+        }
+        
+        item.port          = p_message->port;
+        item.token_len     = p_message->header.token_len;
+        memcpy(&item.remote, &p_message->remote, sizeof(coap_remote_t));
+        memcpy(item.token, p_message->token, p_message->header.token_len);
+        err_code = coap_queue_add(&item);
+        if (err_code != NRF_SUCCESS)
         {
-            *p_handle = COAP_MESSAGE_QUEUE_SIZE;
-            
+            COAP_TRC("[COAP]: Message queue error = 0x%08lX!\r\n", err_code);
             COAP_TRC("[COAP]: Free mem, p_buffer = %p\r\n", p_buffer);
             UNUSED_VARIABLE(nrf_free(p_buffer));
+
+            return err_code;
         }
+
+        // Message IDs may repeat in the queue, the handle identifies the item just added.
+        err_code = coap_queue_item_by_handle_get(&p_queued, item.handle);
+        if (err_code != NRF_SUCCESS)
+        {
+            COAP_TRC("[COAP]: Message queue error = 0x%08lX!\r\n", err_code);
+            COAP_TRC("[COAP]: Free mem, p_buffer = %p\r\n", p_buffer);
+            UNUSED_VARIABLE(nrf_free(p_buffer));
+
+            return err_code;
+        }
+
+        *p_handle = item.handle;
     }
     else
+    {
+        *p_handle = COAP_MESSAGE_QUEUE_SIZE;
+    }
+
+    err_code = coap_transport_write(&p_message->port, &p_message->remote, p_buffer, buffer_length);
+
+    if ((err_code != NRF_SUCCESS) && (p_queued != NULL))
+    {
+        (void)coap_queue_remove(p_queued);
+    }
+
+    if ((err_code != NRF_SUCCESS) || (p_queued == NULL))
     {
         COAP_TRC("[COAP]: Free mem, p_buffer = %p\r\n", p_buffer);
         UNUSED_VARIABLE(nrf_free(p_buffer));
@@ -277,36 +377,25 @@ uint32_t internal_coap_message_send(uint32_t * p_handle, coap_message_t * p_mess
 }
 
 
-static uint32_t create_response(coap_message_t ** pp_response, coap_message_t * p_request, uint16_t data_size)
+/**@brief Prepare a response to a request in a message provided by the caller.
+ *
+ * @param[in] p_response  Message to prepare the response in.
+ * @param[in] p_request   Request to respond to.
+ * @param[in] p_data      Scratch buffer for options and payload of the response. Can be NULL if
+ *                        data_size is 0.
+ * @param[in] data_size   Size of the scratch buffer.
+ */
+static uint32_t create_response(coap_message_t * p_response,
+                                coap_message_t * p_request,
+                                uint8_t        * p_data,
+                                uint16_t         data_size)
 {
     uint32_t err_code;
-    
-    // Allocate space for a new message.
-    uint32_t size = sizeof(coap_message_t);
-    err_code = nrf_mem_reserve((uint8_t **)pp_response, &size);
-    if (err_code != NRF_SUCCESS)
-    {
-        return err_code;
-    }
-    
-    coap_message_t * p_response = (*pp_response);
-    
+
     memset(p_response, 0, sizeof(coap_message_t));
-    COAP_TRC("[COAP]: Alloc mem, p_response = %p\r\n", (uint8_t *)p_response);
 
-    if (data_size > 0)
-    {
-        // Allocate a scratch buffer for payload and options.
-        size = data_size;
-        err_code = nrf_mem_reserve(&(p_response->p_data), &size);
-        if (err_code != NRF_SUCCESS)
-        {
-            return err_code;
-        }
-        memset(p_response->p_data, 0, size);
-        p_response->data_len = size;
-        COAP_TRC("[COAP]: Alloc mem, p_response->p_data = %p\r\n", p_response->p_data);
-    }
+    p_response->p_data   = p_data;
+    p_response->data_len = data_size;
     
     coap_message_conf_t config;
     memset (&config, 0, sizeof(coap_message_conf_t));
@@ -348,11 +437,22 @@ static uint32_t create_response(coap_message_t ** pp_response, coap_message_t *
  */
 static uint32_t send_error_response(coap_message_t * p_message, uint8_t code)
 {
-    coap_message_t * p_error_response = NULL;        
+    uint32_t         err_code         = (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
+    coap_message_t * p_error_response = message_alloc();
+
+    if (p_error_response != NULL)
+    {
+        // The error response has neither options nor payload, no scratch buffer is needed.
+        err_code = create_response(p_error_response, p_message, NULL, 0);
+    }
 
-    uint32_t err_code = create_response(&p_error_response, p_message, COAP_MESSAGE_DATA_MAX_SIZE);
     if (err_code != NRF_SUCCESS)
     {
+        if (p_error_response != NULL)
+        {
+            message_free(p_error_response);
+        }
+
         // If message could not be created, notify the application.
         app_error_notify(err_code, p_message);
         return err_code;
@@ -361,20 +461,60 @@ static uint32_t send_error_response(coap_message_t * p_message, uint8_t code)
     // Set the response code.
     p_error_response->header.code = code;
 
-    if (p_error_response != NULL)
+    uint32_t handle;
+    err_code = internal_coap_message_send(&handle, p_error_response);
+
+    message_free(p_error_response);
+    
+    return err_code;
+}
+
+#ifdef COAP_AUTOMODE
+/**@brief Call the handler of a resource in auto-mode, and send the response it has prepared.
+ *
+ * @param[in] p_resource Resource the request is for.
+ * @param[in] p_request  Request to respond to.
+ *
+ * @retval NRF_SUCCESS If the response was sent out successfully.
+ */
+static uint32_t resource_callback_respond(coap_resource_t * p_resource, coap_message_t * p_request)
+{
+    uint8_t * p_data;
+    uint32_t  data_size = COAP_MESSAGE_DATA_MAX_SIZE;
+    uint32_t  err_code  = nrf_mem_reserve_tagged(&p_data, &data_size, NRF_MEM_TAG_COAP);
+    if (err_code != NRF_SUCCESS)
     {
-        uint32_t handle;
-        err_code = internal_coap_message_send(&handle, p_error_response);
+        return err_code;
+    }
+
+    coap_message_t * p_response = message_alloc();
+    if (p_response == NULL)
+    {
+        UNUSED_VARIABLE(nrf_free(p_data));
+        return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
+    }
+
+    err_code = create_response(p_response, p_request, p_data, COAP_MESSAGE_DATA_MAX_SIZE);
+    if (err_code == NRF_SUCCESS)
+    {
+        observe_expire_time_update(p_resource);
+
+        COAP_MUTEX_UNLOCK();
+
+        p_resource->callback(p_resource, p_request, p_response);
 
-        COAP_TRC("[COAP]: Free mem, p_response->p_data = %p\r\n", p_error_response->p_data);
-        UNUSED_VARIABLE(nrf_free(p_error_response->p_data));
+        COAP_MUTEX_LOCK();
 
-        COAP_TRC("[COAP]: Free mem, p_response = %p\r\n", (uint8_t *)p_error_response);
-        UNUSED_VARIABLE(nrf_free((uint8_t *)p_error_response));
+        uint32_t handle;
+        err_code = internal_coap_message_send(&handle, p_response);
     }
-    
+
+    message_free(p_response);
+    UNUSED_VARIABLE(nrf_free(p_data));
+
     return err_code;
 }
+#endif // COAP_AUTOMODE
 
 uint32_t coap_transport_read(const coap_port_t    * p_port,
                              const coap_remote_t  * p_remote,
@@ -391,25 +531,21 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
     }
     
     uint32_t err_code;
-    coap_message_t * p_message;
 
-    // Allocate space for a new message.
-    uint32_t size = sizeof(coap_message_t);
-    err_code = nrf_mem_reserve((uint8_t **)&p_message, &size);
-    if (err_code != NRF_SUCCESS)
+    // The message is taken from the message pool, and decoded in place with options and payload
+    // referring to p_data.
+    coap_message_t * p_message = message_alloc();
+    if (p_message == NULL)
     {
-        return err_code;
+        return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
     }
 
-    memset(p_message, 0, sizeof(coap_message_t));
-    COAP_TRC("[COAP]: Alloc mem, p_message = %p\r\n", (uint8_t *)p_message);
-
     err_code = coap_message_decode(p_message, p_data, datalen);
     if (err_code != NRF_SUCCESS)
     {
         app_error_notify(err_code, p_message);
         
-        UNUSED_VARIABLE(nrf_free((uint8_t *)p_message));
+        message_free(p_message);
         return err_code;
     }
     
@@ -422,42 +558,42 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
     if (result == UDP_TRUNCATED_PACKET)
     {
 #ifdef COAP_AUTOMODE
-        coap_message_t * p_response;
-        
-        // create a response message.
-        err_code = create_response(&p_response, p_message, 4); // 1 option, 1 byte ext delta, potential 2 byte integer for size1.
-        if (err_code != NRF_SUCCESS)
+        // 1 option, 1 byte ext delta, potential 2 byte integer for size1.
+        uint8_t          option_data[4];
+        coap_message_t * p_response = message_alloc();
+
+        if (p_response == NULL)
         {
-            return err_code;
+            err_code = (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
         }
-        
-        (void)coap_message_opt_uint_add(p_response, COAP_OPT_SIZE1, COAP_REQUEST_ENTITY_MAX_SIZE);
-        
-        p_response->header.token_len = 0;
-        p_response->payload_len      = 0;
-        
-        // Override 404 code.
-        p_response->header.code = COAP_CODE_413_REQUEST_ENTITY_TOO_LARGE;
-        p_response->header.type = COAP_TYPE_RST;
+        else
+        {
+            // create a response message.
+            err_code = create_response(p_response, p_message, option_data, sizeof(option_data));
+            if (err_code == NRF_SUCCESS)
+            {
+                (void)coap_message_opt_uint_add(p_response, COAP_OPT_SIZE1, COAP_REQUEST_ENTITY_MAX_SIZE);
+                
+                p_response->header.token_len = 0;
+                p_response->payload_len      = 0;
+                
+                // Override 404 code.
+                p_response->header.code = COAP_CODE_413_REQUEST_ENTITY_TOO_LARGE;
+                p_response->header.type = COAP_TYPE_RST;
 
-        uint32_t msg_handle;
-        err_code = internal_coap_message_send(&msg_handle, p_response);
-        
-        COAP_TRC("[COAP]: Free mem, p_response->p_data = %p\r\n", p_response->p_data);
-        UNUSED_VARIABLE(nrf_free(p_response->p_data));
-        
-        COAP_TRC("[COAP]: Free mem, p_response = %p\r\n", (uint8_t *)p_response);
-        UNUSED_VARIABLE(nrf_free((uint8_t *)p_response));
+                uint32_t msg_handle;
+                err_code = internal_coap_message_send(&msg_handle, p_response);
+            }
+            
+            message_free(p_response);
+        }
 #else 
         app_error_notify(result, p_message);
 #endif //#ifdef COAP_AUTOMODE
     }
     else if (is_ping(p_message))
     {
-        COAP_MESSAGE_RST_SET(&p_message->remote, p_message->port.port_number, p_message->header.id);
-            
-        uint32_t handle;
-        err_code = internal_coap_message_send(&handle, &m_coap_empty_message);
+        err_code = empty_message_send(p_port, p_remote, COAP_TYPE_RST, p_message->header.id);
     }
     else if (is_ack(p_message) || 
              is_reset(p_message))
@@ -509,14 +645,8 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
         // If this is a CON response, we have to send an ACK on the message id.
         if (p_message->header.type == COAP_TYPE_CON)
         {
-            // create an ACK message and add the current MID.
-            COAP_MESSAGE_ACK_SET(&p_message->remote, p_message->port.port_number, p_message->header.id);
-            
-            uint32_t handle;
-            coap_message_t coap_ack_message = m_coap_empty_message;
-            coap_ack_message.port.port_number = p_port->port_number;
-
-            err_code = internal_coap_message_send(&handle, &coap_ack_message);
+            // Send an ACK on the current MID.
+            err_code = empty_message_send(p_port, p_remote, COAP_TYPE_ACK, p_message->header.id);
         }
         
         coap_queue_item_t * p_item;
@@ -526,7 +656,7 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
             // Compiled away if COAP_ENABLE_OBSERVE_CLIENT is not set to 1.
             coap_observe_client_response_handle(p_message, NULL);
             
-            UNUSED_VARIABLE(nrf_free((uint8_t *)p_message));
+            message_free(p_message);
             return err_code; 
         }
 
@@ -585,20 +715,36 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
         else
         {
             uint8_t * uri_pointers[COAP_RESOURCE_MAX_DEPTH] = {0, };
+            uint16_t  uri_lengths[COAP_RESOURCE_MAX_DEPTH];
 
             uint8_t  uri_path_count = 0;
             uint16_t index;
 
+            coap_resource_t * found_resource = NULL;
+
             for (index = 0; index < p_message->options_count; index++)
             {
                 if (p_message->options[index].number == COAP_OPT_URI_PATH)
                 {
+                    if (uri_path_count == COAP_RESOURCE_MAX_DEPTH)
+                    {
+                        // Deeper than any resource, nothing can be found.
+                        uri_path_count++;
+                        break;
+                    }
+
+                    uri_lengths[uri_path_count]    = p_message->options[index].length;
                     uri_pointers[uri_path_count++] = p_message->options[index].p_data;
                 }
             }
             
-            coap_resource_t * found_resource;
-            err_code = coap_resource_get(&found_resource, uri_pointers, uri_path_count);
+            if (uri_path_count <= COAP_RESOURCE_MAX_DEPTH)
+            {
+                err_code = coap_resource_segments_get(&found_resource,
+                                                      uri_pointers,
+                                                      uri_lengths,
+                                                      uri_path_count);
+            }
             
             if (found_resource != NULL)
             {
@@ -606,11 +752,15 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
                 {
                     if (((found_resource->permission) & (1 << ((p_message->header.code) - 1))) > 0) // Has permission for the requested CoAP method.
                     {
+#ifdef COAP_AUTOMODE
+                        err_code = resource_callback_respond(found_resource, p_message);
+#else // COAP_AUTOMODE
                         COAP_MUTEX_UNLOCK();
                         
                         found_resource->callback(found_resource, p_message);
                         
                         COAP_MUTEX_LOCK();
+#endif // COAP_AUTOMODE
                     }
                     else
                     {
@@ -632,8 +782,7 @@ uint32_t coap_transport_read(const coap_port_t    * p_port,
         }
     }
 
-    COAP_TRC("[COAP]: Free mem, p_message = %p\r\n", (uint8_t *)p_message);
-    UNUSED_VARIABLE(nrf_free((uint8_t *)p_message));
+    message_free(p_message);
 
     COAP_TRC("[COAP]: << coap_transport_read\r\n");
     return err_code;
@@ -672,7 +821,7 @@ uint32_t coap_message_new(coap_message_t ** p_request, coap_message_conf_t * p_c
 
     // Allocate space for a new message.
     uint32_t size = sizeof(coap_message_t);
-    err_code = nrf_mem_reserve((uint8_t **)p_request, &size);
+    err_code = nrf_mem_reserve_tagged((uint8_t **)p_request, &size, NRF_MEM_TAG_COAP);
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
@@ -683,7 +832,7 @@ uint32_t coap_message_new(coap_message_t ** p_request, coap_message_conf_t * p_c
 
     // Allocate a scratch buffer for payload and options.
     size = COAP_MESSAGE_DATA_MAX_SIZE;
-    err_code = nrf_mem_reserve(&((*p_request)->p_data), &size);
+    err_code = nrf_mem_reserve_tagged(&((*p_request)->p_data), &size, NRF_MEM_TAG_COAP);
     if (err_code != NRF_SUCCESS)
     {
         COAP_TRC("[COAP]: Allocation of message data buffer failed!\r\n");
@@ -736,88 +885,322 @@ uint32_t coap_message_delete(coap_message_t * p_message)
 
 #ifdef COAP_AUTOMODE
 
-static uint32_t internal_observer_notify(coap_resource_t * p_resource)
+#define COAP_TOKEN_MAX_LEN 8                                                             /**< Maximum length of a CoAP token. */
+
+/**@brief Find the first observer of a resource using the lowest content type above a given one.
+ *
+ * @param[in] p_resource Resource being observed.
+ * @param[in] p_previous First observer of the content type notified last, or NULL to find the
+ *                       lowest content type in use.
+ *
+ * @return First observer using the next content type, or NULL if all have been notified.
+ */
+static coap_observer_t * observer_ct_next_get(coap_resource_t * p_resource,
+                                              coap_observer_t * p_previous)
 {
-    // Fetch all observers which are subscribed to this resource.
-    // Then send an update value too each observer.
+    coap_observer_t * p_next     = NULL;
     coap_observer_t * p_observer = NULL;
-    while (coap_observe_server_next_get(&p_observer, p_observer, p_resource) != (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE))
+
+    while (coap_observe_server_next_get(&p_observer, p_observer, p_resource) == NRF_SUCCESS)
     {
-        // Generate a message.
-        coap_message_conf_t response_config;
-        memset(&response_config, 0, sizeof(coap_message_conf_t));
-        
-        response_config.type = COAP_TYPE_NON;
-        response_config.code = COAP_CODE_205_CONTENT;
-
-        // Copy token.
-        memcpy(&response_config.token[0], &p_observer->token[0], p_observer->token_len);
-        // Copy token length.
-        response_config.token_len = p_observer->token_len;
-        response_config.port.port_number = COAP_SERVER_PORT;
-        
-        coap_message_t * p_response;
-        uint32_t err_code = coap_message_new(&p_response, &response_config);
-        if (err_code != NRF_SUCCESS)
+        if (((p_previous == NULL) || (p_observer->ct > p_previous->ct)) &&
+            ((p_next == NULL) || (p_observer->ct < p_next->ct)))
         {
-            return err_code;
+            p_next = p_observer;
         }
+    }
+
+    return p_next;
+}
+
+/**@brief Notify the observers of a resource using a given content type.
+ *
+ * @details The notification is rendered and encoded once, without token, after room for the
+ *          header and the longest token. For each observer only the header, with the token length
+ *          and a new message ID, and the token are written in front of the encoded options and
+ *          payload before the message is written to the transport.
+ *
+ * @param[in] p_resource       Resource being observed.
+ * @param[in] p_first_observer First observer of the resource using the content type.
+ * @param[in] sequence_number  Value of the Observe option.
+ */
+static uint32_t observer_ct_notify(coap_resource_t * p_resource,
+                                   coap_observer_t * p_first_observer,
+                                   uint32_t          sequence_number)
+{
+    // Generate a message.
+    coap_message_conf_t response_config;
+    memset(&response_config, 0, sizeof(coap_message_conf_t));
+    
+    response_config.type = COAP_TYPE_NON;
+    response_config.code = COAP_CODE_205_CONTENT;
+    response_config.port.port_number = COAP_SERVER_PORT;
+    
+    coap_message_t * p_response;
+    uint32_t err_code = coap_message_new(&p_response, &response_config);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+    
+    err_code = coap_message_opt_uint_add(p_response, COAP_OPT_OBSERVE, sequence_number);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
         
-        err_code = coap_message_remote_addr_set(p_response, &p_observer->remote);
-        if (err_code != NRF_SUCCESS)
+    err_code = coap_message_opt_uint_add(p_response, COAP_OPT_MAX_AGE, p_resource->expire_time);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
+    
+    COAP_MUTEX_UNLOCK();
+    
+    err_code = coap_resource_observe_payload_set(p_resource, p_first_observer->ct, p_response);
+    
+    COAP_MUTEX_LOCK();
+    
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
+
+    // Encode the notification once, leaving room in front of it for the longest token.
+    uint16_t encoded_length = 0;
+    err_code = coap_message_encode(p_response, NULL, &encoded_length);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
+
+    uint8_t * p_buffer;
+    uint32_t  buffer_length = encoded_length + COAP_TOKEN_MAX_LEN;
+    err_code = nrf_mem_reserve_tagged(&p_buffer, &buffer_length, NRF_MEM_TAG_COAP);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
+    COAP_TRC("[COAP]: Alloc mem, p_buffer = %p\r\n", p_buffer);
+
+    err_code = coap_message_encode(p_response, &p_buffer[COAP_TOKEN_MAX_LEN], &encoded_length);
+
+    (void)coap_message_delete(p_response);
+
+    // Options and payload follow the header, and stay in place for all observers.
+    const uint16_t tail_index  = COAP_TOKEN_MAX_LEN + COAP_EMPTY_MESSAGE_SIZE;
+    const uint16_t tail_length = encoded_length - COAP_EMPTY_MESSAGE_SIZE;
+    const uint8_t  first_byte  = p_buffer[COAP_TOKEN_MAX_LEN] & 0xF0;
+    const uint8_t  code        = p_buffer[COAP_TOKEN_MAX_LEN + 1];
+
+    coap_observer_t * p_observer = p_first_observer;
+
+    while ((err_code == NRF_SUCCESS) && (p_observer != NULL))
+    {
+        if (p_observer->ct == p_first_observer->ct)
         {
-            (void)coap_message_delete(p_response);
-            return err_code;
+            uint16_t index      = tail_index - p_observer->token_len - COAP_EMPTY_MESSAGE_SIZE;
+            uint16_t message_id = (uint16_t)m_message_id_counter++;
+
+            p_buffer[index]     = first_byte | (p_observer->token_len & 0x0F);
+            p_buffer[index + 1] = code;
+            p_buffer[index + 2] = (uint8_t)(message_id >> 8);
+            p_buffer[index + 3] = (uint8_t)(message_id & 0xFF);
+            memcpy(&p_buffer[index + COAP_EMPTY_MESSAGE_SIZE], p_observer->token, p_observer->token_len);
+
+            err_code = coap_transport_write(&response_config.port,
+                                            &p_observer->remote,
+                                            &p_buffer[index],
+                                            COAP_EMPTY_MESSAGE_SIZE + p_observer->token_len + tail_length);
         }
-        
-        err_code = coap_message_opt_uint_add(p_response, COAP_OPT_OBSERVE, m_observe_sequence_number++);
-        if (err_code != NRF_SUCCESS)
+
+        if (coap_observe_server_next_get(&p_observer, p_observer, p_resource) != NRF_SUCCESS)
         {
-            (void)coap_message_delete(p_response);
-            return err_code;
+            p_observer = NULL;
         }
-            
-        err_code = coap_message_opt_uint_add(p_response, COAP_OPT_MAX_AGE, p_resource->expire_time);
+    }
+
+    COAP_TRC("[COAP]: Free mem, p_buffer = %p\r\n", p_buffer);
+    UNUSED_VARIABLE(nrf_free(p_buffer));
+
+    return err_code;
+}
+
+static uint32_t internal_observer_notify(coap_resource_t * p_resource)
+{
+    // Fetch all observers which are subscribed to this resource.
+    // The value is rendered once for each content type in use, and sent to all observers using it.
+    // Content types are notified in increasing order, so no list of those done is needed.
+    uint32_t          sequence_number = m_observe_sequence_number++;
+    coap_observer_t * p_observer      = observer_ct_next_get(p_resource, NULL);
+
+    while (p_observer != NULL)
+    {
+        uint32_t err_code = observer_ct_notify(p_resource, p_observer, sequence_number);
         if (err_code != NRF_SUCCESS)
         {
-            (void)coap_message_delete(p_response);
             return err_code;
         }
-        
-        COAP_MUTEX_UNLOCK();
-        
-        err_code = coap_resource_observe_payload_set(p_resource, p_observer->ct, p_response);
-        
-        COAP_MUTEX_LOCK();
-        
-        if (err_code != NRF_SUCCESS)
+
+        p_observer = observer_ct_next_get(p_resource, p_observer);
+    }
+    
+    return NRF_SUCCESS;
+}
+
+/**@brief Check if deadline a is before deadline b, allowing for counter wrap-around. */
+static bool observe_deadline_before(uint32_t a, uint32_t b)
+{
+    return ((int32_t)(a - b) < 0);
+}
+
+/**@brief Restore the heap order, moving the entry at index towards the root. */
+static void observe_heap_sift_up(uint32_t index)
+{
+    coap_observe_deadline_t entry = m_observe_heap[index];
+
+    while (index > 0)
+    {
+        uint32_t parent = (index - 1) / 2;
+
+        if (!observe_deadline_before(entry.deadline, m_observe_heap[parent].deadline))
         {
-            (void)coap_message_delete(p_response);
-            return err_code;
+            break;
         }
-        
-        uint32_t msg_handle;
-        err_code = internal_coap_message_send(&msg_handle, p_response);
-        if (err_code != NRF_SUCCESS)
+
+        m_observe_heap[index]                                = m_observe_heap[parent];
+        m_observe_heap[index].p_resource->observe_heap_index = index + 1;
+
+        index = parent;
+    }
+
+    m_observe_heap[index]                = entry;
+    entry.p_resource->observe_heap_index = index + 1;
+}
+
+/**@brief Restore the heap order, moving the entry at index towards the leaves. */
+static void observe_heap_sift_down(uint32_t index)
+{
+    coap_observe_deadline_t entry = m_observe_heap[index];
+
+    for (;;)
+    {
+        uint32_t child = (2 * index) + 1;
+
+        if (child >= m_observe_heap_count)
         {
-            (void)coap_message_delete(p_response);
-            return err_code;
+            break;
         }
-        
-        err_code = coap_message_delete(p_response);
-        if (err_code != NRF_SUCCESS)
+
+        if (((child + 1) < m_observe_heap_count) &&
+            observe_deadline_before(m_observe_heap[child + 1].deadline, m_observe_heap[child].deadline))
         {
-            (void)coap_message_delete(p_response);
-            return err_code;
+            child++;
         }
+
+        if (!observe_deadline_before(m_observe_heap[child].deadline, entry.deadline))
+        {
+            break;
+        }
+
+        m_observe_heap[index]                                = m_observe_heap[child];
+        m_observe_heap[index].p_resource->observe_heap_index = index + 1;
+
+        index = child;
+    }
+
+    m_observe_heap[index]                = entry;
+    entry.p_resource->observe_heap_index = index + 1;
+}
+
+/**@brief Number of ticks from one notification of a resource to the next.
+ *
+ * @details The notification is sent COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE ticks before the
+ *          Max-Age of the previous one runs out.
+ */
+static uint32_t observe_period_get(coap_resource_t * p_resource)
+{
+    uint32_t period = 1;
+
+    if (p_resource->max_age > COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE)
+    {
+        period += MIN(p_resource->max_age - COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE,
+                      COAP_OBSERVE_PERIOD_MAX - 1);
+    }
+
+    return period;
+}
+
+/**@brief Find the position of a resource in the heap.
+ *
+ * @param[in]  p_resource Resource to look for.
+ * @param[out] p_index    Position of the resource in m_observe_heap.
+ *
+ * @retval true  If the resource is scheduled.
+ * @retval false If the resource is not scheduled.
+ */
+static bool observe_heap_index_get(coap_resource_t * p_resource, uint32_t * p_index)
+{
+    uint32_t index = p_resource->observe_heap_index;
+
+    // The position stored in the resource is checked, it may be left from before coap_init.
+    if ((index == 0) ||
+        (index > m_observe_heap_count) ||
+        (m_observe_heap[index - 1].p_resource != p_resource))
+    {
+        return false;
+    }
+
+    *p_index = index - 1;
+
+    return true;
+}
+
+/**@brief Start a new notification period for a resource whose value is being notified. */
+static void observe_schedule_restart(coap_resource_t * p_resource)
+{
+    uint32_t index;
+
+    if (observe_heap_index_get(p_resource, &index))
+    {
+        m_observe_heap[index].deadline = m_observe_tick + observe_period_get(p_resource);
+
+        observe_heap_sift_up(index);
+        observe_heap_sift_down(p_resource->observe_heap_index - 1);
+    }
+
+    p_resource->expire_time = p_resource->max_age;
+}
+
+/**@brief Update the number of seconds until the value last notified for a resource expires.
+ *
+ * @details The value was notified one period before the next deadline of the resource, so
+ *          the time left is found from the deadline without counting down every tick.
+ */
+static void observe_expire_time_update(coap_resource_t * p_resource)
+{
+    uint32_t index;
+
+    if (observe_heap_index_get(p_resource, &index))
+    {
+        uint32_t period  = observe_period_get(p_resource);
+        uint32_t left    = m_observe_heap[index].deadline - m_observe_tick;
+        uint32_t elapsed = (left < period) ? (period - left) : 0;
+
+        p_resource->expire_time = (p_resource->max_age > elapsed) ? (p_resource->max_age - elapsed) : 0;
     }
-    
-    return NRF_SUCCESS;
 }
 
 uint32_t coap_observer_notify(coap_resource_t * p_resource)
 {
-    COAP_MUTEX_UNLOCK();
+    COAP_MUTEX_LOCK();
+
+    observe_schedule_restart(p_resource);
 
     uint32_t err_code = internal_observer_notify(p_resource);
     
@@ -826,7 +1209,12 @@ uint32_t coap_observer_notify(coap_resource_t * p_resource)
     return err_code;
 }
 
-static uint32_t resource_autonotify(coap_resource_t * p_current_resource)
+/**@brief Add the observable resources of a subtree that are not yet scheduled to the heap.
+ *
+ * @details New resources are due immediately. Resources are never removed from the tree, so
+ *          scheduled resources keep their deadline.
+ */
+static uint32_t observe_schedule_add(coap_resource_t * p_current_resource)
 {
     uint32_t err_code = NRF_SUCCESS;
     
@@ -835,7 +1223,7 @@ static uint32_t resource_autonotify(coap_resource_t * p_current_resource)
         coap_resource_t * next_child = p_current_resource->p_front;
         do
         {
-            err_code = resource_autonotify(next_child);
+            err_code = observe_schedule_add(next_child);
             if (err_code != NRF_SUCCESS)
             {
                 return err_code;
@@ -844,19 +1232,23 @@ static uint32_t resource_autonotify(coap_resource_t * p_current_resource)
         } while (next_child != NULL);
     }
     
-    // If the resource is observable, append 'obs;' token.
     if ((p_current_resource->permission & COAP_PERM_OBSERVE) > 0)
     {
-        if (p_current_resource->expire_time <= (0 + COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE))
+        uint32_t index;
+
+        if (observe_heap_index_get(p_current_resource, &index))
         {
-            p_current_resource->expire_time = p_current_resource->max_age;
-            
-            (void)internal_observer_notify(p_current_resource);
+            return NRF_SUCCESS;
         }
-        else
+
+        if (m_observe_heap_count == COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES)
         {
-            p_current_resource->expire_time--;
+            return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
         }
+
+        m_observe_heap[m_observe_heap_count].deadline   = m_observe_tick;
+        m_observe_heap[m_observe_heap_count].p_resource = p_current_resource;
+        observe_heap_sift_up(m_observe_heap_count++);
     }
     
     return err_code;
@@ -868,14 +1260,35 @@ static uint32_t coap_observer_process_tick(void)
     
     COAP_MUTEX_LOCK();    
     
-    uint32_t err_code = coap_resource_root_get(&root);
+    m_observe_tick++;
+
+    // The tree is only walked when resources were created or added since the last tick.
+    uint32_t revision = coap_resource_revision_get();
+    if ((revision != m_observe_tree_revision) &&
+        (coap_resource_root_get(&root) == NRF_SUCCESS))
+    {
+        m_observe_tree_revision = revision;
+
+        uint32_t err_code = observe_schedule_add(root);
+        if (err_code != NRF_SUCCESS)
+        {
+            app_error_notify(err_code, NULL);
+        }
+    }
     
-    if (err_code == NRF_SUCCESS)
+    // Only the resources that are due are visited.
+    while ((m_observe_heap_count > 0) &&
+           !observe_deadline_before(m_observe_tick, m_observe_heap[0].deadline))
     {
-        resource_autonotify(root);
+        coap_resource_t * p_resource = m_observe_heap[0].p_resource;
+
+        observe_schedule_restart(p_resource);
+
+        if ((p_resource->permission & COAP_PERM_OBSERVE) > 0)
+        {
+            (void)internal_observer_notify(p_resource);
+        }
     }
-    // If root was not found, we can safely return as there is 
-    // nothing to process.
     
     COAP_MUTEX_UNLOCK();    
 
@@ -890,52 +1303,55 @@ uint32_t coap_time_tick(void)
     coap_transport_process();
     
 #ifdef COAP_AUTOMODE
-    uint32_t err_code = coap_observer_process_tick();
+    UNUSED_VARIABLE(coap_observer_process_tick());
 #endif
     
-    // Loop through the message queue to see if any packets needs retransmission, or has timed out.
-    coap_queue_item_t * p_item = NULL;
-    while (coap_queue_item_next_get(&p_item, p_item) == NRF_SUCCESS)
+    // Handle the messages in the queue which are due for retransmission, or have timed out.
+    coap_queue_item_t * p_item;
+
+    coap_queue_tick();
+
+    while (coap_queue_item_due_get(&p_item) == NRF_SUCCESS)
     {
-        if (p_item->timeout == 0)
-        {                        
-            // If there is still retransmission attempts left.
-            if (p_item->retrans_count < COAP_MAX_RETRANSMIT_COUNT)
-            {
-                p_item->timeout     = p_item->timeout_val * 2;
-                p_item->timeout_val = p_item->timeout;
-                p_item->retrans_count++;
-                
-                // Retransmit the message.
-                uint32_t err_code = coap_transport_write(&p_item->port, &p_item->remote, p_item->p_buffer, p_item->buffer_len);
-                if (err_code != NRF_SUCCESS)
-                {
-                    app_error_notify(err_code, NULL);
-                }
-            }
+        // If there is still retransmission attempts left.
+        if (p_item->retrans_count < COAP_MAX_RETRANSMIT_COUNT)
+        {
+            p_item->timeout     = p_item->timeout_val * 2;
+            p_item->timeout_val = p_item->timeout;
+            p_item->retrans_count++;
             
-            // No more retransmission attempts left, or max transmit span reached.
-            if ((p_item->timeout > COAP_MAX_TRANSMISSION_SPAN) ||
-                (p_item->retrans_count >= COAP_MAX_RETRANSMIT_COUNT))
+            // Retransmit the message.
+            uint32_t err_code = coap_transport_write(&p_item->port, &p_item->remote, p_item->p_buffer, p_item->buffer_len);
+            if (err_code != NRF_SUCCESS)
             {
-                
-                COAP_MUTEX_UNLOCK();    
-                
-                p_item->callback(COAP_TRANSMISSION_TIMEOUT, p_item->p_arg, NULL);
-                
-                COAP_MUTEX_LOCK();
-                
-                COAP_TRC("[COAP]: Free mem, p_item->p_buffer = %p\r\n", p_item->p_buffer);
-                UNUSED_VARIABLE(nrf_free(p_item->p_buffer));
-                
-                (void)coap_queue_remove(p_item);
+                app_error_notify(err_code, NULL);
             }
         }
+        
+        // No more retransmission attempts left, or max transmit span reached.
+        if ((p_item->timeout > COAP_MAX_TRANSMISSION_SPAN) ||
+            (p_item->retrans_count >= COAP_MAX_RETRANSMIT_COUNT))
+        {
+            
+            COAP_MUTEX_UNLOCK();    
+            
+            p_item->callback(COAP_TRANSMISSION_TIMEOUT, p_item->p_arg, NULL);
+            
+            COAP_MUTEX_LOCK();
+            
+            COAP_TRC("[COAP]: Free mem, p_item->p_buffer = %p\r\n", p_item->p_buffer);
+            UNUSED_VARIABLE(nrf_free(p_item->p_buffer));
+            
+            (void)coap_queue_remove(p_item);
+        }
         else
         {
-            p_item->timeout--;
+            (void)coap_queue_item_timeout_set(p_item, p_item->timeout);
         }
     }
+
+    // Compiled away if COAP_ENABLE_BLOCK_TRANSFER is not set to 1.
+    coap_block_time_tick();
     
     COAP_MUTEX_UNLOCK();
     
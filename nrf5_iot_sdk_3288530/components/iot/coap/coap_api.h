@@ -37,6 +37,9 @@
 #define COAP_CT_MASK_APP_OCTET_STREAM    0x10                     /**< Content type Application/octet-stream supported in the endpoint resource. */
 #define COAP_CT_MASK_APP_EXI             0x20                     /**< Content type Application/exi supported in the endpoint resource. */
 #define COAP_CT_MASK_APP_JSON            0x40                     /**< Content type Application/json supported in the endpoint resource. */
+#define COAP_CT_MASK_APP_SENML_JSON      0x80                     /**< Content type Application/senml+json supported in the endpoint resource. */
+#define COAP_CT_MASK_APP_SENML_CBOR      0x100                    /**< Content type Application/senml+cbor supported in the endpoint resource. */
+#define COAP_CT_MASK_APP_LWM2M_TLV       0x200                    /**< Content type Application/vnd.oma.lwm2m+tlv supported in the endpoint resource. */
 /**@} */    
 
 /**@defgroup COAP_METHOD_PERMISSION Resource method permission bitmask values
@@ -137,7 +140,10 @@ typedef enum
     COAP_CT_APP_XML          = 41,                                /**< Application/xml content format number. */
     COAP_CT_APP_OCTET_STREAM = 42,                                /**< Application/octet-stream content format number. */
     COAP_CT_APP_EXI          = 47,                                /**< Application/exi content format number. */
-    COAP_CT_APP_JSON         = 50                                 /**< Application/json content format number. */
+    COAP_CT_APP_JSON         = 50,                                /**< Application/json content format number. */
+    COAP_CT_APP_SENML_JSON   = 110,                               /**< Application/senml+json content format number. */
+    COAP_CT_APP_SENML_CBOR   = 112,                               /**< Application/senml+cbor content format number. */
+    COAP_CT_APP_LWM2M_TLV    = 11542                              /**< Application/vnd.oma.lwm2m+tlv content format number. */
 } coap_content_type_t;
 
 /**@brief Enumeration of CoAP options numbers. */
@@ -259,10 +265,14 @@ struct coap_resource_t
     coap_resource_t *        p_sibling;                           /**< Sibling pointer to the next element in the list. */
     coap_resource_t *        p_front;                             /**< Pointer to the beginning of the linked list. */
     coap_resource_t *        p_tail;                              /**< Pointer to the last added child in the list. */
+    coap_resource_t *        p_parent;                            /**< Internal. Pointer to the parent resource. Set when the resource is added as a child. */
+    coap_resource_t *        p_hash_next;                         /**< Internal. Next resource in the same bucket of the resource lookup table. */
     coap_method_callback_t   callback;                            /**< Callback to the resource handler. */
     uint32_t                 ct_support_mask;                     /**< Bitmask to tell which content types are supported by the resource. Bit values available can be seen in \ref COAP_CONTENT_TYPE_MASK. */
     uint32_t                 max_age;                             /**< Max age of resource endpoint value. */
-    uint32_t                 expire_time;                         /**< Number of seconds until expire. */
+    uint32_t                 expire_time;                         /**< Number of seconds until expire. In auto-mode, updated when a notification is sent and when a request is handed to the callback. */
+    uint16_t                 observe_heap_index;                  /**< Internal. Position of the resource in the schedule of automatic notifications, plus one. Zero if not scheduled. */
+    uint16_t                 name_len;                            /**< Internal. Length of the name of the resource. */
     char                     name[COAP_RESOURCE_MAX_NAME_LEN+1];  /**< Name of the resource. Must be zero terminated. */
 };
 
@@ -373,6 +383,23 @@ uint32_t coap_message_payload_set(coap_message_t * p_message,
                                   void *           p_payload, 
                                   uint16_t         payload_len);
 
+/**@brief Get the buffer where the payload of a CoAP message is placed.
+ *
+ * @details Lets the payload be encoded in place instead of copied in. Once encoded, the payload
+ *          is set by calling @ref coap_message_payload_set with the returned buffer, which is
+ *          then not copied. The buffer is only valid until another option is added.
+ *
+ * @param[in]  p_message     Pointer to the message. Should not be NULL.
+ * @param[out] pp_buffer     Pointer to the payload buffer of the message. Should not be NULL.
+ * @param[out] p_buffer_len  Number of bytes available for the payload. Should not be NULL.
+ *
+ * @retval NRF_SUCCESS    If the buffer was returned.
+ * @retval NRF_ERROR_NULL If one of the parameters was a NULL pointer.
+ */
+uint32_t coap_message_payload_buffer_get(coap_message_t * p_message,
+                                         uint8_t **       pp_buffer,
+                                         uint16_t *       p_buffer_len);
+
 /**@brief Adds an empty CoAP option to the message.
  * 
  * Option numbers must be in ascending order, adding the one with the smallest number
@@ -496,9 +523,13 @@ uint32_t coap_resource_child_add(coap_resource_t * p_parent, coap_resource_t * p
  *          The result will be resources listed in link-format. This function can be called when 
  *          all resources have been added by the application. 
  *
+ *          The generated string is cached if COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE is not 0, and
+ *          copied from the cache until a resource is created or added. Changing the permission
+ *          of a resource that is already added is not detected.
+ *
  * @param[inout] string Buffer to use for the .well-known/core string. Should not be NULL.
  * @param[inout] length Length of the string buffer. Returns the used number of bytes from
- *                      the provided buffer.
+ *                      the provided buffer, excluding the zero termination.
  * 
  * @retval NRF_SUCCESS             If string generation was successful.
  * @retval NRF_ERROR_NULL          If the string buffer was a NULL pointer.
@@ -564,6 +595,41 @@ uint32_t coap_message_ct_match_select(coap_content_type_t * p_ct, coap_message_t
  */
 uint32_t coap_time_tick(void);
 
+#ifdef COAP_AUTOMODE
+
+/**@brief Send a notification with the current value of a resource to all its observers.
+ *
+ * @details The value is rendered once for each content type in use among the observers. All
+ *          observers notified share the same Observe sequence number.
+ *
+ * @param[in] p_resource Pointer to the observed resource. Should not be NULL.
+ *
+ * @retval NRF_SUCCESS If the notification was sent to all observers. Otherwise, an error code
+ *                     that indicates the reason for the failure is returned.
+ */
+uint32_t coap_observer_notify(coap_resource_t * p_resource);
+
+/**@brief Set the payload of a notification of an observable resource, in auto-mode.
+ *
+ * @details Called once for each content type in use among the observers of the resource. The
+ *          Observe and Max-Age options have already been added to the notification.
+ *
+ * @warning This is an interface function. MUST BE IMPLEMENTED BY APPLICATION.
+ *
+ * @param[in]    p_resource Pointer to the observed resource.
+ * @param[in]    ct         Content type requested by the observers.
+ * @param[inout] p_response Pointer to the notification. The payload should be set with
+ *                          coap_message_payload_set.
+ *
+ * @retval NRF_SUCCESS If the payload was set. Otherwise, no notification is sent to the observers
+ *                     using the content type.
+ */
+uint32_t coap_resource_observe_payload_set(coap_resource_t     * p_resource,
+                                           coap_content_type_t   ct,
+                                           coap_message_t      * p_response);
+
+#endif // COAP_AUTOMODE
+
 /**@brief Setup secure DTLS session.
  * 
  * @details For the client role, this API triggers a DTLS handshake. Until the handshake is complete 
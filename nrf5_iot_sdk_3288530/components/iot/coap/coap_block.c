@@ -12,8 +12,12 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
+#include "coap.h"
 #include "coap_block.h"
+#include "coap_option.h"
+#include "nordic_common.h"
 #include "nrf_error.h"
 #include "iot_errors.h"
 #include "sdk_config.h"
@@ -150,3 +154,1117 @@ uint32_t coap_block_opt_block1_decode(coap_block_opt_block1_t * p_opt, uint32_t
     
     return NRF_SUCCESS;
 }
+
+
+#if (COAP_ENABLE_BLOCK_TRANSFER == 1)
+
+#define BLOCK_OPTIONS_MAX_LEN     8                                        /**< Largest option values added to a block request or response: Block (3 bytes), Size (4 bytes) and Content-Format (1 byte). */
+
+#if ((COAP_BLOCK_SIZE_PREFERRED + BLOCK_OPTIONS_MAX_LEN) > COAP_MESSAGE_DATA_MAX_SIZE)
+#error "COAP_BLOCK_SIZE_PREFERRED blocks do not fit in COAP_MESSAGE_DATA_MAX_SIZE."
+#endif
+
+#define BLOCK_TOKEN_LEN           4                                        /**< Length of the tokens of client requests. */
+#define BLOCK_SIZE_MIN            16                                       /**< Smallest block size, in bytes. */
+
+/**@brief Number of ticks a completed server upload is kept: EXCHANGE_LIFETIME of RFC 7252, with a
+ *        MAX_LATENCY of 100 seconds and a PROCESSING_DELAY of COAP_ACK_TIMEOUT. */
+#define BLOCK_EXCHANGE_LIFETIME   (COAP_MAX_TRANSMISSION_SPAN + (2 * 100) + COAP_ACK_TIMEOUT)
+
+#define HASH_FNV_OFFSET_BASIS     2166136261UL                             /**< FNV-1a 32-bit offset basis. */
+#define HASH_FNV_PRIME            16777619UL                               /**< FNV-1a 32-bit prime. */
+
+/**@brief Encode the index and generation of a transfer as the argument of its requests. */
+#define TRANSFER_ARG(INDEX, GENERATION)  ((void *)(uintptr_t)(((uint32_t)(GENERATION) << 8) | (INDEX)))
+
+/**@brief Transfer states. */
+typedef enum
+{
+    TRANSFER_STATE_FREE,                                                   /**< Entry not in use. */
+    TRANSFER_STATE_SERVER_UPLOAD,                                          /**< Server reassembling a Block1 request. */
+    TRANSFER_STATE_SERVER_UPLOAD_DONE,                                     /**< Server upload completed, kept to respond to retransmissions of the last block. */
+    TRANSFER_STATE_CLIENT_UPLOAD,                                          /**< Client sending a Block1 request. */
+    TRANSFER_STATE_CLIENT_DOWNLOAD                                         /**< Client requesting Block2 responses. */
+} transfer_state_t;
+
+/**@brief Block-wise transfer in progress. */
+typedef struct
+{
+    uint8_t                 state;                                         /**< State of the transfer, see transfer_state_t. */
+    uint8_t                 generation;                                    /**< Incremented whenever the entry is freed, to ignore responses to requests of previous transfers. */
+    uint8_t                 in_flight;                                     /**< Client download: number of requests sent and not responded yet. */
+    uint8_t                 final_code;                                    /**< Completed server upload: code of the final response. */
+    bool                    last_received;                                 /**< Client download: the block with the more bit unset has been received. */
+    uint16_t                size;                                          /**< Block size in bytes. */
+    uint16_t                idle_ticks;                                    /**< Number of ticks since the last progress. */
+    uint32_t                number;                                        /**< Client: next block to request, or block in flight for an upload. */
+    uint32_t                total_blocks;                                  /**< Client download: number of blocks of the resource, 0 until known. */
+    uint32_t                blocks_done;                                   /**< Client download: number of blocks written. */
+    uint32_t                offset;                                        /**< Number of bytes transferred. For a server upload, offset of the next block expected. */
+    uint32_t                key;                                           /**< Server upload: hash of the URI of the request. */
+    coap_remote_t           remote;                                        /**< Server upload: remote sending the request. */
+    coap_message_t        * p_template;                                    /**< Client: template of the requests. */
+    iot_file_t            * p_file;                                        /**< File read from or written to. */
+    coap_block_callback_t   callback;                                      /**< Callback notifying the end of the transfer. */
+    void                  * p_arg;                                         /**< Miscellaneous pointer passed to the callback. */
+} block_transfer_t;
+
+/**@brief Option added to a client request, on top of the options of the template. */
+typedef struct
+{
+    uint16_t                number;                                        /**< Option number. */
+    uint32_t                value;                                         /**< Option value. */
+} block_option_t;
+
+static block_transfer_t m_transfers[COAP_BLOCK_MAX_TRANSFERS];             /**< Table of transfers. */
+static uint32_t         m_token_counter;                                   /**< Counter generating the tokens of client requests. */
+
+
+static bool is_success(uint8_t code)
+{
+    return ((code >> 5) == 2);
+}
+
+
+static bool is_block_option(uint16_t number)
+{
+    return ((number == COAP_OPT_BLOCK2) || (number == COAP_OPT_BLOCK1) ||
+            (number == COAP_OPT_SIZE2)  || (number == COAP_OPT_SIZE1));
+}
+
+
+/**@brief Read the value of an unsigned integer option of a received message. */
+static uint32_t uint_opt_get(uint32_t * p_value, coap_message_t * p_message, uint16_t option)
+{
+    uint8_t  index;
+    uint32_t err_code = coap_message_opt_index_get(&index, p_message, option);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    if (p_message->options[index].length == 0)
+    {
+        *p_value = 0;
+        return NRF_SUCCESS;
+    }
+
+    return coap_opt_uint_decode(p_value,
+                                p_message->options[index].length,
+                                p_message->options[index].p_data);
+}
+
+
+/**@brief Read a Block1 or Block2 option of a received message. Both share the same encoding. */
+static uint32_t block_opt_get(coap_block_opt_block1_t * p_block,
+                              coap_message_t          * p_message,
+                              uint16_t                  option)
+{
+    uint32_t value;
+    uint32_t err_code = uint_opt_get(&value, p_message, option);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return coap_block_opt_block1_decode(p_block, value);
+}
+
+
+static uint32_t block_opt_add(coap_message_t * p_message,
+                              uint16_t         option,
+                              uint32_t         number,
+                              uint8_t          more,
+                              uint16_t         size)
+{
+    coap_block_opt_block1_t block =
+    {
+        .more   = more,
+        .size   = size,
+        .number = number
+    };
+
+    uint32_t value;
+    uint32_t err_code = coap_block_opt_block1_encode(&value, &block);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return coap_message_opt_uint_add(p_message, option, value);
+}
+
+
+/**@brief Hash the URI-Path and URI-Query options of a request with FNV-1a. */
+static uint32_t uri_hash(coap_message_t * p_request)
+{
+    uint32_t hash = HASH_FNV_OFFSET_BASIS;
+
+    for (uint32_t index = 0; index < p_request->options_count; index++)
+    {
+        coap_option_t * p_option = &p_request->options[index];
+
+        if ((p_option->number == COAP_OPT_URI_PATH) || (p_option->number == COAP_OPT_URI_QUERY))
+        {
+            // The option number separates the segments, so that "a/bc" and "ab/c" differ.
+            hash = (hash ^ p_option->number) * HASH_FNV_PRIME;
+
+            for (uint32_t byte = 0; byte < p_option->length; byte++)
+            {
+                hash = (hash ^ p_option->p_data[byte]) * HASH_FNV_PRIME;
+            }
+        }
+    }
+
+    return hash;
+}
+
+
+/**@brief Allocate a transfer. Without a free entry, the oldest completed server upload is
+ *        reused.
+ */
+static block_transfer_t * transfer_alloc(void)
+{
+    block_transfer_t * p_transfer = NULL;
+
+    for (uint32_t index = 0; index < COAP_BLOCK_MAX_TRANSFERS; index++)
+    {
+        if (m_transfers[index].state == TRANSFER_STATE_FREE)
+        {
+            p_transfer = &m_transfers[index];
+            break;
+        }
+
+        if ((m_transfers[index].state == TRANSFER_STATE_SERVER_UPLOAD_DONE) &&
+            ((p_transfer == NULL) || (m_transfers[index].idle_ticks > p_transfer->idle_ticks)))
+        {
+            p_transfer = &m_transfers[index];
+        }
+    }
+
+    if (p_transfer != NULL)
+    {
+        uint8_t generation = p_transfer->generation;
+
+        memset(p_transfer, 0, sizeof(block_transfer_t));
+        p_transfer->generation = generation;
+    }
+
+    return p_transfer;
+}
+
+
+static void transfer_free(block_transfer_t * p_transfer)
+{
+    p_transfer->state = TRANSFER_STATE_FREE;
+    p_transfer->generation++;
+}
+
+
+/**@brief Free a transfer and notify its end.
+ *
+ * @details The entry is freed before the callback, so that the callback can start a new transfer.
+ */
+static coap_msg_code_t transfer_end(block_transfer_t * p_transfer,
+                                    coap_block_evt_t   evt,
+                                    uint32_t           result,
+                                    coap_message_t   * p_message)
+{
+    coap_block_callback_t callback = p_transfer->callback;
+
+    transfer_free(p_transfer);
+
+    if (callback == NULL)
+    {
+        return (evt == COAP_BLOCK_EVT_ABORTED) ? COAP_CODE_500_INTERNAL_SERVER_ERROR
+                                               : COAP_CODE_204_CHANGED;
+    }
+
+    return callback(evt, result, p_transfer->p_arg, p_transfer->p_file, p_transfer->offset, p_message);
+}
+
+
+/**@brief Read a block from the file into the payload of a message, after its options. */
+static uint32_t payload_read(coap_message_t * p_message,
+                             iot_file_t     * p_file,
+                             uint32_t         offset,
+                             uint16_t         length)
+{
+    if ((p_message->data_len - p_message->options_offset) < length)
+    {
+        return (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE);
+    }
+
+    p_message->p_payload   = &p_message->p_data[p_message->options_offset];
+    p_message->payload_len = length;
+
+    if (length == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    uint32_t err_code = iot_file_fseek(p_file, offset);
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = iot_file_fread(p_file, p_message->p_payload, length);
+    }
+
+    return err_code;
+}
+
+
+/**@brief Write the payload of a message to the file at the given offset. */
+static uint32_t payload_write(coap_message_t * p_message, iot_file_t * p_file, uint32_t offset)
+{
+    if (p_message->payload_len == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    uint32_t err_code = iot_file_fseek(p_file, offset);
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = iot_file_fwrite(p_file, p_message->p_payload, p_message->payload_len);
+    }
+
+    return err_code;
+}
+
+
+/**@brief Create a response to a request, piggybacked on the ACK of a confirmable request. */
+static uint32_t response_new(coap_message_t ** pp_response, coap_message_t * p_request)
+{
+    coap_message_conf_t config;
+    memset(&config, 0, sizeof(coap_message_conf_t));
+
+    config.token_len        = p_request->header.token_len;
+    config.id               = p_request->header.id;
+    config.code             = COAP_CODE_500_INTERNAL_SERVER_ERROR;
+    config.port.port_number = p_request->port.port_number;
+
+    memcpy(config.token, p_request->token, p_request->header.token_len);
+
+    if ((coap_msg_type_t)p_request->header.type == COAP_TYPE_CON)
+    {
+        config.type = COAP_TYPE_ACK;
+    }
+    else
+    {
+        config.type = (coap_msg_type_t)p_request->header.type;
+    }
+
+    uint32_t err_code = coap_message_new(pp_response, &config);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return coap_message_remote_addr_set(*pp_response, &p_request->remote);
+}
+
+
+/**@brief Check if a block could not be put in a response, or the response not be sent, for lack
+ *        of room in the message or in the Memory Manager.
+ */
+static bool is_block_too_large(uint32_t err_code)
+{
+    return ((err_code == (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE))         ||
+            (err_code == (NRF_ERROR_NO_MEM | MEMORY_MANAGER_ERR_BASE))      ||
+            (err_code == (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE)));
+}
+
+
+/**@brief Respond to a GET request with the block it asks for.
+ *
+ * @param[in]  p_response Response to fill in.
+ * @param[in]  p_request  Request received.
+ * @param[in]  p_conf     Configuration of the resource.
+ * @param[in]  max_size   Largest block size to respond with.
+ * @param[out] p_last     Set to true if the response holds the last block.
+ *
+ * @retval NRF_SUCCESS                                If the response was filled in.
+ * @retval (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE)  If the block does not fit in the response.
+ */
+static uint32_t server_download_handle(coap_message_t                 * p_response,
+                                       coap_message_t                 * p_request,
+                                       const coap_block_server_conf_t * p_conf,
+                                       uint16_t                         max_size,
+                                       bool                           * p_last)
+{
+    const uint32_t          file_size = p_conf->p_file->file_size;
+    coap_block_opt_block1_t block2;
+    uint32_t                offset    = 0;
+    uint16_t                size      = max_size;
+
+    if (block_opt_get(&block2, p_request, COAP_OPT_BLOCK2) == NRF_SUCCESS)
+    {
+        // A smaller block size asked for by the client is adopted. The offset is kept if the
+        // size is reduced by the server.
+        offset = block2.number * block2.size;
+        size   = MIN(block2.size, max_size);
+    }
+
+    if ((offset > 0) && (offset >= file_size))
+    {
+        p_response->header.code = COAP_CODE_402_BAD_OPTION;
+        return NRF_SUCCESS;
+    }
+
+    const uint16_t length = (uint16_t)MIN(size, file_size - offset);
+    const uint8_t  more   = ((offset + length) < file_size) ? COAP_BLOCK_OPT_BLOCK_MORE_BIT_SET
+                                                            : COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+
+    uint32_t err_code = coap_message_opt_uint_add(p_response,
+                                                  COAP_OPT_CONTENT_FORMAT,
+                                                  p_conf->content_format);
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = block_opt_add(p_response, COAP_OPT_BLOCK2, offset / size, more, size);
+    }
+
+    // The size of the representation lets the client keep several requests in flight.
+    if ((err_code == NRF_SUCCESS) && (offset == 0))
+    {
+        err_code = coap_message_opt_uint_add(p_response, COAP_OPT_SIZE2, file_size);
+    }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = payload_read(p_response, p_conf->p_file, offset, length);
+    }
+
+    if ((err_code == (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE)) && (size > BLOCK_SIZE_MIN))
+    {
+        return err_code;
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        p_response->header.code = COAP_CODE_500_INTERNAL_SERVER_ERROR;
+        p_response->payload_len = 0;
+        return NRF_SUCCESS;
+    }
+
+    p_response->header.code = COAP_CODE_205_CONTENT;
+    *p_last                 = (more == COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET);
+
+    return NRF_SUCCESS;
+}
+
+
+static block_transfer_t * server_upload_find(const coap_remote_t * p_remote, uint32_t key)
+{
+    for (uint32_t index = 0; index < COAP_BLOCK_MAX_TRANSFERS; index++)
+    {
+        block_transfer_t * p_transfer = &m_transfers[index];
+
+        if (((p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD) ||
+             (p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD_DONE)) &&
+            (p_transfer->key == key) &&
+            (p_transfer->remote.port_number == p_remote->port_number) &&
+            (memcmp(p_transfer->remote.addr, p_remote->addr, sizeof(p_remote->addr)) == 0))
+        {
+            return p_transfer;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Notify the completion of a server upload.
+ *
+ * @details The transfer is kept for EXCHANGE_LIFETIME, so that a retransmission of the last block,
+ *          whose response was lost, is answered with the same final response rather than 4.08.
+ *
+ * @return Code of the final response.
+ */
+static coap_msg_code_t server_upload_complete(block_transfer_t * p_transfer, coap_message_t * p_request)
+{
+    coap_msg_code_t code = COAP_CODE_204_CHANGED;
+
+    p_transfer->state      = TRANSFER_STATE_SERVER_UPLOAD_DONE;
+    p_transfer->idle_ticks = 0;
+
+    if (p_transfer->callback != NULL)
+    {
+        code = p_transfer->callback(COAP_BLOCK_EVT_UPLOAD_COMPLETE,
+                                    NRF_SUCCESS,
+                                    p_transfer->p_arg,
+                                    p_transfer->p_file,
+                                    p_transfer->offset,
+                                    p_request);
+    }
+
+    // The entry may have been reused by a transfer started from the callback.
+    if (p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD_DONE)
+    {
+        p_transfer->final_code = (uint8_t)code;
+    }
+
+    return code;
+}
+
+
+/**@brief Write a block of a PUT or POST request to the file and fill in the response. */
+static uint32_t server_upload_handle(coap_message_t                 * p_response,
+                                     coap_message_t                 * p_request,
+                                     const coap_block_server_conf_t * p_conf)
+{
+    coap_block_opt_block1_t block1;
+    bool                    blockwise = true;
+
+    if (block_opt_get(&block1, p_request, COAP_OPT_BLOCK1) != NRF_SUCCESS)
+    {
+        // A request without Block1 option carries the whole body.
+        blockwise     = false;
+        block1.number = 0;
+        block1.more   = COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+        block1.size   = COAP_BLOCK_SIZE_PREFERRED;
+    }
+
+    const uint32_t     key        = uri_hash(p_request);
+    const uint32_t     offset     = block1.number * block1.size;
+    block_transfer_t * p_transfer = server_upload_find(&p_request->remote, key);
+
+    if (block1.number == 0)
+    {
+        // The first block (re)starts the transfer.
+        if (p_transfer == NULL)
+        {
+            p_transfer = transfer_alloc();
+            if (p_transfer == NULL)
+            {
+                p_response->header.code = COAP_CODE_503_SERVICE_UNAVAILABLE;
+                return NRF_SUCCESS;
+            }
+        }
+
+        p_transfer->state    = TRANSFER_STATE_SERVER_UPLOAD;
+        p_transfer->key      = key;
+        p_transfer->offset   = 0;
+        p_transfer->p_file   = p_conf->p_file;
+        p_transfer->callback = p_conf->callback;
+        p_transfer->p_arg    = p_conf->p_arg;
+        memcpy(&p_transfer->remote, &p_request->remote, sizeof(coap_remote_t));
+
+        uint32_t total_size;
+        if ((uint_opt_get(&total_size, p_request, COAP_OPT_SIZE1) == NRF_SUCCESS) &&
+            (p_conf->p_file->buffer_size != 0) &&
+            (total_size > p_conf->p_file->buffer_size))
+        {
+            transfer_free(p_transfer);
+
+            p_response->header.code = COAP_CODE_413_REQUEST_ENTITY_TOO_LARGE;
+            return coap_message_opt_uint_add(p_response, COAP_OPT_SIZE1, p_conf->p_file->buffer_size);
+        }
+    }
+    else if (p_transfer == NULL)
+    {
+        p_response->header.code = COAP_CODE_408_REQUEST_ENTITY_INCOMPLETE;
+        return NRF_SUCCESS;
+    }
+
+    const uint16_t size = MIN(block1.size, COAP_BLOCK_SIZE_PREFERRED);
+
+    if (offset < p_transfer->offset)
+    {
+        // Retransmission of a block already written, its acknowledgement was lost. The last block
+        // of a completed upload is answered with the final response again.
+        if ((p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD_DONE) &&
+            (block1.more == COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET))
+        {
+            p_response->header.code = p_transfer->final_code;
+        }
+        else
+        {
+            p_response->header.code = COAP_CODE_231_CONTINUE;
+        }
+
+        return block_opt_add(p_response, COAP_OPT_BLOCK1, block1.number, block1.more, size);
+    }
+
+    if ((offset > p_transfer->offset) || (p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD_DONE))
+    {
+        p_response->header.code = COAP_CODE_408_REQUEST_ENTITY_INCOMPLETE;
+        return NRF_SUCCESS;
+    }
+
+    if ((block1.more == COAP_BLOCK_OPT_BLOCK_MORE_BIT_SET) && (p_request->payload_len != block1.size))
+    {
+        transfer_free(p_transfer);
+
+        p_response->header.code = COAP_CODE_400_BAD_REQUEST;
+        return NRF_SUCCESS;
+    }
+
+    uint32_t err_code = payload_write(p_request, p_transfer->p_file, offset);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, err_code, p_request);
+
+        p_response->header.code = COAP_CODE_413_REQUEST_ENTITY_TOO_LARGE;
+        return NRF_SUCCESS;
+    }
+
+    p_transfer->offset     += p_request->payload_len;
+    p_transfer->idle_ticks  = 0;
+
+    if (block1.more == COAP_BLOCK_OPT_BLOCK_MORE_BIT_SET)
+    {
+        p_response->header.code = COAP_CODE_231_CONTINUE;
+    }
+    else if (blockwise)
+    {
+        p_response->header.code = server_upload_complete(p_transfer, p_request);
+    }
+    else
+    {
+        p_response->header.code = transfer_end(p_transfer, COAP_BLOCK_EVT_UPLOAD_COMPLETE, NRF_SUCCESS, p_request);
+    }
+
+    if (!blockwise)
+    {
+        return NRF_SUCCESS;
+    }
+
+    return block_opt_add(p_response, COAP_OPT_BLOCK1, block1.number, block1.more, size);
+}
+
+
+uint32_t coap_block_server_request_handle(coap_message_t                 * p_request,
+                                          const coap_block_server_conf_t * p_conf)
+{
+    NULL_PARAM_CHECK(p_request);
+    NULL_PARAM_CHECK(p_conf);
+    NULL_PARAM_CHECK(p_conf->p_file);
+
+    if ((p_request->header.code != COAP_CODE_GET) &&
+        (p_request->header.code != COAP_CODE_PUT) &&
+        (p_request->header.code != COAP_CODE_POST))
+    {
+        return (NRF_ERROR_NOT_SUPPORTED | IOT_COAP_ERR_BASE);
+    }
+
+    uint32_t err_code;
+    uint16_t max_size = COAP_BLOCK_SIZE_PREFERRED;
+    bool     last;
+
+    do
+    {
+        coap_message_t * p_response;
+        err_code = response_new(&p_response, p_request);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+
+        last = false;
+
+        if (p_request->header.code == COAP_CODE_GET)
+        {
+            err_code = server_download_handle(p_response, p_request, p_conf, max_size, &last);
+        }
+        else
+        {
+            err_code = server_upload_handle(p_response, p_request, p_conf);
+        }
+
+        if (err_code == NRF_SUCCESS)
+        {
+            uint32_t handle;
+            err_code = coap_message_send(&handle, p_response);
+        }
+
+        (void)coap_message_delete(p_response);
+
+        // A block that does not fit is served again with a smaller block size, that the client
+        // adopts for the rest of the download.
+        max_size >>= 1;
+    } while ((p_request->header.code == COAP_CODE_GET) &&
+             is_block_too_large(err_code)              &&
+             (max_size >= BLOCK_SIZE_MIN));
+
+    if ((err_code == NRF_SUCCESS) && last && (p_conf->callback != NULL))
+    {
+        (void)p_conf->callback(COAP_BLOCK_EVT_DOWNLOAD_COMPLETE,
+                               NRF_SUCCESS,
+                               p_conf->p_arg,
+                               p_conf->p_file,
+                               p_conf->p_file->file_size,
+                               p_request);
+    }
+
+    return err_code;
+}
+
+
+static void client_response_handle(uint32_t status, void * p_arg, coap_message_t * p_response);
+
+
+/**@brief Add the options of the template to a request, merged in ascending order with the
+ *        options of the transfer.
+ *
+ * @details Options of the template are stored as deltas, the absolute number being the sum of
+ *          the deltas. Block and Size options of the template are replaced by the ones of the
+ *          transfer.
+ */
+static uint32_t request_options_add(coap_message_t       * p_request,
+                                    coap_message_t       * p_template,
+                                    const block_option_t * p_options,
+                                    uint32_t               option_count)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    uint32_t added    = 0;
+    uint16_t number   = 0;
+
+    for (uint32_t index = 0; (index < p_template->options_count) && (err_code == NRF_SUCCESS); index++)
+    {
+        coap_option_t * p_option = &p_template->options[index];
+
+        number += p_option->number;
+
+        while ((added < option_count) && (p_options[added].number < number) && (err_code == NRF_SUCCESS))
+        {
+            err_code = coap_message_opt_uint_add(p_request, p_options[added].number, p_options[added].value);
+            added++;
+        }
+
+        if ((err_code == NRF_SUCCESS) && !is_block_option(number))
+        {
+            err_code = coap_message_opt_opaque_add(p_request, number, p_option->p_data, p_option->length);
+        }
+    }
+
+    while ((added < option_count) && (err_code == NRF_SUCCESS))
+    {
+        err_code = coap_message_opt_uint_add(p_request, p_options[added].number, p_options[added].value);
+        added++;
+    }
+
+    return err_code;
+}
+
+
+/**@brief Send the request of a client transfer for the given block. */
+static uint32_t client_request_send(block_transfer_t * p_transfer, uint32_t number)
+{
+    coap_message_t * p_template = p_transfer->p_template;
+    block_option_t   options[2];
+    uint32_t         option_count = 0;
+    uint32_t         offset       = number * p_transfer->size;
+    uint16_t         length       = 0;
+    uint8_t          more         = COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+
+    coap_block_opt_block1_t block =
+    {
+        .size   = p_transfer->size,
+        .number = number
+    };
+
+    if (p_transfer->state == TRANSFER_STATE_CLIENT_DOWNLOAD)
+    {
+        block.more = COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+        options[option_count].number = COAP_OPT_BLOCK2;
+        option_count++;
+
+        if (number == 0)
+        {
+            // Ask for the size of the resource, to open the window.
+            options[option_count].number = COAP_OPT_SIZE2;
+            options[option_count].value  = 0;
+            option_count++;
+        }
+    }
+    else
+    {
+        const uint32_t file_size = p_transfer->p_file->file_size;
+
+        length     = (uint16_t)MIN(p_transfer->size, file_size - MIN(offset, file_size));
+        more       = ((offset + length) < file_size) ? COAP_BLOCK_OPT_BLOCK_MORE_BIT_SET
+                                                     : COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+        block.more = more;
+        options[option_count].number = COAP_OPT_BLOCK1;
+        option_count++;
+
+        if (number == 0)
+        {
+            options[option_count].number = COAP_OPT_SIZE1;
+            options[option_count].value  = file_size;
+            option_count++;
+        }
+    }
+
+    uint32_t err_code = coap_block_opt_block1_encode(&options[0].value, &block);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    coap_message_conf_t config;
+    memset(&config, 0, sizeof(coap_message_conf_t));
+
+    config.type              = (coap_msg_type_t)p_template->header.type;
+    config.code              = (coap_msg_code_t)p_template->header.code;
+    config.port              = p_template->port;
+    config.response_callback = client_response_handle;
+    config.token_len         = BLOCK_TOKEN_LEN;
+
+    m_token_counter++;
+    config.token[0] = (uint8_t)(m_token_counter >> 24);
+    config.token[1] = (uint8_t)(m_token_counter >> 16);
+    config.token[2] = (uint8_t)(m_token_counter >> 8);
+    config.token[3] = (uint8_t)(m_token_counter);
+
+    coap_message_t * p_request;
+    err_code = coap_message_new(&p_request, &config);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    (void)coap_message_remote_addr_set(p_request, &p_template->remote);
+    p_request->p_arg = TRANSFER_ARG(p_transfer - m_transfers, p_transfer->generation);
+
+    err_code = request_options_add(p_request, p_template, options, option_count);
+
+    if ((err_code == NRF_SUCCESS) && (p_transfer->state == TRANSFER_STATE_CLIENT_UPLOAD))
+    {
+        err_code = payload_read(p_request, p_transfer->p_file, offset, length);
+    }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        uint32_t handle;
+        err_code = coap_message_send(&handle, p_request);
+    }
+
+    (void)coap_message_delete(p_request);
+
+    return err_code;
+}
+
+
+/**@brief Request blocks of a download until the window is full, or the last block requested.
+ *
+ * @details The window opens once the number of blocks is known from the Size2 option.
+ *          Otherwise, each block is requested once the previous one has been received.
+ */
+static uint32_t client_download_window_fill(block_transfer_t * p_transfer)
+{
+    const uint32_t window = (p_transfer->total_blocks != 0) ? COAP_BLOCK_WINDOW_SIZE : 1;
+
+    while ((p_transfer->in_flight < window) &&
+           ((p_transfer->total_blocks == 0) || (p_transfer->number < p_transfer->total_blocks)))
+    {
+        uint32_t err_code = client_request_send(p_transfer, p_transfer->number);
+        if (err_code != NRF_SUCCESS)
+        {
+            // The window shrinks if the message queue is full, as long as a request is in flight.
+            return (p_transfer->in_flight == 0) ? err_code : NRF_SUCCESS;
+        }
+
+        p_transfer->number++;
+        p_transfer->in_flight++;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+static void client_download_handle(block_transfer_t * p_transfer, coap_message_t * p_response)
+{
+    coap_block_opt_block1_t block2;
+
+    p_transfer->in_flight--;
+
+    if (!is_success(p_response->header.code) && p_transfer->last_received)
+    {
+        // Requests past the end of a resource smaller than announced are rejected by the server,
+        // the transfer completes with the blocks still in flight.
+        if (p_transfer->in_flight == 0)
+        {
+            (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE), p_response);
+        }
+        return;
+    }
+
+    if (!is_success(p_response->header.code))
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE), p_response);
+        return;
+    }
+
+    if (block_opt_get(&block2, p_response, COAP_OPT_BLOCK2) != NRF_SUCCESS)
+    {
+        // The server sent the whole representation at once.
+        block2.number = 0;
+        block2.more   = COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET;
+        block2.size   = p_transfer->size;
+    }
+
+    if ((block2.number == 0) && (p_transfer->blocks_done == 0))
+    {
+        uint32_t total_size;
+
+        // The server may reduce the block size in its first response.
+        if (block2.size < p_transfer->size)
+        {
+            p_transfer->size = block2.size;
+        }
+
+        if ((uint_opt_get(&total_size, p_response, COAP_OPT_SIZE2) == NRF_SUCCESS) && (total_size != 0))
+        {
+            p_transfer->total_blocks = (total_size + p_transfer->size - 1) / p_transfer->size;
+        }
+    }
+
+    if (block2.size != p_transfer->size)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE), p_response);
+        return;
+    }
+
+    const uint32_t offset   = block2.number * block2.size;
+    uint32_t       err_code = payload_write(p_response, p_transfer->p_file, offset);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, err_code, p_response);
+        return;
+    }
+
+    p_transfer->blocks_done++;
+    p_transfer->idle_ticks = 0;
+    p_transfer->offset     = MAX(p_transfer->offset, offset + p_response->payload_len);
+
+    if (block2.more == COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET)
+    {
+        p_transfer->total_blocks  = block2.number + 1;
+        p_transfer->last_received = true;
+    }
+    else if ((p_transfer->total_blocks != 0) && (block2.number + 1 >= p_transfer->total_blocks))
+    {
+        // The resource has grown beyond the size announced.
+        p_transfer->total_blocks = block2.number + 2;
+    }
+
+    if (p_transfer->last_received && (p_transfer->blocks_done >= p_transfer->total_blocks))
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_DOWNLOAD_COMPLETE, NRF_SUCCESS, p_response);
+        return;
+    }
+
+    err_code = client_download_window_fill(p_transfer);
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, err_code, p_response);
+    }
+}
+
+
+static void client_upload_handle(block_transfer_t * p_transfer, coap_message_t * p_response)
+{
+    coap_block_opt_block1_t block1;
+    uint32_t                err_code = NRF_SUCCESS;
+    const bool              has_block1 = (block_opt_get(&block1, p_response, COAP_OPT_BLOCK1) == NRF_SUCCESS);
+
+    if (p_response->header.code == COAP_CODE_231_CONTINUE)
+    {
+        if (!has_block1)
+        {
+            (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE), p_response);
+            return;
+        }
+
+        uint32_t next_offset = (p_transfer->number + 1) * p_transfer->size;
+
+        // The server may ask for smaller blocks, the offset of the next block is kept.
+        if (block1.size < p_transfer->size)
+        {
+            p_transfer->size = block1.size;
+        }
+
+        p_transfer->offset     = next_offset;
+        p_transfer->number     = next_offset / p_transfer->size;
+        p_transfer->idle_ticks = 0;
+
+        err_code = client_request_send(p_transfer, p_transfer->number);
+    }
+    else if (is_success(p_response->header.code))
+    {
+        p_transfer->offset = p_transfer->p_file->file_size;
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_UPLOAD_COMPLETE, NRF_SUCCESS, p_response);
+        return;
+    }
+    else if ((p_response->header.code == COAP_CODE_413_REQUEST_ENTITY_TOO_LARGE) &&
+             (p_transfer->number == 0) && has_block1 && (block1.size < p_transfer->size))
+    {
+        // The first block was too large, restart with the size asked for by the server.
+        p_transfer->size       = block1.size;
+        p_transfer->idle_ticks = 0;
+
+        err_code = client_request_send(p_transfer, 0);
+    }
+    else
+    {
+        err_code = (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE);
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, err_code, p_response);
+    }
+}
+
+
+/**@brief Response callback of the requests of client transfers. */
+static void client_response_handle(uint32_t status, void * p_arg, coap_message_t * p_response)
+{
+    const uint32_t index      = (uint32_t)(uintptr_t)p_arg & 0xFF;
+    const uint8_t  generation = (uint8_t)((uint32_t)(uintptr_t)p_arg >> 8);
+
+    if (index >= COAP_BLOCK_MAX_TRANSFERS)
+    {
+        return;
+    }
+
+    block_transfer_t * p_transfer = &m_transfers[index];
+
+    // Ignore responses to requests of a transfer that has ended.
+    if ((p_transfer->generation != generation) ||
+        ((p_transfer->state != TRANSFER_STATE_CLIENT_DOWNLOAD) &&
+         (p_transfer->state != TRANSFER_STATE_CLIENT_UPLOAD)))
+    {
+        return;
+    }
+
+    if (status != NRF_SUCCESS)
+    {
+        (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, status, p_response);
+        return;
+    }
+
+    // An empty ACK announces a separate response, which is not matched to the request any more.
+    // The transfer times out unless it progresses otherwise.
+    if (p_response->header.code == COAP_CODE_EMPTY_MESSAGE)
+    {
+        return;
+    }
+
+    if (p_transfer->state == TRANSFER_STATE_CLIENT_DOWNLOAD)
+    {
+        client_download_handle(p_transfer, p_response);
+    }
+    else
+    {
+        client_upload_handle(p_transfer, p_response);
+    }
+}
+
+
+uint32_t coap_block_client_start(uint32_t              * p_handle,
+                                 coap_message_t        * p_template,
+                                 iot_file_t            * p_file,
+                                 coap_block_callback_t   callback,
+                                 void                  * p_arg)
+{
+    NULL_PARAM_CHECK(p_handle);
+    NULL_PARAM_CHECK(p_template);
+    NULL_PARAM_CHECK(p_file);
+    NULL_PARAM_CHECK(callback);
+
+    transfer_state_t state;
+
+    switch (p_template->header.code)
+    {
+        case COAP_CODE_GET:
+            state = TRANSFER_STATE_CLIENT_DOWNLOAD;
+            break;
+
+        case COAP_CODE_PUT:
+            // Fall through.
+        case COAP_CODE_POST:
+            state = TRANSFER_STATE_CLIENT_UPLOAD;
+            break;
+
+        default:
+            return (NRF_ERROR_INVALID_PARAM | IOT_COAP_ERR_BASE);
+    }
+
+    block_transfer_t * p_transfer = transfer_alloc();
+    if (p_transfer == NULL)
+    {
+        return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
+    }
+
+    p_transfer->state      = state;
+    p_transfer->size       = COAP_BLOCK_SIZE_PREFERRED;
+    p_transfer->p_template = p_template;
+    p_transfer->p_file     = p_file;
+    p_transfer->callback   = callback;
+    p_transfer->p_arg      = p_arg;
+
+    uint32_t err_code;
+
+    if (state == TRANSFER_STATE_CLIENT_DOWNLOAD)
+    {
+        err_code = client_download_window_fill(p_transfer);
+    }
+    else
+    {
+        err_code = client_request_send(p_transfer, 0);
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        transfer_free(p_transfer);
+        return err_code;
+    }
+
+    *p_handle = (uint32_t)(p_transfer - m_transfers);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_block_transfer_abort(uint32_t handle)
+{
+    if ((handle >= COAP_BLOCK_MAX_TRANSFERS) ||
+        (m_transfers[handle].state == TRANSFER_STATE_FREE))
+    {
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    }
+
+    transfer_free(&m_transfers[handle]);
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_block_time_tick(void)
+{
+    for (uint32_t index = 0; index < COAP_BLOCK_MAX_TRANSFERS; index++)
+    {
+        block_transfer_t * p_transfer = &m_transfers[index];
+
+        if (p_transfer->state == TRANSFER_STATE_SERVER_UPLOAD_DONE)
+        {
+            if (++p_transfer->idle_ticks >= BLOCK_EXCHANGE_LIFETIME)
+            {
+                transfer_free(p_transfer);
+            }
+        }
+        else if ((p_transfer->state != TRANSFER_STATE_FREE) &&
+                 (++p_transfer->idle_ticks >= COAP_BLOCK_TRANSFER_TIMEOUT))
+        {
+            // The callback is called with the module unlocked, as for transmission timeouts.
+            COAP_MUTEX_UNLOCK();
+
+            (void)transfer_end(p_transfer, COAP_BLOCK_EVT_ABORTED, COAP_TRANSMISSION_TIMEOUT, NULL);
+
+            COAP_MUTEX_LOCK();
+        }
+    }
+}
+
+#endif // COAP_ENABLE_BLOCK_TRANSFER
@@ -17,12 +17,31 @@
  * @{
  * @brief CoAP block transfer options encoding and decoding interface and definitions.
  *
+ * @details When COAP_ENABLE_BLOCK_TRANSFER is set to 1, the module also provides a block-wise
+ *          transfer engine (RFC 7959) streaming bodies of any size between the network and an
+ *          IoT file:
+ *          - As a server, @ref coap_block_server_request_handle serves GET requests from the file
+ *            with Block2, and reassembles PUT and POST requests sent with Block1 into the file.
+ *          - As a client, @ref coap_block_client_start downloads a resource into the file with
+ *            Block2, or uploads the file with Block1.
+ *
+ *          The block size is negotiated down from COAP_BLOCK_SIZE_PREFERRED to the size the peer
+ *          asks for. Downloads keep up to COAP_BLOCK_WINDOW_SIZE requests in flight once the
+ *          peer has given the size of the resource in a Size2 option, and run in lockstep
+ *          otherwise. Uploads run in lockstep, as every block waits for the 2.31 Continue of
+ *          the previous one. Transfers without progress for COAP_BLOCK_TRANSFER_TIMEOUT calls to
+ *          @ref coap_time_tick are aborted.
  */
  
 #ifndef COAP_BLOCK_H__
 #define COAP_BLOCK_H__
 
 #include <stdint.h>
+#include "sdk_config.h"
+
+#ifndef COAP_ENABLE_BLOCK_TRANSFER
+#define COAP_ENABLE_BLOCK_TRANSFER           0      /**< Disable the block-wise transfer engine by default. */
+#endif // COAP_ENABLE_BLOCK_TRANSFER
 
 #define COAP_BLOCK_OPT_BLOCK_MORE_BIT_UNSET  0      /**< Value when more flag is set. */
 #define COAP_BLOCK_OPT_BLOCK_MORE_BIT_SET    1      /**< Value when more flag is not set. */
@@ -61,6 +80,153 @@ uint32_t coap_block_opt_block1_encode(uint32_t * p_encoded, coap_block_opt_block
  */
 uint32_t coap_block_opt_block1_decode(coap_block_opt_block1_t * p_opt, uint32_t encoded);
 
+#if (COAP_ENABLE_BLOCK_TRANSFER == 1)
+
+#include "coap_api.h"
+#include "iot_file.h"
+
+#ifndef COAP_BLOCK_MAX_TRANSFERS
+#define COAP_BLOCK_MAX_TRANSFERS             4      /**< Maximum number of block-wise transfers in progress, client and server together. */
+#endif // COAP_BLOCK_MAX_TRANSFERS
+
+#ifndef COAP_BLOCK_WINDOW_SIZE
+#define COAP_BLOCK_WINDOW_SIZE               4      /**< Maximum number of Block2 requests in flight for a download. */
+#endif // COAP_BLOCK_WINDOW_SIZE
+
+#ifndef COAP_BLOCK_SIZE_PREFERRED
+#define COAP_BLOCK_SIZE_PREFERRED            128    /**< Largest block size used, in bytes. Must be a power of two from 16 to 1024. */
+#endif // COAP_BLOCK_SIZE_PREFERRED
+
+#ifndef COAP_BLOCK_TRANSFER_TIMEOUT
+#define COAP_BLOCK_TRANSFER_TIMEOUT          30     /**< Number of calls to coap_time_tick without progress before a transfer is aborted. */
+#endif // COAP_BLOCK_TRANSFER_TIMEOUT
+
+#if (COAP_BLOCK_MAX_TRANSFERS == 0) || (COAP_BLOCK_MAX_TRANSFERS > 255)
+#error "COAP_BLOCK_MAX_TRANSFERS must be between 1 and 255."
+#endif
+
+#if (COAP_BLOCK_WINDOW_SIZE == 0) || (COAP_BLOCK_WINDOW_SIZE > COAP_MESSAGE_QUEUE_SIZE)
+#error "COAP_BLOCK_WINDOW_SIZE must be between 1 and COAP_MESSAGE_QUEUE_SIZE."
+#endif
+
+#if (COAP_BLOCK_SIZE_PREFERRED != 16)  && (COAP_BLOCK_SIZE_PREFERRED != 32)  && \
+    (COAP_BLOCK_SIZE_PREFERRED != 64)  && (COAP_BLOCK_SIZE_PREFERRED != 128) && \
+    (COAP_BLOCK_SIZE_PREFERRED != 256) && (COAP_BLOCK_SIZE_PREFERRED != 512) && \
+    (COAP_BLOCK_SIZE_PREFERRED != 1024)
+#error "COAP_BLOCK_SIZE_PREFERRED must be a power of two from 16 to 1024."
+#endif
+
+/**@brief Block-wise transfer events. */
+typedef enum
+{
+    COAP_BLOCK_EVT_UPLOAD_COMPLETE,                 /**< A body sent with Block1 has been transferred completely. */
+    COAP_BLOCK_EVT_DOWNLOAD_COMPLETE,               /**< A body sent with Block2 has been transferred completely. */
+    COAP_BLOCK_EVT_ABORTED                          /**< The transfer has been aborted. */
+} coap_block_evt_t;
+
+/**@brief Callback notifying the end of a block-wise transfer.
+ *
+ * @param[in] evt       Event being notified.
+ * @param[in] result    NRF_SUCCESS for a completed transfer, otherwise the reason of the abort:
+ *                      COAP_TRANSMISSION_TIMEOUT, COAP_TRANSMISSION_RESET_BY_PEER,
+ *                      NRF_ERROR_INVALID_DATA if the peer responded with an error code or broke
+ *                      the block sequence, or the error returned by the IoT file.
+ * @param[in] p_arg     Miscellaneous pointer given when the transfer was set up.
+ * @param[in] p_file    File the body was read from or written to.
+ * @param[in] size      Number of bytes transferred.
+ * @param[in] p_message Last message received for the transfer. NULL if the transfer timed out.
+ *
+ * @return Code of the final response to a reassembled upload, for
+ *         @ref COAP_BLOCK_EVT_UPLOAD_COMPLETE notified by the server. Ignored otherwise.
+ */
+typedef coap_msg_code_t (*coap_block_callback_t)(coap_block_evt_t   evt,
+                                                 uint32_t           result,
+                                                 void             * p_arg,
+                                                 iot_file_t       * p_file,
+                                                 uint32_t           size,
+                                                 coap_message_t   * p_message);
+
+/**@brief Configuration of a resource served block-wise. */
+typedef struct
+{
+    iot_file_t            * p_file;                 /**< Opened file holding the representation served, and receiving uploads. */
+    coap_block_callback_t   callback;               /**< Callback notifying the end of transfers. Can be NULL. */
+    void                  * p_arg;                  /**< Miscellaneous pointer passed to the callback. */
+    coap_content_type_t     content_format;         /**< Content format of the representation served. */
+} coap_block_server_conf_t;
+
+/**@brief Respond to a request on a resource served block-wise.
+ *
+ * @details To be called from the resource callback. A GET request is responded with the block
+ *          it asks for, read from the file, in a smaller block size if the block does not fit in
+ *          the memory available. Blocks of a PUT or POST request are written to the file at their
+ *          offset and acknowledged with 2.31 Continue. Once the last block has been written,
+ *          @ref COAP_BLOCK_EVT_UPLOAD_COMPLETE is notified and its return code sent as the final
+ *          response, sent again if the last block is retransmitted within EXCHANGE_LIFETIME. A
+ *          request without Block1 option is handled as a single block.
+ *
+ * @param[in] p_request Request received. Must not be NULL.
+ * @param[in] p_conf    Configuration of the resource. Must not be NULL.
+ *
+ * @retval NRF_SUCCESS             If a response was sent.
+ * @retval NRF_ERROR_NULL          If one of the parameters is a NULL pointer.
+ * @retval NRF_ERROR_NOT_SUPPORTED If the request method is not GET, PUT or POST. No response is
+ *                                 sent.
+ */
+uint32_t coap_block_server_request_handle(coap_message_t                 * p_request,
+                                          const coap_block_server_conf_t * p_conf);
+
+/**@brief Start a block-wise transfer as a client.
+ *
+ * @details The transfer sends requests built from the template, with its own tokens and with
+ *          Block and Size options added. A GET template downloads the resource into the file,
+ *          a PUT or POST template uploads the file_size bytes of the file.
+ *
+ * @param[out] p_handle   Handle of the transfer. Must not be NULL.
+ * @param[in]  p_template Request created with @ref coap_message_new. Must not be NULL, and must
+ *                        be kept until the end of the transfer is notified.
+ * @param[in]  p_file     Opened file to download into or to upload. Must not be NULL.
+ * @param[in]  callback   Callback notifying the end of the transfer. Must not be NULL.
+ * @param[in]  p_arg      Miscellaneous pointer passed to the callback.
+ *
+ * @retval NRF_SUCCESS             If the first request was sent.
+ * @retval NRF_ERROR_NULL          If one of the parameters is a NULL pointer.
+ * @retval NRF_ERROR_INVALID_PARAM If the template method is not GET, PUT or POST.
+ * @retval NRF_ERROR_NO_MEM        If COAP_BLOCK_MAX_TRANSFERS transfers are in progress.
+ */
+uint32_t coap_block_client_start(uint32_t              * p_handle,
+                                 coap_message_t        * p_template,
+                                 iot_file_t            * p_file,
+                                 coap_block_callback_t   callback,
+                                 void                  * p_arg);
+
+/**@brief Abort a block-wise transfer.
+ *
+ * @details The end of the transfer is not notified. Responses to requests in flight are ignored.
+ *
+ * @param[in] handle Handle of the transfer given by @ref coap_block_client_start.
+ *
+ * @retval NRF_SUCCESS         If the transfer was aborted.
+ * @retval NRF_ERROR_NOT_FOUND If no transfer is in progress with the handle.
+ */
+uint32_t coap_block_transfer_abort(uint32_t handle);
+
+/**@cond NO_DOXYGEN */
+
+/**@brief Abort the transfers without progress for COAP_BLOCK_TRANSFER_TIMEOUT ticks.
+ *
+ * @details Called by @ref coap_time_tick with the module locked.
+ */
+void coap_block_time_tick(void);
+
+/**@endcond */
+
+#else // COAP_ENABLE_BLOCK_TRANSFER
+
+#define coap_block_time_tick(...)
+
+#endif // COAP_ENABLE_BLOCK_TRANSFER
+
 #endif // COAP_BLOCK_H__
 
 /** @} */
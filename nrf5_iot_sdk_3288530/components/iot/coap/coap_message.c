@@ -22,6 +22,9 @@
 
 #define COAP_PAYLOAD_MARKER_SIZE  1
 
+/**@brief Number of extension bytes following an option header for a 4-bit delta or length field. */
+#define EXT_FIELD_SIZE(FIELD)     (((FIELD) == 13) ? 1 : (((FIELD) == 14) ? 2 : 0))
+
 /**@brief Verify that there is a index available for a new option. */
 #define OPTION_INDEX_AVAIL_CHECK(COUNT)                                                            \
     if ((COUNT) >= COAP_MAX_NUMBER_OF_OPTIONS)                                                     \
@@ -77,18 +80,34 @@ uint32_t coap_message_create(coap_message_t * p_message, coap_message_conf_t * p
  *                            where current option delta and the size of free memory to add the
  *                            values of the option. Used as a container where to put
  *                            the parsed option.
+ * @param[in]    length       Number of bytes left in the raw message buffer, starting at
+ *                            p_raw_option.
  * @param[out]   byte_count   Number of bytes parsed. Used to indicate where the next option 
  *                            might be located (if any left) in the raw message buffer.
  *
- * @retval NRF_SUCCESS         If the option parsing went successful.
- * @retval NRF_ERROR_DATA_SIZE If there is no more space left in the free memory to add the 
- *                             option value to the p_message.
+ * @retval NRF_SUCCESS                  If the option parsing went successful.
+ * @retval NRF_ERROR_NO_MEM             If the message has no room for another option.
+ * @retval COAP_MESSAGE_INVALID_CONTENT If the option exceeds the raw message buffer.
  */
-static uint32_t decode_option(const uint8_t * p_raw_option, coap_message_t * p_message, uint16_t * byte_count)
+static uint32_t decode_option(const uint8_t *  p_raw_option,
+                              coap_message_t * p_message,
+                              uint16_t         length,
+                              uint16_t *       byte_count)
 {
     uint16_t byte_index = 0;
     uint8_t  option_num = p_message->options_count;
     
+    if (option_num >= COAP_MAX_NUMBER_OF_OPTIONS)
+    {
+        return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
+    }
+
+    // The extended delta and length fields are at most 2 bytes each.
+    if (length < 1 + EXT_FIELD_SIZE(p_raw_option[0] >> 4) + EXT_FIELD_SIZE(p_raw_option[0] & 0x0F))
+    {
+        return COAP_MESSAGE_INVALID_CONTENT;
+    }
+
     // Calculate the option number.
     uint16_t option_delta       = (p_raw_option[byte_index] & 0xF0) >> 4;
     // Calculate the option length.
@@ -138,6 +157,11 @@ static uint32_t decode_option(const uint8_t * p_raw_option, coap_message_t * p_m
     // Update the delta counter with latest option number.
     p_message->options_delta = p_message->options[option_num].number; 
     
+    if (option_length > length - byte_index)
+    {
+        return COAP_MESSAGE_INVALID_CONTENT;
+    }
+
     byte_index += p_message->options[option_num].length;
     *byte_count = byte_index;
     
@@ -258,13 +282,26 @@ uint32_t coap_message_decode(coap_message_t *       p_message,
     p_message->header.id       += p_raw_message[byte_index++];
     
     // Parse the token, if any.
-    for (uint8_t index = 0; (byte_index < message_len) && (index < p_message->header.token_len); index++)
-    {
-        p_message->token[index]  = p_raw_message[byte_index++];
-    }
-    
-    p_message->options_count = 0;
-    p_message->options_delta = 0;
+    if ((p_message->header.token_len > sizeof(p_message->token)) ||
+        (p_message->header.token_len > message_len - byte_index))
+    {
+        return COAP_MESSAGE_INVALID_CONTENT;
+    }
+    memcpy(p_message->token, &p_raw_message[byte_index], p_message->header.token_len);
+    byte_index += p_message->header.token_len;
+    
+    // Options and payload are referenced in the raw message buffer. Only the fields that the
+    // decoding does not set are cleared, the option array is filled up to options_count.
+    p_message->options_count     = 0;
+    p_message->options_delta     = 0;
+    p_message->options_len       = 0;
+    p_message->options_offset    = 0;
+    p_message->p_payload         = NULL;
+    p_message->payload_len       = 0;
+    p_message->p_data            = NULL;
+    p_message->data_len          = 0;
+    p_message->p_arg             = NULL;
+    p_message->response_callback = NULL;
     
     // Parse the options if any.
     while ((byte_index < message_len) && (p_raw_message[byte_index] != COAP_PAYLOAD_MARKER))
@@ -273,7 +310,10 @@ uint32_t coap_message_decode(coap_message_t *       p_message,
         uint32_t err_code;
         uint16_t byte_count = 0;
         
-        err_code = decode_option(&p_raw_message[byte_index], p_message, &byte_count);
+        err_code = decode_option(&p_raw_message[byte_index],
+                                 p_message,
+                                 message_len - byte_index,
+                                 &byte_count);
         if (err_code != NRF_SUCCESS)
         {
             return err_code;
@@ -560,12 +600,32 @@ uint32_t coap_message_payload_set(coap_message_t * p_message,
 {
     p_message->p_payload = &p_message->p_data[p_message->options_offset];
     p_message->payload_len = payload_len;
-    memcpy(p_message->p_payload, p_payload, payload_len);
+
+    // A payload encoded in place through coap_message_payload_buffer_get is already there.
+    if (p_message->p_payload != p_payload)
+    {
+        memcpy(p_message->p_payload, p_payload, payload_len);
+    }
     
     return NRF_SUCCESS;
 }
 
 
+uint32_t coap_message_payload_buffer_get(coap_message_t * p_message,
+                                         uint8_t **       pp_buffer,
+                                         uint16_t *       p_buffer_len)
+{
+    NULL_PARAM_CHECK(p_message);
+    NULL_PARAM_CHECK(pp_buffer);
+    NULL_PARAM_CHECK(p_buffer_len);
+
+    *pp_buffer    = &p_message->p_data[p_message->options_offset];
+    *p_buffer_len = p_message->data_len - p_message->options_offset;
+
+    return NRF_SUCCESS;
+}
+
+
 uint32_t coap_message_remote_addr_set(coap_message_t * p_message, coap_remote_t * p_address)
 {
     memcpy(&p_message->remote, p_address, sizeof(coap_remote_t));
@@ -632,6 +692,18 @@ static uint32_t bit_to_content_format(coap_content_type_t * p_ct, uint32_t bit)
             *p_ct = COAP_CT_APP_JSON;
             break;
         
+        case COAP_CT_MASK_APP_SENML_JSON:
+            *p_ct = COAP_CT_APP_SENML_JSON;
+            break;
+        
+        case COAP_CT_MASK_APP_SENML_CBOR:
+            *p_ct = COAP_CT_APP_SENML_CBOR;
+            break;
+        
+        case COAP_CT_MASK_APP_LWM2M_TLV:
+            *p_ct = COAP_CT_APP_LWM2M_TLV;
+            break;
+        
         default:
             return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
     }
@@ -667,6 +739,18 @@ static uint32_t content_format_to_bit(coap_content_type_t ct)
             mask = COAP_CT_MASK_APP_JSON;
             break;
         
+        case COAP_CT_APP_SENML_JSON:
+            mask = COAP_CT_MASK_APP_SENML_JSON;
+            break;
+        
+        case COAP_CT_APP_SENML_CBOR:
+            mask = COAP_CT_MASK_APP_SENML_CBOR;
+            break;
+        
+        case COAP_CT_APP_LWM2M_TLV:
+            mask = COAP_CT_MASK_APP_LWM2M_TLV;
+            break;
+        
         default:
             break;
     }
@@ -747,6 +831,11 @@ uint32_t coap_message_ct_match_select(coap_content_type_t * p_ct, coap_message_t
     
     // Select the first common content-type between the resource and the CoAP client.
     uint32_t common_ct            = p_resource->ct_support_mask & accept_mask;
+    if (common_ct == 0)
+    {
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    }
+
     uint32_t bit_index;
     for (bit_index = 0; bit_index < 32; bit_index++)
     {
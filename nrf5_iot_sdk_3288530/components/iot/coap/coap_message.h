@@ -50,6 +50,11 @@ uint32_t coap_message_create(coap_message_t * p_message, coap_message_conf_t * p
  * @details When the underlying transport layer receives a message, it has to 
  *          be decoded into a CoAP message type structure. This functions returns
  *          a decoded message if decoding was successfully, or NULL otherwise.
+ *
+ *          The message is decoded in place: the options and the payload of the decoded message
+ *          point into p_raw_message, which has to be kept while the message is in use. All fields
+ *          except remote and port are set by the function, so p_message does not have to be
+ *          cleared in advance.
  * 
  * @param[out] p_message     The generated coap_message_t after decoding the raw message.
  * @param[in]  p_raw_message Pointer to the encoded message memory buffer.
@@ -62,6 +67,8 @@ uint32_t coap_message_create(coap_message_t * p_message, coap_message_conf_t * p
  * @retval COAP_MESSAGE_INVALID_CONTENT If the message could not be decoded successfully. This
  *                                      could happen if message length provided is larger than 
  *                                      what is possible to decode (ex. missing payload marker).
+ * @retval NRF_ERROR_NO_MEM             If the message has more than COAP_MAX_NUMBER_OF_OPTIONS
+ *                                      options.
  *
  */
 uint32_t coap_message_decode(coap_message_t * p_message,
@@ -133,7 +133,7 @@ uint32_t internal_coap_observe_server_next_get(coap_observer_t ** pp_observer,
     }
     else
     {
-        uint32_t index_to_previous = (uint8_t)(((uint32_t)p_observer - (uint32_t)m_observers) / (uint32_t)sizeof(coap_observer_t));
+        uint32_t index_to_previous = (uint8_t)(p_observer - m_observers);
 
         for (uint32_t i = index_to_previous + 1; i < COAP_OBSERVE_MAX_NUM_OBSERVERS; i++)
         {
@@ -291,7 +291,7 @@ uint32_t internal_coap_observe_client_next_get(coap_observable_t ** pp_observabl
     }
     else
     {
-        uint32_t index_to_previous = (uint8_t)(((uint32_t)p_observable - (uint32_t)m_observables) / (uint32_t)sizeof(coap_observable_t));
+        uint32_t index_to_previous = (uint8_t)(p_observable - m_observables);
 
         for (uint32_t i = index_to_previous + 1; i < COAP_OBSERVE_MAX_NUM_OBSERVABLES; i++)
         {
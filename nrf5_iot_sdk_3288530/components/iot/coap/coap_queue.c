@@ -11,6 +11,7 @@
  */
 
 #include "string.h"
+#include <stddef.h>
 #include "coap_queue.h"
 #include "iot_common.h"
 #include "sdk_config.h"
@@ -29,17 +30,175 @@
 
 #endif // COAP_DISABLE_API_PARAM_CHECK 
 
+#ifndef COAP_QUEUE_HASH_SIZE
+#define COAP_QUEUE_HASH_SIZE  8                                                                     /**< Number of hash buckets for lookup of items by message ID and by token. Must be a power of two. */
+#endif
+
+#ifndef COAP_QUEUE_WHEEL_SIZE
+#define COAP_QUEUE_WHEEL_SIZE 64                                                                    /**< Number of slots, one per tick, of the timeout wheel. Must be a power of two. Items with longer timeouts are visited once per wheel rotation. */
+#endif
+
+#define COAP_QUEUE_INDEX_NONE 0xFFFF                                                                /**< Index value indicating end of list. */
+
+#if ((COAP_QUEUE_HASH_SIZE & (COAP_QUEUE_HASH_SIZE - 1)) != 0) || ((COAP_QUEUE_WHEEL_SIZE & (COAP_QUEUE_WHEEL_SIZE - 1)) != 0)
+#error "COAP_QUEUE_HASH_SIZE and COAP_QUEUE_WHEEL_SIZE must be powers of two."
+#endif
+
+#if (COAP_MESSAGE_QUEUE_SIZE >= COAP_QUEUE_INDEX_NONE)
+#error "COAP_MESSAGE_QUEUE_SIZE is too large."
+#endif
+
+/**@brief Links of a queue item into the lookup and timeout structures. */
+typedef struct
+{
+    uint16_t mid_next;                                                                              /**< Next item in the same message ID hash bucket. */
+    uint16_t token_next;                                                                            /**< Next item in the same token hash bucket. */
+    uint16_t timer_prev;                                                                            /**< Previous item in the same timeout wheel slot. */
+    uint16_t timer_next;                                                                            /**< Next item in the same timeout wheel slot, or next free item. */
+    uint32_t deadline;                                                                              /**< Tick count at which the item is due. */
+} coap_queue_link_t;
+
 static coap_queue_item_t m_queue[COAP_MESSAGE_QUEUE_SIZE];
-static uint8_t           m_message_queue_count = 0;
+static coap_queue_link_t m_link[COAP_MESSAGE_QUEUE_SIZE];
+static uint16_t          m_mid_hash[COAP_QUEUE_HASH_SIZE];                                          /**< First item in each message ID hash bucket. */
+static uint16_t          m_token_hash[COAP_QUEUE_HASH_SIZE];                                        /**< First item in each token hash bucket. */
+static uint16_t          m_timer_wheel[COAP_QUEUE_WHEEL_SIZE];                                      /**< First item in each timeout wheel slot. */
+static uint16_t          m_free_head;                                                               /**< First item in the list of free items. */
+static uint16_t          m_message_queue_count = 0;
+static uint32_t          m_tick_count;                                                              /**< Number of ticks since initialization. */
+
+
+/**@brief Get hash bucket of a message ID. */
+static uint32_t mid_hash_get(uint16_t mid)
+{
+    return (mid ^ (mid >> 8)) & (COAP_QUEUE_HASH_SIZE - 1);
+}
+
+
+/**@brief Get hash bucket of a token. */
+static uint32_t token_hash_get(const uint8_t * p_token, uint8_t token_len)
+{
+    uint32_t hash = token_len;
+
+    for (uint8_t i = 0; i < token_len; i++)
+    {
+        hash = (hash * 31) + p_token[i];
+    }
+
+    return (hash ^ (hash >> 8)) & (COAP_QUEUE_HASH_SIZE - 1);
+}
+
+
+/**@brief Get index of an item, or COAP_QUEUE_INDEX_NONE if the pointer is not an item in use. */
+static uint16_t item_index_get(const coap_queue_item_t * p_item)
+{
+    if ((p_item < m_queue) || (p_item >= &m_queue[COAP_MESSAGE_QUEUE_SIZE]))
+    {
+        return COAP_QUEUE_INDEX_NONE;
+    }
+
+    const uint16_t index = (uint16_t)(p_item - m_queue);
+
+    if ((&m_queue[index] != p_item) || (p_item->p_buffer == NULL))
+    {
+        return COAP_QUEUE_INDEX_NONE;
+    }
+
+    return index;
+}
+
+
+/**@brief Remove an item from a hash bucket list, where next_offset selects the link used. */
+static void hash_unlink(uint16_t * p_head, uint16_t index, size_t next_offset)
+{
+    uint16_t * p_current = p_head;
+
+    while (*p_current != COAP_QUEUE_INDEX_NONE)
+    {
+        uint16_t * p_next = (uint16_t *)((uint8_t *)&m_link[*p_current] + next_offset);
+
+        if (*p_current == index)
+        {
+            *p_current = *p_next;
+            return;
+        }
+
+        p_current = p_next;
+    }
+}
+
+
+/**@brief Add an item to the timeout wheel, to be due after timeout ticks. */
+static void timer_link(uint16_t index, uint16_t timeout)
+{
+    coap_queue_link_t * p_link = &m_link[index];
+
+    // Item is due on tick number timeout + 1 from now, as when counting down timeout on each tick.
+    p_link->deadline   = m_tick_count + timeout + 1;
+
+    uint16_t * p_slot  = &m_timer_wheel[p_link->deadline & (COAP_QUEUE_WHEEL_SIZE - 1)];
+
+    p_link->timer_prev = COAP_QUEUE_INDEX_NONE;
+    p_link->timer_next = *p_slot;
+
+    if (*p_slot != COAP_QUEUE_INDEX_NONE)
+    {
+        m_link[*p_slot].timer_prev = index;
+    }
+    *p_slot = index;
+}
+
+
+/**@brief Remove an item from the timeout wheel, if present. */
+static void timer_unlink(uint16_t index)
+{
+    coap_queue_link_t * p_link = &m_link[index];
+    uint16_t          * p_slot = &m_timer_wheel[p_link->deadline & (COAP_QUEUE_WHEEL_SIZE - 1)];
+
+    if (p_link->timer_prev != COAP_QUEUE_INDEX_NONE)
+    {
+        m_link[p_link->timer_prev].timer_next = p_link->timer_next;
+    }
+    else if (*p_slot == index)
+    {
+        *p_slot = p_link->timer_next;
+    }
+    else
+    {
+        // Not in the timeout wheel.
+        return;
+    }
+
+    if (p_link->timer_next != COAP_QUEUE_INDEX_NONE)
+    {
+        m_link[p_link->timer_next].timer_prev = p_link->timer_prev;
+    }
+
+    p_link->timer_prev = COAP_QUEUE_INDEX_NONE;
+    p_link->timer_next = COAP_QUEUE_INDEX_NONE;
+}
+
 
 uint32_t coap_queue_init(void)
 {
-    for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    for (uint16_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
     {
         memset(&m_queue[i], 0, sizeof(coap_queue_item_t));
         m_queue[i].handle = i;
+
+        m_link[i].mid_next   = COAP_QUEUE_INDEX_NONE;
+        m_link[i].token_next = COAP_QUEUE_INDEX_NONE;
+        m_link[i].timer_prev = COAP_QUEUE_INDEX_NONE;
+        m_link[i].timer_next = (i + 1 < COAP_MESSAGE_QUEUE_SIZE) ? (i + 1) : COAP_QUEUE_INDEX_NONE;
     }
+
+    memset(m_mid_hash, 0xFF, sizeof(m_mid_hash));
+    memset(m_token_hash, 0xFF, sizeof(m_token_hash));
+    memset(m_timer_wheel, 0xFF, sizeof(m_timer_wheel));
+
+    m_free_head           = 0;
     m_message_queue_count = 0;
+    m_tick_count          = 0;
     
     return NRF_SUCCESS;
 }
@@ -52,52 +211,90 @@ uint32_t coap_queue_add(coap_queue_item_t * item)
     {
        return (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
     }
-    else 
+
+    if (m_free_head == COAP_QUEUE_INDEX_NONE)
     {
-        for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
-        {
-            if (m_queue[i].p_buffer == NULL)
-            {
-                // Free spot in message queue. Add message here...                
-                memcpy(&m_queue[i], item, sizeof(coap_queue_item_t));
-                
-                m_message_queue_count++;
+        return (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE);
+    }
 
-                return NRF_SUCCESS;
-            }
-        }
-        
+    // Take the first free item.
+    const uint16_t      index  = m_free_head;
+    coap_queue_link_t * p_link = &m_link[index];
+
+    m_free_head  = p_link->timer_next;
+    item->handle = index;
+    memcpy(&m_queue[index], item, sizeof(coap_queue_item_t));
+
+    // Index by message ID, and by token if any.
+    const uint32_t mid_bucket = mid_hash_get(item->mid);
+
+    p_link->mid_next         = m_mid_hash[mid_bucket];
+    m_mid_hash[mid_bucket]   = index;
+
+    p_link->token_next = COAP_QUEUE_INDEX_NONE;
+    if (item->token_len != 0)
+    {
+        const uint32_t token_bucket = token_hash_get(item->token, item->token_len);
+
+        p_link->token_next           = m_token_hash[token_bucket];
+        m_token_hash[token_bucket]   = index;
     }
-    return (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE);
+
+    timer_link(index, item->timeout);
+
+    m_message_queue_count++;
+
+    return NRF_SUCCESS;
 }
 
 uint32_t coap_queue_remove(coap_queue_item_t * p_item)
 {
-    for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    const uint16_t index = item_index_get(p_item);
+
+    if (index == COAP_QUEUE_INDEX_NONE)
     {
-        if (p_item == (coap_queue_item_t *)&m_queue[i])
-        {
-            memset(&m_queue[i], 0, sizeof(coap_queue_item_t));
-            m_message_queue_count--;
-            return NRF_SUCCESS;
-        }
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
     }
 
-    return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    hash_unlink(&m_mid_hash[mid_hash_get(p_item->mid)], index, offsetof(coap_queue_link_t, mid_next));
+
+    if (p_item->token_len != 0)
+    {
+        hash_unlink(&m_token_hash[token_hash_get(p_item->token, p_item->token_len)],
+                    index,
+                    offsetof(coap_queue_link_t, token_next));
+    }
+
+    timer_unlink(index);
+
+    memset(p_item, 0, sizeof(coap_queue_item_t));
+    p_item->handle = index;
+
+    // Return the item to the free list.
+    m_link[index].timer_next = m_free_head;
+    m_free_head              = index;
+
+    m_message_queue_count--;
+
+    return NRF_SUCCESS;
 }
 
 uint32_t coap_queue_item_by_token_get(coap_queue_item_t ** pp_item, uint8_t * p_token, uint8_t token_len)
 {
-    for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    if (token_len != 0)
     {
-        if (m_queue[i].token_len == token_len)
+        uint16_t index = m_token_hash[token_hash_get(p_token, token_len)];
+
+        while (index != COAP_QUEUE_INDEX_NONE)
         {
-            if ((0 != m_queue[i].token_len) && 
-                (memcmp(m_queue[i].token, p_token, m_queue[i].token_len) == 0))
+            if ((m_queue[index].token_len == token_len) &&
+                (memcmp(m_queue[index].token, p_token, token_len) == 0))
             {
-                    *pp_item = &m_queue[i];
-                    return NRF_SUCCESS;
+                *pp_item = &m_queue[index];
+                return NRF_SUCCESS;
             }
+
+            index = m_link[index].token_next;
         }
     }
     
@@ -107,48 +304,102 @@ uint32_t coap_queue_item_by_token_get(coap_queue_item_t ** pp_item, uint8_t * p_
 
 uint32_t coap_queue_item_by_mid_get(coap_queue_item_t ** pp_item, uint16_t message_id)
 {
-    
-    
-    for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    uint16_t index = m_mid_hash[mid_hash_get(message_id)];
+
+    while (index != COAP_QUEUE_INDEX_NONE)
     {
-        if (m_queue[i].mid == message_id)
+        if (m_queue[index].mid == message_id)
         {
-            *pp_item = &m_queue[i];
+            *pp_item = &m_queue[index];
             return NRF_SUCCESS;
         }
+
+        index = m_link[index].mid_next;
     }
     
     return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
 }
 
 
+uint32_t coap_queue_item_by_handle_get(coap_queue_item_t ** pp_item, uint32_t handle)
+{
+    NULL_PARAM_CHECK(pp_item);
+
+    if ((handle >= COAP_MESSAGE_QUEUE_SIZE) || (m_queue[handle].p_buffer == NULL))
+    {
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    }
+
+    *pp_item = &m_queue[handle];
+
+    return NRF_SUCCESS;
+}
+
+
 uint32_t coap_queue_item_next_get(coap_queue_item_t ** pp_item, coap_queue_item_t * p_item)
 {
-    if (p_item == NULL)
+    uint32_t i = 0;
+
+    if (p_item != NULL)
     {
-        for (uint8_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+        i = (uint32_t)(p_item - m_queue) + 1;
+    }
+
+    for (; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    {
+        if (m_queue[i].p_buffer != NULL)
         {
-            if (m_queue[i].p_buffer != NULL)
-            {
-                (*pp_item) = &m_queue[i];
-                return NRF_SUCCESS;
-            }
+            (*pp_item) = &m_queue[i];
+            return NRF_SUCCESS;
         }
     }
-    else
-    {
-        uint8_t index_to_previous = (uint8_t)(((uint32_t)p_item - (uint32_t)m_queue) / (uint32_t)sizeof(coap_queue_item_t));
+    (*pp_item) = NULL;
+
+    return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+}
+
+
+void coap_queue_tick(void)
+{
+    m_tick_count++;
+}
+
+
+uint32_t coap_queue_item_due_get(coap_queue_item_t ** pp_item)
+{
+    uint16_t index = m_timer_wheel[m_tick_count & (COAP_QUEUE_WHEEL_SIZE - 1)];
 
-        for (uint8_t i = index_to_previous + 1; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    // Items in the slot may be due in a later rotation of the wheel.
+    while (index != COAP_QUEUE_INDEX_NONE)
+    {
+        if (m_link[index].deadline == m_tick_count)
         {
-            if (m_queue[i].p_buffer != NULL)
-            {
-                (*pp_item) = &m_queue[i];
-                return NRF_SUCCESS;
-            }
+            timer_unlink(index);
+
+            *pp_item = &m_queue[index];
+            return NRF_SUCCESS;
         }
+
+        index = m_link[index].timer_next;
     }
-    (*pp_item) = NULL;
 
     return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
 }
+
+
+uint32_t coap_queue_item_timeout_set(coap_queue_item_t * p_item, uint16_t timeout)
+{
+    const uint16_t index = item_index_get(p_item);
+
+    if (index == COAP_QUEUE_INDEX_NONE)
+    {
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    }
+
+    timer_unlink(index);
+
+    p_item->timeout = timeout;
+    timer_link(index, timeout);
+
+    return NRF_SUCCESS;
+}
@@ -34,7 +34,7 @@ typedef struct
     uint8_t                  token_len;             /**< Message Token length. */
     uint8_t                  token[8];              /**< Message Token value up to 8 bytes. */
     uint8_t                  retrans_count;         /**< Re-transmission attempt count. */
-    uint16_t                 timeout;               /**< Time until new re-transmission attempt. */
+    uint16_t                 timeout;               /**< Number of ticks from when the item was added or last rescheduled until it is due. */
     uint16_t                 timeout_val;           /**< Last timeout value used. */
     coap_port_t              port;                  /**< Source port to use when re-transmitting. */
     uint8_t *                p_buffer;              /**< Pointer to the data buffer containing the encoded CoAP message. */
@@ -51,8 +51,11 @@ uint32_t coap_queue_init(void);
 
 /**@brief Add item to the queue. 
  * 
+ * @details The item becomes due after the number of ticks given by its timeout field, see
+ *          @ref coap_queue_item_due_get.
+ *
  * @param[in] p_item      Pointer to an item which to add to the queue. The function will copy all
- *                        data provided. 
+ *                        data provided. The handle field is set to the handle of the queued item.
  * 
  * @retval NRF_SUCCESS         If adding the item was successful. 
  * @retval NRF_ERROR_NO_MEM    If max number of queued elements has been reached. This is 
@@ -100,6 +103,20 @@ uint32_t coap_queue_item_by_token_get(coap_queue_item_t ** pp_item, uint8_t * p_
  */
 uint32_t coap_queue_item_by_mid_get(coap_queue_item_t ** pp_item, uint16_t message_id);
 
+/**@brief Get item by handle.
+ *
+ * @details Message IDs may repeat in the queue, for example once they wrap around, but handles are
+ *          unique among the queued items.
+ *
+ * @param[out] pp_item    Pointer to be filled by the function if an item with the handle is queued.
+ *                        Should not be NULL.
+ * @param[in]  handle     Handle of the item, as set by @ref coap_queue_add.
+ *
+ * @retval NRF_SUCCESS         If the item was located.
+ * @retval NRF_ERROR_NOT_FOUND If no queued item has the handle.
+ */
+uint32_t coap_queue_item_by_handle_get(coap_queue_item_t ** pp_item, uint32_t handle);
+
 /**@brief Iterate through items.
  * 
  * @param[out] pp_item    Pointer to be filled by the search function upon finding the next 
@@ -113,6 +130,37 @@ uint32_t coap_queue_item_by_mid_get(coap_queue_item_t ** pp_item, uint16_t messa
  */
 uint32_t coap_queue_item_next_get(coap_queue_item_t ** pp_item, coap_queue_item_t * p_item);
 
+/**@brief Advance the time of the queue by one tick.
+ *
+ * @details Items that are due on the new tick can then be retrieved using
+ *          @ref coap_queue_item_due_get.
+ */
+void coap_queue_tick(void);
+
+/**@brief Get an item that is due on the current tick.
+ *
+ * @details Only the items due on the current tick are visited. The item returned is no longer
+ *          scheduled, and must either be rescheduled using @ref coap_queue_item_timeout_set or
+ *          removed from the queue.
+ *
+ * @param[out] pp_item    Pointer to be filled by the function with the item that is due.
+ *
+ * @retval NRF_SUCCESS         If an item that is due was found.
+ * @retval NRF_ERROR_NOT_FOUND If no more items are due on the current tick.
+ */
+uint32_t coap_queue_item_due_get(coap_queue_item_t ** pp_item);
+
+/**@brief Reschedule an item to be due after a number of ticks.
+ *
+ * @param[in] p_item      Pointer to an item in the queue.
+ * @param[in] timeout     Number of ticks until the item is due. Also stored in the timeout field of
+ *                        the item.
+ *
+ * @retval NRF_SUCCESS         If the item was rescheduled.
+ * @retval NRF_ERROR_NOT_FOUND If the item was not located in the queue.
+ */
+uint32_t coap_queue_item_timeout_set(coap_queue_item_t * p_item, uint16_t timeout);
+
 #endif
 
 /** @} */
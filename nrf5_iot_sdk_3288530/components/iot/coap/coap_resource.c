@@ -10,6 +10,7 @@
  *
  */
 
+#include <stdint.h>
 #include <string.h>
 
 #include "coap_resource.h"
@@ -19,8 +20,31 @@
 
 #define COAP_RESOURCE_MAX_AGE_INIFINITE  0xFFFFFFFF
 
+#ifndef COAP_RESOURCE_HASH_SIZE
+#define COAP_RESOURCE_HASH_SIZE              32                                            /**< Number of buckets in the table used to look up a child resource by its parent and name. Must be a power of two. */
+#endif
+
+#ifndef COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE
+#define COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE  COAP_MESSAGE_DATA_MAX_SIZE                    /**< Size of the buffer caching the .well-known/core string. Set to 0 to disable the cache. */
+#endif
+
+#if ((COAP_RESOURCE_HASH_SIZE == 0) || ((COAP_RESOURCE_HASH_SIZE & (COAP_RESOURCE_HASH_SIZE - 1)) != 0))
+#error "COAP_RESOURCE_HASH_SIZE must be a power of two."
+#endif
+
 static coap_resource_t * mp_root_resource = NULL;
+static coap_resource_t * m_resource_hash[COAP_RESOURCE_HASH_SIZE];                         /**< Children of all resources, hashed on the parent and the name of the child. */
 static char m_scratch_buffer[(COAP_RESOURCE_MAX_NAME_LEN + 1) * COAP_RESOURCE_MAX_DEPTH + 6];
+static uint32_t m_tree_revision;                                                           /**< Incremented every time a resource is created or added. */
+
+#if (COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE > 0)
+static uint8_t  m_well_known_cache[COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE];                   /**< Last generated .well-known/core string. */
+static uint16_t m_well_known_cache_len;                                                   /**< Length of the cached string, 0 if the cache is not valid. */
+
+#define WELL_KNOWN_CACHE_INVALIDATE() (m_well_known_cache_len = 0)
+#else
+#define WELL_KNOWN_CACHE_INVALIDATE()
+#endif // COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE
 
 #if (COAP_DISABLE_API_PARAM_CHECK == 0)
 
@@ -36,9 +60,37 @@ static char m_scratch_buffer[(COAP_RESOURCE_MAX_NAME_LEN + 1) * COAP_RESOURCE_MA
 
 #endif // COAP_DISABLE_API_PARAM_CHECK 
 
+/**@brief Get the lookup table bucket of a child resource.
+ *
+ * @param[in] p_parent Parent of the resource.
+ * @param[in] p_name   Name of the resource, not necessarily zero terminated.
+ * @param[in] length   Length of the name.
+ */
+static uint32_t resource_hash_get(const coap_resource_t * p_parent, const uint8_t * p_name, uint16_t length)
+{
+    uint32_t hash = (uint32_t)(uintptr_t)p_parent;
+
+    for (uint16_t index = 0; index < length; index++)
+    {
+        hash = (hash * 31) + p_name[index];
+    }
+
+    return ((hash >> 8) ^ hash) & (COAP_RESOURCE_HASH_SIZE - 1);
+}
+
+/**@brief Register a change of the resource tree. */
+static void tree_changed(void)
+{
+    m_tree_revision++;
+    WELL_KNOWN_CACHE_INVALIDATE();
+}
+
 uint32_t coap_resource_init(void)
 {
     mp_root_resource = NULL;
+    memset(m_resource_hash, 0, sizeof(m_resource_hash));
+    tree_changed();
+
     return NRF_SUCCESS;
 }    
     
@@ -47,12 +99,14 @@ uint32_t coap_resource_create(coap_resource_t * p_resource, const char * name)
     NULL_PARAM_CHECK(p_resource);
     NULL_PARAM_CHECK(name);
     
-    if (strlen(name) > COAP_RESOURCE_MAX_NAME_LEN)
+    size_t name_len = strlen(name);
+    if (name_len > COAP_RESOURCE_MAX_NAME_LEN)
     {
         return (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE);
     }
     
-    memcpy(p_resource->name, name, strlen(name));
+    memcpy(p_resource->name, name, name_len + 1);
+    p_resource->name_len = (uint16_t)name_len;
     
     if (mp_root_resource == NULL)
     {
@@ -61,6 +115,8 @@ uint32_t coap_resource_create(coap_resource_t * p_resource, const char * name)
     
     p_resource->max_age = COAP_RESOURCE_MAX_AGE_INIFINITE;
     
+    tree_changed();
+
     return NRF_SUCCESS;
 }
 
@@ -83,10 +139,33 @@ uint32_t coap_resource_child_add(coap_resource_t * p_parent, coap_resource_t * p
     
     p_parent->child_count++;
     
+    // Index the child on its parent and name, to resolve request paths without walking siblings.
+    uint32_t bucket = resource_hash_get(p_parent, (uint8_t *)p_child->name, p_child->name_len);
+
+    p_child->p_parent       = p_parent;
+    p_child->p_hash_next    = m_resource_hash[bucket];
+    m_resource_hash[bucket] = p_child;
+
+    tree_changed();
+
     return NRF_SUCCESS;
 }
 
-static uint32_t generate_path(uint16_t buffer_pos, coap_resource_t * p_current_resource, char * parent_path, uint8_t * string, uint16_t * length)
+/**@brief Append the link-format entries of a resource and its children to the string.
+ *
+ * @param[in]    buffer_pos         Length of the path of the parent in m_scratch_buffer.
+ * @param[in]    p_current_resource Resource to generate the entries for.
+ * @param[in]    parent_path        NULL if p_current_resource is the root resource.
+ * @param[out]   string             Buffer to append the entries to.
+ * @param[inout] p_offset           Number of bytes in the string.
+ * @param[in]    length             Size of the string buffer.
+ */
+static uint32_t generate_path(uint16_t          buffer_pos,
+                              coap_resource_t * p_current_resource,
+                              char *            parent_path,
+                              uint8_t *         string,
+                              uint16_t *        p_offset,
+                              uint16_t          length)
 {
     uint32_t err_code = NRF_SUCCESS;
     
@@ -99,7 +178,7 @@ static uint32_t generate_path(uint16_t buffer_pos, coap_resource_t * p_current_r
             coap_resource_t * next_child = p_current_resource->p_front;
             do
             {
-                err_code = generate_path(buffer_pos, next_child, m_scratch_buffer, string, length);
+                err_code = generate_path(buffer_pos, next_child, m_scratch_buffer, string, p_offset, length);
                 if (err_code != NRF_SUCCESS)
                 {
                     return err_code;
@@ -110,7 +189,7 @@ static uint32_t generate_path(uint16_t buffer_pos, coap_resource_t * p_current_r
     }
     else
     {   
-        uint16_t size = strlen(p_current_resource->name);
+        uint16_t size = p_current_resource->name_len;
         m_scratch_buffer[buffer_pos++] = '/';
         
         memcpy(&m_scratch_buffer[buffer_pos], p_current_resource->name, size);
@@ -121,7 +200,7 @@ static uint32_t generate_path(uint16_t buffer_pos, coap_resource_t * p_current_r
             coap_resource_t * next_child = p_current_resource->p_front;
             do
             {
-                err_code = generate_path(buffer_pos, next_child, m_scratch_buffer, string, length);
+                err_code = generate_path(buffer_pos, next_child, m_scratch_buffer, string, p_offset, length);
                 if (err_code != NRF_SUCCESS)
                 {
                     return err_code;
@@ -141,10 +220,10 @@ static uint32_t generate_path(uint16_t buffer_pos, coap_resource_t * p_current_r
 
         m_scratch_buffer[buffer_pos++] = ',';
         
-        if (buffer_pos <= (*length))
+        if (buffer_pos <= (length - (*p_offset)))
         {
-            *length -= buffer_pos;
-            memcpy(&string[strlen((char *)string)], m_scratch_buffer, buffer_pos);
+            memcpy(&string[*p_offset], m_scratch_buffer, buffer_pos);
+            *p_offset += buffer_pos;
         }
         else
         {
@@ -164,41 +243,79 @@ uint32_t coap_resource_well_known_generate(uint8_t * string, uint16_t * length)
     {
         return (NRF_ERROR_INVALID_STATE | IOT_COAP_ERR_BASE);
     }
+
+#if (COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE > 0)
+    if (m_well_known_cache_len > 0)
+    {
+        // Room is needed for the zero termination as well.
+        if (m_well_known_cache_len >= (*length))
+        {
+            return (NRF_ERROR_DATA_SIZE | IOT_COAP_ERR_BASE);
+        }
+
+        memcpy(string, m_well_known_cache, m_well_known_cache_len);
+        string[m_well_known_cache_len] = '\0';
+        *length = m_well_known_cache_len;
+
+        return NRF_SUCCESS;
+    }
+#endif // COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE
   
-    memset(string, 0, *length);
-    
-    uint32_t err_code = generate_path(0, mp_root_resource, NULL, string, length);
+    uint16_t offset   = 0;
+    uint32_t err_code = generate_path(0, mp_root_resource, NULL, string, &offset, *length);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
     
-    string[strlen((char *)string) - 1] = '\0'; // remove the last comma
+    if (offset > 0)
+    {
+        offset--; // remove the last comma
+    }
+    if (offset < (*length))
+    {
+        string[offset] = '\0';
+    }
+
+#if (COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE > 0)
+    if (offset < COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE)
+    {
+        memcpy(m_well_known_cache, string, offset);
+        m_well_known_cache_len = offset;
+    }
+#endif // COAP_RESOURCE_WELL_KNOWN_CACHE_SIZE
+
+    *length = offset;
     
-    return err_code;
+    return NRF_SUCCESS;
 }
 
 static coap_resource_t * coap_resource_child_resolve(coap_resource_t * p_parent, 
-                                                     char *            p_path)
+                                                     const uint8_t *   p_path,
+                                                     uint16_t          length)
 {
-    coap_resource_t * result = NULL;
-    if (p_parent->p_front != NULL)
+    coap_resource_t * p_child = m_resource_hash[resource_hash_get(p_parent, p_path, length)];
+
+    while (p_child != NULL)
     {
-        coap_resource_t * sibling_in_question = p_parent->p_front;
+        // Only an exact match of the name, a request for "temp" does not resolve "temperature".
+        if ((p_child->p_parent == p_parent) &&
+            (p_child->name_len == length)   &&
+            (memcmp(p_child->name, p_path, length) == 0))
+        {
+            return p_child;
+        }
 
-        do {
-            // Check if the sibling name match.
-            size_t size = strlen(sibling_in_question->name);
-            if (strncmp(sibling_in_question->name, p_path, size) == 0)
-            {
-                return sibling_in_question;
-            }
-            else 
-            {
-                sibling_in_question = sibling_in_question->p_sibling;
-            }
-        } while (sibling_in_question != NULL);
+        p_child = p_child->p_hash_next;
     }
-    return result;
+
+    return NULL;
 }
 
-uint32_t coap_resource_get(coap_resource_t ** p_resource, uint8_t ** pp_uri_pointers, uint8_t num_of_uris)
+uint32_t coap_resource_segments_get(coap_resource_t ** p_resource,
+                                    uint8_t **         pp_uri_pointers,
+                                    uint16_t *         p_uri_lengths,
+                                    uint8_t            num_of_uris)
 {
     if (mp_root_resource == NULL)
     {
@@ -212,7 +329,9 @@ uint32_t coap_resource_get(coap_resource_t ** p_resource, uint8_t ** pp_uri_poin
     // Every node should start at root. 
     for (uint8_t i = 0; i < num_of_uris; i++)
     {   
-        p_current_resource = coap_resource_child_resolve(p_current_resource, (char *)pp_uri_pointers[i]);
+        p_current_resource = coap_resource_child_resolve(p_current_resource,
+                                                         pp_uri_pointers[i],
+                                                         p_uri_lengths[i]);
         
         if (p_current_resource == NULL)
         {
@@ -232,6 +351,32 @@ uint32_t coap_resource_get(coap_resource_t ** p_resource, uint8_t ** pp_uri_poin
     return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
 }
 
+uint32_t coap_resource_get(coap_resource_t ** p_resource,
+                           uint8_t **         pp_uri_pointers,
+                           uint8_t            num_of_uris)
+{
+    uint16_t uri_lengths[COAP_RESOURCE_MAX_DEPTH];
+
+    if (num_of_uris > COAP_RESOURCE_MAX_DEPTH)
+    {
+        // Deeper than any resource, nothing can be found.
+        *p_resource = NULL;
+        return (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE);
+    }
+
+    for (uint8_t i = 0; i < num_of_uris; i++)
+    {
+        uri_lengths[i] = (uint16_t)strlen((char *)pp_uri_pointers[i]);
+    }
+
+    return coap_resource_segments_get(p_resource, pp_uri_pointers, uri_lengths, num_of_uris);
+}
+
+uint32_t coap_resource_revision_get(void)
+{
+    return m_tree_revision;
+}
+
 uint32_t coap_resource_root_get(coap_resource_t ** pp_resource)
 {
     NULL_PARAM_CHECK(pp_resource);    
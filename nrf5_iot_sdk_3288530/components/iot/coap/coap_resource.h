@@ -39,9 +39,13 @@
 uint32_t coap_resource_init(void);
 
 /**@brief Find a resource by traversing the resource names.
+ *
+ * @details Each path segment has to match the name of the resource exactly, a segment "temp" does
+ *          not locate a resource named "temperature".
  *
  * @param[out] p_resource      Located resource.
- * @param[in]  pp_uri_pointers Array of strings which forms the hierarchical path to the resource.
+ * @param[in]  pp_uri_pointers Array of zero terminated strings which forms the hierarchical path
+ *                             to the resource.
  * @param[in]  num_of_uris     Number of URIs supplied through the path pointer list.
  *
  * @retval NRF_SUCCESS             The resource was instance located. 
@@ -53,6 +57,37 @@ uint32_t coap_resource_get(coap_resource_t ** p_resource,
                            uint8_t            num_of_uris);
 
 
+/**@brief Find a resource by traversing the resource names, given as segments with a length.
+ *
+ * @details Each path segment is resolved by a lookup on its parent and its name, and has to
+ *          match the name of the resource exactly. Used by CoAP to resolve the Uri-Path options
+ *          of a request in place.
+ *
+ * @param[out] p_resource      Located resource.
+ * @param[in]  pp_uri_pointers Array of path segments which forms the hierarchical path to the
+ *                             resource. The segments do not have to be zero terminated.
+ * @param[in]  p_uri_lengths   Array with the length of each path segment.
+ * @param[in]  num_of_uris     Number of URIs supplied through the path pointer list.
+ *
+ * @retval NRF_SUCCESS             The resource was instance located. 
+ * @retval NRF_ERROR_NOT_FOUND     The resource was not located.
+ * @retval NRF_ERROR_INVALID_STATE If no resource has been registered.
+ */
+uint32_t coap_resource_segments_get(coap_resource_t ** p_resource,
+                                    uint8_t **         pp_uri_pointers,
+                                    uint16_t *         p_uri_lengths,
+                                    uint8_t            num_of_uris);
+
+
+/**@brief Get the revision of the resource tree.
+ *
+ * @details The revision changes every time a resource is created or added to the tree, and can
+ *          be used to detect that information derived from the tree has to be refreshed.
+ *
+ * @retval Current revision of the resource tree.
+ */
+uint32_t coap_resource_revision_get(void);
+
 /**@brief Process the request related to the resource. 
  * 
  * @details When a request is received and the resource has successfully been located it
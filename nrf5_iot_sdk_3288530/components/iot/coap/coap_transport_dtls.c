@@ -475,16 +475,14 @@ uint32_t non_secure_datagram_write(const coap_remote_t * p_remote,
     {
         socket.socket_id = m_port_table[index].socket_id;
 
-        // Make a copy of the data onto the buffer.
-        memcpy(p_buffer->p_payload, p_data, datalen);
-
-        // Send on UDP port.
-        err_code = udp6_socket_sendto(&socket,
-                                      &remote_addr,
-                                      p_remote->port_number,
-                                      p_buffer);
-
-        COAPT_TRC("[CoAP-DTLS]: port_write->udp6_socket_sendto result 0x%08X \r\n", err_code);
+        // Send on UDP port, UDP copies the data onto the buffer.
+        err_code = udp6_socket_data_sendto(&socket,
+                                           &remote_addr,
+                                           p_remote->port_number,
+                                           p_buffer,
+                                           p_data);
+
+        COAPT_TRC("[CoAP-DTLS]: port_write->udp6_socket_data_sendto result 0x%08X \r\n", err_code);
         if (err_code != NRF_SUCCESS)
         {
             // Free the allocated buffer as send procedure has failed.
@@ -806,7 +804,7 @@ void coap_transport_process(void)
                 uint8_t  * p_data      = NULL;
                 uint32_t   buffer_size = datalen;
 
-                err_code = nrf_mem_reserve(&p_data, &buffer_size);
+                err_code = nrf_mem_reserve_tagged(&p_data, &buffer_size, NRF_MEM_TAG_COAP);
 
                 if (p_data != NULL)
                 {
@@ -184,16 +184,14 @@ uint32_t coap_transport_write(const coap_port_t    * p_port,
             {
                 socket.socket_id = m_port_table[index].socket_id;
 
-                //Make a copy of the data onto the buffer.
-                memcpy (p_buffer->p_payload, p_data, datalen);
-                
                 COAP_MUTEX_UNLOCK();
                 
-                //Send on UDP port.
-                err_code = udp6_socket_sendto(&socket,
-                                              &remote_addr,
-                                              p_remote->port_number,
-                                              p_buffer);
+                //Send on UDP port, UDP copies the data onto the buffer.
+                err_code = udp6_socket_data_sendto(&socket,
+                                                   &remote_addr,
+                                                   p_remote->port_number,
+                                                   p_buffer,
+                                                   p_data);
                 
                 COAP_MUTEX_LOCK();
                 
@@ -335,7 +335,9 @@ static uint32_t internal_fwrite(iot_file_t * p_file, const void * p_data, uint32
     p_instance->param.block_size = size;
     FILE_TRC("[FILE][PSRaw]: ALLOC buffer.\r\n");
 
-    err_code = nrf_mem_reserve(&p_instance->p_op_buffer, (uint32_t *)&p_instance->param.block_size);
+    err_code = nrf_mem_reserve_tagged(&p_instance->p_op_buffer,
+                                      (uint32_t *)&p_instance->param.block_size,
+                                      NRF_MEM_TAG_FILE);
     if (err_code != NRF_SUCCESS)
     {
         FILE_ERR("[FILE][PSRaw]: Cannot allocate temporary buffer (%lu bytes). Reason: %08lx.\r\n",
@@ -641,7 +643,9 @@ static uint32_t internal_fopen(iot_file_t * p_file, uint32_t requested_size)
         fpstorage_instance_t * p_last = &m_flash;
         find_last(&p_last);
 
-        err_code = nrf_mem_reserve((uint8_t **)&p_file->p_buffer, &size_alloc);
+        err_code = nrf_mem_reserve_tagged((uint8_t **)&p_file->p_buffer,
+                                          &size_alloc,
+                                          NRF_MEM_TAG_FILE);
         if (err_code != NRF_SUCCESS)
         {
             FILE_ERR("[FILE][PSRaw]: Failed to allocate second instance.\r\n");
@@ -768,7 +768,7 @@ uint32_t dns6_query(const char * p_hostname, dns6_evt_handler_t evt_handler)
     hostname_length = strlen(p_hostname) + 1;
 
     // Allocate memory to make copy of hostname string.
-    err_code = nrf_mem_reserve(&p_hostname_buff, &hostname_length);
+    err_code = nrf_mem_reserve_tagged(&p_hostname_buff, &hostname_length, NRF_MEM_TAG_DNS6);
 
     if (err_code == NRF_SUCCESS)
     {
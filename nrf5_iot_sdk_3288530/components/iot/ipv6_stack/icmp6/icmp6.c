@@ -328,17 +328,20 @@ static uint32_t app_notify_icmp_data(iot_interface_t  * p_interface,
 
 /**@brief Function for responding on ECHO REQUEST message.
  *
- * @param[in]   p_interface   Pointer to external interface from which packet come.
- * @param[in]   p_ip_header   Pointer to IPv6 Header.
- * @param[in]   p_icmp_header Pointer to ICMPv6 header.
- * @param[in]   p_packet      Pointer to packet buffer.
+ * @param[in]   p_interface      Pointer to external interface from which packet come.
+ * @param[in]   p_ip_header      Pointer to IPv6 Header.
+ * @param[in]   p_icmp_header    Pointer to ICMPv6 header.
+ * @param[in]   p_packet         Pointer to packet buffer.
+ * @param[in]   request_checksum Verified checksum of the request, in network byte order. The
+ *                               header given to the application has it in host byte order.
  *
  * @return      NRF_SUCCESS after successful processing, error otherwise. 
  */
 static void echo_reply_send(iot_interface_t  * p_interface,
                             ipv6_header_t    * p_ip_header,
                             icmp6_header_t   * p_icmp_header,
-                            iot_pbuffer_t    * p_packet)
+                            iot_pbuffer_t    * p_packet,
+                            uint16_t           request_checksum)
 {
     uint32_t                    err_code;
     uint16_t                    checksum;
@@ -397,22 +400,31 @@ static void echo_reply_send(iot_interface_t  * p_interface,
         p_reply_echo_header->identifier      = p_echo_header->identifier;
         p_reply_echo_header->sequence_number = p_echo_header->sequence_number;
 
-        // Copy user data.       
+        // Copy user data.
         memcpy(p_pbuffer->p_payload + ICMP6_ECHO_REQUEST_PAYLOAD_OFFSET,
                p_packet->p_payload  + ICMP6_ECHO_REQUEST_PAYLOAD_OFFSET,
                p_packet->length     - ICMP6_ECHO_REQUEST_PAYLOAD_OFFSET);
 
-        // Calculate checksum.
-        checksum = p_pbuffer->length + ICMP6_HEADER_SIZE + IPV6_NEXT_HEADER_ICMP6;
+        // The reply only differs from the verified request in type and code, and in the source
+        // address of a reply to a multicast request. Update the checksum of the request instead
+        // of summing the packet again. The swapped addresses do not change the sum.
+        const uint8_t request_type_code[2] = { p_icmp_header->type, p_icmp_header->code };
+        const uint8_t reply_type_code[2]   = { ICMP6_TYPE_ECHO_REPLY, 0 };
 
-        ipv6_checksum_calculate(p_reply_ip_header->srcaddr.u8, IPV6_ADDR_SIZE, &checksum, false);
-        ipv6_checksum_calculate(p_reply_ip_header->destaddr.u8, IPV6_ADDR_SIZE, &checksum, false);
-        ipv6_checksum_calculate(p_pbuffer->p_payload - ICMP6_HEADER_SIZE,
-                                p_pbuffer->length + ICMP6_HEADER_SIZE, 
-                                &checksum,
-                                false);
+        checksum = NTOHS(request_checksum);
+
+        ipv6_checksum_update(&checksum, request_type_code, reply_type_code, 2, false);
+
+        if(IPV6_ADDRESS_IS_MULTICAST(&p_ip_header->destaddr))
+        {
+            ipv6_checksum_update(&checksum,
+                                 p_ip_header->destaddr.u8,
+                                 p_reply_ip_header->srcaddr.u8,
+                                 IPV6_ADDR_SIZE,
+                                 false);
+        }
 
-        p_reply_icmp_header->checksum = HTONS((~checksum));
+        p_reply_icmp_header->checksum = HTONS(checksum);
 
         p_pbuffer->p_payload -= ICMP6_OFFSET;
         p_pbuffer->length    += ICMP6_OFFSET;
@@ -951,6 +963,7 @@ uint32_t icmp6_input(iot_interface_t  * p_interface,
     uint32_t              process_result = NRF_SUCCESS;
     bool                  is_ndisc       = false;
     icmp6_header_t      * p_icmp_header  = (icmp6_header_t *)p_packet->p_payload;
+    uint16_t              icmp_checksum  = p_icmp_header->checksum;
     icmp6_echo_header_t * p_echo_header  = NULL;
     uint32_t              err_code       = NRF_SUCCESS;
 
@@ -1041,9 +1054,10 @@ uint32_t icmp6_input(iot_interface_t  * p_interface,
 #endif
 
 #if (ICMP6_ENABLE_HANDLE_ECHO_REQUEST_TO_APPLICATION == 0)
-    if(p_icmp_header->type == ICMP6_TYPE_ECHO_REQUEST)
+    // Only a request with a valid checksum is answered, the reply checksum is derived from it.
+    if((process_result == NRF_SUCCESS) && (p_icmp_header->type == ICMP6_TYPE_ECHO_REQUEST))
     {
-        echo_reply_send(p_interface, p_ip_header, p_icmp_header, p_packet);
+        echo_reply_send(p_interface, p_ip_header, p_icmp_header, p_packet, icmp_checksum);
     }
 #endif
 
@@ -1052,6 +1066,7 @@ uint32_t icmp6_input(iot_interface_t  * p_interface,
     UNUSED_VARIABLE(is_ndisc);
     UNUSED_VARIABLE(p_echo_header);
     UNUSED_VARIABLE(process_result);
+    UNUSED_VARIABLE(icmp_checksum);
 
     SDK_MUTEX_UNLOCK();
 
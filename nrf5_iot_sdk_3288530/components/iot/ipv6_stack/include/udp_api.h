@@ -37,6 +37,17 @@ typedef struct
   void       * p_app_data;                                                                          /**< Pointer to application data mapped by the application to the socket. If no mapping is provided by the application using the @ref udp6_socket_app_data_set API, this pointer is NULL. */
 } udp6_socket_t;
 
+/**
+ * @brief UDP socket receive statistics.
+ */
+typedef struct
+{
+  uint32_t     rx_packets;                                                                          /**< Number of datagrams received on the socket, including datagrams with errors. */
+  uint32_t     rx_bytes;                                                                            /**< Number of UDP payload bytes received on the socket. */
+  uint32_t     rx_errors;                                                                           /**< Number of datagrams received truncated, malformed or with a bad checksum. */
+  uint32_t     rx_dropped;                                                                          /**< Number of datagrams dropped because no receive callback was registered. */
+} udp6_socket_stats_t;
+
 /**
  * @brief   UDP data receive callback.
  *
@@ -197,6 +208,33 @@ uint32_t udp6_socket_sendto(const udp6_socket_t * p_socket,
                             iot_pbuffer_t       * p_packet);
 
 
+/**
+ * @brief   Copies data into a UDP packet and sends it on a specific socket to a remote address
+ *          and port.
+ *
+ * @details Same as \ref udp6_socket_sendto, except that the payload is copied from p_data into
+ *          the packet buffer in the same pass that computes the UDP checksum, instead of being
+ *          copied by the application and read again by the checksum.
+ *
+ * @param[in] p_socket     Handle reference to the socket. Should not be NULL.
+ * @param[in] p_dest_addr  IPv6 address of the remote destination.
+ * @param[in] dest_port    Remote UDP port to which data transmission is requested.
+ * @param[in] p_packet     Packet buffer allocated with type UDP6_PACKET_TYPE using \ref
+ *                         iot_pbuffer_allocate, with p_packet->length set to the length of the
+ *                         payload. The payload does not need to be populated.
+ * @param[in] p_data       Payload to be copied into p_packet. Should not be NULL.
+ *
+ * @retval NRF_SUCCESS  If the procedure was executed successfully. Otherwise, an
+ * error code that indicates the reason for the failure is returned.
+ *
+ */
+uint32_t udp6_socket_data_sendto(const udp6_socket_t * p_socket,
+                                 const ipv6_addr_t   * p_dest_addr,
+                                 uint16_t              dest_port,
+                                 iot_pbuffer_t       * p_packet,
+                                 const uint8_t       * p_data);
+
+
 /**
  * @brief   Sets application data for a socket.
  *
@@ -215,6 +253,20 @@ uint32_t udp6_socket_sendto(const udp6_socket_t * p_socket,
  */
 uint32_t udp6_socket_app_data_set(const udp6_socket_t * p_socket);
 
+
+/**
+ * @brief   Gets the receive statistics of a socket.
+ *
+ * @details The statistics are cleared when the socket is freed.
+ *
+ * @param[in]  p_socket  Pointer to the socket for which the statistics are requested.
+ * @param[out] p_stats   Pointer to the memory where the statistics are copied.
+ *
+ * @retval NRF_SUCCESS If the procedure was executed successfully. Otherwise, an
+ * error code that indicates the reason for the failure is returned.
+ */
+uint32_t udp6_socket_stats_get(const udp6_socket_t * p_socket, udp6_socket_stats_t * p_stats);
+
 #endif //UDP_API_H__
 
 /**@} */
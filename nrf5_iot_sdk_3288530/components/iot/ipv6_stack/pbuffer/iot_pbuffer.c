@@ -127,15 +127,31 @@
 /** @} */
 
 /** @brief Packet buffer type managed by the module. */
-typedef struct
+typedef struct pbuffer_s
 {
-   iot_pbuffer_t  buffer;                                                                     /**< Packet buffer being managed. */
-   uint32_t       allocated_length;                                                           /**< Length allocated for the buffer. */
+   iot_pbuffer_t      buffer;                                                                 /**< Packet buffer being managed. */
+   uint32_t           allocated_length;                                                       /**< Length allocated for the buffer. */
+   struct pbuffer_s * p_next;                                                                 /**< Next free packet buffer, only valid while the buffer is on the free list. */
 }pbuffer_t;
 
 SDK_MUTEX_DEFINE(m_pbuffer_mutex)                                                             /**< Mutex variable. Currently unused, this declaration does not occupy any space in RAM. */
-static bool      m_initialization_state  = false;                                             /**< Variable to maintain module initialization state. */
-static pbuffer_t m_pbuffer[IOT_PBUFFER_MAX_COUNT];                                            /**< Table of packet buffers managed by the module. */
+static bool                m_initialization_state  = false;                                   /**< Variable to maintain module initialization state. */
+static pbuffer_t           m_pbuffer[IOT_PBUFFER_MAX_COUNT];                                  /**< Table of packet buffers managed by the module. */
+static pbuffer_t         * mp_free_head;                                                      /**< Head of the list of free packet buffers. */
+static iot_pbuffer_stats_t m_stats;                                                          /**< Statistics of the module. */
+
+/**@brief Headroom, in bytes, provisioned in front of the payload for each packet type so that the
+ *        lower layers can prepend their headers in place. Indexed by iot_pbuffer_type_t.
+ */
+static const uint8_t m_type_offset[COAP_PACKET_TYPE + 1] =
+{
+    0,                                                                                        /**< UNASSIGNED_TYPE. */
+    0,                                                                                        /**< RAW_PACKET_TYPE. */
+    IPV6_IP_HEADER_SIZE,                                                                      /**< IPV6_PACKET_TYPE. */
+    IPV6_IP_HEADER_SIZE + ICMP6_HEADER_SIZE,                                                  /**< ICMP6_PACKET_TYPE. */
+    IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE,                                                    /**< UDP6_PACKET_TYPE. */
+    IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE + COAP_HEADER_SIZE                                  /**< COAP_PACKET_TYPE. */
+};
 
 
 /**@brief Initializes packet buffer. */
@@ -149,92 +165,65 @@ static void pbuffer_init(pbuffer_t * p_buffer)
 }
 
 
-/**@brief Get size of offset to be used based on the requested type. */
-static uint32_t type_offset_get(iot_pbuffer_type_t type)
+/**@brief Returns a packet buffer to the free list. */
+static void pbuffer_release(pbuffer_t * p_buffer)
 {
-    uint32_t offset = 0;
+    pbuffer_init(p_buffer);
 
-    switch(type)
-    {
-        case RAW_PACKET_TYPE:
-        {
-            offset = 0;
-            break;
-        }
-        case IPV6_PACKET_TYPE:
-        {
-           offset = IPV6_IP_HEADER_SIZE;
-           break;
-        }
-        case ICMP6_PACKET_TYPE:
-        {
-            offset = IPV6_IP_HEADER_SIZE + ICMP6_HEADER_SIZE;
-            break;
-        }
-        case UDP6_PACKET_TYPE:   //Fall through.
-        {
-            offset = IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE;
-            break;
-        }
-        case COAP_PACKET_TYPE:
-        {
-            offset = IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE + COAP_HEADER_SIZE;
-            break;
-        }
-        default:
-        {
-            //Should never happen.
-            break;
-        }
-    }
+    p_buffer->p_next = mp_free_head;
+    mp_free_head     = p_buffer;
 
-    return offset;
+    m_stats.in_use--;
 }
 
 
-/**@brief Allocates 'length' sized packet buffer. */
+/**@brief Allocates 'length' sized packet buffer.
+ *
+ * @details The descriptor is taken from the head of the free list, and is only taken once the
+ *          memory for it has been reserved, so that nothing needs to be undone on failure.
+ */
 static uint32_t pbuffer_allocate(pbuffer_t ** pp_buffer, uint32_t length, iot_pbuffer_flags_t flags)
 {
-    uint32_t index;
-    uint32_t err_code = (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE);
+    uint32_t    err_code = NRF_SUCCESS;
+    uint8_t   * p_memory = NULL;
+    pbuffer_t * p_buffer = mp_free_head;
 
+    if (p_buffer == NULL)
+    {
+        PBUFFER_ERR("[PBUFFER]: No free packet buffer.\r\n");
+        m_stats.alloc_failures++;
+        return (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE);
+    }
 
-    for (index = 0; index < IOT_PBUFFER_MAX_COUNT; index ++)
+    if (flags == PBUFFER_FLAG_DEFAULT)
     {
-        if (m_pbuffer[index].allocated_length == 0)
+        err_code = nrf_mem_reserve_tagged(&p_memory, &length, NRF_MEM_TAG_PBUFFER);
+        if (err_code != NRF_SUCCESS)
         {
-            //Found a free buffer, allocate.
-            PBUFFER_TRC("[PBUFFER]: Found free buffer. Requesting memory allocation.\r\n");
+            PBUFFER_ERR("[PBUFFER]: Failed to allocate memory for packet buffer of size %ld\r\n",
+                        length);
+            m_stats.alloc_failures++;
+            return err_code;
+        }
+    }
 
-            m_pbuffer[index].allocated_length = length;
+    mp_free_head = p_buffer->p_next;
 
-            if (flags == PBUFFER_FLAG_DEFAULT)
-            {
-                err_code = nrf_mem_reserve(&m_pbuffer[index].buffer.p_memory, &m_pbuffer[index].allocated_length);
-                if (err_code == NRF_SUCCESS)
-                {
-                    PBUFFER_TRC("[PBUFFER]:  Allocated pbuffer at index 0x%08lX\r\n", index);
-                    (*pp_buffer)  = &m_pbuffer[index];
-                }
-                else
-                {
-                   PBUFFER_ERR("[PBUFFER]: Failed to allocate memory for packet buffer of size %ld\r\n",
-                               length);
-                    m_pbuffer[index].allocated_length  = 0;
-                }
-            }
-            else
-            {
-                PBUFFER_TRC("[PBUFFER]:  Allocated pbuffer at index 0x%08lX without any memory "
-                            "allocation.\r\n", index);
-                (*pp_buffer)  = &m_pbuffer[index];
-                err_code = NRF_SUCCESS;
-            }
-            break;
-        }
+    p_buffer->buffer.p_memory  = p_memory;
+    p_buffer->allocated_length = length;
+
+    m_stats.in_use++;
+    if (m_stats.in_use > m_stats.peak_in_use)
+    {
+        m_stats.peak_in_use = m_stats.in_use;
     }
 
-    return err_code;
+    PBUFFER_TRC("[PBUFFER]: Allocated pbuffer at index 0x%08lX\r\n",
+                (uint32_t)(p_buffer - m_pbuffer));
+
+    (*pp_buffer) = p_buffer;
+
+    return NRF_SUCCESS;
 }
 
 
@@ -244,8 +233,9 @@ static uint32_t pbuffer_find(pbuffer_t ** p_internal_buffer, iot_pbuffer_t * p_b
     const uint32_t size  = sizeof (pbuffer_t);
     const uint32_t diff  = (((uint32_t)p_buffer) - ((uint32_t)m_pbuffer));
 
-    if ((diff > (size * IOT_PBUFFER_MAX_COUNT)) ||
-        ((diff % size) != 0))
+    if ((diff >= (size * IOT_PBUFFER_MAX_COUNT)) ||
+        ((diff % size) != 0)                     ||
+        (p_buffer->type == UNASSIGNED_TYPE))
     {
         return (NRF_ERROR_INVALID_ADDR | IOT_PBUFFER_ERR_BASE);
     }
@@ -266,11 +256,19 @@ uint32_t iot_pbuffer_init(void)
 
     PBUFFER_MUTEX_LOCK();
 
-    for(index = 0; index < IOT_PBUFFER_MAX_COUNT; index++)
+    mp_free_head = NULL;
+
+    for(index = IOT_PBUFFER_MAX_COUNT; index > 0; index--)
     {
-        pbuffer_init(&m_pbuffer[index]);
+        pbuffer_init(&m_pbuffer[index - 1]);
+
+        m_pbuffer[index - 1].p_next = mp_free_head;
+        mp_free_head                = &m_pbuffer[index - 1];
     }
 
+    memset(&m_stats, 0, sizeof(m_stats));
+    m_stats.pool_size = IOT_PBUFFER_MAX_COUNT;
+
     m_initialization_state = true;
 
     PBUFFER_TRC("[PBUFFER]: << iot_pbuffer_init\r\n");
@@ -300,7 +298,7 @@ uint32_t iot_pbuffer_allocate(iot_pbuffer_alloc_param_t    *  p_param,
     pbuffer_t * p_alloc_buffer;
 
     //Get offset to be added to length.
-    offset = type_offset_get(p_param->type);
+    offset = m_type_offset[p_param->type];
 
     err_code = pbuffer_allocate(&p_alloc_buffer, ((p_param->length) + offset), p_param->flags);
     if (err_code == NRF_SUCCESS)
@@ -348,9 +346,11 @@ uint32_t iot_pbuffer_reallocate(iot_pbuffer_alloc_param_t  * p_param,
     if (err_code == NRF_SUCCESS)
     {
         //Get realloc_len to be added to length.
-        const uint32_t offset = type_offset_get(p_param->type);
+        const uint32_t offset = m_type_offset[p_param->type];
         realloc_len = p_param->length + offset;
 
+        m_stats.realloc_count++;
+
         // Check if requested length cannot be accommodated in the allocated buffer.
         if (realloc_len > p_alloc_buffer->allocated_length)
         {
@@ -359,20 +359,36 @@ uint32_t iot_pbuffer_reallocate(iot_pbuffer_alloc_param_t  * p_param,
 
             if (p_param->flags != PBUFFER_FLAG_NO_MEM_ALLOCATION)
             {
-                err_code = nrf_mem_reserve(&p_new_mem, &realloc_len);
+                err_code = nrf_mem_reserve_tagged(&p_new_mem, &realloc_len, NRF_MEM_TAG_PBUFFER);
                 if (err_code == NRF_SUCCESS)
                 {
-                    // Copy data into the new buffer.
-                    memcpy (p_new_mem,
-                            p_pbuffer->p_memory,
-                            p_alloc_buffer->allocated_length);
+                    if (p_alloc_buffer->buffer.p_memory != NULL)
+                    {
+                        // Copy only the headroom and payload in use into the new buffer.
+                        uint32_t used_len = p_alloc_buffer->allocated_length;
+
+                        if (p_alloc_buffer->buffer.p_payload != NULL)
+                        {
+                            used_len = MIN(used_len,
+                                           (uint32_t)(p_alloc_buffer->buffer.p_payload -
+                                                      p_alloc_buffer->buffer.p_memory) +
+                                           p_alloc_buffer->buffer.length);
+                        }
 
-                    // Now free the old buffer. Perform the free
-                    nrf_free(p_alloc_buffer->buffer.p_memory);
+                        memcpy(p_new_mem, p_alloc_buffer->buffer.p_memory, used_len);
+
+                        // Now free the old buffer.
+                        nrf_free(p_alloc_buffer->buffer.p_memory);
+                    }
 
                     p_alloc_buffer->allocated_length = realloc_len;
                     p_alloc_buffer->buffer.p_memory  = p_new_mem;
-                    p_alloc_buffer->buffer.length    = p_param->length;
+
+                    m_stats.realloc_copies++;
+                }
+                else
+                {
+                    m_stats.alloc_failures++;
                 }
             }
         }
@@ -390,7 +406,7 @@ uint32_t iot_pbuffer_reallocate(iot_pbuffer_alloc_param_t  * p_param,
     }
     else
     {
-        PBUFFER_ERR("[PBUFFER]: Cannot find buffer to be freed.\r\n");
+        PBUFFER_ERR("[PBUFFER]: Cannot find buffer to be reallocated.\r\n");
     }
 
     PBUFFER_MUTEX_UNLOCK();
@@ -421,7 +437,7 @@ uint32_t iot_pbuffer_free(iot_pbuffer_t  * p_pbuffer, bool free_flag)
         {
             nrf_free(p_alloc_buffer->buffer.p_memory);
         }
-        pbuffer_init(p_alloc_buffer);
+        pbuffer_release(p_alloc_buffer);
     }
     else
     {
@@ -434,3 +450,18 @@ uint32_t iot_pbuffer_free(iot_pbuffer_t  * p_pbuffer, bool free_flag)
 
     return err_code;
 }
+
+
+uint32_t iot_pbuffer_stats_get(iot_pbuffer_stats_t * p_stats)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    NULL_PARAM_CHECK(p_stats);
+
+    PBUFFER_MUTEX_LOCK();
+
+    (*p_stats) = m_stats;
+
+    PBUFFER_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
@@ -19,7 +19,10 @@
  *
  * @details This module interfaces with the Memory Manager to allocate packet buffers
  *          for the IPv6 stack layers, without each layer having to ensure 
- *          sufficient header space for layers below.
+ *          sufficient header space for layers below. Headroom for the headers of the layers
+ *          below is reserved in front of the payload based on the packet type, so that each
+ *          layer prepends its header in place. Packet buffers are taken from a fixed pool of
+ *          IOT_PBUFFER_MAX_COUNT descriptors in constant time.
  */
 #ifndef IOT_PBUFFER__
 #define IOT_PBUFFER__
@@ -71,6 +74,18 @@ typedef struct
 }iot_pbuffer_alloc_param_t;
 
 
+/**@brief Statistics of the packet buffer pool. */
+typedef struct
+{
+    uint32_t             pool_size;                                                      /**< Number of packet buffers in the pool, configured by IOT_PBUFFER_MAX_COUNT. */
+    uint32_t             in_use;                                                         /**< Number of packet buffers currently allocated. The pool depth is pool_size - in_use. */
+    uint32_t             peak_in_use;                                                    /**< Largest number of packet buffers allocated at the same time. */
+    uint32_t             alloc_failures;                                                 /**< Number of allocations and reallocations that failed, because either the pool or the memory manager was exhausted. */
+    uint32_t             realloc_count;                                                  /**< Number of reallocation requests. */
+    uint32_t             realloc_copies;                                                 /**< Number of reallocations that did not fit the allocated memory and had to move the data. */
+}iot_pbuffer_stats_t;
+
+
 /**@brief Function for initializing the module.
  *
  * @retval NRF_SUCCESS If the module was successfully initialized. Otherwise, an error code that indicates the reason for the failure is returned.
@@ -135,6 +150,16 @@ uint32_t iot_pbuffer_reallocate(iot_pbuffer_alloc_param_t  * p_param,
  */
 uint32_t iot_pbuffer_free(iot_pbuffer_t  * p_pbuffer, bool free_flag);
 
+
+/**@brief Function for reading the statistics of the packet buffer pool.
+ *
+ * @param[out] p_stats   Pointer to the structure to be filled with the statistics. This parameter
+ *                       shall not be NULL.
+ *
+ * @retval NRF_SUCCESS If the statistics were successfully read. Otherwise, an error code that indicates the reason for the failure is returned.
+ */
+uint32_t iot_pbuffer_stats_get(iot_pbuffer_stats_t * p_stats);
+
 #endif // IOT_PBUFFER__
 
 /**@} */
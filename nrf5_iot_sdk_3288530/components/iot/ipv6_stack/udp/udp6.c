@@ -124,22 +124,40 @@
 /** @} */
 
 #define UDP_PORT_FREE  0                                                                 /**< Reserved port of the socket, indicates that port is free. */
+#define UDP_SOCKET_NONE 0xFFFF                                                           /**< Index indicating the end of a socket list. */
+
+#ifndef UDP6_PORT_HASH_SIZE
+#define UDP6_PORT_HASH_SIZE 8                                                            /**< Number of buckets of the table used to find sockets by local port. Must be a power of two. */
+#endif
+
+#if ((UDP6_PORT_HASH_SIZE == 0) || ((UDP6_PORT_HASH_SIZE & (UDP6_PORT_HASH_SIZE - 1)) != 0))
+#error "UDP6_PORT_HASH_SIZE must be a power of two."
+#endif
+
+#if (UDP6_MAX_SOCKET_COUNT >= UDP_SOCKET_NONE)
+#error "UDP6_MAX_SOCKET_COUNT is too large."
+#endif
 
 /**@brief UDP Socket Data needed by the module to manage it. */
 typedef struct
 {
-    uint16_t           local_port;                                                       /**< Local Port of the socket. */
-    uint16_t           remote_port;                                                      /**< Remote port of the socket. */
-    ipv6_addr_t        local_addr;                                                       /**< Local IPv6 Address of the socket. */
-    ipv6_addr_t        remote_addr;                                                      /**< Remote IPv6 Address of the socket. */
-    udp6_handler_t     rx_cb;                                                            /**< Callback registered by application to receive data on the socket. */
-    void             * p_app_data;                                                       /**< Application data mapped to the socket using the udp6_app_data_set. */
+    uint16_t            local_port;                                                      /**< Local Port of the socket. */
+    uint16_t            remote_port;                                                     /**< Remote port of the socket. */
+    ipv6_addr_t         local_addr;                                                      /**< Local IPv6 Address of the socket. */
+    ipv6_addr_t         remote_addr;                                                     /**< Remote IPv6 Address of the socket. */
+    udp6_handler_t      rx_cb;                                                           /**< Callback registered by application to receive data on the socket. */
+    void              * p_app_data;                                                      /**< Application data mapped to the socket using the udp6_app_data_set. */
+    udp6_socket_stats_t stats;                                                           /**< Receive statistics of the socket. */
+    uint16_t            next;                                                            /**< Next socket in the port hash bucket if the socket is bound, or in the free list if not allocated. */
+    bool                allocated;                                                       /**< Indicates if the socket is allocated. */
 } udp_socket_entry_t;
 
 
 SDK_MUTEX_DEFINE(m_udp_mutex)                                                            /**< Mutex variable. Currently unused, this declaration does not occupy any space in RAM. */
 static bool      m_initialization_state  = false;                                        /**< Variable to maintain module initialization state. */
 static udp_socket_entry_t  m_socket[UDP6_MAX_SOCKET_COUNT];                                        /**< Table of sockets managed by the module. */
+static uint16_t  m_port_hash[UDP6_PORT_HASH_SIZE];                                       /**< Bound sockets, hashed on the local port. */
+static uint16_t  m_free_head;                                                            /**< First socket that is not allocated. */
 
 
 /** @brief Initializes socket managed by the module. */
@@ -149,27 +167,82 @@ static void udp_socket_init(udp_socket_entry_t * p_socket)
     p_socket->remote_port = UDP_PORT_FREE;
     p_socket->rx_cb       = NULL;
     p_socket->p_app_data  = NULL;
+    p_socket->next        = UDP_SOCKET_NONE;
+    p_socket->allocated   = false;
     IPV6_ADDRESS_INITIALIZE(&p_socket->local_addr);
     IPV6_ADDRESS_INITIALIZE(&p_socket->remote_addr);
+    memset(&p_socket->stats, 0, sizeof(udp6_socket_stats_t));
 }
 
+
+/** @brief Get the port hash bucket of a port, given in either byte order. */
+static uint32_t port_hash_get(uint16_t port)
+{
+    return ((uint32_t)port ^ ((uint32_t)port >> 8)) & (UDP6_PORT_HASH_SIZE - 1);
+}
+
+
 /**
- * @brief Find UDP socket based on local port. If found its index to m_socket table is returned.
- *        else  UDP6_MAX_SOCKET_COUNT is returned.
+ * @brief Link a bound socket in its port hash bucket. A port is bound by one socket only, so the
+ *        order of the sockets in a bucket does not matter.
  */
-static uint32_t socket_find(uint16_t port)
+static void port_hash_link(uint32_t index)
 {
-    uint32_t index;
+    uint16_t * p_link = &m_port_hash[port_hash_get(m_socket[index].local_port)];
+
+    m_socket[index].next = *p_link;
+    *p_link              = (uint16_t)index;
+}
 
-    for (index = 0; index < UDP6_MAX_SOCKET_COUNT; index++)
+
+/** @brief Unlink a bound socket from its port hash bucket. */
+static void port_hash_unlink(uint32_t index)
+{
+    uint16_t * p_link = &m_port_hash[port_hash_get(m_socket[index].local_port)];
+
+    while (*p_link != UDP_SOCKET_NONE)
     {
-        if (m_socket[index].local_port == port)
+        if (*p_link == index)
         {
+            *p_link              = m_socket[index].next;
+            m_socket[index].next = UDP_SOCKET_NONE;
             break;
         }
+
+        p_link = &m_socket[*p_link].next;
+    }
+}
+
+
+/**
+ * @brief Find the socket a datagram is intended for. If found its index to m_socket table is
+ *        returned, else UDP6_MAX_SOCKET_COUNT is returned.
+ */
+static uint32_t socket_match(const ipv6_header_t * p_ip_header, const udp6_header_t * p_udp_header)
+{
+    uint32_t index = m_port_hash[port_hash_get(p_udp_header->destport)];
+
+    while (index != UDP_SOCKET_NONE)
+    {
+        const udp_socket_entry_t * p_entry = &m_socket[index];
+
+        // Compare ports before any address.
+        if ((p_entry->local_port == p_udp_header->destport) &&
+            ((p_entry->remote_port == 0) || (p_entry->remote_port == p_udp_header->srcport)))
+        {
+            if(((0 == IPV6_ADDRESS_CMP(&p_entry->local_addr, IPV6_ADDR_ANY)) ||
+                (0 == IPV6_ADDRESS_CMP(&p_entry->local_addr, &p_ip_header->destaddr))) &&
+               ((0 == IPV6_ADDRESS_CMP(&p_entry->remote_addr, IPV6_ADDR_ANY)) ||
+                (0 == IPV6_ADDRESS_CMP(&p_entry->remote_addr, &p_ip_header->srcaddr))))
+            {
+                return index;
+            }
+        }
+
+        index = p_entry->next;
     }
 
-    return index;
+    return UDP6_MAX_SOCKET_COUNT;
 }
 
 
@@ -186,6 +259,22 @@ uint32_t udp_init(void)
     for(index = 0; index < UDP6_MAX_SOCKET_COUNT; index++)
     {
         udp_socket_init(&m_socket[index]);
+        m_socket[index].next = (uint16_t)(index + 1);
+    }
+
+    if (UDP6_MAX_SOCKET_COUNT > 0)
+    {
+        m_socket[UDP6_MAX_SOCKET_COUNT - 1].next = UDP_SOCKET_NONE;
+        m_free_head = 0;
+    }
+    else
+    {
+        m_free_head = UDP_SOCKET_NONE;
+    }
+
+    for(index = 0; index < UDP6_PORT_HASH_SIZE; index++)
+    {
+        m_port_hash[index] = UDP_SOCKET_NONE;
     }
 
     m_initialization_state = true;
@@ -207,14 +296,18 @@ uint32_t udp6_socket_allocate(udp6_socket_t  * p_socket)
 
     UDP_MUTEX_LOCK();
 
-    //Search for an unassigned socket.
-    const uint32_t socket_id = socket_find(UDP_PORT_FREE);
+    //Take an unassigned socket from the free list.
+    const uint32_t socket_id = m_free_head;
     uint32_t       err_code  = NRF_SUCCESS;
 
-    if (socket_id != UDP6_MAX_SOCKET_COUNT)
+    if (socket_id != UDP_SOCKET_NONE)
     {
         UDP_TRC("[UDP]: Assigned socket 0x%08lX\r\n", socket_id);
 
+        m_free_head                    = m_socket[socket_id].next;
+        m_socket[socket_id].next       = UDP_SOCKET_NONE;
+        m_socket[socket_id].allocated  = true;
+
         // Found a free socket. Assign.
         p_socket->socket_id = socket_id;
     }
@@ -243,7 +336,20 @@ uint32_t udp6_socket_free(const udp6_socket_t * p_socket)
 
     UDP_MUTEX_LOCK();
 
-    udp_socket_init(&m_socket[p_socket->socket_id]);
+    udp_socket_entry_t * p_entry = &m_socket[p_socket->socket_id];
+
+    if (p_entry->allocated)
+    {
+        if (p_entry->local_port != UDP_PORT_FREE)
+        {
+            port_hash_unlink(p_socket->socket_id);
+        }
+
+        udp_socket_init(p_entry);
+
+        p_entry->next = m_free_head;
+        m_free_head   = (uint16_t)p_socket->socket_id;
+    }
 
     UDP_MUTEX_UNLOCK();
 
@@ -295,20 +401,39 @@ uint32_t udp6_socket_bind(const udp6_socket_t * p_socket,
     // Change Host Byte Order to Network Byte Order.
     src_port = HTONS(src_port);
 
-    //Check if port is already registered.
-    for (uint32_t index = 0; index < UDP6_MAX_SOCKET_COUNT; index ++)
+    if (!m_socket[p_socket->socket_id].allocated)
     {
-        if (m_socket[index].local_port == src_port)
+        // The link of a socket that is not allocated belongs to the free list.
+        err_code = (NRF_ERROR_INVALID_PARAM | IOT_UDP6_ERR_BASE);
+    }
+    else
+    {
+        //Check if port is already registered.
+        uint32_t index = m_port_hash[port_hash_get(src_port)];
+
+        while (index != UDP_SOCKET_NONE)
         {
-            err_code = UDP_PORT_IN_USE;
+            if (m_socket[index].local_port == src_port)
+            {
+                err_code = UDP_PORT_IN_USE;
+                break;
+            }
+
+            index = m_socket[index].next;
         }
     }
 
     if(err_code == NRF_SUCCESS)
     {
+        if (m_socket[p_socket->socket_id].local_port != UDP_PORT_FREE)
+        {
+            port_hash_unlink(p_socket->socket_id);
+        }
+
         m_socket[p_socket->socket_id].local_port = src_port;
         m_socket[p_socket->socket_id].local_addr = (*p_src_addr);
-        
+
+        port_hash_link(p_socket->socket_id);
     }
     UDP_MUTEX_UNLOCK();
 
@@ -333,14 +458,23 @@ uint32_t udp6_socket_connect(const udp6_socket_t * p_socket,
 
     UDP_MUTEX_LOCK();
 
-    m_socket[p_socket->socket_id].remote_port = HTONS(dest_port);
-    m_socket[p_socket->socket_id].remote_addr = (*p_dest_addr);
+    uint32_t err_code = NRF_SUCCESS;
+
+    if (m_socket[p_socket->socket_id].allocated)
+    {
+        m_socket[p_socket->socket_id].remote_port = HTONS(dest_port);
+        m_socket[p_socket->socket_id].remote_addr = (*p_dest_addr);
+    }
+    else
+    {
+        err_code = (NRF_ERROR_INVALID_PARAM | IOT_UDP6_ERR_BASE);
+    }
 
     UDP_MUTEX_UNLOCK();
 
     UDP_TRC("[UDP]: << udp6_socket_connect\r\n");
 
-    return NRF_SUCCESS;
+    return err_code;
 }
 
 
@@ -438,24 +572,23 @@ uint32_t udp6_socket_send(const udp6_socket_t * p_socket,
 }
 
 
-uint32_t udp6_socket_sendto(const udp6_socket_t    * p_socket,
-                            const ipv6_addr_t      * p_dest_addr,
-                            uint16_t                 dest_port,
-                            iot_pbuffer_t          * p_packet)
+/**@brief Send a packet of a socket to a remote address and port, computing the UDP checksum.
+ *
+ * @param[in] p_socket    Socket sending the packet.
+ * @param[in] p_dest_addr Remote address.
+ * @param[in] dest_port   Remote port.
+ * @param[in] p_packet    Packet to send, p_packet->length bytes of payload.
+ * @param[in] p_data      Payload copied to p_packet->p_payload while it is checksummed, or NULL
+ *                        if the payload is already in the packet.
+ *
+ * @retval NRF_SUCCESS if the packet was handed to IPv6, which then owns it.
+ */
+static uint32_t socket_sendto(const udp6_socket_t * p_socket,
+                              const ipv6_addr_t   * p_dest_addr,
+                              uint16_t              dest_port,
+                              iot_pbuffer_t       * p_packet,
+                              const uint8_t       * p_data)
 {
-    VERIFY_MODULE_IS_INITIALIZED();
-    NULL_PARAM_CHECK(p_socket);
-    NULL_PARAM_CHECK(p_dest_addr);
-    NULL_PARAM_CHECK(p_packet);
-    NULL_PARAM_CHECK(p_packet->p_payload);
-    VERIFY_NON_ZERO_LENGTH(p_packet->length);
-    VERIFY_SOCKET_ID(p_socket->socket_id);
-    VERIFY_PORT_NUMBER(dest_port);
-
-    UDP_TRC("[UDP]: >> udp6_socket_sendto\r\n");
-
-    UDP_MUTEX_LOCK();
-
     uint32_t err_code;
     const udp_socket_entry_t  * p_skt       = &m_socket[p_socket->socket_id];
     const uint32_t    header_size = UDP_HEADER_SIZE + IPV6_IP_HEADER_SIZE;
@@ -509,10 +642,24 @@ uint32_t udp6_socket_sendto(const udp6_socket_t    * p_socket,
 
         ipv6_checksum_calculate(p_ip_header->srcaddr.u8,  IPV6_ADDR_SIZE, &checksum, false);
         ipv6_checksum_calculate(p_ip_header->destaddr.u8, IPV6_ADDR_SIZE, &checksum, false);
-        ipv6_checksum_calculate(p_packet->p_payload - UDP_HEADER_SIZE,
-                                p_packet->length + UDP_HEADER_SIZE, 
-                                &checksum, 
-                                true);
+
+        if (p_data == NULL)
+        {
+            ipv6_checksum_calculate(p_packet->p_payload - UDP_HEADER_SIZE,
+                                    p_packet->length + UDP_HEADER_SIZE,
+                                    &checksum,
+                                    true);
+        }
+        else
+        {
+            // Copy the payload in the same pass as it is checksummed.
+            ipv6_checksum_calculate((uint8_t *)p_header, UDP_HEADER_SIZE, &checksum, false);
+            ipv6_checksum_copy_calculate(p_packet->p_payload,
+                                         p_data,
+                                         p_packet->length,
+                                         &checksum,
+                                         true);
+        }
 
         p_header->checksum = HTONS((~checksum));
 
@@ -526,6 +673,30 @@ uint32_t udp6_socket_sendto(const udp6_socket_t    * p_socket,
         err_code = UDP_INTERFACE_NOT_READY;
     }
 
+    return err_code;
+}
+
+
+uint32_t udp6_socket_sendto(const udp6_socket_t    * p_socket,
+                            const ipv6_addr_t      * p_dest_addr,
+                            uint16_t                 dest_port,
+                            iot_pbuffer_t          * p_packet)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    NULL_PARAM_CHECK(p_socket);
+    NULL_PARAM_CHECK(p_dest_addr);
+    NULL_PARAM_CHECK(p_packet);
+    NULL_PARAM_CHECK(p_packet->p_payload);
+    VERIFY_NON_ZERO_LENGTH(p_packet->length);
+    VERIFY_SOCKET_ID(p_socket->socket_id);
+    VERIFY_PORT_NUMBER(dest_port);
+
+    UDP_TRC("[UDP]: >> udp6_socket_sendto\r\n");
+
+    UDP_MUTEX_LOCK();
+
+    const uint32_t err_code = socket_sendto(p_socket, p_dest_addr, dest_port, p_packet, NULL);
+
     UDP_MUTEX_UNLOCK();
 
     UDP_TRC("[UDP]: << udp6_socket_sendto\r\n");
@@ -534,6 +705,36 @@ uint32_t udp6_socket_sendto(const udp6_socket_t    * p_socket,
 }
 
 
+uint32_t udp6_socket_data_sendto(const udp6_socket_t * p_socket,
+                                 const ipv6_addr_t   * p_dest_addr,
+                                 uint16_t              dest_port,
+                                 iot_pbuffer_t       * p_packet,
+                                 const uint8_t       * p_data)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    NULL_PARAM_CHECK(p_socket);
+    NULL_PARAM_CHECK(p_dest_addr);
+    NULL_PARAM_CHECK(p_packet);
+    NULL_PARAM_CHECK(p_packet->p_payload);
+    NULL_PARAM_CHECK(p_data);
+    VERIFY_NON_ZERO_LENGTH(p_packet->length);
+    VERIFY_SOCKET_ID(p_socket->socket_id);
+    VERIFY_PORT_NUMBER(dest_port);
+
+    UDP_TRC("[UDP]: >> udp6_socket_data_sendto\r\n");
+
+    UDP_MUTEX_LOCK();
+
+    const uint32_t err_code = socket_sendto(p_socket, p_dest_addr, dest_port, p_packet, p_data);
+
+    UDP_MUTEX_UNLOCK();
+
+    UDP_TRC("[UDP]: << udp6_socket_data_sendto\r\n");
+
+    return err_code;
+}
+
+
 uint32_t udp6_socket_app_data_set(const udp6_socket_t * p_socket)
 {
     VERIFY_MODULE_IS_INITIALIZED();
@@ -575,30 +776,10 @@ uint32_t udp_input(const iot_interface_t  * p_interface,
 
         UDP_TRC("[UDP]: >> udp_input\r\n");
 
-        uint32_t index;
         udp6_header_t * p_udp_header = (udp6_header_t *)(p_packet->p_payload);
 
         // Check to which UDP socket, port and address was bind.
-        for(index = 0; index < UDP6_MAX_SOCKET_COUNT; index ++)
-        {
-            if (m_socket[index].local_port == p_udp_header->destport)
-            {
-                if((0 == IPV6_ADDRESS_CMP(&m_socket[index].local_addr, IPV6_ADDR_ANY)) ||
-                   (0 == IPV6_ADDRESS_CMP(&m_socket[index].local_addr, &p_ip_header->destaddr)))
-                {
-                    // Check if connection was established.
-                    if(m_socket[index].remote_port == 0 || m_socket[index].remote_port == p_udp_header->srcport)
-                    {
-                        if((0 == IPV6_ADDRESS_CMP(&m_socket[index].remote_addr, IPV6_ADDR_ANY)) ||
-                           (0 == IPV6_ADDRESS_CMP(&m_socket[index].remote_addr, &p_ip_header->srcaddr)))
-                           {
-                                err_code = NRF_SUCCESS;
-                                break;
-                           }
-                    }
-                }
-            }
-        }
+        const uint32_t index = socket_match(p_ip_header, p_udp_header);
 
         if (index < UDP6_MAX_SOCKET_COUNT)
         {
@@ -637,6 +818,16 @@ uint32_t udp_input(const iot_interface_t  * p_interface,
             p_packet->p_payload  = p_packet->p_payload + UDP_HEADER_SIZE;
             p_packet->length    -= UDP_HEADER_SIZE;
 
+            err_code = NRF_SUCCESS;
+
+            m_socket[index].stats.rx_packets++;
+            m_socket[index].stats.rx_bytes += p_packet->length;
+
+            if (process_result != NRF_SUCCESS)
+            {
+                m_socket[index].stats.rx_errors++;
+            }
+
             //Found port for which data is intended.
             const  udp6_socket_t sock  = {index, m_socket[index].p_app_data};
 
@@ -655,6 +846,10 @@ uint32_t udp_input(const iot_interface_t  * p_interface,
 
                 UDP_MUTEX_LOCK();
             }
+            else
+            {
+                m_socket[index].stats.rx_dropped++;
+            }
         }
         else
         {
@@ -673,3 +868,20 @@ uint32_t udp_input(const iot_interface_t  * p_interface,
 
     return err_code;
 }
+
+
+uint32_t udp6_socket_stats_get(const udp6_socket_t * p_socket, udp6_socket_stats_t * p_stats)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    NULL_PARAM_CHECK(p_socket);
+    NULL_PARAM_CHECK(p_stats);
+    VERIFY_SOCKET_ID(p_socket->socket_id);
+
+    UDP_MUTEX_LOCK();
+
+    (*p_stats) = m_socket[p_socket->socket_id].stats;
+
+    UDP_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
@@ -12,55 +12,249 @@
  
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "nordic_common.h"
 #include "sdk_common.h"
 #include "sdk_config.h"
 #include "ipv6_utils.h"
 
-void ipv6_checksum_calculate(const uint8_t * p_data, uint16_t len, uint16_t * p_checksum, bool flip_flag)
+/**@brief Fold a 32-bit one's complement accumulator to 16 bits. */
+static uint16_t checksum_fold(uint32_t sum)
+{
+    sum = (sum & 0xFFFF) + (sum >> 16);
+    sum = (sum & 0xFFFF) + (sum >> 16);
+
+    return (uint16_t)sum;
+}
+
+/**@brief Swap the bytes of a 16-bit value. */
+static uint16_t checksum_swap(uint16_t value)
+{
+    return (uint16_t)((value << 8) | (value >> 8));
+}
+
+/**@brief Sum data as 16-bit words in native (little-endian) byte order.
+ *
+ * @details The one's complement sum does not depend on byte order, so summing words as they are
+ *          loaded and swapping the folded result gives the sum of the big-endian words. The data
+ *          is read 32 bits at a time, after a 16-bit head to reach word alignment. Each 32-bit
+ *          word adds at most 0x1FFFE, so the accumulator cannot overflow for 16-bit lengths.
+ *          If p_copy is not NULL the data is copied there while summing.
+ *
+ * @param[in]  p_data   Data to sum, aligned to 2 bytes.
+ * @param[out] p_copy   Destination of the copy, at the same alignment modulo 4 as p_data, or NULL.
+ * @param[in]  len      Length of the data.
+ *
+ * @retval Unfolded sum. A trailing odd byte is summed as the first byte of a word.
+ */
+static uint32_t checksum_native_sum(const uint8_t * p_data, uint8_t * p_copy, uint32_t len)
 {
-    uint16_t checksum_even = (((*p_checksum) & 0xFF00) >> 8);
-    uint16_t checksum_odd  = ((*p_checksum) & 0x00FF);
+    uint32_t sum = 0;
 
-    while (len)
+    if ((len >= 2) && (((uintptr_t)p_data & 0x02) != 0))
     {
-        if( len == 1 )
+        uint16_t half = *(const uint16_t *)p_data;
+
+        if (p_copy != NULL)
         {
-          checksum_even += (*p_data);
-          len           -= 1;
+            *(uint16_t *)p_copy = half;
+            p_copy += 2;
+        }
+
+        sum    += half;
+        p_data += 2;
+        len    -= 2;
+    }
+
+    const uint32_t * p_word = (const uint32_t *)p_data;
+
+    if (p_copy == NULL)
+    {
+        while (len >= 16)
+        {
+            uint32_t w0 = p_word[0];
+            uint32_t w1 = p_word[1];
+            uint32_t w2 = p_word[2];
+            uint32_t w3 = p_word[3];
+
+            sum += (w0 & 0xFFFF) + (w0 >> 16);
+            sum += (w1 & 0xFFFF) + (w1 >> 16);
+            sum += (w2 & 0xFFFF) + (w2 >> 16);
+            sum += (w3 & 0xFFFF) + (w3 >> 16);
+
+            p_word += 4;
+            len    -= 16;
         }
-        else
-        {        
-          checksum_even += *p_data++;
-          checksum_odd  += *p_data++;
-          len           -= 2;
+
+        while (len >= 4)
+        {
+            uint32_t w0 = *p_word++;
+
+            sum += (w0 & 0xFFFF) + (w0 >> 16);
+            len -= 4;
         }
-        
-        if (checksum_odd & 0xFF00)
+    }
+    else
+    {
+        uint32_t * p_copy_word = (uint32_t *)p_copy;
+
+        while (len >= 16)
         {
-            checksum_even += ((checksum_odd & 0xFF00) >> 8);
-            checksum_odd   = (checksum_odd & 0x00FF);
+            uint32_t w0 = p_word[0];
+            uint32_t w1 = p_word[1];
+            uint32_t w2 = p_word[2];
+            uint32_t w3 = p_word[3];
+
+            p_copy_word[0] = w0;
+            p_copy_word[1] = w1;
+            p_copy_word[2] = w2;
+            p_copy_word[3] = w3;
+
+            sum += (w0 & 0xFFFF) + (w0 >> 16);
+            sum += (w1 & 0xFFFF) + (w1 >> 16);
+            sum += (w2 & 0xFFFF) + (w2 >> 16);
+            sum += (w3 & 0xFFFF) + (w3 >> 16);
+
+            p_word      += 4;
+            p_copy_word += 4;
+            len         -= 16;
         }
 
-        if (checksum_even & 0xFF00)
+        while (len >= 4)
         {
-            checksum_odd += ((checksum_even & 0xFF00) >> 8);
-            checksum_even = (checksum_even & 0x00FF);
+            uint32_t w0 = *p_word++;
+
+            *p_copy_word++ = w0;
+
+            sum += (w0 & 0xFFFF) + (w0 >> 16);
+            len -= 4;
         }
+
+        p_copy = (uint8_t *)p_copy_word;
     }
 
-    checksum_even = (checksum_even << 8) + (checksum_odd & 0xFFFF);
+    p_data = (const uint8_t *)p_word;
 
-    if(flip_flag)
+    if (len >= 2)
+    {
+        uint16_t half = *(const uint16_t *)p_data;
+
+        if (p_copy != NULL)
+        {
+            *(uint16_t *)p_copy = half;
+            p_copy += 2;
+        }
+
+        sum    += half;
+        p_data += 2;
+        len    -= 2;
+    }
+
+    if (len != 0)
+    {
+        if (p_copy != NULL)
+        {
+            *p_copy = *p_data;
+        }
+
+        sum += *p_data;
+    }
+
+    return sum;
+}
+
+/**@brief Sum data as big-endian 16-bit words, starting at any address.
+ *
+ * @param[in]  p_data   Data to sum.
+ * @param[out] p_copy   Destination of the copy, at the same alignment modulo 4 as p_data, or NULL.
+ * @param[in]  len      Length of the data.
+ *
+ * @retval Folded sum in host byte order.
+ */
+static uint16_t checksum_sum(const uint8_t * p_data, uint8_t * p_copy, uint16_t len)
+{
+    uint32_t sum = 0;
+
+    if ((((uintptr_t)p_data & 0x01) != 0) && (len != 0))
+    {
+        // The first byte is the high byte of a word. The rest is summed shifted by one byte,
+        // which swaps the bytes of its sum.
+        if (p_copy != NULL)
+        {
+            *p_copy++ = *p_data;
+        }
+
+        sum = ((uint32_t)(*p_data) << 8) +
+              checksum_fold(checksum_native_sum(p_data + 1, p_copy, len - 1U));
+    }
+    else
+    {
+        sum = checksum_swap(checksum_fold(checksum_native_sum(p_data, p_copy, len)));
+    }
+
+    return checksum_fold(sum);
+}
+
+/**@brief Add the sum of data to a checksum and store the result. */
+static void checksum_add(uint16_t * p_checksum, uint16_t sum, bool flip_zero)
+{
+    uint16_t checksum = checksum_fold((uint32_t)(*p_checksum) + sum);
+
+    if (flip_zero)
     {
         // We use 0xFFFF instead of 0x0000 because of not operator.
-        if(checksum_even == 0xFFFF)
+        if (checksum == 0xFFFF)
         {
-            checksum_even = 0x0000;
+            checksum = 0x0000;
         }
     }
-    
-    (*p_checksum) = (uint16_t)(checksum_even);
+
+    (*p_checksum) = checksum;
+}
+
+void ipv6_checksum_calculate(const uint8_t * p_data, uint16_t len, uint16_t * p_checksum, bool flip_flag)
+{
+    checksum_add(p_checksum, checksum_sum(p_data, NULL, len), flip_flag);
+}
+
+void ipv6_checksum_copy_calculate(uint8_t       * p_dest,
+                                  const uint8_t * p_data,
+                                  uint16_t        len,
+                                  uint16_t      * p_checksum,
+                                  bool            flip_zero)
+{
+    if ((((uintptr_t)p_dest ^ (uintptr_t)p_data) & 0x03) == 0)
+    {
+        checksum_add(p_checksum, checksum_sum(p_data, p_dest, len), flip_zero);
+    }
+    else
+    {
+        // Word copies are not possible between buffers of different alignment.
+        memcpy(p_dest, p_data, len);
+        checksum_add(p_checksum, checksum_sum(p_dest, NULL, len), flip_zero);
+    }
+}
+
+void ipv6_checksum_update(uint16_t      * p_checksum,
+                          const uint8_t * p_old_data,
+                          const uint8_t * p_new_data,
+                          uint16_t        len,
+                          bool            flip_zero)
+{
+    // RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m').
+    uint32_t sum = (uint16_t)(~(*p_checksum));
+
+    sum += (uint16_t)(~checksum_sum(p_old_data, NULL, len));
+    sum += checksum_sum(p_new_data, NULL, len);
+
+    uint16_t checksum = (uint16_t)(~checksum_fold(sum));
+
+    if (flip_zero && (checksum == 0x0000))
+    {
+        checksum = 0xFFFF;
+    }
+
+    (*p_checksum) = checksum;
 }
 
 void ipv6_header_init(ipv6_header_t * p_ip_header)
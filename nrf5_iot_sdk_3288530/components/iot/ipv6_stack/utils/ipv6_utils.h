@@ -28,11 +28,17 @@
 #include "iot_defines.h"
 
 /**@brief Function for calculating checksum using IPv6 algorithm.
+ *
+ * @details The data is added to the checksum as big-endian 16-bit words, an odd trailing byte
+ *          being padded with zero. The data is summed a 32-bit word at a time regardless of
+ *          its alignment.
  *
  * @param[in]  p_data      Pointer to the data needs to be checksummed.
  * @param[in]  len         Length of the data.
  * @param[in]  p_checksum  Pointer to actual value of checksum.
  * @param[out] p_checksum  Value of calculated checksum.
+ * @param[in]  flip_zero   If true, a calculated value of 0xFFFF is replaced with 0x0000, so
+ *                         that its complement is not transmitted as 0.
  *
  * @retval None.
  */
@@ -42,6 +48,51 @@ void ipv6_checksum_calculate(const uint8_t * p_data,
                              bool            flip_zero);
 
 
+/**@brief Function for copying data and adding it to a checksum in the same pass.
+ *
+ * @details Equivalent to copying the data with memcpy and calling @ref ipv6_checksum_calculate on
+ *          it. The data is copied a word at a time when source and destination have the same
+ *          alignment.
+ *
+ * @param[out] p_dest      Pointer to the destination of the copy.
+ * @param[in]  p_data      Pointer to the data to be copied and checksummed.
+ * @param[in]  len         Length of the data.
+ * @param[in]  p_checksum  Pointer to actual value of checksum.
+ * @param[out] p_checksum  Value of calculated checksum.
+ * @param[in]  flip_zero   Same as for @ref ipv6_checksum_calculate.
+ *
+ * @retval None.
+ */
+void ipv6_checksum_copy_calculate(uint8_t       * p_dest,
+                                  const uint8_t * p_data,
+                                  uint16_t        len,
+                                  uint16_t      * p_checksum,
+                                  bool            flip_zero);
+
+
+/**@brief Function for updating a checksum after a part of the checksummed data has changed.
+ *
+ * @details Incremental update as given in RFC 1624, so a patched packet does not have to be
+ *          checksummed again. The changed data has to start at an even offset in the checksummed
+ *          data.
+ *
+ * @param[in]  p_checksum  Pointer to the checksum as sent in the header, in host byte order.
+ * @param[out] p_checksum  Updated checksum.
+ * @param[in]  p_old_data  Pointer to the data before the change.
+ * @param[in]  p_new_data  Pointer to the data after the change.
+ * @param[in]  len         Length of the changed data.
+ * @param[in]  flip_zero   If true, a resulting checksum of 0x0000 is replaced with 0xFFFF, as
+ *                         required for UDP.
+ *
+ * @retval None.
+ */
+void ipv6_checksum_update(uint16_t      * p_checksum,
+                          const uint8_t * p_old_data,
+                          const uint8_t * p_new_data,
+                          uint16_t        len,
+                          bool            flip_zero);
+
+
 /**@brief Function for initializing default values of IPv6 Header.
  *
  * @note  Function initializes Version, Traffic Class, Flow Label, Next Header, Hop Limit and 
@@ -18,9 +18,11 @@
 #include "lwm2m_api.h"
 #include "lwm2m_register.h"
 #include "lwm2m_bootstrap.h"
+#include "lwm2m_observe.h"
 #include "sdk_os.h"
 #include "lwm2m.h"
 #include "sdk_config.h"
+#include "nordic_common.h"
 
 #if (LWM2M_ENABLE_LOGS == 1) && (ENABLE_DEBUG_LOG_SUPPORT == 1)
 
@@ -55,16 +57,115 @@ static const char m_operation_desc[8][9] = {
 
 SDK_MUTEX_DEFINE(m_coap_mutex)                                                           /**< Mutex variable. Currently unused, this declaration does not occupy any space in RAM. */
 
-static lwm2m_object_prototype_t *   m_objects[LWM2M_COAP_HANDLER_MAX_OBJECTS];
-static lwm2m_instance_prototype_t * m_instances[LWM2M_COAP_HANDLER_MAX_INSTANCES];
+static lwm2m_object_prototype_t *   m_objects[LWM2M_COAP_HANDLER_MAX_OBJECTS];                  /**< Objects, sorted by object id. */
+static lwm2m_instance_prototype_t * m_instances[LWM2M_COAP_HANDLER_MAX_INSTANCES];              /**< Instances, sorted by object id and instance id. */
 static uint16_t m_num_objects;
 static uint16_t m_num_instances;
+static uint32_t m_registry_generation;                                                          /**< Incremented on each change of the objects and instances. */
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 0)
+static uint8_t  m_link_format[LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE];                     /**< Link format string of the registered objects and instances. */
+static uint16_t m_link_format_len;                                                              /**< Length of the cached link format string. */
+static bool     m_link_format_valid;                                                            /**< Indicates if the cached link format string is up to date. */
+#endif // LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
 
 static void coap_error_handler(uint32_t error_code, coap_message_t * p_message)
 {
     LWM2M_TRC("[LWM2M][CoAP      ]: ERROR: Unhandled coap message recieved. Error code: %lu\r\n", error_code);
 }
 
+/**@brief Parse a URI path segment of digits only, which is not NUL terminated. */
+static bool path_segment_parse(uint16_t * p_value, const uint8_t * p_str, uint16_t str_len)
+{
+    uint32_t value = 0;
+
+    if ((str_len == 0) || (str_len > 5))
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < str_len; i++)
+    {
+        value = (value * 10) + (p_str[i] - '0');
+    }
+
+    if (value > 0xFFFF)
+    {
+        return false;
+    }
+
+    *p_value = (uint16_t)value;
+
+    return true;
+}
+
+
+/**@brief Invalidate what is derived from the objects and instances after a change. */
+static void registry_changed(void)
+{
+    m_registry_generation++;
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 0)
+    m_link_format_valid = false;
+#endif
+}
+
+
+static uint32_t instance_key(uint16_t object_id, uint16_t instance_id)
+{
+    return (((uint32_t)object_id << 16) | instance_id);
+}
+
+
+/**@brief Find the index of the first instance not ordered before the given object and instance. */
+static uint16_t instance_lower_bound(uint16_t object_id, uint16_t instance_id)
+{
+    const uint32_t key  = instance_key(object_id, instance_id);
+    uint16_t       low  = 0;
+    uint16_t       high = m_num_instances;
+
+    while (low < high)
+    {
+        uint16_t mid = low + (high - low) / 2;
+
+        if (instance_key(m_instances[mid]->object_id, m_instances[mid]->instance_id) < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+
+/**@brief Find the index of the first object not ordered before the given object. */
+static uint16_t object_lower_bound(uint16_t object_id)
+{
+    uint16_t low  = 0;
+    uint16_t high = m_num_objects;
+
+    while (low < high)
+    {
+        uint16_t mid = low + (high - low) / 2;
+
+        if (m_objects[mid]->object_id < object_id)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+
 static void internal_coap_handler_init(void)
 {
     memset(m_objects, 0, sizeof(m_objects));
@@ -72,6 +173,8 @@ static void internal_coap_handler_init(void)
 
     m_num_objects   = 0;
     m_num_instances = 0;
+
+    registry_changed();
 }
 
 
@@ -92,20 +195,20 @@ static uint32_t instance_resolve(lwm2m_instance_prototype_t ** p_instance,
                                           uint16_t             object_id,
                                           uint16_t             instance_id)
 {
-    for (int i = 0; i < m_num_instances; ++i)
+    uint16_t index = instance_lower_bound(object_id, instance_id);
+
+    if ((index < m_num_instances)                       &&
+        (m_instances[index]->object_id == object_id)    &&
+        (m_instances[index]->instance_id == instance_id))
     {
-        if (m_instances[i]->object_id == object_id &&
-            m_instances[i]->instance_id == instance_id)
+        if (m_instances[index]->callback == NULL)
         {
-            if (m_instances[i]->callback == NULL)
-            {
-                return NRF_ERROR_NULL;
-            }
+            return NRF_ERROR_NULL;
+        }
 
-            *p_instance = m_instances[i];
+        *p_instance = m_instances[index];
 
-            return NRF_SUCCESS;
-        }
+        return NRF_SUCCESS;
     }
 
     return NRF_ERROR_NOT_FOUND;
@@ -115,19 +218,18 @@ static uint32_t instance_resolve(lwm2m_instance_prototype_t ** p_instance,
 static uint32_t object_resolve(lwm2m_object_prototype_t ** p_instance,
                                uint16_t                    object_id)
 {
-    for (int i = 0; i < m_num_objects; ++i)
+    uint16_t index = object_lower_bound(object_id);
+
+    if ((index < m_num_objects) && (m_objects[index]->object_id == object_id))
     {
-        if (m_objects[i]->object_id == object_id)
+        if (m_objects[index]->callback == NULL)
         {
-            if (m_objects[i]->callback == NULL)
-            {
-                return NRF_ERROR_NULL;
-            }
+            return NRF_ERROR_NULL;
+        }
 
-            *p_instance = m_objects[i];
+        *p_instance = m_objects[index];
 
-            return NRF_SUCCESS;
-        }
+        return NRF_SUCCESS;
     }
 
     return NRF_ERROR_NOT_FOUND;
@@ -153,6 +255,104 @@ static uint32_t op_code_resolve(lwm2m_instance_prototype_t * p_instance,
     return NRF_ERROR_NOT_FOUND;
 }
 
+#if (LWM2M_ENABLE_OBSERVE == 1)
+
+/**@brief Handle a Write-Attributes request on an existing object, instance or resource. */
+static uint32_t write_attributes_handle(coap_message_t * p_request,
+                                        uint16_t *       p_path,
+                                        uint8_t          path_len)
+{
+    lwm2m_object_prototype_t *   p_object;
+    lwm2m_instance_prototype_t * p_instance;
+    uint8_t                      resource_operation;
+    uint32_t                     err_code;
+
+    switch (path_len)
+    {
+        case 1:
+            err_code = object_resolve(&p_object, p_path[0]);
+            break;
+
+        case 2:
+            err_code = instance_resolve(&p_instance, p_path[0], p_path[1]);
+            break;
+
+        case 3:
+            err_code = instance_resolve(&p_instance, p_path[0], p_path[1]);
+            if (err_code == NRF_SUCCESS)
+            {
+                err_code = op_code_resolve(p_instance, p_path[2], &resource_operation);
+            }
+            break;
+
+        default:
+            err_code = NRF_ERROR_NOT_FOUND;
+            break;
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    LWM2M_TRC("[LWM2M][CoAP      ]:   >> WRITE ATTRIBUTES, path length %u\r\n", path_len);
+
+    err_code = internal_lwm2m_observe_attributes_write(p_request, p_path, path_len);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return lwm2m_respond_with_code(COAP_CODE_204_CHANGED, p_request);
+}
+
+
+uint32_t internal_lwm2m_observe_notify(coap_message_t * p_request,
+                                       const uint16_t * p_path,
+                                       uint8_t          path_len)
+{
+    uint32_t err_code;
+
+    LWM2M_MUTEX_LOCK();
+
+    if (path_len == 1)
+    {
+        lwm2m_object_prototype_t * p_object;
+
+        err_code = object_resolve(&p_object, p_path[0]);
+        if (err_code == NRF_SUCCESS)
+        {
+            LWM2M_MUTEX_UNLOCK();
+
+            return p_object->callback(p_object,
+                                      LWM2M_INVALID_INSTANCE,
+                                      LWM2M_OPERATION_CODE_OBSERVE,
+                                      p_request);
+        }
+    }
+    else
+    {
+        lwm2m_instance_prototype_t * p_instance;
+
+        err_code = instance_resolve(&p_instance, p_path[0], p_path[1]);
+        if (err_code == NRF_SUCCESS)
+        {
+            LWM2M_MUTEX_UNLOCK();
+
+            return p_instance->callback(p_instance,
+                                        (path_len == 3) ? p_path[2] : LWM2M_INVALID_RESOURCE,
+                                        LWM2M_OPERATION_CODE_OBSERVE,
+                                        p_request);
+        }
+    }
+
+    LWM2M_MUTEX_UNLOCK();
+
+    return err_code;
+}
+
+#endif // LWM2M_ENABLE_OBSERVE
+
 static uint32_t internal_request_handle(coap_message_t * p_request,
                                         uint16_t *       p_path,
                                         uint8_t          path_len)
@@ -183,7 +383,12 @@ static uint32_t internal_request_handle(coap_message_t * p_request,
             }
             else // Read
             {
+#if (LWM2M_ENABLE_OBSERVE == 1)
+                // Observe registration, or deregistration followed by a read.
+                operation = internal_lwm2m_observe_operation_get(p_request);
+#else
                 operation = LWM2M_OPERATION_CODE_READ;
+#endif
             }
             break;
         }
@@ -191,6 +396,12 @@ static uint32_t internal_request_handle(coap_message_t * p_request,
         case COAP_CODE_PUT:
         {
             operation = LWM2M_OPERATION_CODE_WRITE;
+#if (LWM2M_ENABLE_OBSERVE == 1)
+            if (internal_lwm2m_observe_is_write_attributes(p_request))
+            {
+                return write_attributes_handle(p_request, p_path, path_len);
+            }
+#endif
             break;
         }
 
@@ -210,6 +421,15 @@ static uint32_t internal_request_handle(coap_message_t * p_request,
             break; // Maybe send response with unsupported method not allowed?
     }
 
+#if (LWM2M_ENABLE_OBSERVE == 1)
+    if ((operation == LWM2M_OPERATION_CODE_OBSERVE) &&
+        (internal_lwm2m_observe_register(p_request, p_path, path_len) != NRF_SUCCESS))
+    {
+        // The path cannot be observed, serve the request as a read.
+        operation = LWM2M_OPERATION_CODE_READ;
+    }
+#endif
+
     err_code = NRF_ERROR_NOT_FOUND;
 
     switch (path_len)
@@ -363,59 +583,52 @@ static uint32_t internal_request_handle(coap_message_t * p_request,
 
             if (p_request->header.code == COAP_CODE_POST)
             {
-                for (int i = 0; i < m_num_instances; ++i)
-                {
-                    if ((m_instances[i]->object_id == p_path[0]) &&
-                        (m_instances[i]->instance_id == p_path[1]))
-                    {
-                        if (m_instances[i]->callback == NULL)
-                        {
-                            err_code = NRF_ERROR_NULL;
-                            break;
-                        }
+                lwm2m_instance_prototype_t * p_instance;
 
-                        uint8_t resource_operation = 0;
-                        err_code = op_code_resolve(m_instances[i], p_path[2], &resource_operation);
+                err_code = instance_resolve(&p_instance, p_path[0], p_path[1]);
+                if (err_code != NRF_SUCCESS)
+                {
+                    break;
+                }
 
-                        if (err_code != NRF_SUCCESS)
-                            break;
+                uint8_t resource_operation = 0;
+                err_code = op_code_resolve(p_instance, p_path[2], &resource_operation);
 
-                        if ((resource_operation & LWM2M_OPERATION_CODE_EXECUTE) > 0)
-                        {
-                            operation = LWM2M_OPERATION_CODE_EXECUTE;
-                        }
+                if (err_code != NRF_SUCCESS)
+                    break;
 
-                        if ((resource_operation & LWM2M_OPERATION_CODE_WRITE) > 0)
-                        {
-                            operation = LWM2M_OPERATION_CODE_WRITE;
-                        }
+                if ((resource_operation & LWM2M_OPERATION_CODE_EXECUTE) > 0)
+                {
+                    operation = LWM2M_OPERATION_CODE_EXECUTE;
+                }
 
-                        LWM2M_TRC("[LWM2M][CoAP      ]:   >> %s instance /%u/%u/%u/\r\n",
-                                  m_operation_desc[op_desc_idx_lookup(operation)],
-                                  m_instances[i]->object_id, 
-                                  m_instances[i]->instance_id, 
-                                  p_path[2]);
+                if ((resource_operation & LWM2M_OPERATION_CODE_WRITE) > 0)
+                {
+                    operation = LWM2M_OPERATION_CODE_WRITE;
+                }
 
-                        LWM2M_MUTEX_UNLOCK();
-                        
-                        (void)m_instances[i]->callback(m_instances[i], 
-                                                       p_path[2],
-                                                       operation,
-                                                       p_request);
-                        
-                        LWM2M_MUTEX_LOCK();
-                        
-                        err_code = NRF_SUCCESS;
+                LWM2M_TRC("[LWM2M][CoAP      ]:   >> %s instance /%u/%u/%u/\r\n",
+                          m_operation_desc[op_desc_idx_lookup(operation)],
+                          p_instance->object_id, 
+                          p_instance->instance_id, 
+                          p_path[2]);
 
-                        LWM2M_TRC("[LWM2M][CoAP      ]:   << %s instance /%u/%u/%u/\r\n",
-                                  m_operation_desc[op_desc_idx_lookup(operation)],
-                                  m_instances[i]->object_id, 
-                                  m_instances[i]->instance_id, 
-                                  p_path[2]);
+                LWM2M_MUTEX_UNLOCK();
+                
+                (void)p_instance->callback(p_instance, 
+                                           p_path[2],
+                                           operation,
+                                           p_request);
+                
+                LWM2M_MUTEX_LOCK();
+                
+                err_code = NRF_SUCCESS;
 
-                        break;
-                    }
-                }
+                LWM2M_TRC("[LWM2M][CoAP      ]:   << %s instance /%u/%u/%u/\r\n",
+                          m_operation_desc[op_desc_idx_lookup(operation)],
+                          p_instance->object_id, 
+                          p_instance->instance_id, 
+                          p_path[2]);
             }
             else
             {
@@ -453,6 +666,13 @@ static uint32_t internal_request_handle(coap_message_t * p_request,
             break;
     }
 
+#if (LWM2M_ENABLE_OBSERVE == 1)
+    if ((operation == LWM2M_OPERATION_CODE_OBSERVE) && (err_code != NRF_SUCCESS))
+    {
+        internal_lwm2m_observe_cancel(p_request);
+    }
+#endif
+
     return err_code;
 }
 
@@ -463,7 +683,6 @@ static uint32_t lwm2m_coap_handler_handle_request(coap_message_t * p_request)
     
     uint16_t index;
     uint16_t path[3];
-    char *   endptr;
     
     bool     is_numbers_only = true;
     uint16_t path_index      = 0;
@@ -478,21 +697,16 @@ static uint32_t lwm2m_coap_handler_handle_request(coap_message_t * p_request)
             bool numbers = numbers_only((char *)p_request->options[index].p_data, p_request->options[index].length);
             if (numbers)
             {
-                path[path_index] = strtol((char *)p_request->options[index].p_data, &endptr, 10);
-                ++path_index;
-
-                if (endptr == ((char *)p_request->options[index].p_data))
-                {                    
+                if ((path_index == (sizeof(path) / sizeof(path[0]))) ||
+                    !path_segment_parse(&path[path_index],
+                                        p_request->options[index].p_data,
+                                        p_request->options[index].length))
+                {
                     err_code = NRF_ERROR_NOT_FOUND;
                     break;
                 }
 
-                if (endptr != ((char *)p_request->options[index].p_data +
-                               p_request->options[index].length))
-                {   
-                    err_code = NRF_ERROR_NOT_FOUND;
-                    break;
-                }
+                ++path_index;
             }
             else
             {
@@ -529,36 +743,32 @@ static uint32_t lwm2m_coap_handler_handle_request(coap_message_t * p_request)
             }
             else
             {
-                // Try to look up if there is a match with object with an alias name.
-                for (int i = 0; i < m_num_objects; ++i)
+                // Try to look up if there is a match with object with an alias name. Named
+                // objects are sorted last.
+                uint16_t first_named = object_lower_bound(LWM2M_NAMED_OBJECT);
+
+                err_code = NRF_ERROR_NOT_FOUND;
+
+                for (int i = first_named; i < m_num_objects; ++i)
                 {
-                    if (m_objects[i]->object_id == LWM2M_NAMED_OBJECT)
+                    size_t size = strlen(m_objects[i]->p_alias_name);
+                    if ((strncmp(m_objects[i]->p_alias_name, requested_uri, size) == 0))
                     {
-                        size_t size = strlen(m_objects[i]->p_alias_name);
-                        if ((strncmp(m_objects[i]->p_alias_name, requested_uri, size) == 0))
+                        if (m_objects[i]->callback == NULL)
                         {
-                            if (m_objects[i]->callback == NULL)
-                            {
-                                err_code = NRF_ERROR_NULL;
-                                break;
-                            }
-                            
-                            LWM2M_MUTEX_UNLOCK();
-
-                            err_code = m_objects[i]->callback(m_objects[i],
-                                                              LWM2M_INVALID_INSTANCE,
-                                                              LWM2M_OPERATION_CODE_NONE,
-                                                              p_request);
-                            
-                            LWM2M_MUTEX_LOCK();
-
+                            err_code = NRF_ERROR_NULL;
                             break;
                         }
-                    }
-                    else 
-                    {
-                        // This is not a name object, return error code.
-                        err_code = NRF_ERROR_NOT_FOUND;
+                        
+                        LWM2M_MUTEX_UNLOCK();
+
+                        err_code = m_objects[i]->callback(m_objects[i],
+                                                          LWM2M_INVALID_INSTANCE,
+                                                          LWM2M_OPERATION_CODE_NONE,
+                                                          p_request);
+                        
+                        LWM2M_MUTEX_LOCK();
+
                         break;
                     }
                 }
@@ -589,8 +799,24 @@ uint32_t lwm2m_coap_handler_instance_add(lwm2m_instance_prototype_t * p_instance
         return NRF_ERROR_NO_MEM;
     }
     
-    m_instances[m_num_instances] = p_instance;
+    // Insert after instances with the same ids, if any, so that the first one added is resolved.
+    uint16_t index = instance_lower_bound(p_instance->object_id, p_instance->instance_id);
+
+    while ((index < m_num_instances)                                 &&
+           (m_instances[index]->object_id == p_instance->object_id)  &&
+           (m_instances[index]->instance_id == p_instance->instance_id))
+    {
+        ++index;
+    }
+
+    memmove(&m_instances[index + 1],
+            &m_instances[index],
+            (m_num_instances - index) * sizeof(m_instances[0]));
+
+    m_instances[index] = p_instance;
     ++m_num_instances;
+
+    registry_changed();
     
     LWM2M_MUTEX_UNLOCK();
     
@@ -606,21 +832,23 @@ uint32_t lwm2m_coap_handler_instance_delete(lwm2m_instance_prototype_t * p_insta
     
     LWM2M_MUTEX_LOCK();
     
-    for (int i = 0; i < m_num_instances; ++i)
+    uint16_t index = instance_lower_bound(p_instance->object_id, p_instance->instance_id);
+
+    if ((index < m_num_instances)                                 &&
+        (m_instances[index]->object_id == p_instance->object_id)  &&
+        (m_instances[index]->instance_id == p_instance->instance_id))
     {
-        if ((m_instances[i]->object_id == p_instance->object_id) && 
-            (m_instances[i]->instance_id == p_instance->instance_id))
-        {
-            // Move current last entry into this index position, and trim down the length.
-            // If this is the last element, it cannot be accessed because the m_num_instances
-            // count is 0.
-            m_instances[i] = m_instances[m_num_instances - 1];
-            --m_num_instances;
-            
-            LWM2M_MUTEX_UNLOCK();
-            
-            return NRF_SUCCESS;
-        }
+        // Close the gap to keep the instances sorted.
+        memmove(&m_instances[index],
+                &m_instances[index + 1],
+                (m_num_instances - index - 1) * sizeof(m_instances[0]));
+        --m_num_instances;
+
+        registry_changed();
+        
+        LWM2M_MUTEX_UNLOCK();
+        
+        return NRF_SUCCESS;
     }
     
     LWM2M_MUTEX_UNLOCK();
@@ -637,15 +865,29 @@ uint32_t lwm2m_coap_handler_object_add(lwm2m_object_prototype_t * p_object)
     
     LWM2M_MUTEX_LOCK();
     
-    if (m_num_objects == LWM2M_COAP_HANDLER_MAX_INSTANCES)
+    if (m_num_objects == LWM2M_COAP_HANDLER_MAX_OBJECTS)
     {
         LWM2M_MUTEX_UNLOCK();
         
         return NRF_ERROR_NO_MEM;
     }
 
-    m_objects[m_num_objects] = p_object;
+    // Insert after objects with the same id, named objects in particular.
+    uint16_t index = object_lower_bound(p_object->object_id);
+
+    while ((index < m_num_objects) && (m_objects[index]->object_id == p_object->object_id))
+    {
+        ++index;
+    }
+
+    memmove(&m_objects[index + 1],
+            &m_objects[index],
+            (m_num_objects - index) * sizeof(m_objects[0]));
+
+    m_objects[index] = p_object;
     ++m_num_objects;
+
+    registry_changed();
     
     LWM2M_MUTEX_UNLOCK();
     
@@ -661,15 +903,20 @@ uint32_t lwm2m_coap_handler_object_delete(lwm2m_object_prototype_t * p_object)
     
     LWM2M_MUTEX_LOCK();
     
-    for (int i = 0; i < m_num_objects; ++i)
+    // Objects sharing an id are named objects, told apart by their address.
+    for (uint16_t index = object_lower_bound(p_object->object_id);
+         (index < m_num_objects) && (m_objects[index]->object_id == p_object->object_id);
+         ++index)
     {
-        if ( m_objects[i]->object_id == p_object->object_id)
+        if ((p_object->object_id != LWM2M_NAMED_OBJECT) || (m_objects[index] == p_object))
         {
-            // Move current last entry into this index position, and trim down the length.
-            // If this is the last element, it cannot be accessed because the m_num_objects
-            // count is 0.
-            m_objects[i] = m_objects[m_num_objects - 1];
+            // Close the gap to keep the objects sorted.
+            memmove(&m_objects[index],
+                    &m_objects[index + 1],
+                    (m_num_objects - index - 1) * sizeof(m_objects[0]));
             --m_num_objects;
+
+            registry_changed();
             
             LWM2M_MUTEX_UNLOCK();
             
@@ -683,100 +930,199 @@ uint32_t lwm2m_coap_handler_object_delete(lwm2m_object_prototype_t * p_object)
 }
 
 
-uint32_t lwm2m_coap_handler_gen_link_format(uint8_t * p_buffer, uint16_t * p_buffer_len)
+/**@brief Append a link to a link format string, or only count its length if p_buffer is NULL.
+ *
+ * @details Links are separated by commas, so that the string has no trailing comma and fits in a
+ *          buffer of the length calculated without one.
+ */
+static uint32_t link_append(uint8_t  * p_buffer,
+                            uint16_t   buffer_max_size,
+                            uint16_t * p_index,
+                            uint16_t   object_id,
+                            uint16_t   instance_id)
 {
+    char         link[16];
+    int          len;
+    const char * p_separator = (*p_index > 0) ? "," : "";
 
-    LWM2M_TRC("[LWM2M][CoAP      ]: lwm2m_coap_handler_gen_link_format\r\n");
-
-    NULL_PARAM_CHECK(p_buffer_len);
-    
-    LWM2M_MUTEX_LOCK();
-    
-    uint16_t  buffer_index = 0;
-    uint8_t * p_string_buffer;
-    uint16_t  buffer_max_size;
-    
-    uint8_t   dry_run_buffer[16];
-    bool      dry_run      = false;
-    uint16_t  dry_run_size = 0;
-    
-    if (p_buffer == NULL)
-    {    
-        // Dry-run only, in order to calculate the size of the needed buffer.
-        dry_run = true;
-        p_string_buffer = dry_run_buffer;
-        buffer_max_size = sizeof(dry_run_buffer);
+    if (instance_id == LWM2M_INVALID_INSTANCE)
+    {
+        len = snprintf(link, sizeof(link), "%s</%u>", p_separator, object_id);
     }
-    else 
+    else
     {
-        p_string_buffer = p_buffer;
-        buffer_max_size = *p_buffer_len;
+        len = snprintf(link, sizeof(link), "%s</%u/%u>", p_separator, object_id, instance_id);
     }
-    
-    for (int i = 0; i < m_num_objects; ++i)
+
+    if (p_buffer != NULL)
     {
-        // We need more than 3 chars to write a new link
-        if (buffer_max_size - buffer_index <= 3) 
+        if ((uint32_t)(*p_index + len) > buffer_max_size)
         {
-            LWM2M_MUTEX_UNLOCK();
-            
             return NRF_ERROR_NO_MEM;
         }
 
+        memcpy(&p_buffer[*p_index], link, len);
+    }
+
+    *p_index += len;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Render the link format string of the registered objects and instances.
+ *
+ * @details Objects and instances are both sorted by object id, so that they are merged in a
+ *          single pass. Instances are listed as /object/instance, objects without instances as
+ *          /object. Named objects are not listed.
+ */
+static uint32_t link_format_render(uint8_t * p_buffer, uint16_t * p_buffer_len)
+{
+    uint32_t err_code     = NRF_SUCCESS;
+    uint16_t buffer_index = 0;
+    uint16_t j            = 0;
+
+    for (uint16_t i = 0; (i < m_num_objects) && (err_code == NRF_SUCCESS); ++i)
+    {
         uint16_t curr_object = m_objects[i]->object_id;
 
-        if (curr_object == LWM2M_NAMED_OBJECT)
+        if ((curr_object == LWM2M_NAMED_OBJECT) ||
+            ((i > 0) && (m_objects[i - 1]->object_id == curr_object)))
         {
-            // Skip this object as it is a named object.
+            // Skip named objects, and objects already listed.
             continue;
         }
 
+        // Skip instances of objects that are not registered.
+        while ((j < m_num_instances) && (m_instances[j]->object_id < curr_object))
+        {
+            ++j;
+        }
+
         bool instance_present = false;
-        for (int j = 0; j < m_num_instances; ++j)
+
+        while ((j < m_num_instances)                      &&
+               (m_instances[j]->object_id == curr_object) &&
+               (err_code == NRF_SUCCESS))
         {
-            if (m_instances[j]->object_id == curr_object)
-            {
-                instance_present = true;
-                
-                buffer_index += snprintf((char *)&p_string_buffer[buffer_index], 
-                                         buffer_max_size - buffer_index, 
-                                         "</%u/%u>,", 
-                                         m_instances[j]->object_id, 
-                                         m_instances[j]->instance_id);
-                if (dry_run == true)
-                {
-                    dry_run_size += buffer_index;
-                    buffer_index = 0;
-                }
-            }
+            instance_present = true;
+
+            err_code = link_append(p_buffer, *p_buffer_len, &buffer_index,
+                                   curr_object, m_instances[j]->instance_id);
+            ++j;
         }
 
-        if (!instance_present)
+        if ((!instance_present) && (err_code == NRF_SUCCESS))
         {
-            buffer_index += snprintf((char *)&p_string_buffer[buffer_index], 
-                                     buffer_max_size - buffer_index, 
-                                     "</%u>,", 
-                                     curr_object);
-            if (dry_run == true)
-            {
-                dry_run_size += buffer_index;
-                buffer_index = 0;
-            }
+            err_code = link_append(p_buffer, *p_buffer_len, &buffer_index,
+                                   curr_object, LWM2M_INVALID_INSTANCE);
         }
     }
-    
-    if (dry_run == true)
+
+    if (err_code != NRF_SUCCESS)
     {
-        *p_buffer_len = dry_run_size - 1;
+        return err_code;
     }
-    else
+
+    *p_buffer_len = buffer_index;
+
+    return NRF_SUCCESS;
+}
+
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 0)
+
+/**@brief Render the cached link format string again if the objects or instances changed. */
+static uint32_t link_format_cache_update(void)
+{
+    if (m_link_format_valid)
     {
-        *p_buffer_len = buffer_index - 1; // Remove the last comma
+        return NRF_SUCCESS;
     }
 
+    m_link_format_len = sizeof(m_link_format);
+
+    uint32_t err_code = link_format_render(m_link_format, &m_link_format_len);
+    if (err_code == NRF_SUCCESS)
+    {
+        m_link_format_valid = true;
+    }
+
+    return err_code;
+}
+
+#endif // LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
+
+
+uint32_t internal_lwm2m_link_format_get(uint8_t ** pp_link_format,
+                                        uint16_t * p_len,
+                                        uint32_t * p_generation)
+{
+    *p_generation = m_registry_generation;
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 0)
+    uint32_t err_code = link_format_cache_update();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    *pp_link_format = m_link_format;
+    *p_len          = m_link_format_len;
+
+    return NRF_SUCCESS;
+#else
+    UNUSED_PARAMETER(pp_link_format);
+    UNUSED_PARAMETER(p_len);
+
+    return NRF_ERROR_NOT_SUPPORTED;
+#endif // LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
+}
+
+
+uint32_t lwm2m_coap_handler_gen_link_format(uint8_t * p_buffer, uint16_t * p_buffer_len)
+{
+
+    LWM2M_TRC("[LWM2M][CoAP      ]: lwm2m_coap_handler_gen_link_format\r\n");
+
+    NULL_PARAM_CHECK(p_buffer_len);
+    
+    LWM2M_MUTEX_LOCK();
+
+    uint32_t err_code;
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 0)
+    err_code = link_format_cache_update();
+    if (err_code == NRF_SUCCESS)
+    {
+        if ((p_buffer != NULL) && (*p_buffer_len < m_link_format_len))
+        {
+            err_code = NRF_ERROR_NO_MEM;
+        }
+        else
+        {
+            if (p_buffer != NULL)
+            {
+                memcpy(p_buffer, m_link_format, m_link_format_len);
+            }
+
+            *p_buffer_len = m_link_format_len;
+        }
+
+        LWM2M_MUTEX_UNLOCK();
+
+        return err_code;
+    }
+
+    // The cache is too small, render into the buffer of the application.
+#endif // LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
+
+    // Without a buffer, only the length of the string is calculated.
+    err_code = link_format_render(p_buffer, p_buffer_len);
+
     LWM2M_MUTEX_UNLOCK();
     
-    return NRF_SUCCESS;
+    return err_code;
 }
 
 
@@ -810,6 +1156,9 @@ uint32_t lwm2m_init(void)
     }
     
     internal_coap_handler_init();
+
+    // Compiled away if LWM2M_ENABLE_OBSERVE is not set to 1.
+    internal_lwm2m_observe_init();
     
     err_code = coap_request_handler_register(lwm2m_coap_handler_handle_request);
     
@@ -86,11 +86,57 @@
 
 #endif // LWM2M_DISABLE_API_PARAM_CHECK
 
+#ifndef LWM2M_ENABLE_OBSERVE
+#define LWM2M_ENABLE_OBSERVE                0                                                      /**< Disable LWM2M Observe and Write-Attributes by default. */
+#endif // LWM2M_ENABLE_OBSERVE
+
+#ifndef LWM2M_OBSERVE_MAX_OBSERVATIONS
+#define LWM2M_OBSERVE_MAX_OBSERVATIONS      4                                                      /**< Maximum number of paths with an observation or notification attributes. */
+#endif // LWM2M_OBSERVE_MAX_OBSERVATIONS
+
+#if (LWM2M_ENABLE_OBSERVE == 1) && (LWM2M_OBSERVE_MAX_OBSERVATIONS == 0)
+#error "LWM2M_OBSERVE_MAX_OBSERVATIONS must be at least 1 when LWM2M_ENABLE_OBSERVE is set."
+#endif
+
+#ifndef LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
+#define LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE 0                                                /**< Size of the cached link format string of the objects and instances, 0 to disable the cache. */
+#endif // LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE
+
+#if (LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE > 65535)
+#error "LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE must fit a CoAP payload length."
+#endif
+
+#ifndef LWM2M_ENABLE_SENML_JSON
+#define LWM2M_ENABLE_SENML_JSON             0                                                      /**< Disable the SenML-JSON content format by default. */
+#endif // LWM2M_ENABLE_SENML_JSON
+
+#ifndef LWM2M_ENABLE_SENML_CBOR
+#define LWM2M_ENABLE_SENML_CBOR             0                                                      /**< Disable the SenML-CBOR content format by default. */
+#endif // LWM2M_ENABLE_SENML_CBOR
+
 #define LWM2M_REQUEST_TYPE_BOOTSTRAP        1
 #define LWM2M_REQUEST_TYPE_REGISTER         2
 #define LWM2M_REQUEST_TYPE_UPDATE           3
 #define LWM2M_REQUEST_TYPE_DEREGISTER       4
 
+/**@brief Get the link format string of the registered objects and instances.
+ *
+ * @details The string is kept in a cache of LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE bytes,
+ *          rendered again only after objects or instances are added or deleted.
+ *
+ * @param[out] pp_link_format Cached link format string. Not NUL terminated.
+ * @param[out] p_len          Length of the string.
+ * @param[out] p_generation   Generation of the objects and instances the string describes.
+ *                            Returned even if the string is not.
+ *
+ * @retval NRF_SUCCESS             If the string was returned.
+ * @retval NRF_ERROR_NO_MEM        If the string does not fit the cache.
+ * @retval NRF_ERROR_NOT_SUPPORTED If the cache is disabled.
+ */
+uint32_t internal_lwm2m_link_format_get(uint8_t ** pp_link_format,
+                                        uint16_t * p_len,
+                                        uint32_t * p_generation);
+
 #endif // LWM2M_H__
 
 /** @} */
@@ -276,13 +276,19 @@ uint32_t lwm2m_register(lwm2m_remote_t *          p_remote,
                         uint16_t                  link_format_len);
 
 /**@brief Update a registration with a remote server.
+ *
+ * @details If LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE is set, the link format string of the
+ *          objects and instances is sent along when they changed since the server last accepted
+ *          a registration or an update. Otherwise only the registration parameters are sent.
  *
  * @param[in] p_remote Pointer to the structure holding connection information of the remote 
  *                     LWM2M server.
  * @param[in] p_config Registration parameters.
  * @param[in] local_port Port number of the local port to be used to send the update request.
  *
- * @retval NRF_SUCCESS If update request to the LWM2M server was sent out successfully.
+ * @retval NRF_SUCCESS      If update request to the LWM2M server was sent out successfully.
+ * @retval NRF_ERROR_NO_MEM If the objects and instances changed and their link format string
+ *                          does not fit LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE.
  */
 uint32_t lwm2m_update(lwm2m_remote_t *        p_remote,
                       lwm2m_server_config_t * p_config,
@@ -303,6 +309,9 @@ uint32_t lwm2m_deregister(lwm2m_remote_t * p_remote, uint16_t local_port);
  * @details Add a new LWM2M instance to the coap_handler. The application MUST initialize
  *          and allocate the additional data in the struct.
  *
+ * @note Instances are indexed by object id and instance id, which must not change until the
+ *       instance is deleted.
+ *
  * @param[in]  p_instance  Pointer to the instance to add.
  *
  * @retval     NRF_SUCCESS      If registration was successfull.
@@ -348,8 +357,9 @@ uint32_t lwm2m_coap_handler_object_delete(lwm2m_object_prototype_t * p_object);
 
 /**@brief Generate link format string based on registered objects and instances.
  *
- * @note For generation of links to work properly it is required that objects is added
- *       before instances.
+ * @details Links are listed by object id. Instances of objects that are not added are not
+ *          listed. If LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE is set, the string is copied
+ *          from a cache, rendered again only after objects or instances are added or deleted.
  *
  * @param[inout] p_buffer     Pointer to a buffer to fill with link format encoded string. If
  *                            a NULL pointer is provided the function will dry-run the function
@@ -386,6 +396,105 @@ uint32_t lwm2m_respond_with_payload(uint8_t *        p_payload,
  */
 uint32_t lwm2m_respond_with_code(coap_msg_code_t code, coap_message_t * p_request);
 
+/**@brief Select the content format of a response from the Accept option of the request.
+ *
+ * @details The content format is matched with @ref coap_message_ct_match_select, which prefers
+ *          the lowest content format number, for example SenML-JSON over LWM2M TLV.
+ *
+ * @param[out] p_ct            Selected content format.
+ * @param[in]  p_request       Original CoAP request. Must not be NULL.
+ * @param[in]  ct_support_mask Content formats the response can be encoded in, see
+ *                             @ref COAP_CONTENT_TYPE_MASK.
+ * @param[in]  default_ct      Content format to use if the request has no Accept option.
+ *
+ * @retval NRF_SUCCESS         If a content format was selected.
+ * @retval NRF_ERROR_NOT_FOUND If none of the accepted content formats is supported. The request is
+ *                             then to be answered with COAP_CODE_406_NOT_ACCEPTABLE.
+ */
+uint32_t lwm2m_content_type_select(coap_content_type_t * p_ct,
+                                   coap_message_t *      p_request,
+                                   uint32_t              ct_support_mask,
+                                   coap_content_type_t   default_ct);
+
+/**@brief Create a CoAP 2.05 Content response with a Content-Format option.
+ *
+ * @details The payload is meant to be encoded in place, into the buffer given by
+ *          @ref coap_message_payload_buffer_get, and set with @ref coap_message_payload_set before
+ *          the response is sent with @ref lwm2m_respond_with_content_send.
+ *
+ * @param[out] pp_response Created response.
+ * @param[in]  ct          Content format of the payload.
+ * @param[in]  p_request   Original CoAP request. Must not be NULL.
+ *
+ * @retval NRF_SUCCESS If the response was created.
+ */
+uint32_t lwm2m_respond_with_content_new(coap_message_t **   pp_response,
+                                        coap_content_type_t ct,
+                                        coap_message_t *    p_request);
+
+/**@brief Send a response created with @ref lwm2m_respond_with_content_new.
+ *
+ * @details The response is deleted, even if it could not be sent.
+ *
+ * @param[in] p_response Response to send. Must not be NULL.
+ * @param[in] p_request  Original CoAP request. Must not be NULL.
+ *
+ * @retval NRF_SUCCESS If the response was sent out successfully.
+ */
+uint32_t lwm2m_respond_with_content_send(coap_message_t * p_response, coap_message_t * p_request);
+
+#if (LWM2M_ENABLE_OBSERVE == 1)
+
+/**@brief Report a new value of an observed numeric resource.
+ *
+ * @details Observations of the resource are notified once the value crosses the gt or lt
+ *          attribute, or moves at least st away from the last notified value. Without any of
+ *          these attributes, every change is notified. Observations of the parent instance and
+ *          object are notified as for @ref lwm2m_observe_resource_changed.
+ *
+ *          Notifications are sent by @ref lwm2m_observe_tick, no sooner than pmin seconds after
+ *          the previous one. The callback of the instance, or of the object, is called with
+ *          @ref LWM2M_OPERATION_CODE_OBSERVE to respond with the current content, as for a read.
+ *
+ * @param[in] object_id   Object identifier of the resource.
+ * @param[in] instance_id Instance identifier of the resource.
+ * @param[in] resource_id Resource identifier.
+ * @param[in] value       Current value of the resource.
+ *
+ * @retval NRF_SUCCESS If the value was recorded.
+ */
+uint32_t lwm2m_observe_resource_update(uint16_t object_id,
+                                       uint16_t instance_id,
+                                       uint16_t resource_id,
+                                       float    value);
+
+/**@brief Report a change of a resource, or of a whole instance, that has no numeric value.
+ *
+ * @details Observations of the resource and of its parent instance and object, or of the
+ *          instance and all its resources if resource_id is LWM2M_INVALID_RESOURCE, are
+ *          notified by @ref lwm2m_observe_tick once pmin has expired.
+ *
+ * @param[in] object_id   Object identifier of the resource.
+ * @param[in] instance_id Instance identifier of the resource.
+ * @param[in] resource_id Resource identifier, or LWM2M_INVALID_RESOURCE.
+ *
+ * @retval NRF_SUCCESS If the change was recorded.
+ */
+uint32_t lwm2m_observe_resource_changed(uint16_t object_id,
+                                        uint16_t instance_id,
+                                        uint16_t resource_id);
+
+/**@brief Send the notifications that are due.
+ *
+ * @details Must be called every second. A notification is due once pmin has expired since the
+ *          previous one and a change was reported, or once pmax has expired.
+ *
+ * @retval NRF_SUCCESS If all due notifications were handed to the callbacks.
+ */
+uint32_t lwm2m_observe_tick(void);
+
+#endif // LWM2M_ENABLE_OBSERVE
+
 #endif // LWM2M_API_H__
 
 /** @} */
@@ -15,13 +15,14 @@
 #include "coap_message.h"
 #include "coap_codes.h"
 #include "lwm2m.h"
+#include "lwm2m_observe.h"
 
 
-uint32_t lwm2m_respond_with_code(coap_msg_code_t code, coap_message_t * p_request)
+/**@brief Create a piggybacked response to a request. */
+static uint32_t response_create(coap_message_t ** pp_response,
+                                coap_msg_code_t   code,
+                                coap_message_t *  p_request)
 {
-    NULL_PARAM_CHECK(p_request);
-    
-    // Application helper function, no need for mutex.
     coap_message_conf_t response_config;
     memset (&response_config, 0, sizeof(coap_message_conf_t));
 
@@ -44,14 +45,23 @@ uint32_t lwm2m_respond_with_code(coap_msg_code_t code, coap_message_t * p_reques
     // Copy token length.
     response_config.token_len = p_request->header.token_len;
 
-    coap_message_t * p_response;
-    uint32_t err_code = coap_message_new(&p_response, &response_config);
+    uint32_t err_code = coap_message_new(pp_response, &response_config);
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
     }
 
-    err_code = coap_message_remote_addr_set(p_response, &p_request->remote);
+    // Observe option of notifications. Compiled away if LWM2M_ENABLE_OBSERVE is not set to 1.
+    internal_lwm2m_observe_response_handle(*pp_response, p_request);
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Send a response to the remote of a request, and delete it. */
+static uint32_t response_send(coap_message_t * p_response, coap_message_t * p_request)
+{
+    uint32_t err_code = coap_message_remote_addr_set(p_response, &p_request->remote);
     if (err_code != NRF_SUCCESS)
     {
         (void)coap_message_delete(p_response);
@@ -74,36 +84,30 @@ uint32_t lwm2m_respond_with_code(coap_msg_code_t code, coap_message_t * p_reques
 }
 
 
-uint32_t lwm2m_respond_with_payload(uint8_t * p_payload, uint16_t payload_len, coap_message_t * p_request)
+uint32_t lwm2m_respond_with_code(coap_msg_code_t code, coap_message_t * p_request)
 {
     NULL_PARAM_CHECK(p_request);
-    NULL_PARAM_CHECK(p_payload);
     
     // Application helper function, no need for mutex.
-    coap_message_conf_t response_config;
-    memset (&response_config, 0, sizeof(coap_message_conf_t));
-
-    if (p_request->header.type == COAP_TYPE_NON)
-    {
-        response_config.type = COAP_TYPE_NON;
-    }
-    else if (p_request->header.type == COAP_TYPE_CON)
+    coap_message_t * p_response;
+    uint32_t err_code = response_create(&p_response, code, p_request);
+    if (err_code != NRF_SUCCESS)
     {
-        response_config.type = COAP_TYPE_ACK;
+        return err_code;
     }
 
-    // PIGGY BACKED RESPONSE
-    response_config.code              = COAP_CODE_205_CONTENT;
-    response_config.id                = p_request->header.id;
-    response_config.port.port_number  = p_request->port.port_number;
-    
-    // Copy token.
-    memcpy(&response_config.token[0], &p_request->token[0], p_request->header.token_len);
-    // Copy token length.
-    response_config.token_len = p_request->header.token_len;
+    return response_send(p_response, p_request);
+}
 
+
+uint32_t lwm2m_respond_with_payload(uint8_t * p_payload, uint16_t payload_len, coap_message_t * p_request)
+{
+    NULL_PARAM_CHECK(p_request);
+    NULL_PARAM_CHECK(p_payload);
+    
+    // Application helper function, no need for mutex.
     coap_message_t * p_response;
-    uint32_t err_code = coap_message_new(&p_response, &response_config);
+    uint32_t err_code = response_create(&p_response, COAP_CODE_205_CONTENT, p_request);
     if (err_code != NRF_SUCCESS)
     {
         return err_code;
@@ -116,24 +120,63 @@ uint32_t lwm2m_respond_with_payload(uint8_t * p_payload, uint16_t payload_len, c
         return err_code;
     }
 
-    err_code = coap_message_remote_addr_set(p_response, &p_request->remote);
+    return response_send(p_response, p_request);
+}
+
+
+uint32_t lwm2m_content_type_select(coap_content_type_t * p_ct,
+                                   coap_message_t *      p_request,
+                                   uint32_t              ct_support_mask,
+                                   coap_content_type_t   default_ct)
+{
+    NULL_PARAM_CHECK(p_ct);
+    NULL_PARAM_CHECK(p_request);
+
+    // Without an Accept option the content format is up to the server.
+    if (coap_message_opt_present(p_request, COAP_OPT_ACCEPT) != NRF_SUCCESS)
+    {
+        *p_ct = default_ct;
+        return NRF_SUCCESS;
+    }
+
+    // LWM2M paths are not CoAP resources, only the content formats of one are needed to match.
+    coap_resource_t resource;
+    memset(&resource, 0, sizeof(coap_resource_t));
+    resource.ct_support_mask = ct_support_mask;
+
+    return coap_message_ct_match_select(p_ct, p_request, &resource);
+}
+
+
+uint32_t lwm2m_respond_with_content_new(coap_message_t **   pp_response,
+                                        coap_content_type_t ct,
+                                        coap_message_t *    p_request)
+{
+    NULL_PARAM_CHECK(pp_response);
+    NULL_PARAM_CHECK(p_request);
+
+    // Application helper function, no need for mutex.
+    uint32_t err_code = response_create(pp_response, COAP_CODE_205_CONTENT, p_request);
     if (err_code != NRF_SUCCESS)
     {
-        (void)coap_message_delete(p_response);
         return err_code;
     }
 
-    memcpy(&p_response->remote, &p_request->remote, sizeof(coap_remote_t));
-
-    uint32_t msg_handle;
-    err_code = coap_message_send(&msg_handle, p_response);
+    err_code = coap_message_opt_uint_add(*pp_response, COAP_OPT_CONTENT_FORMAT, ct);
     if (err_code != NRF_SUCCESS)
     {
-        (void)coap_message_delete(p_response);
+        (void)coap_message_delete(*pp_response);
         return err_code;
     }
 
-    err_code = coap_message_delete(p_response);
+    return NRF_SUCCESS;
+}
 
-    return err_code;
+
+uint32_t lwm2m_respond_with_content_send(coap_message_t * p_response, coap_message_t * p_request)
+{
+    NULL_PARAM_CHECK(p_response);
+    NULL_PARAM_CHECK(p_request);
+
+    return response_send(p_response, p_request);
 }
@@ -0,0 +1,722 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "lwm2m_api.h"
+#include "lwm2m_observe.h"
+#include "lwm2m.h"
+#include "coap_observe_api.h"
+#include "coap_option.h"
+#include "nordic_common.h"
+#include "sdk_config.h"
+
+#if (LWM2M_ENABLE_OBSERVE == 1)
+
+#define ATTR_PMIN                 0x01                                                              /**< Bit mask for the pmin attribute. */
+#define ATTR_PMAX                 0x02                                                              /**< Bit mask for the pmax attribute. */
+#define ATTR_GT                   0x04                                                              /**< Bit mask for the gt attribute. */
+#define ATTR_LT                   0x08                                                              /**< Bit mask for the lt attribute. */
+#define ATTR_ST                   0x10                                                              /**< Bit mask for the st attribute. */
+#define ATTR_THRESHOLDS           (ATTR_GT | ATTR_LT | ATTR_ST)                                     /**< Attributes only valid on resources. */
+
+#define ATTR_QUERY_MAX_LEN        24                                                                /**< Maximum length of a query option of a Write-Attributes request. */
+#define OBSERVE_SEQ_MASK          0x00FFFFFF                                                        /**< Observe option values are 24 bits long. */
+
+#define OBSERVE_REGISTER          0                                                                 /**< Observe option value requesting an observation. */
+#define OBSERVE_DEREGISTER        1                                                                 /**< Observe option value cancelling an observation. */
+
+/**@brief Notification attributes of a path. */
+typedef struct
+{
+    uint8_t  mask;                                                                                  /**< Attributes set, as ATTR_ bit masks. */
+    uint32_t pmin;                                                                                  /**< Minimum period between notifications, in seconds. */
+    uint32_t pmax;                                                                                  /**< Maximum period between notifications, in seconds. */
+    float    gt;                                                                                    /**< Notify when the value crosses above or below this threshold. */
+    float    lt;                                                                                    /**< Notify when the value crosses below or above this threshold. */
+    float    st;                                                                                    /**< Notify when the value moves at least this much. */
+} observe_attr_t;
+
+/**@brief Observation of a path, or notification attributes of a path not observed yet. */
+typedef struct
+{
+    bool            in_use;                                                                         /**< Indicates if the entry is allocated. */
+    bool            active;                                                                         /**< Indicates if the path is observed. */
+    bool            pending;                                                                        /**< Indicates if a change is to be notified. */
+    bool            has_value;                                                                      /**< Indicates if a value was reported for the resource. */
+    uint16_t        path[3];                                                                        /**< Observed path. */
+    uint8_t         path_len;                                                                       /**< Number of elements in the path. */
+    coap_observer_t observer;                                                                       /**< Remote and token of the observation. */
+    coap_port_t     port;                                                                           /**< Local port the observation was registered on. */
+    uint32_t        seq;                                                                            /**< Observe sequence number of the next notification. */
+    uint32_t        last_notify;                                                                    /**< Time of the registration or of the last notification. */
+    float           reported_value;                                                                 /**< Value of the resource at the last notification. */
+    float           current_value;                                                                  /**< Latest value of the resource. */
+    observe_attr_t  attr;                                                                           /**< Notification attributes of the path. */
+} observation_t;
+
+static observation_t m_observations[LWM2M_OBSERVE_MAX_OBSERVATIONS];                                /**< Table of observations. */
+static uint32_t      m_time;                                                                        /**< Seconds elapsed, advanced by lwm2m_observe_tick. */
+
+
+static bool remote_equal(const coap_remote_t * p_remote1, const coap_remote_t * p_remote2)
+{
+    return ((p_remote1->port_number == p_remote2->port_number) &&
+            (memcmp(p_remote1->addr, p_remote2->addr, sizeof(p_remote1->addr)) == 0));
+}
+
+
+static bool path_equal(const observation_t * p_entry, const uint16_t * p_path, uint8_t path_len)
+{
+    return ((p_entry->path_len == path_len) &&
+            (memcmp(p_entry->path, p_path, path_len * sizeof(uint16_t)) == 0));
+}
+
+
+/**@brief Check if one of two paths contains the other. */
+static bool path_related(const observation_t * p_entry, const uint16_t * p_path, uint8_t path_len)
+{
+    uint8_t len = MIN(p_entry->path_len, path_len);
+
+    return (memcmp(p_entry->path, p_path, len * sizeof(uint16_t)) == 0);
+}
+
+
+static observation_t * entry_find(const coap_remote_t * p_remote,
+                                  const uint16_t      * p_path,
+                                  uint8_t               path_len)
+{
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        observation_t * p_entry = &m_observations[index];
+
+        if (p_entry->in_use                                   &&
+            remote_equal(&p_entry->observer.remote, p_remote) &&
+            path_equal(p_entry, p_path, path_len))
+        {
+            return p_entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+static observation_t * entry_find_by_token(coap_message_t * p_message)
+{
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        observation_t * p_entry = &m_observations[index];
+
+        if (p_entry->active                                                &&
+            (p_entry->observer.token_len == p_message->header.token_len)   &&
+            (memcmp(p_entry->observer.token,
+                    p_message->token,
+                    p_message->header.token_len) == 0)                     &&
+            remote_equal(&p_entry->observer.remote, &p_message->remote))
+        {
+            return p_entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+static observation_t * entry_get(const coap_remote_t * p_remote,
+                                 const uint16_t      * p_path,
+                                 uint8_t               path_len)
+{
+    observation_t * p_entry = entry_find(p_remote, p_path, path_len);
+
+    if (p_entry != NULL)
+    {
+        return p_entry;
+    }
+
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        p_entry = &m_observations[index];
+
+        if (!p_entry->in_use)
+        {
+            memset(p_entry, 0, sizeof(observation_t));
+
+            p_entry->in_use          = true;
+            p_entry->path_len        = path_len;
+            p_entry->observer.remote = *p_remote;
+            memcpy(p_entry->path, p_path, path_len * sizeof(uint16_t));
+
+            return p_entry;
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Stop observing a path. Its attributes are kept for a later observation. */
+static void entry_deactivate(observation_t * p_entry)
+{
+    LWM2M_TRC("[LWM2M][Observe   ]: Observation of /%u/%u/%u/ (len %u) cancelled\r\n",
+              p_entry->path[0], p_entry->path[1], p_entry->path[2], p_entry->path_len);
+
+    p_entry->active  = false;
+    p_entry->pending = false;
+
+    if (p_entry->attr.mask == 0)
+    {
+        p_entry->in_use = false;
+    }
+}
+
+
+/**@brief Get the value of the Observe option of a message.
+ *
+ * @retval NRF_SUCCESS         If the option was found and decoded.
+ * @retval NRF_ERROR_NOT_FOUND If the message has no valid Observe option.
+ */
+static uint32_t observe_value_get(uint32_t * p_value, coap_message_t * p_message)
+{
+    for (uint32_t index = 0; index < p_message->options_count; index++)
+    {
+        coap_option_t * p_option = &p_message->options[index];
+
+        if (p_option->number == COAP_OPT_OBSERVE)
+        {
+            *p_value = 0;
+
+            if (p_option->length == 0)
+            {
+                return NRF_SUCCESS;
+            }
+
+            if (coap_opt_uint_decode(p_value, p_option->length, p_option->p_data) == NRF_SUCCESS)
+            {
+                return NRF_SUCCESS;
+            }
+
+            break;
+        }
+    }
+
+    return NRF_ERROR_NOT_FOUND;
+}
+
+
+/**@brief Parse an unsigned decimal attribute value. */
+static bool uint_parse(uint32_t * p_value, const char * p_str)
+{
+    char * p_end;
+    long   value = strtol(p_str, &p_end, 10);
+
+    if ((p_end == p_str) || (*p_end != '\0') || (value < 0))
+    {
+        return false;
+    }
+
+    *p_value = (uint32_t)value;
+
+    return true;
+}
+
+
+/**@brief Parse a decimal number attribute value. */
+static bool float_parse(float * p_value, const char * p_str)
+{
+    char * p_end;
+    float  value = strtof(p_str, &p_end);
+
+    if ((p_end == p_str) || (*p_end != '\0'))
+    {
+        return false;
+    }
+
+    *p_value = value;
+
+    return true;
+}
+
+
+/**@brief Check if a value is on a different side of a threshold than the reported value. */
+static bool threshold_crossed(float reported, float value, float threshold)
+{
+    return ((reported > threshold) != (value > threshold)) ||
+           ((reported < threshold) != (value < threshold));
+}
+
+
+/**@brief Check if a new value of an observed resource is to be notified. */
+static bool value_notifiable(const observation_t * p_entry, float value)
+{
+    const observe_attr_t * p_attr = &p_entry->attr;
+
+    if ((p_attr->mask & ATTR_THRESHOLDS) == 0)
+    {
+        return (value != p_entry->reported_value);
+    }
+
+    if (((p_attr->mask & ATTR_GT) != 0) &&
+        threshold_crossed(p_entry->reported_value, value, p_attr->gt))
+    {
+        return true;
+    }
+
+    if (((p_attr->mask & ATTR_LT) != 0) &&
+        threshold_crossed(p_entry->reported_value, value, p_attr->lt))
+    {
+        return true;
+    }
+
+    if ((p_attr->mask & ATTR_ST) != 0)
+    {
+        float step = value - p_entry->reported_value;
+
+        if (step < 0)
+        {
+            step = -step;
+        }
+
+        if (step >= p_attr->st)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static bool notification_due(const observation_t * p_entry)
+{
+    const uint32_t elapsed = m_time - p_entry->last_notify;
+    const uint32_t pmin    = ((p_entry->attr.mask & ATTR_PMIN) != 0) ? p_entry->attr.pmin : 0;
+
+    if (elapsed < pmin)
+    {
+        return false;
+    }
+
+    if (p_entry->pending)
+    {
+        return true;
+    }
+
+    // pmax is ignored unless greater than pmin.
+    return (((p_entry->attr.mask & ATTR_PMAX) != 0) &&
+            (p_entry->attr.pmax > pmin)             &&
+            (elapsed >= p_entry->attr.pmax));
+}
+
+
+static void notification_send(observation_t * p_entry)
+{
+    coap_message_t request;
+    uint8_t        observe_value = 0;
+
+    // Request a read of the path on behalf of the observer, the response being the notification.
+    memset(&request, 0, sizeof(coap_message_t));
+
+    request.header.version   = 1;
+    request.header.type      = COAP_TYPE_NON;
+    request.header.code      = COAP_CODE_GET;
+    request.header.token_len = p_entry->observer.token_len;
+    request.remote           = p_entry->observer.remote;
+    request.port             = p_entry->port;
+    request.options_count    = 1;
+
+    request.options[0].number = COAP_OPT_OBSERVE;
+    request.options[0].length = 0;
+    request.options[0].p_data = &observe_value;
+
+    memcpy(request.token, p_entry->observer.token, p_entry->observer.token_len);
+
+    p_entry->pending        = false;
+    p_entry->last_notify    = m_time;
+    p_entry->reported_value = p_entry->current_value;
+
+    LWM2M_TRC("[LWM2M][Observe   ]: >> Notify /%u/%u/%u/ (len %u), seq %lu\r\n",
+              p_entry->path[0], p_entry->path[1], p_entry->path[2], p_entry->path_len,
+              p_entry->seq);
+
+    uint32_t err_code = internal_lwm2m_observe_notify(&request, p_entry->path, p_entry->path_len);
+
+    if ((err_code == NRF_ERROR_NOT_FOUND) || (err_code == NRF_ERROR_NULL))
+    {
+        // The path no longer exists.
+        entry_deactivate(p_entry);
+    }
+}
+
+
+void internal_lwm2m_observe_init(void)
+{
+    memset(m_observations, 0, sizeof(m_observations));
+    m_time = 0;
+}
+
+
+uint8_t internal_lwm2m_observe_operation_get(coap_message_t * p_request)
+{
+    uint32_t observe;
+
+    if (observe_value_get(&observe, p_request) != NRF_SUCCESS)
+    {
+        return LWM2M_OPERATION_CODE_READ;
+    }
+
+    if (observe == OBSERVE_REGISTER)
+    {
+        return LWM2M_OPERATION_CODE_OBSERVE;
+    }
+
+    if (observe == OBSERVE_DEREGISTER)
+    {
+        internal_lwm2m_observe_cancel(p_request);
+    }
+
+    return LWM2M_OPERATION_CODE_READ;
+}
+
+
+bool internal_lwm2m_observe_is_write_attributes(coap_message_t * p_request)
+{
+    return ((p_request->header.code == COAP_CODE_PUT) &&
+            (p_request->payload_len == 0)             &&
+            (coap_message_opt_present(p_request, COAP_OPT_URI_QUERY) == NRF_SUCCESS));
+}
+
+
+uint32_t internal_lwm2m_observe_attributes_write(coap_message_t * p_request,
+                                                 const uint16_t * p_path,
+                                                 uint8_t          path_len)
+{
+    observation_t * p_entry = entry_find(&p_request->remote, p_path, path_len);
+    observe_attr_t  attr;
+    bool            cancel = false;
+
+    if (p_entry != NULL)
+    {
+        attr = p_entry->attr;
+    }
+    else
+    {
+        memset(&attr, 0, sizeof(observe_attr_t));
+    }
+
+    for (uint32_t index = 0; index < p_request->options_count; index++)
+    {
+        coap_option_t * p_option = &p_request->options[index];
+        char            query[ATTR_QUERY_MAX_LEN + 1];
+
+        if (p_option->number != COAP_OPT_URI_QUERY)
+        {
+            continue;
+        }
+
+        if (p_option->length > ATTR_QUERY_MAX_LEN)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+
+        memcpy(query, p_option->p_data, p_option->length);
+        query[p_option->length] = '\0';
+
+        // Split the query in name and value. An attribute without a value is removed.
+        char * p_value = strchr(query, '=');
+
+        if (p_value != NULL)
+        {
+            *p_value++ = '\0';
+        }
+
+        uint8_t attr_bit;
+        bool    valid = true;
+
+        if (strcmp(query, "pmin") == 0)
+        {
+            attr_bit = ATTR_PMIN;
+            valid    = (p_value == NULL) || uint_parse(&attr.pmin, p_value);
+        }
+        else if (strcmp(query, "pmax") == 0)
+        {
+            attr_bit = ATTR_PMAX;
+            valid    = (p_value == NULL) || uint_parse(&attr.pmax, p_value);
+        }
+        else if (strcmp(query, "gt") == 0)
+        {
+            attr_bit = ATTR_GT;
+            valid    = (p_value == NULL) || float_parse(&attr.gt, p_value);
+        }
+        else if (strcmp(query, "lt") == 0)
+        {
+            attr_bit = ATTR_LT;
+            valid    = (p_value == NULL) || float_parse(&attr.lt, p_value);
+        }
+        else if (strcmp(query, "st") == 0)
+        {
+            attr_bit = ATTR_ST;
+            valid    = (p_value == NULL) || (float_parse(&attr.st, p_value) && (attr.st >= 0));
+        }
+        else if ((strcmp(query, "cancel") == 0) && (p_value == NULL))
+        {
+            cancel = true;
+            continue;
+        }
+        else
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+
+        if (!valid)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+
+        if (p_value != NULL)
+        {
+            attr.mask |= attr_bit;
+        }
+        else
+        {
+            attr.mask &= ~attr_bit;
+        }
+    }
+
+    // Thresholds only apply to numeric resources.
+    if (((attr.mask & ATTR_THRESHOLDS) != 0) && (path_len != 3))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    if ((attr.mask & (ATTR_GT | ATTR_LT)) == (ATTR_GT | ATTR_LT))
+    {
+        if (attr.lt >= attr.gt)
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+
+        if (((attr.mask & ATTR_ST) != 0) && ((attr.lt + 2 * attr.st) >= attr.gt))
+        {
+            return NRF_ERROR_INVALID_PARAM;
+        }
+    }
+
+    if (p_entry == NULL)
+    {
+        if (attr.mask == 0)
+        {
+            // Nothing to keep for the path.
+            return NRF_SUCCESS;
+        }
+
+        p_entry = entry_get(&p_request->remote, p_path, path_len);
+        if (p_entry == NULL)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+    }
+
+    p_entry->attr = attr;
+
+    if (cancel && p_entry->active)
+    {
+        entry_deactivate(p_entry);
+    }
+    else if ((!p_entry->active) && (attr.mask == 0))
+    {
+        p_entry->in_use = false;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t internal_lwm2m_observe_register(coap_message_t * p_request,
+                                         const uint16_t * p_path,
+                                         uint8_t          path_len)
+{
+    if ((path_len == 0) || (path_len > 3))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    observation_t * p_entry = entry_get(&p_request->remote, p_path, path_len);
+    if (p_entry == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    // The sequence number carries on from a previous observation, for the remote to keep the
+    // notifications in order.
+    p_entry->active             = true;
+    p_entry->pending            = false;
+    p_entry->has_value          = false;
+    p_entry->last_notify        = m_time;
+    p_entry->port               = p_request->port;
+    p_entry->observer.token_len = p_request->header.token_len;
+
+    memcpy(p_entry->observer.token, p_request->token, p_request->header.token_len);
+
+    LWM2M_TRC("[LWM2M][Observe   ]: Observation of /%u/%u/%u/ (len %u) registered\r\n",
+              p_path[0],
+              (path_len > 1) ? p_path[1] : 0,
+              (path_len > 2) ? p_path[2] : 0,
+              path_len);
+
+    return NRF_SUCCESS;
+}
+
+
+void internal_lwm2m_observe_cancel(coap_message_t * p_request)
+{
+    observation_t * p_entry = entry_find_by_token(p_request);
+
+    if (p_entry != NULL)
+    {
+        entry_deactivate(p_entry);
+    }
+}
+
+
+void internal_lwm2m_observe_response_handle(coap_message_t * p_response,
+                                            coap_message_t * p_request)
+{
+    uint32_t observe;
+
+    if ((observe_value_get(&observe, p_request) != NRF_SUCCESS) ||
+        (observe != OBSERVE_REGISTER))
+    {
+        return;
+    }
+
+    observation_t * p_entry = entry_find_by_token(p_request);
+
+    if (p_entry == NULL)
+    {
+        return;
+    }
+
+    if ((p_response->header.code & 0xE0) != (COAP_CODE_205_CONTENT & 0xE0))
+    {
+        // Error responses end the observation.
+        entry_deactivate(p_entry);
+        return;
+    }
+
+    if (coap_message_opt_uint_add(p_response, COAP_OPT_OBSERVE, p_entry->seq) == NRF_SUCCESS)
+    {
+        p_entry->seq = (p_entry->seq + 1) & OBSERVE_SEQ_MASK;
+    }
+}
+
+
+uint32_t lwm2m_observe_resource_update(uint16_t object_id,
+                                       uint16_t instance_id,
+                                       uint16_t resource_id,
+                                       float    value)
+{
+    const uint16_t path[3] = {object_id, instance_id, resource_id};
+
+    LWM2M_MUTEX_LOCK();
+
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        observation_t * p_entry = &m_observations[index];
+
+        if ((!p_entry->active) || (!path_related(p_entry, path, 3)))
+        {
+            continue;
+        }
+
+        if (p_entry->path_len < 3)
+        {
+            // Object and instance observations report every change of their resources.
+            p_entry->pending = true;
+        }
+        else if (!p_entry->has_value)
+        {
+            // First value since the registration, taken as the value that was read.
+            p_entry->has_value      = true;
+            p_entry->reported_value = value;
+            p_entry->current_value  = value;
+        }
+        else
+        {
+            p_entry->current_value = value;
+
+            if (value_notifiable(p_entry, value))
+            {
+                p_entry->pending = true;
+            }
+        }
+    }
+
+    LWM2M_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_observe_resource_changed(uint16_t object_id,
+                                        uint16_t instance_id,
+                                        uint16_t resource_id)
+{
+    const uint16_t path[3]  = {object_id, instance_id, resource_id};
+    const uint8_t  path_len = (resource_id == LWM2M_INVALID_RESOURCE) ? 2 : 3;
+
+    LWM2M_MUTEX_LOCK();
+
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        observation_t * p_entry = &m_observations[index];
+
+        if (p_entry->active && path_related(p_entry, path, path_len))
+        {
+            p_entry->pending = true;
+        }
+    }
+
+    LWM2M_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_observe_tick(void)
+{
+    LWM2M_MUTEX_LOCK();
+
+    m_time++;
+
+    for (uint32_t index = 0; index < LWM2M_OBSERVE_MAX_OBSERVATIONS; index++)
+    {
+        observation_t * p_entry = &m_observations[index];
+
+        if (p_entry->active && notification_due(p_entry))
+        {
+            // Callbacks are called with the module unlocked, as for requests.
+            LWM2M_MUTEX_UNLOCK();
+
+            notification_send(p_entry);
+
+            LWM2M_MUTEX_LOCK();
+        }
+    }
+
+    LWM2M_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+#endif // LWM2M_ENABLE_OBSERVE
@@ -0,0 +1,134 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file lwm2m_observe.h
+ *
+ * @defgroup iot_sdk_lwm2m_observe_api LWM2M observe internal interface
+ * @ingroup iot_sdk_lwm2m
+ * @{
+ * @brief Observe and Write-Attributes handling for the LWM2M protocol.
+ *
+ * @details Observations are kept per remote and path, on objects, instances and resources, with
+ *          the notification attributes of the path. The CoAP observe server is not used as it
+ *          tracks observers of CoAP resources, which LWM2M paths are not.
+ */
+
+#ifndef LWM2M_OBSERVE_H__
+#define LWM2M_OBSERVE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "coap_api.h"
+#include "lwm2m.h"
+
+#if (LWM2M_ENABLE_OBSERVE == 1)
+
+/**@brief Initialize the LWM2M observe module.
+ *
+ * @details Calling this function will set the module in default state.
+ */
+void internal_lwm2m_observe_init(void);
+
+/**@brief Get the operation requested by a GET that is not a discover.
+ *
+ * @details An Observe option of 0 requests an observation. An Observe option of 1 cancels the
+ *          observation with the token of the request, which is then served as a read.
+ *
+ * @param[in] p_request Request to inspect.
+ *
+ * @return LWM2M_OPERATION_CODE_OBSERVE or LWM2M_OPERATION_CODE_READ.
+ */
+uint8_t internal_lwm2m_observe_operation_get(coap_message_t * p_request);
+
+/**@brief Check if a PUT request is a Write-Attributes, that is has a query and no payload.
+ *
+ * @param[in] p_request Request to inspect.
+ *
+ * @return true if the request writes notification attributes.
+ */
+bool internal_lwm2m_observe_is_write_attributes(coap_message_t * p_request);
+
+/**@brief Apply the notification attributes of a Write-Attributes request.
+ *
+ * @details The attributes are applied only if all of them are valid. An attribute given without
+ *          a value is removed, and "cancel" cancels the observation of the path.
+ *
+ * @param[in] p_request Write-Attributes request.
+ * @param[in] p_path    Path of an existing object, instance or resource.
+ * @param[in] path_len  Number of elements in the path, 1 to 3.
+ *
+ * @retval NRF_SUCCESS             If the attributes were applied.
+ * @retval NRF_ERROR_INVALID_PARAM If an attribute is unknown, malformed or inconsistent.
+ * @retval NRF_ERROR_NO_MEM        If no entry was available for the path.
+ */
+uint32_t internal_lwm2m_observe_attributes_write(coap_message_t * p_request,
+                                                 const uint16_t * p_path,
+                                                 uint8_t          path_len);
+
+/**@brief Register the observation of a path by the remote and token of a request.
+ *
+ * @details A previous observation of the path by the same remote is replaced.
+ *
+ * @param[in] p_request Request with an Observe option of 0.
+ * @param[in] p_path    Path to observe.
+ * @param[in] path_len  Number of elements in the path, 1 to 3.
+ *
+ * @retval NRF_SUCCESS             If the observation was registered.
+ * @retval NRF_ERROR_INVALID_PARAM If the path cannot be observed.
+ * @retval NRF_ERROR_NO_MEM        If no entry was available for the path.
+ */
+uint32_t internal_lwm2m_observe_register(coap_message_t * p_request,
+                                         const uint16_t * p_path,
+                                         uint8_t          path_len);
+
+/**@brief Cancel the observation with the remote and token of a request, if any.
+ *
+ * @param[in] p_request Request, or notification request, of the observation.
+ */
+void internal_lwm2m_observe_cancel(coap_message_t * p_request);
+
+/**@brief Complete a response to a request that registers an observation, or to a notification.
+ *
+ * @details A successful response gets an Observe option with the next sequence number. An error
+ *          response cancels the observation. Responses to other requests are left as is.
+ *
+ * @param[in] p_response Response to send, before its payload is set.
+ * @param[in] p_request  Request the response is for.
+ */
+void internal_lwm2m_observe_response_handle(coap_message_t * p_response,
+                                            coap_message_t * p_request);
+
+/**@brief Call the instance or object callback of an observed path to send a notification.
+ *
+ * @details Implemented by the LWM2M coap handler, which owns the objects and instances.
+ *
+ * @param[in] p_request Notification request, carrying the token and remote of the observation.
+ * @param[in] p_path    Observed path.
+ * @param[in] path_len  Number of elements in the path, 1 to 3.
+ *
+ * @retval NRF_SUCCESS         If the callback handled the notification.
+ * @retval NRF_ERROR_NOT_FOUND If the path no longer exists.
+ */
+uint32_t internal_lwm2m_observe_notify(coap_message_t * p_request,
+                                       const uint16_t * p_path,
+                                       uint8_t          path_len);
+
+#else // LWM2M_ENABLE_OBSERVE
+
+#define internal_lwm2m_observe_init(...)
+#define internal_lwm2m_observe_response_handle(...)
+
+#endif // LWM2M_ENABLE_OBSERVE
+
+#endif // LWM2M_OBSERVE_H__
+
+/**@} */
@@ -31,6 +31,7 @@ typedef struct
     lwm2m_remote_t      remote;
     char                location[LWM2M_REGISTER_MAX_LOCATION_LEN];
     uint16_t            location_len;
+    uint32_t            generation;     /**< Generation of the objects and instances known to the server. */
 } internal_lwm2m_remote_location_t;
 
 
@@ -63,6 +64,38 @@ static uint32_t internal_message_new(coap_message_t **        pp_msg,
 }
 
 
+static internal_lwm2m_remote_location_t * internal_remote_entry_find(lwm2m_remote_t * p_remote)
+{
+    for (uint16_t i = 0; i < num_servers; ++i)
+    {
+        if (memcmp(&m_remote_to_location[i].remote, p_remote, sizeof(lwm2m_remote_t)) == 0)
+        {
+            return &m_remote_to_location[i];
+        }
+    }
+
+    return NULL;
+}
+
+
+/**@brief Record the generation of the objects and instances sent to a server it accepted. */
+static void internal_remote_generation_save(uint32_t status, void * p_arg, coap_message_t * p_message)
+{
+    if ((status != NRF_SUCCESS) || (p_message == NULL) ||
+        ((p_message->header.code & 0xE0) != (COAP_CODE_201_CREATED & 0xE0)))
+    {
+        return;
+    }
+
+    internal_lwm2m_remote_location_t * p_entry = internal_remote_entry_find(&p_message->remote);
+
+    if (p_entry != NULL)
+    {
+        p_entry->generation = (uint32_t)(uintptr_t)p_arg;
+    }
+}
+
+
 static uint32_t internal_location_find(lwm2m_string_t * p_location, lwm2m_remote_t * p_remote)
 {
     for (uint16_t i = 0; i < num_servers; ++i)
@@ -223,6 +256,8 @@ static void lwm2m_register_cb(uint32_t status, void * p_arg, coap_message_t * p_
             (void)internal_remote_location_save(&location, &p_message->remote);
         }
     }
+
+    internal_remote_generation_save(status, p_arg, p_message);
     
     LWM2M_MUTEX_UNLOCK();
     
@@ -308,6 +343,18 @@ uint32_t lwm2m_register(lwm2m_remote_t *          p_remote,
     {
         err_code = coap_message_payload_set(p_msg, p_link_format_string, link_format_len);
     }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        // The link format string is expected to describe the current objects and instances.
+        uint8_t * p_link_format;
+        uint16_t  len;
+        uint32_t  generation;
+
+        (void)internal_lwm2m_link_format_get(&p_link_format, &len, &generation);
+
+        p_msg->p_arg = (void *)(uintptr_t)generation;
+    }
     
     if (err_code == NRF_SUCCESS)
     {
@@ -338,6 +385,12 @@ void lwm2m_update_cb(uint32_t status, void * p_arg, coap_message_t * p_message)
     LWM2M_TRC("[LWM2M][Update    ]: lwm2m_update_cb, status: %ul, coap code: %u\r\n",
           status, 
           p_message->header.code);
+
+    LWM2M_MUTEX_LOCK();
+
+    internal_remote_generation_save(status, p_arg, p_message);
+
+    LWM2M_MUTEX_UNLOCK();
     
     (void)lwm2m_notification(LWM2M_NOTIFCATION_TYPE_UPDATE, 
                              &p_message->remote, 
@@ -356,6 +409,37 @@ uint32_t lwm2m_update(lwm2m_remote_t * p_remote, lwm2m_server_config_t * p_confi
     
     uint32_t         err_code;
     coap_message_t * p_msg;
+    uint8_t *        p_link_format   = NULL;
+    uint16_t         link_format_len = 0;
+    uint32_t         generation      = 0;
+
+    internal_lwm2m_remote_location_t * p_entry = internal_remote_entry_find(p_remote);
+
+    if (p_entry != NULL)
+    {
+        generation = p_entry->generation;
+
+        uint32_t current_generation;
+
+        err_code = internal_lwm2m_link_format_get(&p_link_format,
+                                                  &link_format_len,
+                                                  &current_generation);
+
+        if ((err_code == NRF_SUCCESS) && (current_generation != generation))
+        {
+            // Objects or instances changed since the server last heard of them.
+            generation = current_generation;
+        }
+        else if ((err_code == NRF_ERROR_NO_MEM) && (current_generation != generation))
+        {
+            LWM2M_MUTEX_UNLOCK();
+            return err_code;
+        }
+        else
+        {
+            p_link_format = NULL;
+        }
+    }
 
     err_code = internal_message_new(&p_msg, COAP_CODE_POST, lwm2m_update_cb, local_port);
     if(err_code != NRF_SUCCESS)
@@ -384,12 +468,28 @@ uint32_t lwm2m_update(lwm2m_remote_t * p_remote, lwm2m_server_config_t * p_confi
         }
     }
 
+    if ((err_code == NRF_SUCCESS) && (p_link_format != NULL))
+    {
+        // Set content format.
+        err_code = coap_message_opt_uint_add(p_msg, COAP_OPT_CONTENT_FORMAT, COAP_CT_APP_LINK_FORMAT);
+    }
+
     if (err_code == NRF_SUCCESS)
     {
         // Sets CoAP queries
         err_code = internal_server_config_set(p_msg, p_config);
     }
 
+    if ((err_code == NRF_SUCCESS) && (p_link_format != NULL))
+    {
+        err_code = coap_message_payload_set(p_msg, p_link_format, link_format_len);
+    }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        p_msg->p_arg = (void *)(uintptr_t)generation;
+    }
+
     if (err_code == NRF_SUCCESS)
     {
         uint32_t msg_handle;
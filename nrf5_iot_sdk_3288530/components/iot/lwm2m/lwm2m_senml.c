@@ -0,0 +1,2158 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lwm2m_senml.h"
+#include "iot_errors.h"
+#include "nordic_common.h"
+#include "sdk_config.h"
+
+#if (LWM2M_ENABLE_SENML_JSON == 1) || (LWM2M_ENABLE_SENML_CBOR == 1)
+
+#define SENML_LABEL_BASE_NAME      -2                              /**< SenML base name label. */
+#define SENML_LABEL_NAME           0                               /**< SenML name label. */
+#define SENML_LABEL_VALUE          2                               /**< SenML numeric value label. */
+#define SENML_LABEL_STRING_VALUE   3                               /**< SenML string value label. */
+#define SENML_LABEL_BOOLEAN_VALUE  4                               /**< SenML boolean value label. */
+#define SENML_LABEL_DATA_VALUE     8                               /**< SenML data value label. */
+
+#define CBOR_MAJOR_UINT            0                               /**< CBOR unsigned integer. */
+#define CBOR_MAJOR_NINT            1                               /**< CBOR negative integer. */
+#define CBOR_MAJOR_BYTES           2                               /**< CBOR byte string. */
+#define CBOR_MAJOR_TEXT            3                               /**< CBOR text string. */
+#define CBOR_MAJOR_ARRAY           4                               /**< CBOR array. */
+#define CBOR_MAJOR_MAP             5                               /**< CBOR map. */
+#define CBOR_MAJOR_TAG             6                               /**< CBOR tag. */
+#define CBOR_MAJOR_SIMPLE          7                               /**< CBOR simple value or float. */
+
+#define CBOR_INFO_UINT8            24                              /**< Argument in the next byte. */
+#define CBOR_INFO_UINT16           25                              /**< Argument in the next 2 bytes, or half precision float. */
+#define CBOR_INFO_UINT32           26                              /**< Argument in the next 4 bytes, or single precision float. */
+#define CBOR_INFO_UINT64           27                              /**< Argument in the next 8 bytes, or double precision float. */
+#define CBOR_INFO_INDEFINITE       31                              /**< Indefinite length, or break. */
+
+#define CBOR_SIMPLE_FALSE          20                              /**< CBOR false. */
+#define CBOR_SIMPLE_TRUE           21                              /**< CBOR true. */
+#define CBOR_BREAK                 0xFF                            /**< End of an indefinite length array or map. */
+
+#define CBOR_HEAD(MAJOR, INFO)     ((uint8_t)(((MAJOR) << 5) | (INFO)))
+
+#define BASE_NAME_MAX_LEN          19                              /**< "/65535/65535/65535/" */
+#define NAME_MAX_LEN               24                              /**< "/65535/65535/65535/65535" */
+#define NUMBER_MAX_LEN             32                              /**< Longest JSON number read. */
+#define FLOAT_DIGITS               9                               /**< Significant digits written, enough to tell any two floats apart. */
+#define FLOAT_INTEGER_MAX_DIGITS   39                              /**< Digits of the largest float, 3.4e38. */
+#define FLOAT_FRACTION_WORDS       5                               /**< Words holding the integer of a float, or its fraction of up to 149 bits. */
+
+#define SENML_JSON_SUPPORTED(CT)   ((LWM2M_ENABLE_SENML_JSON == 1) && ((CT) == COAP_CT_APP_SENML_JSON))
+#define SENML_CBOR_SUPPORTED(CT)   ((LWM2M_ENABLE_SENML_CBOR == 1) && ((CT) == COAP_CT_APP_SENML_CBOR))
+
+#define NULL_PARAM_CHECK(PARAM)                                                                    \
+    if ((PARAM) == NULL)                                                                           \
+    {                                                                                              \
+        return (NRF_ERROR_NULL | IOT_LWM2M_ERR_BASE);                                              \
+    }
+
+
+/**@brief Write bytes, or only count them if they do not fit. */
+static void put(lwm2m_senml_writer_t * p_writer, const void * p_data, uint32_t len)
+{
+    if (p_writer->index + len <= p_writer->buffer_len)
+    {
+        memcpy(&p_writer->p_buffer[p_writer->index], p_data, len);
+    }
+
+    p_writer->index += len;
+}
+
+
+/**@brief Write a byte, or only count it if it does not fit. */
+static void put_byte(lwm2m_senml_writer_t * p_writer, uint8_t byte)
+{
+    if (p_writer->index < p_writer->buffer_len)
+    {
+        p_writer->p_buffer[p_writer->index] = byte;
+    }
+
+    p_writer->index++;
+}
+
+
+/**@brief Convert an unsigned integer to decimal digits, not NUL terminated.
+ *
+ * @return Number of digits.
+ */
+static uint8_t uint_to_str(char * p_str, uint32_t value)
+{
+    char    digits[10];
+    uint8_t len = 0;
+
+    do
+    {
+        digits[len++] = '0' + (value % 10);
+        value        /= 10;
+    } while (value != 0);
+
+    for (uint8_t i = 0; i < len; i++)
+    {
+        p_str[i] = digits[len - 1 - i];
+    }
+
+    return len;
+}
+
+
+/**@brief Convert a path to a string, not NUL terminated.
+ *
+ * @return Length of the string.
+ */
+static uint8_t path_to_str(char *           p_str,
+                           const uint16_t * p_path,
+                           uint8_t          path_len,
+                           bool             leading_slash,
+                           bool             trailing_slash)
+{
+    uint8_t len = 0;
+
+    for (uint8_t i = 0; i < path_len; i++)
+    {
+        if ((i > 0) || leading_slash)
+        {
+            p_str[len++] = '/';
+        }
+
+        len += uint_to_str(&p_str[len], p_path[i]);
+    }
+
+    if (trailing_slash)
+    {
+        p_str[len++] = '/';
+    }
+
+    return len;
+}
+
+
+/**@brief Check if a float is neither a NaN nor an infinity. */
+static bool float_is_finite(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    return ((bits & 0x7F800000) != 0x7F800000);
+}
+
+
+/**@brief Check if a float has no fraction and fits an int32_t. */
+static bool float_is_integer(float value, int32_t * p_integer)
+{
+    if ((value >= -2147483648.0f) && (value < 2147483648.0f))
+    {
+        int32_t integer = (int32_t)value;
+
+        if ((float)integer == value)
+        {
+            *p_integer = integer;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+
+static const char m_base64url[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+
+/**@brief Write a quoted JSON string, escaping quotes, backslashes and control characters. */
+static void json_string_put(lwm2m_senml_writer_t * p_writer, const char * p_str, uint32_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint32_t          start = 0;
+
+    put_byte(p_writer, '"');
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint8_t c = (uint8_t)p_str[i];
+
+        if ((c == '"') || (c == '\\') || (c < 0x20))
+        {
+            // Write the run of characters that need no escape at once.
+            put(p_writer, &p_str[start], i - start);
+            start = i + 1;
+
+            if (c < 0x20)
+            {
+                char escape[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0x0F]};
+                put(p_writer, escape, sizeof(escape));
+            }
+            else
+            {
+                put_byte(p_writer, '\\');
+                put_byte(p_writer, c);
+            }
+        }
+    }
+
+    put(p_writer, &p_str[start], len - start);
+    put_byte(p_writer, '"');
+}
+
+
+/**@brief Write a quoted base64url string, without padding. */
+static void json_base64url_put(lwm2m_senml_writer_t * p_writer, const uint8_t * p_data, uint32_t len)
+{
+    char     quad[4];
+    uint32_t i = 0;
+
+    put_byte(p_writer, '"');
+
+    for (; i + 3 <= len; i += 3)
+    {
+        uint32_t bits = ((uint32_t)p_data[i] << 16) | ((uint32_t)p_data[i + 1] << 8) | p_data[i + 2];
+
+        quad[0] = m_base64url[(bits >> 18) & 0x3F];
+        quad[1] = m_base64url[(bits >> 12) & 0x3F];
+        quad[2] = m_base64url[(bits >> 6) & 0x3F];
+        quad[3] = m_base64url[bits & 0x3F];
+        put(p_writer, quad, 4);
+    }
+
+    if (i < len)
+    {
+        uint32_t bits = (uint32_t)p_data[i] << 16;
+
+        if (i + 1 < len)
+        {
+            bits |= (uint32_t)p_data[i + 1] << 8;
+        }
+
+        quad[0] = m_base64url[(bits >> 18) & 0x3F];
+        quad[1] = m_base64url[(bits >> 12) & 0x3F];
+        quad[2] = m_base64url[(bits >> 6) & 0x3F];
+        put(p_writer, quad, (i + 1 < len) ? 3 : 2);
+    }
+
+    put_byte(p_writer, '"');
+}
+
+
+/**@brief Write a signed integer as a JSON number. */
+static void json_integer_put(lwm2m_senml_writer_t * p_writer, int32_t value)
+{
+    char     str[11];
+    uint8_t  len       = 0;
+    uint32_t magnitude = (uint32_t)value;
+
+    if (value < 0)
+    {
+        str[len++] = '-';
+        magnitude  = 0 - magnitude;
+    }
+
+    len += uint_to_str(&str[len], magnitude);
+    put(p_writer, str, len);
+}
+
+
+/**@brief Divide a multiword integer, least significant word first, by 10 in place.
+ *
+ * @details Done on 16 bit halves, so that no 64 bit division is needed.
+ *
+ * @return Remainder of the division.
+ */
+static uint32_t words_div10(uint32_t * p_words, uint32_t count)
+{
+    uint32_t remainder = 0;
+
+    for (uint32_t i = count; i-- > 0; )
+    {
+        uint32_t high = (remainder << 16) | (p_words[i] >> 16);
+        uint32_t low  = ((high % 10) << 16) | (p_words[i] & 0xFFFF);
+
+        p_words[i] = ((high / 10) << 16) | (low / 10);
+        remainder  = low % 10;
+    }
+
+    return remainder;
+}
+
+
+/**@brief Multiply a multiword integer, least significant word first, by 10 in place.
+ *
+ * @return Word carried out of the most significant word, the next decimal digit of a fraction.
+ */
+static uint32_t words_mul10(uint32_t * p_words, uint32_t count)
+{
+    uint32_t carry = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t product = ((uint64_t)p_words[i] * 10) + carry;
+
+        p_words[i] = (uint32_t)product;
+        carry      = (uint32_t)(product >> 32);
+    }
+
+    return carry;
+}
+
+
+/**@brief Set the bits of a multiword integer from a bit position, the higher bits being zero. */
+static void words_set(uint32_t * p_words, uint32_t count, uint32_t value, uint32_t bit)
+{
+    uint64_t shifted = (uint64_t)value << (bit % 32);
+
+    memset(p_words, 0, count * sizeof(uint32_t));
+
+    p_words[bit / 32] = (uint32_t)shifted;
+    if ((bit / 32) + 1 < count)
+    {
+        p_words[(bit / 32) + 1] = (uint32_t)(shifted >> 32);
+    }
+}
+
+
+/**@brief Check if a multiword integer is zero. */
+static bool words_are_zero(const uint32_t * p_words, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (p_words[i] != 0)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/**@brief Write a finite float as a JSON number of at most 9 significant digits, which is enough
+ *        to read back the same float.
+ *
+ * @details printf is not used as the float support of the C library is optional and large, nor
+ *          is double precision arithmetic, which is emulated on a single precision FPU. The
+ *          float is mantissa * 2^exponent exactly, its decimal digits are generated from that in
+ *          integer arithmetic: by division of the integer, or by multiplication of the fraction
+ *          kept in FLOAT_FRACTION_WORDS words of fixed point.
+ */
+static void json_float_put(lwm2m_senml_writer_t * p_writer, float value)
+{
+    int32_t integer;
+
+    if (float_is_integer(value, &integer))
+    {
+        json_integer_put(p_writer, integer);
+        return;
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t mantissa = bits & 0x007FFFFF;
+    int32_t  exp2     = (int32_t)((bits >> 23) & 0xFF);
+    char     str[16];
+    uint8_t  len      = 0;
+
+    if ((bits & 0x80000000) != 0)
+    {
+        str[len++] = '-';
+    }
+
+    if (exp2 == 0)
+    {
+        // Subnormal.
+        exp2 = 1;
+    }
+    else
+    {
+        mantissa |= 0x00800000;
+    }
+
+    // value = mantissa * 2^exp2.
+    exp2 -= 150;
+
+    // Significant digits and one more to round, the number of digits before the decimal point,
+    // and whether non-zero digits follow those generated.
+    uint32_t words[FLOAT_FRACTION_WORDS];
+    char     digits[FLOAT_DIGITS + 1];
+    uint8_t  digit_count = 0;
+    int32_t  point       = 0;
+    bool     sticky      = false;
+
+    if (exp2 >= 0)
+    {
+        // An integer of up to 128 bits, beyond the range of int32_t. Its digits come least
+        // significant first.
+        char    all[FLOAT_INTEGER_MAX_DIGITS];
+        uint8_t all_count = 0;
+
+        words_set(words, FLOAT_FRACTION_WORDS, mantissa, (uint32_t)exp2);
+
+        while (!words_are_zero(words, FLOAT_FRACTION_WORDS))
+        {
+            all[all_count++] = (char)('0' + words_div10(words, FLOAT_FRACTION_WORDS));
+        }
+
+        point = all_count;
+
+        for (uint8_t i = all_count; i-- > 0; )
+        {
+            if (digit_count <= FLOAT_DIGITS)
+            {
+                digits[digit_count++] = all[i];
+            }
+            else if (all[i] != '0')
+            {
+                sticky = true;
+            }
+        }
+    }
+    else
+    {
+        // Integer part of up to 24 bits, and a fraction of up to 149 bits, kept in fixed point
+        // with the binary point above the most significant word.
+        uint32_t fraction = mantissa;
+        uint32_t whole    = 0;
+
+        if (exp2 > -32)
+        {
+            whole     = mantissa >> -exp2;
+            fraction &= (1UL << -exp2) - 1;
+        }
+
+        words_set(words, FLOAT_FRACTION_WORDS, fraction, (uint32_t)((32 * FLOAT_FRACTION_WORDS) + exp2));
+
+        if (whole != 0)
+        {
+            digit_count = uint_to_str(digits, whole);
+            point       = digit_count;
+        }
+
+        while ((digit_count <= FLOAT_DIGITS) && !words_are_zero(words, FLOAT_FRACTION_WORDS))
+        {
+            uint32_t digit = words_mul10(words, FLOAT_FRACTION_WORDS);
+
+            if ((digit_count == 0) && (digit == 0))
+            {
+                // Leading zero of the fraction.
+                point--;
+                continue;
+            }
+
+            digits[digit_count++] = (char)('0' + digit);
+        }
+
+        sticky = !words_are_zero(words, FLOAT_FRACTION_WORDS);
+    }
+
+    // Round half to even to FLOAT_DIGITS digits.
+    if (digit_count > FLOAT_DIGITS)
+    {
+        char next = digits[FLOAT_DIGITS];
+
+        digit_count = FLOAT_DIGITS;
+
+        if ((next > '5') || ((next == '5') && (sticky || (((digits[FLOAT_DIGITS - 1] - '0') & 1) != 0))))
+        {
+            uint8_t i = digit_count;
+
+            while ((i > 0) && (digits[i - 1] == '9'))
+            {
+                digits[--i] = '0';
+            }
+
+            if (i == 0)
+            {
+                digits[0] = '1';
+                point++;
+            }
+            else
+            {
+                digits[i - 1]++;
+            }
+        }
+    }
+
+    while ((digit_count > 1) && (digits[digit_count - 1] == '0'))
+    {
+        digit_count--;
+    }
+
+    int32_t exp10 = point - digit_count;
+
+    if ((exp10 >= 0) && (point <= 9))
+    {
+        memcpy(&str[len], digits, digit_count);
+        len += digit_count;
+        memset(&str[len], '0', exp10);
+        len += exp10;
+    }
+    else if ((exp10 < 0) && (point > 0))
+    {
+        memcpy(&str[len], digits, point);
+        len       += point;
+        str[len++] = '.';
+        memcpy(&str[len], &digits[point], digit_count - point);
+        len       += digit_count - point;
+    }
+    else if ((exp10 < 0) && (point > -4))
+    {
+        str[len++] = '0';
+        str[len++] = '.';
+        memset(&str[len], '0', -point);
+        len       += -point;
+        memcpy(&str[len], digits, digit_count);
+        len       += digit_count;
+    }
+    else
+    {
+        int32_t exponent = point - 1;
+
+        str[len++] = digits[0];
+        if (digit_count > 1)
+        {
+            str[len++] = '.';
+            memcpy(&str[len], &digits[1], digit_count - 1);
+            len       += digit_count - 1;
+        }
+        str[len++] = 'e';
+        if (exponent < 0)
+        {
+            str[len++] = '-';
+            exponent   = -exponent;
+        }
+        len += uint_to_str(&str[len], exponent);
+    }
+
+    put(p_writer, str, len);
+}
+
+
+/**@brief Write a record as a JSON object. Names are made of digits and slashes only, and need no
+ *        escaping. */
+static void json_record_put(lwm2m_senml_writer_t *       p_writer,
+                            const lwm2m_senml_record_t * p_record,
+                            const char *                 p_base_name,
+                            uint8_t                      base_name_len,
+                            const char *                 p_name,
+                            uint8_t                      name_len)
+{
+    if (p_writer->count > 0)
+    {
+        put_byte(p_writer, ',');
+    }
+
+    put_byte(p_writer, '{');
+
+    if (p_base_name != NULL)
+    {
+        put(p_writer, "\"bn\":\"", 6);
+        put(p_writer, p_base_name, base_name_len);
+        put(p_writer, "\",", 2);
+    }
+
+    if (name_len > 0)
+    {
+        put(p_writer, "\"n\":\"", 5);
+        put(p_writer, p_name, name_len);
+        put(p_writer, "\",", 2);
+    }
+
+    switch (p_record->type)
+    {
+        case LWM2M_SENML_TYPE_INTEGER:
+            put(p_writer, "\"v\":", 4);
+            json_integer_put(p_writer, p_record->value.integer);
+            break;
+
+        case LWM2M_SENML_TYPE_FLOAT:
+            put(p_writer, "\"v\":", 4);
+            json_float_put(p_writer, p_record->value.fp);
+            break;
+
+        case LWM2M_SENML_TYPE_BOOLEAN:
+            put(p_writer, "\"vb\":", 5);
+            if (p_record->value.boolean)
+            {
+                put(p_writer, "true", 4);
+            }
+            else
+            {
+                put(p_writer, "false", 5);
+            }
+            break;
+
+        case LWM2M_SENML_TYPE_STRING:
+            put(p_writer, "\"vs\":", 5);
+            json_string_put(p_writer, p_record->value.string.p_val, p_record->value.string.len);
+            break;
+
+        default:
+            put(p_writer, "\"vd\":", 5);
+            json_base64url_put(p_writer, p_record->value.opaque.p_val, p_record->value.opaque.len);
+            break;
+    }
+
+    put_byte(p_writer, '}');
+}
+
+#endif // LWM2M_ENABLE_SENML_JSON
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+
+/**@brief Size of the head of a CBOR item with the given argument. */
+static uint8_t cbor_head_size(uint32_t argument)
+{
+    if (argument < CBOR_INFO_UINT8)
+    {
+        return 1;
+    }
+    else if (argument <= 0xFF)
+    {
+        return 2;
+    }
+    else if (argument <= 0xFFFF)
+    {
+        return 3;
+    }
+
+    return 5;
+}
+
+
+/**@brief Encode the head of a CBOR item into a buffer.
+ *
+ * @return Size of the head.
+ */
+static uint8_t cbor_head_encode(uint8_t * p_head, uint8_t major, uint32_t argument)
+{
+    uint8_t size = cbor_head_size(argument);
+
+    switch (size)
+    {
+        case 1:
+            p_head[0] = CBOR_HEAD(major, argument);
+            break;
+
+        case 2:
+            p_head[0] = CBOR_HEAD(major, CBOR_INFO_UINT8);
+            p_head[1] = (uint8_t)argument;
+            break;
+
+        case 3:
+            p_head[0] = CBOR_HEAD(major, CBOR_INFO_UINT16);
+            p_head[1] = (uint8_t)(argument >> 8);
+            p_head[2] = (uint8_t)argument;
+            break;
+
+        default:
+            p_head[0] = CBOR_HEAD(major, CBOR_INFO_UINT32);
+            p_head[1] = (uint8_t)(argument >> 24);
+            p_head[2] = (uint8_t)(argument >> 16);
+            p_head[3] = (uint8_t)(argument >> 8);
+            p_head[4] = (uint8_t)argument;
+            break;
+    }
+
+    return size;
+}
+
+
+/**@brief Write the head of a CBOR item. */
+static void cbor_head_put(lwm2m_senml_writer_t * p_writer, uint8_t major, uint32_t argument)
+{
+    uint8_t head[5];
+    uint8_t size = cbor_head_encode(head, major, argument);
+
+    put(p_writer, head, size);
+}
+
+
+/**@brief Write a CBOR integer. */
+static void cbor_integer_put(lwm2m_senml_writer_t * p_writer, int32_t value)
+{
+    if (value < 0)
+    {
+        cbor_head_put(p_writer, CBOR_MAJOR_NINT, (uint32_t)(-(value + 1)));
+    }
+    else
+    {
+        cbor_head_put(p_writer, CBOR_MAJOR_UINT, (uint32_t)value);
+    }
+}
+
+
+/**@brief Convert a float to a half precision float, if that is exact. */
+static bool float_to_half(float value, uint16_t * p_half)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign     = (bits >> 16) & 0x8000;
+    int32_t  exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if ((exponent == 0) && (mantissa == 0))
+    {
+        *p_half = sign;
+        return true;
+    }
+
+    int32_t half_exponent = exponent - 127 + 15;
+
+    if ((exponent == 0) || (half_exponent >= 31))
+    {
+        return false;
+    }
+
+    if (half_exponent >= 1)
+    {
+        if ((mantissa & 0x1FFF) != 0)
+        {
+            return false;
+        }
+
+        *p_half = sign | (uint16_t)(half_exponent << 10) | (uint16_t)(mantissa >> 13);
+        return true;
+    }
+
+    // Subnormal half precision float.
+    uint32_t shift = 126 - exponent;
+
+    if (shift > 24)
+    {
+        return false;
+    }
+
+    mantissa |= 0x800000;
+
+    if ((mantissa & ((1UL << shift) - 1)) != 0)
+    {
+        return false;
+    }
+
+    *p_half = sign | (uint16_t)(mantissa >> shift);
+    return true;
+}
+
+
+/**@brief Write a finite float as a CBOR integer, half or single precision float. */
+static void cbor_float_put(lwm2m_senml_writer_t * p_writer, float value)
+{
+    int32_t  integer;
+    uint16_t half;
+
+    if (float_is_integer(value, &integer))
+    {
+        cbor_integer_put(p_writer, integer);
+    }
+    else if (float_to_half(value, &half))
+    {
+        uint8_t item[3] = {CBOR_HEAD(CBOR_MAJOR_SIMPLE, CBOR_INFO_UINT16),
+                           (uint8_t)(half >> 8),
+                           (uint8_t)half};
+        put(p_writer, item, sizeof(item));
+    }
+    else
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint8_t item[5] = {CBOR_HEAD(CBOR_MAJOR_SIMPLE, CBOR_INFO_UINT32),
+                           (uint8_t)(bits >> 24),
+                           (uint8_t)(bits >> 16),
+                           (uint8_t)(bits >> 8),
+                           (uint8_t)bits};
+        put(p_writer, item, sizeof(item));
+    }
+}
+
+
+/**@brief Write a record as a CBOR map. */
+static void cbor_record_put(lwm2m_senml_writer_t *       p_writer,
+                            const lwm2m_senml_record_t * p_record,
+                            const char *                 p_base_name,
+                            uint8_t                      base_name_len,
+                            const char *                 p_name,
+                            uint8_t                      name_len)
+{
+    uint8_t pairs = 1;
+
+    pairs += (p_base_name != NULL) ? 1 : 0;
+    pairs += (name_len > 0) ? 1 : 0;
+
+    put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_MAP, pairs));
+
+    if (p_base_name != NULL)
+    {
+        put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_NINT, -1 - SENML_LABEL_BASE_NAME));
+        cbor_head_put(p_writer, CBOR_MAJOR_TEXT, base_name_len);
+        put(p_writer, p_base_name, base_name_len);
+    }
+
+    if (name_len > 0)
+    {
+        put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_NAME));
+        cbor_head_put(p_writer, CBOR_MAJOR_TEXT, name_len);
+        put(p_writer, p_name, name_len);
+    }
+
+    switch (p_record->type)
+    {
+        case LWM2M_SENML_TYPE_INTEGER:
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_VALUE));
+            cbor_integer_put(p_writer, p_record->value.integer);
+            break;
+
+        case LWM2M_SENML_TYPE_FLOAT:
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_VALUE));
+            cbor_float_put(p_writer, p_record->value.fp);
+            break;
+
+        case LWM2M_SENML_TYPE_BOOLEAN:
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_BOOLEAN_VALUE));
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_SIMPLE, p_record->value.boolean ? CBOR_SIMPLE_TRUE
+                                                                                    : CBOR_SIMPLE_FALSE));
+            break;
+
+        case LWM2M_SENML_TYPE_STRING:
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_STRING_VALUE));
+            cbor_head_put(p_writer, CBOR_MAJOR_TEXT, p_record->value.string.len);
+            put(p_writer, p_record->value.string.p_val, p_record->value.string.len);
+            break;
+
+        default:
+            put_byte(p_writer, CBOR_HEAD(CBOR_MAJOR_UINT, SENML_LABEL_DATA_VALUE));
+            cbor_head_put(p_writer, CBOR_MAJOR_BYTES, p_record->value.opaque.len);
+            put(p_writer, p_record->value.opaque.p_val, p_record->value.opaque.len);
+            break;
+    }
+}
+
+#endif // LWM2M_ENABLE_SENML_CBOR
+
+
+/**@brief Number of bytes that closing the records will take once a record is added. */
+static uint32_t closing_size(const lwm2m_senml_writer_t * p_writer)
+{
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+    if (p_writer->content_type == COAP_CT_APP_SENML_CBOR)
+    {
+        // One byte of the array head is reserved at the start.
+        return cbor_head_size(p_writer->count + 1) - 1;
+    }
+#endif // LWM2M_ENABLE_SENML_CBOR
+
+    // Closing bracket.
+    return 1;
+}
+
+
+uint32_t lwm2m_senml_writer_init(lwm2m_senml_writer_t * p_writer,
+                                 coap_content_type_t    content_type,
+                                 uint8_t *              p_buffer,
+                                 uint32_t               buffer_len,
+                                 const uint16_t *       p_base_path,
+                                 uint8_t                base_path_len)
+{
+    NULL_PARAM_CHECK(p_writer);
+
+    if (!SENML_JSON_SUPPORTED(content_type) && !SENML_CBOR_SUPPORTED(content_type))
+    {
+        return (NRF_ERROR_NOT_SUPPORTED | IOT_LWM2M_ERR_BASE);
+    }
+
+    if ((base_path_len >= LWM2M_SENML_MAX_PATH_LEN) || ((base_path_len > 0) && (p_base_path == NULL)))
+    {
+        return (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE);
+    }
+
+    memset(p_writer, 0, sizeof(lwm2m_senml_writer_t));
+
+    p_writer->p_buffer      = p_buffer;
+    p_writer->buffer_len    = (p_buffer != NULL) ? buffer_len : 0;
+    p_writer->content_type  = content_type;
+    p_writer->base_path_len = base_path_len;
+
+    if (base_path_len > 0)
+    {
+        memcpy(p_writer->base_path, p_base_path, base_path_len * sizeof(uint16_t));
+    }
+
+    // Open the array. The head of a CBOR array is completed once the number of records is known.
+    put_byte(p_writer, (content_type == COAP_CT_APP_SENML_CBOR) ? CBOR_HEAD(CBOR_MAJOR_ARRAY, 0) : '[');
+
+    if ((p_buffer != NULL) && (p_writer->index + closing_size(p_writer) > p_writer->buffer_len))
+    {
+        return (NRF_ERROR_DATA_SIZE | IOT_LWM2M_ERR_BASE);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_senml_record_add(lwm2m_senml_writer_t * p_writer, const lwm2m_senml_record_t * p_record)
+{
+    NULL_PARAM_CHECK(p_writer);
+    NULL_PARAM_CHECK(p_record);
+
+    if ((p_record->path_len == 0)                          ||
+        (p_record->path_len > LWM2M_SENML_MAX_PATH_LEN)    ||
+        (p_record->path_len < p_writer->base_path_len)     ||
+        (memcmp(p_record->path, p_writer->base_path, p_writer->base_path_len * sizeof(uint16_t)) != 0))
+    {
+        return (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE);
+    }
+
+    if ((p_record->type == LWM2M_SENML_TYPE_FLOAT) && !float_is_finite(p_record->value.fp))
+    {
+        return (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE);
+    }
+
+    const uint16_t * p_suffix   = &p_record->path[p_writer->base_path_len];
+    uint8_t          suffix_len = p_record->path_len - p_writer->base_path_len;
+
+    char         base_name[BASE_NAME_MAX_LEN];
+    const char * p_base_name   = NULL;
+    uint8_t      base_name_len = 0;
+    char         name[NAME_MAX_LEN];
+    uint8_t      name_len      = 0;
+
+    if (p_writer->count == 0)
+    {
+        // The base name ends with a slash, as in "/3303/0/", unless the first record is named by
+        // the base path alone, as in a read of a single resource.
+        p_writer->base_name_slash = (suffix_len > 0);
+
+        base_name_len = path_to_str(base_name,
+                                    p_writer->base_path,
+                                    p_writer->base_path_len,
+                                    true,
+                                    p_writer->base_name_slash);
+        p_base_name   = base_name;
+    }
+    else if (p_writer->base_name_slash && (suffix_len == 0))
+    {
+        // "/3303/0/" cannot be completed into "/3303/0".
+        return (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE);
+    }
+
+    name_len = path_to_str(name, p_suffix, suffix_len, !p_writer->base_name_slash, false);
+
+    uint32_t index = p_writer->index;
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+    if (p_writer->content_type == COAP_CT_APP_SENML_CBOR)
+    {
+        cbor_record_put(p_writer, p_record, p_base_name, base_name_len, name, name_len);
+    }
+#endif // LWM2M_ENABLE_SENML_CBOR
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+    if (p_writer->content_type == COAP_CT_APP_SENML_JSON)
+    {
+        json_record_put(p_writer, p_record, p_base_name, base_name_len, name, name_len);
+    }
+#endif // LWM2M_ENABLE_SENML_JSON
+
+    if ((p_writer->p_buffer != NULL) &&
+        (p_writer->index + closing_size(p_writer) > p_writer->buffer_len))
+    {
+        // Drop the partly written record.
+        p_writer->index = index;
+        return (NRF_ERROR_DATA_SIZE | IOT_LWM2M_ERR_BASE);
+    }
+
+    p_writer->count++;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Write a record for a resource of the base path instance. */
+static uint32_t resource_record_add(lwm2m_senml_writer_t * p_writer,
+                                    uint16_t               resource_id,
+                                    lwm2m_senml_record_t * p_record)
+{
+    NULL_PARAM_CHECK(p_writer);
+
+    if (p_writer->base_path_len != 2)
+    {
+        return (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE);
+    }
+
+    p_record->path[0]  = p_writer->base_path[0];
+    p_record->path[1]  = p_writer->base_path[1];
+    p_record->path[2]  = resource_id;
+    p_record->path_len = 3;
+
+    return lwm2m_senml_record_add(p_writer, p_record);
+}
+
+
+uint32_t lwm2m_senml_integer_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, int32_t value)
+{
+    lwm2m_senml_record_t record;
+
+    record.type          = LWM2M_SENML_TYPE_INTEGER;
+    record.value.integer = value;
+
+    return resource_record_add(p_writer, resource_id, &record);
+}
+
+
+uint32_t lwm2m_senml_float_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, float value)
+{
+    lwm2m_senml_record_t record;
+
+    record.type     = LWM2M_SENML_TYPE_FLOAT;
+    record.value.fp = value;
+
+    return resource_record_add(p_writer, resource_id, &record);
+}
+
+
+uint32_t lwm2m_senml_bool_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, bool value)
+{
+    lwm2m_senml_record_t record;
+
+    record.type          = LWM2M_SENML_TYPE_BOOLEAN;
+    record.value.boolean = value;
+
+    return resource_record_add(p_writer, resource_id, &record);
+}
+
+
+uint32_t lwm2m_senml_string_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, lwm2m_string_t value)
+{
+    lwm2m_senml_record_t record;
+
+    record.type         = LWM2M_SENML_TYPE_STRING;
+    record.value.string = value;
+
+    return resource_record_add(p_writer, resource_id, &record);
+}
+
+
+uint32_t lwm2m_senml_opaque_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, lwm2m_opaque_t value)
+{
+    lwm2m_senml_record_t record;
+
+    record.type         = LWM2M_SENML_TYPE_OPAQUE;
+    record.value.opaque = value;
+
+    return resource_record_add(p_writer, resource_id, &record);
+}
+
+
+uint32_t lwm2m_senml_writer_finish(lwm2m_senml_writer_t * p_writer, uint32_t * p_len)
+{
+    NULL_PARAM_CHECK(p_writer);
+    NULL_PARAM_CHECK(p_len);
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+    if (p_writer->content_type == COAP_CT_APP_SENML_CBOR)
+    {
+        uint8_t head[5];
+        uint8_t head_size = cbor_head_encode(head, CBOR_MAJOR_ARRAY, p_writer->count);
+
+        // Room for the records and the array head was checked as they were added.
+        if ((p_writer->p_buffer != NULL) && (head_size > 1))
+        {
+            memmove(&p_writer->p_buffer[head_size],
+                    &p_writer->p_buffer[1],
+                    p_writer->index - 1);
+        }
+
+        p_writer->index += head_size - 1;
+
+        if (p_writer->p_buffer != NULL)
+        {
+            memcpy(p_writer->p_buffer, head, head_size);
+        }
+    }
+#endif // LWM2M_ENABLE_SENML_CBOR
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+    if (p_writer->content_type == COAP_CT_APP_SENML_JSON)
+    {
+        put_byte(p_writer, ']');
+    }
+#endif // LWM2M_ENABLE_SENML_JSON
+
+    *p_len = p_writer->index;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Resolve the name of a record, the base name followed by the name, into a path. */
+static bool name_resolve(lwm2m_senml_record_t * p_record,
+                         const char *           p_base_name,
+                         uint32_t               base_name_len,
+                         const char *           p_name,
+                         uint32_t               name_len)
+{
+    uint32_t total_len = base_name_len + name_len;
+
+    if ((total_len == 0) || (((base_name_len > 0) ? p_base_name[0] : p_name[0]) != '/'))
+    {
+        return false;
+    }
+
+    uint32_t value  = 0;
+    uint8_t  digits = 0;
+
+    p_record->path_len = 0;
+
+    for (uint32_t i = 1; i <= total_len; i++)
+    {
+        char c = '/';
+
+        if (i < base_name_len)
+        {
+            c = p_base_name[i];
+        }
+        else if (i < total_len)
+        {
+            c = p_name[i - base_name_len];
+        }
+
+        if (c == '/')
+        {
+            if (digits == 0)
+            {
+                // Only a trailing slash may follow a slash.
+                if (i == total_len)
+                {
+                    break;
+                }
+                return false;
+            }
+            if (p_record->path_len == LWM2M_SENML_MAX_PATH_LEN)
+            {
+                return false;
+            }
+
+            p_record->path[p_record->path_len++] = (uint16_t)value;
+
+            value  = 0;
+            digits = 0;
+        }
+        else if ((c >= '0') && (c <= '9'))
+        {
+            value = value * 10 + (c - '0');
+            digits++;
+
+            if (value > UINT16_MAX)
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (p_record->path_len > 0);
+}
+
+
+/**@brief Set the value of a record read as an unsigned or negative CBOR integer. */
+static void integer_value_set(lwm2m_senml_record_t * p_record, bool negative, uint64_t magnitude)
+{
+    if (!negative && (magnitude <= INT32_MAX))
+    {
+        p_record->type          = LWM2M_SENML_TYPE_INTEGER;
+        p_record->value.integer = (int32_t)magnitude;
+    }
+    else if (negative && (magnitude <= INT32_MAX))
+    {
+        // The CBOR argument of a negative integer n is -1 - n.
+        p_record->type          = LWM2M_SENML_TYPE_INTEGER;
+        p_record->value.integer = -1 - (int32_t)magnitude;
+    }
+    else
+    {
+        p_record->type     = LWM2M_SENML_TYPE_FLOAT;
+        p_record->value.fp = negative ? -1.0f - (float)magnitude : (float)magnitude;
+    }
+}
+
+
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+
+/**@brief Skip JSON whitespace.
+ *
+ * @return Next character, or 0 at the end of the buffer.
+ */
+static char json_ws_skip(lwm2m_senml_reader_t * p_reader)
+{
+    while (p_reader->index < p_reader->buffer_len)
+    {
+        char c = (char)p_reader->p_buffer[p_reader->index];
+
+        if ((c != ' ') && (c != '\t') && (c != '\r') && (c != '\n'))
+        {
+            return c;
+        }
+
+        p_reader->index++;
+    }
+
+    return 0;
+}
+
+
+/**@brief Consume the given character after any whitespace. */
+static bool json_char_read(lwm2m_senml_reader_t * p_reader, char c)
+{
+    if (json_ws_skip(p_reader) != c)
+    {
+        return false;
+    }
+
+    p_reader->index++;
+    return true;
+}
+
+
+/**@brief Get the value of a hexadecimal digit, or -1. */
+static int8_t hex_value(char c)
+{
+    if ((c >= '0') && (c <= '9'))
+    {
+        return c - '0';
+    }
+    if ((c >= 'a') && (c <= 'f'))
+    {
+        return c - 'a' + 10;
+    }
+    if ((c >= 'A') && (c <= 'F'))
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+
+/**@brief Read a JSON string, unescaping it in place. */
+static bool json_string_read(lwm2m_senml_reader_t * p_reader, char ** pp_str, uint32_t * p_len)
+{
+    if (!json_char_read(p_reader, '"'))
+    {
+        return false;
+    }
+
+    char *   p_str = (char *)&p_reader->p_buffer[p_reader->index];
+    uint32_t len   = 0;
+
+    while (p_reader->index < p_reader->buffer_len)
+    {
+        uint8_t c = p_reader->p_buffer[p_reader->index++];
+
+        if (c == '"')
+        {
+            *pp_str = p_str;
+            *p_len  = len;
+            return true;
+        }
+
+        if (c < 0x20)
+        {
+            return false;
+        }
+
+        if (c == '\\')
+        {
+            if (p_reader->index >= p_reader->buffer_len)
+            {
+                return false;
+            }
+
+            c = p_reader->p_buffer[p_reader->index++];
+
+            switch (c)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    break;
+
+                case 'b':
+                    c = '\b';
+                    break;
+
+                case 'f':
+                    c = '\f';
+                    break;
+
+                case 'n':
+                    c = '\n';
+                    break;
+
+                case 'r':
+                    c = '\r';
+                    break;
+
+                case 't':
+                    c = '\t';
+                    break;
+
+                case 'u':
+                {
+                    uint32_t code_point = 0;
+
+                    if (p_reader->index + 4 > p_reader->buffer_len)
+                    {
+                        return false;
+                    }
+
+                    for (uint8_t i = 0; i < 4; i++)
+                    {
+                        int8_t digit = hex_value((char)p_reader->p_buffer[p_reader->index++]);
+
+                        if (digit < 0)
+                        {
+                            return false;
+                        }
+
+                        code_point = (code_point << 4) | (uint32_t)digit;
+                    }
+
+                    // Surrogate pairs are not supported.
+                    if ((code_point >= 0xD800) && (code_point <= 0xDFFF))
+                    {
+                        return false;
+                    }
+
+                    // UTF-8 is never longer than the escape it replaces.
+                    if (code_point < 0x80)
+                    {
+                        p_str[len++] = (char)code_point;
+                    }
+                    else if (code_point < 0x800)
+                    {
+                        p_str[len++] = (char)(0xC0 | (code_point >> 6));
+                        p_str[len++] = (char)(0x80 | (code_point & 0x3F));
+                    }
+                    else
+                    {
+                        p_str[len++] = (char)(0xE0 | (code_point >> 12));
+                        p_str[len++] = (char)(0x80 | ((code_point >> 6) & 0x3F));
+                        p_str[len++] = (char)(0x80 | (code_point & 0x3F));
+                    }
+                    continue;
+                }
+
+                default:
+                    return false;
+            }
+        }
+
+        p_str[len++] = (char)c;
+    }
+
+    return false;
+}
+
+
+/**@brief Decode a base64url, or base64, string in place. Padding is optional. */
+static bool base64_decode(uint8_t * p_data, uint32_t * p_len)
+{
+    uint32_t bits      = 0;
+    uint8_t  bit_count = 0;
+    uint32_t len       = 0;
+    uint32_t i;
+
+    for (i = 0; i < *p_len; i++)
+    {
+        char    c = (char)p_data[i];
+        uint8_t value;
+
+        if ((c >= 'A') && (c <= 'Z'))
+        {
+            value = c - 'A';
+        }
+        else if ((c >= 'a') && (c <= 'z'))
+        {
+            value = c - 'a' + 26;
+        }
+        else if ((c >= '0') && (c <= '9'))
+        {
+            value = c - '0' + 52;
+        }
+        else if ((c == '-') || (c == '+'))
+        {
+            value = 62;
+        }
+        else if ((c == '_') || (c == '/'))
+        {
+            value = 63;
+        }
+        else
+        {
+            break;
+        }
+
+        bits       = (bits << 6) | value;
+        bit_count += 6;
+
+        if (bit_count >= 8)
+        {
+            bit_count    -= 8;
+            p_data[len++] = (uint8_t)(bits >> bit_count);
+        }
+    }
+
+    // Only padding may follow, and a single character cannot complete a byte.
+    for (; i < *p_len; i++)
+    {
+        if (p_data[i] != '=')
+        {
+            return false;
+        }
+    }
+
+    if (bit_count >= 6)
+    {
+        return false;
+    }
+
+    *p_len = len;
+    return true;
+}
+
+
+/**@brief Read a JSON number. */
+static bool json_number_read(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record)
+{
+    char     number[NUMBER_MAX_LEN];
+    uint32_t len        = 0;
+    bool     fractional = false;
+
+    (void)json_ws_skip(p_reader);
+
+    while (p_reader->index < p_reader->buffer_len)
+    {
+        char c = (char)p_reader->p_buffer[p_reader->index];
+
+        if ((c == '.') || (c == 'e') || (c == 'E'))
+        {
+            fractional = true;
+        }
+        else if (((c < '0') || (c > '9')) && (c != '-') && (c != '+'))
+        {
+            break;
+        }
+
+        if (len == NUMBER_MAX_LEN - 1)
+        {
+            return false;
+        }
+
+        number[len++] = c;
+        p_reader->index++;
+    }
+
+    number[len] = '\0';
+
+    if (!fractional)
+    {
+        bool     negative  = (number[0] == '-');
+        uint64_t magnitude = 0;
+        uint32_t i         = negative ? 1 : 0;
+
+        if (i == len)
+        {
+            return false;
+        }
+
+        for (; i < len; i++)
+        {
+            if ((number[i] < '0') || (number[i] > '9'))
+            {
+                return false;
+            }
+
+            magnitude = magnitude * 10 + (number[i] - '0');
+
+            if (magnitude > UINT32_MAX)
+            {
+                // Beyond int32_t anyway.
+                fractional = true;
+                break;
+            }
+        }
+
+        if (!fractional)
+        {
+            if (negative && (magnitude > 0))
+            {
+                integer_value_set(p_record, true, magnitude - 1);
+            }
+            else
+            {
+                integer_value_set(p_record, false, magnitude);
+            }
+            return true;
+        }
+    }
+
+    char * p_end;
+    float  value = strtof(number, &p_end);
+
+    if ((p_end == number) || (*p_end != '\0'))
+    {
+        return false;
+    }
+
+    p_record->type     = LWM2M_SENML_TYPE_FLOAT;
+    p_record->value.fp = value;
+
+    return true;
+}
+
+
+/**@brief Read a JSON literal. */
+static bool json_literal_read(lwm2m_senml_reader_t * p_reader, const char * p_literal)
+{
+    uint32_t len = strlen(p_literal);
+
+    (void)json_ws_skip(p_reader);
+
+    if ((p_reader->index + len > p_reader->buffer_len) ||
+        (memcmp(&p_reader->p_buffer[p_reader->index], p_literal, len) != 0))
+    {
+        return false;
+    }
+
+    p_reader->index += len;
+    return true;
+}
+
+
+/**@brief Skip a JSON string, number or literal. */
+static bool json_scalar_skip(lwm2m_senml_reader_t * p_reader)
+{
+    lwm2m_senml_record_t record;
+    char *               p_str;
+    uint32_t             len;
+
+    switch (json_ws_skip(p_reader))
+    {
+        case '"':
+            return json_string_read(p_reader, &p_str, &len);
+
+        case 't':
+            return json_literal_read(p_reader, "true");
+
+        case 'f':
+            return json_literal_read(p_reader, "false");
+
+        case 'n':
+            return json_literal_read(p_reader, "null");
+
+        default:
+            return json_number_read(p_reader, &record);
+    }
+}
+
+
+/**@brief Check if a label is the given one. */
+static bool label_is(const char * p_label, uint32_t len, const char * p_expected)
+{
+    return (strlen(p_expected) == len) && (memcmp(p_label, p_expected, len) == 0);
+}
+
+
+/**@brief Read a record from a JSON object. */
+static uint32_t json_record_read(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record)
+{
+    if (p_reader->first)
+    {
+        p_reader->first = false;
+
+        if (json_char_read(p_reader, ']'))
+        {
+            p_reader->ended = true;
+            return (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE);
+        }
+    }
+    else
+    {
+        if (json_char_read(p_reader, ']'))
+        {
+            p_reader->ended = true;
+            return (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE);
+        }
+        if (!json_char_read(p_reader, ','))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+    }
+
+    if (!json_char_read(p_reader, '{'))
+    {
+        return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+    }
+
+    char *   p_name      = NULL;
+    uint32_t name_len    = 0;
+    uint8_t  value_count = 0;
+
+    do
+    {
+        char *   p_label;
+        uint32_t label_len;
+        bool     valid;
+
+        if (!json_string_read(p_reader, &p_label, &label_len) || !json_char_read(p_reader, ':'))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+
+        if (label_is(p_label, label_len, "bn"))
+        {
+            char *   p_base_name;
+            uint32_t base_name_len;
+
+            valid = json_string_read(p_reader, &p_base_name, &base_name_len) &&
+                    (base_name_len <= UINT16_MAX);
+
+            p_reader->p_base_name   = p_base_name;
+            p_reader->base_name_len = (uint16_t)base_name_len;
+        }
+        else if (label_is(p_label, label_len, "n"))
+        {
+            valid = json_string_read(p_reader, &p_name, &name_len);
+        }
+        else if (label_is(p_label, label_len, "v"))
+        {
+            valid = json_number_read(p_reader, p_record);
+            value_count++;
+        }
+        else if (label_is(p_label, label_len, "vs"))
+        {
+            p_record->type = LWM2M_SENML_TYPE_STRING;
+            valid          = json_string_read(p_reader,
+                                              &p_record->value.string.p_val,
+                                              &p_record->value.string.len);
+            value_count++;
+        }
+        else if (label_is(p_label, label_len, "vb"))
+        {
+            p_record->type = LWM2M_SENML_TYPE_BOOLEAN;
+
+            if (json_literal_read(p_reader, "true"))
+            {
+                p_record->value.boolean = true;
+                valid                   = true;
+            }
+            else
+            {
+                p_record->value.boolean = false;
+                valid                   = json_literal_read(p_reader, "false");
+            }
+            value_count++;
+        }
+        else if (label_is(p_label, label_len, "vd"))
+        {
+            char * p_data;
+
+            p_record->type = LWM2M_SENML_TYPE_OPAQUE;
+            valid          = json_string_read(p_reader, &p_data, &p_record->value.opaque.len) &&
+                             base64_decode((uint8_t *)p_data, &p_record->value.opaque.len);
+
+            p_record->value.opaque.p_val = (uint8_t *)p_data;
+            value_count++;
+        }
+        else
+        {
+            // Labels ending with an underscore must be understood.
+            valid = (label_len > 0) && (p_label[label_len - 1] != '_') && json_scalar_skip(p_reader);
+        }
+
+        if (!valid)
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+    } while (json_char_read(p_reader, ','));
+
+    if (!json_char_read(p_reader, '}') ||
+        (value_count != 1)             ||
+        !name_resolve(p_record, p_reader->p_base_name, p_reader->base_name_len, p_name, name_len))
+    {
+        return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+    }
+
+    return NRF_SUCCESS;
+}
+
+#endif // LWM2M_ENABLE_SENML_JSON
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+
+/**@brief Read the head of a CBOR item.
+ *
+ * @param[inout] p_reader      Reader.
+ * @param[out]   p_major       Major type of the item.
+ * @param[out]   p_info        Additional information of the item.
+ * @param[out]   p_argument    Argument of the item, or raw bits of a float.
+ */
+static bool cbor_head_read(lwm2m_senml_reader_t * p_reader,
+                           uint8_t *              p_major,
+                           uint8_t *              p_info,
+                           uint64_t *             p_argument)
+{
+    if (p_reader->index >= p_reader->buffer_len)
+    {
+        return false;
+    }
+
+    uint8_t head = p_reader->p_buffer[p_reader->index++];
+    uint8_t size = 0;
+
+    *p_major    = head >> 5;
+    *p_info     = head & 0x1F;
+    *p_argument = *p_info;
+
+    if (*p_info < CBOR_INFO_UINT8)
+    {
+        return true;
+    }
+    else if (*p_info <= CBOR_INFO_UINT64)
+    {
+        size = 1 << (*p_info - CBOR_INFO_UINT8);
+    }
+    else if (*p_info != CBOR_INFO_INDEFINITE)
+    {
+        return false;
+    }
+
+    if (p_reader->index + size > p_reader->buffer_len)
+    {
+        return false;
+    }
+
+    *p_argument = 0;
+
+    for (uint8_t i = 0; i < size; i++)
+    {
+        *p_argument = (*p_argument << 8) | p_reader->p_buffer[p_reader->index++];
+    }
+
+    return true;
+}
+
+
+/**@brief Read a CBOR text or byte string of definite length. */
+static bool cbor_string_read(lwm2m_senml_reader_t * p_reader,
+                             uint8_t                major,
+                             uint8_t **             pp_data,
+                             uint32_t *             p_len)
+{
+    uint8_t  item_major;
+    uint8_t  info;
+    uint64_t len;
+
+    if (!cbor_head_read(p_reader, &item_major, &info, &len) ||
+        (item_major != major)                               ||
+        (info == CBOR_INFO_INDEFINITE)                      ||
+        (len > p_reader->buffer_len - p_reader->index))
+    {
+        return false;
+    }
+
+    *pp_data          = &p_reader->p_buffer[p_reader->index];
+    *p_len            = (uint32_t)len;
+    p_reader->index  += (uint32_t)len;
+
+    return true;
+}
+
+
+/**@brief Convert a half precision float to a float. */
+static float half_to_float(uint16_t half)
+{
+    uint32_t sign     = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+    float    value;
+
+    if (exponent == 0)
+    {
+        // Zero or subnormal, mantissa * 2^-24.
+        value = (float)mantissa / 16777216.0f;
+        return (sign != 0) ? -value : value;
+    }
+    else if (exponent == 31)
+    {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    }
+    else
+    {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/**@brief Read a CBOR number. */
+static bool cbor_number_read(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record)
+{
+    uint8_t  major;
+    uint8_t  info;
+    uint64_t argument;
+
+    if (!cbor_head_read(p_reader, &major, &info, &argument) || (info == CBOR_INFO_INDEFINITE))
+    {
+        return false;
+    }
+
+    if ((major == CBOR_MAJOR_UINT) || (major == CBOR_MAJOR_NINT))
+    {
+        integer_value_set(p_record, (major == CBOR_MAJOR_NINT), argument);
+        return true;
+    }
+
+    if (major != CBOR_MAJOR_SIMPLE)
+    {
+        return false;
+    }
+
+    p_record->type = LWM2M_SENML_TYPE_FLOAT;
+
+    switch (info)
+    {
+        case CBOR_INFO_UINT16:
+            p_record->value.fp = half_to_float((uint16_t)argument);
+            return true;
+
+        case CBOR_INFO_UINT32:
+        {
+            uint32_t bits = (uint32_t)argument;
+            memcpy(&p_record->value.fp, &bits, sizeof(float));
+            return true;
+        }
+
+        case CBOR_INFO_UINT64:
+        {
+            double value;
+            memcpy(&value, &argument, sizeof(double));
+            p_record->value.fp = (float)value;
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+
+/**@brief Skip a CBOR scalar item, along with any tags. */
+static bool cbor_scalar_skip(lwm2m_senml_reader_t * p_reader)
+{
+    uint8_t  major;
+    uint8_t  info;
+    uint64_t argument;
+
+    do
+    {
+        if (!cbor_head_read(p_reader, &major, &info, &argument) || (info == CBOR_INFO_INDEFINITE))
+        {
+            return false;
+        }
+    } while (major == CBOR_MAJOR_TAG);
+
+    if ((major == CBOR_MAJOR_BYTES) || (major == CBOR_MAJOR_TEXT))
+    {
+        if (argument > p_reader->buffer_len - p_reader->index)
+        {
+            return false;
+        }
+
+        p_reader->index += (uint32_t)argument;
+    }
+
+    return (major != CBOR_MAJOR_ARRAY) && (major != CBOR_MAJOR_MAP);
+}
+
+
+/**@brief Read a record from a CBOR map. */
+static uint32_t cbor_record_read(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record)
+{
+    if (p_reader->indefinite)
+    {
+        if (p_reader->index >= p_reader->buffer_len)
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+        if (p_reader->p_buffer[p_reader->index] == CBOR_BREAK)
+        {
+            p_reader->index++;
+            p_reader->ended = true;
+            return (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE);
+        }
+    }
+    else if (p_reader->remaining == 0)
+    {
+        p_reader->ended = true;
+        return (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE);
+    }
+    else
+    {
+        p_reader->remaining--;
+    }
+
+    uint8_t  major;
+    uint8_t  info;
+    uint64_t pairs;
+
+    if (!cbor_head_read(p_reader, &major, &info, &pairs) || (major != CBOR_MAJOR_MAP))
+    {
+        return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+    }
+
+    bool     indefinite  = (info == CBOR_INFO_INDEFINITE);
+    uint8_t *p_name      = NULL;
+    uint32_t name_len    = 0;
+    uint8_t  value_count = 0;
+
+    while (indefinite || (pairs > 0))
+    {
+        if (indefinite)
+        {
+            if (p_reader->index >= p_reader->buffer_len)
+            {
+                return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+            }
+            if (p_reader->p_buffer[p_reader->index] == CBOR_BREAK)
+            {
+                p_reader->index++;
+                break;
+            }
+        }
+        else
+        {
+            pairs--;
+        }
+
+        uint8_t  key_major;
+        uint8_t  key_info;
+        uint64_t key;
+        bool     valid;
+
+        if (!cbor_head_read(p_reader, &key_major, &key_info, &key))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+
+        if (key_major == CBOR_MAJOR_TEXT)
+        {
+            // Labels ending with an underscore must be understood.
+            if ((key_info == CBOR_INFO_INDEFINITE)                    ||
+                (key == 0)                                            ||
+                (key > p_reader->buffer_len - p_reader->index)        ||
+                (p_reader->p_buffer[p_reader->index + key - 1] == '_'))
+            {
+                return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+            }
+
+            p_reader->index += (uint32_t)key;
+            valid            = cbor_scalar_skip(p_reader);
+        }
+        else if ((key_major != CBOR_MAJOR_UINT) && (key_major != CBOR_MAJOR_NINT))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+        else
+        {
+            int32_t label = (key > INT16_MAX) ? INT16_MAX : (int32_t)key;
+
+            if (key_major == CBOR_MAJOR_NINT)
+            {
+                label = -1 - label;
+            }
+
+            switch (label)
+            {
+                case SENML_LABEL_BASE_NAME:
+                {
+                    uint8_t * p_base_name;
+                    uint32_t  base_name_len;
+
+                    valid = cbor_string_read(p_reader, CBOR_MAJOR_TEXT, &p_base_name, &base_name_len) &&
+                            (base_name_len <= UINT16_MAX);
+
+                    p_reader->p_base_name   = (const char *)p_base_name;
+                    p_reader->base_name_len = (uint16_t)base_name_len;
+                    break;
+                }
+
+                case SENML_LABEL_NAME:
+                    valid = cbor_string_read(p_reader, CBOR_MAJOR_TEXT, &p_name, &name_len);
+                    break;
+
+                case SENML_LABEL_VALUE:
+                    valid = cbor_number_read(p_reader, p_record);
+                    value_count++;
+                    break;
+
+                case SENML_LABEL_STRING_VALUE:
+                    p_record->type = LWM2M_SENML_TYPE_STRING;
+                    valid          = cbor_string_read(p_reader,
+                                                      CBOR_MAJOR_TEXT,
+                                                      (uint8_t **)&p_record->value.string.p_val,
+                                                      &p_record->value.string.len);
+                    value_count++;
+                    break;
+
+                case SENML_LABEL_BOOLEAN_VALUE:
+                {
+                    uint8_t  value_major;
+                    uint8_t  value_info;
+                    uint64_t value;
+
+                    p_record->type          = LWM2M_SENML_TYPE_BOOLEAN;
+                    p_record->value.boolean = false;
+                    valid                   = cbor_head_read(p_reader, &value_major, &value_info, &value) &&
+                                              (value_major == CBOR_MAJOR_SIMPLE)                            &&
+                                              ((value_info == CBOR_SIMPLE_FALSE) ||
+                                               (value_info == CBOR_SIMPLE_TRUE));
+
+                    p_record->value.boolean = (value_info == CBOR_SIMPLE_TRUE);
+                    value_count++;
+                    break;
+                }
+
+                case SENML_LABEL_DATA_VALUE:
+                    p_record->type = LWM2M_SENML_TYPE_OPAQUE;
+                    valid          = cbor_string_read(p_reader,
+                                                      CBOR_MAJOR_BYTES,
+                                                      &p_record->value.opaque.p_val,
+                                                      &p_record->value.opaque.len);
+                    value_count++;
+                    break;
+
+                default:
+                    valid = cbor_scalar_skip(p_reader);
+                    break;
+            }
+        }
+
+        if (!valid)
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+    }
+
+    if ((value_count != 1) ||
+        !name_resolve(p_record, p_reader->p_base_name, p_reader->base_name_len, (const char *)p_name, name_len))
+    {
+        return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+    }
+
+    return NRF_SUCCESS;
+}
+
+#endif // LWM2M_ENABLE_SENML_CBOR
+
+
+uint32_t lwm2m_senml_reader_init(lwm2m_senml_reader_t * p_reader,
+                                 coap_content_type_t    content_type,
+                                 uint8_t *              p_buffer,
+                                 uint32_t               buffer_len)
+{
+    NULL_PARAM_CHECK(p_reader);
+    NULL_PARAM_CHECK(p_buffer);
+
+    if (!SENML_JSON_SUPPORTED(content_type) && !SENML_CBOR_SUPPORTED(content_type))
+    {
+        return (NRF_ERROR_NOT_SUPPORTED | IOT_LWM2M_ERR_BASE);
+    }
+
+    memset(p_reader, 0, sizeof(lwm2m_senml_reader_t));
+
+    p_reader->p_buffer     = p_buffer;
+    p_reader->buffer_len   = buffer_len;
+    p_reader->content_type = content_type;
+    p_reader->first        = true;
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+    if (content_type == COAP_CT_APP_SENML_CBOR)
+    {
+        uint8_t  major;
+        uint8_t  info;
+        uint64_t count;
+
+        if (!cbor_head_read(p_reader, &major, &info, &count) ||
+            (major != CBOR_MAJOR_ARRAY)                      ||
+            (count > UINT32_MAX))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+
+        p_reader->indefinite = (info == CBOR_INFO_INDEFINITE);
+        p_reader->remaining  = p_reader->indefinite ? 0 : (uint32_t)count;
+    }
+#endif // LWM2M_ENABLE_SENML_CBOR
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+    if (content_type == COAP_CT_APP_SENML_JSON)
+    {
+        if (!json_char_read(p_reader, '['))
+        {
+            return (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE);
+        }
+    }
+#endif // LWM2M_ENABLE_SENML_JSON
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_senml_record_next(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record)
+{
+    NULL_PARAM_CHECK(p_reader);
+    NULL_PARAM_CHECK(p_record);
+
+    if (p_reader->ended)
+    {
+        return (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE);
+    }
+
+#if (LWM2M_ENABLE_SENML_CBOR == 1)
+    if (p_reader->content_type == COAP_CT_APP_SENML_CBOR)
+    {
+        return cbor_record_read(p_reader, p_record);
+    }
+#endif // LWM2M_ENABLE_SENML_CBOR
+#if (LWM2M_ENABLE_SENML_JSON == 1)
+    if (p_reader->content_type == COAP_CT_APP_SENML_JSON)
+    {
+        return json_record_read(p_reader, p_record);
+    }
+#endif // LWM2M_ENABLE_SENML_JSON
+
+    return (NRF_ERROR_NOT_SUPPORTED | IOT_LWM2M_ERR_BASE);
+}
+
+#endif // LWM2M_ENABLE_SENML_JSON || LWM2M_ENABLE_SENML_CBOR
@@ -0,0 +1,235 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file lwm2m_senml.h
+ *
+ * @defgroup iot_sdk_lwm2m_senml_api LWM2M SenML interface
+ * @ingroup iot_sdk_lwm2m
+ * @{
+ * @brief SenML-JSON and SenML-CBOR encoding and decoding interface for the LWM2M protocol.
+ *
+ * @details Records are written one by one straight into the payload buffer, and read one by one
+ *          from it, without building a document in memory. The first record written carries the
+ *          base name of the request path, so that the other records only name the resource, and
+ *          the resource instance, relative to it.
+ *
+ *          Each format is compiled in with LWM2M_ENABLE_SENML_JSON or LWM2M_ENABLE_SENML_CBOR.
+ */
+
+#ifndef LWM2M_SENML_H__
+#define LWM2M_SENML_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "coap_api.h"
+#include "lwm2m_api.h"
+
+/**@brief Mask of the SenML content formats compiled in, to be used with
+ *        @ref lwm2m_content_type_select. */
+#define LWM2M_SENML_CT_MASK        (((LWM2M_ENABLE_SENML_JSON == 1) ? COAP_CT_MASK_APP_SENML_JSON : 0) | \
+                                    ((LWM2M_ENABLE_SENML_CBOR == 1) ? COAP_CT_MASK_APP_SENML_CBOR : 0))
+
+#define LWM2M_SENML_MAX_PATH_LEN   4                               /**< Object, instance, resource and resource instance identifiers. */
+
+/**@brief Type of the value of a SenML record. */
+typedef enum
+{
+    LWM2M_SENML_TYPE_INTEGER,                                      /**< Numeric value without a fraction, within the range of int32_t. */
+    LWM2M_SENML_TYPE_FLOAT,                                        /**< Any other numeric value. */
+    LWM2M_SENML_TYPE_BOOLEAN,                                      /**< Boolean value. */
+    LWM2M_SENML_TYPE_STRING,                                       /**< String value. */
+    LWM2M_SENML_TYPE_OPAQUE                                        /**< Data value. */
+} lwm2m_senml_type_t;
+
+/**@brief SenML record. */
+typedef struct
+{
+    uint16_t           path[LWM2M_SENML_MAX_PATH_LEN];             /**< Absolute path of the record. */
+    uint8_t            path_len;                                   /**< Number of elements in the path. */
+    lwm2m_senml_type_t type;                                       /**< Type of the value. */
+    union
+    {
+        int32_t        integer;                                    /**< Value of LWM2M_SENML_TYPE_INTEGER. */
+        float          fp;                                         /**< Value of LWM2M_SENML_TYPE_FLOAT. */
+        bool           boolean;                                    /**< Value of LWM2M_SENML_TYPE_BOOLEAN. */
+        lwm2m_string_t string;                                     /**< Value of LWM2M_SENML_TYPE_STRING. */
+        lwm2m_opaque_t opaque;                                     /**< Value of LWM2M_SENML_TYPE_OPAQUE. */
+    } value;                                                       /**< Value of the record. */
+} lwm2m_senml_record_t;
+
+/**@brief SenML writer. Its members are internal. */
+typedef struct
+{
+    uint8_t *           p_buffer;                                  /**< Buffer to write the records into. */
+    uint32_t            buffer_len;                                /**< Size of the buffer. */
+    uint32_t            index;                                     /**< Number of bytes written, or that would have been written. */
+    uint16_t            count;                                     /**< Number of records written. */
+    coap_content_type_t content_type;                              /**< Content format written. */
+    uint16_t            base_path[LWM2M_SENML_MAX_PATH_LEN - 1];   /**< Path the records are relative to. */
+    uint8_t             base_path_len;                             /**< Number of elements in the base path. */
+    bool                base_name_slash;                           /**< Whether the base name ends with a slash. */
+} lwm2m_senml_writer_t;
+
+/**@brief SenML reader. Its members are internal. */
+typedef struct
+{
+    uint8_t *           p_buffer;                                  /**< Buffer to read the records from. */
+    uint32_t            buffer_len;                                /**< Size of the buffer. */
+    uint32_t            index;                                     /**< Index of the next byte to read. */
+    uint32_t            remaining;                                 /**< Number of records left in a CBOR array of known length. */
+    bool                indefinite;                                /**< Whether the CBOR array ends with a break. */
+    bool                first;                                     /**< Whether no record has been read yet. */
+    bool                ended;                                     /**< Whether all records have been read. */
+    coap_content_type_t content_type;                              /**< Content format read. */
+    const char *        p_base_name;                               /**< Base name in effect. */
+    uint16_t            base_name_len;                             /**< Length of the base name. */
+} lwm2m_senml_reader_t;
+
+/**@brief Start writing SenML records into a buffer.
+ *
+ * @details The payload buffer of a response can be obtained with
+ *          @ref coap_message_payload_buffer_get and set back once the writer is finished.
+ *
+ * @param[out] p_writer      Writer to initialize.
+ * @param[in]  content_type  COAP_CT_APP_SENML_JSON or COAP_CT_APP_SENML_CBOR.
+ * @param[in]  p_buffer      Buffer to write the records into. May be NULL to only compute the
+ *                           size of the records, in which case buffer_len is ignored.
+ * @param[in]  buffer_len    Size of the buffer.
+ * @param[in]  p_base_path   Path of the request the records are the content of.
+ * @param[in]  base_path_len Number of elements in the path, 0 to 3.
+ *
+ * @retval NRF_SUCCESS             If the writer was initialized.
+ * @retval NRF_ERROR_NOT_SUPPORTED If the content format is not compiled in.
+ * @retval NRF_ERROR_INVALID_PARAM If the path is too long.
+ * @retval NRF_ERROR_DATA_SIZE     If the buffer cannot even hold an empty array.
+ */
+uint32_t lwm2m_senml_writer_init(lwm2m_senml_writer_t * p_writer,
+                                 coap_content_type_t    content_type,
+                                 uint8_t *              p_buffer,
+                                 uint32_t               buffer_len,
+                                 const uint16_t *       p_base_path,
+                                 uint8_t                base_path_len);
+
+/**@brief Write a SenML record.
+ *
+ * @details Float values are written as integers when they have no fraction. In SenML-JSON they
+ *          are otherwise rounded to 7 significant digits. In SenML-CBOR they are written as half
+ *          precision floats when that is exact. Strings are expected in UTF-8.
+ *
+ * @param[inout] p_writer Writer.
+ * @param[in]    p_record Record to write. Its path must start with the base path of the writer.
+ *
+ * @retval NRF_SUCCESS             If the record was written.
+ * @retval NRF_ERROR_INVALID_PARAM If the path of the record is not within the base path, or if the
+ *                                 value is not a finite number.
+ * @retval NRF_ERROR_DATA_SIZE     If the record does not fit the buffer. The record is not
+ *                                 written, and the records written so far are kept.
+ */
+uint32_t lwm2m_senml_record_add(lwm2m_senml_writer_t * p_writer, const lwm2m_senml_record_t * p_record);
+
+/**@brief Write a SenML record with an integer value for a resource of the base path instance.
+ *
+ * @param[inout] p_writer    Writer, with a base path of an instance.
+ * @param[in]    resource_id Resource identifier.
+ * @param[in]    value       Value of the resource.
+ *
+ * @return See @ref lwm2m_senml_record_add.
+ */
+uint32_t lwm2m_senml_integer_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, int32_t value);
+
+/**@brief Write a SenML record with a float value for a resource of the base path instance.
+ *
+ * @param[inout] p_writer    Writer, with a base path of an instance.
+ * @param[in]    resource_id Resource identifier.
+ * @param[in]    value       Value of the resource.
+ *
+ * @return See @ref lwm2m_senml_record_add.
+ */
+uint32_t lwm2m_senml_float_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, float value);
+
+/**@brief Write a SenML record with a boolean value for a resource of the base path instance.
+ *
+ * @param[inout] p_writer    Writer, with a base path of an instance.
+ * @param[in]    resource_id Resource identifier.
+ * @param[in]    value       Value of the resource.
+ *
+ * @return See @ref lwm2m_senml_record_add.
+ */
+uint32_t lwm2m_senml_bool_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, bool value);
+
+/**@brief Write a SenML record with a string value for a resource of the base path instance.
+ *
+ * @param[inout] p_writer    Writer, with a base path of an instance.
+ * @param[in]    resource_id Resource identifier.
+ * @param[in]    value       Value of the resource.
+ *
+ * @return See @ref lwm2m_senml_record_add.
+ */
+uint32_t lwm2m_senml_string_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, lwm2m_string_t value);
+
+/**@brief Write a SenML record with an opaque value for a resource of the base path instance.
+ *
+ * @param[inout] p_writer    Writer, with a base path of an instance.
+ * @param[in]    resource_id Resource identifier.
+ * @param[in]    value       Value of the resource.
+ *
+ * @return See @ref lwm2m_senml_record_add.
+ */
+uint32_t lwm2m_senml_opaque_add(lwm2m_senml_writer_t * p_writer, uint16_t resource_id, lwm2m_opaque_t value);
+
+/**@brief Finish writing SenML records.
+ *
+ * @param[inout] p_writer Writer.
+ * @param[out]   p_len    Length of the encoded records. If the writer has no buffer, the length
+ *                        the encoded records would have.
+ *
+ * @retval NRF_SUCCESS If the records were closed. Room to close them is kept as they are added.
+ */
+uint32_t lwm2m_senml_writer_finish(lwm2m_senml_writer_t * p_writer, uint32_t * p_len);
+
+/**@brief Start reading SenML records from a buffer.
+ *
+ * @details SenML-JSON strings and data values are decoded in place, so the buffer is modified.
+ *
+ * @param[out] p_reader     Reader to initialize.
+ * @param[in]  content_type COAP_CT_APP_SENML_JSON or COAP_CT_APP_SENML_CBOR.
+ * @param[in]  p_buffer     Buffer holding the records, typically the payload of a request.
+ * @param[in]  buffer_len   Size of the records.
+ *
+ * @retval NRF_SUCCESS             If the reader was initialized.
+ * @retval NRF_ERROR_NOT_SUPPORTED If the content format is not compiled in.
+ * @retval NRF_ERROR_INVALID_DATA  If the buffer does not hold an array of records.
+ */
+uint32_t lwm2m_senml_reader_init(lwm2m_senml_reader_t * p_reader,
+                                 coap_content_type_t    content_type,
+                                 uint8_t *              p_buffer,
+                                 uint32_t               buffer_len);
+
+/**@brief Read the next SenML record.
+ *
+ * @details The name of the record, with the base name in effect, must be an absolute path of one
+ *          to four elements. Records without a value, and labels that must be understood, are not
+ *          supported. Other labels, such as times and units, are ignored. String and opaque values
+ *          point into the buffer.
+ *
+ * @param[inout] p_reader Reader.
+ * @param[out]   p_record Record read.
+ *
+ * @retval NRF_SUCCESS            If a record was read.
+ * @retval NRF_ERROR_NOT_FOUND    If all records have been read.
+ * @retval NRF_ERROR_INVALID_DATA If the record is malformed or not supported.
+ */
+uint32_t lwm2m_senml_record_next(lwm2m_senml_reader_t * p_reader, lwm2m_senml_record_t * p_record);
+
+#endif // LWM2M_SENML_H__
+
+/** @} */
@@ -24,6 +24,7 @@
 #define IPV6_MEDIUM_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "ipv6_medium_platform.h"
 #include "iot_defines.h"
 
@@ -32,6 +33,7 @@
 #define IPV6_MEDIUM_ID_ANY                        0x00                                              /**< Indicates invalid physical transport type. */
 #define IPV6_MEDIUM_ID_BLE                        0x01                                              /**< Indicates that the physical transport is BLE. */
 #define IPV6_MEDIUM_ID_802154                     0x02                                              /**< Indicates that the physical transport is 802.15.4. */
+#define IPV6_MEDIUM_ID_HOST                       0x03                                              /**< Indicates that the physical transport is the host loopback. */
 
 #define IPV6_MEDIUM_EVT_CONN_DOWN                 0x01                                              /**< Indicates that a connection is established. */
 #define IPV6_MEDIUM_EVT_CONN_UP                   0x02                                              /**< Indicates that a connection is torn down. */
@@ -0,0 +1,215 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ipv6_medium.h"
+#include "ipv6_medium_host.h"
+#include "ble_6lowpan_host.h"
+#include "iot_common.h"
+#include "nordic_common.h"
+
+#define NULL_PARAM_CHECK(PARAM)                                                                    \
+        if ((PARAM) == NULL)                                                                       \
+        {                                                                                          \
+            return (NRF_ERROR_NULL);                                                               \
+        }
+
+static ipv6_medium_instance_id_t   m_module_instance_id = 0x01;                                     /**< Module instance identifier. As of today, only a single instance is supported. */
+static ipv6_medium_evt_handler_t   m_ipv6_medium_evt_handler;                                       /**< Pointer to the event handler procedure of the parent layer. */
+static ipv6_medium_error_handler_t m_ipv6_medium_error_handler;                                     /**< Pointer to the error handler procedure of the parent layer. */
+static eui48_t                     m_local_eui48 = {{0x00, 0x01, 0x02, 0x03, 0x04, 0x00}};          /**< Local EUI-48, public address type. */
+static bool                        m_connectable_mode_active = false;                               /**< Indicates if the node is in connectable mode. */
+static bool                        m_connected = false;                                             /**< Indicates if a peer is connected. */
+static eui64_t                     m_peer_addr;                                                     /**< EUI-64 of the connected peer. */
+
+
+/**@brief Function for notifying the parent layer of a medium event. */
+static void evt_notify(uint8_t evt_id)
+{
+    ipv6_medium_evt_t ipv6_medium_evt;
+
+    memset(&ipv6_medium_evt, 0x00, sizeof(ipv6_medium_evt));
+    ipv6_medium_evt.ipv6_medium_instance_id.ipv6_medium_instance_id   = m_module_instance_id;
+    ipv6_medium_evt.ipv6_medium_instance_id.ipv6_medium_instance_type = IPV6_MEDIUM_ID_HOST;
+    ipv6_medium_evt.ipv6_medium_evt_id                                = evt_id;
+    ipv6_medium_evt.medium_specific.host.peer_addr                    = m_peer_addr;
+
+    m_ipv6_medium_evt_handler(&ipv6_medium_evt);
+}
+
+
+uint32_t ipv6_medium_connectable_mode_enter(ipv6_medium_instance_id_t ipv6_medium_instance_id)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_connected)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    m_connectable_mode_active = true;
+    evt_notify(IPV6_MEDIUM_EVT_CONNECTABLE_MODE_ENTER);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_connectable_mode_exit(ipv6_medium_instance_id_t ipv6_medium_instance_id)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (!m_connectable_mode_active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    m_connectable_mode_active = false;
+    evt_notify(IPV6_MEDIUM_EVT_CONNECTABLE_MODE_EXIT);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_eui48_get(ipv6_medium_instance_id_t   ipv6_medium_instance_id, \
+                               eui48_t                   * p_ipv6_medium_eui48)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(p_ipv6_medium_eui48, &m_local_eui48, sizeof(eui48_t));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_eui48_set(ipv6_medium_instance_id_t   ipv6_medium_instance_id, \
+                               eui48_t                   * p_ipv6_medium_eui48)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (p_ipv6_medium_eui48->identifier[5] != 0x00)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    memcpy(&m_local_eui48, p_ipv6_medium_eui48, sizeof(eui48_t));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_eui64_get(ipv6_medium_instance_id_t   ipv6_medium_instance_id, \
+                               eui64_t                   * p_ipv6_medium_eui64)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    IPV6_EUI64_CREATE_FROM_EUI48(p_ipv6_medium_eui64->identifier,
+                                 m_local_eui48.identifier,
+                                 BLE_GAP_ADDR_TYPE_PUBLIC);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_eui64_set(ipv6_medium_instance_id_t   ipv6_medium_instance_id, \
+                               eui64_t                   * p_ipv6_medium_eui64)
+{
+    if (ipv6_medium_instance_id != m_module_instance_id)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if ((p_ipv6_medium_eui64->identifier[0] != 0x02)  ||
+        (p_ipv6_medium_eui64->identifier[3] != 0xFF)  ||
+        (p_ipv6_medium_eui64->identifier[4] != 0xFE))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_local_eui48.identifier[0] = p_ipv6_medium_eui64->identifier[7];
+    m_local_eui48.identifier[1] = p_ipv6_medium_eui64->identifier[6];
+    m_local_eui48.identifier[2] = p_ipv6_medium_eui64->identifier[5];
+    m_local_eui48.identifier[3] = p_ipv6_medium_eui64->identifier[2];
+    m_local_eui48.identifier[4] = p_ipv6_medium_eui64->identifier[1];
+    m_local_eui48.identifier[5] = 0x00;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ipv6_medium_host_connect(const eui64_t * p_peer_addr)
+{
+    NULL_PARAM_CHECK(p_peer_addr);
+
+    if (!m_connectable_mode_active)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // As with advertising, connectable mode ends when a peer connects.
+    m_connectable_mode_active = false;
+    m_connected               = true;
+    m_peer_addr               = *p_peer_addr;
+
+    evt_notify(IPV6_MEDIUM_EVT_CONN_UP);
+
+    return ble_6lowpan_host_link_up(p_peer_addr);
+}
+
+
+uint32_t ipv6_medium_host_disconnect(void)
+{
+    if (!m_connected)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    uint32_t err_code = ble_6lowpan_host_link_down();
+
+    m_connected = false;
+    evt_notify(IPV6_MEDIUM_EVT_CONN_DOWN);
+
+    return err_code;
+}
+
+
+uint32_t ipv6_medium_init(ipv6_medium_init_params_t * p_init_param,          \
+                          ipv6_medium_type_t          desired_medium_type,   \
+                          ipv6_medium_instance_t    * p_new_medium_instance)
+{
+    NULL_PARAM_CHECK(p_init_param->ipv6_medium_evt_handler);
+    if ((desired_medium_type != IPV6_MEDIUM_ID_HOST) && (desired_medium_type != IPV6_MEDIUM_ID_ANY))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_ipv6_medium_evt_handler   = p_init_param->ipv6_medium_evt_handler;
+    m_ipv6_medium_error_handler = p_init_param->ipv6_medium_error_handler;
+    m_connectable_mode_active   = false;
+    m_connected                 = false;
+
+    UNUSED_VARIABLE(m_ipv6_medium_error_handler);
+
+    p_new_medium_instance->ipv6_medium_instance_type = IPV6_MEDIUM_ID_HOST;
+    p_new_medium_instance->ipv6_medium_instance_id   = m_module_instance_id;
+
+    return NRF_SUCCESS;
+}
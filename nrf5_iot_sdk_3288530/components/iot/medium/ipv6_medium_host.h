@@ -0,0 +1,65 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ */
+
+ /** @file
+ *
+ * @defgroup ipv6_medium_host Host IPv6 Medium Implementation
+ * @{
+ * @ingroup iot_sdk_common
+ * @brief Host loopback implementation of the IPv6 medium interface.
+ *
+ * @details Runs the IPv6 stack as a process on a host, on top of @ref ble_6lowpan_host. Entering
+ *          connectable mode only reports the mode change; the connection is established and torn
+ *          down by the application, on behalf of the simulated peer, with
+ *          @ref ipv6_medium_host_connect and @ref ipv6_medium_host_disconnect.
+ */
+
+#ifndef IPV6_MEDIUM_HOST_H__
+#define IPV6_MEDIUM_HOST_H__
+
+#include <stdint.h>
+#include "iot_defines.h"
+
+/**@brief Structure of host-specific parameters of events passed to the parent layer by the IPv6 medium. */
+typedef struct
+{
+    eui64_t peer_addr;                                                                              /**< EUI-64 of the peer, for @ref IPV6_MEDIUM_EVT_CONN_UP and @ref IPV6_MEDIUM_EVT_CONN_DOWN. */
+} ipv6_medium_host_cb_params_t;
+
+/**@brief Structure of host-specific parameters of errors passed to the parent layer by the IPv6 medium. */
+typedef struct
+{
+    uint8_t dummy_value; // Parameters to be added.
+} ipv6_medium_host_error_params_t;
+
+/**@brief Function for connecting a simulated peer to the node.
+ *
+ * @details The 6LoWPAN interface is brought up and @ref IPV6_MEDIUM_EVT_CONN_UP is notified.
+ *
+ * @param[in]    p_peer_addr    EUI-64 of the peer, typically the router.
+ *
+ * @retval       NRF_SUCCESS              If the connection was established.
+ * @retval       NRF_ERROR_INVALID_STATE  If the node is not in connectable mode.
+ */
+uint32_t ipv6_medium_host_connect(const eui64_t * p_peer_addr);
+
+/**@brief Function for disconnecting the simulated peer.
+ *
+ * @details The 6LoWPAN interface is brought down and @ref IPV6_MEDIUM_EVT_CONN_DOWN is notified.
+ *
+ * @retval       NRF_SUCCESS              If the connection was torn down.
+ * @retval       NRF_ERROR_INVALID_STATE  If no peer is connected.
+ */
+uint32_t ipv6_medium_host_disconnect(void);
+
+#endif // IPV6_MEDIUM_HOST_H__
+
+/** @} */
@@ -71,11 +71,20 @@ void client_init(mqtt_client_t * const p_client)
     p_client->p_pending_packet     = NULL;
     p_client->pending_packetlen    = 0;
     p_client->p_security_settings  = NULL;
+    p_client->tx_ring_read         = 0;
+    p_client->tx_ring_len          = 0;
+
+    memset(p_client->inflight, 0, sizeof(p_client->inflight));
 
     // Free memory used for TX packets and reset the pointer.
     nrf_free(p_client->p_packet);
     p_client->p_packet = NULL;
 
+    nrf_free(p_client->p_tx_ring);
+    p_client->p_tx_ring = NULL;
+
+    mqtt_rx_decoder_reset(p_client);
+
     // Free TLS instance and reset the instance.
     UNUSED_VARIABLE(nrf_tls_free(&p_client->tls_instance));
     NRF_TLS_INTSANCE_INIT(&p_client->tls_instance);
@@ -121,6 +130,112 @@ void notify_disconnection(mqtt_client_t * p_client, uint32_t result)
 }
 
 
+/**@brief Frees the entry of a publish message in flight, if any. */
+static void inflight_remove(mqtt_client_t * const p_client, uint16_t message_id)
+{
+    for (uint32_t index = 0; index < MQTT_MAX_INFLIGHT; index++)
+    {
+        if ((p_client->inflight[index].state != MQTT_INFLIGHT_FREE) &&
+            (p_client->inflight[index].message_id == message_id))
+        {
+            p_client->inflight[index].state = MQTT_INFLIGHT_FREE;
+            break;
+        }
+    }
+}
+
+
+uint32_t mqtt_inflight_add(mqtt_client_t * p_client,
+                           uint16_t        message_id,
+                           uint8_t         qos,
+                           uint8_t         dup_flag)
+{
+    mqtt_inflight_t * p_free = NULL;
+    uint16_t          count  = 1;
+
+    for (uint32_t index = 0; index < MQTT_MAX_INFLIGHT; index++)
+    {
+        mqtt_inflight_t * p_entry = &p_client->inflight[index];
+
+        if (p_entry->state == MQTT_INFLIGHT_FREE)
+        {
+            if (p_free == NULL)
+            {
+                p_free = p_entry;
+            }
+        }
+        else if (p_entry->message_id == message_id)
+        {
+            // A retransmission keeps its entry, anything else reuses an id still in use.
+            return dup_flag ? NRF_SUCCESS : (NRF_ERROR_INVALID_PARAM | IOT_MQTT_ERR_BASE);
+        }
+        else
+        {
+            count++;
+        }
+    }
+
+    if (p_free == NULL)
+    {
+        return (NRF_ERROR_NO_MEM | IOT_MQTT_ERR_BASE);
+    }
+
+    p_free->message_id = message_id;
+    p_free->state      = (qos == MQTT_QoS_1_ATLEAST_ONCE) ? MQTT_INFLIGHT_PUBACK :
+                                                            MQTT_INFLIGHT_PUBREC;
+
+    if (count > p_client->stats.inflight_peak)
+    {
+        p_client->stats.inflight_peak = count;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t mqtt_inflight_ack(mqtt_client_t * p_client, uint8_t pkt_type, uint16_t message_id)
+{
+    uint8_t awaited;
+
+    switch (pkt_type)
+    {
+        case MQTT_PKT_TYPE_PUBACK:
+            awaited = MQTT_INFLIGHT_PUBACK;
+            break;
+        case MQTT_PKT_TYPE_PUBREC:
+            awaited = MQTT_INFLIGHT_PUBREC;
+            break;
+        case MQTT_PKT_TYPE_PUBCOMP:
+            awaited = MQTT_INFLIGHT_PUBCOMP;
+            break;
+        default:
+            return (NRF_ERROR_NOT_FOUND | IOT_MQTT_ERR_BASE);
+    }
+
+    for (uint32_t index = 0; index < MQTT_MAX_INFLIGHT; index++)
+    {
+        mqtt_inflight_t * p_entry = &p_client->inflight[index];
+
+        if ((p_entry->state == awaited) && (p_entry->message_id == message_id))
+        {
+            if (awaited == MQTT_INFLIGHT_PUBREC)
+            {
+                // Released by the application with mqtt_publish_release, completed by PUBCOMP.
+                p_entry->state = MQTT_INFLIGHT_PUBCOMP;
+            }
+            else
+            {
+                p_entry->state = MQTT_INFLIGHT_FREE;
+                p_client->stats.publish_completed++;
+            }
+            return NRF_SUCCESS;
+        }
+    }
+
+    return (NRF_ERROR_NOT_FOUND | IOT_MQTT_ERR_BASE);
+}
+
+
 uint32_t mqtt_init(void)
 {
     SDK_MUTEX_INIT(m_mqtt_mutex);
@@ -166,17 +281,32 @@ uint32_t mqtt_connect(mqtt_client_t * const p_client)
              m_mqtt_client[client_index] = p_client;
 
              // Allocate buffer packts in TX path.
-             p_client->p_packet = nrf_malloc(MQTT_MAX_PACKET_LENGTH);
+             p_client->p_packet  = nrf_malloc_tagged(MQTT_MAX_PACKET_LENGTH, NRF_MEM_TAG_MQTT);
+             p_client->p_tx_ring = nrf_malloc_tagged(MQTT_TX_RING_SIZE, NRF_MEM_TAG_MQTT);
              break;
          }
     }
 
-    if ((client_index == MQTT_MAX_CLIENTS) || (p_client->p_packet == NULL))
+    if (client_index == MQTT_MAX_CLIENTS)
     {
         err_code = (NRF_ERROR_NO_MEM | IOT_MQTT_ERR_BASE);
     }
+    else if ((p_client->p_packet == NULL) || (p_client->p_tx_ring == NULL))
+    {
+        m_mqtt_client[client_index] = NULL;
+        nrf_free(p_client->p_packet);
+        nrf_free(p_client->p_tx_ring);
+        p_client->p_packet  = NULL;
+        p_client->p_tx_ring = NULL;
+        err_code = (NRF_ERROR_NO_MEM | IOT_MQTT_ERR_BASE);
+    }
     else
     {
+        p_client->tx_ring_read = 0;
+        p_client->tx_ring_len  = 0;
+        memset(p_client->inflight, 0, sizeof(p_client->inflight));
+        memset(&p_client->stats, 0, sizeof(p_client->stats));
+
         err_code = tcp_request_connection(p_client);
 
         if(err_code != NRF_SUCCESS)
@@ -184,6 +314,9 @@ uint32_t mqtt_connect(mqtt_client_t * const p_client)
             // Free the instance.
             m_mqtt_client[client_index] = NULL;
             nrf_free(p_client->p_packet);
+            nrf_free(p_client->p_tx_ring);
+            p_client->p_packet  = NULL;
+            p_client->p_tx_ring = NULL;
             err_code = MQTT_ERR_TCP_PROC_FAILED;
         }
     }
@@ -218,11 +351,7 @@ uint32_t mqtt_publish(mqtt_client_t               * const p_client,
 
     p_payload = &p_client->p_packet[MQTT_FIXED_HEADER_EXTENDED_SIZE];
 
-    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
-    {
-        err_code = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
-    }
-    else if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
+    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
         memset(p_payload, 0, MQTT_MAX_PACKET_LENGTH);
 
@@ -252,10 +381,18 @@ uint32_t mqtt_publish(mqtt_client_t               * const p_client,
         }
 
 
+        if ((err_code == NRF_SUCCESS) && (p_param->message.topic.qos != MQTT_QoS_0_AT_MOST_ONCE))
+        {
+            err_code = mqtt_inflight_add(p_client,
+                                         p_param->message_id,
+                                         p_param->message.topic.qos,
+                                         p_param->dup_flag);
+        }
+
         if (err_code == NRF_SUCCESS)
         {
             const uint8_t message_type = MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBLISH,
-                                                               0,  // Duplicate flag not set.
+                                                               p_param->dup_flag,
                                                                p_param->message.topic.qos,
                                                                0); // Retain flag not set.
 
@@ -266,6 +403,13 @@ uint32_t mqtt_publish(mqtt_client_t               * const p_client,
 
             //Publish message
             err_code = transport_fn[p_client->transport_type].write(p_client, p_payload, mqtt_packetlen);
+
+            if ((err_code != NRF_SUCCESS) &&
+                (p_param->message.topic.qos != MQTT_QoS_0_AT_MOST_ONCE) &&
+                (p_param->dup_flag == 0))
+            {
+                inflight_remove(p_client, p_param->message_id);
+            }
         }
     }
     else
@@ -281,53 +425,43 @@ uint32_t mqtt_publish(mqtt_client_t               * const p_client,
     return err_code;
 }
 
-uint32_t mqtt_publish_ack(mqtt_client_t               * const p_client,
-                          uint16_t                            message_id)
+/**@brief Encodes and sends a packet carrying only a message id, such as the acknowledgements. */
+static uint32_t message_id_packet_send(mqtt_client_t * const p_client,
+                                       uint8_t               message_type,
+                                       uint16_t              message_id)
 {
     uint32_t      err_code       = MQTT_ERR_NOT_CONNECTED;
     uint32_t      offset         = 0;
     uint32_t      mqtt_packetlen = 0;
     uint8_t     * p_payload;
-    
-    NULL_PARAM_CHECK(p_client);
 
-    MQTT_TRC("[MQTT]:[CID %p]:[State 0x%02x]: >> mqtt_publish_ack Message id 0x%04x\r\n",
+    MQTT_TRC("[MQTT]:[CID %p]:[State 0x%02x]: >> message_id_packet_send Type 0x%02x "
+             "Message id 0x%04x\r\n",
              (p_client),
               p_client->state,
+              message_type,
               message_id);
 
     MQTT_MUTEX_LOCK();
 
     p_payload = &p_client->p_packet[MQTT_FIXED_HEADER_EXTENDED_SIZE];
 
-    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
+    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
-        err_code = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
-    }
-    else if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
-    {
-        memset(p_payload, 0, MQTT_MAX_PACKET_LENGTH);
-
         err_code = pack_uint16(message_id, MQTT_MAX_VARIABLE_HEADER_N_PAYLOAD, p_payload, &offset);
         if (err_code == NRF_SUCCESS)
         {
-            const uint8_t message_type = MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBACK,
-                                                               0,  // Duplicate flag not set.
-                                                               0,  // QoS unused.
-                                                               0); // Retain flag not set.
-
             mqtt_packetlen = mqtt_encode_fixed_header(message_type, // Message type
                                                       offset,       // Payload size without the fixed header
                                                       &p_payload);  // Address where the p_payload is contained.
 
-            //Publish message
             err_code = transport_fn[p_client->transport_type].write(p_client,
                                                                     p_payload,
                                                                     mqtt_packetlen);
         }
     }
 
-    MQTT_TRC("[MQTT]:[CID %p]:[State 0x%02x]: << mqtt_publish_ack result 0x%08x\r\n",
+    MQTT_TRC("[MQTT]:[CID %p]:[State 0x%02x]: << message_id_packet_send result 0x%08x\r\n",
              (p_client),
               p_client->state,
               err_code);
@@ -338,6 +472,53 @@ uint32_t mqtt_publish_ack(mqtt_client_t               * const p_client,
 }
 
 
+uint32_t mqtt_publish_ack(mqtt_client_t               * const p_client,
+                          uint16_t                            message_id)
+{
+    NULL_PARAM_CHECK(p_client);
+
+    return message_id_packet_send(p_client,
+                                  MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBACK, 0, 0, 0),
+                                  message_id);
+}
+
+
+uint32_t mqtt_publish_receive(mqtt_client_t               * const p_client,
+                              uint16_t                            message_id)
+{
+    NULL_PARAM_CHECK(p_client);
+
+    return message_id_packet_send(p_client,
+                                  MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBREC, 0, 0, 0),
+                                  message_id);
+}
+
+
+uint32_t mqtt_publish_release(mqtt_client_t               * const p_client,
+                              uint16_t                            message_id)
+{
+    NULL_PARAM_CHECK(p_client);
+
+    return message_id_packet_send(p_client,
+                                  MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBREL,
+                                                        0,
+                                                        MQTT_QoS_1_ATLEAST_ONCE,
+                                                        0),
+                                  message_id);
+}
+
+
+uint32_t mqtt_publish_complete(mqtt_client_t               * const p_client,
+                               uint16_t                            message_id)
+{
+    NULL_PARAM_CHECK(p_client);
+
+    return message_id_packet_send(p_client,
+                                  MQTT_MESSAGES_OPTIONS(MQTT_PKT_TYPE_PUBCOMP, 0, 0, 0),
+                                  message_id);
+}
+
+
 uint32_t mqtt_disconnect(mqtt_client_t * const p_client)
 {
     uint32_t   err_code = MQTT_ERR_NOT_CONNECTED;
@@ -379,11 +560,7 @@ uint32_t mqtt_subscribe(mqtt_client_t                  * const p_client,
 
     p_payload = &p_client->p_packet[MQTT_FIXED_HEADER_EXTENDED_SIZE];
 
-    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
-    {
-        err_code = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
-    }
-    else if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
+    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
         memset(p_payload, 0, MQTT_MAX_PACKET_LENGTH);
 
@@ -453,11 +630,7 @@ uint32_t mqtt_unsubscribe(mqtt_client_t                  * const p_client,
 
     p_payload = &p_client->p_packet[MQTT_FIXED_HEADER_EXTENDED_SIZE];
 
-    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
-    {
-        err_code = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
-    }
-    else if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
+    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
         memset(p_payload, 0, MQTT_MAX_PACKET_LENGTH);
 
@@ -511,11 +684,7 @@ uint32_t mqtt_ping(mqtt_client_t * const p_client)
     
     MQTT_MUTEX_LOCK();
 
-    if(MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
-    {
-        err_code = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
-    }
-    else if(MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
+    if(MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
         // Ping
         err_code = transport_fn[p_client->transport_type].write(p_client,
@@ -548,6 +717,22 @@ uint32_t mqtt_abort(mqtt_client_t * const p_client)
     return NRF_SUCCESS;
 }
 
+uint32_t mqtt_client_stats_get(mqtt_client_t       const * const p_client,
+                               mqtt_client_stats_t       * const p_stats)
+{
+    NULL_PARAM_CHECK(p_client);
+    NULL_PARAM_CHECK(p_stats);
+
+    MQTT_MUTEX_LOCK();
+
+    memcpy(p_stats, &p_client->stats, sizeof(mqtt_client_stats_t));
+
+    MQTT_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
 uint32_t mqtt_live(void)
 {
     iot_timer_time_in_ms_t elapsed_time;
@@ -566,6 +751,9 @@ uint32_t mqtt_live(void)
             UNUSED_VARIABLE(iot_timer_wall_clock_delta_get(&p_client->last_activity,
                                                            &elapsed_time));
 
+            // Push out anything queued while the TCP send buffer was full.
+            mqtt_client_tcp_flush(p_client);
+
             if (elapsed_time > ((MQTT_KEEPALIVE - 2)* 1000))
             {
                 UNUSED_VARIABLE(mqtt_ping(p_client));
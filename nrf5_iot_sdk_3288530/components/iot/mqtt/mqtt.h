@@ -36,6 +36,10 @@
 #include "nrf_tls.h"
 
 
+#ifndef MQTT_MAX_INFLIGHT
+#define MQTT_MAX_INFLIGHT         4                                            /**< Maximum number of QoS 1 and QoS 2 publish messages awaiting acknowledgement per client. */
+#endif // MQTT_MAX_INFLIGHT
+
 /**@brief MQTT Asynchronous Events notified to the application from the module
  *        through the callback registered by the application. */
 typedef enum
@@ -133,13 +137,20 @@ typedef struct
     uint16_t                message_id;                                        /**< Message id used to identify subscription request. */
 } mqtt_subscription_list_t;
 
+/**@brief Parameters accompanying acknowledgement events. */
+typedef struct
+{
+    uint16_t                 message_id;                                       /**< Message id of the request being acknowledged. */
+} mqtt_ack_param_t;
+
 /**
  * @brief Defines event parameters notified along with asynchronous events to the application.
- *        Currently, only MQTT_EVT_PUBLISH is accompanied with parameters.
+ *        MQTT_EVT_PUBLISH and the acknowledgement events are accompanied with parameters.
  */
 typedef union
 {
     mqtt_publish_param_t  pub_message;                                          /**< Parameters accompanying MQTT_EVT_PUBLISH event. */
+    mqtt_ack_param_t      ack;                                                  /**< Parameters accompanying MQTT_EVT_PUBLISH_ACK, MQTT_EVT_PUBLISH_REC, MQTT_EVT_PUBLISH_REL, MQTT_EVT_PUBLISH_COMP, MQTT_EVT_SUBSCRIBE_ACK and MQTT_EVT_UNSUBSCRIBE_ACK events. */
 } mqtt_evt_param_t;
 
 /**@brief Defined MQTT asynchronous event notified to the application. */
@@ -158,6 +169,40 @@ typedef struct
  */
 typedef void (*mqtt_evt_cb_t)(mqtt_client_t * const p_client, const mqtt_evt_t * p_evt);
 
+/**@brief Publish message awaiting acknowledgement from the broker. */
+typedef struct
+{
+    uint16_t                 message_id;                                       /**< Message id of the publish message. */
+    uint8_t                  state;                                            /**< Acknowledgement awaited for the message. Free when zero. */
+} mqtt_inflight_t;
+
+/**@brief Transmission statistics of a client. Counters are reset on @ref mqtt_connect. */
+typedef struct
+{
+    uint32_t                 tx_packets;                                       /**< Number of MQTT packets queued for transmission. */
+    uint32_t                 tx_bytes;                                         /**< Number of bytes handed to the TCP stack. */
+    uint32_t                 tx_acked_bytes;                                   /**< Number of bytes acknowledged by the peer TCP stack. */
+    uint32_t                 tx_ring_full;                                     /**< Number of packets rejected because the transmit ring had no room. */
+    uint32_t                 publish_completed;                                /**< Number of QoS 1 and QoS 2 publish messages fully acknowledged. */
+    uint32_t                 rx_bytes;                                         /**< Number of bytes received from the transport. */
+    uint32_t                 rx_packets;                                       /**< Number of MQTT packets decoded. */
+    uint32_t                 rx_reassembled;                                   /**< Number of MQTT packets received across several segments and copied to be decoded. */
+    uint32_t                 rx_dropped;                                       /**< Number of MQTT packets dropped for lack of memory to reassemble them, or malformed. */
+    uint16_t                 tx_ring_peak;                                     /**< Highest number of bytes held in the transmit ring. */
+    uint16_t                 inflight_peak;                                    /**< Highest number of publish messages awaiting acknowledgement. */
+} mqtt_client_stats_t;
+
+/**@brief State of the incremental decoder of packets received on the transport. */
+typedef struct
+{
+    uint8_t                * p_buffer;                                         /**< Reassembly buffer for a packet spanning several segments. NULL if no packet is being reassembled. */
+    uint32_t                 length;                                           /**< Total length, including the fixed header, of the packet being reassembled. */
+    uint32_t                 offset;                                           /**< Number of bytes of the packet being reassembled received so far. */
+    uint32_t                 discard;                                          /**< Number of bytes still to be skipped of a packet being dropped. */
+    uint8_t                  header[5];                                        /**< Fixed header bytes received so far of a packet split within its fixed header. */
+    uint8_t                  header_len;                                       /**< Number of bytes in header. */
+} mqtt_rx_decoder_t;
+
 /**@brief MQTT Client definition to maintain information relevant to the client. */
 struct mqtt_client_t
 {
@@ -181,6 +226,12 @@ struct mqtt_client_t
     uint8_t                * p_pending_packet;                                 /**< Internal. Shall not be touched by the application. */
     nrf_tls_instance_t       tls_instance;                                     /**< Internal. Shall not be touched by the application. TLS instance identifier. Valid only if transport is a secure one. */
     uint32_t                 pending_packetlen;                                /**< Internal. Shall not be touched by the application. */
+    uint8_t                * p_tx_ring;                                        /**< Internal. Shall not be touched by the application. Ring of encoded packets waiting for room in the TCP send buffer. */
+    uint16_t                 tx_ring_read;                                     /**< Internal. Shall not be touched by the application. Read index in the transmit ring. */
+    uint16_t                 tx_ring_len;                                      /**< Internal. Shall not be touched by the application. Number of bytes held in the transmit ring. */
+    mqtt_inflight_t          inflight[MQTT_MAX_INFLIGHT];                      /**< Internal. Shall not be touched by the application. Publish messages awaiting acknowledgement. */
+    mqtt_client_stats_t      stats;                                            /**< Internal. Shall not be touched by the application. Use @ref mqtt_client_stats_get. */
+    mqtt_rx_decoder_t        rx;                                               /**< Internal. Shall not be touched by the application. Decoder state of the receive path. */
 };
 
 
@@ -226,6 +277,8 @@ void mqtt_client_init(mqtt_client_t * const p_client);
  * @note Please define MQTT_KEEPALIVE time to override default of 1 minute.
  * @note Please define MQTT_MAX_PACKET_LENGTH time to override default of 128 bytes.
  *       Ensure the system has enough memory for the new length per client.
+ * @note Please define MQTT_TX_RING_SIZE to override default of 512 bytes of encoded packets
+ *       queued per client while the TCP send buffer is full.
  */
 uint32_t mqtt_connect(mqtt_client_t * const p_client);
 
@@ -240,6 +293,12 @@ uint32_t mqtt_connect(mqtt_client_t * const p_client);
  *
  * @retval NRF_SUCCESS or an error code indicating reason for failure.
  *
+ * @note Several publish messages may be outstanding at a time. The packet is queued on the client
+ *       and written as room becomes available in the TCP send buffer. NRF_ERROR_BUSY is returned
+ *       only when the transmit ring of the client is full.
+ * @note For QoS 1 and QoS 2, the message id shall be unique among the messages still awaiting
+ *       acknowledgement, and at most MQTT_MAX_INFLIGHT messages may await acknowledgement.
+ *       Messages with the duplicate flag set reuse the entry of the message being retransmitted.
  * @note Default protocol revision used for connection request is 3.1.0.
  *       Please define MQTT_3_1_1 to use protocol 3.1.1.
  */
@@ -366,6 +425,18 @@ uint32_t mqtt_abort(mqtt_client_t * const p_client);
 uint32_t mqtt_disconnect(mqtt_client_t * const p_client);
 
 
+/**
+ * @brief API to fetch transmission statistics of a client.
+ *
+ * @param[in]  p_client  Identifies client instance for which procedure is requested.
+ * @param[out] p_stats   Memory where the statistics are copied. Shall not be NULL.
+ *
+ * @retval NRF_SUCCESS or an error code indicating reason for failure.
+ */
+uint32_t mqtt_client_stats_get(mqtt_client_t       const * const p_client,
+                               mqtt_client_stats_t       * const p_stats);
+
+
 /**
  * @brief This API should be called periodically for the module to be able to keep the connection
  *        alive by sending Ping Requests if need be.
@@ -16,6 +16,7 @@
  */
 
 #include "mqtt_internal.h"
+#include "mem_manager.h"
 
 
 uint32_t unpack_uint8(uint8_t    * p_val,
@@ -190,3 +191,211 @@ void packet_length_decode(uint8_t * p_buff, uint32_t * p_remaining_length, uint3
 
     MQTT_TRC("[MQTT]: packet_length_decode: RL:0x%08x RLS:0x%08x\r\n", remaining_length, index);
 }
+
+
+uint32_t fixed_header_decode(uint8_t  const * p_buffer,
+                             uint32_t         buffer_len,
+                             uint32_t       * p_remaining_length,
+                             uint32_t       * p_header_len)
+{
+    uint32_t remaining_length = 0;
+    uint32_t multiplier       = 1;
+
+    // Packet type and flags are followed by one to four bytes of remaining length.
+    for (uint32_t index = 1; index < MQTT_FIXED_HEADER_EXTENDED_SIZE; index++)
+    {
+        if (index >= buffer_len)
+        {
+            return NRF_ERROR_DATA_SIZE;
+        }
+
+        remaining_length += (p_buffer[index] & 0x7F) * multiplier;
+        multiplier       *= 0x80;
+
+        if ((p_buffer[index] & 0x80) == 0)
+        {
+            *p_remaining_length = remaining_length;
+            *p_header_len       = index + 1;
+
+            return NRF_SUCCESS;
+        }
+    }
+
+    return NRF_ERROR_INVALID_DATA;
+}
+
+
+void mqtt_rx_decoder_reset(mqtt_client_t * p_client)
+{
+    nrf_free(p_client->rx.p_buffer);
+    memset(&p_client->rx, 0, sizeof(mqtt_rx_decoder_t));
+}
+
+
+/**@brief Hands a complete packet to the packet handler.
+ *
+ * @retval true if decoding may continue, false if the client was disconnected while handling
+ *         the packet.
+ */
+static bool rx_packet_dispatch(mqtt_client_t * p_client, uint8_t * p_packet, uint32_t length)
+{
+    p_client->stats.rx_packets++;
+
+    UNUSED_VARIABLE(mqtt_handle_rx_data(p_client, p_packet, length));
+
+    return (p_client->state != MQTT_STATE_IDLE);
+}
+
+
+/**@brief Starts reassembly of a packet whose fixed header has been received.
+ *
+ * @details The packet is dropped if no buffer large enough can be allocated for it.
+ */
+static void rx_reassembly_start(mqtt_client_t * p_client,
+                                uint8_t const * p_header,
+                                uint32_t        header_len,
+                                uint32_t        remaining_length)
+{
+    mqtt_rx_decoder_t * p_rx = &p_client->rx;
+
+    p_rx->p_buffer = nrf_malloc_tagged(header_len + remaining_length, NRF_MEM_TAG_MQTT);
+
+    if (p_rx->p_buffer != NULL)
+    {
+        memcpy(p_rx->p_buffer, p_header, header_len);
+        p_rx->length = header_len + remaining_length;
+        p_rx->offset = header_len;
+        p_client->stats.rx_reassembled++;
+    }
+    else
+    {
+        MQTT_TRC("[MQTT]: No memory to reassemble packet of length 0x%08x, dropped.\r\n",
+                 header_len + remaining_length);
+        p_rx->discard = remaining_length;
+        p_client->stats.rx_dropped++;
+    }
+}
+
+
+uint32_t mqtt_rx_decode(mqtt_client_t * p_client, uint8_t * p_data, uint32_t datalen)
+{
+    mqtt_rx_decoder_t * p_rx   = &p_client->rx;
+    uint32_t            offset = 0;
+    uint32_t            remaining_length;
+    uint32_t            header_len;
+    uint32_t            err_code;
+
+    p_client->stats.rx_bytes += datalen;
+
+    while (offset < datalen)
+    {
+        const uint32_t available = datalen - offset;
+
+        if (p_rx->discard != 0)
+        {
+            const uint32_t chunk = MIN(available, p_rx->discard);
+
+            p_rx->discard -= chunk;
+            offset        += chunk;
+        }
+        else if (p_rx->p_buffer != NULL)
+        {
+            const uint32_t chunk = MIN(available, p_rx->length - p_rx->offset);
+
+            memcpy(&p_rx->p_buffer[p_rx->offset], &p_data[offset], chunk);
+            p_rx->offset += chunk;
+            offset       += chunk;
+
+            if (p_rx->offset == p_rx->length)
+            {
+                // Detach the buffer first, the client may be freed while handling the packet.
+                uint8_t * p_packet = p_rx->p_buffer;
+                p_rx->p_buffer     = NULL;
+
+                const bool proceed = rx_packet_dispatch(p_client, p_packet, p_rx->length);
+
+                nrf_free(p_packet);
+
+                if (!proceed)
+                {
+                    break;
+                }
+            }
+        }
+        else if (p_rx->header_len == 0)
+        {
+            err_code = fixed_header_decode(&p_data[offset], available, &remaining_length, &header_len);
+
+            if ((err_code == NRF_SUCCESS) && (remaining_length <= (available - header_len)))
+            {
+                // Whole packet present, decode it in place.
+                const uint32_t length = header_len + remaining_length;
+
+                offset += length;
+
+                if (!rx_packet_dispatch(p_client, &p_data[offset - length], length))
+                {
+                    break;
+                }
+            }
+            else if (err_code == NRF_SUCCESS)
+            {
+                rx_reassembly_start(p_client, &p_data[offset], header_len, remaining_length);
+                offset += header_len;
+            }
+            else if (err_code == NRF_ERROR_DATA_SIZE)
+            {
+                // Segment ends within the fixed header.
+                memcpy(p_rx->header, &p_data[offset], available);
+                p_rx->header_len = available;
+                offset          += available;
+            }
+            else
+            {
+                break;
+            }
+        }
+        else
+        {
+            // Complete a fixed header split across segments, one byte at a time.
+            p_rx->header[p_rx->header_len++] = p_data[offset++];
+
+            err_code = fixed_header_decode(p_rx->header,
+                                           p_rx->header_len,
+                                           &remaining_length,
+                                           &header_len);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                p_rx->header_len = 0;
+
+                if (remaining_length == 0)
+                {
+                    if (!rx_packet_dispatch(p_client, p_rx->header, header_len))
+                    {
+                        break;
+                    }
+                }
+                else
+                {
+                    rx_reassembly_start(p_client, p_rx->header, header_len, remaining_length);
+                }
+            }
+            else if (err_code != NRF_ERROR_DATA_SIZE)
+            {
+                break;
+            }
+        }
+    }
+
+    if ((offset < datalen) && (p_client->state != MQTT_STATE_IDLE))
+    {
+        MQTT_TRC("[MQTT]: Malformed fixed header, framing lost.\r\n");
+        p_client->stats.rx_dropped++;
+        mqtt_rx_decoder_reset(p_client);
+
+        return (NRF_ERROR_INVALID_DATA | IOT_MQTT_ERR_BASE);
+    }
+
+    return NRF_SUCCESS;
+}
@@ -19,6 +19,7 @@
 #define MQTT_INTERNAL_H_
 
 #include "nordic_common.h"
+#include "sdk_common.h"
 #include "mqtt.h"
 #include "iot_errors.h"
 #include "nrf_tls.h"
@@ -44,6 +45,14 @@
 #define MQTT_MAX_PACKET_LENGTH    128                                          /**< Maximum MQTT packet size that can be sent (including the fixed and variable header). */
 #endif // MQTT_MAX_PACKET_LENGTH
 
+#ifndef MQTT_TX_RING_SIZE
+#define MQTT_TX_RING_SIZE         512                                          /**< Size of the per client ring holding encoded packets until there is room in the TCP send buffer. */
+#endif // MQTT_TX_RING_SIZE
+
+#if (MQTT_TX_RING_SIZE < MQTT_MAX_PACKET_LENGTH) || (MQTT_TX_RING_SIZE > 0xFFFF)
+#error "MQTT_TX_RING_SIZE shall hold at least one packet of MQTT_MAX_PACKET_LENGTH and not exceed 0xFFFF."
+#endif
+
 #define MQTT_FIXED_HEADER_SIZE              2                                  /**< Fixed header minimum size. Remaining length size is 1 in this case. */
 #define MQTT_FIXED_HEADER_EXTENDED_SIZE     5                                  /**< Maxium size of the fixed header.  Remaining length size is 4 in this case. */
 
@@ -160,9 +169,18 @@ typedef enum
     MQTT_STATE_TCP_CONNECTING = 0x00000001,                                    /**< TCP Connection has been requested, awaiting result of the request. */
     MQTT_STATE_TCP_CONNECTED  = 0x00000002,                                    /**< TCP Connection successfully established. */
     MQTT_STATE_CONNECTED      = 0x00000004,                                    /**< MQTT Connection successful. */
-    MQTT_STATE_PENDING_WRITE  = 0x00000008                                     /**< State that indicates write callback is awaited for an issued request. */
+    MQTT_STATE_PENDING_WRITE  = 0x00000008                                     /**< State that indicates the transmit ring holds data not yet handed to TCP. */
 } mqtt_state_t;
 
+/**@brief Acknowledgement awaited for a publish message in flight. */
+typedef enum
+{
+    MQTT_INFLIGHT_FREE        = 0x00,                                          /**< Entry is unused. */
+    MQTT_INFLIGHT_PUBACK      = 0x01,                                          /**< QoS 1 message awaiting PUBACK. */
+    MQTT_INFLIGHT_PUBREC      = 0x02,                                          /**< QoS 2 message awaiting PUBREC. */
+    MQTT_INFLIGHT_PUBCOMP     = 0x03                                           /**< QoS 2 message released, awaiting PUBCOMP. */
+} mqtt_inflight_state_t;
+
 /**@brief Transport for handling transport connect procedure. */
 typedef uint32_t (*transport_connect_handler_t)(mqtt_client_t * p_client);
 
@@ -207,6 +225,13 @@ uint32_t mqtt_client_tcp_connect(mqtt_client_t * p_client);
 uint32_t mqtt_client_tcp_write(mqtt_client_t * p_client, uint8_t const * p_data, uint32_t datalen);
 
 
+/**@brief Writes as much of the transmit ring as fits in the TCP send buffer.
+ *
+ * @param[in] p_client Idenitifies the client on which the procedure is requested.
+ */
+void mqtt_client_tcp_flush(mqtt_client_t * p_client);
+
+
 /**@brief Handles read requests on TCP(non-secure) transport.
  *
  * @param[in] p_client Idenitifies the client on which the procedure is requested.
@@ -485,12 +510,53 @@ void packet_length_decode(uint8_t * p_buffer, uint32_t * p_remaining_length, uin
 uint32_t mqtt_encode_fixed_header(uint8_t message_type, uint32_t length, uint8_t ** pp_packet);
 
 
+/**@brief Decodes the fixed header of a packet, if the buffer holds all of it.
+ *
+ * @param[in]  p_buffer           Buffer starting with the fixed header.
+ * @param[in]  buffer_len         Number of bytes available in the buffer.
+ * @param[out] p_remaining_length Length of variable header and payload in the MQTT message.
+ * @param[out] p_header_len       Length of the fixed header.
+ *
+ * @retval NRF_SUCCESS            if the fixed header was decoded.
+ * @retval NRF_ERROR_DATA_SIZE    if the buffer ends within the fixed header.
+ * @retval NRF_ERROR_INVALID_DATA if the remaining length is encoded on more than four bytes.
+ */
+uint32_t fixed_header_decode(uint8_t  const * p_buffer,
+                             uint32_t         buffer_len,
+                             uint32_t       * p_remaining_length,
+                             uint32_t       * p_header_len);
+
+
+/**@brief Feeds data received on the transport to the incremental packet decoder.
+ *
+ * @details Data may end anywhere within a packet and hold several packets. Every complete packet
+ *          is handed to @ref mqtt_handle_rx_data. Packets held entirely in the data are decoded in
+ *          place, only packets spanning several calls are copied to a reassembly buffer.
+ *
+ * @param[in] p_client Identifies the client for which the data was received.
+ * @param[in] p_data   Data received. For TLS, the decrypted application data.
+ * @param[in] datalen  Length of data received.
+ *
+ * @retval NRF_SUCCESS            if the data was consumed.
+ * @retval NRF_ERROR_INVALID_DATA if a malformed fixed header was received. Framing of the stream
+ *                                is lost and the connection shall be closed.
+ */
+uint32_t mqtt_rx_decode(mqtt_client_t * p_client, uint8_t * p_data, uint32_t datalen);
+
+
+/**@brief Resets the incremental packet decoder, freeing any packet being reassembled.
+ *
+ * @param[in] p_client Identifies the client for which the procedure is requested.
+ */
+void mqtt_rx_decoder_reset(mqtt_client_t * p_client);
+
+
 /**@brief Handles MQTT messages received from the peer. For TLS, this routine is evoked to handle
  *        decrypted application data. For TCP, this routine is evoked to handle TCP data.
  *
  * @param[in]    p_client     Identifies the client for which the data was received.
- * @param[in]    p_data       MQTT data received.
- * @param[inout] datalen      Length of data received.
+ * @param[in]    p_data       One complete MQTT packet, starting with its fixed header.
+ * @param[inout] datalen      Length of the packet.
  *
  * @retval NRF_SUCCESS if the procedure is successul, else an error code indicating the reason
  *                     for failure.
@@ -498,6 +564,14 @@ uint32_t mqtt_encode_fixed_header(uint8_t message_type, uint32_t length, uint8_t
 uint32_t mqtt_handle_rx_data(mqtt_client_t * p_client, uint8_t * p_data, uint32_t datalen);
 
 
+/**@brief Notifies disconnection to the application and frees the client instance.
+ *
+ * @param[in] p_client Identifies the client for which the procedure is requested.
+ * @param[in] result   Result notified with the event.
+ */
+void notify_disconnection(mqtt_client_t * p_client, uint32_t result);
+
+
 /**@brief Constructs/encodes connect packet.
  *
  * @param[in]  p_client          Identifies the client for which the procedure is requested.
@@ -514,6 +588,35 @@ void connect_request_encode(const mqtt_client_t *  p_client,
                             uint8_t             ** pp_packet,
                             uint32_t            *  p_packet_length);
 
+/**@brief Records a QoS 1 or QoS 2 publish message as awaiting acknowledgement.
+ *
+ * @param[in] p_client   Identifies the client for which the procedure is requested.
+ * @param[in] message_id Message id of the publish message.
+ * @param[in] qos        QoS of the publish message, 1 or 2.
+ * @param[in] dup_flag   Duplicate flag. If set, an entry for the same message id is reused.
+ *
+ * @retval NRF_SUCCESS             if the message is recorded.
+ * @retval NRF_ERROR_INVALID_PARAM if the message id is already awaiting acknowledgement.
+ * @retval NRF_ERROR_NO_MEM        if MQTT_MAX_INFLIGHT messages are awaiting acknowledgement.
+ */
+uint32_t mqtt_inflight_add(mqtt_client_t * p_client,
+                           uint16_t        message_id,
+                           uint8_t         qos,
+                           uint8_t         dup_flag);
+
+
+/**@brief Advances or releases a publish message in flight on reception of an acknowledgement.
+ *
+ * @param[in] p_client   Identifies the client for which the procedure is requested.
+ * @param[in] pkt_type   Acknowledgement packet type, PUBACK, PUBREC or PUBCOMP.
+ * @param[in] message_id Message id being acknowledged.
+ *
+ * @retval NRF_SUCCESS         if a matching message was found.
+ * @retval NRF_ERROR_NOT_FOUND if no message with the message id awaits the acknowledgement.
+ */
+uint32_t mqtt_inflight_ack(mqtt_client_t * p_client, uint8_t pkt_type, uint16_t message_id);
+
+
 /**@biref Function pointer array for selection of correct handler based on transport type. */
 extern const transport_procedure_t transport_fn[MQTT_TRASNPORT_MAX];
 
@@ -20,6 +20,7 @@
 
 
 #include "mqtt_internal.h"
+#include "mem_manager.h"
 
 #include "lwip/opt.h"
 #include "lwip/stats.h"
@@ -30,53 +31,154 @@
 /*lint -restore -e607 */
 
 
+/**@brief Copies data to the tail of the transmit ring. Caller ensures there is room. */
+static void tx_ring_put(mqtt_client_t * p_client, uint8_t const * p_data, uint32_t datalen)
+{
+    uint32_t write = (p_client->tx_ring_read + p_client->tx_ring_len) % MQTT_TX_RING_SIZE;
+    uint32_t chunk = MIN(datalen, MQTT_TX_RING_SIZE - write);
+
+    memcpy(&p_client->p_tx_ring[write], p_data, chunk);
+    memcpy(&p_client->p_tx_ring[0], &p_data[chunk], datalen - chunk);
+
+    p_client->tx_ring_len += datalen;
+
+    if (p_client->tx_ring_len > p_client->stats.tx_ring_peak)
+    {
+        p_client->stats.tx_ring_peak = p_client->tx_ring_len;
+    }
+}
+
+
+/**@brief Hands as much data as the TCP send buffer has room for to the stack.
+ *
+ * @param[in]    p_tcp_id  TCP connection of the client.
+ * @param[in]    p_data    Data to be written.
+ * @param[inout] p_datalen Length of data to be written. Set to the length written.
+ *
+ * @retval true if the data was written entirely.
+ */
+static bool tcp_write_available(struct tcp_pcb * p_tcp_id, uint8_t const * p_data, uint32_t * p_datalen)
+{
+    uint32_t chunk = MIN(*p_datalen, tcp_sndbuf(p_tcp_id));
+
+    if ((chunk != 0) && (tcp_write(p_tcp_id, p_data, chunk, TCP_WRITE_FLAG_COPY) != ERR_OK))
+    {
+        chunk = 0;
+    }
+
+    const bool complete = (chunk == *p_datalen);
+    *p_datalen = chunk;
+
+    return complete;
+}
+
+
+void mqtt_client_tcp_flush(mqtt_client_t * p_client)
+{
+    struct tcp_pcb * p_tcp_id = (struct tcp_pcb *)p_client->tcp_id;
+    uint32_t         sent     = 0;
+
+    if (!MQTT_VERIFY_STATE(p_client, MQTT_STATE_TCP_CONNECTED))
+    {
+        return;
+    }
+
+    while (p_client->tx_ring_len != 0)
+    {
+        uint32_t chunk = MIN(p_client->tx_ring_len, MQTT_TX_RING_SIZE - p_client->tx_ring_read);
+
+        const bool complete = tcp_write_available(p_tcp_id,
+                                                  &p_client->p_tx_ring[p_client->tx_ring_read],
+                                                  &chunk);
+
+        p_client->tx_ring_read  = (p_client->tx_ring_read + chunk) % MQTT_TX_RING_SIZE;
+        p_client->tx_ring_len  -= chunk;
+        sent                   += chunk;
+
+        if (!complete)
+        {
+            break;
+        }
+    }
+
+    if (p_client->tx_ring_len == 0)
+    {
+        p_client->tx_ring_read = 0;
+        MQTT_RESET_STATE(p_client, MQTT_STATE_PENDING_WRITE);
+    }
+
+    if (sent != 0)
+    {
+        p_client->stats.tx_bytes += sent;
+        UNUSED_VARIABLE(tcp_output(p_tcp_id));
+        MQTT_TRC("[MQTT]:[%p]: TX ring flushed 0x%08x, remaining 0x%08x.\r\n",
+                 p_client, sent, p_client->tx_ring_len);
+    }
+}
+
+
 err_t tcp_write_complete_cb(void *p_arg, struct tcp_pcb *ttcp_id, u16_t len)
 {
     MQTT_MUTEX_LOCK();
 
     mqtt_client_t   *p_client = (mqtt_client_t *)(p_arg);
-    MQTT_RESET_STATE(p_client, MQTT_STATE_PENDING_WRITE);
-    MQTT_TRC("[MQTT]:[%p]: TCP Write Complete.\r\n", p_client);
+    p_client->stats.tx_acked_bytes += len;
+    MQTT_TRC("[MQTT]:[%p]: TCP Write Complete, length 0x%04x.\r\n", p_client, len);
+
+    // Acknowledged data made room in the send buffer, keep the pipeline full.
+    mqtt_client_tcp_flush(p_client);
 
     MQTT_MUTEX_UNLOCK();
 
-    return NRF_SUCCESS;
+    return ERR_OK;
 }
 
 
 uint32_t mqtt_client_tcp_write(mqtt_client_t * p_client, uint8_t const * data, uint32_t datalen)
 {
-    uint32_t retval = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
+    uint32_t retval  = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
+    uint32_t written = 0;
 
-    if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_PENDING_WRITE))
+    if (!MQTT_VERIFY_STATE(p_client, MQTT_STATE_TCP_CONNECTED))
     {
-        retval = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
+        return retval;
     }
-    else if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_TCP_CONNECTED))
-    {
-        tcp_sent((struct tcp_pcb *)p_client->tcp_id, tcp_write_complete_cb);
-
-        MQTT_MUTEX_UNLOCK ();
-
-        uint32_t err = tcp_write((struct tcp_pcb *)p_client->tcp_id,
-                                 data,
-                                 datalen,
-                                 TCP_WRITE_FLAG_COPY);
 
-        MQTT_MUTEX_LOCK ();
+    // Bypass the ring while nothing is queued ahead of the packet. Ring space is then only needed
+    // for what the TCP send buffer does not take. Packets are written whole or not at all, so that
+    // framing on the stream is kept, hence the write is only tried when the remainder fits.
+    if ((p_client->tx_ring_len == 0) &&
+        (datalen <= (uint32_t)(MQTT_TX_RING_SIZE + tcp_sndbuf((struct tcp_pcb *)p_client->tcp_id))))
+    {
+        written = datalen;
+        UNUSED_VARIABLE(tcp_write_available((struct tcp_pcb *)p_client->tcp_id, data, &written));
+    }
 
-        if(err == ERR_OK)
+    if ((datalen - written) > (uint32_t)(MQTT_TX_RING_SIZE - p_client->tx_ring_len))
+    {
+        // Either the ring is not empty, or the TCP write was refused as a whole.
+        p_client->stats.tx_ring_full++;
+        MQTT_TRC("[MQTT]: TX ring full, length 0x%08x, queued 0x%08x\r\n",
+                 datalen, p_client->tx_ring_len);
+    }
+    else
+    {
+        if (written != 0)
         {
-            MQTT_SET_STATE(p_client, MQTT_STATE_PENDING_WRITE);
-            UNUSED_VARIABLE(iot_timer_wall_clock_get(&p_client->last_activity));
-            MQTT_TRC("[MQTT]:[%p]: TCP Write in Progress, length 0x%08x.\r\n", p_client, datalen);
-            retval = NRF_SUCCESS;
+            p_client->stats.tx_bytes += written;
+            UNUSED_VARIABLE(tcp_output((struct tcp_pcb *)p_client->tcp_id));
         }
-        else
+
+        if (written != datalen)
         {
-            MQTT_TRC("[MQTT]: TCP write failed, err = %d\r\n", err);
-            retval = (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE);
+            tx_ring_put(p_client, &data[written], datalen - written);
+            MQTT_SET_STATE(p_client, MQTT_STATE_PENDING_WRITE);
         }
+
+        p_client->stats.tx_packets++;
+        UNUSED_VARIABLE(iot_timer_wall_clock_get(&p_client->last_activity));
+        MQTT_TRC("[MQTT]:[%p]: TCP Write in Progress, length 0x%08x.\r\n", p_client, datalen);
+        retval = NRF_SUCCESS;
     }
 
     return retval;
@@ -167,18 +269,111 @@ uint32_t mqtt_handle_rx_data(mqtt_client_t * p_client, uint8_t * p_data, uint32_
         }
         case MQTT_PKT_TYPE_CONNACK:
         {
-            MQTT_TRC("[MQTT]:[%p]: Received CONACK, MQTT connection up!\r\n", p_client);
+            uint8_t return_code = 0xFF;
 
-            // Set state.
-            MQTT_SET_STATE(p_client, MQTT_STATE_CONNECTED);
+            // Acknowledge flags (reserved in 3.1.0) are followed by the connect return code.
+            packet_length_decode(p_data, &remaining_length, &offset);
+            offset++;
+            UNUSED_VARIABLE(unpack_uint8(&return_code, datalen, p_data, &offset));
+
+            MQTT_TRC("[MQTT]:[%p]: Received CONACK, return code 0x%02x\r\n", p_client, return_code);
 
             evt.id        = MQTT_EVT_CONNECT;
-            evt.result    = NRF_SUCCESS;
+            evt.result    = MQTT_CONNECTION_FAILED;
+
+            if (return_code == 0)
+            {
+                // Set state.
+                MQTT_SET_STATE(p_client, MQTT_STATE_CONNECTED);
+                evt.result = NRF_SUCCESS;
+            }
 
             // Set event notification callback to notify the event to application.
             evt_cb        = p_client->evt_cb;
             break;
         }
+        case MQTT_PKT_TYPE_PUBACK:
+        case MQTT_PKT_TYPE_PUBREC:
+        case MQTT_PKT_TYPE_PUBCOMP:
+        {
+            packet_length_decode(p_data, &remaining_length, &offset);
+
+            err_code = unpack_uint16(&evt.param.ack.message_id, datalen, p_data, &offset);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                err_code = mqtt_inflight_ack(p_client, p_data[0] & 0xF0, evt.param.ack.message_id);
+            }
+
+            MQTT_TRC("[MQTT]:[CID %p]: Received acknowledgement 0x%02x, message id 0x%04x, "
+                     "result 0x%08x\r\n",
+                     p_client, p_data[0], evt.param.ack.message_id, err_code);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                switch (p_data[0] & 0xF0)
+                {
+                    case MQTT_PKT_TYPE_PUBACK:
+                        evt.id = MQTT_EVT_PUBLISH_ACK;
+                        break;
+                    case MQTT_PKT_TYPE_PUBREC:
+                        evt.id = MQTT_EVT_PUBLISH_REC;
+                        break;
+                    default:
+                        evt.id = MQTT_EVT_PUBLISH_COMP;
+                        break;
+                }
+
+                evt.result = NRF_SUCCESS;
+                evt_cb     = p_client->evt_cb;
+            }
+            break;
+        }
+        case MQTT_PKT_TYPE_PUBREL:
+        case MQTT_PKT_TYPE_UNSUBACK:
+        {
+            packet_length_decode(p_data, &remaining_length, &offset);
+
+            err_code = unpack_uint16(&evt.param.ack.message_id, datalen, p_data, &offset);
+
+            MQTT_TRC("[MQTT]:[CID %p]: Received 0x%02x, message id 0x%04x\r\n",
+                     p_client, p_data[0], evt.param.ack.message_id);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                evt.id     = ((p_data[0] & 0xF0) == MQTT_PKT_TYPE_UNSUBACK) ? MQTT_EVT_UNSUBSCRIBE_ACK :
+                                                                              MQTT_EVT_PUBLISH_REL;
+                evt.result = NRF_SUCCESS;
+                evt_cb     = p_client->evt_cb;
+            }
+            break;
+        }
+        case MQTT_PKT_TYPE_SUBACK:
+        {
+            packet_length_decode(p_data, &remaining_length, &offset);
+
+            err_code = unpack_uint16(&evt.param.ack.message_id, datalen, p_data, &offset);
+
+            MQTT_TRC("[MQTT]:[CID %p]: Received SUBACK, message id 0x%04x\r\n",
+                     p_client, evt.param.ack.message_id);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                evt.id     = MQTT_EVT_SUBSCRIBE_ACK;
+                evt.result = NRF_SUCCESS;
+                evt_cb     = p_client->evt_cb;
+
+                // One granted QoS per topic requested, 0x80 indicates the topic was refused.
+                for (; offset < datalen; offset++)
+                {
+                    if (p_data[offset] == 0x80)
+                    {
+                        evt.result = (NRF_ERROR_FORBIDDEN | IOT_MQTT_ERR_BASE);
+                    }
+                }
+            }
+            break;
+        }
         case MQTT_PKT_TYPE_DISCONNECT:
         {
             MQTT_TRC("[MQTT]: Received DISCONNECT\r\n");
@@ -209,7 +404,7 @@ uint32_t mqtt_handle_rx_data(mqtt_client_t * p_client, uint8_t * p_data, uint32_
 
 uint32_t mqtt_client_tcp_read(mqtt_client_t * p_id, uint8_t * p_data, uint32_t datalen)
 {
-    return mqtt_handle_rx_data( p_id, p_data, datalen);
+    return mqtt_rx_decode(p_id, p_data, datalen);
 }
 
 
@@ -226,9 +421,23 @@ err_t recv_callback(void * p_arg, struct tcp_pcb * p_tcp_id, struct pbuf * p_buf
     {
         MQTT_TRC("[MQTT]: >> Packet buffer length 0x%08x \r\n", p_buffer->tot_len);
         tcp_recved(p_tcp_id, p_buffer->tot_len);
-        UNUSED_VARIABLE(transport_fn[p_client->transport_type].read(p_client,
-                                                                    p_buffer->payload,
-                                                                    p_buffer->tot_len));
+
+        // Each buffer of the chain is contiguous, the decoder handles packets spanning them.
+        for (struct pbuf * p_part = p_buffer;
+             (p_part != NULL) && (p_client->state != MQTT_STATE_IDLE);
+             p_part = p_part->next)
+        {
+            uint32_t err_code = transport_fn[p_client->transport_type].read(p_client,
+                                                                            p_part->payload,
+                                                                            p_part->len);
+
+            if (err_code == (NRF_ERROR_INVALID_DATA | IOT_MQTT_ERR_BASE))
+            {
+                MQTT_TRC("[MQTT]: Stream framing lost, closing connection\r\n");
+                tcp_close_connection(p_client, MQTT_ERR_TRANSPORT_CLOSED);
+                notify_disconnection(p_client, MQTT_ERR_TRANSPORT_CLOSED);
+            }
+        }
     }
     else
     {
@@ -281,6 +490,7 @@ err_t tcp_connection_callback(void * p_arg, struct tcp_pcb * p_tcp_id, err_t err
 
         //Register callback.
         tcp_recv(p_tcp_id, recv_callback);
+        tcp_sent(p_tcp_id, tcp_write_complete_cb);
         uint32_t err_code = transport_fn[p_client->transport_type].connect(p_client);
 
         if (err_code != NRF_SUCCESS)
@@ -366,10 +576,10 @@ uint32_t mqtt_client_tcp_disconnect(mqtt_client_t * p_client)
     if (MQTT_VERIFY_STATE(p_client, MQTT_STATE_CONNECTED))
     {
         const uint8_t packet[] = {MQTT_PKT_TYPE_DISCONNECT, 0x00};
-        UNUSED_VARIABLE(tcp_write((struct tcp_pcb *)p_client->tcp_id,
-                       (void *)packet,
-                        sizeof(packet),
-                        1));
+
+        // Queue behind any packets still in the transmit ring; best effort if the ring is full.
+        UNUSED_VARIABLE(mqtt_client_tcp_write(p_client, packet, sizeof(packet)));
+        mqtt_client_tcp_flush(p_client);
 
         tcp_close_connection(p_client, NRF_SUCCESS);
         err_code = NRF_SUCCESS;
@@ -473,7 +683,7 @@ uint32_t mqtt_client_tls_read(mqtt_client_t * p_client, uint8_t * p_data, uint32
 
             if ((err == NRF_SUCCESS) && (rx_datalen > 0))
             {
-                 err = mqtt_handle_rx_data(p_client, p_data, rx_datalen);
+                 err = mqtt_rx_decode(p_client, p_data, rx_datalen);
             }
 
             nrf_free(p_data);
@@ -16,22 +16,20 @@
 #include "mem_manager.h"
 #include "mbuf.h"
 
-static bool     mbuf_empty_entry(mbuf_head_t * p_head, mbuf_t * p_mbuf);
-
-void mbuf_init(mbuf_head_t * p_head, mbuf_buf_fn buf_fn, mbuf_buf_len_fn buf_len_fn, mbuf_free_fn free_fn)
+void mbuf_init(mbuf_head_t * p_head, mbuf_free_fn free_fn)
 {
-    p_head->p_current = NULL;
+    p_head->p_first = NULL;
+    p_head->p_last = NULL;
     p_head->readp_current = 0;
-    p_head->buf = buf_fn;
-    p_head->buf_len = buf_len_fn;
+    p_head->size_total = 0;
     p_head->free = free_fn;
 }
  
 uint32_t
-mbuf_alloc(mbuf_t ** pp_mbuf, void * p_ctx)
+mbuf_alloc(mbuf_t ** pp_mbuf, void * p_ctx, uint8_t * p_data, uint32_t len)
 {
     uint32_t mbuf_len = sizeof(mbuf_t);
-    uint32_t err_code = nrf_mem_reserve((uint8_t **)pp_mbuf, &mbuf_len);
+    uint32_t err_code = nrf_mem_reserve_tagged((uint8_t **)pp_mbuf, &mbuf_len, NRF_MEM_TAG_SOCKET);
     if (err_code != NRF_SUCCESS)
     {
         *pp_mbuf = NULL;
@@ -40,78 +38,148 @@ mbuf_alloc(mbuf_t ** pp_mbuf, void * p_ctx)
     {
         mbuf_t * p_mbuf = *pp_mbuf;
         p_mbuf->p_ctx = p_ctx;
+        p_mbuf->p_data = p_data;
+        p_mbuf->len = len;
         p_mbuf->p_next = NULL;
     }
     return err_code;
 }
 
-static bool
-mbuf_empty_entry(mbuf_head_t *p_head, mbuf_t * p_mbuf)
+static void
+mbuf_first_free(mbuf_head_t * p_head)
 {
-    return p_head->buf_len(p_mbuf) == p_head->readp_current;
+    mbuf_t * p_first = p_head->p_first;
+    p_head->p_first = p_first->p_next;
+    if (p_head->p_first == NULL)
+    {
+        p_head->p_last = NULL;
+    }
+    p_head->readp_current = 0;
+    p_head->free(p_first->p_ctx);
+    (void) nrf_free((uint8_t *)p_first);
 }
 
 
 void
 mbuf_write(mbuf_head_t * p_head, mbuf_t * p_mbuf)
 {
-    if (p_head->p_current == NULL)
+    mbuf_t * p_last = p_mbuf;
+    p_head->size_total += p_last->len;
+    while (p_last->p_next != NULL)
     {
-        p_head->p_current = p_mbuf;
+        p_last = p_last->p_next;
+        p_head->size_total += p_last->len;
+    }
+
+    if (p_head->p_first == NULL)
+    {
+        p_head->p_first = p_mbuf;
     }
     else
     {
-        mbuf_t * p_current = p_head->p_current;
-        while (p_current->p_next != NULL)
+        p_head->p_last->p_next = p_mbuf;
+    }
+    p_head->p_last = p_last;
+}
+
+uint32_t
+mbuf_release(mbuf_head_t * p_head, uint32_t len)
+{
+    uint32_t nbytes = 0;
+    while (p_head->p_first != NULL)
+    {
+        uint32_t skip_len = MIN(len - nbytes, p_head->p_first->len - p_head->readp_current);
+        p_head->readp_current += skip_len;
+        nbytes += skip_len;
+        if (p_head->readp_current < p_head->p_first->len)
         {
-            p_current = p_current->p_next;
+            break;
         }
-        p_current->p_next = p_mbuf;
+        // Segment fully consumed, or empty.
+        mbuf_first_free(p_head);
     }
+    p_head->size_total -= nbytes;
+    return nbytes;
 }
 
 uint32_t
-mbuf_read(mbuf_head_t * p_head, void * p_buf, uint32_t buf_size)
+mbuf_readv(mbuf_head_t * p_head, const struct iovec * p_iov, uint32_t iovcnt, int flags)
 {
-    mbuf_t * p_current = p_head->p_current;
+    mbuf_t * p_current = p_head->p_first;
+    uint32_t offset = p_head->readp_current;
     uint32_t nbytes = 0;
-    while (nbytes < buf_size && p_current != NULL)
+    for (uint32_t i = 0; i < iovcnt && p_current != NULL; i++)
     {
-        uint8_t * p_data = p_head->buf(p_current);
-        uint32_t p_data_len = p_head->buf_len(p_current);
-
-        uint32_t copy_len = MIN(buf_size, (p_data_len - p_head->readp_current));
-        memcpy(p_buf, (void *)(p_data + p_head->readp_current), copy_len);
-        p_head->readp_current += copy_len;
-        nbytes += copy_len;
-        if (mbuf_empty_entry(p_head, p_current) == true)
+        uint8_t * p_buf = (uint8_t *)p_iov[i].iov_base;
+        uint32_t buf_size = p_iov[i].iov_len;
+        while (buf_size > 0 && p_current != NULL)
         {
-            mbuf_t * p_next = p_current->p_next;
-            p_head->free(p_current->p_ctx);
-            (void) nrf_free((uint8_t *)p_current);
-            p_current = p_next;
-            p_head->readp_current = 0;
+            uint32_t copy_len = MIN(buf_size, (p_current->len - offset));
+            memcpy(p_buf, (void *)(p_current->p_data + offset), copy_len);
+            p_buf += copy_len;
+            buf_size -= copy_len;
+            offset += copy_len;
+            nbytes += copy_len;
+            if (offset == p_current->len)
+            {
+                p_current = p_current->p_next;
+                offset = 0;
+            }
         }
     }
-    p_head->p_current = p_current;
+    if ((flags & MSG_PEEK) == 0)
+    {
+        (void) mbuf_release(p_head, nbytes);
+    }
     return nbytes;
 }
 
+uint32_t
+mbuf_read(mbuf_head_t * p_head, void * p_buf, uint32_t buf_size)
+{
+    const struct iovec iov = { p_buf, buf_size };
+    return mbuf_readv(p_head, &iov, 1, 0);
+}
+
+uint32_t
+mbuf_peek(mbuf_head_t * p_head, void * p_buf, uint32_t buf_size)
+{
+    const struct iovec iov = { p_buf, buf_size };
+    return mbuf_readv(p_head, &iov, 1, MSG_PEEK);
+}
+
+uint32_t
+mbuf_borrow(mbuf_head_t * p_head, uint8_t ** pp_data)
+{
+    // Drop any segments that are already consumed, or empty.
+    (void) mbuf_release(p_head, 0);
+    if (p_head->p_first == NULL)
+    {
+        *pp_data = NULL;
+        return 0;
+    }
+    *pp_data = p_head->p_first->p_data + p_head->readp_current;
+    return p_head->p_first->len - p_head->readp_current;
+}
+
+void
+mbuf_flush(mbuf_head_t * p_head)
+{
+    while (p_head->p_first != NULL)
+    {
+        mbuf_first_free(p_head);
+    }
+    p_head->size_total = 0;
+}
+
 bool
 mbuf_empty(mbuf_head_t * p_head)
 {
-    return p_head->p_current == NULL || mbuf_empty_entry(p_head, p_head->p_current);
+    return p_head->size_total == 0;
 }
 
 uint32_t
 mbuf_size_total(mbuf_head_t * p_head)
 {
-    uint32_t total_size= 0;
-    mbuf_t * p_current = p_head->p_current;
-    while (p_current != NULL)
-    {
-        total_size += p_head->buf_len(p_current);
-        p_current = p_current->p_next;
-    }
-    return total_size;
+    return p_head->size_total;
 }
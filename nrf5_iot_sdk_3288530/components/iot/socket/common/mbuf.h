@@ -13,31 +13,61 @@
 #ifndef MBUF_H__
 #define MBUF_H__
 
+#include "socket_api.h"
+
+/**
+ * @brief Segment of received data.
+ *
+ * @details A segment refers to a contiguous area of data owned by the transport. The context is
+ *          given back to the transport through the free function of the queue once all data of
+ *          the segment has been consumed.
+ */
 struct mbuf {
     void        * p_ctx;
+    uint8_t     * p_data;
+    uint32_t      len;
     struct mbuf * p_next;
 };
 
 typedef struct mbuf mbuf_t;
-typedef uint8_t * (*mbuf_buf_fn)(mbuf_t * p_mbuf);
-typedef uint32_t  (*mbuf_buf_len_fn)(mbuf_t * p_mbuf);
 typedef void      (*mbuf_free_fn)(void * p_ctx);
 
 typedef struct {
-    mbuf_t              * p_current;
-    mbuf_buf_fn           buf;
-    mbuf_buf_len_fn       buf_len;
+    mbuf_t              * p_first;
+    mbuf_t              * p_last;
     mbuf_free_fn          free;
     uint32_t              readp_current;
+    uint32_t              size_total;
 } mbuf_head_t;
 
 
-void     mbuf_init(mbuf_head_t * p_head, mbuf_buf_fn buf_fn, mbuf_buf_len_fn buf_len_fn, mbuf_free_fn free_fn);
-uint32_t mbuf_alloc(mbuf_t ** pp_mbuf, void * p_ctx);
+void     mbuf_init(mbuf_head_t * p_head, mbuf_free_fn free_fn);
+uint32_t mbuf_alloc(mbuf_t ** pp_mbuf, void * p_ctx, uint8_t * p_data, uint32_t len);
 
+/** Append a list of segments, linked through p_next, to the queue. */
 void     mbuf_write(mbuf_head_t * p_head, mbuf_t * p_mbuf);
+
+/** Copy up to buf_size bytes from the queue, consuming them. */
 uint32_t mbuf_read(mbuf_head_t * p_head, void * p_buf, uint32_t buf_size);
 
+/** Copy up to buf_size bytes from the queue, leaving them in the queue. */
+uint32_t mbuf_peek(mbuf_head_t * p_head, void * p_buf, uint32_t buf_size);
+
+/** Scatter data from the queue into iovcnt buffers. Data is consumed unless MSG_PEEK is set in
+ *  flags. */
+uint32_t mbuf_readv(mbuf_head_t * p_head, const struct iovec * p_iov, uint32_t iovcnt, int flags);
+
+/** Borrow the contiguous data at the read position without copying. Returns the number of bytes
+ *  available at *pp_data, 0 if the queue is empty. The data stays valid until released. */
+uint32_t mbuf_borrow(mbuf_head_t * p_head, uint8_t ** pp_data);
+
+/** Consume up to len bytes from the queue, such as data borrowed using mbuf_borrow. Returns the
+ *  number of bytes consumed. */
+uint32_t mbuf_release(mbuf_head_t * p_head, uint32_t len);
+
+/** Free all segments in the queue. */
+void     mbuf_flush(mbuf_head_t * p_head);
+
 bool     mbuf_empty(mbuf_head_t * p_head);
 uint32_t mbuf_size_total(mbuf_head_t * p_head);
 
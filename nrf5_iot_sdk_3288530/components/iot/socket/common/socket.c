@@ -9,6 +9,7 @@
  * the file.
  *
  */
+#include <stddef.h>
 #include "nordic_common.h"
 #include "sdk_common.h"
 #include "sdk_config.h"
@@ -26,11 +27,19 @@
 #include "mem_manager.h"
 #include "ipv6_parse.h"
 #include "netinet/in.h"
+#include "app_util_platform.h"
+#include "nrf_platform_port.h"
 
 #ifndef SOCKET_ENABLE_API_PARAM_CHECK
 #define SOCKET_ENABLE_API_PARAM_CHECK 0
 #endif
 
+#define SOCKET_WAIT_CHUNK_MS   3600000                                                             /**< Longest interval of the wait timer, longer timeouts are waited for in several intervals. */
+
+#if SOCKET_MAX_SOCKET_COUNT > 32
+#error "SOCKET_MAX_SOCKET_COUNT must not be larger than 32, readiness is tracked in 32-bit masks."
+#endif
+
 #if SOCKET_MEDIUM_ENABLE == 1
 #include "socket_medium.h"
 #endif
@@ -116,6 +125,49 @@ typedef struct
 
 static socket_entry_t m_socket_table[SOCKET_MAX_SOCKET_COUNT];
 
+static volatile uint32_t m_readable;                                                            /**< Sockets with received data queued or hung up, one bit per socket. */
+static volatile uint32_t m_writable;                                                            /**< Sockets that can accept data to send, one bit per socket. */
+static volatile uint32_t m_hungup;                                                              /**< Sockets closed by the remote end, one bit per socket. */
+static volatile bool     m_readiness_changed;                                                   /**< Set whenever the readiness of any socket changes. */
+static volatile bool     m_wait_timeout;                                                        /**< Set when the wait timer of poll() expires. */
+
+APP_TIMER_DEF(m_wait_timer_id);
+
+static void
+socket_wait_timeout_handler(void * p_context)
+{
+    (void) p_context;
+    m_wait_timeout = true;
+}
+
+/**
+ * Evaluates the readiness of a socket and updates the readiness masks. Called from the transport
+ * event handlers as well as from the application context, so the masks are updated in a critical
+ * region.
+ */
+static void
+socket_readiness_evaluate(int sock)
+{
+    socket_handle_t * p_handle = &m_socket_table[sock].handle;
+    const uint32_t mask = (1u << sock);
+    const bool readable = ((mbuf_empty(&p_handle->mbuf_head) == false) || p_handle->hangup);
+
+    CRITICAL_REGION_ENTER();
+    m_readable = readable ? (m_readable | mask) : (m_readable & ~mask);
+    m_writable = p_handle->write_ready ? (m_writable | mask) : (m_writable & ~mask);
+    m_hungup = p_handle->hangup ? (m_hungup | mask) : (m_hungup & ~mask);
+    m_readiness_changed = true;
+    CRITICAL_REGION_EXIT();
+}
+
+void
+socket_readiness_update(socket_handle_t * p_socket_handle)
+{
+    const socket_entry_t * p_entry =
+        (const socket_entry_t *)((uint8_t *)p_socket_handle - offsetof(socket_entry_t, handle));
+    socket_readiness_evaluate((int)(p_entry - m_socket_table));
+}
+
 uint32_t
 socket_init(void)
 {
@@ -130,6 +182,13 @@ socket_init(void)
 #endif
 	    APP_ERROR_CHECK(err_code);
         portdb_init();
+        m_readable = 0;
+        m_writable = 0;
+        m_hungup = 0;
+        err_code = app_timer_create(&m_wait_timer_id,
+                                    APP_TIMER_MODE_SINGLE_SHOT,
+                                    socket_wait_timeout_handler);
+        APP_ERROR_CHECK(err_code);
 #if SOCKET_IPV6_ENABLE == 1 || SOCKET_LWIP_ENABLE == 1
         transport_handler_init();
 #endif
@@ -232,6 +291,7 @@ socket_free(int sock)
     memset(&m_socket_table[sock], 0, sizeof(m_socket_table[sock]));
     m_socket_table[sock].state = STATE_CLOSED;
     SOCKET_MUTEX_UNLOCK();
+    socket_readiness_evaluate(sock);
 }
 
 int
@@ -359,8 +419,8 @@ write(int sock, const void * p_buf, size_t buflen)
 
 static uint32_t
 socket_recv(socket_handle_t * p_socket_handle,
-            void * p_buf,
-            uint32_t buf_size,
+            const struct iovec * p_iov,
+            uint32_t iovcnt,
             uint32_t * buf_len,
             int flags)
 {
@@ -370,7 +430,7 @@ socket_recv(socket_handle_t * p_socket_handle,
         flags |= MSG_DONTWAIT;
     }
     uint32_t err_code = NRF_SUCCESS;
-    if (mbuf_empty(&p_socket_handle->mbuf_head) == true)
+    if ((mbuf_empty(&p_socket_handle->mbuf_head) == true) && (p_socket_handle->hangup == false))
     {
         if ((flags & MSG_DONTWAIT) != 0)
         {
@@ -378,7 +438,9 @@ socket_recv(socket_handle_t * p_socket_handle,
         }
         else
         {
-            while ((mbuf_empty(&p_socket_handle->mbuf_head) == true) && (err_code == NRF_SUCCESS))
+            while ((mbuf_empty(&p_socket_handle->mbuf_head) == true) &&
+                   (p_socket_handle->hangup == false) &&
+                   (err_code == NRF_SUCCESS))
             {
                 err_code = sd_app_evt_wait();
             }
@@ -387,18 +449,20 @@ socket_recv(socket_handle_t * p_socket_handle,
 
     if (err_code == NRF_SUCCESS)
     {
-        *buf_len = mbuf_read(&p_socket_handle->mbuf_head, p_buf, buf_size);
-        p_socket_handle->read_events = 0;
+        // Returns 0 once all data has been read from a socket closed by the remote end.
+        *buf_len = mbuf_readv(&p_socket_handle->mbuf_head, p_iov, iovcnt, flags);
+        if ((flags & MSG_PEEK) == 0)
+        {
+            p_socket_handle->read_events = 0;
+            socket_readiness_update(p_socket_handle);
+        }
     }
     return err_code;
 }
 
-ssize_t recv(int sock, void * p_buf, size_t buf_size, int flags)
+static ssize_t
+socket_recv_iov(int sock, const struct iovec * p_iov, uint32_t iovcnt, int flags)
 {
-    VERIFY_MODULE_IS_INITIALIZED();
-    VERIFY_SOCKET_ID(sock);
-    NULL_PARAM_CHECK(p_buf);
-
     SOCKET_MUTEX_LOCK();
     socket_entry_t * p_socket_entry = &m_socket_table[sock];
     SOCKET_MUTEX_UNLOCK();
@@ -408,8 +472,8 @@ ssize_t recv(int sock, void * p_buf, size_t buf_size, int flags)
     {
         uint32_t recv_size = 0;
         uint32_t err_code = socket_recv(&p_socket_entry->handle,
-                                        p_buf,
-                                        buf_size,
+                                        p_iov,
+                                        iovcnt,
                                         &recv_size,
                                         flags);
         if (err_code == NRF_SUCCESS)
@@ -425,6 +489,33 @@ ssize_t recv(int sock, void * p_buf, size_t buf_size, int flags)
     return ret;
 }
 
+ssize_t recv(int sock, void * p_buf, size_t buf_size, int flags)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    VERIFY_SOCKET_ID(sock);
+    NULL_PARAM_CHECK(p_buf);
+
+    const struct iovec iov = { p_buf, buf_size };
+    return socket_recv_iov(sock, &iov, 1, flags);
+}
+
+ssize_t recvmsg(int sock, struct msghdr * p_msg, int flags)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    VERIFY_SOCKET_ID(sock);
+    NULL_PARAM_CHECK(p_msg);
+    NULL_PARAM_CHECK(p_msg->msg_iov);
+
+    if ((p_msg->msg_iovlen <= 0) || (p_msg->msg_iovlen > IOV_MAX))
+    {
+        set_errno(EINVAL);
+        return -1;
+    }
+
+    p_msg->msg_flags = 0;
+    return socket_recv_iov(sock, p_msg->msg_iov, (uint32_t)p_msg->msg_iovlen, flags);
+}
+
 ssize_t read(int sock, void * p_buf, size_t buf_size)
 {
     return recv(sock, p_buf,  buf_size, 0);
@@ -512,17 +603,121 @@ close(int sock)
     return ret;
 }
 
-int
-fd_set_cmp(fd_set * set_a, fd_set * set_b)
+/**
+ * Sets the events that occurred on each socket in p_fds, returns the number of sockets with events.
+ */
+static int
+socket_poll_scan(struct pollfd * p_fds, nfds_t nfds)
 {
-    for (uint32_t i = 0; i < FD_SETSIZE; i++)
+    int num_ready = 0;
+
+    // Cleared before evaluating, so that changes while evaluating are not missed.
+    m_readiness_changed = false;
+
+    for (nfds_t i = 0; i < nfds; i++)
     {
-        if (FD_ISSET(i, set_a) != FD_ISSET(i, set_b))
+        const int sock = p_fds[i].fd;
+        short revents = 0;
+        if (sock < 0)
         {
-            return 1;
+            // Ignored.
+        }
+        else if ((sock >= SOCKET_MAX_SOCKET_COUNT) || (m_socket_table[sock].state == STATE_CLOSED))
+        {
+            revents = POLLNVAL;
+        }
+        else
+        {
+            const uint32_t mask = (1u << sock);
+            if ((m_readable & mask) != 0)
+            {
+                revents |= (p_fds[i].events & POLLIN);
+            }
+            if ((m_writable & mask) != 0)
+            {
+                revents |= (p_fds[i].events & POLLOUT);
+            }
+            if ((m_hungup & mask) != 0)
+            {
+                revents |= POLLHUP;
+            }
+        }
+        p_fds[i].revents = revents;
+        if (revents != 0)
+        {
+            num_ready++;
         }
     }
-    return 0;
+    return num_ready;
+}
+
+/**
+ * Starts the wait timer for at most SOCKET_WAIT_CHUNK_MS, and deducts the interval started from
+ * the remaining time.
+ */
+static uint32_t
+socket_wait_timer_start(int * p_remaining)
+{
+    const uint32_t interval = MIN((uint32_t)*p_remaining, SOCKET_WAIT_CHUNK_MS);
+    *p_remaining -= (int)interval;
+    m_wait_timeout = false;
+    return app_timer_start(m_wait_timer_id,
+                           MAX(APP_TIMER_TICKS(interval, NRF_DRIVER_TIMER_PRESCALER),
+                               APP_TIMER_MIN_TIMEOUT_TICKS),
+                           NULL);
+}
+
+static int
+socket_poll(struct pollfd * p_fds, nfds_t nfds, int timeout)
+{
+    uint32_t err_code = NRF_SUCCESS;
+    int num_ready = socket_poll_scan(p_fds, nfds);
+
+    if ((num_ready == 0) && (timeout != 0))
+    {
+        int remaining = timeout;
+        m_wait_timeout = false;
+        if (timeout > 0)
+        {
+            err_code = socket_wait_timer_start(&remaining);
+        }
+        while ((num_ready == 0) && (err_code == NRF_SUCCESS))
+        {
+            err_code = sd_app_evt_wait();
+            if (m_readiness_changed)
+            {
+                num_ready = socket_poll_scan(p_fds, nfds);
+            }
+            // The timer may expire in the same wake-up as a readiness change.
+            if ((num_ready == 0) && m_wait_timeout)
+            {
+                if (remaining == 0)
+                {
+                    break;
+                }
+                err_code = socket_wait_timer_start(&remaining);
+            }
+        }
+        if (timeout > 0)
+        {
+            (void) app_timer_stop(m_wait_timer_id);
+        }
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        socket_set_errno(err_code);
+        num_ready = -1;
+    }
+    return num_ready;
+}
+
+int poll(struct pollfd * p_fds, nfds_t nfds, int timeout)
+{
+    VERIFY_MODULE_IS_INITIALIZED();
+    NULL_PARAM_CHECK(p_fds);
+
+    return socket_poll(p_fds, nfds, timeout);
 }
 
 int select(int nfds,
@@ -531,50 +726,87 @@ int select(int nfds,
            fd_set * p_exceptset,
            const struct timeval * timeout)
 {
+    VERIFY_MODULE_IS_INITIALIZED();
     VERIFY_SOCKET_ID(nfds - 1);
-    // TODO: Support writeset and exceptset
-    (void) p_writeset;
-    (void) p_exceptset;
 
+    struct pollfd fds[SOCKET_MAX_SOCKET_COUNT];
+    for (int sock = 0; sock < nfds; sock++)
+    {
+        fds[sock].fd = sock;
+        fds[sock].events = 0;
+        if ((p_readset != NULL) && FD_ISSET(sock, p_readset))
+        {
+            fds[sock].events |= POLLIN;
+        }
+        if ((p_writeset != NULL) && FD_ISSET(sock, p_writeset))
+        {
+            fds[sock].events |= POLLOUT;
+        }
+        if (fds[sock].events == 0)
+        {
+            fds[sock].fd = -1;
+        }
+    }
+
+    int timeout_ms = -1;
     if (timeout != NULL)
     {
-        set_errno(EINVAL);
-        return -1;
+        if ((timeout->tv_sec < 0) || (timeout->tv_usec < 0) || (timeout->tv_usec >= 1000000))
+        {
+            set_errno(EINVAL);
+            return -1;
+        }
+        if (timeout->tv_sec >= (INT32_MAX / 1000) - 1)
+        {
+            // Longer than poll() takes, wait as long as it can.
+            timeout_ms = INT32_MAX;
+        }
+        else
+        {
+            timeout_ms = ((int)timeout->tv_sec * 1000) + (int)((timeout->tv_usec + 999) / 1000);
+        }
     }
 
-    fd_set readset;
-    FD_ZERO(&readset);
+    int num_ready = socket_poll(fds, (nfds_t)nfds, timeout_ms);
+    if (num_ready < 0)
+    {
+        return -1;
+    }
 
-    int num_ready = 0;
-    uint32_t err_code = NRF_SUCCESS;
-    while (err_code == NRF_SUCCESS)
+    num_ready = 0;
+    for (int sock = 0; sock < nfds; sock++)
     {
-        SOCKET_MUTEX_LOCK();
-        for (int sock = 0; sock < nfds; sock++)
+        if ((fds[sock].revents & POLLNVAL) != 0)
         {
-            socket_entry_t * p_socket_entry = &m_socket_table[sock];
-            if (FD_ISSET(sock, p_readset) &&
-                p_socket_entry->handle.read_events > 0)
+            set_errno(EBADF);
+            return -1;
+        }
+        if (p_readset != NULL && FD_ISSET(sock, p_readset))
+        {
+            if ((fds[sock].revents & (POLLIN | POLLHUP)) != 0)
             {
-                FD_SET(sock, &readset);
                 num_ready++;
             }
             else
             {
-                FD_CLR(sock, &readset);
+                FD_CLR(sock, p_readset);
             }
         }
-        SOCKET_MUTEX_UNLOCK();
-        // TODO: Check out how app events queue up while we checked the socket
-        if (fd_set_cmp(p_readset, &readset) == 0)
+        if (p_writeset != NULL && FD_ISSET(sock, p_writeset))
         {
-            break;
+            if ((fds[sock].revents & (POLLOUT | POLLHUP)) != 0)
+            {
+                num_ready++;
+            }
+            else
+            {
+                FD_CLR(sock, p_writeset);
+            }
         }
-        else
+        if (p_exceptset != NULL)
         {
-            err_code = sd_app_evt_wait();
+            FD_CLR(sock, p_exceptset);
         }
-
     }
 
     return num_ready;
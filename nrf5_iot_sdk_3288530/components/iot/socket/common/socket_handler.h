@@ -28,6 +28,8 @@ typedef struct {
     int                flags;
     mbuf_head_t        mbuf_head;
     uint16_t           read_events;
+    volatile bool      write_ready;     /**< Set by the transport while it can accept data to send. */
+    volatile bool      hangup;          /**< Set by the transport once the remote end has closed. */
     socket_params_t    params;
 } socket_handle_t;
 
@@ -62,6 +64,15 @@ typedef struct {
     close_handler_t   close_handler;
 } socket_handler_t;
 
+/**
+ * @brief Notify the socket layer that the readiness of a socket has changed.
+ *
+ * @details Called by the transport after it has changed the receive queue, write_ready or hangup
+ *          of the socket. Only this socket is evaluated again, and any waiting poll() or select()
+ *          is woken up.
+ */
+void socket_readiness_update(socket_handle_t * p_socket_handle);
+
 #if SOCKET_IPV6_ENABLE == 1 || SOCKET_LWIP_ENABLE == 1
 extern socket_handler_t transport_handler;
 void transport_handler_init(void);
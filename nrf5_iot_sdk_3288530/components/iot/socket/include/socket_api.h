@@ -63,7 +63,42 @@ typedef uint32_t fd_set;
 #endif
 
 typedef uint16_t in_port_t;
-struct timeval;
+
+#if !defined(__GNUC__) || (__GNUC__ == 0)
+/**
+ * @brief Time interval, used as the timeout of select().
+ */
+struct timeval {
+    int32_t tv_sec;                                         /**< Seconds. */
+    int32_t tv_usec;                                        /**< Microseconds. */
+};
+#else
+#include <sys/time.h>
+#endif
+
+/**
+ * @brief API for polling a set of sockets.
+ *
+ * @details Each element of the array given to poll() selects the events of interest on a socket.
+ *          The events that occurred are returned in revents. A negative descriptor is ignored.
+ */
+#ifndef POLLIN
+
+typedef uint32_t nfds_t;
+
+struct pollfd {
+    int     fd;                                             /**< Socket descriptor.          */
+    short   events;                                         /**< Requested events.           */
+    short   revents;                                        /**< Returned events.            */
+};
+
+#define POLLIN                  0x0001                         /**< Data can be read without blocking.                   */
+#define POLLOUT                 0x0004                         /**< Data can be sent without blocking.                   */
+#define POLLERR                 0x0008                         /**< Error on the socket. Always returned, if any.        */
+#define POLLHUP                 0x0010                         /**< Remote end closed. Always returned, if any.          */
+#define POLLNVAL                0x0020                         /**< Descriptor not open. Always returned, if any.        */
+
+#endif
 
 /**
  * @brief Socket families.
@@ -100,6 +135,33 @@ typedef int socket_protocol_t;
 #define MSG_PEEK        0x08
 #define MSG_WAITALL     0x10
 
+/**
+ * @brief Buffer used for scatter/gather input.
+ */
+struct iovec {
+    void   * iov_base;                                      /**< Start of the buffer. */
+    size_t   iov_len;                                       /**< Size of the buffer. */
+};
+
+#ifndef IOV_MAX
+#define IOV_MAX         16       /**< Largest number of buffers in the msg_iov array given to recvmsg(). */
+#endif
+
+/**
+ * @brief Message header used by recvmsg().
+ *
+ * @details Only msg_iov and msg_iovlen are used, other fields are provided for API compatibility.
+ */
+struct msghdr {
+    void         * msg_name;                                /**< Optional address. */
+    socklen_t      msg_namelen;                             /**< Size of the address. */
+    struct iovec * msg_iov;                                 /**< Scatter array. */
+    int            msg_iovlen;                              /**< Number of elements in msg_iov. */
+    void         * msg_control;                             /**< Ancillary data. */
+    socklen_t      msg_controllen;                          /**< Size of the ancillary data. */
+    int            msg_flags;                               /**< Flags on the received message. */
+};
+
 /**
  * @brief Generic socket address.
  *
@@ -235,12 +297,28 @@ ssize_t write(int sock, const void * p_buff, size_t nbytes);
  * @param[in]  sock     The socket to receive data from.
  * @param[out] p_buff   Buffer to hold data to be read.
  * @param[in]  nbytes   Number of bytes to read. Should NOT BE larger than the size of p_buff.
- * @param[in]  flags Flags to control send behavior.
+ * @param[in]  flags Flags to control send behavior. If MSG_PEEK is set, the data is left in the
+ *                   socket and returned again by the next receive.
  *
  * @retval The amount of bytes that was read, or -1 on error.
  */
 ssize_t recv(int sock, void * p_buff, size_t nbytes, int flags);
 
+/**
+ * @brief Receive data on a socket into several buffers.
+ *
+ * @details Same as \ref recv(), except that the data is scattered into the buffers described by
+ *          the msg_iov array of p_msg, filling each buffer in turn. msg_iovlen must be between 1
+ *          and IOV_MAX, else errno is set to EINVAL.
+ *
+ * @param[in]    sock     The socket to receive data from.
+ * @param[inout] p_msg    Message header describing the buffers to hold the data.
+ * @param[in]    flags    Flags to control receive behavior, see \ref recv().
+ *
+ * @retval The amount of bytes that was read, or -1 on error.
+ */
+ssize_t recvmsg(int sock, struct msghdr * p_msg, int flags);
+
 /**
  * @brief Read data from a socket. See \ref recv() for details.
  */
@@ -263,6 +341,10 @@ ssize_t read(int sock, void * p_buff, size_t nbytes);
  * @param[inout] p_exceptset   The set of descriptors for which to wait for exception events. Set to
  *                             NULL if not used.
  * @param[in]    timeout       The timeout to use for select call. Set to NULL if waiting forever.
+ *                             Timeouts longer than INT32_MAX milliseconds are shortened to that.
+ *
+ * @note Exceptional conditions are not supported, descriptors in p_exceptset are always cleared.
+ *       See \ref poll() for when a socket is ready.
  *
  * @retval The number of ready descriptors contained in the descriptor sets, or -1 on error.
  */
@@ -272,6 +354,25 @@ int select(int nfds,
            fd_set * p_exceptset,
            const struct timeval * timeout);
 
+/**
+ * @brief Wait for events on a set of sockets.
+ *
+ * @details Wait for any socket in p_fds to have any of the events requested in its events field.
+ *          The calling context sleeps until a socket changes, and only then are the requested
+ *          sockets evaluated again. A socket is readable while received data is queued or once the
+ *          remote end has closed the connection, and writable while the transport can accept
+ *          more data to send.
+ *
+ * @param[inout] p_fds      Array of descriptors and requested events. The revents field of each
+ *                          element is set to the events that occurred.
+ * @param[in]    nfds       Number of elements in p_fds.
+ * @param[in]    timeout    Timeout in milliseconds. 0 returns immediately, a negative value waits
+ *                          forever.
+ *
+ * @retval The number of elements with non-zero revents, 0 on timeout, or -1 on error.
+ */
+int poll(struct pollfd * p_fds, nfds_t nfds, int timeout);
+
 /**
  * @brief Set socket options for a given socket.
  *
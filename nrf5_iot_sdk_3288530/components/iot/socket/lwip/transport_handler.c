@@ -58,20 +58,7 @@ static lwip_handle_t lwip_handles[SOCKET_MAX_SOCKET_COUNT];
 APP_TIMER_DEF(m_lwip_timer_id);
 
 static err_t lwip_recv_callback(void * p_arg, struct tcp_pcb * p_pcb, struct pbuf * p_pbuf, err_t err);
-
-static uint8_t *
-mbuf_buf(mbuf_t * p_mbuf)
-{
-    struct pbuf * p_pbuf = (struct pbuf *)p_mbuf->p_ctx;
-    return p_pbuf->payload;
-}
-
-static uint32_t
-mbuf_buf_len(mbuf_t * p_mbuf)
-{
-    struct pbuf * p_pbuf = (struct pbuf *)p_mbuf->p_ctx;
-    return p_pbuf->len;
-}
+static err_t lwip_send_complete(void * p_arg, struct tcp_pcb * p_pcb, u16_t len);
 
 static void
 mbuf_freefn(void * p_ctx)
@@ -130,13 +117,14 @@ static lwip_handle_t * lwip_handle_allocate(socket_handle_t * p_socket_handle)
         if (lwip_handles[i].p_pcb == NULL)
         {
             p_handle = &lwip_handles[i];
-            mbuf_init(&p_socket_handle->mbuf_head, mbuf_buf, mbuf_buf_len, mbuf_freefn);
+            mbuf_init(&p_socket_handle->mbuf_head, mbuf_freefn);
             p_handle->p_pcb = tcp_new_ip6();
             p_handle->p_socket_handle = p_socket_handle;
             p_handle->tcp_state = TCP_STATE_IDLE;
             tcp_arg(p_handle->p_pcb, p_handle);
             tcp_setprio(p_handle->p_pcb, TCP_PRIO_MIN);
             tcp_recv(p_handle->p_pcb, lwip_recv_callback);
+            tcp_sent(p_handle->p_pcb, lwip_send_complete);
             break;
         }
     }
@@ -209,11 +197,26 @@ lwip_transport_close(socket_handle_t * p_socket_handle)
     err_t err_code = tcp_close(p_handle->p_pcb);
     if (err_code == ERR_OK)
     {
+        mbuf_flush(&p_socket_handle->mbuf_head);
         lwip_handle_free(p_handle);
     }
     return lwip_error_convert(err_code);
 }
 
+/**@brief Update the write readiness of the socket from the space in the send buffer. */
+static void
+lwip_write_ready_update(lwip_handle_t * p_handle)
+{
+    socket_handle_t * p_socket_handle = p_handle->p_socket_handle;
+    const bool write_ready = (p_handle->tcp_state != TCP_STATE_DISCONNECTED) &&
+                             (tcp_sndbuf(p_handle->p_pcb) > 0);
+    if (write_ready != p_socket_handle->write_ready)
+    {
+        p_socket_handle->write_ready = write_ready;
+        socket_readiness_update(p_socket_handle);
+    }
+}
+
 static err_t
 lwip_connect_callback(void * p_arg, struct tcp_pcb * p_pcb, err_t err)
 {
@@ -221,6 +224,56 @@ lwip_connect_callback(void * p_arg, struct tcp_pcb * p_pcb, err_t err)
     // TODO: Error check
     SOCKET_TRACE("Got connection callback with err %d\r\n", (int)err);
     p_handle->tcp_state = TCP_STATE_CONNECTED;
+    lwip_write_ready_update(p_handle);
+    return ERR_OK;
+}
+
+/**@brief Queue each pbuf of a received chain as a segment of the socket.
+ *
+ * @details Each segment holds a reference to its pbuf, so that the pbufs of the chain are freed
+ *          one by one as they are consumed. On failure, nothing is queued and the chain is left
+ *          untouched.
+ */
+static err_t
+lwip_recv_enqueue(mbuf_head_t * p_mbuf_head, struct pbuf * p_pbuf)
+{
+    mbuf_t      * p_first = NULL;
+    mbuf_t      * p_last  = NULL;
+    struct pbuf * p_seg;
+
+    for (p_seg = p_pbuf; p_seg != NULL; p_seg = p_seg->next)
+    {
+        mbuf_t * p_mbuf;
+        uint32_t err_code = mbuf_alloc(&p_mbuf, p_seg, p_seg->payload, p_seg->len);
+        if (err_code != NRF_SUCCESS)
+        {
+            while (p_first != NULL)
+            {
+                mbuf_t * p_next = p_first->p_next;
+                (void) nrf_free((uint8_t *)p_first);
+                p_first = p_next;
+            }
+            return ERR_MEM;
+        }
+        if (p_first == NULL)
+        {
+            p_first = p_mbuf;
+        }
+        else
+        {
+            p_last->p_next = p_mbuf;
+        }
+        p_last = p_mbuf;
+    }
+
+    // The reference to the head is handed over by lwIP. Take one to each pbuf that follows, as
+    // freeing a pbuf releases the reference it holds to the next pbuf of the chain.
+    for (p_seg = p_pbuf->next; p_seg != NULL; p_seg = p_seg->next)
+    {
+        pbuf_ref(p_seg);
+    }
+
+    mbuf_write(p_mbuf_head, p_first);
     return ERR_OK;
 }
 
@@ -229,31 +282,41 @@ lwip_recv_callback(void * p_arg, struct tcp_pcb * p_pcb, struct pbuf * p_pbuf, e
 {
     lwip_handle_t * p_handle = (lwip_handle_t *)p_arg;
     socket_handle_t * p_socket_handle = p_handle->p_socket_handle;
-    if (err == ERR_OK)
+    if (p_pbuf == NULL)
+    {
+        // Connection closed by the remote end.
+        p_handle->tcp_state = TCP_STATE_DISCONNECTED;
+        p_socket_handle->hangup = true;
+        p_socket_handle->write_ready = false;
+        socket_readiness_update(p_socket_handle);
+        err = ERR_OK;
+    }
+    else if (err == ERR_OK)
     {
-        if (mbuf_size_total(&p_socket_handle->mbuf_head) >= (RECV_BUFFER_MAX_SIZE - p_pbuf->len))
+        if ((mbuf_size_total(&p_socket_handle->mbuf_head) + p_pbuf->tot_len) >= RECV_BUFFER_MAX_SIZE)
         {
             err = ERR_MEM;
         }
         else
         {
-            mbuf_t * p_mbuf;
-            uint32_t err_code = mbuf_alloc(&p_mbuf, p_pbuf);
-            if (err_code == NRF_SUCCESS)
+            err = lwip_recv_enqueue(&p_socket_handle->mbuf_head, p_pbuf);
+            if (err == ERR_OK)
             {
-                mbuf_write(&p_socket_handle->mbuf_head, p_mbuf);
                 tcp_recved(p_handle->p_pcb, p_pbuf->tot_len);
                 p_socket_handle->read_events++;
-            }
-            else
-            {
-                err = ERR_MEM;
+                socket_readiness_update(p_socket_handle);
             }
         }
     }
     return err;
 }
 
+/**@brief Block until the connection reaches a state, or is disconnected.
+ *
+ * @details Unlike poll and select, no wait timer is used: blocking connect and send have no
+ *          time-out, as setsockopt is not implemented, and the state is set by the same lwIP
+ *          callbacks that wake the application up.
+ */
 static uint32_t
 lwip_wait_for_state(lwip_handle_t * p_handle, tcp_state_t state)
 {
@@ -353,6 +416,7 @@ lwip_send_complete(void * p_arg, struct tcp_pcb * p_pcb, u16_t len)
     {
         p_handle->tcp_state = TCP_STATE_DATA_TX_IN_PROGRESS;
     }
+    lwip_write_ready_update(p_handle);
     return ERR_OK;
 }
 
@@ -373,10 +437,10 @@ lwip_transport_send(socket_handle_t * p_socket_handle,
     uint32_t len = tcp_sndbuf(p_handle->p_pcb);
     if (len >= buf_len)
     {
-        tcp_sent(p_handle->p_pcb, lwip_send_complete);
         p_handle->tcp_state = TCP_STATE_TCP_SEND_PENDING;
         err_t err = tcp_write(p_handle->p_pcb, p_buf, buf_len, 1);
         err_code = lwip_error_convert(err);
+        lwip_write_ready_update(p_handle);
         if (err_code == NRF_SUCCESS &&
            (flags & MSG_DONTWAIT) == 0)
         {
@@ -17,6 +17,11 @@
  * @ingroup hci_transport
  *
  * @brief    This module implements the CRC-16 calculation in the blocks.
+ *
+ * @details  The CRC is computed using a 256-entry table, or a 16-entry table when
+ *           CRC16_TABLE_NIBBLE is defined, to save flash. Define CRC16_SLICE_BY to 4 or 8 to process
+ *           that many bytes per iteration for large buffers, at the cost of 512 bytes of flash
+ *           for each additional table.
  */
  
 #ifndef CRC16_H__
@@ -38,6 +43,34 @@
  */
 uint16_t crc16_compute(const uint8_t * p_data, uint32_t size, const uint16_t * p_crc);
 
+/**@brief CRC-16 computation context, for computing the CRC of data received in pieces. */
+typedef struct
+{
+    uint16_t crc;                                                                                   /**< CRC-16 value of the data so far. */
+} crc16_ctx_t;
+
+/**@brief Function for initializing a CRC-16 computation context.
+ *
+ * @param[out] p_ctx  Context to initialize.
+ */
+void crc16_init(crc16_ctx_t * p_ctx);
+
+/**@brief Function for adding a data block to a CRC-16 computation.
+ *
+ * @param[inout] p_ctx   Computation context.
+ * @param[in]    p_data  The input data block for computation.
+ * @param[in]    size    The size of the input data block in bytes.
+ */
+void crc16_update(crc16_ctx_t * p_ctx, const uint8_t * p_data, uint32_t size);
+
+/**@brief Function for getting the CRC-16 value of the data added to a computation context.
+ *
+ * @param[in] p_ctx  Computation context.
+ *
+ * @return The CRC-16 value, same as returned by @ref crc16_compute for the same data.
+ */
+uint16_t crc16_final(crc16_ctx_t const * p_ctx);
+
 #endif // CRC16_H__
  
 /** @} */
@@ -11,8 +11,10 @@
  */
 
 #include "app_fifo.h"
+#include <string.h>
 #include "nrf_error.h"
 #include "app_util.h"
+#include "nordic_common.h"
 
 /**
  * @brief Verify NULL parameters are not passed to an API by application.
@@ -50,6 +52,44 @@ static __INLINE void fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
 }
 
 
+/**@brief Copy bytes out of the FIFO, from the read position.
+ *
+ * @details The data occupies at most two contiguous spans of the buffer, the second one starting at
+ *          the beginning of the buffer when the data wraps around.
+ */
+static __INLINE void fifo_copy_out(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t size)
+{
+    const uint32_t index      = p_fifo->read_pos & p_fifo->buf_size_mask;
+    const uint32_t first_size = MIN(size, (uint32_t)p_fifo->buf_size_mask + 1 - index);
+
+    memcpy(p_byte_array, &p_fifo->p_buf[index], first_size);
+
+    if (size > first_size)
+    {
+        memcpy(&p_byte_array[first_size], p_fifo->p_buf, size - first_size);
+    }
+
+    p_fifo->read_pos += size;
+}
+
+
+/**@brief Copy bytes into the FIFO, at the write position. */
+static __INLINE void fifo_copy_in(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t size)
+{
+    const uint32_t index      = p_fifo->write_pos & p_fifo->buf_size_mask;
+    const uint32_t first_size = MIN(size, (uint32_t)p_fifo->buf_size_mask + 1 - index);
+
+    memcpy(&p_fifo->p_buf[index], p_byte_array, first_size);
+
+    if (size > first_size)
+    {
+        memcpy(p_fifo->p_buf, &p_byte_array[first_size], size - first_size);
+    }
+
+    p_fifo->write_pos += size;
+}
+
+
 uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
 {
     // Check buffer for null pointer.
@@ -112,7 +152,6 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
     
     const uint32_t byte_count    = fifo_length(p_fifo);
     const uint32_t requested_len = (*p_size);
-    uint32_t       index         = 0;
     uint32_t       read_size     = 0;
     
     (*p_size) = byte_count;
@@ -141,10 +180,7 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
     }
     
     // Fetch bytes from the FIFO.
-    do
-    {
-        fifo_get(p_fifo, &p_byte_array[index++]);
-    } while (index < read_size);
+    fifo_copy_out(p_fifo, p_byte_array, read_size);
     
     (*p_size) = read_size;
 
@@ -159,7 +195,6 @@ uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint3
     
     const uint32_t available_count = p_fifo->buf_size_mask - fifo_length(p_fifo) + 1;
     const uint32_t requested_len   = (*p_size);
-    uint32_t       index           = 0;
     uint32_t       write_size      = 0;
     
     (*p_size) = available_count;
@@ -187,13 +222,90 @@ uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint3
         write_size = available_count;
     }
     
-    //Fetch bytes from the FIFO.
-    do
-    {
-        fifo_put(p_fifo, p_byte_array[index++]);
-    } while (index < write_size);
+    // Put bytes in the FIFO.
+    fifo_copy_in(p_fifo, p_byte_array, write_size);
     
     (*p_size) = write_size;
 
     return NRF_SUCCESS;
 }
+
+
+uint32_t app_fifo_peek(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size)
+{
+    NULL_PARAM_CHECK(p_fifo);
+    NULL_PARAM_CHECK(pp_data);
+    NULL_PARAM_CHECK(p_size);
+
+    const uint32_t byte_count = fifo_length(p_fifo);
+    const uint32_t index      = p_fifo->read_pos & p_fifo->buf_size_mask;
+
+    (*p_size) = byte_count;
+
+    // Check if the FIFO is empty.
+    if (byte_count == 0)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    // Data up to the end of the buffer.
+    (*pp_data) = &p_fifo->p_buf[index];
+    (*p_size)  = MIN(byte_count, (uint32_t)p_fifo->buf_size_mask + 1 - index);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_consume(app_fifo_t * p_fifo, uint32_t size)
+{
+    NULL_PARAM_CHECK(p_fifo);
+
+    if (size > fifo_length(p_fifo))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->read_pos += size;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_space_get(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size)
+{
+    NULL_PARAM_CHECK(p_fifo);
+    NULL_PARAM_CHECK(pp_data);
+    NULL_PARAM_CHECK(p_size);
+
+    const uint32_t available_count = p_fifo->buf_size_mask - fifo_length(p_fifo) + 1;
+    const uint32_t index           = p_fifo->write_pos & p_fifo->buf_size_mask;
+
+    (*p_size) = available_count;
+
+    // Check if the FIFO is FULL.
+    if (available_count == 0)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    // Free space up to the end of the buffer.
+    (*pp_data) = &p_fifo->p_buf[index];
+    (*p_size)  = MIN(available_count, (uint32_t)p_fifo->buf_size_mask + 1 - index);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_commit(app_fifo_t * p_fifo, uint32_t size)
+{
+    NULL_PARAM_CHECK(p_fifo);
+
+    if (size > (p_fifo->buf_size_mask - fifo_length(p_fifo) + 1))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->write_pos += size;
+
+    return NRF_SUCCESS;
+}
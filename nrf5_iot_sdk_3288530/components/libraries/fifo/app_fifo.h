@@ -128,6 +128,64 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
  */
 uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size);
 
+/**@brief Function for getting the data in the FIFO without copying it.
+ *
+ * Data in the FIFO is held in at most two contiguous regions of the FIFO buffer. This function
+ * returns the region at the read position. When the data wraps around the end of the buffer, the
+ * second region is returned by calling this function again after @ref app_fifo_consume. Data
+ * remains in the FIFO until it is consumed.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[out] pp_data  Pointer to the first byte of the contiguous region. Must not be NULL.
+ * @param[out] p_size   Number of bytes in the contiguous region. Must not be NULL.
+ *
+ * @retval     NRF_SUCCESS          If the procedure is successful.
+ * @retval     NRF_ERROR_NULL       If a NULL parameter was passed for a parameter that must not
+ *                                  be NULL.
+ * @retval     NRF_ERROR_NOT_FOUND  If the FIFO is empty.
+ */
+uint32_t app_fifo_peek(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size);
+
+/**@brief Function for removing bytes from the FIFO after they were read using @ref app_fifo_peek.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[in]  size     Number of bytes to remove.
+ *
+ * @retval     NRF_SUCCESS               If the procedure is successful.
+ * @retval     NRF_ERROR_NULL            If a NULL parameter was passed for the FIFO.
+ * @retval     NRF_ERROR_INVALID_LENGTH  If size is larger than the number of bytes in the FIFO.
+ */
+uint32_t app_fifo_consume(app_fifo_t * p_fifo, uint32_t size);
+
+/**@brief Function for getting free space in the FIFO to be written without copying, for example
+ *        by EasyDMA.
+ *
+ * This function returns the contiguous free region at the write position. Bytes written to the
+ * region are added to the FIFO by @ref app_fifo_commit.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[out] pp_data  Pointer to the first byte of the contiguous region. Must not be NULL.
+ * @param[out] p_size   Number of bytes in the contiguous region. Must not be NULL.
+ *
+ * @retval     NRF_SUCCESS       If the procedure is successful.
+ * @retval     NRF_ERROR_NULL    If a NULL parameter was passed for a parameter that must not
+ *                               be NULL.
+ * @retval     NRF_ERROR_NO_MEM  If the FIFO is full.
+ */
+uint32_t app_fifo_space_get(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size);
+
+/**@brief Function for adding bytes written to the region returned by @ref app_fifo_space_get to
+ *        the FIFO.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[in]  size     Number of bytes to add.
+ *
+ * @retval     NRF_SUCCESS               If the procedure is successful.
+ * @retval     NRF_ERROR_NULL            If a NULL parameter was passed for the FIFO.
+ * @retval     NRF_ERROR_INVALID_LENGTH  If size is larger than the free space in the FIFO.
+ */
+uint32_t app_fifo_commit(app_fifo_t * p_fifo, uint32_t size);
+
 #endif // APP_FIFO_H__
 
 /** @} */
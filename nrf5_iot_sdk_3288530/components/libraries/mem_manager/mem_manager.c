@@ -9,6 +9,7 @@
  * the file.
  *
  */
+#include <inttypes.h>
 #include "sdk_config.h"
 #include "sdk_common.h"
 #include "mem_manager.h"
@@ -117,6 +118,19 @@
     } while (0)
 
 
+/**
+ * @brief Macro for verifying module's initialization status and returning NULL on failure.
+ */
+#define VERIFY_MODULE_INITIALIZED_NULL()                                \
+    do                                                                  \
+    {                                                                   \
+        if (!m_module_initialized)                                      \
+        {                                                               \
+            return NULL;                                                \
+        }                                                               \
+    } while (0)
+
+
 /**
  * @brief Macro for verifying requested size of memory does not exceed maximum block
  *       size supported by the module. Returning with appropriate error code on failure.
@@ -156,12 +170,21 @@
 #else  //MEM_MANAGER_DISABLE_API_PARAM_CHECK
 
 #define NULL_PARAM_CHECK(PARAM)
+#define NULL_PARAM_CHECK_VOID(PARAM)
 #define VERIFY_MODULE_INITIALIZED()
+#define VERIFY_MODULE_INITIALIZED_VOID()
+#define VERIFY_MODULE_INITIALIZED_NULL()
 #define VERIFY_REQUESTED_SIZE(SIZE)
 
 #endif //MEM_MANAGER_DISABLE_API_PARAM_CHECK
 
 
+/**@brief Number of allocation tags for which statistics are maintained. */
+#ifndef MEM_MANAGER_TAG_COUNT
+    #define MEM_MANAGER_TAG_COUNT              (NRF_MEM_TAG_APP + 1)
+#endif // MEM_MANAGER_TAG_COUNT
+
+
 /**@brief Setting defualts in case XXSmall block not used by application. */
 #ifndef MEMORY_MANAGER_XXSMALL_BLOCK_COUNT
     #define MEMORY_MANAGER_XXSMALL_BLOCK_COUNT 0
@@ -408,7 +431,7 @@
                            XXLARGE_MEMORY_SIZE)
 
 
-#define BLOCK_CAT_COUNT                7                                                            /**< Block category count is 7 (xxsmall, xsmall, small, medium, large, xlarge, xxlarge). Having one of the block count to zero has no impact on this count. */
+#define BLOCK_CAT_COUNT                NRF_MEM_BLOCK_CAT_COUNT                                      /**< Block category count is 7 (xxsmall, xsmall, small, medium, large, xlarge, xxlarge). Having one of the block count to zero has no impact on this count. */
 #define BLOCK_CAT_XXS                  0                                                            /**< Extra Extra Small category identifier. */
 #define BLOCK_CAT_XS                   1                                                            /**< Extra Small category identifier. */
 #define BLOCK_CAT_SMALL                2                                                            /**< Small category identifier. */
@@ -469,6 +492,14 @@ static const uint32_t m_block_mem_start[BLOCK_CAT_COUNT] =
     XXLARGE_MEMORY_START
 };
 
+/**@brief Lookup table for bit position of the least significant set bit, indexed by de Bruijn
+ *        sequence hash. Used to find first free block in a bitmap word in constant time. */
+static const uint8_t m_lsb_position[BITMAP_SIZE] =
+{
+    0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+    31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9
+};
+
 static uint8_t  m_memory[TOTAL_MEMORY_SIZE];                                                        /**< Memory managed by the module. */
 static uint32_t m_mem_pool[BLOCK_BITMAP_ARRAY_SIZE];                                                /**< Bitmap used for book-keeping availability of all blocks managed by the module.  */
 
@@ -486,6 +517,10 @@ static const char * m_block_desc_str[BLOCK_CAT_COUNT] =
     "XXLarge"
 };
 
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+
 /**@brief Table for book keeping smallest size allocated in each block range. */
 static uint32_t m_min_size[BLOCK_CAT_COUNT]  =
 {
@@ -501,12 +536,6 @@ static uint32_t m_min_size[BLOCK_CAT_COUNT]  =
 /**@brief Table for book keeping largest size allocated in each block range. */
 static uint32_t m_max_size[BLOCK_CAT_COUNT];
 
-/**@brief Global pointing to minimum size holder for block type being allocated. */
-static uint32_t * p_min_size;
-
-/**@brief Global pointing to maximum size holder for block type being allocated. */
-static uint32_t * p_max_size;
-
 /**@brief Lookup table for count of block available in each block category. */
 static uint32_t m_block_count[BLOCK_CAT_COUNT] =
 {
@@ -519,7 +548,28 @@ static uint32_t m_block_count[BLOCK_CAT_COUNT] =
     MEMORY_MANAGER_XXLARGE_BLOCK_COUNT
 };
 
-#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+/**@brief Table for book keeping number of blocks in use in each block category. */
+static uint32_t m_in_use[BLOCK_CAT_COUNT];
+
+/**@brief Table for book keeping largest number of blocks in use in each block category. */
+static uint32_t m_peak_in_use[BLOCK_CAT_COUNT];
+
+/**@brief Table for book keeping failed reservations for each requested block category. */
+static uint32_t m_failed_count[BLOCK_CAT_COUNT];
+
+/**@brief Table for book keeping bytes requested for blocks in use in each block category. */
+static uint32_t m_requested_bytes[BLOCK_CAT_COUNT];
+
+/**@brief Size requested by the user of each block currently in use. */
+static uint32_t m_block_requested_size[TOTAL_BLOCK_COUNT];
+
+/**@brief Tag identifying the user of each block currently in use. */
+static uint8_t m_block_tag[TOTAL_BLOCK_COUNT];
+
+/**@brief Statistics for each allocation tag. */
+static nrf_mem_tag_stats_t m_tag_stats[MEM_MANAGER_TAG_COUNT];
+
+#endif // MEM_MANAGER_ENABLE_STATISTICS
 
 SDK_MUTEX_DEFINE(m_mm_mutex)                                                                        /**< Mutex variable. Currently unused, this declaration does not occupy any space in RAM. */
 #if (MEM_MANAGER_DISABLE_API_PARAM_CHECK == 0)
@@ -580,21 +630,67 @@ static __INLINE uint32_t get_block_cat(uint32_t size, uint32_t block_index)
 }
 
 
-/**@brief Function to get the size of the block number 'block_index'. */
-static __INLINE uint32_t get_block_size(uint32_t block_index)
+/**@brief Function to get the memory offset of the block number 'block_index' in category
+ *        'block_cat'. */
+static __INLINE uint32_t get_block_memory_index(uint32_t block_cat, uint32_t block_index)
 {
-    const uint32_t block_cat = get_block_cat(0, block_index);
+    return (m_block_mem_start[block_cat] +
+            ((block_index - m_block_start[block_cat]) * m_block_size[block_cat]));
+}
+
+
+/**@brief Function to get the block number and category of the memory location 'p_mem'.
+ *
+ * @details The block is determined arithmetically from the offset of 'p_mem' in the managed
+ *          memory, no search of the block bitmap is needed.
+ *
+ * @param[in]  p_mem         Memory location to be resolved.
+ * @param[out] p_block_cat   Category of the block, if found.
+ * @param[out] p_block_index Block number, if found.
+ *
+ * @retval true  If 'p_mem' is the start address of a block managed by the module.
+ * @retval false Otherwise.
+ */
+static bool get_block_index(void * p_mem, uint32_t * p_block_cat, uint32_t * p_block_index)
+{
+    const uint8_t * p_addr = (const uint8_t *)p_mem;
+
+    if ((p_addr < &m_memory[0]) || (p_addr >= &m_memory[TOTAL_MEMORY_SIZE]))
+    {
+        return false;
+    }
 
-    #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
-        p_min_size = &m_min_size[block_cat];
-        p_max_size = &m_max_size[block_cat];
-    #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+    const uint32_t memory_index = (uint32_t)(p_addr - &m_memory[0]);
+    uint32_t       block_cat    = BLOCK_CAT_COUNT;
+
+    // Categories are laid out in increasing order in memory, the last category that begins at or
+    // before the offset contains the block.
+    while (block_cat-- > 0)
+    {
+        if ((m_block_end[block_cat] != m_block_start[block_cat]) &&
+            (memory_index >= m_block_mem_start[block_cat]))
+        {
+            const uint32_t cat_offset = memory_index - m_block_mem_start[block_cat];
 
-    return m_block_size[block_cat];
+            if ((cat_offset % m_block_size[block_cat]) != 0)
+            {
+                return false;
+            }
+
+            (*p_block_cat)   = block_cat;
+            (*p_block_index) = m_block_start[block_cat] + (cat_offset / m_block_size[block_cat]);
+
+            return true;
+        }
+    }
+
+    return false;
 }
 
 
-/**@brief Function to free the block identified by block number 'block_index'. */
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+
+/**@brief Function to check if the block identified by block number 'block_index' is free. */
 static bool is_block_free(uint32_t block_index)
 {
     uint32_t x;
@@ -607,6 +703,8 @@ static bool is_block_free(uint32_t block_index)
     return IS_SET(m_mem_pool[x], y);
 }
 
+#endif // MEM_MANAGER_ENABLE_STATISTICS
+
 
 /**@brief Function to allocate the block identified by block number 'block_index'. */
 static void block_allocate(uint32_t block_index)
@@ -622,6 +720,114 @@ static void block_allocate(uint32_t block_index)
 }
 
 
+/**@brief Function to find the first free block with block number greater than or equal to
+ *        'block_index'.
+ *
+ * @details Whole bitmap words are examined at a time and the free block within a word is located
+ *          using a de Bruijn sequence lookup, so the cost does not depend on number of blocks in
+ *          use.
+ *
+ * @retval Block number of the first free block, or TOTAL_BLOCK_COUNT if no block is free.
+ */
+static uint32_t free_block_find(uint32_t block_index)
+{
+    uint32_t x;
+    uint32_t y;
+
+    get_block_coordinates(block_index, &x, &y);
+
+    // Mask out blocks preceding the start block in the first word.
+    uint32_t word = m_mem_pool[x] & (0xFFFFFFFFU << y);
+
+    while (word == 0)
+    {
+        x++;
+        if (x >= BLOCK_BITMAP_ARRAY_SIZE)
+        {
+            return TOTAL_BLOCK_COUNT;
+        }
+        word = m_mem_pool[x];
+    }
+
+    // Isolate the least significant set bit and look up its position.
+    y = m_lsb_position[(uint32_t)((word & (0U - word)) * 0x077CB531U) >> 27];
+
+    return ((x * BITMAP_SIZE) + y);
+}
+
+
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+
+/**@brief Function to get the statistics of allocation tag 'tag'.
+ *
+ * @details Tags not within the configured range are accounted as @ref NRF_MEM_TAG_NONE.
+ */
+static __INLINE nrf_mem_tag_stats_t * get_tag_stats(uint8_t tag)
+{
+    if (tag >= MEM_MANAGER_TAG_COUNT)
+    {
+        tag = NRF_MEM_TAG_NONE;
+    }
+
+    return &m_tag_stats[tag];
+}
+
+
+/**@brief Function to update statistics on reservation of block 'block_index'. */
+static void stats_block_reserve(uint32_t block_cat,
+                                uint32_t block_index,
+                                uint32_t requested_size,
+                                uint8_t  tag)
+{
+    nrf_mem_tag_stats_t * p_tag_stats = get_tag_stats(tag);
+
+    m_min_size[block_cat] = MIN(m_min_size[block_cat], requested_size);
+    m_max_size[block_cat] = MAX(m_max_size[block_cat], requested_size);
+
+    m_in_use[block_cat]++;
+    m_peak_in_use[block_cat] = MAX(m_peak_in_use[block_cat], m_in_use[block_cat]);
+
+    m_requested_bytes[block_cat]       += requested_size;
+    m_block_requested_size[block_index] = requested_size;
+    m_block_tag[block_index]            = tag;
+
+    p_tag_stats->reserve_count++;
+    p_tag_stats->in_use++;
+    p_tag_stats->requested_bytes   += requested_size;
+    p_tag_stats->granted_bytes     += m_block_size[block_cat];
+    p_tag_stats->peak_in_use        = MAX(p_tag_stats->peak_in_use, p_tag_stats->in_use);
+    p_tag_stats->peak_granted_bytes = MAX(p_tag_stats->peak_granted_bytes,
+                                          p_tag_stats->granted_bytes);
+}
+
+
+/**@brief Function to update statistics on release of block 'block_index'. */
+static void stats_block_free(uint32_t block_cat, uint32_t block_index)
+{
+    nrf_mem_tag_stats_t * p_tag_stats = get_tag_stats(m_block_tag[block_index]);
+
+    m_in_use[block_cat]--;
+    m_requested_bytes[block_cat] -= m_block_requested_size[block_index];
+
+    p_tag_stats->in_use--;
+    p_tag_stats->requested_bytes -= m_block_requested_size[block_index];
+    p_tag_stats->granted_bytes   -= m_block_size[block_cat];
+
+    m_block_requested_size[block_index] = 0;
+    m_block_tag[block_index]            = NRF_MEM_TAG_NONE;
+}
+
+
+/**@brief Function to update statistics on failed reservation in category 'block_cat'. */
+static void stats_reserve_failure(uint32_t block_cat, uint8_t tag)
+{
+    m_failed_count[block_cat]++;
+    get_tag_stats(tag)->failed_count++;
+}
+
+#endif // MEM_MANAGER_ENABLE_STATISTICS
+
+
 uint32_t nrf_mem_init(void)
 {
     MM_LOG("[MM]: >> nrf_mem_init.\r\n");
@@ -641,8 +847,24 @@ uint32_t nrf_mem_init(void)
     m_module_initialized = true;
 #endif // MEM_MANAGER_DISABLE_API_PARAM_CHECK
 
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+    memset(m_in_use, 0, sizeof(m_in_use));
+    memset(m_peak_in_use, 0, sizeof(m_peak_in_use));
+    memset(m_failed_count, 0, sizeof(m_failed_count));
+    memset(m_requested_bytes, 0, sizeof(m_requested_bytes));
+    memset(m_block_requested_size, 0, sizeof(m_block_requested_size));
+    memset(m_block_tag, 0, sizeof(m_block_tag));
+    memset(m_tag_stats, 0, sizeof(m_tag_stats));
+
+    for (uint32_t block_cat = 0; block_cat < BLOCK_CAT_COUNT; block_cat++)
+    {
+        m_min_size[block_cat] = UINT32_MAX;
+        m_max_size[block_cat] = 0;
+    }
+#endif // MEM_MANAGER_ENABLE_STATISTICS
+
 #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
-        nrf_mem_diagnose();
+    nrf_mem_diagnose();
 #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
 
     MM_MUTEX_UNLOCK();
@@ -654,6 +876,12 @@ uint32_t nrf_mem_init(void)
 
 
 uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
+{
+    return nrf_mem_reserve_tagged(pp_buffer, p_size, NRF_MEM_TAG_NONE);
+}
+
+
+uint32_t nrf_mem_reserve_tagged(uint8_t ** pp_buffer, uint32_t * p_size, uint8_t tag)
 {
     VERIFY_MODULE_INITIALIZED();
     NULL_PARAM_CHECK(pp_buffer);
@@ -669,38 +897,35 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
 
     const uint32_t block_cat    = get_block_cat(requested_size, TOTAL_BLOCK_COUNT);
     uint32_t       block_index  = m_block_start[block_cat];
-    uint32_t       memory_index = m_block_mem_start[block_cat];
     uint32_t       err_code     = (NRF_ERROR_NO_MEM | MEMORY_MANAGER_ERR_BASE);
 
     MM_LOG("[MM]: Start index for the pool = 0x%08lX, total block count 0x%08X\r\n",
            block_index,
            TOTAL_BLOCK_COUNT);
 
-    for (; block_index < TOTAL_BLOCK_COUNT; block_index++)
-    {
-        uint32_t block_size = get_block_size(block_index);
+    // Look for a free block in the category, or in a larger one if the category is exhausted.
+    block_index = free_block_find(block_index);
 
-        if (is_block_free(block_index) == true)
-        {
-            MM_LOG("[MM]: Reserving block 0x%08lX\r\n", block_index);
+    if (block_index < TOTAL_BLOCK_COUNT)
+    {
+        const uint32_t alloc_cat = get_block_cat(0, block_index);
 
-            // Search succeeded, found free block.
-            err_code     = NRF_SUCCESS;
+        MM_LOG("[MM]: Reserving block 0x%08lX\r\n", block_index);
 
-            // Allocate block.
-            block_allocate(block_index);
+        // Search succeeded, found free block.
+        err_code     = NRF_SUCCESS;
 
-            (*pp_buffer) = &m_memory[memory_index];
-            (*p_size)    = block_size;
+        // Allocate block.
+        block_allocate(block_index);
 
-            #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
-                (*p_min_size) = MIN((*p_min_size), requested_size);
-                (*p_max_size) = MAX((*p_max_size), requested_size);
-            #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+        (*pp_buffer) = &m_memory[get_block_memory_index(alloc_cat, block_index)];
+        (*p_size)    = m_block_size[alloc_cat];
 
-            break;
-        }
-        memory_index += block_size;
+        #ifdef MEM_MANAGER_ENABLE_STATISTICS
+            stats_block_reserve(alloc_cat, block_index, requested_size, tag);
+        #else // MEM_MANAGER_ENABLE_STATISTICS
+            UNUSED_PARAMETER(tag);
+        #endif // MEM_MANAGER_ENABLE_STATISTICS
     }
     if (err_code != NRF_SUCCESS)
     {
@@ -708,6 +933,10 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
                 err_code,
                 (*p_size));
 
+        #ifdef MEM_MANAGER_ENABLE_STATISTICS
+        stats_reserve_failure(block_cat, tag);
+        #endif // MEM_MANAGER_ENABLE_STATISTICS
+
         #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
         nrf_mem_diagnose();
         #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
@@ -722,11 +951,17 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
 
 
 void * nrf_malloc(uint32_t size)
+{
+    return nrf_malloc_tagged(size, NRF_MEM_TAG_NONE);
+}
+
+
+void * nrf_malloc_tagged(uint32_t size, uint8_t tag)
 {
     uint8_t * buffer = NULL;
     uint32_t allocated_size = size;
 
-    uint32_t retval = nrf_mem_reserve(&buffer, &allocated_size);
+    uint32_t retval = nrf_mem_reserve_tagged(&buffer, &allocated_size, tag);
 
     if (retval != NRF_SUCCESS)
     {
@@ -769,19 +1004,21 @@ void nrf_free(void * p_mem)
 
     MM_MUTEX_LOCK();
 
-    uint32_t index;
-    uint32_t memory_index = 0;
+    uint32_t block_cat;
+    uint32_t block_index;
 
-    for (index = 0; index < TOTAL_BLOCK_COUNT; index++)
+    if (get_block_index(p_mem, &block_cat, &block_index) == true)
     {
-        if (&m_memory[memory_index] == p_mem)
+        MM_LOG("[MM]: << Freeing block 0x%08lx.\r\n", block_index);
+
+        #ifdef MEM_MANAGER_ENABLE_STATISTICS
+        if (is_block_free(block_index) == false)
         {
-            // Found a free block of memory, assign.
-            MM_LOG("[MM]: << Freeing block 0x%08lx.\r\n", index);
-            block_init(index);
-            break;
+            stats_block_free(block_cat, block_index);
         }
-        memory_index += get_block_size(index);
+        #endif // MEM_MANAGER_ENABLE_STATISTICS
+
+        block_init(block_index);
     }
 
     MM_MUTEX_UNLOCK();
@@ -793,7 +1030,74 @@ void nrf_free(void * p_mem)
 
 void * nrf_realloc(void * p_mem, uint32_t size)
 {
-    return p_mem;
+    uint32_t block_cat;
+    uint32_t block_index;
+
+    if (p_mem == NULL)
+    {
+        return nrf_malloc(size);
+    }
+
+    VERIFY_MODULE_INITIALIZED_NULL();
+
+    MM_LOG("[MM]: >> nrf_realloc %p, size 0x%04lX.\r\n", p_mem, size);
+
+    if ((size == 0) || (size > MAX_MEM_SIZE))
+    {
+        MM_LOG("[MM]: << nrf_realloc, invalid size.\r\n");
+        return NULL;
+    }
+
+    uint8_t tag = NRF_MEM_TAG_NONE;
+
+    MM_MUTEX_LOCK();
+
+    const bool is_valid = get_block_index(p_mem, &block_cat, &block_index);
+
+    #ifdef MEM_MANAGER_ENABLE_STATISTICS
+    if ((is_valid == true) && (size <= m_block_size[block_cat]))
+    {
+        // Block is resized in place, account for the new requested size.
+        const uint8_t block_tag = m_block_tag[block_index];
+
+        stats_block_free(block_cat, block_index);
+        stats_block_reserve(block_cat, block_index, size, block_tag);
+    }
+    else if (is_valid == true)
+    {
+        tag = m_block_tag[block_index];
+    }
+    #endif // MEM_MANAGER_ENABLE_STATISTICS
+
+    MM_MUTEX_UNLOCK();
+
+    if (is_valid == false)
+    {
+        MM_LOG("[MM]: << nrf_realloc, unknown block.\r\n");
+        return NULL;
+    }
+
+    const uint32_t block_size = m_block_size[block_cat];
+
+    if (size <= block_size)
+    {
+        // Current block is large enough, grow or trim in place.
+        MM_LOG("[MM]: << nrf_realloc, in place.\r\n");
+        return p_mem;
+    }
+
+    // Move the contents to a block large enough for the requested size.
+    void * p_new_mem = nrf_malloc_tagged(size, tag);
+
+    if (p_new_mem != NULL)
+    {
+        memcpy(p_new_mem, p_mem, block_size);
+        nrf_free(p_mem);
+    }
+
+    MM_LOG("[MM]: << nrf_realloc %p.\r\n", p_new_mem);
+
+    return p_new_mem;
 }
 
 
@@ -811,7 +1115,7 @@ void * nrf_realloc(void * p_mem, uint32_t size)
 void print_block_info(uint32_t block_cat, uint32_t * p_mem_in_use)
 {
     #define PRINT_COLUMN_WIDTH      13
-    #define PRINT_BUFFER_SIZE       80
+    #define PRINT_BUFFER_SIZE       120
     #define ASCII_VALUE_FOR_SPACE   32
 
     char           print_buffer[PRINT_BUFFER_SIZE];
@@ -844,33 +1148,45 @@ void print_block_info(uint32_t block_cat, uint32_t * p_mem_in_use)
         column_number++;
         snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
                  PRINT_COLUMN_WIDTH,
-                 "| %d",
+                 "| %" PRIu32,
                  m_block_size[block_cat]);
 
         column_number++;
         snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
                  PRINT_COLUMN_WIDTH,
-                 "| %d",
+                 "| %" PRIu32,
                  m_block_count[block_cat]);
 
         column_number++;
         snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
                  PRINT_COLUMN_WIDTH,
-                 "| %d",
+                 "| %" PRIu32,
                  num_of_blocks);
 
         column_number++;
         snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
                  PRINT_COLUMN_WIDTH,
-                 "| %d",
+                 "| %" PRIu32,
+                 m_peak_in_use[block_cat]);
+
+        column_number++;
+        snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
+                 PRINT_COLUMN_WIDTH,
+                 "| %" PRIu32,
                  m_min_size[block_cat]);
 
         column_number++;
         snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
                  PRINT_COLUMN_WIDTH,
-                 "| %d",
+                 "| %" PRIu32,
                  m_max_size[block_cat]);
 
+        column_number++;
+        snprintf(&print_buffer[column_number * PRINT_COLUMN_WIDTH],
+                 PRINT_COLUMN_WIDTH,
+                 "| %" PRIu32,
+                 m_failed_count[block_cat]);
+
         column_number++;
         const uint32_t column_end = (column_number * PRINT_COLUMN_WIDTH);
 
@@ -895,9 +1211,9 @@ void nrf_mem_diagnose(void)
     uint32_t in_use = 0;
 
     MMD_LOG ("\r\n");
-    MMD_LOG ("+------------+------------+------------+------------+------------+------------+\r\n");
-    MMD_LOG ("| Block      | Size       | Total      | In Use     | Min Alloc  | Max Alloc  |\r\n");
-    MMD_LOG ("+------------+------------+------------+------------+------------+------------+\r\n");
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
+    MMD_LOG ("| Block      | Size       | Total      | In Use     | Peak       | Min Alloc  | Max Alloc  | Failed     |\r\n");
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
 
     print_block_info(BLOCK_CAT_XXS, &in_use);
     print_block_info(BLOCK_CAT_XS, &in_use);
@@ -907,11 +1223,113 @@ void nrf_mem_diagnose(void)
     print_block_info(BLOCK_CAT_XL, &in_use);
     print_block_info(BLOCK_CAT_XXL, &in_use);
 
-    MMD_LOG ("+------------+------------+------------+------------+------------+------------+\r\n");
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
     MMD_LOG ("| Total      | %d      | %d        | %d\r\n",
             TOTAL_MEMORY_SIZE, TOTAL_BLOCK_COUNT,in_use);
-    MMD_LOG ("+------------+------------+------------+------------+------------+------------+\r\n");
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
+
+    MMD_LOG ("| Tag        | In Use     | Peak       | Requested  | Granted    | Peak Bytes | Reserved   | Failed     |\r\n");
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
+
+    for (uint32_t tag = 0; tag < MEM_MANAGER_TAG_COUNT; tag++)
+    {
+        const nrf_mem_tag_stats_t * p_stats = &m_tag_stats[tag];
+
+        // Only tags that have been used are listed.
+        if ((p_stats->reserve_count != 0) || (p_stats->failed_count != 0))
+        {
+            MMD_LOG ("| %-10" PRIu32 " | %-10" PRIu32 " | %-10" PRIu32 " | %-10" PRIu32
+                     " | %-10" PRIu32 " | %-10" PRIu32 " | %-10" PRIu32 " | %-10" PRIu32 " |\r\n",
+                     tag,
+                     p_stats->in_use,
+                     p_stats->peak_in_use,
+                     p_stats->requested_bytes,
+                     p_stats->granted_bytes,
+                     p_stats->peak_granted_bytes,
+                     p_stats->reserve_count,
+                     p_stats->failed_count);
+        }
+    }
+
+    MMD_LOG ("+------------+------------+------------+------------+------------+------------+------------+------------+\r\n");
 }
 
 #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+
+uint32_t nrf_mem_cat_stats_get(uint32_t block_cat, nrf_mem_cat_stats_t * p_stats)
+{
+    VERIFY_MODULE_INITIALIZED();
+    NULL_PARAM_CHECK(p_stats);
+
+    if (block_cat >= BLOCK_CAT_COUNT)
+    {
+        return (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE);
+    }
+
+    MM_MUTEX_LOCK();
+
+    p_stats->block_size      = m_block_size[block_cat];
+    p_stats->block_count     = m_block_count[block_cat];
+    p_stats->in_use          = m_in_use[block_cat];
+    p_stats->peak_in_use     = m_peak_in_use[block_cat];
+    p_stats->min_request     = m_min_size[block_cat];
+    p_stats->max_request     = m_max_size[block_cat];
+    p_stats->failed_count    = m_failed_count[block_cat];
+    p_stats->requested_bytes = m_requested_bytes[block_cat];
+    p_stats->granted_bytes   = m_in_use[block_cat] * m_block_size[block_cat];
+
+    MM_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_mem_tag_stats_get(uint8_t tag, nrf_mem_tag_stats_t * p_stats)
+{
+    VERIFY_MODULE_INITIALIZED();
+    NULL_PARAM_CHECK(p_stats);
+
+    if (tag >= MEM_MANAGER_TAG_COUNT)
+    {
+        return (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE);
+    }
+
+    MM_MUTEX_LOCK();
+
+    (*p_stats) = m_tag_stats[tag];
+
+    MM_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
+void nrf_mem_stats_reset(void)
+{
+    VERIFY_MODULE_INITIALIZED_VOID();
+
+    MM_MUTEX_LOCK();
+
+    for (uint32_t block_cat = 0; block_cat < BLOCK_CAT_COUNT; block_cat++)
+    {
+        m_peak_in_use[block_cat]  = m_in_use[block_cat];
+        m_failed_count[block_cat] = 0;
+        m_min_size[block_cat]     = UINT32_MAX;
+        m_max_size[block_cat]     = 0;
+    }
+
+    for (uint32_t tag = 0; tag < MEM_MANAGER_TAG_COUNT; tag++)
+    {
+        m_tag_stats[tag].peak_in_use        = m_tag_stats[tag].in_use;
+        m_tag_stats[tag].peak_granted_bytes = m_tag_stats[tag].granted_bytes;
+        m_tag_stats[tag].reserve_count      = 0;
+        m_tag_stats[tag].failed_count       = 0;
+    }
+
+    MM_MUTEX_UNLOCK();
+}
+
+#endif // MEM_MANAGER_ENABLE_STATISTICS
 /** @} */
@@ -35,6 +35,34 @@
 #define MEM_MANAGER_H__
 
 #include "sdk_common.h"
+#include "sdk_config.h"
+
+/**@brief Keep allocation statistics. They are always kept when MEM_MANAGER_ENABLE_DIAGNOSTICS is
+ *        defined, as the diagnostics print them. */
+#if defined(MEM_MANAGER_ENABLE_DIAGNOSTICS) && !defined(MEM_MANAGER_ENABLE_STATISTICS)
+#define MEM_MANAGER_ENABLE_STATISTICS
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
+#define NRF_MEM_BLOCK_CAT_COUNT 7                                                                   /**< Number of block categories managed by the module (xxsmall, xsmall, small, medium, large, xlarge, xxlarge). */
+
+/**
+ * @defgroup nrf_mem_tags Allocation tags.
+ *
+ * @details Tags identify the user of a memory block when memory is reserved using
+ *          @ref nrf_mem_reserve_tagged or @ref nrf_malloc_tagged. Statistics are maintained per tag
+ *          when MEM_MANAGER_ENABLE_STATISTICS is defined. Applications may use tags starting from
+ *          @ref NRF_MEM_TAG_APP, up to MEM_MANAGER_TAG_COUNT - 1.
+ * @{
+ */
+#define NRF_MEM_TAG_NONE        0                                                                   /**< Memory reserved without a tag. */
+#define NRF_MEM_TAG_COAP        1                                                                   /**< Memory reserved by CoAP. */
+#define NRF_MEM_TAG_MQTT        2                                                                   /**< Memory reserved by MQTT. */
+#define NRF_MEM_TAG_PBUFFER     3                                                                   /**< Memory reserved for IPv6 packet buffers, used by UDP6 and ICMP6. */
+#define NRF_MEM_TAG_DNS6        4                                                                   /**< Memory reserved by DNS6. */
+#define NRF_MEM_TAG_SOCKET      5                                                                   /**< Memory reserved by the socket layer. */
+#define NRF_MEM_TAG_FILE        6                                                                   /**< Memory reserved by IoT File. */
+#define NRF_MEM_TAG_APP         7                                                                   /**< First tag available to the application. */
+/** @} */
 
 
 /**@brief Initializes Memory Manager.
@@ -87,6 +115,32 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size);
 void * nrf_malloc(uint32_t size);
 
 
+/**@brief Reserves a block of memory for the user identified by a tag.
+ *
+ * @details Same as @ref nrf_mem_reserve, the block is additionally accounted to 'tag' in the
+ *          statistics of the module. The tag is ignored if MEM_MANAGER_ENABLE_STATISTICS is not
+ *          defined.
+ *
+ * @param[out]   pp_buffer  Pointer to the allocated memory block if memory allocation succeeds;
+ *                          otherwise points to NULL.
+ * @param[inout] p_size     Requested memory size. Returns the actual size allocated.
+ * @param[in]    tag        Tag identifying the user of the block, see @ref nrf_mem_tags.
+ *
+ * @retval  Same as @ref nrf_mem_reserve.
+ */
+uint32_t nrf_mem_reserve_tagged(uint8_t ** pp_buffer, uint32_t * p_size, uint8_t tag);
+
+
+/**@brief 'malloc' styled memory allocation function for the user identified by a tag.
+ *
+ * @param[in]  size  Requested memory size.
+ * @param[in]  tag   Tag identifying the user of the block, see @ref nrf_mem_tags.
+ *
+ * @retval     Valid memory location if the procedure was successful, else, NULL.
+ */
+void * nrf_malloc_tagged(uint32_t size, uint8_t tag);
+
+
 /**@brief 'calloc' styled memory allocation function.
  *
  * @details API to allocate zero-initialized memory of size count*size.
@@ -108,26 +162,93 @@ void * nrf_calloc(uint32_t nmemb, uint32_t size);
 void nrf_free(void * p_buffer);
 
 
-/**@brief Memory reallocation (trim) function.
+/**@brief Memory reallocation function - standard 'realloc' styled API.
  *
- * @details API to reallocate memory or to trim it. Trim is mentioned here to avoid use of API to
- *          request memory size larger than original memory allocated.
+ * @details API to resize a memory block. If the block currently holding the buffer is large enough
+ *          for the requested size, the same buffer is returned. Otherwise, a block of sufficient
+ *          size is reserved, contents of the original block are copied to it and the original
+ *          block is freed. If p_buffer is NULL, the API behaves as @ref nrf_malloc.
  *
- * @param[in] p_buffer   Pointer to the memory block that needs to be trimmed.
- * @param[in] size       Size of memory at the beginning of the buffer to be left untrimmed.
+ * @param[in] p_buffer   Pointer to the memory block that needs to be resized.
+ * @param[in] size       Requested memory size.
  *
- * @retval    Pointer to memory location with trimmed size, else, NULL.
+ * @retval    Pointer to memory location of requested size, else, NULL. On failure, the original
+ *            memory block is left untouched.
  */
 void * nrf_realloc(void *p_buffer, uint32_t size);
 
+#ifdef MEM_MANAGER_ENABLE_STATISTICS
+
+/**@brief Statistics of a block category. */
+typedef struct
+{
+    uint32_t block_size;                                                                            /**< Size of each block in the category. */
+    uint32_t block_count;                                                                           /**< Number of blocks in the category. Zero if the category is not used. */
+    uint32_t in_use;                                                                                /**< Number of blocks currently in use. */
+    uint32_t peak_in_use;                                                                           /**< Largest number of blocks in use at the same time. */
+    uint32_t min_request;                                                                           /**< Smallest size requested for a block in the category. UINT32_MAX if none was requested since initialization or the last reset. */
+    uint32_t max_request;                                                                           /**< Largest size requested for a block in the category. Zero if none was requested since initialization or the last reset. */
+    uint32_t failed_count;                                                                          /**< Number of reservations that failed for a requested size belonging to the category. */
+    uint32_t requested_bytes;                                                                       /**< Bytes requested for the blocks currently in use. */
+    uint32_t granted_bytes;                                                                         /**< Bytes granted for the blocks currently in use. The difference to requested_bytes is the internal fragmentation. */
+} nrf_mem_cat_stats_t;
+
+
+/**@brief Statistics of an allocation tag. */
+typedef struct
+{
+    uint32_t in_use;                                                                                /**< Number of blocks currently in use. */
+    uint32_t peak_in_use;                                                                           /**< Largest number of blocks in use at the same time. */
+    uint32_t requested_bytes;                                                                       /**< Bytes requested for the blocks currently in use. */
+    uint32_t granted_bytes;                                                                         /**< Bytes granted for the blocks currently in use. */
+    uint32_t peak_granted_bytes;                                                                    /**< Largest number of bytes granted at the same time. */
+    uint32_t reserve_count;                                                                         /**< Number of successful reservations. */
+    uint32_t failed_count;                                                                          /**< Number of failed reservations. */
+} nrf_mem_tag_stats_t;
+
+
+/**@brief Function to get statistics of a block category.
+ *
+ * @param[in]  block_cat  Block category, 0 (xxsmall) to NRF_MEM_BLOCK_CAT_COUNT - 1 (xxlarge).
+ * @param[out] p_stats    Statistics of the category.
+ *
+ * @retval NRF_SUCCESS             If the statistics were successfully read.
+ * @retval NRF_ERROR_INVALID_PARAM If the block category is not valid.
+ */
+uint32_t nrf_mem_cat_stats_get(uint32_t block_cat, nrf_mem_cat_stats_t * p_stats);
+
+
+/**@brief Function to get statistics of an allocation tag.
+ *
+ * @param[in]  tag      Allocation tag, see @ref nrf_mem_tags.
+ * @param[out] p_stats  Statistics of the tag.
+ *
+ * @retval NRF_SUCCESS             If the statistics were successfully read.
+ * @retval NRF_ERROR_INVALID_PARAM If the tag is not less than MEM_MANAGER_TAG_COUNT.
+ */
+uint32_t nrf_mem_tag_stats_get(uint8_t tag, nrf_mem_tag_stats_t * p_stats);
+
+
+/**@brief Function to reset statistics.
+ *
+ * @details Peak values are set to the current usage, and failure, reservation and request size
+ *          statistics are cleared. Blocks currently in use remain accounted.
+ */
+void nrf_mem_stats_reset(void);
+
+#endif // MEM_MANAGER_ENABLE_STATISTICS
+
 #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
 
+
 /**@brief Function to print statstics related to memory blocks managed by memory manager.
  *
  * @details This API prints information with respects to each block function, including size, total
- *          block count, number of blocks in use at the time of printing, smallest memory size
- *          allocated in the block and the largest one. This  API is intended to help developers
- *          tune the block sizes to make optimal use of memory for the application.
+ *          block count, number of blocks in use at the time of printing, peak number of blocks
+ *          in use, smallest memory size allocated in the block, the largest one, and number of
+ *          failed reservations. Usage of each allocation tag is printed as well. This API is
+ *          intended to help developers tune the block sizes to make optimal use of memory for the
+ *          application.
  *          This functionality is never needed in final application and therefore, is disabled by
  *          default.
  */
@@ -16,24 +16,50 @@
 #include <string.h>
 #include "nrf_soc.h"
 #include "nrf_assert.h"
+#include "nordic_common.h"
 #include "app_util.h"
 #include "app_util_platform.h"
 
+#if defined(APP_SCHEDULER_LOCK_FREE) && (__CORTEX_M < 0x03)
+#error "APP_SCHEDULER_LOCK_FREE requires exclusive access instructions (Cortex-M3 or later)."
+#endif // APP_SCHEDULER_LOCK_FREE
+
+#define EVENT_STATE_FREE      0                 /**< Queue entry is not in use, or has been claimed but is not yet committed. */
+#define EVENT_STATE_COMMITTED 1                 /**< Queue entry holds an event ready for execution. */
+#define EVENT_STATE_CANCELLED 2                 /**< Queue entry was reserved and cancelled, it is released without execution. */
+
 /**@brief Structure for holding a scheduled event header. */
 typedef struct
 {
     app_sched_event_handler_t handler;          /**< Pointer to event handler to receive the event. */
     uint16_t                  event_data_size;  /**< Size of event data. */
+    volatile uint8_t          state;            /**< State of the queue entry, see EVENT_STATE_FREE and EVENT_STATE_COMMITTED. */
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    uint32_t                  timestamp;        /**< Time at which the event was committed. */
+#endif // APP_SCHEDULER_WITH_PROFILER
 } event_header_t;
 
 STATIC_ASSERT(sizeof(event_header_t) <= APP_SCHED_EVENT_HEADER_SIZE);
 
-static event_header_t * m_queue_event_headers;  /**< Array for holding the queue event headers. */
-static uint8_t        * m_queue_event_data;     /**< Array for holding the queue event data. */
-static volatile uint8_t m_queue_start_index;    /**< Index of queue entry at the start of the queue. */
-static volatile uint8_t m_queue_end_index;      /**< Index of queue entry at the end of the queue. */
-static uint16_t         m_queue_event_size;     /**< Maximum event size in queue. */
-static uint16_t         m_queue_size;           /**< Number of queue entries. */
+/**@brief Structure for holding the state of the event queue of one priority level. */
+typedef struct
+{
+    event_header_t * p_event_headers;           /**< Array for holding the queue event headers. */
+    uint8_t        * p_event_data;              /**< Array for holding the queue event data. */
+    volatile uint8_t start_index;               /**< Index of queue entry at the start of the queue. */
+    volatile uint8_t end_index;                 /**< Index of queue entry at the end of the queue. */
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    app_sched_prio_stats_t stats;               /**< Statistics of the queue. */
+#endif // APP_SCHEDULER_WITH_PROFILER
+} sched_queue_t;
+
+static sched_queue_t    m_queues[APP_SCHED_PRIORITY_COUNT]; /**< Event queues, one per priority level. */
+static uint16_t         m_queue_event_size;                 /**< Maximum event size in queue. */
+static uint16_t         m_queue_size;                       /**< Number of queue entries. */
+
+#if defined(APP_SCHEDULER_WITH_PROFILER) || defined(APP_SCHEDULER_WITH_BUDGET)
+static app_sched_timestamp_get_t m_timestamp_get;           /**< Function for reading current time, NULL if not set. */
+#endif // APP_SCHEDULER_WITH_PROFILER || APP_SCHEDULER_WITH_BUDGET
 
 /**@brief Function for incrementing a queue index, and handle wrap-around.
  *
@@ -47,29 +73,110 @@ static __INLINE uint8_t next_index(uint8_t index)
 }
 
 
-static __INLINE uint8_t app_sched_queue_full()
+static __INLINE uint8_t app_sched_queue_full(sched_queue_t * p_queue)
 {
-  uint8_t tmp = m_queue_start_index;
-  return next_index(m_queue_end_index) == tmp;
+  uint8_t tmp = p_queue->start_index;
+  return next_index(p_queue->end_index) == tmp;
 }
 
 /**@brief Macro for checking if a queue is full. */
-#define APP_SCHED_QUEUE_FULL() app_sched_queue_full()
+#define APP_SCHED_QUEUE_FULL(P_QUEUE) app_sched_queue_full(P_QUEUE)
 
 
-static __INLINE uint8_t app_sched_queue_empty()
+static __INLINE uint8_t app_sched_queue_empty(sched_queue_t * p_queue)
 {
-  uint8_t tmp = m_queue_start_index;
-  return m_queue_end_index == tmp;
+  uint8_t tmp = p_queue->start_index;
+  return p_queue->end_index == tmp;
 }
 
 /**@brief Macro for checking if a queue is empty. */
-#define APP_SCHED_QUEUE_EMPTY() app_sched_queue_empty()
+#define APP_SCHED_QUEUE_EMPTY(P_QUEUE) app_sched_queue_empty(P_QUEUE)
+
+
+#if defined(APP_SCHEDULER_WITH_PROFILER) || defined(APP_SCHEDULER_WITH_BUDGET)
+
+/**@brief Function for getting current time, or 0 if no time source is set. */
+static __INLINE uint32_t timestamp_get(void)
+{
+    app_sched_timestamp_get_t timestamp_func = m_timestamp_get;
+
+    return (timestamp_func != NULL) ? timestamp_func() : 0;
+}
+
+#endif // APP_SCHEDULER_WITH_PROFILER || APP_SCHEDULER_WITH_BUDGET
+
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+
+
+/**@brief Function for getting number of events in a queue. */
+static __INLINE uint16_t queue_depth_get(sched_queue_t * p_queue)
+{
+    const uint8_t start_index = p_queue->start_index;
+    const uint8_t end_index   = p_queue->end_index;
+
+    return (end_index >= start_index) ? (end_index - start_index)
+                                      : ((m_queue_size + 1) - start_index + end_index);
+}
+
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+
+/**@brief Function for claiming the queue entry at the end of the queue.
+ *
+ * @details With APP_SCHEDULER_LOCK_FREE defined, the end index is advanced using exclusive
+ *          load/store, so that producers at any interrupt priority never need to disable
+ *          interrupts. An interrupt between the load and the store makes the store fail, and the
+ *          claim is retried. Otherwise, the end index is advanced in a critical region.
+ *
+ * @param[in]   p_queue         Queue in which to claim an entry.
+ * @param[out]  p_event_index   Index of the claimed queue entry.
+ *
+ * @return      NRF_SUCCESS on success, NRF_ERROR_NO_MEM if the queue is full.
+ */
+static uint32_t queue_entry_claim(sched_queue_t * p_queue, uint8_t * p_event_index)
+{
+#ifdef APP_SCHEDULER_LOCK_FREE
+    uint8_t end_index;
+
+    do
+    {
+        end_index = __LDREXB(&p_queue->end_index);
+
+        if (next_index(end_index) == p_queue->start_index)
+        {
+            __CLREX();
+            return NRF_ERROR_NO_MEM;
+        }
+    } while (__STREXB(next_index(end_index), &p_queue->end_index) != 0);
+
+    *p_event_index = end_index;
+
+    return NRF_SUCCESS;
+#else
+    uint32_t err_code = NRF_ERROR_NO_MEM;
+
+    CRITICAL_REGION_ENTER();
+
+    if (!APP_SCHED_QUEUE_FULL(p_queue))
+    {
+        *p_event_index     = p_queue->end_index;
+        p_queue->end_index = next_index(p_queue->end_index);
+        err_code           = NRF_SUCCESS;
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    return err_code;
+#endif // APP_SCHEDULER_LOCK_FREE
+}
 
 
 uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event_buffer)
 {
-    uint16_t data_start_index = (queue_size + 1) * sizeof(event_header_t);
+    const uint16_t headers_size = (queue_size + 1) * sizeof(event_header_t);
+    const uint16_t data_size    = (queue_size + 1) * event_size;
+    uint8_t      * p_buffer     = p_event_buffer;
 
     // Check that buffer is correctly aligned
     if (!is_word_aligned(p_event_buffer))
@@ -78,115 +185,311 @@ uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event
     }
 
     // Initialize event scheduler
-    m_queue_event_headers = p_event_buffer;
-    m_queue_event_data    = &((uint8_t *)p_event_buffer)[data_start_index];
-    m_queue_end_index     = 0;
-    m_queue_start_index   = 0;
-    m_queue_event_size    = event_size;
-    m_queue_size          = queue_size;
+    m_queue_event_size = event_size;
+    m_queue_size       = queue_size;
+
+    // The buffer is split in equally sized queues, one per priority level.
+    for (uint32_t priority = 0; priority < APP_SCHED_PRIORITY_COUNT; priority++)
+    {
+        sched_queue_t * p_queue = &m_queues[priority];
+
+        memset(p_queue, 0, sizeof(sched_queue_t));
+        memset(p_buffer, 0, headers_size);
+
+        p_queue->p_event_headers = (event_header_t *)p_buffer;
+        p_queue->p_event_data    = &p_buffer[headers_size];
+
+        // Keep each queue word aligned.
+        p_buffer += CEIL_DIV(headers_size + data_size, sizeof(uint32_t)) * sizeof(uint32_t);
+    }
 
     return NRF_SUCCESS;
 }
 
 
-uint32_t app_sched_event_put(void                    * p_event_data,
-                             uint16_t                  event_data_size,
-                             app_sched_event_handler_t handler)
+uint32_t app_sched_event_reserve_prio(uint16_t                  event_data_size,
+                                      app_sched_event_handler_t handler,
+                                      uint8_t                   priority,
+                                      app_sched_slot_t        * p_slot)
 {
-    uint32_t err_code;
+    uint32_t        err_code;
+    uint8_t         event_index;
+    sched_queue_t * p_queue;
 
-    if (event_data_size <= m_queue_event_size)
+    if (priority >= APP_SCHED_PRIORITY_COUNT)
     {
-        uint16_t event_index = 0xFFFF;
+        return NRF_ERROR_INVALID_PARAM;
+    }
 
-        CRITICAL_REGION_ENTER();
+    if (event_data_size > m_queue_event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
 
-        if (!APP_SCHED_QUEUE_FULL())
-        {
-            event_index       = m_queue_end_index;
-            m_queue_end_index = next_index(m_queue_end_index);
-        }
+    p_queue  = &m_queues[priority];
+    err_code = queue_entry_claim(p_queue, &event_index);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        // NOTE: The entry is not visible to the consumer until it is committed, so the header can
+        //       be written outside of the critical region.
+        p_queue->p_event_headers[event_index].handler         = handler;
+        p_queue->p_event_headers[event_index].event_data_size = event_data_size;
+
+        p_slot->p_event_data = &p_queue->p_event_data[event_index * m_queue_event_size];
+        p_slot->index        = event_index;
+        p_slot->priority     = priority;
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+        // NOTE: Statistics are updated without locking and may be inaccurate if producers at
+        //       different interrupt priorities reserve at the same time.
+        const uint16_t depth = queue_depth_get(p_queue);
+
+        p_queue->stats.put_count++;
+        p_queue->stats.max_depth = MAX(p_queue->stats.max_depth, depth);
+#endif // APP_SCHEDULER_WITH_PROFILER
+    }
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    else
+    {
+        p_queue->stats.drop_count++;
+    }
+#endif // APP_SCHEDULER_WITH_PROFILER
 
-        CRITICAL_REGION_EXIT();
+    return err_code;
+}
 
-        if (event_index != 0xFFFF)
-        {
-            // NOTE: This can be done outside the critical region since the event consumer will
-            //       always be called from the main loop, and will thus never interrupt this code.
-            m_queue_event_headers[event_index].handler = handler;
-            if ((p_event_data != NULL) && (event_data_size > 0))
-            {
-                memcpy(&m_queue_event_data[event_index * m_queue_event_size],
-                       p_event_data,
-                       event_data_size);
-                m_queue_event_headers[event_index].event_data_size = event_data_size;
-            }
-            else
-            {
-                m_queue_event_headers[event_index].event_data_size = 0;
-            }
 
-            err_code = NRF_SUCCESS;
-        }
-        else
-        {
-            err_code = NRF_ERROR_NO_MEM;
-        }
+uint32_t app_sched_event_reserve(uint16_t                  event_data_size,
+                                 app_sched_event_handler_t handler,
+                                 app_sched_slot_t        * p_slot)
+{
+    return app_sched_event_reserve_prio(event_data_size,
+                                        handler,
+                                        APP_SCHED_PRIORITY_HIGHEST,
+                                        p_slot);
+}
+
+
+void app_sched_event_commit(app_sched_slot_t const * p_slot)
+{
+    event_header_t * p_header = &m_queues[p_slot->priority].p_event_headers[p_slot->index];
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    p_header->timestamp = timestamp_get();
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+    p_header->state = EVENT_STATE_COMMITTED;
+}
+
+
+void app_sched_event_cancel(app_sched_slot_t const * p_slot)
+{
+    sched_queue_t * p_queue = &m_queues[p_slot->priority];
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    p_queue->stats.cancel_count++;
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+    p_queue->p_event_headers[p_slot->index].state = EVENT_STATE_CANCELLED;
+}
+
+
+uint32_t app_sched_event_put_prio(void                    * p_event_data,
+                                  uint16_t                  event_data_size,
+                                  app_sched_event_handler_t handler,
+                                  uint8_t                   priority)
+{
+    uint32_t         err_code;
+    app_sched_slot_t slot;
+
+    if ((p_event_data == NULL) || (event_data_size == 0))
+    {
+        event_data_size = 0;
     }
-    else
+
+    err_code = app_sched_event_reserve_prio(event_data_size, handler, priority, &slot);
+
+    if (err_code == NRF_SUCCESS)
     {
-        err_code = NRF_ERROR_INVALID_LENGTH;
+        if (event_data_size > 0)
+        {
+            memcpy(slot.p_event_data, p_event_data, event_data_size);
+        }
+
+        app_sched_event_commit(&slot);
     }
 
     return err_code;
 }
 
 
-/**@brief Function for reading the next event from specified event queue.
+uint32_t app_sched_event_put(void                    * p_event_data,
+                             uint16_t                  event_data_size,
+                             app_sched_event_handler_t handler)
+{
+    return app_sched_event_put_prio(p_event_data,
+                                    event_data_size,
+                                    handler,
+                                    APP_SCHED_PRIORITY_HIGHEST);
+}
+
+
+/**@brief Function for releasing the queue entry at the start of a queue. */
+static void app_sched_event_release(sched_queue_t * p_queue)
+{
+    const uint8_t event_index = p_queue->start_index;
+
+    p_queue->p_event_headers[event_index].state = EVENT_STATE_FREE;
+
+    // NOTE: Updating of (i.e. writing to) the start index is an atomic operation. The entry
+    //       becomes available to producers only after this point.
+    p_queue->start_index = next_index(event_index);
+}
+
+
+/**@brief Function for reading the next event from the event queues.
+ *
+ * @details Queues are examined in order of priority, and the first committed event found is
+ *          returned. The queue entry is not released, so that the event data remains valid while
+ *          the event handler executes. The entry must be released using
+ *          @ref app_sched_event_release once the handler returns.
  *
  * @param[out]  pp_event_data       Pointer to pointer to event data.
  * @param[out]  p_event_data_size   Pointer to size of event data.
  * @param[out]  p_event_handler     Pointer to event handler function pointer.
+ * @param[out]  pp_queue            Pointer to the queue holding the event.
+ *
+ *          Cancelled events found at the start of a queue are released.
  *
- * @return      NRF_SUCCESS if new event, NRF_ERROR_NOT_FOUND if event queue is empty.
+ * @return      NRF_SUCCESS if new event, NRF_ERROR_NOT_FOUND if all event queues are empty or the
+ *              events at the start of the queues have not been committed yet.
  */
 static uint32_t app_sched_event_get(void                     ** pp_event_data,
                                     uint16_t *                  p_event_data_size,
-                                    app_sched_event_handler_t * p_event_handler)
+                                    app_sched_event_handler_t * p_event_handler,
+                                    sched_queue_t            ** pp_queue)
 {
-    uint32_t err_code = NRF_ERROR_NOT_FOUND;
-
-    if (!APP_SCHED_QUEUE_EMPTY())
+    for (uint32_t priority = 0; priority < APP_SCHED_PRIORITY_COUNT; priority++)
     {
-        uint16_t event_index;
+        sched_queue_t * p_queue = &m_queues[priority];
+
+        // Cancelled events at the start of the queue are released without execution.
+        while (!APP_SCHED_QUEUE_EMPTY(p_queue) &&
+               (p_queue->p_event_headers[p_queue->start_index].state == EVENT_STATE_CANCELLED))
+        {
+            app_sched_event_release(p_queue);
+        }
+
+        if (!APP_SCHED_QUEUE_EMPTY(p_queue))
+        {
+            uint16_t event_index;
+
+            // NOTE: There is no need for a critical region here, as this function will only be
+            //       called from app_sched_execute() from inside the main loop, so it will never
+            //       interrupt app_sched_event_put(). Producers never modify the start index.
+            event_index = p_queue->start_index;
+
+            if (p_queue->p_event_headers[event_index].state == EVENT_STATE_COMMITTED)
+            {
+                *pp_event_data     = &p_queue->p_event_data[event_index * m_queue_event_size];
+                *p_event_data_size = p_queue->p_event_headers[event_index].event_data_size;
+                *p_event_handler   = p_queue->p_event_headers[event_index].handler;
+                *pp_queue          = p_queue;
 
-        // NOTE: There is no need for a critical region here, as this function will only be called
-        //       from app_sched_execute() from inside the main loop, so it will never interrupt
-        //       app_sched_event_put(). Also, updating of (i.e. writing to) the start index will be
-        //       an atomic operation.
-        event_index         = m_queue_start_index;
-        m_queue_start_index = next_index(m_queue_start_index);
+#ifdef APP_SCHEDULER_WITH_PROFILER
+                const uint32_t latency = timestamp_get() -
+                                         p_queue->p_event_headers[event_index].timestamp;
 
-        *pp_event_data     = &m_queue_event_data[event_index * m_queue_event_size];
-        *p_event_data_size = m_queue_event_headers[event_index].event_data_size;
-        *p_event_handler   = m_queue_event_headers[event_index].handler;
+                p_queue->stats.exec_count++;
+                p_queue->stats.total_latency += latency;
+                p_queue->stats.max_latency    = MAX(p_queue->stats.max_latency, latency);
+#endif // APP_SCHEDULER_WITH_PROFILER
 
-        err_code = NRF_SUCCESS;
+                return NRF_SUCCESS;
+            }
+        }
     }
 
-    return err_code;
+    return NRF_ERROR_NOT_FOUND;
 }
 
 
-void app_sched_execute(void)
+uint32_t app_sched_execute_budget(uint32_t max_events, uint32_t max_ticks)
 {
     void                    * p_event_data;
     uint16_t                  event_data_size;
     app_sched_event_handler_t event_handler;
+    sched_queue_t           * p_queue;
+    uint32_t                  event_count = 0;
+
+#ifdef APP_SCHEDULER_WITH_BUDGET
+    const uint32_t start_time = timestamp_get();
+#else
+    UNUSED_PARAMETER(max_ticks);
+#endif // APP_SCHEDULER_WITH_BUDGET
 
     // Get next event (if any), and execute handler
-    while ((app_sched_event_get(&p_event_data, &event_data_size, &event_handler) == NRF_SUCCESS))
+    while ((event_count < max_events) &&
+           (app_sched_event_get(&p_event_data, &event_data_size, &event_handler, &p_queue)
+            == NRF_SUCCESS))
     {
         event_handler(p_event_data, event_data_size);
+        app_sched_event_release(p_queue);
+        event_count++;
+
+#ifdef APP_SCHEDULER_WITH_BUDGET
+        if ((max_ticks != 0) && ((timestamp_get() - start_time) >= max_ticks))
+        {
+            break;
+        }
+#endif // APP_SCHEDULER_WITH_BUDGET
+    }
+
+    return event_count;
+}
+
+
+void app_sched_execute(void)
+{
+    UNUSED_VARIABLE(app_sched_execute_budget(UINT32_MAX, 0));
+}
+
+
+#if defined(APP_SCHEDULER_WITH_PROFILER) || defined(APP_SCHEDULER_WITH_BUDGET)
+
+void app_sched_timestamp_handler_set(app_sched_timestamp_get_t timestamp_func)
+{
+    m_timestamp_get = timestamp_func;
+}
+
+#endif // APP_SCHEDULER_WITH_PROFILER || APP_SCHEDULER_WITH_BUDGET
+
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+
+uint32_t app_sched_prio_stats_get(uint8_t priority, app_sched_prio_stats_t * p_stats)
+{
+    if ((priority >= APP_SCHED_PRIORITY_COUNT) || (p_stats == NULL))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    sched_queue_t * p_queue = &m_queues[priority];
+
+    (*p_stats)     = p_queue->stats;
+    p_stats->depth = queue_depth_get(p_queue);
+
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_stats_reset(void)
+{
+    for (uint32_t priority = 0; priority < APP_SCHED_PRIORITY_COUNT; priority++)
+    {
+        memset(&m_queues[priority].stats, 0, sizeof(app_sched_prio_stats_t));
     }
 }
+
+#endif // APP_SCHEDULER_WITH_PROFILER
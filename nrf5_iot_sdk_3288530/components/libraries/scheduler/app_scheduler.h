@@ -54,22 +54,63 @@
 #include "app_error.h"
 #include "app_util.h"
 
-#define APP_SCHED_EVENT_HEADER_SIZE 8       /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). */
+#ifdef APP_SCHEDULER_WITH_PROFILER
+#define APP_SCHED_EVENT_HEADER_SIZE (sizeof(void *) + 8)                                            /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). 12 on Cortex-M. */
+#else
+#define APP_SCHED_EVENT_HEADER_SIZE (CEIL_DIV(sizeof(void *) + 4, sizeof(void *)) * sizeof(void *)) /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). 8 on Cortex-M. */
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+#ifndef APP_SCHED_PRIORITY_COUNT
+#define APP_SCHED_PRIORITY_COUNT    1       /**< Number of event priority levels. Each level has its own queue of QUEUE_SIZE entries. */
+#endif // APP_SCHED_PRIORITY_COUNT
+
+#define APP_SCHED_PRIORITY_HIGHEST  0                                   /**< Highest event priority, used by @ref app_sched_event_put. */
+#define APP_SCHED_PRIORITY_LOWEST   (APP_SCHED_PRIORITY_COUNT - 1)      /**< Lowest event priority. */
 
 /**@brief Compute number of bytes required to hold the scheduler buffer.
  *
  * @param[in] EVENT_SIZE   Maximum size of events to be passed through the scheduler.
- * @param[in] QUEUE_SIZE   Number of entries in scheduler queue (i.e. the maximum number of events
- *                         that can be scheduled for execution).
+ * @param[in] QUEUE_SIZE   Number of entries in each scheduler queue (i.e. the maximum number of
+ *                         events of one priority that can be scheduled for execution).
  *
  * @return    Required scheduler buffer size (in bytes).
  */
 #define APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE)                                                 \
-            (((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1))
-            
+            (CEIL_DIV(((EVENT_SIZE) + APP_SCHED_EVENT_HEADER_SIZE) * ((QUEUE_SIZE) + 1),           \
+                      sizeof(uint32_t)) * sizeof(uint32_t) * APP_SCHED_PRIORITY_COUNT)
+
 /**@brief Scheduler event handler type. */
 typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
 
+/**@brief Queue entry reserved for an event, see @ref app_sched_event_reserve. */
+typedef struct
+{
+    void  * p_event_data;                   /**< Memory for the event data, valid until the event handler returns. */
+    uint8_t index;                          /**< Index of the queue entry. For internal use. */
+    uint8_t priority;                       /**< Priority of the event. For internal use. */
+} app_sched_slot_t;
+
+#if defined(APP_SCHEDULER_WITH_PROFILER) || defined(APP_SCHEDULER_WITH_BUDGET)
+/**@brief Function for reading the current time in ticks, see @ref app_sched_timestamp_handler_set.
+ */
+typedef uint32_t (*app_sched_timestamp_get_t)(void);
+#endif // APP_SCHEDULER_WITH_PROFILER || APP_SCHEDULER_WITH_BUDGET
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+/**@brief Statistics of the event queue of one priority level. */
+typedef struct
+{
+    uint16_t depth;                         /**< Number of events currently in the queue. */
+    uint16_t max_depth;                     /**< Largest number of events in the queue. */
+    uint32_t put_count;                     /**< Number of events scheduled. */
+    uint32_t drop_count;                    /**< Number of events rejected because the queue was full. */
+    uint32_t exec_count;                    /**< Number of events executed. */
+    uint32_t cancel_count;                  /**< Number of reserved events cancelled. */
+    uint32_t max_latency;                   /**< Largest time, in ticks, from commit of an event to execution of its handler. */
+    uint32_t total_latency;                 /**< Sum of the latency of all executed events, in ticks. */
+} app_sched_prio_stats_t;
+#endif // APP_SCHEDULER_WITH_PROFILER
+
 /**@brief Macro for initializing the event scheduler.
  *
  * @details It will also handle dimensioning and allocation of the memory buffer required by the
@@ -114,10 +155,29 @@ uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_e
 /**@brief Function for executing all scheduled events.
  *
  * @details This function must be called from within the main loop. It will execute all events
- *          scheduled since the last time it was called.
+ *          scheduled since the last time it was called. A queue entry is released only after its
+ *          event handler returns, so event data is never overwritten while it is being handled.
+ *          Events are executed in order of priority, and in FIFO order within a priority level.
  */
 void app_sched_execute(void);
 
+/**@brief Function for executing scheduled events within a budget.
+ *
+ * @details Same as @ref app_sched_execute, but returns once the given number of events has been
+ *          executed or, if APP_SCHEDULER_WITH_BUDGET is defined and a time source is set, once
+ *          the given time has elapsed. APP_SCHEDULER_WITH_BUDGET does not depend on
+ *          APP_SCHEDULER_WITH_PROFILER. The event with the highest priority is always executed
+ *          next, so that time-critical events are not delayed by a flood of lower priority events.
+ *
+ * @param[in]   max_events   Maximum number of events to execute.
+ * @param[in]   max_ticks    Time after which no further events are executed, in ticks of the
+ *                           function set by @ref app_sched_timestamp_handler_set. Zero for no time
+ *                           limit. Ignored if APP_SCHEDULER_WITH_BUDGET is not defined.
+ *
+ * @return      Number of events executed.
+ */
+uint32_t app_sched_execute_budget(uint32_t max_events, uint32_t max_ticks);
+
 /**@brief Function for scheduling an event.
  *
  * @details Puts an event into the event queue.
@@ -132,6 +192,117 @@ uint32_t app_sched_event_put(void *                    p_event_data,
                              uint16_t                  event_size,
                              app_sched_event_handler_t handler);
 
+/**@brief Function for scheduling an event with a given priority.
+ *
+ * @details Same as @ref app_sched_event_put, the event is put into the queue of the given
+ *          priority level.
+ *
+ * @param[in]   p_event_data   Pointer to event data to be scheduled.
+ * @param[in]   event_size     Size of event data to be scheduled.
+ * @param[in]   handler        Event handler to receive the event.
+ * @param[in]   priority       Priority of the event, APP_SCHED_PRIORITY_HIGHEST to
+ *                             APP_SCHED_PRIORITY_LOWEST.
+ *
+ * @return      NRF_SUCCESS on success, otherwise an error code.
+ */
+uint32_t app_sched_event_put_prio(void *                    p_event_data,
+                                  uint16_t                  event_size,
+                                  app_sched_event_handler_t handler,
+                                  uint8_t                   priority);
+
+/**@brief Function for reserving a queue entry for an event.
+ *
+ * @details Reserves a queue entry so that the event data can be written directly into the
+ *          scheduler queue, without an intermediate copy. The event is not executed until it is
+ *          committed using @ref app_sched_event_commit. The event data memory remains valid until
+ *          the event handler returns.
+ *
+ *          If APP_SCHEDULER_LOCK_FREE is defined, reservation is done using exclusive load/store
+ *          instead of a critical region, and the function can be used from any interrupt priority
+ *          without disabling interrupts.
+ *
+ * @note Events are executed in the order they were reserved. An event that is reserved but not
+ *       committed holds back execution of events reserved after it, so the commit should follow
+ *       the reservation closely, typically within the same interrupt handler. An event that is
+ *       not going to be committed must be cancelled using @ref app_sched_event_cancel.
+ *
+ * @param[in]   event_data_size   Size of event data to be scheduled.
+ * @param[in]   handler           Event handler to receive the event.
+ * @param[out]  p_slot            Reserved queue entry.
+ *
+ * @retval      NRF_SUCCESS                If the queue entry was reserved.
+ * @retval      NRF_ERROR_INVALID_LENGTH   If event_data_size exceeds the maximum event size.
+ * @retval      NRF_ERROR_NO_MEM           If the queue is full.
+ */
+uint32_t app_sched_event_reserve(uint16_t                  event_data_size,
+                                 app_sched_event_handler_t handler,
+                                 app_sched_slot_t        * p_slot);
+
+/**@brief Function for reserving a queue entry for an event with a given priority.
+ *
+ * @details Same as @ref app_sched_event_reserve, the entry is reserved in the queue of the given
+ *          priority level.
+ *
+ * @param[in]   event_data_size   Size of event data to be scheduled.
+ * @param[in]   handler           Event handler to receive the event.
+ * @param[in]   priority          Priority of the event, APP_SCHED_PRIORITY_HIGHEST to
+ *                                APP_SCHED_PRIORITY_LOWEST.
+ * @param[out]  p_slot            Reserved queue entry.
+ *
+ * @retval      NRF_SUCCESS                If the queue entry was reserved.
+ * @retval      NRF_ERROR_INVALID_PARAM    If the priority is not valid.
+ * @retval      NRF_ERROR_INVALID_LENGTH   If event_data_size exceeds the maximum event size.
+ * @retval      NRF_ERROR_NO_MEM           If the queue is full.
+ */
+uint32_t app_sched_event_reserve_prio(uint16_t                  event_data_size,
+                                      app_sched_event_handler_t handler,
+                                      uint8_t                   priority,
+                                      app_sched_slot_t        * p_slot);
+
+/**@brief Function for committing an event reserved using @ref app_sched_event_reserve.
+ *
+ * @details After this call, the event is executed by @ref app_sched_execute.
+ *
+ * @param[in]   p_slot   Queue entry returned by @ref app_sched_event_reserve.
+ */
+void app_sched_event_commit(app_sched_slot_t const * p_slot);
+
+/**@brief Function for cancelling an event reserved using @ref app_sched_event_reserve.
+ *
+ * @details Use this function instead of @ref app_sched_event_commit when the producer aborts after
+ *          reserving, for example because the data for the event could not be read. The handler of
+ *          the event is not called. The queue entry is released when @ref app_sched_execute
+ *          reaches it, so events reserved after it are no longer held back.
+ *
+ * @param[in]   p_slot   Queue entry returned by @ref app_sched_event_reserve.
+ */
+void app_sched_event_cancel(app_sched_slot_t const * p_slot);
+
+#if defined(APP_SCHEDULER_WITH_PROFILER) || defined(APP_SCHEDULER_WITH_BUDGET)
+/**@brief Function for setting the time source used for latency measurement and time budgets.
+ *
+ * @param[in]   timestamp_func   Function returning the current time in ticks, as a counter that
+ *                               wraps around at 2^32. NULL to disable time measurement.
+ */
+void app_sched_timestamp_handler_set(app_sched_timestamp_get_t timestamp_func);
+#endif // APP_SCHEDULER_WITH_PROFILER || APP_SCHEDULER_WITH_BUDGET
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+
+/**@brief Function for getting statistics of the event queue of a priority level.
+ *
+ * @param[in]   priority   Priority level.
+ * @param[out]  p_stats    Statistics of the queue.
+ *
+ * @retval      NRF_SUCCESS               On success.
+ * @retval      NRF_ERROR_INVALID_PARAM   If the priority is not valid or p_stats is NULL.
+ */
+uint32_t app_sched_prio_stats_get(uint8_t priority, app_sched_prio_stats_t * p_stats);
+
+/**@brief Function for clearing statistics of all event queues. */
+void app_sched_stats_reset(void);
+#endif // APP_SCHEDULER_WITH_PROFILER
+
 #ifdef APP_SCHEDULER_WITH_PAUSE
 /**@brief A function to pause the scheduler.
  *
@@ -12,10 +12,12 @@
 
 #include "app_timer.h"
 #include <stdlib.h>
+#include <string.h>
 #include "nrf.h"
 #include "nrf_soc.h"
 #include "app_error.h"
 #include "nrf_delay.h"
+#include "nordic_common.h"
 #include "app_util.h"
 #include "app_util_platform.h"
 
@@ -57,6 +59,10 @@ typedef struct
     app_timer_timeout_handler_t p_timeout_handler;                          /**< Pointer to function to be executed when the timer expires. */
     void *                      p_context;                                  /**< General purpose pointer. Will be passed to the timeout handler when the timer expires. */
     void *                      next;                                       /**< Pointer to the next node. */
+#ifdef APP_TIMER_WITH_WHEEL
+    void *                      prev;                                       /**< Pointer to the previous node in the timer wheel slot, NULL if first. */
+    void *                      p_wheel_slot;                               /**< Timer wheel slot holding the node, NULL if not in the timer wheel. */
+#endif // APP_TIMER_WITH_WHEEL
 } timer_node_t;
 
 STATIC_ASSERT(sizeof(timer_node_t) == APP_TIMER_NODE_SIZE);
@@ -133,7 +139,33 @@ static uint8_t                       m_ticks_elapsed_q_write_ind;
 static app_timer_evt_schedule_func_t m_evt_schedule_func;                       /**< Pointer to function for propagating timeout events to the scheduler. */
 static bool                          m_rtc1_running;                            /**< Boolean indicating if RTC1 is running. */
 static bool                          m_rtc1_reset;                              /**< Boolean indicating if RTC1 counter has been reset due to last timer removed from timer list during the timer list handling. */
- 
+
+#ifdef APP_TIMER_WITH_WHEEL
+
+#define WHEEL_SLOT_BITS         5                                           /**< Number of bits of expiry time resolved by each level of the timer wheel. */
+#define WHEEL_SLOT_COUNT        (1UL << WHEEL_SLOT_BITS)                    /**< Number of slots in each level of the timer wheel. */
+#define WHEEL_SLOT_MASK         (WHEEL_SLOT_COUNT - 1)                      /**< Mask for slot index in a level of the timer wheel. */
+#define WHEEL_LEVEL_COUNT       5                                           /**< Number of levels of the timer wheel, covering timeouts up to 2^25 ticks. */
+
+STATIC_ASSERT(WHEEL_SLOT_COUNT == 32);
+STATIC_ASSERT((WHEEL_SLOT_BITS * WHEEL_LEVEL_COUNT) > 24);
+
+/**@brief Lookup table for bit position of the least significant set bit, indexed by de Bruijn
+ *        sequence hash. */
+static const uint8_t m_lsb_position[WHEEL_SLOT_COUNT] =
+{
+    0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+    31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9
+};
+
+static timer_node_t * m_wheel_slots[WHEEL_LEVEL_COUNT][WHEEL_SLOT_COUNT];      /**< Lists of running timers, per timer wheel level and slot. */
+static uint32_t       m_wheel_bitmap[WHEEL_LEVEL_COUNT];                       /**< Bitmap of non-empty slots in each timer wheel level. */
+static uint32_t       m_wheel_slot_expiry[WHEEL_LEVEL_COUNT - 1][WHEEL_SLOT_COUNT]; /**< Earliest expiry time of the timers added to each slot of the higher timer wheel levels since the slot was last empty. Not updated when timers are removed, hence a lower bound. */
+static uint32_t       m_wheel_time;                                            /**< Current time of the timer wheel. Corresponds to m_ticks_latest, but does not wrap at the RTC counter width. */
+static uint32_t       m_wheel_timer_count;                                     /**< Number of timers in the timer wheel. */
+
+#endif // APP_TIMER_WITH_WHEEL
+
 
 /**@brief Function for initializing the RTC1 counter.
  *
@@ -214,6 +246,312 @@ static __INLINE void rtc1_compare0_set(uint32_t value)
 }
 
 
+#ifdef APP_TIMER_WITH_WHEEL
+
+/**@brief Function for getting the index of the least significant set bit in a non-zero word. */
+static __INLINE uint32_t lsb_index_get(uint32_t word)
+{
+    return m_lsb_position[(uint32_t)((word & (0U - word)) * 0x077CB531U) >> 27];
+}
+
+
+/**@brief Function for getting the mask of slots following slot 'index' in a timer wheel level. */
+static __INLINE uint32_t wheel_slots_after_mask_get(uint32_t index)
+{
+    return (index == WHEEL_SLOT_MASK) ? 0 : (0xFFFFFFFFU << (index + 1));
+}
+
+
+/**@brief Function for adding a timer to the timer wheel.
+ *
+ * @details The level is chosen so that the slot of the timer is reached before the timer expires.
+ *          Timers expiring within WHEEL_SLOT_COUNT ticks are put in the first level, where each slot
+ *          corresponds to one tick. In higher levels, each slot covers WHEEL_SLOT_COUNT slots of the
+ *          level below, and timers are moved down a level when their slot is reached.
+ *
+ * @param[in]  p_timer   Timer to add, with ticks_to_expire holding its expiry time in timer wheel
+ *                       time.
+ */
+static void wheel_link(timer_node_t * p_timer)
+{
+    const uint32_t ticks_to_expire = p_timer->ticks_to_expire - m_wheel_time;
+    uint32_t       level           = 0;
+
+    while ((level < (WHEEL_LEVEL_COUNT - 1)) &&
+           (ticks_to_expire >= (1UL << (WHEEL_SLOT_BITS * (level + 1)))))
+    {
+        level++;
+    }
+
+    const uint32_t   index  = (p_timer->ticks_to_expire >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+    timer_node_t  ** p_slot = &m_wheel_slots[level][index];
+
+    if (level != 0)
+    {
+        uint32_t * p_slot_expiry = &m_wheel_slot_expiry[level - 1][index];
+
+        if ((*p_slot == NULL) || (ticks_to_expire < (*p_slot_expiry - m_wheel_time)))
+        {
+            *p_slot_expiry = p_timer->ticks_to_expire;
+        }
+    }
+
+    p_timer->prev         = NULL;
+    p_timer->next         = *p_slot;
+    p_timer->p_wheel_slot = p_slot;
+
+    if (*p_slot != NULL)
+    {
+        (*p_slot)->prev = p_timer;
+    }
+    *p_slot = p_timer;
+
+    SET_BIT(m_wheel_bitmap[level], index);
+
+    m_wheel_timer_count++;
+}
+
+
+/**@brief Function for removing a timer from the timer wheel, if present.
+ *
+ * @param[in]  p_timer   Timer to remove.
+ */
+static void wheel_unlink(timer_node_t * p_timer)
+{
+    timer_node_t ** p_slot = p_timer->p_wheel_slot;
+
+    if (p_slot == NULL)
+    {
+        return;
+    }
+
+    if (p_timer->prev != NULL)
+    {
+        ((timer_node_t *)p_timer->prev)->next = p_timer->next;
+    }
+    else
+    {
+        *p_slot = p_timer->next;
+    }
+
+    if (p_timer->next != NULL)
+    {
+        ((timer_node_t *)p_timer->next)->prev = p_timer->prev;
+    }
+
+    if (*p_slot == NULL)
+    {
+        const uint32_t slot_number = (uint32_t)(p_slot - &m_wheel_slots[0][0]);
+
+        CLR_BIT(m_wheel_bitmap[slot_number / WHEEL_SLOT_COUNT], slot_number % WHEEL_SLOT_COUNT);
+    }
+
+    p_timer->next         = NULL;
+    p_timer->prev         = NULL;
+    p_timer->p_wheel_slot = NULL;
+
+    m_wheel_timer_count--;
+}
+
+
+/**@brief Function for detaching all timers in a timer wheel slot.
+ *
+ * @return     List of the timers that were in the slot, linked through the next pointer.
+ */
+static timer_node_t * wheel_slot_detach(uint32_t level, uint32_t index)
+{
+    timer_node_t * p_head  = m_wheel_slots[level][index];
+    timer_node_t * p_timer = p_head;
+
+    m_wheel_slots[level][index] = NULL;
+    CLR_BIT(m_wheel_bitmap[level], index);
+
+    while (p_timer != NULL)
+    {
+        p_timer->prev         = NULL;
+        p_timer->p_wheel_slot = NULL;
+        p_timer               = p_timer->next;
+
+        m_wheel_timer_count--;
+    }
+
+    return p_head;
+}
+
+
+/**@brief Function for getting the number of ticks from current timer wheel time until the next
+ *        slot of the timer wheel holding timers is reached.
+ *
+ * @param[in]  to_expiry   If TRUE, return ticks until the earliest expiry of the timers in a higher
+ *                         level slot instead of until the slot is reached, so that the RTC1
+ *                         compare event is not set earlier than needed.
+ *
+ * @note   The timer wheel must not be empty.
+ */
+static uint32_t wheel_next_expiry_get(bool to_expiry)
+{
+    uint32_t ticks_min = 0xFFFFFFFF;
+    uint32_t level;
+
+    // Timers in the first level expiring in the current rotation.
+    const uint32_t index   = m_wheel_time & WHEEL_SLOT_MASK;
+    const uint32_t pending = m_wheel_bitmap[0] & (0xFFFFFFFFU << index);
+
+    if (pending != 0)
+    {
+        return (lsb_index_get(pending) - index);
+    }
+
+    for (level = 0; level < WHEEL_LEVEL_COUNT; level++)
+    {
+        const uint32_t shift        = WHEEL_SLOT_BITS * level;
+        const uint32_t level_index  = (m_wheel_time >> shift) & WHEEL_SLOT_MASK;
+        const uint32_t bitmap       = m_wheel_bitmap[level];
+        const uint32_t bitmap_after = bitmap & wheel_slots_after_mask_get(level_index);
+        uint32_t       distance;
+
+        if (bitmap == 0)
+        {
+            continue;
+        }
+
+        // Slots following the current one are reached in the current rotation of the level, the
+        // others in the next rotation.
+        if (bitmap_after != 0)
+        {
+            distance = lsb_index_get(bitmap_after) - level_index;
+        }
+        else
+        {
+            distance = lsb_index_get(bitmap) + WHEEL_SLOT_COUNT - level_index;
+        }
+
+        if (to_expiry && (level != 0))
+        {
+            const uint32_t slot_index = (level_index + distance) & WHEEL_SLOT_MASK;
+
+            ticks_min = MIN(ticks_min, m_wheel_slot_expiry[level - 1][slot_index] - m_wheel_time);
+        }
+        else
+        {
+            ticks_min = MIN(ticks_min,
+                            ((((m_wheel_time >> shift) + distance) << shift) - m_wheel_time));
+        }
+    }
+
+    return ticks_min;
+}
+
+
+/**@brief Function for moving timers down the timer wheel when a slot of a higher level is reached.
+ *
+ * @note   Must be called when the current timer wheel time is at the start of a rotation of the
+ *         first level.
+ */
+static void wheel_cascade(void)
+{
+    uint32_t level;
+
+    for (level = 1; level < WHEEL_LEVEL_COUNT; level++)
+    {
+        const uint32_t index   = (m_wheel_time >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+        timer_node_t * p_timer = wheel_slot_detach(level, index);
+
+        while (p_timer != NULL)
+        {
+            timer_node_t * p_next = p_timer->next;
+
+            wheel_link(p_timer);
+            p_timer = p_next;
+        }
+
+        // Next level is only reached when this level starts a new rotation.
+        if (index != 0)
+        {
+            break;
+        }
+    }
+}
+
+
+static void timeout_handler_exec(timer_node_t * p_timer);
+
+
+/**@brief Function for expiring timers in the slot of the first level of the timer wheel
+ *        corresponding to the current timer wheel time.
+ *
+ * @details Repeating timers are added back to the timer wheel before the timeout handler is
+ *          executed, so that the handler can stop them.
+ */
+static void wheel_slot_expire(void)
+{
+    timer_node_t * p_timer = wheel_slot_detach(0, m_wheel_time & WHEEL_SLOT_MASK);
+
+    while (p_timer != NULL)
+    {
+        timer_node_t * p_next = p_timer->next;
+
+        p_timer->next = NULL;
+
+        if (p_timer->is_running)
+        {
+            if (p_timer->ticks_periodic_interval != 0)
+            {
+                p_timer->ticks_to_expire = m_wheel_time + p_timer->ticks_periodic_interval;
+                wheel_link(p_timer);
+            }
+            else
+            {
+                p_timer->is_running = false;
+            }
+
+            timeout_handler_exec(p_timer);
+        }
+
+        p_timer = p_next;
+    }
+}
+
+
+/**@brief Function for inserting a timer in the timer wheel.
+ *
+ * @param[in]  p_timer   Timer to insert, with ticks_to_expire holding the number of ticks from
+ *                       last known RTC counter value to timer expiry.
+ */
+static void timer_list_insert(timer_node_t * p_timer)
+{
+    // Make sure the timer is not linked twice.
+    wheel_unlink(p_timer);
+
+    p_timer->ticks_to_expire += m_wheel_time;
+    wheel_link(p_timer);
+}
+
+
+/**@brief Function for removing a timer from the timer wheel.
+ *
+ * @param[in]  p_timer   Timer to remove.
+ */
+static void timer_list_remove(timer_node_t * p_timer)
+{
+    if (p_timer->p_wheel_slot == NULL)
+    {
+        return;
+    }
+
+    wheel_unlink(p_timer);
+
+    // No more timers in the wheel. Reset RTC1 in case Start timer operations are present in the queue.
+    if (m_wheel_timer_count == 0)
+    {
+        NRF_RTC1->TASKS_CLEAR = 1;
+        m_ticks_latest        = 0;
+        m_rtc1_reset          = true;
+    }
+}
+
+#else
+
 /**@brief Function for inserting a timer in the timer list.
  *
  * @param[in]  timer_id   Id of timer to insert.
@@ -321,6 +659,56 @@ static void timer_list_remove(timer_node_t * p_timer)
     }
 }
 
+#endif // APP_TIMER_WITH_WHEEL
+
+
+/**@brief Function for getting a value that changes whenever the expiry time of the first timer to
+ *        expire changes.
+ */
+static __INLINE uint32_t timer_list_state_get(void)
+{
+#ifdef APP_TIMER_WITH_WHEEL
+    if (m_wheel_timer_count == 0)
+    {
+        // Expiry times are never in the past, so this cannot match any timer.
+        return (m_wheel_time - 1);
+    }
+
+    return (m_wheel_time + wheel_next_expiry_get(true));
+#else
+    return (uint32_t)(uintptr_t)mp_timer_id_head;
+#endif // APP_TIMER_WITH_WHEEL
+}
+
+
+/**@brief Function for getting the number of ticks from last known RTC counter value until the
+ *        first timer expires.
+ *
+ * @param[out] p_ticks_to_expire   Number of ticks until expiry.
+ *
+ * @return     TRUE if a timer is running, FALSE otherwise.
+ */
+static bool timer_next_expiry_get(uint32_t * p_ticks_to_expire)
+{
+#ifdef APP_TIMER_WITH_WHEEL
+    if (m_wheel_timer_count == 0)
+    {
+        return false;
+    }
+
+    *p_ticks_to_expire = wheel_next_expiry_get(true);
+#else
+    if (mp_timer_id_head == NULL)
+    {
+        return false;
+    }
+
+    *p_ticks_to_expire = mp_timer_id_head->ticks_to_expire;
+#endif // APP_TIMER_WITH_WHEEL
+
+    return true;
+}
+
 
 /**@brief Function for scheduling a check for timeouts by generating a RTC1 interrupt.
  */
@@ -361,6 +749,12 @@ static void timeout_handler_exec(timer_node_t * p_timer)
  */
 static void timer_timeouts_check(void)
 {
+#ifdef APP_TIMER_WITH_WHEEL
+    // Expired timers are handled in the timer list handler, pass all elapsed ticks to it.
+    if (m_wheel_timer_count != 0)
+    {
+        uint32_t ticks_expired = ticks_diff_get(rtc1_counter_get(), m_ticks_latest);
+#else
     // Handle expired of timer 
     if (mp_timer_id_head != NULL)
     {
@@ -402,6 +796,7 @@ static void timer_timeouts_check(void)
                 timeout_handler_exec(p_previous_timer);
             }
         }
+#endif // APP_TIMER_WITH_WHEEL
 
         // Prepare to queue the ticks expired in the m_ticks_elapsed queue.
         if (m_ticks_elapsed_q_read_ind == m_ticks_elapsed_q_write_ind)
@@ -467,11 +862,11 @@ static bool elapsed_ticks_acquire(uint32_t * p_ticks_elapsed)
  */
 static bool list_deletions_handler(void)
 {
-    timer_node_t * p_timer_old_head;
-    uint8_t        user_id;
+    uint32_t list_state_old;
+    uint8_t  user_id;
 
     // Remember the old head, so as to decide if new compare needs to be set.
-    p_timer_old_head = mp_timer_id_head;
+    list_state_old = timer_list_state_get();
 
     user_id = m_user_array_size;
     while (user_id--)
@@ -499,6 +894,19 @@ static bool list_deletions_handler(void)
                     
                 case TIMER_USER_OP_TYPE_STOP_ALL:
                     // Delete list of running timers, and mark all timers as not running.
+#ifdef APP_TIMER_WITH_WHEEL
+                    for (uint32_t slot = 0; slot < (WHEEL_LEVEL_COUNT * WHEEL_SLOT_COUNT); slot++)
+                    {
+                        timer_node_t * p_head = wheel_slot_detach(slot / WHEEL_SLOT_COUNT,
+                                                                  slot % WHEEL_SLOT_COUNT);
+
+                        while (p_head != NULL)
+                        {
+                            p_head->is_running = false;
+                            p_head             = p_head->next;
+                        }
+                    }
+#else
                     while (mp_timer_id_head != NULL)
                     {
                         timer_node_t * p_head = mp_timer_id_head;
@@ -506,6 +914,7 @@ static bool list_deletions_handler(void)
                         p_head->is_running = false;
                         mp_timer_id_head    = p_head->next;
                     }
+#endif // APP_TIMER_WITH_WHEEL
                     break;
                     
                 default:
@@ -516,7 +925,7 @@ static bool list_deletions_handler(void)
     }
 
     // Detect change in head of the list.
-    return (mp_timer_id_head != p_timer_old_head);
+    return (timer_list_state_get() != list_state_old);
 }
 
 
@@ -530,6 +939,34 @@ static void expired_timers_handler(uint32_t         ticks_elapsed,
                                    uint32_t         ticks_previous,
                                    timer_node_t **  p_restart_list_head)
 {
+#ifdef APP_TIMER_WITH_WHEEL
+    // Repeating timers are restarted directly in the timer wheel.
+    UNUSED_PARAMETER(ticks_previous);
+    UNUSED_PARAMETER(p_restart_list_head);
+
+    for (;;)
+    {
+        uint32_t ticks_step;
+
+        wheel_slot_expire();
+
+        if ((ticks_elapsed == 0) || (m_wheel_timer_count == 0))
+        {
+            m_wheel_time += ticks_elapsed;
+            break;
+        }
+
+        // Skip directly to the next slot holding timers, without visiting empty slots.
+        ticks_step     = MIN(wheel_next_expiry_get(false), ticks_elapsed);
+        m_wheel_time  += ticks_step;
+        ticks_elapsed -= ticks_step;
+
+        if ((m_wheel_time & WHEEL_SLOT_MASK) == 0)
+        {
+            wheel_cascade();
+        }
+    }
+#else
     uint32_t ticks_expired = 0;
 
     while (mp_timer_id_head != NULL)
@@ -567,6 +1004,7 @@ static void expired_timers_handler(uint32_t         ticks_elapsed,
             *p_restart_list_head          = p_timer_expired;
         }
     }
+#endif // APP_TIMER_WITH_WHEEL
 }
 
 
@@ -578,11 +1016,11 @@ static void expired_timers_handler(uint32_t         ticks_elapsed,
  */
 static bool list_insertions_handler(timer_node_t * p_restart_list_head)
 {
-    timer_node_t * p_timer_id_old_head;
-    uint8_t        user_id;
+    uint32_t list_state_old;
+    uint8_t  user_id;
 
     // Remember the old head, so as to decide if new compare needs to be set.
-    p_timer_id_old_head = mp_timer_id_head;
+    list_state_old = timer_list_state_get();
 
     user_id = m_user_array_size;
     while (user_id--)
@@ -655,14 +1093,16 @@ static bool list_insertions_handler(timer_node_t * p_restart_list_head)
             p_timer->ticks_at_start       = 0;
             p_timer->ticks_first_interval = 0;
             p_timer->is_running           = true;
+#ifndef APP_TIMER_WITH_WHEEL
             p_timer->next                 = NULL;
+#endif // APP_TIMER_WITH_WHEEL
 
             // Insert into list 
             timer_list_insert(p_timer);
         }
     }
     
-    return (mp_timer_id_head != p_timer_id_old_head);
+    return (timer_list_state_get() != list_state_old);
 }
 
 
@@ -670,10 +1110,11 @@ static bool list_insertions_handler(timer_node_t * p_restart_list_head)
  */
 static void compare_reg_update(timer_node_t * p_timer_id_head_old)
 {
+    uint32_t ticks_to_expire;
+
     // Setup the timeout for timers on the head of the list 
-    if (mp_timer_id_head != NULL)
+    if (timer_next_expiry_get(&ticks_to_expire))
     {
-        uint32_t ticks_to_expire = mp_timer_id_head->ticks_to_expire;
         uint32_t pre_counter_val = rtc1_counter_get();
         uint32_t cc              = m_ticks_latest;
         uint32_t ticks_elapsed   = ticks_diff_get(pre_counter_val, cc) + RTC_COMPARE_OFFSET_MIN;
@@ -734,6 +1175,21 @@ static void timer_list_handler(void)
     // Get number of elapsed ticks
     ticks_have_elapsed = elapsed_ticks_acquire(&ticks_elapsed);
 
+#ifdef APP_TIMER_WITH_WHEEL
+    // Handle expired timers first, so that operations requested by the timeout handlers are
+    // handled in this pass, as when the handlers are invoked from the RTC1 interrupt handler.
+    compare_update = ticks_have_elapsed;
+    if (ticks_have_elapsed)
+    {
+        expired_timers_handler(ticks_elapsed, ticks_previous, &p_restart_list_head);
+    }
+
+    // Handle list deletions
+    if (list_deletions_handler())
+    {
+        compare_update = true;
+    }
+#else
     // Handle list deletions
     compare_update = list_deletions_handler();
     
@@ -743,6 +1199,7 @@ static void timer_list_handler(void)
         expired_timers_handler(ticks_elapsed, ticks_previous, &p_restart_list_head);
         compare_update = true;
     }
+#endif // APP_TIMER_WITH_WHEEL
     
     // Handle list insertions
     if (list_insertions_handler(p_restart_list_head))
@@ -969,6 +1426,12 @@ uint32_t app_timer_init(uint32_t                      prescaler,
     }
 
     mp_timer_id_head             = NULL;
+#ifdef APP_TIMER_WITH_WHEEL
+    memset(m_wheel_slots, 0, sizeof(m_wheel_slots));
+    memset(m_wheel_bitmap, 0, sizeof(m_wheel_bitmap));
+    m_wheel_time        = 0;
+    m_wheel_timer_count = 0;
+#endif // APP_TIMER_WITH_WHEEL
     m_ticks_elapsed_q_read_ind  = 0;
     m_ticks_elapsed_q_write_ind = 0;
 
@@ -35,6 +35,12 @@
  *          @ref app_scheduler should be used or not. Even if the scheduler is 
  *          not used, app_timer.h will include app_scheduler.h, so when
  *          compiling, app_scheduler.h must be available in one of the compiler include paths.
+ *
+ * @details Running timers are by default kept in a list sorted by expiry time, making start and stop
+ *          operations linear in the number of running timers. When APP_TIMER_WITH_WHEEL is defined,
+ *          a hierarchical timer wheel is used instead, with constant time start and stop operations
+ *          at the cost of about 1.2 kB of RAM and 8 more bytes per timer. Time-out handlers are
+ *          then invoked from the SWI0 interrupt handler.
  */
 
 #ifndef APP_TIMER_H__
@@ -50,9 +56,17 @@
 #define APP_TIMER_CLOCK_FREQ         32768                      /**< Clock frequency of the RTC timer used to implement the app timer module. */
 #define APP_TIMER_MIN_TIMEOUT_TICKS  5                          /**< Minimum value of the timeout_ticks parameter of app_timer_start(). */
 
-#define APP_TIMER_NODE_SIZE          32                         /**< Size of app_timer.timer_node_t (used to allocate data). */
-#define APP_TIMER_USER_OP_SIZE       24                         /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()). */
-#define APP_TIMER_USER_SIZE          8                          /**< Size of app_timer.timer_user_t (only for use inside APP_TIMER_BUF_SIZE()). */
+/**@brief Round a structure size up to pointer alignment (only for use in the sizes below, which
+ *        evaluate to the sizes on Cortex-M given in their descriptions). */
+#define APP_TIMER_PTR_ALIGN(SIZE)    (CEIL_DIV((SIZE), sizeof(void *)) * sizeof(void *))
+
+#ifdef APP_TIMER_WITH_WHEEL
+#define APP_TIMER_NODE_SIZE          (APP_TIMER_PTR_ALIGN(20) + 5 * sizeof(void *))                 /**< Size of app_timer.timer_node_t (used to allocate data), 40 on Cortex-M. */
+#else
+#define APP_TIMER_NODE_SIZE          (APP_TIMER_PTR_ALIGN(20) + 3 * sizeof(void *))                 /**< Size of app_timer.timer_node_t (used to allocate data), 32 on Cortex-M. */
+#endif // APP_TIMER_WITH_WHEEL
+#define APP_TIMER_USER_OP_SIZE       (APP_TIMER_PTR_ALIGN(12) + 3 * sizeof(void *))                 /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()), 24 on Cortex-M. */
+#define APP_TIMER_USER_SIZE          (2 * sizeof(void *))                                           /**< Size of app_timer.timer_user_t (only for use inside APP_TIMER_BUF_SIZE()), 8 on Cortex-M. */
 #define APP_TIMER_INT_LEVELS         3                          /**< Number of interrupt levels from where timer operations may be initiated (only for use inside APP_TIMER_BUF_SIZE()). */
 
 /**@brief Compute number of bytes required to hold the application timer data structures.
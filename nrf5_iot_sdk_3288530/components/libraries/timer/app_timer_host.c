@@ -0,0 +1,274 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "app_timer_host.h"
+#include <stdlib.h>
+#include <string.h>
+#include "app_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+
+#define MAX_RTC_COUNTER_VAL     0x00FFFFFF                                  /**< Maximum value of the RTC counter. */
+
+/**@brief Timer node type, stored in the memory reserved by APP_TIMER_DEF. */
+typedef struct
+{
+    app_timer_timeout_handler_t p_timeout_handler;                          /**< Pointer to function to be executed when the timer expires. */
+    void *                      p_context;                                  /**< General purpose pointer. Will be passed to the timeout handler when the timer expires. */
+    uint32_t                    expiry_low;                                 /**< Absolute expiry tick, low word. */
+    uint32_t                    expiry_high;                                /**< Absolute expiry tick, high word. */
+    uint32_t                    ticks_periodic_interval;                    /**< Timer period (for repeating timers). */
+    uint8_t                     mode;                                       /**< Timer mode. */
+    uint8_t                     slot;                                       /**< Index in the table of running timers, APP_TIMER_HOST_MAX_TIMERS if not running. */
+} timer_node_t;
+
+STATIC_ASSERT(sizeof(timer_node_t) <= APP_TIMER_NODE_SIZE);
+STATIC_ASSERT(APP_TIMER_HOST_MAX_TIMERS < 0xFF);
+
+static bool                          m_initialized;                         /**< Indicates if the module has been initialized. */
+static uint64_t                      m_ticks_now;                           /**< Simulated clock. */
+static app_timer_evt_schedule_func_t m_evt_schedule_func;                   /**< Pointer to function for propagating timeout events to the scheduler. */
+static timer_node_t                * m_running[APP_TIMER_HOST_MAX_TIMERS];  /**< Table of running timers. */
+
+
+static uint64_t expiry_get(timer_node_t const * p_node)
+{
+    return ((uint64_t)p_node->expiry_high << 32) | p_node->expiry_low;
+}
+
+
+static void expiry_set(timer_node_t * p_node, uint64_t expiry)
+{
+    p_node->expiry_low  = (uint32_t)expiry;
+    p_node->expiry_high = (uint32_t)(expiry >> 32);
+}
+
+
+static void timer_remove(timer_node_t * p_node)
+{
+    if (p_node->slot < APP_TIMER_HOST_MAX_TIMERS)
+    {
+        m_running[p_node->slot] = NULL;
+        p_node->slot            = APP_TIMER_HOST_MAX_TIMERS;
+    }
+}
+
+
+/**@brief Function for finding the running timer expiring first, the lowest slot on ties. */
+static timer_node_t * timer_earliest_get(void)
+{
+    timer_node_t * p_earliest = NULL;
+
+    for (uint32_t index = 0; index < APP_TIMER_HOST_MAX_TIMERS; index++)
+    {
+        timer_node_t * p_node = m_running[index];
+
+        if ((p_node != NULL) &&
+            ((p_earliest == NULL) || (expiry_get(p_node) < expiry_get(p_earliest))))
+        {
+            p_earliest = p_node;
+        }
+    }
+
+    return p_earliest;
+}
+
+
+uint32_t app_timer_init(uint32_t                      prescaler,
+                        uint8_t                       op_queues_size,
+                        void *                        p_buffer,
+                        app_timer_evt_schedule_func_t evt_schedule_func)
+{
+    UNUSED_PARAMETER(prescaler);
+    UNUSED_PARAMETER(op_queues_size);
+
+    if (p_buffer == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    m_evt_schedule_func = evt_schedule_func;
+    m_ticks_now         = 0;
+    m_initialized       = true;
+
+    memset(m_running, 0, sizeof(m_running));
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                          app_timer_mode_t            mode,
+                          app_timer_timeout_handler_t timeout_handler)
+{
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((timeout_handler == NULL) || (p_timer_id == NULL))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    timer_node_t * p_node = (timer_node_t *)*p_timer_id;
+
+    if ((p_node->p_timeout_handler != NULL) && (p_node->slot < APP_TIMER_HOST_MAX_TIMERS))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    memset(p_node, 0, sizeof(timer_node_t));
+    p_node->p_timeout_handler = timeout_handler;
+    p_node->mode              = (uint8_t)mode;
+    p_node->slot              = APP_TIMER_HOST_MAX_TIMERS;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    timer_node_t * p_node = (timer_node_t *)timer_id;
+
+    if ((!m_initialized) || (timer_id == NULL) || (p_node->p_timeout_handler == NULL))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Restart the timer if it is running.
+    timer_remove(p_node);
+
+    for (uint32_t index = 0; index < APP_TIMER_HOST_MAX_TIMERS; index++)
+    {
+        if (m_running[index] == NULL)
+        {
+            p_node->p_context               = p_context;
+            p_node->ticks_periodic_interval = timeout_ticks;
+            p_node->slot                    = index;
+            expiry_set(p_node, m_ticks_now + timeout_ticks);
+
+            m_running[index] = p_node;
+
+            return NRF_SUCCESS;
+        }
+    }
+
+    return NRF_ERROR_NO_MEM;
+}
+
+
+uint32_t app_timer_stop(app_timer_id_t timer_id)
+{
+    timer_node_t * p_node = (timer_node_t *)timer_id;
+
+    if ((!m_initialized) || (timer_id == NULL) || (p_node->p_timeout_handler == NULL))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    timer_remove(p_node);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_stop_all(void)
+{
+    if (!m_initialized)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    for (uint32_t index = 0; index < APP_TIMER_HOST_MAX_TIMERS; index++)
+    {
+        if (m_running[index] != NULL)
+        {
+            timer_remove(m_running[index]);
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_get(uint32_t * p_ticks)
+{
+    *p_ticks = (uint32_t)(m_ticks_now & MAX_RTC_COUNTER_VAL);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_diff_compute(uint32_t   ticks_to,
+                                    uint32_t   ticks_from,
+                                    uint32_t * p_ticks_diff)
+{
+    *p_ticks_diff = ((ticks_to - ticks_from) & MAX_RTC_COUNTER_VAL);
+    return NRF_SUCCESS;
+}
+
+
+void app_timer_host_advance(uint32_t ticks)
+{
+    const uint64_t target = m_ticks_now + ticks;
+    timer_node_t * p_node;
+
+    while (((p_node = timer_earliest_get()) != NULL) && (expiry_get(p_node) <= target))
+    {
+        m_ticks_now = expiry_get(p_node);
+
+        if (p_node->mode == APP_TIMER_MODE_REPEATED)
+        {
+            expiry_set(p_node, m_ticks_now + p_node->ticks_periodic_interval);
+        }
+        else
+        {
+            timer_remove(p_node);
+        }
+
+        if (m_evt_schedule_func != NULL)
+        {
+            uint32_t err_code = m_evt_schedule_func(p_node->p_timeout_handler, p_node->p_context);
+            APP_ERROR_CHECK(err_code);
+        }
+        else
+        {
+            p_node->p_timeout_handler(p_node->p_context);
+        }
+    }
+
+    m_ticks_now = target;
+}
+
+
+uint32_t app_timer_host_next_expiry_get(uint32_t * p_ticks)
+{
+    timer_node_t * p_node = timer_earliest_get();
+
+    if (p_node == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    *p_ticks = (uint32_t)(expiry_get(p_node) - m_ticks_now);
+
+    return NRF_SUCCESS;
+}
+
+
+uint64_t app_timer_host_ticks_get(void)
+{
+    return m_ticks_now;
+}
@@ -0,0 +1,64 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @defgroup app_timer_host Application Timer on a simulated clock
+ * @{
+ * @ingroup app_timer
+ *
+ * @brief Host implementation of the @ref app_timer API driven by a simulated RTC1 clock.
+ *
+ * @details Link app_timer_host.c instead of app_timer.c to run modules using the application
+ *          timer on a host. Time does not pass on its own: the clock is advanced by
+ *          @ref app_timer_host_advance, which invokes the time-out handlers of expiring timers in
+ *          order of expiry, with the clock set to the expiry tick of each. Runs are therefore
+ *          deterministic and independent of the speed of the host.
+ */
+
+#ifndef APP_TIMER_HOST_H__
+#define APP_TIMER_HOST_H__
+
+#include <stdint.h>
+#include "app_timer.h"
+
+#ifndef APP_TIMER_HOST_MAX_TIMERS
+#define APP_TIMER_HOST_MAX_TIMERS    32                         /**< Maximum number of timers running at the same time. */
+#endif // APP_TIMER_HOST_MAX_TIMERS
+
+/**@brief Function for advancing the simulated clock.
+ *
+ * @details Time-out handlers of timers expiring within the interval are called in order of
+ *          expiry. Timers started from a handler expire in the same call if due within the interval.
+ *
+ * @param[in]  ticks   Number of RTC1 ticks to advance the clock by.
+ */
+void app_timer_host_advance(uint32_t ticks);
+
+/**@brief Function for getting the number of ticks until the next timer expires.
+ *
+ * @param[out] p_ticks Number of ticks until the earliest running timer expires.
+ *
+ * @retval     NRF_SUCCESS          If a timer is running.
+ * @retval     NRF_ERROR_NOT_FOUND  If no timer is running.
+ */
+uint32_t app_timer_host_next_expiry_get(uint32_t * p_ticks);
+
+/**@brief Function for getting the simulated time elapsed since initialization.
+ *
+ * @return     Number of RTC1 ticks elapsed, without the 24-bit wrap of @ref app_timer_cnt_get.
+ */
+uint64_t app_timer_host_ticks_get(void);
+
+#endif // APP_TIMER_HOST_H__
+
+/** @} */
@@ -613,6 +613,17 @@
  */
 #define COAP_ACK_RANDOM_FACTOR                            1
 
+/**
+ * @brief Enable the CoAP block-wise transfer engine.
+ *
+ * @details If enabled, the coap_block module serves and reassembles bodies of any size block by
+ *          block from an IoT file, and the iot_file module has to be included.
+ *
+ *          Possible values : 0 or 1.
+ *          Dependencies    : None.
+ */
+#define COAP_ENABLE_BLOCK_TRANSFER                        1
+
 /** @} */
 /** @} */
 
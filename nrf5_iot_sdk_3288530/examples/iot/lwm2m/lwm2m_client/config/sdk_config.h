@@ -733,6 +733,20 @@
  */
 #define LWM2M_COAP_HANDLER_MAX_INSTANCES                  5
 
+/**
+ * @brief Size of the cached link format string of the objects and instances.
+ *
+ * @details The link format string listing the objects and instances is kept in a buffer of
+ *          this size and rendered again only after objects or instances are added or deleted.
+ *          lwm2m_update then sends it along when it changed since the last registration or
+ *          update. Set to 0 to disable the cache.
+ *
+ *          Minimum value : 0
+ *          Maximum value : 65535
+ *          Dependencies  : None
+ */
+#define LWM2M_COAP_HANDLER_LINK_FORMAT_CACHE_SIZE         0
+
 /**
  * @brief Max number of bytes allocated for location string from remote server.
  * 
@@ -747,6 +761,53 @@
  */
 #define LWM2M_REGISTER_MAX_LOCATION_LEN                   20
 
+/**
+ * @brief Enable LWM2M Observe and Write-Attributes.
+ *
+ * @details Set this define to 1 to let servers observe objects, instances and resources and
+ *          set their notification attributes (pmin, pmax, gt, lt and st). The application then
+ *          reports changes with lwm2m_observe_resource_update or lwm2m_observe_resource_changed,
+ *          calls lwm2m_observe_tick every second, and handles LWM2M_OPERATION_CODE_OBSERVE in
+ *          its callbacks as a read.
+ *
+ *          Possible values : 0 or 1.
+ *          Dependencies    : None.
+ */
+#define LWM2M_ENABLE_OBSERVE                              0
+
+/**
+ * @brief Maximum number of observations.
+ *
+ * @details Number of paths that can be observed, or hold notification attributes, at a time.
+ *
+ *          Minimum value : 1
+ *          Maximum value : 255
+ *          Dependencies  : LWM2M_ENABLE_OBSERVE
+ */
+#define LWM2M_OBSERVE_MAX_OBSERVATIONS                    4
+
+/**
+ * @brief Enable the SenML-JSON content format.
+ *
+ * @details Set this define to 1 to compile in the SenML-JSON writer and reader of lwm2m_senml.h,
+ *          used to read and write several resources at a time in content format 110.
+ *
+ *          Possible values : 0 or 1.
+ *          Dependencies    : None.
+ */
+#define LWM2M_ENABLE_SENML_JSON                           0
+
+/**
+ * @brief Enable the SenML-CBOR content format.
+ *
+ * @details Set this define to 1 to compile in the SenML-CBOR writer and reader of lwm2m_senml.h,
+ *          in content format 112. Payloads are about half the size of SenML-JSON.
+ *
+ *          Possible values : 0 or 1.
+ *          Dependencies    : None.
+ */
+#define LWM2M_ENABLE_SENML_CBOR                           0
+
 /** @} */
 /** @} */
 
@@ -43,6 +43,9 @@
 #include "lwm2m_api.h"
 #include "lwm2m_objects_tlv.h"
 #include "ipso_objects_tlv.h"
+#if (LWM2M_ENABLE_SENML_JSON == 1) || (LWM2M_ENABLE_SENML_CBOR == 1)
+#include "lwm2m_senml.h"
+#endif
 #include "addr_parse.h"
 #include "ipv6_medium.h"
 
@@ -599,6 +602,86 @@ uint32_t bootstrap_object_callback(lwm2m_object_prototype_t * p_object,
 }
 
 
+#if (LWM2M_ENABLE_SENML_JSON == 1) || (LWM2M_ENABLE_SENML_CBOR == 1)
+/**@brief Respond to a read of an IPSO digital output instance in the SenML content format
+ *        accepted by the server, or with 4.06 Not Acceptable if it accepts no supported format.
+ *
+ * @retval NRF_ERROR_NOT_FOUND If the server did not ask for SenML, and TLV should be used.
+ */
+static uint32_t ipso_instance_senml_respond(ipso_digital_output_t * ipso_dig_out,
+                                            coap_message_t *        p_request)
+{
+    coap_content_type_t  ct;
+    coap_message_t     * p_response;
+    lwm2m_senml_writer_t writer;
+    uint8_t            * p_buffer;
+    uint16_t             buffer_len;
+    uint32_t             payload_len;
+    uint16_t             path[] = {ipso_dig_out->proto.object_id, ipso_dig_out->proto.instance_id};
+
+    uint32_t err_code = lwm2m_content_type_select(&ct,
+                                                  p_request,
+                                                  LWM2M_SENML_CT_MASK | COAP_CT_MASK_APP_LWM2M_TLV,
+                                                  COAP_CT_APP_LWM2M_TLV);
+    if (err_code != NRF_SUCCESS)
+    {
+        // The Accept option names no format the instance can be encoded in.
+        return lwm2m_respond_with_code(COAP_CODE_406_NOT_ACCEPTABLE, p_request);
+    }
+
+    if (ct == COAP_CT_APP_LWM2M_TLV)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    err_code = lwm2m_respond_with_content_new(&p_response, ct, p_request);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    // Encode straight into the payload of the response.
+    err_code = coap_message_payload_buffer_get(p_response, &p_buffer, &buffer_len);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = lwm2m_senml_writer_init(&writer, ct, p_buffer, buffer_len, path, 2);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = lwm2m_senml_bool_add(&writer,
+                                        IPSO_RR_ID_DIGITAL_OUTPUT_STATE,
+                                        ipso_dig_out->digital_output_state);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = lwm2m_senml_bool_add(&writer,
+                                        IPSO_RR_ID_DIGITAL_OUTPUT_POLARITY,
+                                        ipso_dig_out->digital_output_polarity);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = lwm2m_senml_string_add(&writer,
+                                          IPSO_RR_ID_APPLICATION_TYPE,
+                                          ipso_dig_out->application_type);
+    }
+    if (err_code == NRF_SUCCESS)
+    {
+        (void)lwm2m_senml_writer_finish(&writer, &payload_len);
+        err_code = coap_message_payload_set(p_response, p_buffer, payload_len);
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        (void)coap_message_delete(p_response);
+        return err_code;
+    }
+
+    return lwm2m_respond_with_content_send(p_response, p_request);
+}
+#endif // LWM2M_ENABLE_SENML_JSON || LWM2M_ENABLE_SENML_CBOR
+
+
 /**@brief Callback function for IPSO digital output instances. */
 uint32_t ipso_instance_callback(lwm2m_instance_prototype_t * p_instance, 
                                 uint16_t                     resource_id, 
@@ -726,6 +809,18 @@ uint32_t ipso_instance_callback(lwm2m_instance_prototype_t * p_instance,
                     uint8_t  buffer[100];
                     uint32_t buffer_size = sizeof(buffer);
 
+#if (LWM2M_ENABLE_SENML_JSON == 1) || (LWM2M_ENABLE_SENML_CBOR == 1)
+                    uint32_t err_code = ipso_instance_senml_respond(ipso_dig_out, p_request);
+                    if (err_code != NRF_ERROR_NOT_FOUND)
+                    {
+                        if (err_code != NRF_SUCCESS)
+                        {
+                            (void)lwm2m_respond_with_code(COAP_CODE_500_INTERNAL_SERVER_ERROR, p_request);
+                        }
+                        break;
+                    }
+#endif // LWM2M_ENABLE_SENML_JSON || LWM2M_ENABLE_SENML_CBOR
+
                     (void)ipso_tlv_ipso_digital_output_encode(buffer, &buffer_size, ipso_dig_out);
                     
                     (void)lwm2m_respond_with_payload(buffer, 
@@ -86,23 +86,32 @@ static void blenetif_input(struct netif  * p_netif,  uint8_t * p_payload, uint16
 }
 
 
-/** @brief Network interface output function registered with LwIP to send packets on 6lowpan. */
+/** @brief Network interface output function registered with LwIP to send packets on 6lowpan.
+ *
+ * @details The 6lowpan layer takes ownership of a single contiguous buffer reserved from the
+ *          memory manager, and frees it once transmitted. The entire pbuf chain is therefore
+ *          gathered into one such buffer in a single pass. Chained pbufs, as queued by TCP for
+ *          segments spanning several pbufs, are sent in full.
+ */
 static err_t blenetif_output(struct netif * p_netif, struct pbuf * p_buffer, const ip6_addr_t * p_addr)
 {
     struct blenetif * p_blenetif    = (struct blenetif *)p_netif->state;
     uint8_t         * p_payload;
     err_t             error_code    = ERR_MEM;
-    const    uint16_t requested_len = p_buffer->len;
+    const    uint16_t requested_len = p_buffer->tot_len;
 
+    UNUSED_PARAMETER(p_addr);
 
     NRF_DRIVER_LOG("[IP-DRI]: >> blenetif_output\r\n");
-    NRF_DRIVER_DUMP(p_buffer->payload, requested_len);
 
-    p_payload = nrf_malloc(p_buffer->len);
+    p_payload = nrf_malloc(requested_len);
 
     if (NULL != p_payload)
     {
-        memcpy(p_payload, p_buffer->payload, p_buffer->len);
+        UNUSED_VARIABLE(pbuf_copy_partial(p_buffer, p_payload, requested_len, 0));
+
+        NRF_DRIVER_DUMP(p_payload, requested_len);
+
         uint32_t retval = ble_6lowpan_interface_send(p_blenetif->p_ble_interface,
                                                      p_payload,
                                                      requested_len);
@@ -110,15 +119,18 @@ static err_t blenetif_output(struct netif * p_netif, struct pbuf * p_buffer, con
         {
             NRF_DRIVER_ERR("[IP-DRI]: Failed to send IP packet, reason 0x%08X\r\n", retval);
             nrf_free(p_payload);
+            LINK_STATS_INC(link.drop);
         }
         else
         {
+            LINK_STATS_INC(link.xmit);
             error_code = ERR_OK;
         }
     }
     else
     {
          NRF_DRIVER_ERR("[IP-DRI]: Failed to allocate memory for output packet\r\n");
+         LINK_STATS_INC(link.memerr);
     }
 
     NRF_DRIVER_LOG("[IP-DRI]: << blenetif_output\r\n");
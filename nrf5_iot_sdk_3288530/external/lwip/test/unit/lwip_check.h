@@ -13,6 +13,18 @@
 #define EXPECT_RETX(x, y) do { fail_unless(x); if(!(x)) { return y; }} while(0)
 #define EXPECT_RETNULL(x) EXPECT_RETX(x, NULL)
 
+#if defined(CHECK_MINOR_VERSION) && ((CHECK_MAJOR_VERSION > 0) || (CHECK_MINOR_VERSION >= 13))
+/* Since check 0.13, START_TEST defines a test description that carries the function name */
+typedef struct {
+	const TTest *func;
+	const char *name;
+} testfunc;
+
+#define TESTFUNC(x) {(x), "" # x "" }
+
+#define tcase_add_named_test(tc,tf) \
+   _tcase_add_test((tc),(tf).func,0, 0, 0, 1)
+#else
 typedef struct {
 	TFun func;
 	const char *name;
@@ -23,6 +35,7 @@ typedef struct {
 /* Modified function from check.h, supplying function name */
 #define tcase_add_named_test(tc,tf) \
    _tcase_add_test((tc),(tf).func,(tf).name,0, 0, 0, 1)
+#endif
 
 /** typedef for a function returning a test suite */
 typedef Suite* (suite_getter_fn)(void);
@@ -0,0 +1,264 @@
+#include "test_blenetif.h"
+
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+
+#if !LWIP_IPV6
+#error "This tests needs IPv6 enabled"
+#endif
+
+/* The nRF port is built into this test to reach its static output function. The nRF5 SDK
+ * include paths must be provided, and SVCALL_AS_NORMAL_FUNCTION defined for a host build. The
+ * 6lowpan, memory manager, context manager and timer functions it uses are replaced by the
+ * stubs below. The suite needs IPv6, so it is built as a program of its own by the host unit
+ * tests of the SDK (test_lwip_blenetif in test/Makefile), not by lwip_unittests.c. */
+#include "../../../src/port/nrf_platform_port.c"
+
+#define TEST_SEND_BUF_SIZE 1280
+
+static u8_t  test_send_buf[TEST_SEND_BUF_SIZE];
+static u16_t test_send_len;
+static int   test_send_count;
+static int   test_malloc_count;
+static int   test_free_count;
+static int   test_malloc_fail;
+static u32_t test_send_result;
+
+/* Stubs of the nRF5 SDK */
+
+eui64_t eui64_local_iid;
+
+void *
+nrf_malloc(uint32_t size)
+{
+  if (test_malloc_fail) {
+    return NULL;
+  }
+  test_malloc_count++;
+  return malloc(size);
+}
+
+void
+nrf_free(void *p_buffer)
+{
+  test_free_count++;
+  free(p_buffer);
+}
+
+uint32_t
+ble_6lowpan_interface_send(const iot_interface_t *p_interface, const uint8_t *p_packet, uint16_t packet_len)
+{
+  LWIP_UNUSED_ARG(p_interface);
+  test_send_count++;
+  if (test_send_result != NRF_SUCCESS) {
+    return test_send_result;
+  }
+  fail_unless(packet_len <= TEST_SEND_BUF_SIZE);
+  memcpy(test_send_buf, p_packet, packet_len);
+  test_send_len = packet_len;
+  /* 6lowpan owns the packet once accepted and frees it after transmission. */
+  nrf_free((void *)p_packet);
+  return NRF_SUCCESS;
+}
+
+uint32_t
+ble_6lowpan_init(const ble_6lowpan_init_t *p_init)
+{
+  LWIP_UNUSED_ARG(p_init);
+  return NRF_SUCCESS;
+}
+
+uint32_t
+iot_context_manager_init(void)
+{
+  return NRF_SUCCESS;
+}
+
+uint32_t
+iot_context_manager_table_alloc(const iot_interface_t *p_interface)
+{
+  LWIP_UNUSED_ARG(p_interface);
+  return NRF_SUCCESS;
+}
+
+uint32_t
+iot_context_manager_table_free(const iot_interface_t *p_interface)
+{
+  LWIP_UNUSED_ARG(p_interface);
+  return NRF_SUCCESS;
+}
+
+uint32_t
+app_timer_cnt_get(uint32_t *p_ticks)
+{
+  *p_ticks = 0;
+  return NRF_SUCCESS;
+}
+
+void
+nrf_driver_interface_up(void)
+{
+}
+
+void
+nrf_driver_interface_down(void)
+{
+}
+
+/* Helper functions */
+
+static struct netif *
+test_netif(void)
+{
+  m_blenetif_table[0].netif.state = &m_blenetif_table[0];
+  return &m_blenetif_table[0].netif;
+}
+
+/** Create a chain of pbufs of the given lengths, filled with an incrementing pattern. */
+static struct pbuf *
+test_chain_create(const u16_t *lengths, size_t count)
+{
+  struct pbuf *p = NULL;
+  size_t i;
+  u16_t j;
+  u8_t value = 0;
+
+  for (i = 0; i < count; i++) {
+    struct pbuf *q = pbuf_alloc(PBUF_RAW, lengths[i], PBUF_RAM);
+    if (q == NULL) {
+      if (p != NULL) {
+        pbuf_free(p);
+      }
+      return NULL;
+    }
+    for (j = 0; j < lengths[i]; j++) {
+      ((u8_t *)q->payload)[j] = value++;
+    }
+    if (p == NULL) {
+      p = q;
+    } else {
+      pbuf_cat(p, q);
+    }
+  }
+  return p;
+}
+
+/* Setups/teardown functions */
+
+static void
+blenetif_setup(void)
+{
+  memset(test_send_buf, 0, sizeof(test_send_buf));
+  test_send_len     = 0;
+  test_send_count   = 0;
+  test_malloc_count = 0;
+  test_free_count   = 0;
+  test_malloc_fail  = 0;
+  test_send_result  = NRF_SUCCESS;
+}
+
+static void
+blenetif_teardown(void)
+{
+}
+
+
+/* Test functions */
+
+/** Call blenetif_output with a chain of pbufs, as queued by TCP, and check that the whole
+ * chain is handed to 6lowpan in one buffer. */
+START_TEST(test_blenetif_output_chain)
+{
+  const u16_t lengths[] = {60, 536, 200};
+  struct pbuf *p;
+  u16_t i;
+  LWIP_UNUSED_ARG(_i);
+
+  p = test_chain_create(lengths, sizeof(lengths)/sizeof(lengths[0]));
+  fail_unless(p != NULL);
+  fail_unless(p->next != NULL);
+  fail_unless(p->tot_len == 796);
+
+  fail_unless(blenetif_output(test_netif(), p, NULL) == ERR_OK);
+  fail_unless(test_send_count == 1);
+  fail_unless(test_send_len == p->tot_len);
+  for (i = 0; i < test_send_len; i++) {
+    fail_unless(test_send_buf[i] == (u8_t)i);
+  }
+  fail_unless(test_malloc_count == 1);
+  fail_unless(test_free_count == 1);
+
+  pbuf_free(p);
+}
+END_TEST
+
+/** Call blenetif_output with a single pbuf. */
+START_TEST(test_blenetif_output_single)
+{
+  const u16_t lengths[] = {48};
+  struct pbuf *p;
+  LWIP_UNUSED_ARG(_i);
+
+  p = test_chain_create(lengths, 1);
+  fail_unless(p != NULL);
+
+  fail_unless(blenetif_output(test_netif(), p, NULL) == ERR_OK);
+  fail_unless(test_send_count == 1);
+  fail_unless(test_send_len == 48);
+  fail_unless(test_send_buf[47] == 47);
+
+  pbuf_free(p);
+}
+END_TEST
+
+/** Check that a packet that cannot be allocated is not sent. */
+START_TEST(test_blenetif_output_no_mem)
+{
+  const u16_t lengths[] = {40, 40};
+  struct pbuf *p;
+  LWIP_UNUSED_ARG(_i);
+
+  p = test_chain_create(lengths, 2);
+  fail_unless(p != NULL);
+
+  test_malloc_fail = 1;
+  fail_unless(blenetif_output(test_netif(), p, NULL) == ERR_MEM);
+  fail_unless(test_send_count == 0);
+
+  pbuf_free(p);
+}
+END_TEST
+
+/** Check that the buffer is released when 6lowpan does not accept the packet. */
+START_TEST(test_blenetif_output_send_fail)
+{
+  const u16_t lengths[] = {40, 40};
+  struct pbuf *p;
+  LWIP_UNUSED_ARG(_i);
+
+  p = test_chain_create(lengths, 2);
+  fail_unless(p != NULL);
+
+  test_send_result = NRF_ERROR_NO_MEM;
+  fail_unless(blenetif_output(test_netif(), p, NULL) == ERR_MEM);
+  fail_unless(test_send_count == 1);
+  fail_unless(test_malloc_count == 1);
+  fail_unless(test_free_count == 1);
+
+  pbuf_free(p);
+}
+END_TEST
+
+
+/** Create the suite including all tests for this module */
+Suite *
+blenetif_suite(void)
+{
+  testfunc tests[] = {
+    TESTFUNC(test_blenetif_output_chain),
+    TESTFUNC(test_blenetif_output_single),
+    TESTFUNC(test_blenetif_output_no_mem),
+    TESTFUNC(test_blenetif_output_send_fail),
+  };
+  return create_suite("BLENETIF", tests, sizeof(tests)/sizeof(testfunc), blenetif_setup, blenetif_teardown);
+}
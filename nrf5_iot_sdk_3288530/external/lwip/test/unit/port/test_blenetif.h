@@ -0,0 +1,8 @@
+#ifndef LWIP_HDR_TEST_BLENETIF_H__
+#define LWIP_HDR_TEST_BLENETIF_H__
+
+#include "../lwip_check.h"
+
+Suite* blenetif_suite(void);
+
+#endif
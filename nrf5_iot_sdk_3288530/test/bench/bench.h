@@ -0,0 +1,78 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file bench.h
+ *
+ * @brief Common helpers of the host benchmarks.
+ *
+ * @details Benchmarks time a number of iterations of an operation with the monotonic clock of
+ *          the host and print one line per measurement. They only use the public API of the
+ *          modules measured, so the same benchmark can be built against an earlier revision of a
+ *          module to compare the two.
+ */
+
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/**@brief Get the time of the monotonic clock of the host, in nanoseconds. */
+static inline uint64_t bench_time_ns(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+
+/**@brief Print the time taken per operation by a measurement.
+ *
+ * @param[in] p_name     Name of the measurement.
+ * @param[in] start_ns   Time the measurement started at, from @ref bench_time_ns.
+ * @param[in] operations Number of operations done.
+ */
+static inline void bench_report(const char * p_name, uint64_t start_ns, uint64_t operations)
+{
+    uint64_t elapsed_ns = bench_time_ns() - start_ns;
+
+    printf("%-40s %10.1f ns/op %12.0f op/s\n",
+           p_name,
+           (double)elapsed_ns / (double)operations,
+           (double)operations * 1e9 / (double)elapsed_ns);
+}
+
+
+/**@brief Pseudo random number generator, so that runs are repeatable.
+ *
+ * @param[inout] p_state State of the generator, any value to start with.
+ *
+ * @return Next pseudo random number.
+ */
+static inline uint32_t bench_rand(uint32_t * p_state)
+{
+    // xorshift32.
+    uint32_t x = (*p_state != 0) ? *p_state : 0x12345678;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    *p_state = x;
+
+    return x;
+}
+
+#endif // BENCH_H__
@@ -0,0 +1,270 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the CoAP receive path on a host loopback transport. Datagrams are given to
+ *        coap_transport_read and the replies of CoAP are taken from coap_transport_write. An
+ *        operation is one received datagram.
+ *
+ * @details Only the public API of CoAP is used, so the benchmark can be built against the CoAP
+ *          sources of an earlier revision, for example:
+ *
+ *          mkdir /tmp/coap_old
+ *          git archive <revision> components/iot/coap | tar -x -C /tmp/coap_old
+ *          make bench bench_coap_CFLAGS=-I/tmp/coap_old/components/iot/coap \
+ *                     bench_coap_SRC="bench/coap/bench_coap.c \
+ *                     $(ls /tmp/coap_old/components/iot/coap/coap*.c | grep -v observe) \
+ *                     ../components/libraries/mem_manager/mem_manager.c"
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sdk_errors.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_transport.h"
+#include "bench.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the benchmark. */
+#define DATAGRAM_COUNT        1000000                                                               /**< Number of datagrams received in each measurement. */
+#define MAX_DATAGRAM_SIZE     300                                                                   /**< Largest datagram written by CoAP. */
+
+static const coap_port_t m_port   = { .port_number = LOCAL_PORT_NUM };
+static coap_remote_t     m_remote = { .port_number = LOCAL_PORT_NUM };
+
+static uint8_t           m_written[MAX_DATAGRAM_SIZE];                                              /**< Last datagram written by CoAP. */
+static uint16_t          m_written_len;                                                             /**< Length of the last datagram written by CoAP. */
+static uint32_t          m_write_count;                                                             /**< Number of datagrams written by CoAP. */
+
+static coap_resource_t   m_root;
+static coap_resource_t   m_lights;
+static coap_resource_t   m_led3;
+
+static const uint8_t     m_led3_value[] = "1";
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    if (datalen > MAX_DATAGRAM_SIZE)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(m_written, p_data, datalen);
+    m_written_len = datalen;
+    m_write_count++;
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+/**@brief Reply to a GET of /lights/led3 with a piggybacked response, as the CoAP server example
+ *        does. */
+static void led3_callback(coap_resource_t * p_resource, coap_message_t * p_request)
+{
+    coap_message_conf_t response_config;
+    memset(&response_config, 0x00, sizeof(coap_message_conf_t));
+
+    response_config.type      = (p_request->header.type == COAP_TYPE_CON) ? COAP_TYPE_ACK
+                                                                          : COAP_TYPE_NON;
+    response_config.code      = COAP_CODE_205_CONTENT;
+    response_config.id        = p_request->header.id;
+    response_config.port      = m_port;
+    response_config.token_len = p_request->header.token_len;
+    memcpy(&response_config.token[0], &p_request->token[0], p_request->header.token_len);
+
+    coap_message_t * p_response;
+    uint32_t         handle;
+
+    if ((coap_message_new(&p_response, &response_config) != NRF_SUCCESS)                    ||
+        (coap_message_remote_addr_set(p_response, &p_request->remote) != NRF_SUCCESS)        ||
+        (coap_message_opt_uint_add(p_response,
+                                   COAP_OPT_CONTENT_FORMAT,
+                                   COAP_CT_PLAIN_TEXT) != NRF_SUCCESS)                       ||
+        (coap_message_payload_set(p_response,
+                                  (void *)m_led3_value,
+                                  sizeof(m_led3_value) - 1) != NRF_SUCCESS)                  ||
+        (coap_message_send(&handle, p_response) != NRF_SUCCESS)                              ||
+        (coap_message_delete(p_response) != NRF_SUCCESS))
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void coap_error_handler(uint32_t error_code, coap_message_t * p_message)
+{
+}
+
+
+static void response_handler(uint32_t status, void * p_arg, coap_message_t * p_response)
+{
+}
+
+
+static void resources_create(void)
+{
+    if ((coap_resource_create(&m_root, "/") != NRF_SUCCESS)           ||
+        (coap_resource_create(&m_lights, "lights") != NRF_SUCCESS)    ||
+        (coap_resource_child_add(&m_root, &m_lights) != NRF_SUCCESS)  ||
+        (coap_resource_create(&m_led3, "led3") != NRF_SUCCESS))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    m_led3.permission = COAP_PERM_GET;
+    m_led3.callback   = led3_callback;
+
+    if (coap_resource_child_add(&m_lights, &m_led3) != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/**@brief Receive the same datagram repeatedly, with a new message ID each time, and check that
+ *        CoAP replies to each with a datagram of the expected size. */
+static void bench_receive(const char    * p_name,
+                          uint8_t       * p_datagram,
+                          uint16_t        datagram_len,
+                          uint16_t        reply_len)
+{
+    uint32_t write_count = m_write_count;
+    uint64_t start       = bench_time_ns();
+
+    for (uint32_t i = 0; i < DATAGRAM_COUNT; i++)
+    {
+        p_datagram[2] = (uint8_t)(i >> 8);
+        p_datagram[3] = (uint8_t)i;
+
+        (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, p_datagram, datagram_len);
+    }
+
+    bench_report(p_name, start, DATAGRAM_COUNT);
+
+    if ((m_write_count - write_count != DATAGRAM_COUNT) || (m_written_len != reply_len))
+    {
+        printf("%s: %u replies of %u bytes\n",
+               p_name,
+               (unsigned int)(m_write_count - write_count),
+               (unsigned int)m_written_len);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/**@brief Send a CON request and receive its empty ACK. An operation is one ACK, the time includes
+ *        building and sending the request. */
+static void bench_request_ack(void)
+{
+    coap_message_conf_t config;
+    memset(&config, 0x00, sizeof(coap_message_conf_t));
+
+    config.type              = COAP_TYPE_CON;
+    config.code              = COAP_CODE_PUT;
+    config.port              = m_port;
+    config.token_len         = 2;
+    config.response_callback = response_handler;
+
+    uint8_t  ack[4] = { 0x60, COAP_CODE_EMPTY_MESSAGE, 0, 0 };
+    uint64_t start  = bench_time_ns();
+
+    for (uint32_t i = 0; i < DATAGRAM_COUNT; i++)
+    {
+        coap_message_t * p_request;
+        uint32_t         handle;
+
+        config.id = (uint16_t)i;
+
+        if ((coap_message_new(&p_request, &config) != NRF_SUCCESS)                     ||
+            (coap_message_remote_addr_set(p_request, &m_remote) != NRF_SUCCESS)        ||
+            (coap_message_opt_str_add(p_request, COAP_OPT_URI_PATH, (uint8_t *)"led3", 4)
+                != NRF_SUCCESS)                                                         ||
+            (coap_message_send(&handle, p_request) != NRF_SUCCESS)                     ||
+            (coap_message_delete(p_request) != NRF_SUCCESS))
+        {
+            exit(EXIT_FAILURE);
+        }
+
+        ack[2] = m_written[2];
+        ack[3] = m_written[3];
+
+        (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, ack, sizeof(ack));
+    }
+
+    bench_report("CON request, empty ACK", start, DATAGRAM_COUNT);
+}
+
+
+int main(void)
+{
+    coap_port_t           ports[COAP_PORT_COUNT] = { { .port_number = LOCAL_PORT_NUM } };
+    coap_transport_init_t transport_params       = { .p_port_table = ports };
+
+    if ((nrf_mem_init() != NRF_SUCCESS) ||
+        (coap_init(17, &transport_params) != NRF_SUCCESS) ||
+        (coap_error_handler_register(coap_error_handler) != NRF_SUCCESS))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    resources_create();
+
+    // Empty CON message, answered by an RST.
+    uint8_t ping[] = { 0x40, COAP_CODE_EMPTY_MESSAGE, 0, 0 };
+    bench_receive("CON ping, RST", ping, sizeof(ping), 4);
+
+    // CON GET /lights/led3 with a 2 byte token, answered by a piggybacked 2.05 Content with an
+    // empty Content-Format option and a 1 byte payload.
+    uint8_t get[] = { 0x42, COAP_CODE_GET, 0, 0, 0xA5, 0x5A,
+                      0xB6, 'l', 'i', 'g', 'h', 't', 's', 0x04, 'l', 'e', 'd', '3' };
+    bench_receive("CON GET, piggybacked 2.05", get, sizeof(get), 9);
+
+    // NON GET of a resource that does not exist, answered by a 4.04 Not Found.
+    uint8_t not_found[] = { 0x52, COAP_CODE_GET, 0, 0, 0xA5, 0x5A,
+                            0xB4, 't', 'e', 'm', 'p' };
+    bench_receive("NON GET, 4.04", not_found, sizeof(not_found), 6);
+
+    bench_request_ack();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,272 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the notifications of observable resources in CoAP auto-mode.
+ *
+ * @details The latency of coap_observer_notify, which writes one datagram to each observer of
+ *          the resource, is measured for a growing number of observers, all using the same
+ *          content type, and for observers split over two content types. The time per observer
+ *          shows the cost of rewriting the header and token of the notification encoded once,
+ *          the time at one observer the cost of rendering and encoding it.
+ *
+ *          The cost of coap_time_tick is then measured for a growing number of observable
+ *          resources, with one of them due on each tick. It should not depend on the number of
+ *          resources.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sdk_errors.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_observe_api.h"
+#include "coap_transport.h"
+#include "bench.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the benchmark. */
+#define NOTIFY_COUNT          100000                                                                /**< Number of notifications sent in each measurement. */
+#define MAX_DATAGRAM_SIZE     64                                                                    /**< Largest datagram written by CoAP. */
+#define TICK_COUNT            1000000                                                               /**< Number of ticks in each measurement. */
+#define GROUP_SIZE            32                                                                    /**< Number of resources under each child of the root. */
+#define GROUP_COUNT           (COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES / GROUP_SIZE)                /**< Number of children of the root. */
+
+static coap_resource_t   m_root;
+static coap_resource_t   m_temperature;                                                             /**< Observed resource. */
+static coap_resource_t   m_groups[GROUP_COUNT];
+static coap_resource_t   m_resources[COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES];                      /**< Observable resources scheduled by coap_time_tick. */
+
+static uint8_t           m_written[MAX_DATAGRAM_SIZE];                                              /**< Last datagram written by CoAP. */
+static uint32_t          m_write_count;                                                             /**< Number of datagrams written by CoAP. */
+
+static const char        m_text_payload[] = "21.5";
+static const char        m_json_payload[] = "{\"t\":21.5}";
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    if (datalen > MAX_DATAGRAM_SIZE)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(m_written, p_data, datalen);
+    m_write_count++;
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_resource_observe_payload_set(coap_resource_t     * p_resource,
+                                           coap_content_type_t   ct,
+                                           coap_message_t      * p_response)
+{
+    const char * p_payload = (ct == COAP_CT_APP_JSON) ? m_json_payload : m_text_payload;
+
+    return coap_message_payload_set(p_response, (void *)p_payload, strlen(p_payload));
+}
+
+
+/**@brief Register observers of the temperature up to a given count, with 4 byte tokens. */
+static void observers_register(uint32_t first, uint32_t count, coap_content_type_t ct)
+{
+    for (uint32_t index = first; index < count; index++)
+    {
+        coap_observer_t observer;
+        uint32_t        handle;
+
+        memset(&observer, 0, sizeof(coap_observer_t));
+
+        observer.remote.addr[15]        = (uint8_t)index;
+        observer.remote.port_number     = (uint16_t)(LOCAL_PORT_NUM + index + 1);
+        observer.token_len              = 4;
+        observer.ct                     = ct;
+        observer.p_resource_of_interest = &m_temperature;
+
+        memcpy(observer.token, &index, sizeof(index));
+
+        if (coap_observe_server_register(&handle, &observer) != NRF_SUCCESS)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+/**@brief Notify the observers registered, and check that each receives every notification. */
+static void bench_notify(const char * p_name, uint32_t observer_count)
+{
+    char     name[64];
+    uint32_t write_count = m_write_count;
+    uint64_t start       = bench_time_ns();
+
+    for (uint32_t i = 0; i < NOTIFY_COUNT; i++)
+    {
+        if (coap_observer_notify(&m_temperature) != NRF_SUCCESS)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    (void)snprintf(name, sizeof(name), "%s, %u observers", p_name, (unsigned int)observer_count);
+    bench_report(name, start, NOTIFY_COUNT);
+
+    if (m_write_count - write_count != NOTIFY_COUNT * observer_count)
+    {
+        printf("%s: %u notifications\n", name, (unsigned int)(m_write_count - write_count));
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/**@brief Tick with a number of observable resources, one of them due on each tick.
+ *
+ * @details One resource is added on each tick before the measurement, so that with a period of
+ *          resource_count ticks their deadlines are spread evenly.
+ */
+static void bench_tick(uint32_t resource_count)
+{
+    coap_port_t           ports[COAP_PORT_COUNT] = { { .port_number = LOCAL_PORT_NUM } };
+    coap_transport_init_t transport_params       = { .p_port_table = ports };
+    char                  name[64];
+
+    memset(&m_root, 0, sizeof(m_root));
+    memset(m_groups, 0, sizeof(m_groups));
+    memset(m_resources, 0, sizeof(m_resources));
+
+    if ((coap_init(17, &transport_params) != NRF_SUCCESS) ||
+        (coap_resource_create(&m_root, "/") != NRF_SUCCESS))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t group = 0; group < (resource_count + GROUP_SIZE - 1) / GROUP_SIZE; group++)
+    {
+        (void)snprintf(name, sizeof(name), "g%u", (unsigned int)group);
+
+        if ((coap_resource_create(&m_groups[group], name) != NRF_SUCCESS) ||
+            (coap_resource_child_add(&m_root, &m_groups[group]) != NRF_SUCCESS))
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (uint32_t index = 0; index < resource_count; index++)
+    {
+        coap_resource_t * p_resource = &m_resources[index];
+
+        (void)snprintf(name, sizeof(name), "r%u", (unsigned int)index);
+
+        if ((coap_resource_create(p_resource, name) != NRF_SUCCESS) ||
+            (coap_resource_child_add(&m_groups[index / GROUP_SIZE], p_resource) != NRF_SUCCESS))
+        {
+            exit(EXIT_FAILURE);
+        }
+
+        p_resource->permission = (COAP_PERM_GET | COAP_PERM_OBSERVE);
+        p_resource->max_age    = resource_count + COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE - 1;
+
+        (void)coap_time_tick();
+    }
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t i = 0; i < TICK_COUNT; i++)
+    {
+        (void)coap_time_tick();
+    }
+
+    (void)snprintf(name, sizeof(name), "tick, %u resources, 1 due", (unsigned int)resource_count);
+    bench_report(name, start, TICK_COUNT);
+}
+
+
+int main(void)
+{
+    static const uint32_t observer_counts[] = { 1, 8, 32, COAP_OBSERVE_MAX_NUM_OBSERVERS };
+
+    coap_port_t           ports[COAP_PORT_COUNT] = { { .port_number = LOCAL_PORT_NUM } };
+    coap_transport_init_t transport_params       = { .p_port_table = ports };
+
+    if ((nrf_mem_init() != NRF_SUCCESS) ||
+        (coap_init(17, &transport_params) != NRF_SUCCESS) ||
+        (coap_resource_create(&m_root, "/") != NRF_SUCCESS) ||
+        (coap_resource_create(&m_temperature, "temp") != NRF_SUCCESS) ||
+        (coap_resource_child_add(&m_root, &m_temperature) != NRF_SUCCESS))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    m_temperature.permission  = (COAP_PERM_GET | COAP_PERM_OBSERVE);
+    m_temperature.max_age     = 60;
+    m_temperature.expire_time = 60;
+
+    uint32_t registered = 0;
+
+    for (uint32_t i = 0; i < sizeof(observer_counts) / sizeof(observer_counts[0]); i++)
+    {
+        observers_register(registered, observer_counts[i], COAP_CT_PLAIN_TEXT);
+        registered = observer_counts[i];
+
+        bench_notify("notify, 1 content type", registered);
+    }
+
+    // Start over with half of the observers using JSON, rendered and encoded separately.
+    if (coap_init(17, &transport_params) != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    observers_register(0, COAP_OBSERVE_MAX_NUM_OBSERVERS / 2, COAP_CT_PLAIN_TEXT);
+    observers_register(COAP_OBSERVE_MAX_NUM_OBSERVERS / 2, COAP_OBSERVE_MAX_NUM_OBSERVERS, COAP_CT_APP_JSON);
+
+    bench_notify("notify, 2 content types", COAP_OBSERVE_MAX_NUM_OBSERVERS);
+
+    for (uint32_t resource_count = 16;
+         resource_count <= COAP_AUTOMODE_OBSERVE_MAX_NUM_RESOURCES;
+         resource_count *= 4)
+    {
+        bench_tick(resource_count);
+    }
+
+    return EXIT_SUCCESS;
+}
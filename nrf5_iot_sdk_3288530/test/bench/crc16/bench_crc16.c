@@ -0,0 +1,84 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of crc16_compute over blocks of several sizes, built for the 256-entry table,
+ *        the nibble table and slice-by-4 and slice-by-8. An operation is one byte.
+ *
+ * @details On x86 hosts the time stamp counter is also read, and the cycles per byte are printed
+ *          after each measurement. Only crc16_compute is used, so the benchmark can be built
+ *          against the shift and xor implementation of an earlier revision, for example:
+ *
+ *          git show <revision>:components/libraries/crc16/crc16.c > /tmp/crc16_old.c
+ *          make bench bench_crc16_SRC="bench/crc16/bench_crc16.c /tmp/crc16_old.c"
+ */
+
+#include <stdlib.h>
+#include "crc16.h"
+#include "bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES()        __rdtsc()                                                             /**< Read the time stamp counter. */
+#endif
+
+#define BYTES_PER_RUN         (64 * 1024 * 1024)                                                    /**< Number of bytes in each measurement. */
+#define BUFFER_SIZE           4096                                                                  /**< Size of the largest block. */
+
+static uint8_t           m_data[BUFFER_SIZE];
+static volatile uint16_t m_crc;                                                                     /**< Result, so that the computation is not optimized away. */
+
+
+static void bench_block(const char * p_name, uint32_t size)
+{
+    uint16_t crc    = 0xFFFF;
+    uint32_t blocks = BYTES_PER_RUN / size;
+
+#ifdef BENCH_CYCLES
+    uint64_t start_cycles = BENCH_CYCLES();
+#endif
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t i = 0; i < blocks; i++)
+    {
+        crc = crc16_compute(m_data, size, &crc);
+    }
+
+    bench_report(p_name, start, (uint64_t)blocks * size);
+
+#ifdef BENCH_CYCLES
+    printf("%-40s %10.2f TSC cycles/byte\n",
+           "",
+           (double)(BENCH_CYCLES() - start_cycles) / ((double)blocks * size));
+#endif
+
+    m_crc = crc;
+}
+
+
+int main(void)
+{
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        m_data[i] = (uint8_t)bench_rand(&seed);
+    }
+
+    bench_block("crc16_compute, 16 byte blocks", 16);
+    bench_block("crc16_compute, 64 byte blocks", 64);
+    bench_block("crc16_compute, 512 byte blocks", 512);
+    bench_block("crc16_compute, 4096 byte blocks", 4096);
+
+    return EXIT_SUCCESS;
+}
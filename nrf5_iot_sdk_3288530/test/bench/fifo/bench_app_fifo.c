@@ -0,0 +1,165 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Throughput benchmark of app_fifo: single bytes, bulk read/write in chunks of several
+ *        sizes, and zero-copy peek/consume with space_get/commit. An operation is one byte through
+ *        the FIFO, written and read back.
+ *
+ * @details Define BENCH_NO_ZERO_COPY to build against an earlier revision of app_fifo.c without
+ *          the zero-copy API, for example:
+ *
+ *          git show <revision>:components/libraries/fifo/app_fifo.c > /tmp/app_fifo_old.c
+ *          make bench bench_app_fifo_SRC="bench/fifo/bench_app_fifo.c /tmp/app_fifo_old.c" \
+ *                     bench_app_fifo_CFLAGS=-DBENCH_NO_ZERO_COPY
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "nrf_error.h"
+#include "app_fifo.h"
+#include "bench.h"
+
+#define FIFO_SIZE             1024                                                                  /**< Size of the FIFO buffer. */
+#define BYTES_PER_RUN         (16 * 1024 * 1024)                                                    /**< Number of bytes through the FIFO in each measurement. */
+
+static app_fifo_t m_fifo;
+static uint8_t    m_fifo_buffer[FIFO_SIZE];
+static uint8_t    m_data[FIFO_SIZE];
+static volatile uint32_t m_sum;                                                                     /**< Sum of bytes read, so that reads are not optimized away. */
+
+
+static void fifo_init(void)
+{
+    if (app_fifo_init(&m_fifo, m_fifo_buffer, FIFO_SIZE) != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static void bench_bytes(void)
+{
+    uint8_t byte;
+
+    fifo_init();
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t i = 0; i < BYTES_PER_RUN / 8; i++)
+    {
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            (void)app_fifo_put(&m_fifo, m_data[j]);
+        }
+
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            (void)app_fifo_get(&m_fifo, &byte);
+            m_sum += byte;
+        }
+    }
+
+    bench_report("put/get, byte by byte", start, BYTES_PER_RUN / 8 * 8);
+}
+
+
+/**@brief Write and read chunks of a given size. The FIFO is kept half full, so that chunks wrap
+ *        around the end of the buffer. */
+static void bench_read_write(const char * p_name, uint32_t chunk_size)
+{
+    uint8_t  chunk[FIFO_SIZE];
+    uint32_t size      = FIFO_SIZE / 2;
+    uint64_t bytes     = 0;
+
+    fifo_init();
+    (void)app_fifo_write(&m_fifo, m_data, &size);
+
+    uint64_t start = bench_time_ns();
+
+    while (bytes < BYTES_PER_RUN)
+    {
+        size = chunk_size;
+        (void)app_fifo_write(&m_fifo, m_data, &size);
+
+        size = chunk_size;
+        (void)app_fifo_read(&m_fifo, chunk, &size);
+
+        m_sum += chunk[0];
+        bytes += size;
+    }
+
+    bench_report(p_name, start, bytes);
+}
+
+
+#ifndef BENCH_NO_ZERO_COPY
+
+/**@brief Fill the free space with space_get/commit and drain the data with peek/consume, one
+ *        contiguous span at a time, as a DMA or a parser would. */
+static void bench_zero_copy(const char * p_name, uint32_t chunk_size)
+{
+    uint8_t * p_span;
+    uint32_t  size;
+    uint32_t  initial = FIFO_SIZE / 2;
+    uint64_t  bytes   = 0;
+
+    fifo_init();
+    (void)app_fifo_write(&m_fifo, m_data, &initial);
+
+    uint64_t start = bench_time_ns();
+
+    while (bytes < BYTES_PER_RUN)
+    {
+        if (app_fifo_space_get(&m_fifo, &p_span, &size) == NRF_SUCCESS)
+        {
+            size = (size < chunk_size) ? size : chunk_size;
+            memcpy(p_span, m_data, size);
+            (void)app_fifo_commit(&m_fifo, size);
+        }
+
+        if (app_fifo_peek(&m_fifo, &p_span, &size) == NRF_SUCCESS)
+        {
+            size = (size < chunk_size) ? size : chunk_size;
+            m_sum += p_span[0];
+            (void)app_fifo_consume(&m_fifo, size);
+            bytes += size;
+        }
+    }
+
+    bench_report(p_name, start, bytes);
+}
+
+#endif // BENCH_NO_ZERO_COPY
+
+
+int main(void)
+{
+    for (uint32_t i = 0; i < FIFO_SIZE; i++)
+    {
+        m_data[i] = (uint8_t)i;
+    }
+
+    bench_bytes();
+    bench_read_write("read/write, 1 byte chunks", 1);
+    bench_read_write("read/write, 16 byte chunks", 16);
+    bench_read_write("read/write, 64 byte chunks", 64);
+    bench_read_write("read/write, 255 byte chunks", 255);
+
+#ifndef BENCH_NO_ZERO_COPY
+    bench_zero_copy("space_get/commit, peek/consume, 16", 16);
+    bench_zero_copy("space_get/commit, peek/consume, 255", 255);
+#endif // BENCH_NO_ZERO_COPY
+
+    return EXIT_SUCCESS;
+}
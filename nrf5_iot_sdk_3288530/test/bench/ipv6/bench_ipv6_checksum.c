@@ -0,0 +1,174 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of ipv6_checksum_calculate over packets of several sizes and alignments, and of
+ *        the checksum of an ICMPv6 echo reply. An operation is one packet.
+ *
+ * @details The echo reply is measured both checksummed again, as icmp6 did before, and updated
+ *          from the checksum of the request with ipv6_checksum_update. Copying a UDP payload into
+ *          a packet buffer is measured as memcpy followed by ipv6_checksum_calculate, and with
+ *          ipv6_checksum_copy_calculate. Define BENCH_NO_UPDATE to build the benchmark against an
+ *          earlier revision without ipv6_checksum_update and ipv6_checksum_copy_calculate, for
+ *          example:
+ *
+ *          git show <revision>:components/iot/ipv6_stack/utils/ipv6_utils.c > /tmp/ipv6_utils_old.c
+ *          make bench bench_ipv6_checksum_SRC="bench/ipv6/bench_ipv6_checksum.c /tmp/ipv6_utils_old.c" \
+ *                     bench_ipv6_checksum_CFLAGS=-DBENCH_NO_UPDATE
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ipv6_utils.h"
+#include "bench.h"
+
+#define BYTES_PER_RUN         (64 * 1024 * 1024)                                                    /**< Number of bytes in each measurement. */
+#define BUFFER_SIZE           1536                                                                  /**< Size of the largest packet, with room for the alignments. */
+#define ECHO_PAYLOAD_SIZE     1232                                                                  /**< ICMPv6 message size of a full IPv6 MTU echo request. */
+#define ECHO_RUNS             100000                                                                /**< Number of echo replies in each measurement. */
+#define COPY_SIZE             1024                                                                  /**< Size of the UDP payload copied. */
+
+static uint8_t           m_data[BUFFER_SIZE];
+static uint8_t           m_copy[BUFFER_SIZE];                                                       /**< Packet buffer the payload is copied to. */
+static volatile uint16_t m_checksum;                                                                /**< Result, so that the computation is not optimized away. */
+
+
+static void bench_calculate(const char * p_name, uint32_t offset, uint16_t size)
+{
+    uint32_t packets  = BYTES_PER_RUN / size;
+    uint16_t checksum = 0;
+    uint64_t start    = bench_time_ns();
+
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        checksum = (uint16_t)i;
+        ipv6_checksum_calculate(&m_data[offset], size, &checksum, false);
+        m_checksum = checksum;
+    }
+
+    bench_report(p_name, start, packets);
+}
+
+
+static void bench_echo_reply(void)
+{
+    // Source and destination address, the pseudo header fields and the message, summed the way
+    // icmp6 sums them.
+    const uint8_t * p_src     = &m_data[0];
+    const uint8_t * p_dst     = &m_data[IPV6_ADDR_SIZE];
+    const uint8_t * p_message = &m_data[2 * IPV6_ADDR_SIZE + 8];
+    uint64_t        start     = bench_time_ns();
+
+    for (uint32_t i = 0; i < ECHO_RUNS; i++)
+    {
+        uint16_t checksum = (uint16_t)(ECHO_PAYLOAD_SIZE + 58);
+
+        ipv6_checksum_calculate(p_src, IPV6_ADDR_SIZE, &checksum, false);
+        ipv6_checksum_calculate(p_dst, IPV6_ADDR_SIZE, &checksum, false);
+        ipv6_checksum_calculate(p_message, ECHO_PAYLOAD_SIZE, &checksum, false);
+        m_checksum = (uint16_t)~checksum;
+    }
+
+    bench_report("echo reply, checksummed again", start, ECHO_RUNS);
+
+#ifndef BENCH_NO_UPDATE
+    static const uint8_t request_type_code[2] = { 128, 0 };
+    static const uint8_t reply_type_code[2]   = { 129, 0 };
+
+    start = bench_time_ns();
+
+    for (uint32_t i = 0; i < ECHO_RUNS; i++)
+    {
+        uint16_t checksum = (uint16_t)i;
+
+        ipv6_checksum_update(&checksum, request_type_code, reply_type_code, 2, false);
+        m_checksum = checksum;
+    }
+
+    bench_report("echo reply, updated", start, ECHO_RUNS);
+
+    start = bench_time_ns();
+
+    for (uint32_t i = 0; i < ECHO_RUNS; i++)
+    {
+        uint16_t checksum = (uint16_t)i;
+
+        ipv6_checksum_update(&checksum, request_type_code, reply_type_code, 2, false);
+        ipv6_checksum_update(&checksum, p_dst, p_src, IPV6_ADDR_SIZE, false);
+        m_checksum = checksum;
+    }
+
+    bench_report("echo reply to multicast, updated", start, ECHO_RUNS);
+#endif // BENCH_NO_UPDATE
+}
+
+
+/**@brief Copy a payload to an offset in a packet buffer and checksum it, as udp6 does. */
+static void bench_copy(const char * p_name, uint32_t copy_offset)
+{
+    uint32_t packets = BYTES_PER_RUN / COPY_SIZE;
+    uint64_t start   = bench_time_ns();
+
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        uint16_t checksum = (uint16_t)i;
+
+        memcpy(&m_copy[copy_offset], m_data, COPY_SIZE);
+        ipv6_checksum_calculate(&m_copy[copy_offset], COPY_SIZE, &checksum, true);
+        m_checksum = checksum;
+    }
+
+    bench_report(p_name, start, packets);
+
+#ifndef BENCH_NO_UPDATE
+    char name[64];
+
+    start = bench_time_ns();
+
+    for (uint32_t i = 0; i < packets; i++)
+    {
+        uint16_t checksum = (uint16_t)i;
+
+        ipv6_checksum_copy_calculate(&m_copy[copy_offset], m_data, COPY_SIZE, &checksum, true);
+        m_checksum = checksum;
+    }
+
+    (void)snprintf(name, sizeof(name), "%s, one pass", p_name);
+    bench_report(name, start, packets);
+#endif // BENCH_NO_UPDATE
+}
+
+
+int main(void)
+{
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        m_data[i] = (uint8_t)bench_rand(&seed);
+    }
+
+    bench_calculate("ipv6_checksum_calculate, 16 bytes", 0, 16);
+    bench_calculate("ipv6_checksum_calculate, 64 bytes", 0, 64);
+    bench_calculate("ipv6_checksum_calculate, 1232 bytes", 0, 1232);
+    bench_calculate("ipv6_checksum_calculate, 1232 bytes +1", 1, 1232);
+    bench_calculate("ipv6_checksum_calculate, 1232 bytes +2", 2, 1232);
+    bench_calculate("ipv6_checksum_calculate, 1231 bytes", 0, 1231);
+
+    bench_echo_reply();
+
+    bench_copy("copy, checksum 1024 bytes", 0);
+    bench_copy("copy, checksum 1024 bytes +2", 2);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,270 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the LWM2M content formats: TLV, SenML-JSON and SenML-CBOR. An operation is
+ *        the encoding of a whole object instance into a buffer.
+ *
+ * @details The instances are an IPSO digital output (3201), an LWM2M server (1) and an IPSO
+ *          temperature (3303). The digital output and the server are encoded in TLV by the object
+ *          encoders of the SDK, the temperature, which has none, resource by resource with
+ *          lwm2m_tlv_encode. The size of each encoding is printed after its time.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "lwm2m_tlv.h"
+#include "lwm2m_senml.h"
+#include "lwm2m_objects_tlv.h"
+#include "ipso_objects_tlv.h"
+#include "iot_errors.h"
+#include "bench.h"
+
+#define BUFFER_SIZE           512                                                                   /**< Size of the buffer an instance is encoded into. */
+#define ITERATIONS            1000000                                                               /**< Number of encodings in each measurement. */
+
+/**@brief Encoder of an object instance.
+ *
+ * @param[out]   p_buffer     Buffer to encode into.
+ * @param[inout] p_buffer_len Size of the buffer. Set to the length encoded.
+ */
+typedef uint32_t (*encode_t)(uint8_t * p_buffer, uint32_t * p_buffer_len);
+
+static ipso_digital_output_t m_digital_output;
+static lwm2m_server_t        m_server;
+static ipso_temperature_t    m_temperature;
+static uint8_t               m_buffer[BUFFER_SIZE];
+
+
+static uint32_t digital_output_tlv_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return ipso_tlv_ipso_digital_output_encode(p_buffer, p_buffer_len, &m_digital_output);
+}
+
+
+static uint32_t digital_output_senml_encode(coap_content_type_t content_type,
+                                            uint8_t           * p_buffer,
+                                            uint32_t          * p_buffer_len)
+{
+    const uint16_t       path[] = { 3201, 0 };
+    lwm2m_senml_writer_t writer;
+
+    uint32_t err_code = lwm2m_senml_writer_init(&writer, content_type, p_buffer, *p_buffer_len, path, 2);
+
+    err_code |= lwm2m_senml_bool_add(&writer, 5550, m_digital_output.digital_output_state);
+    err_code |= lwm2m_senml_bool_add(&writer, 5551, m_digital_output.digital_output_polarity);
+    err_code |= lwm2m_senml_string_add(&writer, 5750, m_digital_output.application_type);
+    err_code |= lwm2m_senml_writer_finish(&writer, p_buffer_len);
+
+    return err_code;
+}
+
+
+static uint32_t digital_output_json_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return digital_output_senml_encode(COAP_CT_APP_SENML_JSON, p_buffer, p_buffer_len);
+}
+
+
+static uint32_t digital_output_cbor_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return digital_output_senml_encode(COAP_CT_APP_SENML_CBOR, p_buffer, p_buffer_len);
+}
+
+
+static uint32_t server_tlv_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return lwm2m_tlv_server_encode(p_buffer, p_buffer_len, &m_server);
+}
+
+
+static uint32_t server_senml_encode(coap_content_type_t content_type,
+                                    uint8_t           * p_buffer,
+                                    uint32_t          * p_buffer_len)
+{
+    const uint16_t       path[] = { 1, 0 };
+    lwm2m_senml_writer_t writer;
+
+    uint32_t err_code = lwm2m_senml_writer_init(&writer, content_type, p_buffer, *p_buffer_len, path, 2);
+
+    err_code |= lwm2m_senml_integer_add(&writer, 0, m_server.short_server_id);
+    err_code |= lwm2m_senml_integer_add(&writer, 1, m_server.lifetime);
+    err_code |= lwm2m_senml_integer_add(&writer, 2, m_server.default_minimum_period);
+    err_code |= lwm2m_senml_integer_add(&writer, 3, m_server.default_maximum_period);
+    err_code |= lwm2m_senml_integer_add(&writer, 5, m_server.disable_timeout);
+    err_code |= lwm2m_senml_bool_add(&writer, 6, m_server.notification_storing_on_disabled);
+    err_code |= lwm2m_senml_string_add(&writer, 7, m_server.binding);
+    err_code |= lwm2m_senml_writer_finish(&writer, p_buffer_len);
+
+    return err_code;
+}
+
+
+static uint32_t server_json_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return server_senml_encode(COAP_CT_APP_SENML_JSON, p_buffer, p_buffer_len);
+}
+
+
+static uint32_t server_cbor_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return server_senml_encode(COAP_CT_APP_SENML_CBOR, p_buffer, p_buffer_len);
+}
+
+
+/**@brief Encode a float resource in TLV, as the 4 bytes of its IEEE 754 value in network order. */
+static uint32_t tlv_float_encode(uint8_t * p_buffer, uint32_t * p_index, uint32_t buffer_len, float value, uint16_t id)
+{
+    uint32_t    bits;
+    uint8_t     value_buffer[sizeof(bits)];
+    lwm2m_tlv_t tlv;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    value_buffer[0] = (uint8_t)(bits >> 24);
+    value_buffer[1] = (uint8_t)(bits >> 16);
+    value_buffer[2] = (uint8_t)(bits >> 8);
+    value_buffer[3] = (uint8_t)bits;
+
+    tlv.id_type = TLV_TYPE_RESOURCE_VAL;
+    tlv.id      = id;
+    tlv.length  = sizeof(value_buffer);
+    tlv.value   = value_buffer;
+
+    uint32_t len      = buffer_len - *p_index;
+    uint32_t err_code = lwm2m_tlv_encode(&p_buffer[*p_index], &len, &tlv);
+
+    *p_index += len;
+
+    return err_code;
+}
+
+
+static uint32_t temperature_tlv_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    uint32_t    index = 0;
+    lwm2m_tlv_t tlv;
+
+    uint32_t err_code = tlv_float_encode(p_buffer, &index, *p_buffer_len, m_temperature.sensor_value, 5700);
+
+    tlv.id_type = TLV_TYPE_RESOURCE_VAL;
+    lwm2m_tlv_string_set(&tlv, m_temperature.units, 5701);
+
+    uint32_t len = *p_buffer_len - index;
+    err_code    |= lwm2m_tlv_encode(&p_buffer[index], &len, &tlv);
+    index       += len;
+
+    err_code |= tlv_float_encode(p_buffer, &index, *p_buffer_len, m_temperature.min_measured_value, 5601);
+    err_code |= tlv_float_encode(p_buffer, &index, *p_buffer_len, m_temperature.max_measured_value, 5602);
+    err_code |= tlv_float_encode(p_buffer, &index, *p_buffer_len, m_temperature.min_range_value, 5603);
+    err_code |= tlv_float_encode(p_buffer, &index, *p_buffer_len, m_temperature.max_range_value, 5604);
+
+    *p_buffer_len = index;
+
+    return err_code;
+}
+
+
+static uint32_t temperature_senml_encode(coap_content_type_t content_type,
+                                         uint8_t           * p_buffer,
+                                         uint32_t          * p_buffer_len)
+{
+    const uint16_t       path[] = { 3303, 0 };
+    lwm2m_senml_writer_t writer;
+
+    uint32_t err_code = lwm2m_senml_writer_init(&writer, content_type, p_buffer, *p_buffer_len, path, 2);
+
+    err_code |= lwm2m_senml_float_add(&writer, 5700, m_temperature.sensor_value);
+    err_code |= lwm2m_senml_string_add(&writer, 5701, m_temperature.units);
+    err_code |= lwm2m_senml_float_add(&writer, 5601, m_temperature.min_measured_value);
+    err_code |= lwm2m_senml_float_add(&writer, 5602, m_temperature.max_measured_value);
+    err_code |= lwm2m_senml_float_add(&writer, 5603, m_temperature.min_range_value);
+    err_code |= lwm2m_senml_float_add(&writer, 5604, m_temperature.max_range_value);
+    err_code |= lwm2m_senml_writer_finish(&writer, p_buffer_len);
+
+    return err_code;
+}
+
+
+static uint32_t temperature_json_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return temperature_senml_encode(COAP_CT_APP_SENML_JSON, p_buffer, p_buffer_len);
+}
+
+
+static uint32_t temperature_cbor_encode(uint8_t * p_buffer, uint32_t * p_buffer_len)
+{
+    return temperature_senml_encode(COAP_CT_APP_SENML_CBOR, p_buffer, p_buffer_len);
+}
+
+
+static uint32_t bench_encode(const char * p_name, encode_t encode)
+{
+    uint32_t encoded_len = 0;
+    uint32_t err_code    = NRF_SUCCESS;
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+        // A reading that changes, as in notifications.
+        m_temperature.sensor_value = 20.0f + (float)(iteration % 16) * 0.5f;
+
+        encoded_len  = sizeof(m_buffer);
+        err_code    |= encode(m_buffer, &encoded_len);
+    }
+
+    bench_report(p_name, start, ITERATIONS);
+
+    printf("    %u bytes\n", (unsigned int)encoded_len);
+
+    return err_code;
+}
+
+
+int main(void)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    m_digital_output.digital_output_state     = true;
+    m_digital_output.application_type.p_val   = "LED4";
+    m_digital_output.application_type.len     = 4;
+
+    m_server.short_server_id                  = 101;
+    m_server.lifetime                         = 86400;
+    m_server.default_minimum_period           = 10;
+    m_server.default_maximum_period           = 60;
+    m_server.disable_timeout                  = 86400;
+    m_server.binding.p_val                    = "U";
+    m_server.binding.len                      = 1;
+
+    m_temperature.units.p_val                 = "Cel";
+    m_temperature.units.len                   = 3;
+    m_temperature.min_measured_value          = -3.25f;
+    m_temperature.max_measured_value          = 38.7f;
+    m_temperature.min_range_value             = -40.0f;
+    m_temperature.max_range_value             = 125.0f;
+
+    err_code |= bench_encode("3201 digital output, TLV", digital_output_tlv_encode);
+    err_code |= bench_encode("3201 digital output, SenML-JSON", digital_output_json_encode);
+    err_code |= bench_encode("3201 digital output, SenML-CBOR", digital_output_cbor_encode);
+    err_code |= bench_encode("1 server, TLV", server_tlv_encode);
+    err_code |= bench_encode("1 server, SenML-JSON", server_json_encode);
+    err_code |= bench_encode("1 server, SenML-CBOR", server_cbor_encode);
+    err_code |= bench_encode("3303 temperature, TLV", temperature_tlv_encode);
+    err_code |= bench_encode("3303 temperature, SenML-JSON", temperature_json_encode);
+    err_code |= bench_encode("3303 temperature, SenML-CBOR", temperature_cbor_encode);
+
+    return (err_code == NRF_SUCCESS) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,137 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the Memory Manager reserve and free paths.
+ *
+ * @details Only nrf_mem_init, nrf_malloc and nrf_free are used, so the benchmark can also be built
+ *          against the block scanning implementation of an earlier revision, for example:
+ *
+ *          git show <revision>:components/libraries/mem_manager/mem_manager.c > /tmp/mm_old.c
+ *          make bench bench_mem_manager_SRC="bench/mem_manager/bench_mem_manager.c /tmp/mm_old.c"
+ */
+
+#include <stdlib.h>
+#include "sdk_config.h"
+#include "mem_manager.h"
+#include "bench.h"
+
+#define ITERATIONS            200000                                                                /**< Number of iterations of each measurement. */
+#define MAX_BLOCKS            256                                                                   /**< Upper bound on the number of blocks in the pool. */
+
+
+static void * m_blocks[MAX_BLOCKS];
+
+
+/**@brief Reserve blocks of one size until the pool is exhausted, then free them in reverse order.
+ *        An operation is one reserve and one free. */
+static void bench_fill_drain(const char * p_name, uint32_t size)
+{
+    uint64_t operations = 0;
+    uint64_t start      = bench_time_ns();
+
+    for (uint32_t i = 0; i < ITERATIONS / 50; i++)
+    {
+        uint32_t count = 0;
+
+        while (count < MAX_BLOCKS)
+        {
+            m_blocks[count] = nrf_malloc(size);
+
+            if (m_blocks[count] == NULL)
+            {
+                break;
+            }
+
+            count++;
+        }
+
+        while (count > 0)
+        {
+            nrf_free(m_blocks[--count]);
+            operations++;
+        }
+    }
+
+    bench_report(p_name, start, operations);
+}
+
+
+/**@brief Free and reserve one block while the rest of the pool is held at random sizes. An
+ *        operation is one free and one reserve. */
+static void bench_churn(const char * p_name, uint32_t max_size)
+{
+    uint32_t seed  = 1;
+    uint32_t count = 0;
+
+    // Hold about three quarters of the pool.
+    while (count < MAX_BLOCKS)
+    {
+        m_blocks[count] = nrf_malloc(1 + (bench_rand(&seed) % max_size));
+
+        if (m_blocks[count] == NULL)
+        {
+            break;
+        }
+
+        count++;
+    }
+
+    for (uint32_t i = 0; i < count / 4; i++)
+    {
+        nrf_free(m_blocks[i]);
+        m_blocks[i] = NULL;
+    }
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint32_t index = bench_rand(&seed) % count;
+
+        if (m_blocks[index] != NULL)
+        {
+            nrf_free(m_blocks[index]);
+        }
+
+        m_blocks[index] = nrf_malloc(1 + (bench_rand(&seed) % max_size));
+    }
+
+    bench_report(p_name, start, ITERATIONS);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_blocks[i] != NULL)
+        {
+            nrf_free(m_blocks[i]);
+            m_blocks[i] = NULL;
+        }
+    }
+}
+
+
+int main(void)
+{
+    if (nrf_mem_init() != NRF_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Small requests spill into every larger category once the small blocks are used.
+    bench_fill_drain("fill/drain, small requests", MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+    bench_fill_drain("fill/drain, medium requests", MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+    bench_churn("churn, 1 to small block size", MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+    bench_churn("churn, 1 to large block size", MEMORY_MANAGER_LARGE_BLOCK_SIZE);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,105 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the streaming receive decoder of the MQTT client (mqtt_rx_decode). A stream
+ *        of publishes is fed to the decoder in TCP segments of 1460 bytes. An operation is one
+ *        segment.
+ *
+ * @details Publishes of 64 bytes mostly lie within a segment and are decoded in place. Publishes
+ *          of 600 bytes mostly span segments and are reassembled in a buffer of the Memory Manager.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "mem_manager.h"
+#include "mqtt_internal.h"
+#include "bench.h"
+
+#define STREAM_SIZE           (1024 * 1024)                                                         /**< Size of the stream of publishes. */
+#define SEGMENT_SIZE          1460                                                                  /**< Size of a TCP segment, the maximum segment size of Ethernet. */
+#define RUNS                  50                                                                    /**< Number of times the stream is decoded in each measurement. */
+
+static mqtt_client_t     m_client;
+static uint8_t           m_stream[STREAM_SIZE];
+static volatile uint32_t m_received_size;                                                           /**< Result, so that the decoding is not optimized away. */
+
+
+uint32_t mqtt_handle_rx_data(mqtt_client_t * p_client, uint8_t * p_data, uint32_t datalen)
+{
+    m_received_size += datalen + p_data[datalen - 1];
+
+    return NRF_SUCCESS;
+}
+
+
+static void bench_publish_stream(const char * p_name, uint32_t publish_size)
+{
+    uint32_t stream_size = 0;
+    uint32_t segments    = 0;
+
+    // Publishes with a remaining length of one or two bytes.
+    while (stream_size + publish_size <= STREAM_SIZE)
+    {
+        uint32_t body_size = publish_size - ((publish_size > 129) ? 3 : 2);
+
+        m_stream[stream_size]     = MQTT_PKT_TYPE_PUBLISH;
+        m_stream[stream_size + 1] = (uint8_t)(body_size | ((body_size > 127) ? 0x80 : 0));
+
+        if (body_size > 127)
+        {
+            m_stream[stream_size + 2] = (uint8_t)(body_size >> 7);
+        }
+
+        memset(&m_stream[stream_size + publish_size - body_size], 0xAA, body_size);
+        stream_size += publish_size;
+    }
+
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.state = MQTT_STATE_CONNECTED;
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t run = 0; run < RUNS; run++)
+    {
+        for (uint32_t offset = 0; offset < stream_size; offset += SEGMENT_SIZE)
+        {
+            UNUSED_VARIABLE(mqtt_rx_decode(&m_client,
+                                           &m_stream[offset],
+                                           MIN(SEGMENT_SIZE, stream_size - offset)));
+            segments++;
+        }
+    }
+
+    bench_report(p_name, start, segments);
+
+    printf("    %u publishes, %u reassembled, %u dropped\n",
+           (unsigned int)m_client.stats.rx_packets,
+           (unsigned int)m_client.stats.rx_reassembled,
+           (unsigned int)m_client.stats.rx_dropped);
+}
+
+
+int main(void)
+{
+    if (nrf_mem_init() != NRF_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+
+    bench_publish_stream("mqtt_rx_decode, 64 byte publishes", 64);
+    bench_publish_stream("mqtt_rx_decode, 600 byte publishes", 600);
+
+    return EXIT_SUCCESS;
+}
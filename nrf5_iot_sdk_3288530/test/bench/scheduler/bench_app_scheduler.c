@@ -0,0 +1,186 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the scheduler: events per second through put or reserve/commit and
+ *        execute, and the time spent in critical regions.
+ *
+ * @details Each measurement runs twice. The first run is timed as a whole. The second run times
+ *          each critical region using the hook of the host platform, and reports the mean, the
+ *          99.99th percentile and the longest time spent in one. Reading the clock in the hook adds
+ *          to the times reported, and the longest time also includes preemption by the host.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "app_scheduler.h"
+#include "app_util_platform.h"
+#include "bench.h"
+
+#define ITERATIONS            100000                                                                /**< Number of batches of events of each measurement. */
+#define EVENT_SIZE            16                                                                    /**< Size of the event data. */
+#define QUEUE_SIZE            32                                                                    /**< Number of entries in each queue, and number of events in a batch. */
+#define HISTOGRAM_SIZE        4096                                                                  /**< Number of 1 ns buckets of the critical region histogram. */
+
+static uint32_t m_buffer[CEIL_DIV(APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE), sizeof(uint32_t))];
+static volatile uint32_t m_sum;                                                                     /**< Sum of event data, so that the handler is not optimized away. */
+
+static uint64_t m_region_start;                                                                     /**< Time the current critical region was entered at. */
+static uint64_t m_region_max;                                                                       /**< Longest time spent in a critical region. */
+static uint64_t m_region_total;                                                                     /**< Total time spent in critical regions. */
+static uint64_t m_region_count;                                                                     /**< Number of critical regions. */
+static uint32_t m_region_histogram[HISTOGRAM_SIZE];                                                 /**< Number of critical regions per time spent in them, the last bucket holds longer ones. */
+
+/**@brief Producer of a batch of events. */
+typedef void (*batch_put_t)(uint32_t batch);
+
+
+static void critical_region_hook(bool enter)
+{
+    if (enter)
+    {
+        m_region_start = bench_time_ns();
+    }
+    else
+    {
+        uint64_t elapsed = bench_time_ns() - m_region_start;
+
+        m_region_total += elapsed;
+        m_region_count++;
+
+        if (elapsed > m_region_max)
+        {
+            m_region_max = elapsed;
+        }
+
+        m_region_histogram[(elapsed < HISTOGRAM_SIZE) ? elapsed : (HISTOGRAM_SIZE - 1)]++;
+    }
+}
+
+
+/**@brief Get the time spent in a critical region that the given fraction of regions does not
+ *        exceed. */
+static uint64_t region_percentile(double fraction)
+{
+    uint64_t limit = (uint64_t)((double)m_region_count * fraction);
+    uint64_t count = 0;
+
+    for (uint32_t i = 0; i < HISTOGRAM_SIZE; i++)
+    {
+        count += m_region_histogram[i];
+
+        if (count >= limit)
+        {
+            return i;
+        }
+    }
+
+    return HISTOGRAM_SIZE;
+}
+
+
+static void event_handler(void * p_event_data, uint16_t event_size)
+{
+    m_sum += ((uint32_t *)p_event_data)[0] + event_size;
+}
+
+
+static void batch_put(uint32_t batch)
+{
+    uint32_t event[EVENT_SIZE / sizeof(uint32_t)] = {batch};
+
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        (void)app_sched_event_put(event, EVENT_SIZE, event_handler);
+    }
+}
+
+
+static void batch_put_prio(uint32_t batch)
+{
+    uint32_t event[EVENT_SIZE / sizeof(uint32_t)] = {batch};
+
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        (void)app_sched_event_put_prio(event, EVENT_SIZE, event_handler,
+                                       i % APP_SCHED_PRIORITY_COUNT);
+    }
+}
+
+
+static void batch_reserve_commit(uint32_t batch)
+{
+    app_sched_slot_t slot;
+
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        if (app_sched_event_reserve(EVENT_SIZE, event_handler, &slot) == NRF_SUCCESS)
+        {
+            ((uint32_t *)slot.p_event_data)[0] = batch;
+            app_sched_event_commit(&slot);
+        }
+    }
+}
+
+
+static void bench_events(const char * p_name, batch_put_t put)
+{
+    uint64_t start;
+
+    start = bench_time_ns();
+
+    for (uint32_t batch = 0; batch < ITERATIONS; batch++)
+    {
+        put(batch);
+        app_sched_execute();
+    }
+
+    bench_report(p_name, start, (uint64_t)ITERATIONS * QUEUE_SIZE);
+
+    m_region_max   = 0;
+    m_region_total = 0;
+    m_region_count = 0;
+    memset(m_region_histogram, 0, sizeof(m_region_histogram));
+
+    host_critical_region_hook_set(critical_region_hook);
+
+    for (uint32_t batch = 0; batch < ITERATIONS; batch++)
+    {
+        put(batch);
+        app_sched_execute();
+    }
+
+    host_critical_region_hook_set(NULL);
+
+    printf("%-40s %10.1f ns mean %6" PRIu64 " ns 99.99%% %8" PRIu64 " ns max\n",
+           "  critical region",
+           (m_region_count != 0) ? (double)m_region_total / (double)m_region_count : 0.0,
+           region_percentile(0.9999),
+           m_region_max);
+}
+
+
+int main(void)
+{
+    if (app_sched_init(EVENT_SIZE, QUEUE_SIZE, m_buffer) != NRF_SUCCESS)
+    {
+        return EXIT_FAILURE;
+    }
+
+    bench_events("put and execute", batch_put);
+    bench_events("put and execute, all priorities", batch_put_prio);
+    bench_events("reserve/commit and execute", batch_reserve_commit);
+
+    return EXIT_SUCCESS;
+}
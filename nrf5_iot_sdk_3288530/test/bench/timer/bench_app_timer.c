@@ -0,0 +1,156 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of app_timer with 1000 timers on an emulated RTC1, built once for the sorted
+ *        list and once for the timer wheel (APP_TIMER_WITH_WHEEL).
+ *
+ * @details The time measured includes handling of the timer operations and time-outs in the
+ *          emulated interrupt handlers, and the emulation of RTC1 itself.
+ */
+
+#include <stdlib.h>
+#include "app_timer.h"
+#include "host_rtc.h"
+#include "bench.h"
+
+#define TIMER_COUNT           1000                                                                  /**< Number of timers. */
+#define OP_QUEUE_SIZE         8                                                                     /**< Size of the timer operation queues. */
+#define RESTART_COUNT         20000                                                                 /**< Number of restarts measured. */
+#define CHURN_TICKS           2000000                                                               /**< Number of ticks of the churn measurement. */
+
+static uint32_t       m_buffer[CEIL_DIV(APP_TIMER_BUF_SIZE(OP_QUEUE_SIZE + 1), sizeof(uint32_t))];
+static app_timer_t    m_timer_data[TIMER_COUNT];
+static app_timer_id_t m_timers[TIMER_COUNT];
+static uint32_t       m_seed = 1;
+static uint64_t       m_expired_count;
+
+
+static void timeout_handler(void * p_context)
+{
+    (void)p_context;
+    m_expired_count++;
+}
+
+
+static void timers_init(void)
+{
+    host_rtc1_reset();
+
+    if (app_timer_init(0, OP_QUEUE_SIZE + 1, m_buffer, NULL) != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        m_timers[i] = &m_timer_data[i];
+
+        if (app_timer_create(&m_timers[i],
+                             ((i % 3) == 0) ? APP_TIMER_MODE_REPEATED : APP_TIMER_MODE_SINGLE_SHOT,
+                             timeout_handler) != NRF_SUCCESS)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+static void timer_start(uint32_t index, uint32_t max_timeout)
+{
+    uint32_t timeout = APP_TIMER_MIN_TIMEOUT_TICKS + (bench_rand(&m_seed) % max_timeout);
+
+    (void)app_timer_start(m_timers[index], timeout, NULL);
+    host_irq_handle();
+}
+
+
+/**@brief Restart random timers while all timers are running. An operation is one stop and one
+ *        start, each handled by the SWI handler. */
+static void bench_restart(void)
+{
+    timers_init();
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        timer_start(i, 0x7FFFFF);
+    }
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t i = 0; i < RESTART_COUNT; i++)
+    {
+        uint32_t index = bench_rand(&m_seed) % TIMER_COUNT;
+
+        (void)app_timer_stop(m_timers[index]);
+        host_irq_handle();
+        timer_start(index, 0x7FFFFF);
+    }
+
+    bench_report("restart, 1000 timers running", start, RESTART_COUNT);
+
+    (void)app_timer_stop_all();
+    host_irq_handle();
+}
+
+
+/**@brief Run ticks while starting a random timer every 16 ticks, with time-outs up to 50000
+ *        ticks. An operation is one tick. */
+static void bench_churn(void)
+{
+    timers_init();
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        timer_start(i, 50000);
+    }
+
+    m_expired_count = 0;
+
+    uint64_t start = bench_time_ns();
+
+    for (uint32_t tick = 0; tick < CHURN_TICKS; tick++)
+    {
+        host_rtc1_tick();
+
+        if ((tick % 16) == 0)
+        {
+            uint32_t index = bench_rand(&m_seed) % TIMER_COUNT;
+
+            (void)app_timer_stop(m_timers[index]);
+            host_irq_handle();
+            timer_start(index, 50000);
+        }
+    }
+
+    bench_report("churn, 1000 timers, per tick", start, CHURN_TICKS);
+    printf("%-40s %10.1f per tick\n", "  time-outs", (double)m_expired_count / CHURN_TICKS);
+
+    (void)app_timer_stop_all();
+    host_irq_handle();
+}
+
+
+int main(void)
+{
+#ifdef APP_TIMER_WITH_WHEEL
+    printf("timer wheel\n");
+#else
+    printf("sorted list\n");
+#endif // APP_TIMER_WITH_WHEEL
+
+    bench_restart();
+    bench_churn();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,237 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Benchmark of the delivery of received datagrams to UDP sockets. An operation is one
+ *        datagram given to udp_input, checksummed and handed to the receive callback of its socket.
+ *
+ * @details UDP6_MAX_SOCKET_COUNT sockets are bound to consecutive ports, and datagrams are sent to
+ *          each of them in turn, then to the socket bound first only and to the socket bound last
+ *          only. The same is done with ports that all fall in one port hash bucket, the worst case
+ *          of the hash. Only the public API and udp_input are used, so the benchmark also builds
+ *          against an earlier revision of udp6.c, for example:
+ *
+ *          git show <revision>:components/iot/ipv6_stack/udp/udp6.c > /tmp/udp6_old.c
+ *          make bench bench_udp6_SRC="bench/udp6/bench_udp6.c /tmp/udp6_old.c \
+ *                                     ../components/iot/ipv6_stack/utils/ipv6_utils.c"
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ipv6_api.h"
+#include "udp_api.h"
+#include "udp.h"
+#include "ipv6_utils.h"
+#include "bench.h"
+
+#define UDP_HEADER_SIZE       8                                                                     /**< Size of the UDP header. */
+#define PAYLOAD_SIZE          16                                                                    /**< Size of the payload of the datagrams. */
+#define PEER_PORT             40000                                                                 /**< Source port of the datagrams. */
+#define FIRST_PORT            49152                                                                 /**< Port of the first socket. */
+#define BUCKET_STRIDE         0x0008                                                                /**< Distance between ports hashed to the same bucket, for up to 8 buckets, within 256 ports. */
+#define DATAGRAM_COUNT        1000000                                                               /**< Number of datagrams in each measurement. */
+
+/**@brief A datagram to one of the sockets, with its IPv6 header. */
+typedef struct
+{
+    ipv6_header_t ip_header;
+    uint8_t       datagram[UDP_HEADER_SIZE + PAYLOAD_SIZE];
+} datagram_t;
+
+ipv6_addr_t              ipv6_addr_any;                                                             /**< Unspecified address, defined by the IPv6 layer. */
+
+static const ipv6_addr_t m_local_addr = {{0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01}};
+static const ipv6_addr_t m_peer_addr  = {{0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02}};
+
+static iot_interface_t   m_interface;
+static udp6_socket_t     m_sockets[UDP6_MAX_SOCKET_COUNT];
+static datagram_t        m_datagrams[UDP6_MAX_SOCKET_COUNT];                                        /**< Datagram to each socket. */
+static uint32_t          m_rx_count[UDP6_MAX_SOCKET_COUNT];                                         /**< Number of datagrams received by each socket. */
+
+
+uint32_t ipv6_address_find_best_match(iot_interface_t     ** pp_interface,
+                                      ipv6_addr_t          * p_addr_r,
+                                      const ipv6_addr_t    * p_addr_f)
+{
+    return NRF_ERROR_NOT_FOUND;
+}
+
+
+uint32_t ipv6_send(const iot_interface_t * p_interface, iot_pbuffer_t * p_packet)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+static uint32_t rx_handler(const udp6_socket_t * p_socket,
+                           const ipv6_header_t * p_ip_header,
+                           const udp6_header_t * p_udp_header,
+                           uint32_t              process_result,
+                           iot_pbuffer_t       * p_rx_packet)
+{
+    if (process_result != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    m_rx_count[p_socket->socket_id]++;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Build the datagram to a port. */
+static void datagram_build(datagram_t * p_datagram, uint16_t dest_port)
+{
+    udp6_header_t * p_udp_header = (udp6_header_t *)p_datagram->datagram;
+    uint16_t        checksum     = sizeof(p_datagram->datagram) + IPV6_NEXT_HEADER_UDP;
+
+    memset(p_datagram, 0, sizeof(datagram_t));
+
+    p_datagram->ip_header.length      = HTONS(sizeof(p_datagram->datagram));
+    p_datagram->ip_header.next_header = IPV6_NEXT_HEADER_UDP;
+    p_datagram->ip_header.srcaddr     = m_peer_addr;
+    p_datagram->ip_header.destaddr    = m_local_addr;
+
+    p_udp_header->srcport  = HTONS(PEER_PORT);
+    p_udp_header->destport = HTONS(dest_port);
+    p_udp_header->length   = HTONS(sizeof(p_datagram->datagram));
+
+    ipv6_checksum_calculate(m_peer_addr.u8, IPV6_ADDR_SIZE, &checksum, false);
+    ipv6_checksum_calculate(m_local_addr.u8, IPV6_ADDR_SIZE, &checksum, false);
+    ipv6_checksum_calculate(p_datagram->datagram, sizeof(p_datagram->datagram), &checksum, true);
+
+    p_udp_header->checksum = HTONS((uint16_t)~checksum);
+}
+
+
+/**@brief Give a datagram to udp_input. udp_input converts the header to host byte order for the
+ *        receive callback, so the datagram is given from a copy.
+ */
+static void datagram_input(const datagram_t * p_datagram)
+{
+    datagram_t    datagram = (*p_datagram);
+    iot_pbuffer_t packet;
+
+    packet.type      = UDP6_PACKET_TYPE;
+    packet.p_memory  = datagram.datagram;
+    packet.p_payload = datagram.datagram;
+    packet.length    = sizeof(datagram.datagram);
+
+    if (udp_input(&m_interface, &datagram.ip_header, &packet) != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/**@brief Open every socket, on consecutive ports or on ports of the same port hash bucket. */
+static void sockets_open(bool one_bucket)
+{
+    if (udp_init() != NRF_SUCCESS)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i++)
+    {
+        uint16_t port = (uint16_t)(FIRST_PORT + i);
+
+        if (one_bucket)
+        {
+            // Moving both bytes of the port by the stride keeps it in the bucket.
+            port = (uint16_t)(FIRST_PORT +
+                              (i % 32) * BUCKET_STRIDE +
+                              (i / 32) * (BUCKET_STRIDE << 8));
+        }
+
+        if ((udp6_socket_allocate(&m_sockets[i]) != NRF_SUCCESS) ||
+            (udp6_socket_bind(&m_sockets[i], IPV6_ADDR_ANY, port) != NRF_SUCCESS) ||
+            (udp6_socket_recv(&m_sockets[i], rx_handler) != NRF_SUCCESS))
+        {
+            exit(EXIT_FAILURE);
+        }
+
+        datagram_build(&m_datagrams[i], port);
+    }
+}
+
+
+/**@brief Send datagrams to one socket, or to every socket in turn if index is
+ *        UDP6_MAX_SOCKET_COUNT, and check that each socket received its datagrams.
+ */
+static void bench_input(const char * p_name, const char * p_target, uint32_t index)
+{
+    char     name[64];
+    uint64_t start = bench_time_ns();
+
+    memset(m_rx_count, 0, sizeof(m_rx_count));
+
+    for (uint32_t i = 0; i < DATAGRAM_COUNT; i++)
+    {
+        datagram_input(&m_datagrams[(index < UDP6_MAX_SOCKET_COUNT) ? index :
+                                                                      (i % UDP6_MAX_SOCKET_COUNT)]);
+    }
+
+    (void)snprintf(name, sizeof(name), "%s, %s", p_name, p_target);
+    bench_report(name, start, DATAGRAM_COUNT);
+
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i++)
+    {
+        uint32_t expected = 0;
+
+        if (index == i)
+        {
+            expected = DATAGRAM_COUNT;
+        }
+        else if (index == UDP6_MAX_SOCKET_COUNT)
+        {
+            expected = (DATAGRAM_COUNT / UDP6_MAX_SOCKET_COUNT) +
+                       ((i < (DATAGRAM_COUNT % UDP6_MAX_SOCKET_COUNT)) ? 1 : 0);
+        }
+
+        if (m_rx_count[m_sockets[i].socket_id] != expected)
+        {
+            printf("%s: socket %u received %u datagrams\n",
+                   name,
+                   (unsigned int)i,
+                   (unsigned int)m_rx_count[m_sockets[i].socket_id]);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+
+/**@brief Send datagrams to every socket in turn, then to the socket bound first and last. */
+static void bench_sockets(const char * p_name)
+{
+    bench_input(p_name, "each socket", UDP6_MAX_SOCKET_COUNT);
+    bench_input(p_name, "first socket", 0);
+    bench_input(p_name, "last socket", UDP6_MAX_SOCKET_COUNT - 1);
+}
+
+
+int main(void)
+{
+    char name[64];
+
+    (void)snprintf(name, sizeof(name), "%u sockets", (unsigned int)UDP6_MAX_SOCKET_COUNT);
+    sockets_open(false);
+    bench_sockets(name);
+
+    (void)snprintf(name, sizeof(name), "%u sockets, 1 bucket", (unsigned int)UDP6_MAX_SOCKET_COUNT);
+    sockets_open(true);
+    bench_sockets(name);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,38 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ */
+
+/** @cond To make doxygen skip this file */
+
+/** @file
+ *  This header needs to include the desired IPv6 medium implementation(s).
+ *  The host unit tests and benchmarks run the IPv6 stack on the host loopback medium.
+ * @{
+ */
+
+#ifndef IPV6_MEDIUM_PLATFORM_H__
+#define IPV6_MEDIUM_PLATFORM_H__
+
+#include "ipv6_medium_host.h"
+
+typedef union
+{
+    ipv6_medium_host_cb_params_t host;
+} ipv6_medium_cb_params_union_t;
+
+typedef union
+{
+    ipv6_medium_host_error_params_t host;
+} ipv6_medium_err_params_union_t;
+
+#endif // IPV6_MEDIUM_PLATFORM_H__
+
+/** @} */
+/** @endcond */
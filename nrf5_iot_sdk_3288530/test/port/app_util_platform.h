@@ -0,0 +1,70 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Host stand-in for app_util_platform.h of the host unit tests and benchmarks.
+ *
+ * @details Critical regions are functions of host_platform.c that count the nesting level and
+ *          call an optional hook, so that a test can check that a region is balanced and a
+ *          benchmark can time it. The current interrupt priority is a variable that a test sets to
+ *          simulate running in an interrupt handler.
+ */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "compiler_abstraction.h"
+#include "nrf.h"
+#include "app_error.h"
+
+/**@brief The interrupt priorities available to the application. */
+typedef enum
+{
+    APP_IRQ_PRIORITY_HIGHEST = 0,
+    APP_IRQ_PRIORITY_HIGH    = 1,
+    APP_IRQ_PRIORITY_MID     = 2,
+    APP_IRQ_PRIORITY_LOW     = 3
+} app_irq_priority_t;
+
+#define NRF_APP_PRIORITY_THREAD    4                    /**< "Interrupt level" when running in Thread Mode. */
+
+#define PACKED(TYPE) TYPE __attribute__((packed))
+
+/**@brief Critical region hook, called with true on entry to and false on exit from the outermost
+ *        critical region. */
+typedef void (*host_critical_region_hook_t)(bool enter);
+
+extern uint8_t  host_int_priority;                      /**< Value returned by @ref current_int_priority_get. */
+extern uint32_t host_critical_region_nesting;           /**< Current nesting level of critical regions. */
+
+void critical_region_enter(void);
+void critical_region_exit(void);
+
+/**@brief Function for setting the hook called on entry to and exit from critical regions.
+ *
+ * @param[in] hook   Hook to call, NULL for none.
+ */
+void host_critical_region_hook_set(host_critical_region_hook_t hook);
+
+#define CRITICAL_REGION_ENTER() critical_region_enter()
+#define CRITICAL_REGION_EXIT()  critical_region_exit()
+
+/**@brief Function for finding the current interrupt level, see @ref host_int_priority. */
+static __INLINE uint8_t current_int_priority_get(void)
+{
+    return host_int_priority;
+}
+
+#endif // APP_UTIL_PLATFORM_H__
@@ -0,0 +1,56 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "app_util_platform.h"
+#include "app_error.h"
+
+uint8_t  host_int_priority            = NRF_APP_PRIORITY_THREAD;
+uint32_t host_critical_region_nesting = 0;
+
+static host_critical_region_hook_t m_hook;                  /**< Hook called on entry to and exit from the outermost critical region. */
+
+
+void critical_region_enter(void)
+{
+    if ((host_critical_region_nesting++ == 0) && (m_hook != NULL))
+    {
+        m_hook(true);
+    }
+}
+
+
+void critical_region_exit(void)
+{
+    if ((--host_critical_region_nesting == 0) && (m_hook != NULL))
+    {
+        m_hook(false);
+    }
+}
+
+
+void host_critical_region_hook_set(host_critical_region_hook_t hook)
+{
+    m_hook = hook;
+}
+
+
+void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+    printf("error 0x%08x at %s:%u\n",
+           (unsigned int)error_code,
+           (p_file_name != NULL) ? (const char *)p_file_name : "?",
+           (unsigned int)line_num);
+    abort();
+}
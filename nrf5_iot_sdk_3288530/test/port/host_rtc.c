@@ -0,0 +1,154 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "host_rtc.h"
+#include "app_util_platform.h"
+
+#define RTC_COUNTER_MASK      0x00FFFFFF                                                            /**< The RTC counter is 24 bits wide. */
+
+void RTC1_IRQHandler(void);
+void SWI0_EGU0_IRQHandler(void);
+
+static NRF_RTC_Type m_rtc1;                                                                         /**< Registers of RTC1 as seen by the module under test. */
+static bool         m_rtc1_started;                                                                 /**< True if RTC1 is started. */
+static uint32_t     m_rtc1_evten;                                                                   /**< Enabled events of RTC1. */
+static uint32_t     m_rtc1_inten;                                                                   /**< Enabled interrupts of RTC1. */
+static uint32_t     m_irq_enabled;                                                                  /**< Enabled interrupts, one bit per IRQn. */
+static uint32_t     m_irq_pending;                                                                  /**< Pending interrupts, one bit per IRQn. */
+
+
+NRF_RTC_Type * host_rtc1_get(void)
+{
+    if (m_rtc1.TASKS_CLEAR != 0)
+    {
+        m_rtc1.TASKS_CLEAR = 0;
+        m_rtc1.COUNTER     = 0;
+    }
+
+    if (m_rtc1.TASKS_START != 0)
+    {
+        m_rtc1.TASKS_START = 0;
+        m_rtc1_started     = true;
+    }
+
+    if (m_rtc1.TASKS_STOP != 0)
+    {
+        m_rtc1.TASKS_STOP = 0;
+        m_rtc1_started    = false;
+    }
+
+    m_rtc1_evten    |= m_rtc1.EVTENSET;
+    m_rtc1_evten    &= ~m_rtc1.EVTENCLR;
+    m_rtc1_inten    |= m_rtc1.INTENSET;
+    m_rtc1_inten    &= ~m_rtc1.INTENCLR;
+    m_rtc1.EVTENSET  = 0;
+    m_rtc1.EVTENCLR  = 0;
+    m_rtc1.INTENSET  = 0;
+    m_rtc1.INTENCLR  = 0;
+
+    return &m_rtc1;
+}
+
+
+void host_rtc1_tick(void)
+{
+    NRF_RTC_Type * p_rtc = host_rtc1_get();
+
+    if (m_rtc1_started)
+    {
+        p_rtc->COUNTER = (p_rtc->COUNTER + 1) & RTC_COUNTER_MASK;
+
+        if (p_rtc->COUNTER == p_rtc->CC[0])
+        {
+            if ((m_rtc1_evten & RTC_EVTEN_COMPARE0_Msk) != 0)
+            {
+                p_rtc->EVENTS_COMPARE[0] = 1;
+            }
+
+            if ((m_rtc1_inten & RTC_INTENSET_COMPARE0_Msk) != 0)
+            {
+                NVIC_SetPendingIRQ(RTC1_IRQn);
+            }
+        }
+    }
+
+    host_irq_handle();
+}
+
+
+void host_irq_handle(void)
+{
+    uint8_t int_priority = host_int_priority;
+
+    host_int_priority = APP_IRQ_PRIORITY_LOW;
+
+    while ((m_irq_pending & m_irq_enabled) != 0)
+    {
+        if ((m_irq_pending & m_irq_enabled & (1UL << RTC1_IRQn)) != 0)
+        {
+            m_irq_pending &= ~(1UL << RTC1_IRQn);
+            RTC1_IRQHandler();
+        }
+        else
+        {
+            m_irq_pending &= ~(1UL << SWI0_EGU0_IRQn);
+            SWI0_EGU0_IRQHandler();
+        }
+    }
+
+    host_int_priority = int_priority;
+}
+
+
+void host_rtc1_reset(void)
+{
+    memset(&m_rtc1, 0, sizeof(m_rtc1));
+
+    m_rtc1_started = false;
+    m_rtc1_evten   = 0;
+    m_rtc1_inten   = 0;
+    m_irq_enabled  = 0;
+    m_irq_pending  = 0;
+}
+
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority)
+{
+    (void)irq;
+    (void)priority;
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    m_irq_enabled |= (1UL << irq);
+}
+
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    m_irq_enabled &= ~(1UL << irq);
+}
+
+
+void NVIC_SetPendingIRQ(IRQn_Type irq)
+{
+    m_irq_pending |= (1UL << irq);
+}
+
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+    m_irq_pending &= ~(1UL << irq);
+}
@@ -0,0 +1,48 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Emulation of RTC1 and of the NVIC for the host unit tests and benchmarks of app_timer.
+ *
+ * @details Writes to the task and the set/clear registers of RTC1 take effect at the next access
+ *          to NRF_RTC1. The counter only advances when @ref host_rtc1_tick is called, which also
+ *          runs the interrupt handlers of app_timer if their interrupts are pending and enabled.
+ *          Interrupt handlers run with @ref host_int_priority set to APP_IRQ_PRIORITY_LOW, and are
+ *          not preempted.
+ */
+
+#ifndef HOST_RTC_H__
+#define HOST_RTC_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+/**@brief Function for advancing the RTC1 counter by one tick.
+ *
+ * @details The counter advances only if RTC1 is started. A compare event on CC[0] makes the RTC1
+ *          interrupt pending if the compare interrupt is enabled. Pending interrupts are handled
+ *          before the function returns.
+ */
+void host_rtc1_tick(void);
+
+/**@brief Function for handling pending interrupts.
+ *
+ * @details Call after operations from thread mode that trigger an interrupt, such as starting or
+ *          stopping a timer, to run the interrupt handler before the next tick.
+ */
+void host_irq_handle(void);
+
+/**@brief Function for resetting RTC1 and the NVIC to their state after reset. */
+void host_rtc1_reset(void);
+
+#endif // HOST_RTC_H__
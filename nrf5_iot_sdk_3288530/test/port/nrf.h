@@ -0,0 +1,68 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Host stand-in for the device header of the host unit tests and benchmarks.
+ *
+ * @details The device header of the SDK is empty when building for a host. This header provides
+ *          the few device definitions that the modules under test refer to. The RTC and NVIC are
+ *          emulated by host_rtc.c, see host_rtc.h.
+ */
+
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+/**@brief Interrupt numbers referred to by the modules under test. */
+typedef enum
+{
+    RTC1_IRQn      = 17,
+    SWI0_EGU0_IRQn = 20
+} IRQn_Type;
+
+/**@brief Registers of the RTC used by the modules under test, see host_rtc.h. */
+typedef struct
+{
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_CLEAR;
+    volatile uint32_t EVENTS_TICK;
+    volatile uint32_t EVENTS_OVRFLW;
+    volatile uint32_t EVENTS_COMPARE[4];
+    volatile uint32_t INTENSET;
+    volatile uint32_t INTENCLR;
+    volatile uint32_t EVTENSET;
+    volatile uint32_t EVTENCLR;
+    volatile uint32_t COUNTER;
+    volatile uint32_t PRESCALER;
+    volatile uint32_t CC[4];
+} NRF_RTC_Type;
+
+NRF_RTC_Type * host_rtc1_get(void);
+
+#define NRF_RTC1                   (host_rtc1_get())
+
+#define RTC_EVTEN_COMPARE0_Pos     (16UL)
+#define RTC_EVTEN_COMPARE0_Msk     (0x1UL << RTC_EVTEN_COMPARE0_Pos)
+#define RTC_INTENSET_COMPARE0_Pos  (16UL)
+#define RTC_INTENSET_COMPARE0_Msk  (0x1UL << RTC_INTENSET_COMPARE0_Pos)
+
+void NVIC_SetPriority(IRQn_Type irq, uint32_t priority);
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+void NVIC_SetPendingIRQ(IRQn_Type irq);
+void NVIC_ClearPendingIRQ(IRQn_Type irq);
+
+#endif // NRF_H
@@ -0,0 +1,33 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Host stand-in for nrf_delay.h of the host unit tests and benchmarks.
+ *
+ * @details Delays do not take time on the host. Tasks triggered on the emulated RTC take effect
+ *          at the next access to its registers, which is at the latest the delay that follows them.
+ */
+
+#ifndef NRF_DELAY_H
+#define NRF_DELAY_H
+
+#include <stdint.h>
+#include "nrf.h"
+
+static __INLINE void nrf_delay_us(uint32_t volatile number_of_us)
+{
+    (void)number_of_us;
+    (void)NRF_RTC1;
+}
+
+#endif // NRF_DELAY_H
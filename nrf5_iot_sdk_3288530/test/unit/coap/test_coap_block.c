@@ -0,0 +1,692 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the CoAP block-wise transfer engine (coap_block.h), client and server
+ *        talking to each other over a host loopback transport.
+ *
+ * @details Datagrams written by CoAP are queued and given back to coap_transport_read, so that
+ *          the requests of the client reach the resources of the server and the responses reach
+ *          the client. Datagrams can be dropped to exercise retransmissions. Downloads (Block2)
+ *          and uploads (Block1) must reproduce the file byte for byte, the server must answer a
+ *          retransmitted last block with the final response, and must reduce the block size when
+ *          a block does not fit in the memory left. A request that cannot be written must be
+ *          removed from the queue, and not an earlier request with the same message ID.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_transport.h"
+#include "coap_block.h"
+#include "coap_queue.h"
+#include "iot_file.h"
+#include "iot_file_static.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the client and server. */
+#define MAX_DATAGRAM_SIZE     300                                                                   /**< Largest datagram written by CoAP. */
+#define DATAGRAM_QUEUE_SIZE   64                                                                    /**< Number of datagrams in flight on the loopback transport. */
+#define MAX_TICKS             5000                                                                  /**< Calls to coap_time_tick after which a transfer is considered stuck. */
+#define DOWNLOAD_SIZE         5000                                                                  /**< Size of the resource downloaded. */
+#define UPLOAD_SIZE           3001                                                                  /**< Size of the body uploaded. */
+#define SERVER_FILE_SIZE      4096                                                                  /**< Size of the file receiving uploads on the server. */
+#define EXCHANGE_LIFETIME     247                                                                   /**< EXCHANGE_LIFETIME of RFC 7252 with the default parameters, in ticks. */
+#define NO_EVT                0xFF                                                                  /**< No block-wise event notified yet. */
+#define CODE_PUT              0x03                                                                  /**< Code of a PUT request in the second byte of a datagram. */
+
+/**@brief Datagram on the loopback transport. */
+typedef struct
+{
+    uint8_t  data[MAX_DATAGRAM_SIZE];
+    uint16_t length;
+} datagram_t;
+
+static const coap_port_t m_port   = { .port_number = LOCAL_PORT_NUM };
+static coap_remote_t     m_remote = { .port_number = LOCAL_PORT_NUM };
+
+static datagram_t        m_queue[DATAGRAM_QUEUE_SIZE];                                              /**< Datagrams written by CoAP and not read yet. */
+static uint32_t          m_queue_head;
+static uint32_t          m_queue_tail;
+static uint32_t          m_write_count;                                                             /**< Number of datagrams written by CoAP. */
+static uint32_t          m_drop_every;                                                              /**< Drop every n-th datagram written, zero for none. */
+static uint32_t          m_drop_after;                                                              /**< Drop the datagrams written after this count. */
+static uint8_t           m_drop_code;                                                               /**< Drop the first datagram with this code, zero for none. */
+static uint32_t          m_write_error;                                                             /**< Error returned by the next write, NRF_SUCCESS for none. */
+static datagram_t        m_last_put;                                                                /**< Last PUT request written by the client. */
+static datagram_t        m_last_response;                                                           /**< Last datagram written that is not a request. */
+
+static coap_resource_t   m_root;
+static coap_resource_t   m_firmware;                                                                /**< Resource served block-wise with GET. */
+static coap_resource_t   m_config;                                                                  /**< Resource receiving block-wise PUT and POST. */
+
+static uint8_t           m_download_src[DOWNLOAD_SIZE];
+static uint8_t           m_download_dst[2 * DOWNLOAD_SIZE];
+static uint8_t           m_upload_src[UPLOAD_SIZE];
+static uint8_t           m_upload_dst[SERVER_FILE_SIZE];
+static iot_file_t        m_server_download_file;
+static iot_file_t        m_client_download_file;
+static iot_file_t        m_client_upload_file;
+static iot_file_t        m_server_upload_file;
+
+static uint8_t           m_client_evt;                                                              /**< Last event notified to the client. */
+static uint32_t          m_client_result;
+static uint32_t          m_client_size;
+static uint8_t           m_server_evt;                                                              /**< Last event notified to the server. */
+static uint32_t          m_server_size;
+static uint32_t          m_server_uploads;                                                          /**< Number of uploads completed on the server. */
+static uint32_t          m_server_gets;                                                             /**< Number of GET requests handled by the server. */
+static uint32_t          m_response_status;                                                         /**< Status of the last response notified to a request. */
+static uint32_t          m_response_count;
+static bool              m_hog_memory;                                                              /**< Leave only the memory for the response to the next GET. */
+static uint32_t          m_seed;                                                                    /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    ck_assert_uint_le(datalen, MAX_DATAGRAM_SIZE);
+
+    if (m_write_error != NRF_SUCCESS)
+    {
+        uint32_t err_code = m_write_error;
+
+        m_write_error = NRF_SUCCESS;
+        return err_code;
+    }
+
+    datagram_t * p_datagram = (p_data[1] == CODE_PUT) ? &m_last_put : &m_last_response;
+
+    memcpy(p_datagram->data, p_data, datalen);
+    p_datagram->length = datalen;
+
+    m_write_count++;
+
+    if ((m_drop_every != 0) && ((m_write_count % m_drop_every) == 0))
+    {
+        return NRF_SUCCESS;
+    }
+
+    if (m_write_count > m_drop_after)
+    {
+        return NRF_SUCCESS;
+    }
+
+    if ((m_drop_code != 0) && (p_data[1] == m_drop_code))
+    {
+        m_drop_code = 0;
+        return NRF_SUCCESS;
+    }
+
+    ck_assert_uint_lt(m_queue_tail - m_queue_head, DATAGRAM_QUEUE_SIZE);
+
+    memcpy(m_queue[m_queue_tail % DATAGRAM_QUEUE_SIZE].data, p_data, datalen);
+    m_queue[m_queue_tail % DATAGRAM_QUEUE_SIZE].length = datalen;
+    m_queue_tail++;
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+/**@brief Read a datagram back through CoAP. */
+static void datagram_read(datagram_t * p_datagram)
+{
+    (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, p_datagram->data, p_datagram->length);
+}
+
+
+/**@brief Read the queued datagrams, and those written meanwhile. */
+static void queue_flush(void)
+{
+    while (m_queue_head != m_queue_tail)
+    {
+        datagram_t datagram = m_queue[m_queue_head % DATAGRAM_QUEUE_SIZE];
+
+        m_queue_head++;
+        datagram_read(&datagram);
+    }
+}
+
+
+/**@brief Reserve the blocks of the Memory Manager that can hold a response with a block of
+ *        COAP_BLOCK_SIZE_PREFERRED bytes, except those needed to create the response.
+ *
+ * @return Number of blocks reserved, stored in pp_blocks.
+ */
+static uint32_t memory_hog(uint8_t ** pp_blocks, uint32_t max_count)
+{
+    uint32_t count = 0;
+
+    while (count < max_count)
+    {
+        pp_blocks[count] = nrf_malloc(MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+        if (pp_blocks[count] == NULL)
+        {
+            break;
+        }
+        count++;
+    }
+
+    // The message and its scratch buffer are kept, the buffer the block is serialized into is not.
+    uint32_t spare = (sizeof(coap_message_t) > MEMORY_MANAGER_SMALL_BLOCK_SIZE) ? 2 : 1;
+
+    ck_assert_uint_ge(count, spare);
+
+    while (spare-- > 0)
+    {
+        nrf_free(pp_blocks[--count]);
+    }
+
+    return count;
+}
+
+
+static coap_msg_code_t server_callback(coap_block_evt_t   evt,
+                                       uint32_t           result,
+                                       void             * p_arg,
+                                       iot_file_t       * p_file,
+                                       uint32_t           size,
+                                       coap_message_t   * p_message)
+{
+    m_server_evt  = evt;
+    m_server_size = size;
+
+    if (evt == COAP_BLOCK_EVT_UPLOAD_COMPLETE)
+    {
+        m_server_uploads++;
+    }
+
+    return COAP_CODE_204_CHANGED;
+}
+
+
+static coap_msg_code_t client_callback(coap_block_evt_t   evt,
+                                       uint32_t           result,
+                                       void             * p_arg,
+                                       iot_file_t       * p_file,
+                                       uint32_t           size,
+                                       coap_message_t   * p_message)
+{
+    m_client_evt    = evt;
+    m_client_result = result;
+    m_client_size   = size;
+
+    return COAP_CODE_204_CHANGED;
+}
+
+
+static void resource_callback(coap_resource_t * p_resource, coap_message_t * p_request)
+{
+    coap_block_server_conf_t conf =
+    {
+        .callback       = server_callback,
+        .content_format = COAP_CT_APP_OCTET_STREAM
+    };
+
+    uint8_t * blocks[64];
+    uint32_t  block_count = 0;
+
+    if (p_resource == &m_firmware)
+    {
+        conf.p_file = &m_server_download_file;
+        m_server_gets++;
+    }
+    else
+    {
+        conf.p_file = &m_server_upload_file;
+    }
+
+    if (m_hog_memory)
+    {
+        m_hog_memory = false;
+        block_count  = memory_hog(blocks, sizeof(blocks) / sizeof(blocks[0]));
+    }
+
+    ck_assert_uint_eq(coap_block_server_request_handle(p_request, &conf), NRF_SUCCESS);
+
+    while (block_count > 0)
+    {
+        nrf_free(blocks[--block_count]);
+    }
+}
+
+
+static void response_callback(uint32_t status, void * p_arg, coap_message_t * p_message)
+{
+    m_response_status = status;
+    m_response_count++;
+}
+
+
+/**@brief Create the template of the requests of a client transfer. */
+static coap_message_t * template_new(coap_msg_code_t code, const char * p_path)
+{
+    coap_message_conf_t config;
+    memset(&config, 0, sizeof(coap_message_conf_t));
+
+    config.type      = COAP_TYPE_CON;
+    config.code      = code;
+    config.port      = m_port;
+    config.token_len = 1;
+
+    coap_message_t * p_template;
+
+    ck_assert_uint_eq(coap_message_new(&p_template, &config), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_message_remote_addr_set(p_template, &m_remote), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_message_opt_str_add(p_template,
+                                               COAP_OPT_URI_PATH,
+                                               (uint8_t *)p_path,
+                                               strlen(p_path)), NRF_SUCCESS);
+
+    // An option after the Block options, to check that options are kept in order.
+    ck_assert_uint_eq(coap_message_opt_uint_add(p_template, COAP_OPT_ACCEPT, COAP_CT_APP_OCTET_STREAM),
+                      NRF_SUCCESS);
+
+    return p_template;
+}
+
+
+/**@brief Exchange datagrams until the client transfer ends.
+ *
+ * @return Number of calls to coap_time_tick.
+ */
+static uint32_t transfer_run(void)
+{
+    uint32_t ticks = 0;
+
+    for (;;)
+    {
+        queue_flush();
+
+        if (m_client_evt != NO_EVT)
+        {
+            return ticks;
+        }
+
+        ck_assert_uint_lt(ticks, MAX_TICKS);
+
+        (void)coap_time_tick();
+        ticks++;
+    }
+}
+
+
+/**@brief Download the resource, and check it is received whole. */
+static void download_check(void)
+{
+    uint32_t handle;
+
+    IOT_FILE_STATIC_INIT(&m_client_download_file, "dl", m_download_dst, sizeof(m_download_dst));
+    ck_assert_uint_eq(iot_file_fopen(&m_client_download_file, 0), NRF_SUCCESS);
+    memset(m_download_dst, 0, sizeof(m_download_dst));
+
+    coap_message_t * p_template = template_new(COAP_CODE_GET, "fw");
+
+    ck_assert_uint_eq(coap_block_client_start(&handle, p_template, &m_client_download_file,
+                                              client_callback, NULL), NRF_SUCCESS);
+    (void)transfer_run();
+
+    ck_assert_uint_eq(m_client_evt, COAP_BLOCK_EVT_DOWNLOAD_COMPLETE);
+    ck_assert_uint_eq(m_client_result, NRF_SUCCESS);
+    ck_assert_uint_eq(m_client_size, DOWNLOAD_SIZE);
+    ck_assert_uint_eq(m_client_download_file.file_size, DOWNLOAD_SIZE);
+    ck_assert_int_eq(memcmp(m_download_dst, m_download_src, DOWNLOAD_SIZE), 0);
+    ck_assert_uint_eq(m_server_evt, COAP_BLOCK_EVT_DOWNLOAD_COMPLETE);
+
+    ck_assert_uint_eq(coap_message_delete(p_template), NRF_SUCCESS);
+}
+
+
+/**@brief Upload the body, and check it is received whole. */
+static void upload_check(coap_msg_code_t code)
+{
+    uint32_t handle;
+
+    coap_message_t * p_template = template_new(code, "cfg");
+
+    ck_assert_uint_eq(coap_block_client_start(&handle, p_template, &m_client_upload_file,
+                                              client_callback, NULL), NRF_SUCCESS);
+    (void)transfer_run();
+
+    ck_assert_uint_eq(m_client_evt, COAP_BLOCK_EVT_UPLOAD_COMPLETE);
+    ck_assert_uint_eq(m_client_result, NRF_SUCCESS);
+    ck_assert_uint_eq(m_server_evt, COAP_BLOCK_EVT_UPLOAD_COMPLETE);
+    ck_assert_uint_eq(m_server_size, UPLOAD_SIZE);
+    ck_assert_uint_eq(m_server_uploads, 1);
+    ck_assert_uint_eq(m_server_upload_file.file_size, UPLOAD_SIZE);
+    ck_assert_int_eq(memcmp(m_upload_dst, m_upload_src, UPLOAD_SIZE), 0);
+
+    ck_assert_uint_eq(coap_message_delete(p_template), NRF_SUCCESS);
+}
+
+
+static void setup(void)
+{
+    coap_transport_init_t transport_params = { .p_port_table = (coap_port_t *)&m_port };
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_init(1, &transport_params), NRF_SUCCESS);
+
+    memset(&m_root, 0, sizeof(m_root));
+    memset(&m_firmware, 0, sizeof(m_firmware));
+    memset(&m_config, 0, sizeof(m_config));
+
+    ck_assert_uint_eq(coap_resource_create(&m_root, "/"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_firmware, "fw"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_config, "cfg"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_firmware), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_config), NRF_SUCCESS);
+
+    m_firmware.permission = COAP_PERM_GET;
+    m_firmware.callback   = resource_callback;
+    m_config.permission   = (COAP_PERM_PUT | COAP_PERM_POST);
+    m_config.callback     = resource_callback;
+
+    m_seed = 1;
+
+    for (uint32_t i = 0; i < DOWNLOAD_SIZE; i++)
+    {
+        m_download_src[i] = (uint8_t)rand_get();
+    }
+
+    for (uint32_t i = 0; i < UPLOAD_SIZE; i++)
+    {
+        m_upload_src[i] = (uint8_t)rand_get();
+    }
+
+    IOT_FILE_STATIC_INIT(&m_server_download_file, "fw", m_download_src, DOWNLOAD_SIZE);
+    ck_assert_uint_eq(iot_file_fopen(&m_server_download_file, DOWNLOAD_SIZE), NRF_SUCCESS);
+
+    IOT_FILE_STATIC_INIT(&m_client_upload_file, "up", m_upload_src, UPLOAD_SIZE);
+    ck_assert_uint_eq(iot_file_fopen(&m_client_upload_file, UPLOAD_SIZE), NRF_SUCCESS);
+
+    IOT_FILE_STATIC_INIT(&m_server_upload_file, "cfg", m_upload_dst, SERVER_FILE_SIZE);
+    ck_assert_uint_eq(iot_file_fopen(&m_server_upload_file, 0), NRF_SUCCESS);
+    memset(m_upload_dst, 0, sizeof(m_upload_dst));
+
+    m_queue_head     = 0;
+    m_queue_tail     = 0;
+    m_write_count    = 0;
+    m_drop_every     = 0;
+    m_drop_after     = UINT32_MAX;
+    m_drop_code      = 0;
+    m_write_error    = NRF_SUCCESS;
+    m_response_count = 0;
+    m_client_evt     = NO_EVT;
+    m_server_evt     = NO_EVT;
+    m_server_uploads = 0;
+    m_server_gets    = 0;
+    m_hog_memory     = false;
+}
+
+
+static void teardown(void)
+{
+    nrf_mem_cat_stats_t stats;
+
+    // End the transfers left, and let the requests in flight time out.
+    for (uint32_t handle = 0; handle < COAP_BLOCK_MAX_TRANSFERS; handle++)
+    {
+        (void)coap_block_transfer_abort(handle);
+    }
+
+    m_drop_after = 0;
+
+    for (uint32_t tick = 0; tick < COAP_MAX_TRANSMISSION_SPAN + 1; tick++)
+    {
+        (void)coap_time_tick();
+    }
+
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+
+
+START_TEST(test_download)
+{
+    download_check();
+
+    ck_assert_uint_eq(m_server_gets, (DOWNLOAD_SIZE + COAP_BLOCK_SIZE_PREFERRED - 1) / COAP_BLOCK_SIZE_PREFERRED);
+}
+END_TEST
+
+
+START_TEST(test_download_lossy)
+{
+    m_drop_every = 7;
+
+    download_check();
+}
+END_TEST
+
+
+START_TEST(test_download_block_size_reduced)
+{
+    // The first block does not fit in the memory left, the server answers with blocks of half
+    // the size, which the client keeps to.
+    m_hog_memory = true;
+
+    download_check();
+
+    ck_assert_uint_eq(m_server_gets, (DOWNLOAD_SIZE + (COAP_BLOCK_SIZE_PREFERRED / 2) - 1) /
+                                     (COAP_BLOCK_SIZE_PREFERRED / 2));
+}
+END_TEST
+
+
+START_TEST(test_upload)
+{
+    upload_check(COAP_CODE_PUT);
+}
+END_TEST
+
+
+START_TEST(test_upload_lossy)
+{
+    m_drop_every = 7;
+
+    upload_check(COAP_CODE_PUT);
+}
+END_TEST
+
+
+START_TEST(test_upload_too_large)
+{
+    uint32_t handle;
+
+    // The server file is smaller than the body announced in Size1: 4.13.
+    IOT_FILE_STATIC_INIT(&m_server_upload_file, "cfg", m_upload_dst, 1000);
+    ck_assert_uint_eq(iot_file_fopen(&m_server_upload_file, 0), NRF_SUCCESS);
+
+    coap_message_t * p_template = template_new(COAP_CODE_POST, "cfg");
+
+    ck_assert_uint_eq(coap_block_client_start(&handle, p_template, &m_client_upload_file,
+                                              client_callback, NULL), NRF_SUCCESS);
+    (void)transfer_run();
+
+    ck_assert_uint_eq(m_client_evt, COAP_BLOCK_EVT_ABORTED);
+    ck_assert_uint_eq(m_client_result, (NRF_ERROR_INVALID_DATA | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(m_server_evt, NO_EVT);
+
+    ck_assert_uint_eq(coap_message_delete(p_template), NRF_SUCCESS);
+}
+END_TEST
+
+
+START_TEST(test_upload_last_block_retransmitted)
+{
+    // The final response is lost, the retransmission of the last block is answered with it again
+    // rather than with 4.08, and the upload is notified once.
+    m_drop_code = COAP_CODE_204_CHANGED;
+
+    upload_check(COAP_CODE_PUT);
+
+    // Later retransmissions get the final response until EXCHANGE_LIFETIME.
+    datagram_read(&m_last_put);
+    ck_assert_uint_eq(m_last_response.data[1], COAP_CODE_204_CHANGED);
+    ck_assert_uint_eq(m_server_uploads, 1);
+
+    for (uint32_t tick = 0; tick < EXCHANGE_LIFETIME; tick++)
+    {
+        (void)coap_time_tick();
+    }
+
+    m_queue_head = m_queue_tail;
+
+    datagram_read(&m_last_put);
+    ck_assert_uint_eq(m_last_response.data[1], COAP_CODE_408_REQUEST_ENTITY_INCOMPLETE);
+    ck_assert_uint_eq(m_server_uploads, 1);
+}
+END_TEST
+
+
+START_TEST(test_server_upload_idle_abort)
+{
+    uint32_t handle;
+
+    // Block 0 and its 2.31 Continue are delivered, the client then goes away.
+    coap_message_t * p_template = template_new(COAP_CODE_PUT, "cfg");
+
+    ck_assert_uint_eq(coap_block_client_start(&handle, p_template, &m_client_upload_file,
+                                              client_callback, NULL), NRF_SUCCESS);
+    m_drop_after = m_write_count + 2;
+    queue_flush();
+    ck_assert_uint_eq(coap_block_transfer_abort(handle), NRF_SUCCESS);
+
+    for (uint32_t tick = 0; tick < COAP_BLOCK_TRANSFER_TIMEOUT; tick++)
+    {
+        ck_assert_uint_eq(m_server_evt, NO_EVT);
+        (void)coap_time_tick();
+    }
+
+    ck_assert_uint_eq(m_server_evt, COAP_BLOCK_EVT_ABORTED);
+    ck_assert_uint_eq(m_client_evt, NO_EVT);
+
+    ck_assert_uint_eq(coap_message_delete(p_template), NRF_SUCCESS);
+}
+END_TEST
+
+
+START_TEST(test_send_failed_with_repeated_mid)
+{
+    coap_queue_item_t * p_item;
+    uint32_t            first;
+    uint32_t            second;
+    uint32_t            queued = 0;
+    uint8_t             ack[]  = { 0x60, 0x00, 0x00, 0x07 };                                        // Empty ACK to message ID 7.
+
+    coap_message_t * p_request = template_new(COAP_CODE_GET, "fw");
+
+    p_request->header.id         = 7;
+    p_request->response_callback = response_callback;
+
+    // The requests do not reach the server.
+    m_drop_after = 0;
+
+    ck_assert_uint_eq(coap_message_send(&first, p_request), NRF_SUCCESS);
+
+    m_write_error = NRF_ERROR_NO_MEM;
+    ck_assert_uint_eq(coap_message_send(&second, p_request), NRF_ERROR_NO_MEM);
+
+    // Only the request written is left in the queue.
+    ck_assert_uint_eq(coap_queue_item_by_handle_get(&p_item, first), NRF_SUCCESS);
+    ck_assert_uint_eq(p_item->mid, 7);
+
+    p_item = NULL;
+    while (coap_queue_item_next_get(&p_item, p_item) == NRF_SUCCESS)
+    {
+        queued++;
+    }
+    ck_assert_uint_eq(queued, 1);
+
+    // And it is completed by the acknowledgement.
+    (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, ack, sizeof(ack));
+    ck_assert_uint_eq(m_response_count, 1);
+    ck_assert_uint_eq(m_response_status, NRF_SUCCESS);
+    ck_assert_uint_eq(coap_queue_item_by_handle_get(&p_item, first),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+
+    ck_assert_uint_eq(coap_message_delete(p_request), NRF_SUCCESS);
+}
+END_TEST
+
+
+static Suite * coap_block_suite(void)
+{
+    Suite * p_suite = suite_create("coap_block");
+    TCase * p_case  = tcase_create("coap_block");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_download);
+    tcase_add_test(p_case, test_download_lossy);
+    tcase_add_test(p_case, test_download_block_size_reduced);
+    tcase_add_test(p_case, test_upload);
+    tcase_add_test(p_case, test_upload_lossy);
+    tcase_add_test(p_case, test_upload_too_large);
+    tcase_add_test(p_case, test_upload_last_block_retransmitted);
+    tcase_add_test(p_case, test_server_upload_idle_abort);
+    tcase_add_test(p_case, test_send_failed_with_repeated_mid);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(coap_block_suite());
+}
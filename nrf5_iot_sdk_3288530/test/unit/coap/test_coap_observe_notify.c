@@ -0,0 +1,592 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the notifications sent to observers in CoAP auto-mode
+ *        (coap_observer_notify and coap_time_tick).
+ *
+ * @details The notification is rendered once for each content type in use, and the header and
+ *          token are rewritten for each observer. Every datagram written must decode to a
+ *          Non-confirmable 2.05 Content carrying the token of its observer, a message ID of its
+ *          own, the shared Observe sequence number and the payload of its content type.
+ *          Observable resources are notified by coap_time_tick every period of their own, and
+ *          their expire_time counts down from the Max-Age of the value notified last.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdk_check.h"
+#include "iot_errors.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_message.h"
+#include "coap_option.h"
+#include "coap_observe_api.h"
+#include "coap_transport.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the server. */
+#define MAX_DATAGRAM_SIZE     64                                                                    /**< Largest datagram written by CoAP. */
+#define OBSERVER_COUNT        COAP_OBSERVE_MAX_NUM_OBSERVERS                                        /**< Number of observers registered to the resource. */
+#define MAX_AGE               60                                                                    /**< Max-Age of the observed resource. */
+#define NOTIFY_DELTA          COAP_AUTOMODE_OBSERVE_NOTIFY_DELTA_MAX_AGE                            /**< Seconds before Max-Age runs out that a notification is sent. */
+#define RESOURCE_COUNT        COAP_OBSERVE_MAX_NUM_OBSERVERS                                        /**< Number of resources scheduled together, each with one observer. */
+
+/**@brief Datagram written by CoAP. */
+typedef struct
+{
+    coap_remote_t remote;
+    uint8_t       data[MAX_DATAGRAM_SIZE];
+    uint16_t      length;
+} datagram_t;
+
+static const coap_port_t m_port = { .port_number = LOCAL_PORT_NUM };
+
+static datagram_t        m_written[OBSERVER_COUNT];                                                 /**< Datagrams written by CoAP. */
+static uint32_t          m_write_count;                                                             /**< Number of datagrams written by CoAP. */
+static uint32_t          m_render_count;                                                            /**< Number of notifications rendered by the application. */
+static uint32_t          m_render_result;                                                           /**< Result returned when rendering a notification. */
+static uint32_t          m_callback_expire_time;                                                    /**< expire_time of the resource seen by the last request. */
+static uint16_t          m_request_id;                                                              /**< Message ID of the next request. */
+
+static coap_resource_t   m_root;
+static coap_resource_t   m_temperature;                                                             /**< Observed resource. */
+static coap_observer_t   m_observers[OBSERVER_COUNT];                                               /**< Observers registered, in registration order. */
+static coap_resource_t   m_resources[RESOURCE_COUNT];                                               /**< Resources with a Max-Age of their own. */
+
+static const char        m_text_payload[] = "21.5";
+static const char        m_json_payload[] = "{\"t\":21.5}";
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    ck_assert_uint_eq(p_port->port_number, LOCAL_PORT_NUM);
+    ck_assert_uint_lt(m_write_count, OBSERVER_COUNT);
+    ck_assert_uint_le(datalen, MAX_DATAGRAM_SIZE);
+
+    datagram_t * p_datagram = &m_written[m_write_count++];
+
+    memcpy(&p_datagram->remote, p_remote, sizeof(coap_remote_t));
+    memcpy(p_datagram->data, p_data, datalen);
+    p_datagram->length = datalen;
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_resource_observe_payload_set(coap_resource_t     * p_resource,
+                                           coap_content_type_t   ct,
+                                           coap_message_t      * p_response)
+{
+    m_render_count++;
+
+    if (m_render_result != NRF_SUCCESS)
+    {
+        return m_render_result;
+    }
+
+    const char * p_payload = (ct == COAP_CT_APP_JSON) ? m_json_payload : m_text_payload;
+
+    return coap_message_payload_set(p_response, (void *)p_payload, strlen(p_payload));
+}
+
+
+static void temperature_callback(coap_resource_t * p_resource,
+                                 coap_message_t  * p_request,
+                                 coap_message_t  * p_response)
+{
+    m_callback_expire_time   = p_resource->expire_time;
+    p_response->header.code = COAP_CODE_205_CONTENT;
+}
+
+
+/**@brief Send a NON GET of the temperature, and drop the response. */
+static void temperature_get(void)
+{
+    uint8_t       get[]  = { 0x50, COAP_CODE_GET, 0, 0, 0xB4, 't', 'e', 'm', 'p' };
+    coap_remote_t remote = { .port_number = LOCAL_PORT_NUM };
+    uint32_t      write_count = m_write_count;
+
+    get[2] = (uint8_t)(m_request_id >> 8);
+    get[3] = (uint8_t)m_request_id++;
+
+    ck_assert_uint_eq(coap_transport_read(&m_port, &remote, NRF_SUCCESS, get, sizeof(get)), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, write_count + 1);
+
+    m_write_count = write_count;
+}
+
+
+/**@brief Register an observer of the temperature, with a token of token_len bytes. */
+static void observer_register(uint32_t index, uint8_t token_len, coap_content_type_t ct)
+{
+    coap_observer_t * p_observer = &m_observers[index];
+    uint32_t          handle;
+
+    memset(p_observer, 0, sizeof(coap_observer_t));
+
+    p_observer->remote.addr[15]        = (uint8_t)(index + 1);
+    p_observer->remote.port_number     = (uint16_t)(LOCAL_PORT_NUM + index + 1);
+    p_observer->token_len              = token_len;
+    p_observer->ct                     = ct;
+    p_observer->p_resource_of_interest = &m_temperature;
+
+    for (uint32_t i = 0; i < token_len; i++)
+    {
+        p_observer->token[i] = (uint8_t)((index << 4) | i);
+    }
+
+    ck_assert_uint_eq(coap_observe_server_register(&handle, p_observer), NRF_SUCCESS);
+    ck_assert_uint_eq(handle, index);
+}
+
+
+/**@brief Decode the Observe option of a datagram written by CoAP. */
+static uint32_t observe_option_get(datagram_t * p_datagram)
+{
+    coap_message_t message;
+    uint32_t       observe = 0xFFFFFFFF;
+
+    memset(&message, 0, sizeof(message));
+    ck_assert_uint_eq(coap_message_decode(&message, p_datagram->data, p_datagram->length), NRF_SUCCESS);
+
+    for (uint32_t index = 0; index < message.options_count; index++)
+    {
+        if (message.options[index].number == COAP_OPT_OBSERVE)
+        {
+            ck_assert_uint_eq(coap_opt_uint_decode(&observe,
+                                                   message.options[index].length,
+                                                   message.options[index].p_data), NRF_SUCCESS);
+        }
+    }
+
+    return observe;
+}
+
+
+/**@brief Check that a datagram is the notification of an observer.
+ *
+ * @return Message ID of the notification.
+ */
+static uint16_t notification_check(datagram_t * p_datagram, coap_observer_t * p_observer)
+{
+    coap_message_t message;
+    uint32_t       max_age = 0xFFFFFFFF;
+
+    memset(&message, 0, sizeof(message));
+
+    ck_assert_int_eq(memcmp(&p_datagram->remote, &p_observer->remote, sizeof(coap_remote_t)), 0);
+    ck_assert_uint_eq(coap_message_decode(&message, p_datagram->data, p_datagram->length), NRF_SUCCESS);
+
+    ck_assert_uint_eq(message.header.version, 1);
+    ck_assert_uint_eq(message.header.type, COAP_TYPE_NON);
+    ck_assert_uint_eq(message.header.code, COAP_CODE_205_CONTENT);
+    ck_assert_uint_eq(message.header.token_len, p_observer->token_len);
+    ck_assert_int_eq(memcmp(message.token, p_observer->token, p_observer->token_len), 0);
+
+    for (uint32_t index = 0; index < message.options_count; index++)
+    {
+        if (message.options[index].number == COAP_OPT_MAX_AGE)
+        {
+            ck_assert_uint_eq(coap_opt_uint_decode(&max_age,
+                                                   message.options[index].length,
+                                                   message.options[index].p_data), NRF_SUCCESS);
+        }
+    }
+
+    ck_assert_uint_eq(max_age, m_temperature.expire_time);
+
+    const char * p_payload = (p_observer->ct == COAP_CT_APP_JSON) ? m_json_payload : m_text_payload;
+
+    ck_assert_uint_eq(message.payload_len, strlen(p_payload));
+    ck_assert_int_eq(memcmp(message.p_payload, p_payload, message.payload_len), 0);
+
+    return message.header.id;
+}
+
+
+/**@brief Check that each observer received one notification, in the order given, with a message
+ *        ID of its own and the same Observe sequence number.
+ */
+static void notifications_check(coap_observer_t ** pp_observers, uint32_t observer_count)
+{
+    uint16_t message_ids[OBSERVER_COUNT];
+    uint32_t sequence_number = observe_option_get(&m_written[0]);
+
+    ck_assert_uint_eq(m_write_count, observer_count);
+
+    for (uint32_t index = 0; index < observer_count; index++)
+    {
+        ck_assert_uint_eq(observe_option_get(&m_written[index]), sequence_number);
+
+        message_ids[index] = notification_check(&m_written[index], pp_observers[index]);
+
+        for (uint32_t previous = 0; previous < index; previous++)
+        {
+            ck_assert_uint_ne(message_ids[previous], message_ids[index]);
+        }
+    }
+}
+
+
+static void setup(void)
+{
+    coap_transport_init_t transport_params = { .p_port_table = (coap_port_t *)&m_port };
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_init(1, &transport_params), NRF_SUCCESS);
+
+    memset(&m_root, 0, sizeof(m_root));
+    memset(&m_temperature, 0, sizeof(m_temperature));
+
+    ck_assert_uint_eq(coap_resource_create(&m_root, "/"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_temperature, "temp"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_temperature), NRF_SUCCESS);
+
+    m_temperature.permission  = (COAP_PERM_GET | COAP_PERM_OBSERVE);
+    m_temperature.callback    = temperature_callback;
+    m_temperature.max_age     = MAX_AGE;
+    m_temperature.expire_time = MAX_AGE;
+
+    m_write_count          = 0;
+    m_render_count         = 0;
+    m_render_result        = NRF_SUCCESS;
+    m_callback_expire_time = 0xFFFFFFFF;
+}
+
+
+static void teardown(void)
+{
+    nrf_mem_cat_stats_t stats;
+
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+
+
+START_TEST(test_notify_no_observer)
+{
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+
+    ck_assert_uint_eq(m_write_count, 0);
+    ck_assert_uint_eq(m_render_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_notify_tokens)
+{
+    coap_observer_t * p_expected[OBSERVER_COUNT];
+
+    // Tokens of every length, from none to the longest.
+    for (uint32_t index = 0; index < OBSERVER_COUNT; index++)
+    {
+        observer_register(index, (uint8_t)(index % 9), COAP_CT_PLAIN_TEXT);
+        p_expected[index] = &m_observers[index];
+    }
+
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+
+    notifications_check(p_expected, OBSERVER_COUNT);
+    ck_assert_uint_eq(m_render_count, 1);
+}
+END_TEST
+
+
+START_TEST(test_notify_content_types)
+{
+    coap_observer_t * p_expected[OBSERVER_COUNT];
+    uint32_t          count = 0;
+
+    // Observers using JSON are interleaved with those using plain text.
+    for (uint32_t index = 0; index < OBSERVER_COUNT; index++)
+    {
+        observer_register(index,
+                          (uint8_t)(8 - (index % 9)),
+                          ((index % 3) == 1) ? COAP_CT_APP_JSON : COAP_CT_PLAIN_TEXT);
+    }
+
+    // Content types are notified in increasing order, plain text before JSON.
+    for (uint32_t index = 0; index < OBSERVER_COUNT; index++)
+    {
+        if (m_observers[index].ct == COAP_CT_PLAIN_TEXT)
+        {
+            p_expected[count++] = &m_observers[index];
+        }
+    }
+
+    for (uint32_t index = 0; index < OBSERVER_COUNT; index++)
+    {
+        if (m_observers[index].ct == COAP_CT_APP_JSON)
+        {
+            p_expected[count++] = &m_observers[index];
+        }
+    }
+
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+
+    notifications_check(p_expected, count);
+    ck_assert_uint_eq(m_render_count, 2);
+}
+END_TEST
+
+
+START_TEST(test_notify_sequence_number)
+{
+    observer_register(0, 4, COAP_CT_PLAIN_TEXT);
+
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 2);
+
+    ck_assert_uint_eq(observe_option_get(&m_written[1]), observe_option_get(&m_written[0]) + 1);
+}
+END_TEST
+
+
+START_TEST(test_notify_render_failure)
+{
+    observer_register(0, 2, COAP_CT_PLAIN_TEXT);
+    observer_register(1, 2, COAP_CT_PLAIN_TEXT);
+
+    m_render_result = (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE);
+
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(m_write_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_tick_expire_time)
+{
+    observer_register(0, 2, COAP_CT_PLAIN_TEXT);
+
+    // A new observable resource is notified on the first tick.
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+    ck_assert_uint_eq(m_temperature.expire_time, MAX_AGE);
+
+    m_write_count = 0;
+
+    // The time left counts down to the delta, which is when the next notification is sent.
+    for (uint32_t tick = 1; tick <= MAX_AGE - NOTIFY_DELTA; tick++)
+    {
+        ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+        ck_assert_uint_eq(m_write_count, 0);
+
+        temperature_get();
+        ck_assert_uint_eq(m_callback_expire_time, MAX_AGE - tick);
+    }
+
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+    ck_assert_uint_eq(m_temperature.expire_time, MAX_AGE);
+
+    notification_check(&m_written[0], &m_observers[0]);
+
+    temperature_get();
+    ck_assert_uint_eq(m_callback_expire_time, MAX_AGE);
+}
+END_TEST
+
+
+START_TEST(test_tick_notify_restarts_period)
+{
+    observer_register(0, 2, COAP_CT_PLAIN_TEXT);
+
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+
+    for (uint32_t tick = 0; tick < 10; tick++)
+    {
+        ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    }
+
+    // The application notifies a new value, the next automatic notification is a whole period
+    // after it.
+    ck_assert_uint_eq(coap_observer_notify(&m_temperature), NRF_SUCCESS);
+    ck_assert_uint_eq(m_temperature.expire_time, MAX_AGE);
+
+    m_write_count = 0;
+
+    for (uint32_t tick = 1; tick <= MAX_AGE - NOTIFY_DELTA; tick++)
+    {
+        ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+        ck_assert_uint_eq(m_write_count, 0);
+    }
+
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+}
+END_TEST
+
+
+START_TEST(test_tick_resource_periods)
+{
+    uint32_t last_tick[RESOURCE_COUNT];
+    uint32_t notify_count[RESOURCE_COUNT];
+
+    // Resources with a Max-Age of their own, each with one observer telling them apart.
+    for (uint32_t index = 0; index < RESOURCE_COUNT; index++)
+    {
+        coap_observer_t * p_observer = &m_observers[index];
+        uint32_t          handle;
+        char              name[8];
+
+        (void)snprintf(name, sizeof(name), "r%u", (unsigned int)index);
+
+        memset(&m_resources[index], 0, sizeof(coap_resource_t));
+        ck_assert_uint_eq(coap_resource_create(&m_resources[index], name), NRF_SUCCESS);
+        ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_resources[index]), NRF_SUCCESS);
+
+        m_resources[index].permission = (COAP_PERM_GET | COAP_PERM_OBSERVE);
+        m_resources[index].max_age    = NOTIFY_DELTA + 1 + ((index * 7) % 13);
+
+        memset(p_observer, 0, sizeof(coap_observer_t));
+        p_observer->remote.port_number     = (uint16_t)index;
+        p_observer->p_resource_of_interest = &m_resources[index];
+        ck_assert_uint_eq(coap_observe_server_register(&handle, p_observer), NRF_SUCCESS);
+
+        notify_count[index] = 0;
+    }
+
+    for (uint32_t tick = 0; tick < 200; tick++)
+    {
+        m_write_count = 0;
+
+        ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+
+        for (uint32_t write = 0; write < m_write_count; write++)
+        {
+            uint32_t index  = m_written[write].remote.port_number;
+            uint32_t period = m_resources[index].max_age - NOTIFY_DELTA + 1;
+
+            ck_assert_uint_lt(index, RESOURCE_COUNT);
+
+            if (notify_count[index] == 0)
+            {
+                // Every resource is notified on the first tick.
+                ck_assert_uint_eq(tick, 0);
+            }
+            else
+            {
+                ck_assert_uint_eq(tick - last_tick[index], period);
+            }
+
+            last_tick[index] = tick;
+            notify_count[index]++;
+        }
+    }
+
+    for (uint32_t index = 0; index < RESOURCE_COUNT; index++)
+    {
+        uint32_t period = m_resources[index].max_age - NOTIFY_DELTA + 1;
+
+        ck_assert_uint_eq(notify_count[index], 1 + (199 / period));
+    }
+}
+END_TEST
+
+
+START_TEST(test_tick_reinit)
+{
+    observer_register(0, 2, COAP_CT_PLAIN_TEXT);
+
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+
+    // The resource keeps its position in the schedule left from before coap_init, which must not
+    // be taken for a scheduled resource.
+    coap_transport_init_t transport_params = { .p_port_table = (coap_port_t *)&m_port };
+    uint16_t              heap_index       = m_temperature.observe_heap_index;
+
+    ck_assert_uint_ne(heap_index, 0);
+
+    memset(&m_root, 0, sizeof(m_root));
+    memset(&m_temperature, 0, sizeof(m_temperature));
+    m_temperature.observe_heap_index = heap_index;
+
+    ck_assert_uint_eq(coap_init(1, &transport_params), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_root, "/"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_temperature, "temp"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_temperature), NRF_SUCCESS);
+    m_temperature.permission = (COAP_PERM_GET | COAP_PERM_OBSERVE);
+    m_temperature.max_age    = MAX_AGE;
+
+    observer_register(0, 2, COAP_CT_PLAIN_TEXT);
+
+    m_write_count = 0;
+
+    ck_assert_uint_eq(coap_time_tick(), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+}
+END_TEST
+
+
+static Suite * coap_observe_notify_suite(void)
+{
+    Suite * p_suite = suite_create("coap_observe_notify");
+    TCase * p_case  = tcase_create("coap_observe_notify");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_notify_no_observer);
+    tcase_add_test(p_case, test_notify_tokens);
+    tcase_add_test(p_case, test_notify_content_types);
+    tcase_add_test(p_case, test_notify_sequence_number);
+    tcase_add_test(p_case, test_notify_render_failure);
+    tcase_add_test(p_case, test_tick_expire_time);
+    tcase_add_test(p_case, test_tick_notify_restarts_period);
+    tcase_add_test(p_case, test_tick_resource_periods);
+    tcase_add_test(p_case, test_tick_reinit);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(coap_observe_notify_suite());
+}
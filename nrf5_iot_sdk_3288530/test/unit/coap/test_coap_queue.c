@@ -0,0 +1,340 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the CoAP transaction queue: lookup by message ID, token and handle through
+ *        the hash buckets, expiry through the timeout wheel, and reuse of items from the free list.
+ *
+ * @details Built with COAP_MESSAGE_QUEUE_SIZE from config/sdk_config.h, and the default hash and
+ *          wheel sizes of coap_queue.c.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "sdk_config.h"
+#include "iot_errors.h"
+#include "coap_queue.h"
+
+#define WHEEL_SIZE            64                                                                    /**< Default COAP_QUEUE_WHEEL_SIZE of coap_queue.c. */
+#define HASH_SIZE             8                                                                     /**< Default COAP_QUEUE_HASH_SIZE of coap_queue.c. */
+
+static uint8_t m_buffer[COAP_MESSAGE_QUEUE_SIZE][16];                                               /**< Encoded messages of the queued items, only their address is used. */
+
+
+/**@brief Add an item to the queue.
+ *
+ * @return Handle of the queued item.
+ */
+static uint32_t item_add(uint16_t mid, const char * p_token, uint16_t timeout)
+{
+    coap_queue_item_t item;
+
+    memset(&item, 0, sizeof(item));
+    item.mid        = mid;
+    item.timeout    = timeout;
+    item.p_buffer   = m_buffer[mid % COAP_MESSAGE_QUEUE_SIZE];
+    item.buffer_len = sizeof(m_buffer[0]);
+
+    if (p_token != NULL)
+    {
+        item.token_len = (uint8_t)strlen(p_token);
+        memcpy(item.token, p_token, item.token_len);
+    }
+
+    ck_assert_uint_eq(coap_queue_add(&item), NRF_SUCCESS);
+
+    return item.handle;
+}
+
+
+/**@brief Get the item with a handle, which must be queued. */
+static coap_queue_item_t * item_get(uint32_t handle)
+{
+    coap_queue_item_t * p_item = NULL;
+
+    ck_assert_uint_eq(coap_queue_item_by_handle_get(&p_item, handle), NRF_SUCCESS);
+    ck_assert_ptr_ne(p_item, NULL);
+
+    return p_item;
+}
+
+
+/**@brief Count the items in the queue by iterating over them. */
+static uint32_t item_count_get(void)
+{
+    coap_queue_item_t * p_item = NULL;
+    uint32_t            count  = 0;
+
+    while (coap_queue_item_next_get(&p_item, p_item) == NRF_SUCCESS)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+
+/**@brief Advance the queue by one tick.
+ *
+ * @return Number of items due on the new tick. Each is removed from the queue.
+ */
+static uint32_t tick(void)
+{
+    coap_queue_item_t * p_item;
+    uint32_t            count = 0;
+
+    coap_queue_tick();
+
+    while (coap_queue_item_due_get(&p_item) == NRF_SUCCESS)
+    {
+        ck_assert_uint_eq(coap_queue_remove(p_item), NRF_SUCCESS);
+        count++;
+    }
+
+    return count;
+}
+
+
+static void setup(void)
+{
+    memset(m_buffer, 0, sizeof(m_buffer));
+
+    ck_assert_uint_eq(coap_queue_init(), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_add_and_remove)
+{
+    coap_queue_item_t * p_item;
+
+    const uint32_t handle = item_add(1, "a", 10);
+
+    ck_assert_uint_eq(item_count_get(), 1);
+
+    p_item = item_get(handle);
+    ck_assert_uint_eq(p_item->mid, 1);
+    ck_assert_uint_eq(p_item->handle, handle);
+
+    ck_assert_uint_eq(coap_queue_remove(p_item), NRF_SUCCESS);
+    ck_assert_uint_eq(item_count_get(), 0);
+
+    // The removed item is found neither by handle, message ID nor token, nor removed again.
+    ck_assert_uint_eq(coap_queue_item_by_handle_get(&p_item, handle),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1), (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"a", 1),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_remove(p_item), (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_remove(NULL), (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_item_by_handle_get(&p_item, COAP_MESSAGE_QUEUE_SIZE),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_lookup_in_shared_buckets)
+{
+    coap_queue_item_t * p_item;
+
+    // Message IDs HASH_SIZE apart share a bucket, and so do these tokens.
+    const uint32_t first  = item_add(1, "ab", 10);
+    const uint32_t second = item_add(1 + HASH_SIZE, "bc", 10);
+    const uint32_t third  = item_add(1 + (2 * HASH_SIZE), NULL, 10);
+
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(first));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1 + HASH_SIZE), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(second));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1 + (2 * HASH_SIZE)), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(third));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1 + (3 * HASH_SIZE)),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"ab", 2), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(first));
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"bc", 2), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(second));
+
+    // A prefix of a token, or an empty token, matches nothing.
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"ab", 1),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"", 0),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+
+    // Removing an item from the middle of a bucket keeps the others found.
+    ck_assert_uint_eq(coap_queue_remove(item_get(second)), NRF_SUCCESS);
+
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(first));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1 + (2 * HASH_SIZE)), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(third));
+    ck_assert_uint_eq(coap_queue_item_by_mid_get(&p_item, 1 + HASH_SIZE),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"ab", 2), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_queue_item_by_token_get(&p_item, (uint8_t *)"bc", 2),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_expiry_through_wheel)
+{
+    // An item with a timeout of n ticks is due on tick n + 1. Timeouts a wheel rotation apart
+    // share a slot, and only the one due is returned.
+    (void)item_add(1, NULL, 0);
+    (void)item_add(2, NULL, 3);
+    (void)item_add(3, NULL, 3 + WHEEL_SIZE);
+
+    ck_assert_uint_eq(tick(), 1);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 1);
+    ck_assert_uint_eq(item_count_get(), 1);
+
+    for (uint32_t i = 5; i < 4 + WHEEL_SIZE; i++)
+    {
+        ck_assert_uint_eq(tick(), 0);
+    }
+
+    ck_assert_uint_eq(tick(), 1);
+    ck_assert_uint_eq(item_count_get(), 0);
+}
+END_TEST
+
+
+START_TEST(test_timeout_set_reschedules)
+{
+    coap_queue_item_t * p_item;
+
+    const uint32_t handle = item_add(1, NULL, 1);
+
+    ck_assert_uint_eq(tick(), 0);
+
+    // A due item is no longer scheduled until it is rescheduled.
+    coap_queue_tick();
+    ck_assert_uint_eq(coap_queue_item_due_get(&p_item), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_item, item_get(handle));
+    ck_assert_uint_eq(coap_queue_item_due_get(&p_item), (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+
+    ck_assert_uint_eq(coap_queue_item_timeout_set(p_item, 2), NRF_SUCCESS);
+    ck_assert_uint_eq(p_item->timeout, 2);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 1);
+
+    // Rescheduling a scheduled item moves it.
+    p_item = item_get(item_add(2, NULL, 1));
+    ck_assert_uint_eq(coap_queue_item_timeout_set(p_item, 3), NRF_SUCCESS);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 0);
+    ck_assert_uint_eq(tick(), 1);
+
+    ck_assert_uint_eq(coap_queue_item_timeout_set(p_item, 1), (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_removed_item_not_due)
+{
+    const uint32_t handle = item_add(1, NULL, 0);
+
+    (void)item_add(2, NULL, 0);
+
+    ck_assert_uint_eq(coap_queue_remove(item_get(handle)), NRF_SUCCESS);
+    ck_assert_uint_eq(tick(), 1);
+    ck_assert_uint_eq(tick(), 0);
+}
+END_TEST
+
+
+START_TEST(test_free_list_reuse)
+{
+    uint32_t handles[COAP_MESSAGE_QUEUE_SIZE];
+
+    for (uint32_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    {
+        handles[i] = item_add((uint16_t)i, NULL, 10);
+
+        // Handles are unique.
+        for (uint32_t j = 0; j < i; j++)
+        {
+            ck_assert_uint_ne(handles[i], handles[j]);
+        }
+    }
+
+    // The item freed last is reused first.
+    ck_assert_uint_eq(coap_queue_remove(item_get(handles[1])), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_queue_remove(item_get(handles[2])), NRF_SUCCESS);
+
+    ck_assert_uint_eq(item_add(100, NULL, 10), handles[2]);
+    ck_assert_uint_eq(item_add(101, NULL, 10), handles[1]);
+
+    ck_assert_uint_eq(item_get(handles[1])->mid, 101);
+    ck_assert_uint_eq(item_get(handles[2])->mid, 100);
+    ck_assert_uint_eq(item_count_get(), COAP_MESSAGE_QUEUE_SIZE);
+}
+END_TEST
+
+
+START_TEST(test_full_queue)
+{
+    coap_queue_item_t item;
+
+    for (uint32_t i = 0; i < COAP_MESSAGE_QUEUE_SIZE; i++)
+    {
+        (void)item_add((uint16_t)i, NULL, 10);
+    }
+
+    memset(&item, 0, sizeof(item));
+    item.p_buffer = m_buffer[0];
+
+    ck_assert_uint_eq(coap_queue_add(&item), (NRF_ERROR_NO_MEM | IOT_COAP_ERR_BASE));
+    ck_assert_uint_eq(item_count_get(), COAP_MESSAGE_QUEUE_SIZE);
+
+    // Space is available again once an item is removed.
+    ck_assert_uint_eq(coap_queue_remove(item_get(0)), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_queue_add(&item), NRF_SUCCESS);
+    ck_assert_uint_eq(item.handle, 0);
+}
+END_TEST
+
+
+static Suite * coap_queue_suite(void)
+{
+    Suite * p_suite = suite_create("coap_queue");
+    TCase * p_case  = tcase_create("coap_queue");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_add_and_remove);
+    tcase_add_test(p_case, test_lookup_in_shared_buckets);
+    tcase_add_test(p_case, test_expiry_through_wheel);
+    tcase_add_test(p_case, test_timeout_set_reschedules);
+    tcase_add_test(p_case, test_removed_item_not_due);
+    tcase_add_test(p_case, test_free_list_reuse);
+    tcase_add_test(p_case, test_full_queue);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(coap_queue_suite());
+}
@@ -0,0 +1,171 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the CoAP resource tree: resolution of request paths and the generated
+ *        .well-known/core string.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "iot_errors.h"
+#include "coap_api.h"
+#include "coap_resource.h"
+
+static coap_resource_t m_root;
+static coap_resource_t m_lights;
+static coap_resource_t m_led3;
+static coap_resource_t m_temperature;
+static coap_resource_t m_temp;
+
+
+static void setup(void)
+{
+    memset(&m_root, 0, sizeof(m_root));
+    memset(&m_lights, 0, sizeof(m_lights));
+    memset(&m_led3, 0, sizeof(m_led3));
+    memset(&m_temperature, 0, sizeof(m_temperature));
+    memset(&m_temp, 0, sizeof(m_temp));
+
+    ck_assert_uint_eq(coap_resource_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_root, "/"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_lights, "lights"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_lights), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_led3, "led3"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_lights, &m_led3), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_create(&m_temperature, "temperature"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_temperature), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+}
+
+
+/**@brief Resolve a path of zero terminated segments with coap_resource_get. */
+static coap_resource_t * path_get(const char * p_first, const char * p_second)
+{
+    uint8_t         * uri_pointers[] = { (uint8_t *)p_first, (uint8_t *)p_second };
+    coap_resource_t * p_resource     = &m_root;
+
+    (void)coap_resource_get(&p_resource, uri_pointers, (p_second != NULL) ? 2 : 1);
+
+    return p_resource;
+}
+
+
+START_TEST(test_get_matches_exact_names)
+{
+    ck_assert_ptr_eq(path_get("lights", "led3"), &m_led3);
+    ck_assert_ptr_eq(path_get("temperature", NULL), &m_temperature);
+
+    // A prefix of a name, or a name at another level, is not found.
+    ck_assert_ptr_eq(path_get("temp", NULL), NULL);
+    ck_assert_ptr_eq(path_get("lights", "led"), NULL);
+    ck_assert_ptr_eq(path_get("led3", NULL), NULL);
+
+    ck_assert_uint_eq(coap_resource_create(&m_temp, "temp"), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_temp), NRF_SUCCESS);
+
+    ck_assert_ptr_eq(path_get("temp", NULL), &m_temp);
+    ck_assert_ptr_eq(path_get("temperature", NULL), &m_temperature);
+}
+END_TEST
+
+
+START_TEST(test_segments_get_uses_lengths)
+{
+    // Segments as they are in the Uri-Path options of a request, without zero termination.
+    uint8_t           path[]         = "lightsled3x";
+    uint8_t         * uri_pointers[] = { &path[0], &path[6] };
+    uint16_t          uri_lengths[]  = { 6, 4 };
+    coap_resource_t * p_resource;
+
+    ck_assert_uint_eq(coap_resource_segments_get(&p_resource, uri_pointers, uri_lengths, 2),
+                      NRF_SUCCESS);
+    ck_assert_ptr_eq(p_resource, &m_led3);
+
+    uri_lengths[1] = 5;
+    ck_assert_uint_eq(coap_resource_segments_get(&p_resource, uri_pointers, uri_lengths, 2),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_ptr_eq(p_resource, NULL);
+}
+END_TEST
+
+
+START_TEST(test_get_deeper_than_tree)
+{
+    uint8_t         * uri_pointers[COAP_RESOURCE_MAX_DEPTH + 1];
+    coap_resource_t * p_resource;
+
+    for (uint32_t i = 0; i <= COAP_RESOURCE_MAX_DEPTH; i++)
+    {
+        uri_pointers[i] = (uint8_t *)"lights";
+    }
+
+    ck_assert_uint_eq(coap_resource_get(&p_resource, uri_pointers, COAP_RESOURCE_MAX_DEPTH + 1),
+                      (NRF_ERROR_NOT_FOUND | IOT_COAP_ERR_BASE));
+    ck_assert_ptr_eq(p_resource, NULL);
+}
+END_TEST
+
+
+START_TEST(test_well_known_follows_tree)
+{
+    uint8_t  buffer[COAP_MESSAGE_DATA_MAX_SIZE];
+    uint16_t length = sizeof(buffer);
+
+    m_led3.permission        = COAP_PERM_GET;
+    m_temperature.permission = COAP_PERM_GET;
+
+    ck_assert_uint_eq(coap_resource_well_known_generate(buffer, &length), NRF_SUCCESS);
+    ck_assert_uint_eq(length, strlen((char *)buffer));
+    ck_assert_ptr_ne(strstr((char *)buffer, "</lights/led3>"), NULL);
+    ck_assert_ptr_eq(strstr((char *)buffer, "</temp>"), NULL);
+
+    // A resource added after the string was generated is in the next string.
+    ck_assert_uint_eq(coap_resource_create(&m_temp, "temp"), NRF_SUCCESS);
+    m_temp.permission = COAP_PERM_GET;
+    ck_assert_uint_eq(coap_resource_child_add(&m_root, &m_temp), NRF_SUCCESS);
+
+    length = sizeof(buffer);
+    ck_assert_uint_eq(coap_resource_well_known_generate(buffer, &length), NRF_SUCCESS);
+    ck_assert_ptr_ne(strstr((char *)buffer, "</temp>"), NULL);
+
+    length = 10;
+    ck_assert_uint_ne(coap_resource_well_known_generate(buffer, &length), NRF_SUCCESS);
+}
+END_TEST
+
+
+static Suite * coap_resource_suite(void)
+{
+    Suite * p_suite = suite_create("coap_resource");
+    TCase * p_case  = tcase_create("coap_resource");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_get_matches_exact_names);
+    tcase_add_test(p_case, test_segments_get_uses_lengths);
+    tcase_add_test(p_case, test_get_deeper_than_tree);
+    tcase_add_test(p_case, test_well_known_follows_tree);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(coap_resource_suite());
+}
@@ -0,0 +1,153 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of crc16, built for the 256-entry table, the nibble table (CRC16_TABLE_NIBBLE)
+ *        and slice-by-4 and slice-by-8 (CRC16_SLICE_BY).
+ *
+ * @details Every variant is checked bit for bit against the shift and xor implementation that
+ *          crc16_compute had before the tables were introduced.
+ */
+
+#include <stddef.h>
+#include "sdk_check.h"
+#include "crc16.h"
+
+#define BUFFER_SIZE           600                                                                   /**< Size of the random test data. */
+#define ITERATIONS            20000                                                                 /**< Number of random blocks checked. */
+
+static uint8_t  m_data[BUFFER_SIZE];
+static uint32_t m_seed;                                                                             /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+/**@brief The shift and xor CRC-16 of earlier revisions of crc16_compute. */
+static uint16_t crc16_reference(const uint8_t * p_data, uint32_t size, const uint16_t * p_crc)
+{
+    uint32_t i;
+    uint16_t crc = (p_crc == NULL) ? 0xffff : *p_crc;
+
+    for (i = 0; i < size; i++)
+    {
+        crc  = (unsigned char)(crc >> 8) | (crc << 8);
+        crc ^= p_data[i];
+        crc ^= (unsigned char)(crc & 0xff) >> 4;
+        crc ^= (crc << 8) << 4;
+        crc ^= ((crc & 0xff) << 4) << 1;
+    }
+
+    return crc;
+}
+
+
+static void setup(void)
+{
+    m_seed = 1;
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        m_data[i] = (uint8_t)rand_get();
+    }
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_check_value)
+{
+    static const uint8_t check_data[] = "123456789";
+
+    // CRC-16-CCITT with initial value 0xFFFF.
+    ck_assert_uint_eq(crc16_compute(check_data, 9, NULL), 0x29B1);
+    ck_assert_uint_eq(crc16_compute(check_data, 0, NULL), 0xFFFF);
+}
+END_TEST
+
+
+START_TEST(test_compute_matches_reference)
+{
+    // Random lengths and alignments, with and without a previous CRC value.
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint32_t offset = rand_get() % 16;
+        uint32_t size   = rand_get() % (BUFFER_SIZE - 16);
+        uint16_t crc    = (uint16_t)rand_get();
+
+        ck_assert_uint_eq(crc16_compute(&m_data[offset], size, NULL),
+                          crc16_reference(&m_data[offset], size, NULL));
+        ck_assert_uint_eq(crc16_compute(&m_data[offset], size, &crc),
+                          crc16_reference(&m_data[offset], size, &crc));
+    }
+}
+END_TEST
+
+
+START_TEST(test_context_matches_reference)
+{
+    // The data is added in up to four pieces of random size.
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        crc16_ctx_t ctx;
+        uint32_t    size  = rand_get() % BUFFER_SIZE;
+        uint32_t    added = 0;
+
+        crc16_init(&ctx);
+
+        for (uint32_t piece = 0; (piece < 3) && (added < size); piece++)
+        {
+            uint32_t piece_size = rand_get() % (size - added + 1);
+
+            crc16_update(&ctx, &m_data[added], piece_size);
+            added += piece_size;
+        }
+
+        crc16_update(&ctx, &m_data[added], size - added);
+
+        ck_assert_uint_eq(crc16_final(&ctx), crc16_reference(m_data, size, NULL));
+    }
+}
+END_TEST
+
+
+static Suite * crc16_suite(void)
+{
+    Suite * p_suite = suite_create("crc16");
+    TCase * p_case  = tcase_create("crc16");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_check_value);
+    tcase_add_test(p_case, test_compute_matches_reference);
+    tcase_add_test(p_case, test_context_matches_reference);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(crc16_suite());
+}
@@ -0,0 +1,241 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of app_fifo. Random sequences of bulk and zero-copy operations are checked
+ *        against a model of the FIFO contents.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "nrf_error.h"
+#include "app_fifo.h"
+
+#define FIFO_SIZE             64                                                                    /**< Size of the FIFO buffer. */
+#define MAX_CHUNK_SIZE        80                                                                    /**< Largest chunk in the random test, larger than the FIFO. */
+#define MODEL_SIZE            1024                                                                  /**< Size of the model of the FIFO contents, a power of two. */
+#define OPERATION_COUNT       200000                                                                /**< Number of operations in the random test. */
+
+static app_fifo_t m_fifo;
+static uint8_t    m_fifo_buffer[FIFO_SIZE];
+
+static uint8_t    m_model[MODEL_SIZE];                                                              /**< Every byte written, indexed by its position in the stream. */
+static uint32_t   m_written;                                                                        /**< Number of bytes written to the FIFO. */
+static uint32_t   m_read;                                                                           /**< Number of bytes read from the FIFO. */
+static uint32_t   m_seed;                                                                           /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+static void model_fill(uint8_t * p_data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        p_data[i] = (uint8_t)rand_get();
+        m_model[(m_written + i) & (MODEL_SIZE - 1)] = p_data[i];
+    }
+}
+
+
+static void model_check(uint8_t const * p_data, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        ck_assert_uint_eq(p_data[i], m_model[(m_read + i) & (MODEL_SIZE - 1)]);
+    }
+}
+
+
+static void setup(void)
+{
+    m_written = 0;
+    m_read    = 0;
+    m_seed    = 1;
+
+    ck_assert_uint_eq(app_fifo_init(&m_fifo, m_fifo_buffer, FIFO_SIZE), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_wrap_around)
+{
+    uint8_t  data[FIFO_SIZE];
+    uint32_t size = 40;
+
+    model_fill(data, size);
+    ck_assert_uint_eq(app_fifo_write(&m_fifo, data, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, 40);
+    m_written += size;
+
+    size = 30;
+    ck_assert_uint_eq(app_fifo_read(&m_fifo, data, &size), NRF_SUCCESS);
+    model_check(data, size);
+    m_read += size;
+
+    // A NULL array queries the free space.
+    ck_assert_uint_eq(app_fifo_write(&m_fifo, NULL, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, FIFO_SIZE - 10);
+
+    // It is used from position 40 to the end of the buffer and on from its start.
+    size = FIFO_SIZE;
+    model_fill(data, size);
+    ck_assert_uint_eq(app_fifo_write(&m_fifo, data, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, FIFO_SIZE - 10);
+    m_written += size;
+
+    ck_assert_uint_eq(app_fifo_write(&m_fifo, data, &size), NRF_ERROR_NO_MEM);
+    ck_assert_uint_eq(size, 0);
+
+    size = FIFO_SIZE;
+    ck_assert_uint_eq(app_fifo_read(&m_fifo, data, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, FIFO_SIZE);
+    model_check(data, size);
+
+    ck_assert_uint_eq(app_fifo_read(&m_fifo, data, &size), NRF_ERROR_NOT_FOUND);
+}
+END_TEST
+
+
+START_TEST(test_zero_copy_spans)
+{
+    uint8_t * p_span;
+    uint32_t  size;
+
+    ck_assert_uint_eq(app_fifo_peek(&m_fifo, &p_span, &size), NRF_ERROR_NOT_FOUND);
+    ck_assert_uint_eq(app_fifo_consume(&m_fifo, 1), NRF_ERROR_INVALID_LENGTH);
+
+    ck_assert_uint_eq(app_fifo_space_get(&m_fifo, &p_span, &size), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_span, m_fifo_buffer);
+    ck_assert_uint_eq(size, FIFO_SIZE);
+    ck_assert_uint_eq(app_fifo_commit(&m_fifo, FIFO_SIZE - 4), NRF_SUCCESS);
+    ck_assert_uint_eq(app_fifo_consume(&m_fifo, FIFO_SIZE - 8), NRF_SUCCESS);
+
+    // The free space wraps around, only the span up to the end of the buffer is given.
+    ck_assert_uint_eq(app_fifo_space_get(&m_fifo, &p_span, &size), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_span, &m_fifo_buffer[FIFO_SIZE - 4]);
+    ck_assert_uint_eq(size, 4);
+    ck_assert_uint_eq(app_fifo_commit(&m_fifo, FIFO_SIZE - 3), NRF_ERROR_INVALID_LENGTH);
+    ck_assert_uint_eq(app_fifo_commit(&m_fifo, 6), NRF_SUCCESS);
+
+    // So does the data.
+    ck_assert_uint_eq(app_fifo_peek(&m_fifo, &p_span, &size), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_span, &m_fifo_buffer[FIFO_SIZE - 8]);
+    ck_assert_uint_eq(size, 8);
+    ck_assert_uint_eq(app_fifo_consume(&m_fifo, 8), NRF_SUCCESS);
+
+    ck_assert_uint_eq(app_fifo_peek(&m_fifo, &p_span, &size), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_span, m_fifo_buffer);
+    ck_assert_uint_eq(size, 2);
+}
+END_TEST
+
+
+START_TEST(test_random_operations)
+{
+    uint8_t data[MAX_CHUNK_SIZE];
+
+    for (uint32_t i = 0; i < OPERATION_COUNT; i++)
+    {
+        uint8_t * p_span;
+        uint32_t  size = rand_get() % MAX_CHUNK_SIZE;
+        uint32_t  err_code;
+
+        switch (rand_get() % 4)
+        {
+            case 0:
+                model_fill(data, size);
+                err_code = app_fifo_write(&m_fifo, data, &size);
+
+                if (m_written - m_read == FIFO_SIZE)
+                {
+                    ck_assert_uint_eq(err_code, NRF_ERROR_NO_MEM);
+                    size = 0;
+                }
+
+                m_written += size;
+                break;
+
+            case 1:
+                err_code = app_fifo_read(&m_fifo, data, &size);
+
+                if (m_written == m_read)
+                {
+                    ck_assert_uint_eq(err_code, NRF_ERROR_NOT_FOUND);
+                    size = 0;
+                }
+
+                model_check(data, size);
+                m_read += size;
+                break;
+
+            case 2:
+                if (app_fifo_space_get(&m_fifo, &p_span, &size) == NRF_SUCCESS)
+                {
+                    size = rand_get() % (size + 1);
+                    model_fill(p_span, size);
+                    ck_assert_uint_eq(app_fifo_commit(&m_fifo, size), NRF_SUCCESS);
+                    m_written += size;
+                }
+                break;
+
+            default:
+                if (app_fifo_peek(&m_fifo, &p_span, &size) == NRF_SUCCESS)
+                {
+                    size = rand_get() % (size + 1);
+                    model_check(p_span, size);
+                    ck_assert_uint_eq(app_fifo_consume(&m_fifo, size), NRF_SUCCESS);
+                    m_read += size;
+                }
+                break;
+        }
+
+        ck_assert_uint_le(m_written - m_read, FIFO_SIZE);
+    }
+
+    ck_assert_uint_gt(m_read, OPERATION_COUNT);
+}
+END_TEST
+
+
+static Suite * app_fifo_suite(void)
+{
+    Suite * p_suite = suite_create("app_fifo");
+    TCase * p_case  = tcase_create("app_fifo");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_wrap_around);
+    tcase_add_test(p_case, test_zero_copy_spans);
+    tcase_add_test(p_case, test_random_operations);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(app_fifo_suite());
+}
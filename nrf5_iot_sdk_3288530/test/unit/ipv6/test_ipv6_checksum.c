@@ -0,0 +1,404 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the IPv6 checksum functions of ipv6_utils.
+ *
+ * @details ipv6_checksum_calculate is checked bit for bit against the byte at a time
+ *          implementation it had before it summed 32-bit words. ipv6_checksum_copy_calculate
+ *          must give the same checksum and an exact copy, for source and destination of the same
+ *          and of different alignments. ipv6_checksum_update is checked against checksumming the
+ *          changed data again, including the update an ICMPv6 echo reply is built with.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "ipv6_utils.h"
+
+#define BUFFER_SIZE           1500                                                                  /**< Size of the random test data. */
+#define ITERATIONS            20000                                                                 /**< Number of random blocks checked. */
+#define ICMP6_TYPE_ECHO_REQ   128                                                                   /**< ICMPv6 type of an echo request. */
+#define ICMP6_TYPE_ECHO_REP   129                                                                   /**< ICMPv6 type of an echo reply. */
+#define ICMP6_CHECKSUM_OFFSET 2                                                                     /**< Offset of the checksum in the ICMPv6 header. */
+
+static uint8_t  m_data[BUFFER_SIZE];
+static uint8_t  m_copy[BUFFER_SIZE];                                                                /**< Destination of the copies. */
+static uint32_t m_seed;                                                                             /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+/**@brief The byte at a time ipv6_checksum_calculate of earlier revisions. */
+static void checksum_reference(const uint8_t * p_data,
+                               uint16_t        len,
+                               uint16_t      * p_checksum,
+                               bool            flip_flag)
+{
+    uint16_t checksum_even = (((*p_checksum) & 0xFF00) >> 8);
+    uint16_t checksum_odd  = ((*p_checksum) & 0x00FF);
+
+    while (len)
+    {
+        if (len == 1)
+        {
+            checksum_even += (*p_data);
+            len           -= 1;
+        }
+        else
+        {
+            checksum_even += *p_data++;
+            checksum_odd  += *p_data++;
+            len           -= 2;
+        }
+
+        if (checksum_odd & 0xFF00)
+        {
+            checksum_even += ((checksum_odd & 0xFF00) >> 8);
+            checksum_odd   = (checksum_odd & 0x00FF);
+        }
+
+        if (checksum_even & 0xFF00)
+        {
+            checksum_odd += ((checksum_even & 0xFF00) >> 8);
+            checksum_even = (checksum_even & 0x00FF);
+        }
+    }
+
+    checksum_even = (checksum_even << 8) + (checksum_odd & 0xFFFF);
+
+    if (flip_flag)
+    {
+        if (checksum_even == 0xFFFF)
+        {
+            checksum_even = 0x0000;
+        }
+    }
+
+    (*p_checksum) = (uint16_t)(checksum_even);
+}
+
+
+/**@brief Checksum of a message as sent, with the checksum field taken as zero. */
+static uint16_t message_checksum_get(const uint8_t * p_message, uint16_t len)
+{
+    uint16_t checksum = 0;
+
+    ipv6_checksum_calculate(p_message, len, &checksum, false);
+
+    return (uint16_t)(~checksum);
+}
+
+
+static void setup(void)
+{
+    m_seed = 1;
+
+    for (uint32_t i = 0; i < BUFFER_SIZE; i++)
+    {
+        m_data[i] = (uint8_t)rand_get();
+    }
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_calculate_known_values)
+{
+    // Example of RFC 1071, section 3: the sum of 0001 f203 f4f5 f6f7 is ddf2.
+    static const uint8_t data[] = { 0x00, 0x01, 0xF2, 0x03, 0xF4, 0xF5, 0xF6, 0xF7 };
+    uint16_t             checksum;
+
+    checksum = 0;
+    ipv6_checksum_calculate(data, sizeof(data), &checksum, false);
+    ck_assert_uint_eq(checksum, 0xDDF2);
+
+    // An odd trailing byte is padded with zero.
+    checksum = 0;
+    ipv6_checksum_calculate(data, 3, &checksum, false);
+    ck_assert_uint_eq(checksum, 0xF201);
+
+    // The sum is added to the value given, with the carry added back.
+    checksum = 0x220F;
+    ipv6_checksum_calculate(data, sizeof(data), &checksum, false);
+    ck_assert_uint_eq(checksum, 0x0002);
+
+    // 0xFFFF is kept or flipped to 0x0000.
+    checksum = 0x220D;
+    ipv6_checksum_calculate(data, sizeof(data), &checksum, false);
+    ck_assert_uint_eq(checksum, 0xFFFF);
+
+    checksum = 0x220D;
+    ipv6_checksum_calculate(data, sizeof(data), &checksum, true);
+    ck_assert_uint_eq(checksum, 0x0000);
+}
+END_TEST
+
+
+START_TEST(test_calculate_matches_reference)
+{
+    // Random lengths and alignments, random initial values, with and without the flip.
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint32_t offset    = rand_get() % 16;
+        uint16_t len       = (uint16_t)(rand_get() % (BUFFER_SIZE - 16));
+        uint16_t initial   = (uint16_t)rand_get();
+        bool     flip_flag = ((rand_get() % 2) == 0);
+        uint16_t checksum  = initial;
+        uint16_t expected  = initial;
+
+        ipv6_checksum_calculate(&m_data[offset], len, &checksum, flip_flag);
+        checksum_reference(&m_data[offset], len, &expected, flip_flag);
+
+        ck_assert_uint_eq(checksum, expected);
+    }
+
+    // Every length of the first bytes at every alignment, including the words that fold to 0xFFFF.
+    memset(m_data, 0xFF, 64);
+
+    for (uint32_t offset = 0; offset < 8; offset++)
+    {
+        for (uint16_t len = 0; len < 40; len++)
+        {
+            uint16_t checksum = 0xFFFF;
+            uint16_t expected = 0xFFFF;
+
+            ipv6_checksum_calculate(&m_data[offset], len, &checksum, true);
+            checksum_reference(&m_data[offset], len, &expected, true);
+
+            ck_assert_uint_eq(checksum, expected);
+        }
+    }
+}
+END_TEST
+
+
+START_TEST(test_copy_calculate_matches_reference)
+{
+    // Random lengths, source and destination alignments, initial values and flip.
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint32_t offset      = rand_get() % 16;
+        uint32_t copy_offset = rand_get() % 16;
+        uint16_t len         = (uint16_t)(rand_get() % (BUFFER_SIZE - 32));
+        uint16_t initial     = (uint16_t)rand_get();
+        bool     flip_flag   = ((rand_get() % 2) == 0);
+        uint16_t checksum    = initial;
+        uint16_t expected    = initial;
+
+        memset(m_copy, 0xA5, sizeof(m_copy));
+
+        ipv6_checksum_copy_calculate(&m_copy[copy_offset],
+                                     &m_data[offset],
+                                     len,
+                                     &checksum,
+                                     flip_flag);
+        checksum_reference(&m_data[offset], len, &expected, flip_flag);
+
+        ck_assert_uint_eq(checksum, expected);
+        ck_assert_int_eq(memcmp(&m_copy[copy_offset], &m_data[offset], len), 0);
+
+        // Nothing is written around the destination.
+        for (uint32_t j = 0; j < copy_offset; j++)
+        {
+            ck_assert_uint_eq(m_copy[j], 0xA5);
+        }
+
+        for (uint32_t j = copy_offset + len; j < copy_offset + len + 16; j++)
+        {
+            ck_assert_uint_eq(m_copy[j], 0xA5);
+        }
+    }
+
+    // Every short length at every pair of alignments.
+    for (uint32_t offset = 0; offset < 8; offset++)
+    {
+        for (uint32_t copy_offset = 0; copy_offset < 8; copy_offset++)
+        {
+            for (uint16_t len = 0; len < 40; len++)
+            {
+                uint16_t checksum = 0;
+                uint16_t expected = 0;
+
+                memset(m_copy, 0, 64);
+
+                ipv6_checksum_copy_calculate(&m_copy[copy_offset],
+                                             &m_data[offset],
+                                             len,
+                                             &checksum,
+                                             true);
+                checksum_reference(&m_data[offset], len, &expected, true);
+
+                ck_assert_uint_eq(checksum, expected);
+                ck_assert_int_eq(memcmp(&m_copy[copy_offset], &m_data[offset], len), 0);
+            }
+        }
+    }
+}
+END_TEST
+
+
+START_TEST(test_update_matches_recalculation)
+{
+    // A random field at an even offset of a random message is changed.
+    for (uint32_t i = 0; i < ITERATIONS; i++)
+    {
+        uint8_t  message[256];
+        uint8_t  old_field[32];
+        uint16_t len       = (uint16_t)(64 + (rand_get() % (sizeof(message) - 64)));
+        uint16_t field_len = (uint16_t)(1 + (rand_get() % sizeof(old_field)));
+        uint16_t offset    = (uint16_t)((rand_get() % (len - field_len)) & ~1U);
+
+        memcpy(message, &m_data[rand_get() % (BUFFER_SIZE - sizeof(message))], len);
+
+        uint16_t checksum = message_checksum_get(message, len);
+
+        memcpy(old_field, &message[offset], field_len);
+
+        for (uint16_t j = 0; j < field_len; j++)
+        {
+            message[offset + j] = (uint8_t)rand_get();
+        }
+
+        ipv6_checksum_update(&checksum, old_field, &message[offset], field_len, false);
+
+        ck_assert_uint_eq(checksum, message_checksum_get(message, len));
+    }
+}
+END_TEST
+
+
+START_TEST(test_update_flip_zero)
+{
+    // A message that sums to 0xFFFF after the change has the checksum 0x0000, sent as 0xFFFF.
+    uint8_t  message[4] = { 0x12, 0x34, 0x00, 0x00 };
+    uint8_t  old_field[2];
+    uint16_t checksum   = message_checksum_get(message, sizeof(message));
+
+    memcpy(old_field, &message[2], 2);
+    message[2] = 0xED;
+    message[3] = 0xCB;
+
+    uint16_t flipped = checksum;
+
+    ipv6_checksum_update(&checksum, old_field, &message[2], 2, false);
+    ck_assert_uint_eq(checksum, 0x0000);
+
+    ipv6_checksum_update(&flipped, old_field, &message[2], 2, true);
+    ck_assert_uint_eq(flipped, 0xFFFF);
+}
+END_TEST
+
+
+START_TEST(test_update_echo_reply)
+{
+    // Pseudo header followed by an ICMPv6 echo request, as checksummed by icmp6.
+    for (uint32_t i = 0; i < ITERATIONS / 10; i++)
+    {
+        uint8_t  packet[2 * IPV6_ADDR_SIZE + 4 + 200];
+        uint8_t  request_src[IPV6_ADDR_SIZE];
+        uint8_t  request_dst[IPV6_ADDR_SIZE];
+        uint8_t  reply_src[IPV6_ADDR_SIZE];
+        uint8_t  request_type_code[2];
+        uint16_t message_len = (uint16_t)(8 + (rand_get() % 192));
+        uint16_t len         = (uint16_t)(2 * IPV6_ADDR_SIZE + 4 + message_len);
+        bool     multicast   = ((rand_get() % 2) == 0);
+
+        memcpy(packet, &m_data[rand_get() % (BUFFER_SIZE - sizeof(packet))], len);
+
+        uint8_t * p_message = &packet[2 * IPV6_ADDR_SIZE + 4];
+
+        packet[2 * IPV6_ADDR_SIZE]     = 0;
+        packet[2 * IPV6_ADDR_SIZE + 1] = (uint8_t)message_len;
+        packet[2 * IPV6_ADDR_SIZE + 2] = 0;
+        packet[2 * IPV6_ADDR_SIZE + 3] = 58;
+        p_message[0]                   = ICMP6_TYPE_ECHO_REQ;
+        p_message[1]                   = 0;
+        p_message[2]                   = 0;
+        p_message[3]                   = 0;
+
+        if (multicast)
+        {
+            packet[IPV6_ADDR_SIZE] = 0xFF;
+        }
+
+        uint16_t request_checksum = message_checksum_get(packet, len);
+
+        memcpy(request_src, packet, IPV6_ADDR_SIZE);
+        memcpy(request_dst, &packet[IPV6_ADDR_SIZE], IPV6_ADDR_SIZE);
+        memcpy(request_type_code, p_message, 2);
+
+        // Build the reply the way icmp6 does: swap the addresses, use a link-local source
+        // address for a reply to a multicast request, and change the type.
+        memcpy(reply_src, multicast ? &m_data[rand_get() % 64] : request_dst, IPV6_ADDR_SIZE);
+        memcpy(packet, reply_src, IPV6_ADDR_SIZE);
+        memcpy(&packet[IPV6_ADDR_SIZE], request_src, IPV6_ADDR_SIZE);
+        p_message[0] = ICMP6_TYPE_ECHO_REP;
+
+        uint16_t checksum = request_checksum;
+
+        ipv6_checksum_update(&checksum, request_type_code, p_message, 2, false);
+
+        if (multicast)
+        {
+            ipv6_checksum_update(&checksum, request_dst, reply_src, IPV6_ADDR_SIZE, false);
+        }
+
+        ck_assert_uint_eq(checksum, message_checksum_get(packet, len));
+
+        // The receiver verifies the reply with the checksum in place.
+        uint16_t verify = 0;
+
+        p_message[ICMP6_CHECKSUM_OFFSET]     = (uint8_t)(checksum >> 8);
+        p_message[ICMP6_CHECKSUM_OFFSET + 1] = (uint8_t)checksum;
+        ipv6_checksum_calculate(packet, len, &verify, false);
+
+        ck_assert_uint_eq(verify, 0xFFFF);
+    }
+}
+END_TEST
+
+
+static Suite * ipv6_checksum_suite(void)
+{
+    Suite * p_suite = suite_create("ipv6_checksum");
+    TCase * p_case  = tcase_create("ipv6_checksum");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_calculate_known_values);
+    tcase_add_test(p_case, test_calculate_matches_reference);
+    tcase_add_test(p_case, test_copy_calculate_matches_reference);
+    tcase_add_test(p_case, test_update_matches_recalculation);
+    tcase_add_test(p_case, test_update_flip_zero);
+    tcase_add_test(p_case, test_update_echo_reply);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(ipv6_checksum_suite());
+}
@@ -0,0 +1,605 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the IPv6 stack on the host loopback medium, with the application timer on
+ *        a simulated clock.
+ *
+ * @details The unmodified ipv6, udp6 and icmp6 modules run on ipv6_medium_host and
+ *          ble_6lowpan_host. A simulated router peer sends UDP datagrams to an echo socket and
+ *          ICMPv6 echo requests to the node, and checks the replies it receives. The UDP replies
+ *          are sent both with udp6_socket_sendto and udp6_socket_data_sendto. Requests with a
+ *          wrong checksum must not be answered. Every test must leave all Memory Manager blocks
+ *          free, including when 6LoWPAN refuses a packet, which it then frees, as ipv6_send only
+ *          frees the packet buffer.
+ *
+ *          Built a second time with ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION, where the checksum
+ *          is converted to host order before the application handler is called.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "app_timer_host.h"
+#include "ble_6lowpan_host.h"
+#include "ipv6_medium.h"
+#include "ipv6_api.h"
+#include "udp_api.h"
+#include "icmp6_api.h"
+#include "iot_timer.h"
+#include "iot_pbuffer.h"
+#include "ipv6_utils.h"
+
+#define ECHO_PORT             9000                                                                  /**< UDP port of the echo socket of the node. */
+#define PEER_PORT             0x1234                                                                /**< UDP port of the router peer. */
+#define ECHO_COUNT            10000                                                                 /**< Number of UDP datagrams echoed. */
+#define ECHO_BURST            8                                                                     /**< Number of datagrams queued before they are handed to the stack. */
+#define MAX_PAYLOAD_SIZE      256                                                                   /**< Largest payload sent by the router. */
+#define UDP_HEADER_SIZE       8                                                                     /**< Size of the UDP header. */
+#define UDP_CHECKSUM_OFFSET   6                                                                     /**< Offset of the checksum in the UDP header. */
+#define ICMP6_ECHO_HEADER_SIZE 8                                                                    /**< Size of the ICMPv6 echo header. */
+#define ICMP6_CHECKSUM_OFFSET 2                                                                     /**< Offset of the checksum in the ICMPv6 header. */
+#define ICMP6_TYPE_ECHO_REQ   128                                                                   /**< ICMPv6 type of an echo request. */
+#define ICMP6_TYPE_ECHO_REP   129                                                                   /**< ICMPv6 type of an echo reply. */
+#define NEXT_HEADER_OFFSET    6                                                                     /**< Offset of the next header in the IPv6 header. */
+#define SRC_ADDR_OFFSET       8                                                                     /**< Offset of the source address in the IPv6 header. */
+#define DEST_ADDR_OFFSET      24                                                                    /**< Offset of the destination address in the IPv6 header. */
+#define RTC_TICKS_PER_SECOND  32768                                                                 /**< Frequency of the simulated RTC1. */
+#define TIMER_OP_QUEUE_SIZE   4                                                                     /**< Size of the timer operation queues. */
+
+eui64_t                       eui64_local_iid;                                                      /**< EUI-64 of the node, used as the IID for SLAAC. */
+
+static const eui64_t          m_router_eui64 = {{0x02, 0x11, 0x22, 0xFF, 0xFE, 0x33, 0x44, 0x55}};
+static ipv6_addr_t            m_node_addr;                                                          /**< Link-local address of the node. */
+static ipv6_addr_t            m_router_addr;                                                        /**< Link-local address of the router peer. */
+static ipv6_medium_instance_t m_medium;
+static iot_interface_t      * mp_interface;                                                         /**< Interface of the node, once added. */
+static udp6_socket_t          m_socket;
+static uint32_t               m_timer_buffer[CEIL_DIV(APP_TIMER_BUF_SIZE(TIMER_OP_QUEUE_SIZE), sizeof(uint32_t))];
+
+static uint16_t               m_sent_len[ECHO_BURST];                                               /**< Payload lengths of the requests awaiting a reply, by sequence number. */
+static uint32_t               m_sequence;                                                           /**< Sequence number of the next request of the router. */
+static uint32_t               m_reply_sequence;                                                     /**< Sequence number of the request the next reply answers. */
+static uint32_t               m_udp_reply_count;                                                    /**< Number of valid UDP replies received by the router. */
+static uint32_t               m_icmp_reply_count;                                                   /**< Number of valid ICMPv6 echo replies received by the router. */
+static uint32_t               m_icmp_notify_count;                                                  /**< Number of valid ICMPv6 messages given to the application. */
+static bool                   m_checksum_corrupt;                                                   /**< Send packets from the router with a wrong checksum. */
+static uint32_t               m_bad_reply_count;                                                    /**< Number of replies with unexpected addresses, checksum or contents. */
+static uint32_t               m_iot_timer_count;                                                    /**< Number of calls of the IoT Timer client. */
+
+APP_TIMER_DEF(m_iot_timer_tick);
+
+
+/**@brief Checksum of an upper layer message and its pseudo header, with the checksum in place. */
+static uint16_t message_checksum_get(const uint8_t * p_packet, uint16_t message_len)
+{
+    uint16_t checksum = (uint16_t)(message_len + p_packet[NEXT_HEADER_OFFSET]);
+
+    ipv6_checksum_calculate(&p_packet[SRC_ADDR_OFFSET], 2 * IPV6_ADDR_SIZE, &checksum, false);
+    ipv6_checksum_calculate(&p_packet[IPV6_IP_HEADER_SIZE], message_len, &checksum, false);
+
+    return checksum;
+}
+
+
+/**@brief Check that a packet is from the node to the router, of the given protocol, and valid. */
+static bool reply_check(const uint8_t * p_packet, uint16_t packet_len, uint8_t next_header)
+{
+    const uint16_t message_len = packet_len - IPV6_IP_HEADER_SIZE;
+
+    return (p_packet[NEXT_HEADER_OFFSET] == next_header) &&
+           (memcmp(&p_packet[SRC_ADDR_OFFSET], m_node_addr.u8, IPV6_ADDR_SIZE) == 0) &&
+           (memcmp(&p_packet[DEST_ADDR_OFFSET], m_router_addr.u8, IPV6_ADDR_SIZE) == 0) &&
+           (message_checksum_get(p_packet, message_len) == 0xFFFF);
+}
+
+
+/**@brief Payload of the request with the given sequence number. */
+static void payload_fill(uint8_t * p_payload, uint32_t sequence, uint16_t payload_len)
+{
+    for (uint16_t i = 0; i < payload_len; i++)
+    {
+        p_payload[i] = (uint8_t)((sequence >> (8 * (i % 4))) + (i / 4));
+    }
+}
+
+
+static void router_handler(const eui64_t * p_peer_addr, const uint8_t * p_packet, uint16_t packet_len)
+{
+    // Replies come in the order of the requests.
+    const uint16_t payload_len = m_sent_len[m_reply_sequence % ECHO_BURST];
+    uint8_t        payload[MAX_PAYLOAD_SIZE];
+
+    ck_assert_int_eq(memcmp(p_peer_addr, &m_router_eui64, sizeof(eui64_t)), 0);
+
+    payload_fill(payload, m_reply_sequence, payload_len);
+
+    if (p_packet[NEXT_HEADER_OFFSET] == IPV6_NEXT_HEADER_UDP)
+    {
+        const uint8_t * p_udp = &p_packet[IPV6_IP_HEADER_SIZE];
+
+        if (reply_check(p_packet, packet_len, IPV6_NEXT_HEADER_UDP) &&
+            (packet_len == IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE + payload_len) &&
+            (((p_udp[0] << 8) | p_udp[1]) == ECHO_PORT) &&
+            (((p_udp[2] << 8) | p_udp[3]) == PEER_PORT) &&
+            (memcmp(&p_udp[UDP_HEADER_SIZE], payload, payload_len) == 0))
+        {
+            m_udp_reply_count++;
+        }
+        else
+        {
+            m_bad_reply_count++;
+        }
+
+        m_reply_sequence++;
+    }
+    else if ((p_packet[NEXT_HEADER_OFFSET] == IPV6_NEXT_HEADER_ICMP6) &&
+             (p_packet[IPV6_IP_HEADER_SIZE] == ICMP6_TYPE_ECHO_REP))
+    {
+        const uint8_t * p_icmp = &p_packet[IPV6_IP_HEADER_SIZE];
+
+        if (reply_check(p_packet, packet_len, IPV6_NEXT_HEADER_ICMP6) &&
+            (packet_len == IPV6_IP_HEADER_SIZE + ICMP6_ECHO_HEADER_SIZE + payload_len) &&
+            (memcmp(&p_icmp[ICMP6_ECHO_HEADER_SIZE], payload, payload_len) == 0))
+        {
+            m_icmp_reply_count++;
+        }
+        else
+        {
+            m_bad_reply_count++;
+        }
+
+        m_reply_sequence++;
+    }
+}
+
+
+/**@brief Send a packet from the router to the node, with a payload made of the sequence number.
+ *
+ * @param[in] next_header     Protocol of the message.
+ * @param[in] p_header        Header of the message, with a zero checksum.
+ * @param[in] header_len      Length of the header.
+ * @param[in] checksum_offset Offset of the checksum in the header.
+ * @param[in] payload_len     Length of the payload.
+ */
+static void router_send(uint8_t         next_header,
+                        const uint8_t * p_header,
+                        uint16_t        header_len,
+                        uint16_t        checksum_offset,
+                        uint16_t        payload_len)
+{
+    uint8_t        packet[IPV6_IP_HEADER_SIZE + UDP_HEADER_SIZE + MAX_PAYLOAD_SIZE];
+    uint8_t      * p_message   = &packet[IPV6_IP_HEADER_SIZE];
+    const uint16_t message_len = header_len + payload_len;
+
+    memset(packet, 0, IPV6_IP_HEADER_SIZE);
+    packet[0]                  = 0x60;
+    packet[4]                  = (uint8_t)(message_len >> 8);
+    packet[5]                  = (uint8_t)message_len;
+    packet[NEXT_HEADER_OFFSET] = next_header;
+    packet[7]                  = IPV6_DEFAULT_HOP_LIMIT;
+    memcpy(&packet[SRC_ADDR_OFFSET], m_router_addr.u8, IPV6_ADDR_SIZE);
+    memcpy(&packet[DEST_ADDR_OFFSET], m_node_addr.u8, IPV6_ADDR_SIZE);
+    memcpy(p_message, p_header, header_len);
+    payload_fill(&p_message[header_len], m_sequence, payload_len);
+
+    m_sent_len[m_sequence % ECHO_BURST] = payload_len;
+    m_sequence++;
+
+    uint16_t checksum = (uint16_t)~message_checksum_get(packet, message_len);
+
+    // A zero UDP checksum means none was computed, the equivalent 0xFFFF is sent instead.
+    if (checksum == 0)
+    {
+        checksum = 0xFFFF;
+    }
+
+    if (m_checksum_corrupt)
+    {
+        checksum ^= 0x0100;
+    }
+
+    p_message[checksum_offset]     = (uint8_t)(checksum >> 8);
+    p_message[checksum_offset + 1] = (uint8_t)checksum;
+
+    ck_assert_uint_eq(ble_6lowpan_host_peer_send(packet, IPV6_IP_HEADER_SIZE + message_len),
+                      NRF_SUCCESS);
+}
+
+
+static void udp_request_send(uint16_t payload_len)
+{
+    const uint16_t udp_len = UDP_HEADER_SIZE + payload_len;
+    const uint8_t  header[UDP_HEADER_SIZE] =
+    {
+        (uint8_t)(PEER_PORT >> 8), (uint8_t)PEER_PORT,
+        (uint8_t)(ECHO_PORT >> 8), (uint8_t)ECHO_PORT,
+        (uint8_t)(udp_len >> 8),   (uint8_t)udp_len,
+        0, 0
+    };
+
+    router_send(IPV6_NEXT_HEADER_UDP, header, UDP_HEADER_SIZE, UDP_CHECKSUM_OFFSET, payload_len);
+}
+
+
+static void icmp_echo_request_send(uint16_t payload_len)
+{
+    const uint8_t header[ICMP6_ECHO_HEADER_SIZE] =
+    {
+        ICMP6_TYPE_ECHO_REQ, 0, 0, 0,
+        0x12, 0x34, (uint8_t)(m_sequence >> 8), (uint8_t)m_sequence
+    };
+
+    router_send(IPV6_NEXT_HEADER_ICMP6, header, ICMP6_ECHO_HEADER_SIZE, ICMP6_CHECKSUM_OFFSET, payload_len);
+}
+
+
+#if (ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION == 1)
+/**@brief ICMPv6 handler of the application, given the header with the checksum in host order. */
+static uint32_t icmp6_handler(iot_interface_t * p_interface,
+                              ipv6_header_t   * p_ip_header,
+                              icmp6_header_t  * p_icmp_header,
+                              uint32_t          process_result,
+                              iot_pbuffer_t   * p_rx_packet)
+{
+    if (process_result == NRF_SUCCESS)
+    {
+        m_icmp_notify_count++;
+    }
+
+    return NRF_SUCCESS;
+}
+#endif // ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION
+
+
+static uint32_t udp_echo_handler(const udp6_socket_t * p_socket,
+                                 const ipv6_header_t * p_ip_header,
+                                 const udp6_header_t * p_udp_header,
+                                 uint32_t              process_result,
+                                 iot_pbuffer_t       * p_rx_packet)
+{
+    iot_pbuffer_alloc_param_t param =
+    {
+        .flags  = PBUFFER_FLAG_DEFAULT,
+        .type   = UDP6_PACKET_TYPE,
+        .length = p_rx_packet->length
+    };
+    iot_pbuffer_t * p_tx_packet;
+
+    ck_assert_uint_eq(process_result, NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_tx_packet), NRF_SUCCESS);
+
+    // Half of the replies are copied by udp6 while it computes the checksum.
+    if ((p_rx_packet->length % 2) == 0)
+    {
+        memcpy(p_tx_packet->p_payload, p_rx_packet->p_payload, p_rx_packet->length);
+
+        ck_assert_uint_eq(udp6_socket_sendto(p_socket,
+                                             &p_ip_header->srcaddr,
+                                             p_udp_header->srcport,
+                                             p_tx_packet),
+                          NRF_SUCCESS);
+    }
+    else
+    {
+        ck_assert_uint_eq(udp6_socket_data_sendto(p_socket,
+                                                  &p_ip_header->srcaddr,
+                                                  p_udp_header->srcport,
+                                                  p_tx_packet,
+                                                  p_rx_packet->p_payload),
+                          NRF_SUCCESS);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+static void ip_app_handler(iot_interface_t * p_interface, ipv6_event_t * p_event)
+{
+    if (p_event->event_id == IPV6_EVT_INTERFACE_ADD)
+    {
+        mp_interface = p_interface;
+
+        ck_assert_uint_eq(udp6_socket_allocate(&m_socket), NRF_SUCCESS);
+        ck_assert_uint_eq(udp6_socket_bind(&m_socket, IPV6_ADDR_ANY, ECHO_PORT), NRF_SUCCESS);
+        ck_assert_uint_eq(udp6_socket_recv(&m_socket, udp_echo_handler), NRF_SUCCESS);
+    }
+    else if (p_event->event_id == IPV6_EVT_INTERFACE_DELETE)
+    {
+        mp_interface = NULL;
+
+        ck_assert_uint_eq(udp6_socket_free(&m_socket), NRF_SUCCESS);
+    }
+}
+
+
+static void ipv6_medium_evt_handler(ipv6_medium_evt_t * p_ipv6_medium_evt)
+{
+    UNUSED_PARAMETER(p_ipv6_medium_evt);
+}
+
+
+static void ipv6_medium_error_handler(ipv6_medium_error_t * p_ipv6_medium_error)
+{
+    UNUSED_PARAMETER(p_ipv6_medium_error);
+}
+
+
+static void iot_timer_tick_callback(void * p_context)
+{
+    UNUSED_PARAMETER(p_context);
+
+    ck_assert_uint_eq(iot_timer_update(), NRF_SUCCESS);
+}
+
+
+static void iot_timer_client_callback(iot_timer_time_in_ms_t wall_clock_value)
+{
+    UNUSED_PARAMETER(wall_clock_value);
+
+    m_iot_timer_count++;
+}
+
+
+/**@brief Link-local address of the owner of an EUI-64. */
+static void link_local_addr_get(ipv6_addr_t * p_addr, const eui64_t * p_eui64)
+{
+    memset(p_addr, 0, sizeof(ipv6_addr_t));
+    p_addr->u8[0] = 0xFE;
+    p_addr->u8[1] = 0x80;
+    memcpy(&p_addr->u8[8], p_eui64->identifier, EUI_64_ADDR_SIZE);
+    p_addr->u8[8] ^= IPV6_IID_FLIP_VALUE;
+}
+
+
+/**@brief Number of Memory Manager blocks in use, of all categories. */
+static uint32_t memory_in_use_get(void)
+{
+    nrf_mem_cat_stats_t stats;
+    uint32_t            in_use = 0;
+
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            in_use += stats.in_use;
+        }
+    }
+
+    return in_use;
+}
+
+
+static void setup(void)
+{
+    static const iot_timer_client_t        clients[] = { { iot_timer_client_callback, 100 } };
+    static const iot_timer_clients_list_t  list      = { 1, (iot_timer_client_t *)clients };
+    ipv6_medium_init_params_t              medium_params;
+    ipv6_init_t                            ipv6_params;
+
+    m_sequence          = 0;
+    m_reply_sequence    = 0;
+    m_udp_reply_count   = 0;
+    m_icmp_reply_count  = 0;
+    m_icmp_notify_count = 0;
+    m_bad_reply_count   = 0;
+    m_iot_timer_count   = 0;
+    m_checksum_corrupt  = false;
+
+    ck_assert_uint_eq(app_timer_init(0, TIMER_OP_QUEUE_SIZE, m_timer_buffer, NULL), NRF_SUCCESS);
+    ck_assert_uint_eq(app_timer_create(&m_iot_timer_tick,
+                                       APP_TIMER_MODE_REPEATED,
+                                       iot_timer_tick_callback),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(iot_timer_client_list_set(&list), NRF_SUCCESS);
+    ck_assert_uint_eq(app_timer_start(m_iot_timer_tick,
+                                      APP_TIMER_TICKS(IOT_TIMER_RESOLUTION_IN_MS, 0),
+                                      NULL),
+                      NRF_SUCCESS);
+
+    medium_params.ipv6_medium_evt_handler   = ipv6_medium_evt_handler;
+    medium_params.ipv6_medium_error_handler = ipv6_medium_error_handler;
+    ck_assert_uint_eq(ipv6_medium_init(&medium_params, IPV6_MEDIUM_ID_HOST, &m_medium), NRF_SUCCESS);
+    ck_assert_uint_eq(ipv6_medium_eui64_get(m_medium.ipv6_medium_instance_id, &eui64_local_iid),
+                      NRF_SUCCESS);
+
+    ipv6_params.p_eui64       = &eui64_local_iid;
+    ipv6_params.event_handler = ip_app_handler;
+    ck_assert_uint_eq(ipv6_init(&ipv6_params), NRF_SUCCESS);
+
+#if (ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION == 1)
+    ck_assert_uint_eq(icmp6_receive_register(icmp6_handler), NRF_SUCCESS);
+#endif // ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION
+
+    link_local_addr_get(&m_node_addr, &eui64_local_iid);
+    link_local_addr_get(&m_router_addr, &m_router_eui64);
+
+    ck_assert_uint_eq(ble_6lowpan_host_peer_add(&m_router_eui64, router_handler), NRF_SUCCESS);
+    ck_assert_uint_eq(ipv6_medium_connectable_mode_enter(m_medium.ipv6_medium_instance_id),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(ipv6_medium_host_connect(&m_router_eui64), NRF_SUCCESS);
+    ck_assert_ptr_ne(mp_interface, NULL);
+}
+
+
+static void teardown(void)
+{
+    ck_assert_uint_eq(app_timer_stop_all(), NRF_SUCCESS);
+    ck_assert_uint_eq(ipv6_medium_host_disconnect(), NRF_SUCCESS);
+    ck_assert_ptr_eq(mp_interface, NULL);
+
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+}
+
+
+START_TEST(test_udp_echo)
+{
+    ble_6lowpan_host_stats_t stats;
+
+    // Payloads of every size up to the largest, several requests queued at a time. udp6 drops
+    // datagrams without payload.
+    for (uint32_t i = 0; i < ECHO_COUNT; i++)
+    {
+        udp_request_send((uint16_t)(1 + (i % MAX_PAYLOAD_SIZE)));
+
+        if ((i % ECHO_BURST) == (ECHO_BURST - 1))
+        {
+            UNUSED_VARIABLE(ble_6lowpan_host_process());
+        }
+    }
+
+    UNUSED_VARIABLE(ble_6lowpan_host_process());
+
+    ble_6lowpan_host_stats_get(&stats);
+
+    ck_assert_uint_eq(m_bad_reply_count, 0);
+    ck_assert_uint_eq(m_udp_reply_count, ECHO_COUNT);
+    ck_assert_uint_eq(stats.rx_packets, ECHO_COUNT);
+    ck_assert_uint_eq(stats.rx_dropped, 0);
+    ck_assert_uint_eq(stats.tx_unroutable, 0);
+}
+END_TEST
+
+
+START_TEST(test_icmp_echo)
+{
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        icmp_echo_request_send((uint16_t)(i * 2));
+        UNUSED_VARIABLE(ble_6lowpan_host_process());
+
+        ck_assert_uint_eq(m_icmp_reply_count, i + 1);
+    }
+
+    ck_assert_uint_eq(m_bad_reply_count, 0);
+
+#if (ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION == 1)
+    ck_assert_uint_eq(m_icmp_notify_count, 100);
+#endif // ICMP6_ENABLE_ALL_MESSAGES_TO_APPLICATION
+}
+END_TEST
+
+
+START_TEST(test_icmp_echo_bad_checksum)
+{
+    // A request that fails the checksum is dropped, not answered.
+    m_checksum_corrupt = true;
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        icmp_echo_request_send((uint16_t)(i * 3));
+        UNUSED_VARIABLE(ble_6lowpan_host_process());
+    }
+
+    ck_assert_uint_eq(m_icmp_reply_count, 0);
+    ck_assert_uint_eq(m_icmp_notify_count, 0);
+
+    // The next valid request is answered.
+    m_checksum_corrupt = false;
+    m_reply_sequence   = m_sequence;
+
+    icmp_echo_request_send(16);
+    UNUSED_VARIABLE(ble_6lowpan_host_process());
+
+    ck_assert_uint_eq(m_icmp_reply_count, 1);
+    ck_assert_uint_eq(m_bad_reply_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_send_refused_freed)
+{
+    // A packet refused by 6LoWPAN is freed by it, as any packet handed over.
+    iot_interface_t   other_interface;
+    uint8_t         * p_packet = nrf_malloc(IPV6_IP_HEADER_SIZE);
+
+    ck_assert_ptr_ne(p_packet, NULL);
+    memset(p_packet, 0, IPV6_IP_HEADER_SIZE);
+    memset(&other_interface, 0, sizeof(other_interface));
+
+    ck_assert_uint_eq(ble_6lowpan_interface_send(&other_interface, p_packet, IPV6_IP_HEADER_SIZE),
+                      (NRF_ERROR_NOT_FOUND | BLE_6LOWPAN_ERR_BASE));
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+
+    p_packet = nrf_malloc(IPV6_IP_HEADER_SIZE);
+    ck_assert_ptr_ne(p_packet, NULL);
+
+    ck_assert_uint_eq(ble_6lowpan_interface_send(mp_interface, p_packet, IPV6_IP_HEADER_SIZE - 1),
+                      (NRF_ERROR_INVALID_LENGTH | BLE_6LOWPAN_ERR_BASE));
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+
+    // ipv6_send frees the packet buffer only, 6LoWPAN the memory of the packet.
+    iot_pbuffer_alloc_param_t param =
+    {
+        .flags  = PBUFFER_FLAG_DEFAULT,
+        .type   = RAW_PACKET_TYPE,
+        .length = IPV6_IP_HEADER_SIZE
+    };
+    iot_pbuffer_t * p_buffer;
+
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), NRF_SUCCESS);
+    ck_assert_uint_eq(ipv6_send(&other_interface, p_buffer),
+                      (NRF_ERROR_NOT_FOUND | BLE_6LOWPAN_ERR_BASE));
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+}
+END_TEST
+
+
+START_TEST(test_simulated_clock)
+{
+    const uint32_t         period = APP_TIMER_TICKS(IOT_TIMER_RESOLUTION_IN_MS, 0);
+    uint32_t               ticks;
+    iot_timer_time_in_ms_t wall_clock;
+
+    // The IoT Timer runs on the application timer, which only runs when the clock is advanced.
+    ck_assert_uint_eq(app_timer_host_next_expiry_get(&ticks), NRF_SUCCESS);
+    ck_assert_uint_eq(ticks, period);
+
+    app_timer_host_advance((10 * period) - 1);
+    ck_assert_uint_eq(m_iot_timer_count, 9);
+
+    app_timer_host_advance(1);
+    ck_assert_uint_eq(m_iot_timer_count, 10);
+    ck_assert_uint_eq(app_timer_host_ticks_get(), 10 * period);
+    ck_assert_uint_eq(iot_timer_wall_clock_get(&wall_clock), NRF_SUCCESS);
+    ck_assert_uint_eq(wall_clock, 10 * IOT_TIMER_RESOLUTION_IN_MS);
+
+    ck_assert_uint_eq(app_timer_stop(m_iot_timer_tick), NRF_SUCCESS);
+    app_timer_host_advance(RTC_TICKS_PER_SECOND);
+    ck_assert_uint_eq(m_iot_timer_count, 10);
+    ck_assert_uint_eq(app_timer_host_next_expiry_get(&ticks), NRF_ERROR_NOT_FOUND);
+}
+END_TEST
+
+
+static Suite * ipv6_loopback_suite(void)
+{
+    Suite * p_suite = suite_create("ipv6_loopback");
+    TCase * p_case  = tcase_create("ipv6_loopback");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_udp_echo);
+    tcase_add_test(p_case, test_icmp_echo);
+    tcase_add_test(p_case, test_icmp_echo_bad_checksum);
+    tcase_add_test(p_case, test_send_refused_freed);
+    tcase_add_test(p_case, test_simulated_clock);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(ipv6_loopback_suite());
+}
@@ -0,0 +1,24 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file perf.h
+ *
+ * @brief Performance measurement hooks of lwIP, unused in the host unit tests.
+ */
+
+#ifndef ARCH_PERF_H__
+#define ARCH_PERF_H__
+
+#define PERF_START
+#define PERF_STOP(x)
+
+#endif // ARCH_PERF_H__
@@ -0,0 +1,23 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file sys_arch.h
+ *
+ * @brief Operating system types of lwIP. The host unit tests are built with NO_SYS.
+ */
+
+#ifndef ARCH_SYS_ARCH_H__
+#define ARCH_SYS_ARCH_H__
+
+typedef void * sys_prot_t;
+
+#endif // ARCH_SYS_ARCH_H__
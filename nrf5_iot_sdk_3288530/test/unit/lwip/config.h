@@ -0,0 +1,22 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file config.h
+ *
+ * @brief Build configuration included by lwip_check.h of the lwIP unit tests. Nothing is needed
+ *        on the host.
+ */
+
+#ifndef CONFIG_H__
+#define CONFIG_H__
+
+#endif // CONFIG_H__
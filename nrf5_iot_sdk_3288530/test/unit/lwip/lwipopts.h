@@ -0,0 +1,33 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file lwipopts.h
+ *
+ * @brief lwIP options of the host unit tests of the nRF port of lwIP.
+ *
+ * @details Only used by these tests, so that the suites of external/lwip/test/unit keep their
+ *          own options. The port sends IPv6 over 6LoWPAN, so IPv6 is enabled.
+ */
+
+#ifndef LWIPOPTS_H__
+#define LWIPOPTS_H__
+
+// No operating system, and no API layers: the port is called directly.
+#define NO_SYS                          1
+#define LWIP_NETCONN                    0
+#define LWIP_SOCKET                     0
+
+// IPv6 only, as on 6LoWPAN.
+#define LWIP_ARP                        0
+#define LWIP_IPV6                       1
+
+#endif // LWIPOPTS_H__
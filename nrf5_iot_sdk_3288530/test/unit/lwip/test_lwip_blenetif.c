@@ -0,0 +1,32 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Runs the BLENETIF suite of the lwIP unit tests, which tests the output of the nRF port
+ *        of lwIP (external/lwip/test/unit/port/test_blenetif.c).
+ *
+ * @details The suite is built as a program of its own, with the lwIP options in lwipopts.h of
+ *          this directory, as it needs IPv6 which the other lwIP suites are not built with.
+ */
+
+#include "sdk_check.h"
+#include "lwip/init.h"
+#include "port/test_blenetif.h"
+
+
+int main(void)
+{
+    lwip_init();
+
+    return sdk_check_run(blenetif_suite());
+}
@@ -0,0 +1,424 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the LWM2M CoAP handler: the sorted index of objects and instances, the
+ *        lookup of objects by alias name, and the link format string of the registry.
+ *
+ * @details Requests are encoded and given to coap_transport_read, the responses written by CoAP
+ *          are decoded and recorded. Objects and instances are registered in random order, and
+ *          each request must reach the callback of its object or instance. A request for a path
+ *          that matches no object, by number or by alias name, must be answered with 4.04.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_message.h"
+#include "coap_transport.h"
+#include "lwm2m_api.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the client. */
+#define OBJECT_COUNT          4                                                                     /**< Numbered objects registered, LWM2M_COAP_HANDLER_MAX_OBJECTS less the named one. */
+#define ROUNDS                200                                                                   /**< Number of random registrations. */
+
+static const coap_port_t          m_port   = { .port_number = LOCAL_PORT_NUM };
+static coap_remote_t              m_remote = { .port_number = LOCAL_PORT_NUM };
+
+static lwm2m_object_prototype_t   m_objects[OBJECT_COUNT];
+static lwm2m_object_prototype_t   m_named_object;
+static lwm2m_instance_prototype_t m_instances[LWM2M_COAP_HANDLER_MAX_INSTANCES];
+
+static uint16_t                   m_message_id;                                                     /**< Message ID of the next request. */
+static uint32_t                   m_write_count;                                                    /**< Number of messages written by CoAP. */
+static uint8_t                    m_last_code;                                                      /**< Code of the last message written. */
+static void                     * m_last_callee;                                                    /**< Object or instance whose callback was called last. */
+static uint16_t                   m_last_instance_id;                                               /**< Instance id given to the last object callback. */
+static uint32_t                   m_seed;                                                           /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    coap_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    ck_assert_uint_eq(coap_message_decode(&message, p_data, datalen), NRF_SUCCESS);
+
+    m_write_count++;
+    m_last_code = message.header.code;
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t lwm2m_notification(lwm2m_notification_type_t type,
+                            lwm2m_remote_t          * p_remote,
+                            uint8_t                   coap_code)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_coap_handler_root(uint8_t op_code, coap_message_t * p_request)
+{
+    return lwm2m_respond_with_code(COAP_CODE_405_METHOD_NOT_ALLOWED, p_request);
+}
+
+
+static uint32_t object_callback(lwm2m_object_prototype_t * p_object,
+                                uint16_t                   instance_id,
+                                uint8_t                    op_code,
+                                coap_message_t           * p_request)
+{
+    m_last_callee      = p_object;
+    m_last_instance_id = instance_id;
+
+    return lwm2m_respond_with_code(COAP_CODE_205_CONTENT, p_request);
+}
+
+
+static uint32_t instance_callback(lwm2m_instance_prototype_t * p_instance,
+                                  uint16_t                     resource_id,
+                                  uint8_t                      op_code,
+                                  coap_message_t             * p_request)
+{
+    m_last_callee = p_instance;
+
+    return lwm2m_respond_with_code(COAP_CODE_205_CONTENT, p_request);
+}
+
+
+/**@brief Give a request of the server to CoAP, and check that it gets exactly one response.
+ *
+ * @param[in] code   Code of the request.
+ * @param[in] p_path Path of the request, with segments separated by '/'.
+ */
+static void request_send(coap_msg_code_t code, const char * p_path)
+{
+    coap_message_conf_t config;
+    coap_message_t    * p_request;
+    uint8_t             buffer[64];
+    uint16_t            length = sizeof(buffer);
+
+    memset(&config, 0, sizeof(config));
+
+    config.type      = COAP_TYPE_CON;
+    config.code      = code;
+    config.id        = m_message_id++;
+    config.port      = m_port;
+    config.token_len = 1;
+
+    ck_assert_uint_eq(coap_message_new(&p_request, &config), NRF_SUCCESS);
+
+    while (*p_path != '\0')
+    {
+        uint16_t segment_len = (uint16_t)strcspn(p_path, "/");
+
+        ck_assert_uint_eq(coap_message_opt_str_add(p_request, COAP_OPT_URI_PATH,
+                                                   (uint8_t *)p_path, segment_len), NRF_SUCCESS);
+
+        p_path += segment_len + ((p_path[segment_len] == '/') ? 1 : 0);
+    }
+
+    ck_assert_uint_eq(coap_message_encode(p_request, buffer, &length), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_message_delete(p_request), NRF_SUCCESS);
+
+    m_write_count = 0;
+    m_last_callee = NULL;
+
+    (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, buffer, length);
+
+    ck_assert_uint_eq(m_write_count, 1);
+}
+
+
+/**@brief GET a path, and check which callback answered it.
+ *
+ * @param[in] p_path   Path of the request.
+ * @param[in] p_callee Object or instance expected to answer, or NULL for 4.04.
+ */
+static void get_check(const char * p_path, void * p_callee)
+{
+    request_send(COAP_CODE_GET, p_path);
+
+    ck_assert_ptr_eq(m_last_callee, p_callee);
+    ck_assert_uint_eq(m_last_code, (p_callee == NULL) ? COAP_CODE_404_NOT_FOUND : COAP_CODE_205_CONTENT);
+}
+
+
+/**@brief Shuffle an array of pointers. */
+static void shuffle(void ** pp_items, uint32_t count)
+{
+    for (uint32_t i = count; i > 1; i--)
+    {
+        uint32_t j     = rand_get() % i;
+        void   * p_tmp = pp_items[i - 1];
+
+        pp_items[i - 1] = pp_items[j];
+        pp_items[j]     = p_tmp;
+    }
+}
+
+
+static void setup(void)
+{
+    coap_transport_init_t transport_params = { .p_port_table = (coap_port_t *)&m_port };
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_init(17, &transport_params), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_init(), NRF_SUCCESS);
+
+    m_seed       = 1;
+    m_message_id = 100;
+
+    memset(m_objects, 0, sizeof(m_objects));
+    memset(&m_named_object, 0, sizeof(m_named_object));
+    memset(m_instances, 0, sizeof(m_instances));
+
+    m_named_object.object_id    = LWM2M_NAMED_OBJECT;
+    m_named_object.callback     = object_callback;
+    m_named_object.p_alias_name = "bs";
+}
+
+
+static void teardown(void)
+{
+    nrf_mem_cat_stats_t stats;
+
+    // Every request and response was returned to the Memory Manager.
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+
+
+START_TEST(test_alias_lookup)
+{
+    m_objects[0].object_id = 3;
+    m_objects[0].callback  = object_callback;
+
+    ck_assert_uint_eq(lwm2m_coap_handler_object_add(&m_objects[0]), NRF_SUCCESS);
+
+    // Without named objects.
+    get_check("bs", NULL);
+
+    ck_assert_uint_eq(lwm2m_coap_handler_object_add(&m_named_object), NRF_SUCCESS);
+
+    get_check("bs", &m_named_object);
+    ck_assert_uint_eq(m_last_instance_id, LWM2M_INVALID_INSTANCE);
+
+    // A name that matches none of the named objects.
+    get_check("rd", NULL);
+
+    // Numbered paths are not affected by named objects.
+    get_check("3", &m_objects[0]);
+    get_check("4", NULL);
+
+    ck_assert_uint_eq(lwm2m_coap_handler_object_delete(&m_named_object), NRF_SUCCESS);
+
+    get_check("bs", NULL);
+}
+END_TEST
+
+
+START_TEST(test_random_registration)
+{
+    void   * p_objects[OBJECT_COUNT];
+    void   * p_instances[LWM2M_COAP_HANDLER_MAX_INSTANCES];
+    char     path[16];
+
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        ck_assert_uint_eq(lwm2m_init(), NRF_SUCCESS);
+
+        // Object ids and instance ids from a small range, so that several instances share an
+        // object and some objects have none.
+        for (uint32_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            m_objects[i].object_id = (uint16_t)(i * 3 + (rand_get() % 3));
+            m_objects[i].callback  = object_callback;
+            p_objects[i]           = &m_objects[i];
+        }
+
+        for (uint32_t i = 0; i < LWM2M_COAP_HANDLER_MAX_INSTANCES; i++)
+        {
+            m_instances[i].object_id   = m_objects[rand_get() % OBJECT_COUNT].object_id;
+            m_instances[i].instance_id = (uint16_t)i;
+            m_instances[i].callback    = instance_callback;
+            p_instances[i]             = &m_instances[i];
+        }
+
+        shuffle(p_objects, OBJECT_COUNT);
+        shuffle(p_instances, LWM2M_COAP_HANDLER_MAX_INSTANCES);
+
+        for (uint32_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            ck_assert_uint_eq(lwm2m_coap_handler_object_add(p_objects[i]), NRF_SUCCESS);
+        }
+
+        for (uint32_t i = 0; i < LWM2M_COAP_HANDLER_MAX_INSTANCES; i++)
+        {
+            ck_assert_uint_eq(lwm2m_coap_handler_instance_add(p_instances[i]), NRF_SUCCESS);
+        }
+
+        ck_assert_uint_eq(lwm2m_coap_handler_object_add(&m_named_object), NRF_SUCCESS);
+
+        // Every object and instance is found, whatever the order they were added in.
+        for (uint32_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            snprintf(path, sizeof(path), "%u", m_objects[i].object_id);
+            get_check(path, &m_objects[i]);
+        }
+
+        for (uint32_t i = 0; i < LWM2M_COAP_HANDLER_MAX_INSTANCES; i++)
+        {
+            snprintf(path, sizeof(path), "%u/%u", m_instances[i].object_id, m_instances[i].instance_id);
+            get_check(path, &m_instances[i]);
+        }
+
+        // Deleted instances are no longer found, the others still are.
+        lwm2m_instance_prototype_t * p_deleted = p_instances[rand_get() % LWM2M_COAP_HANDLER_MAX_INSTANCES];
+
+        ck_assert_uint_eq(lwm2m_coap_handler_instance_delete(p_deleted), NRF_SUCCESS);
+
+        for (uint32_t i = 0; i < LWM2M_COAP_HANDLER_MAX_INSTANCES; i++)
+        {
+            snprintf(path, sizeof(path), "%u/%u", m_instances[i].object_id, m_instances[i].instance_id);
+            get_check(path, (&m_instances[i] == p_deleted) ? NULL : &m_instances[i]);
+        }
+
+        snprintf(path, sizeof(path), "%u/%u", m_objects[0].object_id, LWM2M_COAP_HANDLER_MAX_INSTANCES);
+        get_check(path, NULL);
+
+        get_check("bs", &m_named_object);
+        get_check("bootstrap", NULL);
+    }
+}
+END_TEST
+
+
+START_TEST(test_link_format)
+{
+    static const uint16_t object_ids[OBJECT_COUNT] = { 3303, 1, 3, 5 };
+    static const uint16_t instances[][2] =
+    {
+        { 3303, 1 }, { 3, 0 }, { 3303, 0 }, { 1, 2 }, { 1, 0 }
+    };
+
+    uint8_t  buffer[64];
+    uint16_t length = sizeof(buffer);
+
+    for (uint32_t i = 0; i < OBJECT_COUNT; i++)
+    {
+        m_objects[i].object_id = object_ids[i];
+        m_objects[i].callback  = object_callback;
+
+        ck_assert_uint_eq(lwm2m_coap_handler_object_add(&m_objects[i]), NRF_SUCCESS);
+    }
+
+    ck_assert_uint_eq(lwm2m_coap_handler_object_add(&m_named_object), NRF_SUCCESS);
+
+    for (uint32_t i = 0; i < sizeof(instances) / sizeof(instances[0]); i++)
+    {
+        m_instances[i].object_id   = instances[i][0];
+        m_instances[i].instance_id = instances[i][1];
+        m_instances[i].callback    = instance_callback;
+
+        ck_assert_uint_eq(lwm2m_coap_handler_instance_add(&m_instances[i]), NRF_SUCCESS);
+    }
+
+    // Sorted by object id, then instance id. Objects without instances are listed alone, named
+    // objects not at all.
+    static const char expected[] = "</1/0>,</1/2>,</3/0>,</5>,</3303/0>,</3303/1>";
+
+    ck_assert_uint_eq(lwm2m_coap_handler_gen_link_format(buffer, &length), NRF_SUCCESS);
+    ck_assert_uint_eq(length, strlen(expected));
+    ck_assert_int_eq(memcmp(buffer, expected, length), 0);
+
+    // Length only.
+    length = 0;
+    ck_assert_uint_eq(lwm2m_coap_handler_gen_link_format(NULL, &length), NRF_SUCCESS);
+    ck_assert_uint_eq(length, strlen(expected));
+
+    // Buffer too small.
+    length = (uint16_t)(strlen(expected) - 1);
+    ck_assert_uint_eq(lwm2m_coap_handler_gen_link_format(buffer, &length), NRF_ERROR_NO_MEM);
+}
+END_TEST
+
+
+static Suite * lwm2m_coap_handler_suite(void)
+{
+    Suite * p_suite = suite_create("lwm2m_coap_handler");
+    TCase * p_case  = tcase_create("lwm2m_coap_handler");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_alias_lookup);
+    tcase_add_test(p_case, test_random_registration);
+    tcase_add_test(p_case, test_link_format);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(lwm2m_coap_handler_suite());
+}
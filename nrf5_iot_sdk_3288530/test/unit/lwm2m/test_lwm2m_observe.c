@@ -0,0 +1,524 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of LWM2M Observe and Write-Attributes (lwm2m_observe.h), with
+ *        LWM2M_ENABLE_OBSERVE set.
+ *
+ * @details Requests of a server are encoded and given to coap_transport_read, the responses and
+ *          notifications written by CoAP are decoded and recorded. The instance under test holds
+ *          two resources, and tells a read from an observation in the content it responds with.
+ *          A GET without the Observe option must remain a plain read, notifications must follow
+ *          the pmin, pmax, st, gt and lt attributes, and observations must end on cancellation,
+ *          or when the instance is deleted.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "coap_api.h"
+#include "coap_message.h"
+#include "coap_observe_api.h"
+#include "coap_option.h"
+#include "coap_transport.h"
+#include "lwm2m_api.h"
+
+#define LOCAL_PORT_NUM        5683                                                                  /**< CoAP port of the client. */
+#define OBJECT_ID             3303                                                                  /**< Temperature object of IPSO. */
+#define RESOURCE_ID_VALUE     5700                                                                  /**< Sensor value resource. */
+#define RESOURCE_ID_UNITS     5701                                                                  /**< Sensor units resource. */
+#define NO_OBSERVE            -1                                                                    /**< Request without the Observe option. */
+#define OBSERVE_REGISTER      0                                                                     /**< Observe option value of a registration. */
+#define OBSERVE_DEREGISTER    1                                                                     /**< Observe option value of a deregistration. */
+#define MAX_PAYLOAD_SIZE      32                                                                    /**< Largest payload recorded. */
+
+/**@brief Instance of the temperature object. */
+typedef struct
+{
+    lwm2m_instance_prototype_t proto;
+    uint8_t                    operations[2];
+    uint16_t                   resource_ids[2];
+} temperature_t;
+
+static const coap_port_t m_port   = { .port_number = LOCAL_PORT_NUM };
+static coap_remote_t     m_remote = { .port_number = LOCAL_PORT_NUM };
+
+static temperature_t     m_temperature;
+static float             m_value;                                                                   /**< Value of the sensor value resource. */
+static uint16_t          m_message_id;                                                              /**< Message ID of the next request. */
+
+static uint32_t          m_write_count;                                                             /**< Number of messages written by CoAP. */
+static uint8_t           m_last_code;                                                               /**< Code of the last message written. */
+static uint16_t          m_last_id;                                                                 /**< Message ID of the last message written. */
+static uint8_t           m_last_token;                                                              /**< First byte of the token of the last message written. */
+static bool              m_last_observe;                                                            /**< Indicates if the last message written has the Observe option. */
+static uint32_t          m_last_sequence;                                                           /**< Value of the Observe option of the last message written. */
+static char              m_last_payload[MAX_PAYLOAD_SIZE];                                          /**< Payload of the last message written, null terminated. */
+
+
+uint32_t coap_transport_init(const coap_transport_init_t * p_param)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t coap_transport_write(const coap_port_t   * p_port,
+                              const coap_remote_t * p_remote,
+                              const uint8_t       * p_data,
+                              uint16_t              datalen)
+{
+    coap_message_t message;
+
+    memset(&message, 0, sizeof(message));
+    ck_assert_uint_eq(coap_message_decode(&message, p_data, datalen), NRF_SUCCESS);
+
+    m_write_count++;
+    m_last_code     = message.header.code;
+    m_last_id       = message.header.id;
+    m_last_token    = message.token[0];
+    m_last_observe  = false;
+    m_last_sequence = 0;
+
+    for (uint32_t i = 0; i < message.options_count; i++)
+    {
+        if (message.options[i].number == COAP_OPT_OBSERVE)
+        {
+            m_last_observe = true;
+            ck_assert_uint_eq(coap_opt_uint_decode(&m_last_sequence,
+                                                   message.options[i].length,
+                                                   message.options[i].p_data), NRF_SUCCESS);
+        }
+    }
+
+    ck_assert_uint_lt(message.payload_len, MAX_PAYLOAD_SIZE);
+
+    memset(m_last_payload, 0, sizeof(m_last_payload));
+    memcpy(m_last_payload, message.p_payload, message.payload_len);
+
+    return NRF_SUCCESS;
+}
+
+
+void coap_transport_process(void)
+{
+}
+
+
+uint32_t coap_security_setup(uint16_t                       local_port,
+                             nrf_tls_role_t                 role,
+                             coap_remote_t          * const p_remote,
+                             nrf_tls_key_settings_t * const p_settings)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t coap_security_destroy(uint16_t local_port, coap_remote_t * const p_remote)
+{
+    return API_NOT_IMPLEMENTED;
+}
+
+
+uint32_t lwm2m_notification(lwm2m_notification_type_t type,
+                            lwm2m_remote_t          * p_remote,
+                            uint8_t                   coap_code)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t lwm2m_coap_handler_root(uint8_t op_code, coap_message_t * p_request)
+{
+    return lwm2m_respond_with_code(COAP_CODE_405_METHOD_NOT_ALLOWED, p_request);
+}
+
+
+/**@brief Respond with "R" for a read or "O" for an observation, the resource id and the value. */
+static uint32_t temperature_callback(lwm2m_instance_prototype_t * p_instance,
+                                     uint16_t                     resource_id,
+                                     uint8_t                      op_code,
+                                     coap_message_t             * p_request)
+{
+    char     buffer[MAX_PAYLOAD_SIZE];
+    uint32_t length;
+
+    if ((op_code != LWM2M_OPERATION_CODE_READ) && (op_code != LWM2M_OPERATION_CODE_OBSERVE))
+    {
+        return lwm2m_respond_with_code(COAP_CODE_405_METHOD_NOT_ALLOWED, p_request);
+    }
+
+    length = (uint32_t)snprintf(buffer, sizeof(buffer), "%c%u:%.1f",
+                                (op_code == LWM2M_OPERATION_CODE_OBSERVE) ? 'O' : 'R',
+                                resource_id,
+                                (double)m_value);
+
+    return lwm2m_respond_with_payload((uint8_t *)buffer, (uint16_t)length, p_request);
+}
+
+
+/**@brief Give a request of the server to CoAP.
+ *
+ * @param[in] code    Code of the request.
+ * @param[in] token   Token of the request, one byte.
+ * @param[in] p_path  Path of the request, with segments separated by '/'.
+ * @param[in] observe Value of the Observe option, or NO_OBSERVE.
+ * @param[in] p_query Query of the request with arguments separated by '&', or NULL.
+ */
+static void request_send(coap_msg_code_t code,
+                         uint8_t         token,
+                         const char    * p_path,
+                         int32_t         observe,
+                         const char    * p_query)
+{
+    coap_message_conf_t config;
+    coap_message_t    * p_request;
+    uint8_t             buffer[128];
+    uint16_t            length = sizeof(buffer);
+    const char        * p_segment;
+
+    memset(&config, 0, sizeof(config));
+
+    config.type      = COAP_TYPE_CON;
+    config.code      = code;
+    config.id        = m_message_id++;
+    config.port      = m_port;
+    config.token[0]  = token;
+    config.token_len = 1;
+
+    ck_assert_uint_eq(coap_message_new(&p_request, &config), NRF_SUCCESS);
+
+    if (observe != NO_OBSERVE)
+    {
+        ck_assert_uint_eq(coap_message_opt_uint_add(p_request, COAP_OPT_OBSERVE, (uint32_t)observe),
+                          NRF_SUCCESS);
+    }
+
+    for (p_segment = p_path; *p_segment != '\0'; )
+    {
+        uint16_t segment_len = (uint16_t)strcspn(p_segment, "/");
+
+        ck_assert_uint_eq(coap_message_opt_str_add(p_request, COAP_OPT_URI_PATH,
+                                                   (uint8_t *)p_segment, segment_len), NRF_SUCCESS);
+
+        p_segment += segment_len + ((p_segment[segment_len] == '/') ? 1 : 0);
+    }
+
+    for (p_segment = p_query; (p_segment != NULL) && (*p_segment != '\0'); )
+    {
+        uint16_t argument_len = (uint16_t)strcspn(p_segment, "&");
+
+        ck_assert_uint_eq(coap_message_opt_str_add(p_request, COAP_OPT_URI_QUERY,
+                                                   (uint8_t *)p_segment, argument_len), NRF_SUCCESS);
+
+        p_segment += argument_len + ((p_segment[argument_len] == '&') ? 1 : 0);
+    }
+
+    ck_assert_uint_eq(coap_message_encode(p_request, buffer, &length), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_message_delete(p_request), NRF_SUCCESS);
+
+    m_write_count = 0;
+    (void)coap_transport_read(&m_port, &m_remote, NRF_SUCCESS, buffer, length);
+
+    // Every request gets exactly one response.
+    ck_assert_uint_eq(m_write_count, 1);
+}
+
+
+/**@brief Call lwm2m_observe_tick once per second.
+ *
+ * @return Number of notifications sent.
+ */
+static uint32_t ticks_run(uint32_t seconds)
+{
+    m_write_count = 0;
+
+    while (seconds-- > 0)
+    {
+        ck_assert_uint_eq(lwm2m_observe_tick(), NRF_SUCCESS);
+    }
+
+    return m_write_count;
+}
+
+
+/**@brief Set the sensor value, and report it. */
+static void value_update(float value)
+{
+    m_value = value;
+    ck_assert_uint_eq(lwm2m_observe_resource_update(OBJECT_ID, 0, RESOURCE_ID_VALUE, value),
+                      NRF_SUCCESS);
+}
+
+
+static void setup(void)
+{
+    coap_transport_init_t transport_params = { .p_port_table = (coap_port_t *)&m_port };
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(coap_init(17, &transport_params), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_init(), NRF_SUCCESS);
+
+    memset(&m_temperature, 0, sizeof(m_temperature));
+
+    m_temperature.proto.object_id           = OBJECT_ID;
+    m_temperature.proto.instance_id         = 0;
+    m_temperature.proto.num_resources       = 2;
+    m_temperature.proto.operations_offset   = offsetof(temperature_t, operations);
+    m_temperature.proto.resource_ids_offset = offsetof(temperature_t, resource_ids);
+    m_temperature.proto.callback            = temperature_callback;
+    m_temperature.operations[0]             = LWM2M_OPERATION_CODE_READ;
+    m_temperature.operations[1]             = LWM2M_OPERATION_CODE_READ;
+    m_temperature.resource_ids[0]           = RESOURCE_ID_VALUE;
+    m_temperature.resource_ids[1]           = RESOURCE_ID_UNITS;
+
+    ck_assert_uint_eq(lwm2m_coap_handler_instance_add(&m_temperature.proto), NRF_SUCCESS);
+
+    m_value      = 20.0f;
+    m_message_id = 100;
+}
+
+
+static void teardown(void)
+{
+    nrf_mem_cat_stats_t stats;
+
+    (void)lwm2m_coap_handler_instance_delete(&m_temperature.proto);
+
+    // Every request, response and notification was returned to the Memory Manager.
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+
+
+START_TEST(test_read_without_observe)
+{
+    // A GET without the Observe option is a read, and is answered without the Observe option.
+    request_send(COAP_CODE_GET, 1, "3303/0/5700", NO_OBSERVE, NULL);
+
+    ck_assert_uint_eq(m_last_code, COAP_CODE_205_CONTENT);
+    ck_assert(!m_last_observe);
+    ck_assert_str_eq(m_last_payload, "R5700:20.0");
+
+    // Nor does it start notifications.
+    value_update(30.0f);
+    ck_assert_uint_eq(ticks_run(100), 0);
+}
+END_TEST
+
+
+START_TEST(test_write_attributes)
+{
+    // Thresholds only apply to a resource.
+    request_send(COAP_CODE_PUT, 2, "3303/0", NO_OBSERVE, "st=1");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_400_BAD_REQUEST);
+
+    // lt must be below gt, and lt + 2 * st must be below gt.
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "gt=10&lt=20");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_400_BAD_REQUEST);
+
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "lt=10&gt=20&st=5");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_400_BAD_REQUEST);
+
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "pmin=x");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_400_BAD_REQUEST);
+
+    request_send(COAP_CODE_PUT, 2, "3303/0/9999", NO_OBSERVE, "pmin=1");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_404_NOT_FOUND);
+
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "pmin=2&pmax=10&st=1.5");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_204_CHANGED);
+}
+END_TEST
+
+
+START_TEST(test_observe_resource)
+{
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "pmin=2&pmax=10&st=1.5");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_204_CHANGED);
+
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_REGISTER, NULL);
+    ck_assert_uint_eq(m_last_code, COAP_CODE_205_CONTENT);
+    ck_assert(m_last_observe);
+    ck_assert_uint_eq(m_last_sequence, 0);
+    ck_assert_str_eq(m_last_payload, "O5700:20.0");
+
+    // A change smaller than st is not notified.
+    value_update(20.0f);
+    value_update(21.0f);
+    ck_assert_uint_eq(ticks_run(5), 0);
+
+    value_update(22.0f);
+    ck_assert_uint_eq(ticks_run(1), 1);
+    ck_assert(m_last_observe);
+    ck_assert_uint_eq(m_last_sequence, 1);
+    ck_assert_uint_eq(m_last_token, 0xAA);
+    ck_assert_str_eq(m_last_payload, "O5700:22.0");
+
+    // pmin holds the next change back.
+    value_update(30.0f);
+    ck_assert_uint_eq(ticks_run(1), 0);
+    ck_assert_uint_eq(ticks_run(1), 1);
+    ck_assert_uint_eq(m_last_sequence, 2);
+
+    // pmax notifies without a change, in a new message each time.
+    ck_assert_uint_eq(ticks_run(9), 0);
+    ck_assert_uint_eq(ticks_run(1), 1);
+    ck_assert_uint_eq(m_last_sequence, 3);
+    ck_assert_str_eq(m_last_payload, "O5700:30.0");
+
+    uint16_t last_id = m_last_id;
+
+    ck_assert_uint_eq(ticks_run(10), 1);
+    ck_assert_uint_ne(m_last_id, last_id);
+}
+END_TEST
+
+
+START_TEST(test_observe_instance)
+{
+    request_send(COAP_CODE_GET, 0xBB, "3303/0", OBSERVE_REGISTER, NULL);
+    ck_assert_uint_eq(m_last_code, COAP_CODE_205_CONTENT);
+    ck_assert(m_last_observe);
+    ck_assert_str_eq(m_last_payload, "O65535:20.0");
+
+    // An object that is not registered can not be observed.
+    request_send(COAP_CODE_GET, 0xCC, "3304", OBSERVE_REGISTER, NULL);
+    ck_assert_uint_eq(m_last_code, COAP_CODE_404_NOT_FOUND);
+
+    // A change of any resource notifies the observation of the instance.
+    ck_assert_uint_eq(lwm2m_observe_resource_changed(OBJECT_ID, 0, RESOURCE_ID_UNITS), NRF_SUCCESS);
+    ck_assert_uint_eq(ticks_run(1), 1);
+    ck_assert_uint_eq(m_last_token, 0xBB);
+}
+END_TEST
+
+
+START_TEST(test_observe_cancel)
+{
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_REGISTER, NULL);
+    request_send(COAP_CODE_GET, 0xBB, "3303/0", OBSERVE_REGISTER, NULL);
+
+    // Deregistration with Observe set to 1 is followed by a read.
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_DEREGISTER, NULL);
+    ck_assert_uint_eq(m_last_code, COAP_CODE_205_CONTENT);
+    ck_assert(!m_last_observe);
+    ck_assert_str_eq(m_last_payload, "R5700:20.0");
+
+    // Only the observation of the instance is left.
+    value_update(50.0f);
+    ck_assert_uint_eq(ticks_run(20), 1);
+    ck_assert_uint_eq(m_last_token, 0xBB);
+
+    // The cancel attribute ends the observation of the instance.
+    request_send(COAP_CODE_PUT, 3, "3303/0", NO_OBSERVE, "cancel");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_204_CHANGED);
+
+    value_update(60.0f);
+    ck_assert_uint_eq(ticks_run(20), 0);
+}
+END_TEST
+
+
+START_TEST(test_observe_register_again)
+{
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "pmax=10");
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_REGISTER, NULL);
+    ck_assert_uint_eq(ticks_run(10), 1);
+    ck_assert_uint_eq(m_last_sequence, 1);
+
+    // A new registration of the same path takes over its attributes and sequence number.
+    request_send(COAP_CODE_GET, 0xDD, "3303/0/5700", OBSERVE_REGISTER, NULL);
+    ck_assert(m_last_observe);
+    ck_assert_uint_eq(m_last_sequence, 2);
+
+    ck_assert_uint_eq(ticks_run(9), 0);
+    ck_assert_uint_eq(ticks_run(1), 1);
+    ck_assert_uint_eq(m_last_sequence, 3);
+    ck_assert_uint_eq(m_last_token, 0xDD);
+}
+END_TEST
+
+
+START_TEST(test_threshold_crossing)
+{
+    request_send(COAP_CODE_PUT, 2, "3303/0/5700", NO_OBSERVE, "gt=55");
+    ck_assert_uint_eq(m_last_code, COAP_CODE_204_CHANGED);
+
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_REGISTER, NULL);
+
+    // Only crossing gt, either way, is notified.
+    value_update(50.0f);
+    value_update(54.0f);
+    ck_assert_uint_eq(ticks_run(30), 0);
+
+    value_update(56.0f);
+    ck_assert_uint_eq(ticks_run(3), 1);
+
+    value_update(57.0f);
+    ck_assert_uint_eq(ticks_run(3), 0);
+
+    value_update(54.0f);
+    ck_assert_uint_eq(ticks_run(3), 1);
+}
+END_TEST
+
+
+START_TEST(test_instance_deleted)
+{
+    request_send(COAP_CODE_GET, 0xAA, "3303/0/5700", OBSERVE_REGISTER, NULL);
+
+    // The observation ends with the instance, on the notification of a change, and does not come
+    // back with it.
+    value_update(20.0f);
+    value_update(60.0f);
+    ck_assert_uint_eq(lwm2m_coap_handler_instance_delete(&m_temperature.proto), NRF_SUCCESS);
+    ck_assert_uint_eq(ticks_run(3), 0);
+
+    ck_assert_uint_eq(lwm2m_coap_handler_instance_add(&m_temperature.proto), NRF_SUCCESS);
+    value_update(40.0f);
+    ck_assert_uint_eq(ticks_run(30), 0);
+}
+END_TEST
+
+
+static Suite * lwm2m_observe_suite(void)
+{
+    Suite * p_suite = suite_create("lwm2m_observe");
+    TCase * p_case  = tcase_create("lwm2m_observe");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_read_without_observe);
+    tcase_add_test(p_case, test_write_attributes);
+    tcase_add_test(p_case, test_observe_resource);
+    tcase_add_test(p_case, test_observe_instance);
+    tcase_add_test(p_case, test_observe_cancel);
+    tcase_add_test(p_case, test_observe_register_again);
+    tcase_add_test(p_case, test_threshold_crossing);
+    tcase_add_test(p_case, test_instance_deleted);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(lwm2m_observe_suite());
+}
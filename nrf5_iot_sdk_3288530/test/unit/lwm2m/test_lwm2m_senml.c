@@ -0,0 +1,721 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the SenML-JSON and SenML-CBOR writer and reader (lwm2m_senml.h), with
+ *        LWM2M_ENABLE_SENML_JSON and LWM2M_ENABLE_SENML_CBOR set.
+ *
+ * @details An instance of the temperature object is written and read back in both formats. Every
+ *          truncation of the buffer must fail cleanly when writing, and must never read as a
+ *          valid payload. Floats are written in JSON with 9 significant digits, and must read back
+ *          bit for bit. Payloads of other encoders, using indefinite lengths, escapes, tags or
+ *          double precision, must be read, and malformed payloads rejected.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdk_check.h"
+#include "lwm2m_senml.h"
+
+#define ROUNDS                100000                                                                /**< Number of random floats written and read back. */
+#define BUFFER_SIZE           512                                                                   /**< Size of the payload buffers. */
+
+/**@brief Resources of the temperature object, in the order they are written. */
+static const uint16_t m_temperature_ids[] = { 5700, 5701, 5601, 5602, 5603, 5604, 5750 };
+static const float    m_temperature_values[] = { 21.5f, 0.0f, -3.25f, 38.7f, -40.0f, 125.0f, 0.0f };
+
+static uint8_t        m_buffer[BUFFER_SIZE];
+static uint8_t        m_copy[BUFFER_SIZE];                                                          /**< The reader unescapes strings in place, so it works on a copy. */
+static uint32_t       m_len;                                                                        /**< Length of the payload in m_buffer. */
+static uint32_t       m_seed;                                                                       /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+/**@brief Write the instance of the temperature object.
+ *
+ * @return Result of the writer, NRF_ERROR_DATA_SIZE if the buffer is too small.
+ */
+static uint32_t temperature_write(uint8_t * p_buffer, uint32_t buffer_len, coap_content_type_t content_type, uint32_t * p_len)
+{
+    lwm2m_senml_writer_t writer;
+    uint16_t             path[2] = { 3303, 0 };
+    lwm2m_string_t       units   = { .p_val = "Cel", .len = 3 };
+    lwm2m_string_t       app     = { .p_val = "Living room", .len = 11 };
+    uint32_t             err_code;
+
+    err_code = lwm2m_senml_writer_init(&writer, content_type, p_buffer, buffer_len, path, 2);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    err_code |= lwm2m_senml_float_add(&writer, 5700, m_temperature_values[0]);
+    err_code |= lwm2m_senml_string_add(&writer, 5701, units);
+    err_code |= lwm2m_senml_float_add(&writer, 5601, m_temperature_values[2]);
+    err_code |= lwm2m_senml_float_add(&writer, 5602, m_temperature_values[3]);
+    err_code |= lwm2m_senml_float_add(&writer, 5603, m_temperature_values[4]);
+    err_code |= lwm2m_senml_float_add(&writer, 5604, m_temperature_values[5]);
+    err_code |= lwm2m_senml_string_add(&writer, 5750, app);
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    return lwm2m_senml_writer_finish(&writer, p_len);
+}
+
+
+/**@brief Write the temperature object, read it back and check every record. */
+static void round_trip_check(coap_content_type_t content_type)
+{
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    uint32_t             len;
+    uint32_t             dry_len;
+
+    ck_assert_uint_eq(temperature_write(m_buffer, sizeof(m_buffer), content_type, &len), NRF_SUCCESS);
+
+    // Without a buffer, only the length is calculated.
+    ck_assert_uint_eq(temperature_write(NULL, 0, content_type, &dry_len), NRF_SUCCESS);
+    ck_assert_uint_eq(dry_len, len);
+
+    memcpy(m_copy, m_buffer, len);
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, content_type, m_copy, len), NRF_SUCCESS);
+
+    for (uint32_t i = 0; i < sizeof(m_temperature_ids) / sizeof(m_temperature_ids[0]); i++)
+    {
+        ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+        ck_assert_uint_eq(record.path_len, 3);
+        ck_assert_uint_eq(record.path[0], 3303);
+        ck_assert_uint_eq(record.path[1], 0);
+        ck_assert_uint_eq(record.path[2], m_temperature_ids[i]);
+
+        if (m_temperature_ids[i] == 5701)
+        {
+            ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_STRING);
+            ck_assert_uint_eq(record.value.string.len, 3);
+            ck_assert_int_eq(memcmp(record.value.string.p_val, "Cel", 3), 0);
+        }
+        else if (m_temperature_ids[i] == 5750)
+        {
+            ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_STRING);
+            ck_assert_uint_eq(record.value.string.len, 11);
+            ck_assert_int_eq(memcmp(record.value.string.p_val, "Living room", 11), 0);
+        }
+        else if (record.type == LWM2M_SENML_TYPE_INTEGER)
+        {
+            // Floats without a fraction are written as integers.
+            ck_assert_int_eq(record.value.integer, (int32_t)m_temperature_values[i]);
+        }
+        else
+        {
+            ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_FLOAT);
+            ck_assert(record.value.fp == m_temperature_values[i]);
+        }
+    }
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+}
+
+
+/**@brief Write the temperature object to every buffer too small for it, and read every truncation
+ *        of the payload. */
+static void truncation_check(coap_content_type_t content_type)
+{
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    uint32_t             len;
+    uint32_t             truncated_len;
+
+    ck_assert_uint_eq(temperature_write(m_buffer, sizeof(m_buffer), content_type, &len), NRF_SUCCESS);
+
+    for (uint32_t buffer_len = 0; buffer_len < len; buffer_len++)
+    {
+        uint8_t small[BUFFER_SIZE];
+
+        ck_assert_uint_eq(temperature_write(small, buffer_len, content_type, &truncated_len),
+                          (NRF_ERROR_DATA_SIZE | IOT_LWM2M_ERR_BASE));
+
+        memcpy(m_copy, m_buffer, len);
+
+        if (lwm2m_senml_reader_init(&reader, content_type, m_copy, buffer_len) == NRF_SUCCESS)
+        {
+            uint32_t err_code;
+
+            do
+            {
+                err_code = lwm2m_senml_record_next(&reader, &record);
+            } while (err_code == NRF_SUCCESS);
+
+            // An empty CBOR payload holds no item, neither valid nor invalid.
+            if ((content_type != COAP_CT_APP_SENML_CBOR) || (buffer_len != 0))
+            {
+                ck_assert_uint_eq(err_code, (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE));
+            }
+        }
+    }
+}
+
+
+/**@brief Write a float as the only record of a SenML-JSON payload.
+ *
+ * @return The JSON number written, NUL terminated, in a static buffer.
+ */
+static const char * json_float_write(float value)
+{
+    static const char    prefix[] = "[{\"bn\":\"/3303/0/\",\"n\":\"5700\",\"v\":";
+    static char          number[BUFFER_SIZE];
+    lwm2m_senml_writer_t writer;
+    uint16_t             path[2] = { 3303, 0 };
+    uint32_t             len;
+
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_JSON, m_buffer, sizeof(m_buffer), path, 2),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_float_add(&writer, 5700, value), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &m_len), NRF_SUCCESS);
+
+    len = m_len;
+
+    ck_assert_uint_gt(len, sizeof(prefix) + 1);
+    ck_assert_int_eq(memcmp(m_buffer, prefix, sizeof(prefix) - 1), 0);
+    ck_assert_int_eq(memcmp(&m_buffer[len - 2], "}]", 2), 0);
+
+    len -= sizeof(prefix) - 1 + 2;
+    memcpy(number, &m_buffer[sizeof(prefix) - 1], len);
+    number[len] = '\0';
+
+    return number;
+}
+
+
+/**@brief Read back the payload of @ref json_float_write. */
+static float json_float_read(void)
+{
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, m_buffer, m_len), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+
+    return (record.type == LWM2M_SENML_TYPE_INTEGER) ? (float)record.value.integer : record.value.fp;
+}
+
+
+static void setup(void)
+{
+    m_seed = 1;
+    m_len  = 0;
+
+    memset(m_buffer, 0, sizeof(m_buffer));
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_json_round_trip)
+{
+    round_trip_check(COAP_CT_APP_SENML_JSON);
+}
+END_TEST
+
+
+START_TEST(test_cbor_round_trip)
+{
+    round_trip_check(COAP_CT_APP_SENML_CBOR);
+}
+END_TEST
+
+
+START_TEST(test_json_truncated_buffer)
+{
+    truncation_check(COAP_CT_APP_SENML_JSON);
+}
+END_TEST
+
+
+START_TEST(test_cbor_truncated_buffer)
+{
+    truncation_check(COAP_CT_APP_SENML_CBOR);
+}
+END_TEST
+
+
+START_TEST(test_json_float_format)
+{
+    static const struct
+    {
+        float        value;
+        const char * p_str;
+    } floats[] =
+    {
+        { 0.0f,            "0"              },
+        { 0.5f,            "0.5"            },
+        { -3.25f,          "-3.25"          },
+        { 0.0009765625f,   "0.0009765625"   },
+        { 1e10f,           "1e10"           },
+        { -2147483648.0f,  "-2147483648"    },
+        { 2147483648.0f,   "2.14748365e9"   },
+        { 0.1f,            "0.100000001"    },
+        { -0.001f,         "-0.00100000005" },
+        { 1e-5f,           "9.99999975e-6"  },
+        { 123456.7f,       "123456.703"     },
+        { 1234567.8f,      "1234567.75"     },
+        { 3.14159265f,     "3.14159274"     },
+        { 3.4e38f,         "3.39999995e38"  },
+        { 1.17549435e-38f, "1.17549435e-38" },
+        { 1.4e-45f,        "1.40129846e-45" },
+    };
+
+    for (uint32_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++)
+    {
+        ck_assert_str_eq(json_float_write(floats[i].value), floats[i].p_str);
+        ck_assert(json_float_read() == floats[i].value);
+    }
+}
+END_TEST
+
+
+START_TEST(test_json_float_random)
+{
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        uint32_t bits = rand_get();
+        float    value;
+        char     expected[32];
+
+        memcpy(&value, &bits, sizeof(value));
+
+        if ((bits & 0x7F800000) == 0x7F800000)
+        {
+            // NaN or infinity.
+            continue;
+        }
+
+        const char * p_number = json_float_write(value);
+
+        // Integers within the range of int32_t are written exactly, any other float as the nearest
+        // number of 9 significant digits, which reads back as the same float.
+        if ((value >= -2147483648.0f) && (value < 2147483648.0f) && (value == (float)(int32_t)value))
+        {
+            snprintf(expected, sizeof(expected), "%ld", (long)value);
+            ck_assert_str_eq(p_number, expected);
+        }
+        else
+        {
+            snprintf(expected, sizeof(expected), "%.9g", (double)value);
+            ck_assert(strtod(p_number, NULL) == strtod(expected, NULL));
+        }
+        ck_assert(json_float_read() == value);
+    }
+}
+END_TEST
+
+
+START_TEST(test_json_strings_and_multiple_instances)
+{
+    lwm2m_senml_writer_t writer;
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    uint16_t             path[3] = { 3, 0, 0 };
+    uint32_t             len;
+
+    // A single resource: the base name has no trailing slash, and the record no name.
+    memset(&record, 0, sizeof(record));
+    record.path[0]            = 3;
+    record.path_len           = 3;
+    record.type               = LWM2M_SENML_TYPE_STRING;
+    record.value.string.p_val = "Open \"Mobile\"\n\\";
+    record.value.string.len   = 15;
+
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_JSON, m_buffer, sizeof(m_buffer), path, 3),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_record_add(&writer, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &len), NRF_SUCCESS);
+
+    m_buffer[len] = '\0';
+    ck_assert_str_eq((char *)m_buffer, "[{\"bn\":\"/3/0/0\",\"vs\":\"Open \\\"Mobile\\\"\\u000a\\\\\"}]");
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, m_buffer, len), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path_len, 3);
+    ck_assert_uint_eq(record.value.string.len, 15);
+    ck_assert_int_eq(memcmp(record.value.string.p_val, "Open \"Mobile\"\n\\", 15), 0);
+
+    // Instances of a multiple resource: the base name has a trailing slash. Records outside the
+    // base path are rejected.
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_JSON, m_buffer, sizeof(m_buffer), path, 3),
+                      NRF_SUCCESS);
+
+    record.path[0]       = 3;
+    record.path[1]       = 0;
+    record.path[2]       = 0;
+    record.path[3]       = 0;
+    record.path_len      = 4;
+    record.type          = LWM2M_SENML_TYPE_INTEGER;
+    record.value.integer = 3800;
+    ck_assert_uint_eq(lwm2m_senml_record_add(&writer, &record), NRF_SUCCESS);
+
+    record.path[3]       = 1;
+    record.value.integer = -5000;
+    ck_assert_uint_eq(lwm2m_senml_record_add(&writer, &record), NRF_SUCCESS);
+
+    record.path_len = 3;
+    ck_assert_uint_eq(lwm2m_senml_record_add(&writer, &record), (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE));
+
+    record.path[0]  = 4;
+    record.path_len = 4;
+    ck_assert_uint_eq(lwm2m_senml_record_add(&writer, &record), (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE));
+
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &len), NRF_SUCCESS);
+
+    m_buffer[len] = '\0';
+    ck_assert_str_eq((char *)m_buffer, "[{\"bn\":\"/3/0/0/\",\"n\":\"0\",\"v\":3800},{\"n\":\"1\",\"v\":-5000}]");
+}
+END_TEST
+
+
+START_TEST(test_cbor_encoding)
+{
+    static const uint8_t expected[] =
+    {
+        0x85,
+        0xA3, 0x21, 0x68, '/', '3', '3', '0', '3', '/', '0', '/', 0x00, 0x64, '5', '7', '0', '0', 0x02, 0xF9, 0x4D, 0x60,
+        0xA2, 0x00, 0x64, '5', '8', '5', '0', 0x04, 0xF5,
+        0xA2, 0x00, 0x64, '5', '6', '0', '1', 0x02, 0xFA, 0x42, 0x1A, 0xCC, 0xCD,
+        0xA2, 0x00, 0x61, '5', 0x02, 0x39, 0x01, 0xF3,
+        0xA2, 0x00, 0x61, '6', 0x08, 0x44, 1, 2, 3, 0xFF,
+    };
+
+    lwm2m_senml_writer_t writer;
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    uint16_t             path[2]   = { 3303, 0 };
+    uint8_t              opaque[4] = { 1, 2, 3, 0xFF };
+    lwm2m_opaque_t       data      = { .p_val = opaque, .len = 4 };
+    uint32_t             len;
+
+    // Floats as half precision when exact, single precision otherwise.
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_CBOR, m_buffer, sizeof(m_buffer), path, 2),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_float_add(&writer, 5700, 21.5f), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_bool_add(&writer, 5850, true), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_float_add(&writer, 5601, 38.7f), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_integer_add(&writer, 5, -500), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_opaque_add(&writer, 6, data), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &len), NRF_SUCCESS);
+
+    ck_assert_uint_eq(len, sizeof(expected));
+    ck_assert_int_eq(memcmp(m_buffer, expected, len), 0);
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_CBOR, m_buffer, len), NRF_SUCCESS);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_FLOAT);
+    ck_assert(record.value.fp == 21.5f);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_BOOLEAN);
+    ck_assert(record.value.boolean);
+    ck_assert_uint_eq(record.path[2], 5850);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert(record.value.fp == 38.7f);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_INTEGER);
+    ck_assert_int_eq(record.value.integer, -500);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_OPAQUE);
+    ck_assert_uint_eq(record.value.opaque.len, 4);
+    ck_assert_int_eq(memcmp(record.value.opaque.p_val, opaque, 4), 0);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+
+    // Infinities and NaNs have no SenML representation.
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_CBOR, m_buffer, sizeof(m_buffer), path, 2),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_float_add(&writer, 5700, strtof("inf", NULL)),
+                      (NRF_ERROR_INVALID_PARAM | IOT_LWM2M_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_cbor_long_array)
+{
+    lwm2m_senml_writer_t writer;
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    uint16_t             path[2] = { 3303, 0 };
+    uint32_t             len;
+
+    // More than 23 records need a longer array head, and half precision subnormals.
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_CBOR, m_buffer, sizeof(m_buffer), path, 2),
+                      NRF_SUCCESS);
+
+    for (uint16_t i = 0; i < 30; i++)
+    {
+        ck_assert_uint_eq(lwm2m_senml_float_add(&writer, i, (i + 0.25f) / 16777216.0f), NRF_SUCCESS);
+    }
+
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &len), NRF_SUCCESS);
+    ck_assert_uint_eq(m_buffer[0], 0x98);
+    ck_assert_uint_eq(m_buffer[1], 30);
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_CBOR, m_buffer, len), NRF_SUCCESS);
+
+    for (uint16_t i = 0; i < 30; i++)
+    {
+        ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+        ck_assert_uint_eq(record.path[2], i);
+        ck_assert(record.value.fp == (i + 0.25f) / 16777216.0f);
+    }
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+
+    // The 24th record fits the buffer, but the longer array head it needs does not.
+    uint32_t full_len;
+
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_CBOR, NULL, 0, path, 2), NRF_SUCCESS);
+    for (int32_t i = 0; i < 24; i++)
+    {
+        ck_assert_uint_eq(lwm2m_senml_integer_add(&writer, (uint16_t)i, i), NRF_SUCCESS);
+    }
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &full_len), NRF_SUCCESS);
+
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_CBOR, m_buffer, full_len - 1, path, 2),
+                      NRF_SUCCESS);
+
+    uint32_t added = 0;
+
+    for (int32_t i = 0; i < 24; i++)
+    {
+        if (lwm2m_senml_integer_add(&writer, (uint16_t)i, i) == NRF_SUCCESS)
+        {
+            added++;
+        }
+    }
+
+    ck_assert_uint_eq(added, 23);
+    ck_assert_uint_eq(lwm2m_senml_writer_finish(&writer, &len), NRF_SUCCESS);
+    ck_assert_uint_le(len, full_len - 1);
+    ck_assert_uint_eq(m_buffer[0], 0x80 + 23);
+}
+END_TEST
+
+
+START_TEST(test_json_other_encoders)
+{
+    static const uint8_t opaque[4] = { 1, 2, 3, 0xFF };
+
+    char payload[] = " [ {\"bn\" : \"/3303/0/\", \"n\":\"5700\", \"v\": 2.5e1, \"t\": 12, \"u\":\"Cel\"},\n"
+                     "{\"n\":\"5750\",\"vs\":\"caf\\u00e9 \\u20ac\"}, {\"n\":\"1\",\"vd\":\"AQID_w\"},"
+                     "{\"n\":\"2\",\"vd\":\"AQID/w==\"}, {\"bn\":\"/1/2\",\"vb\":false}, {\"n\":\"/3\", \"v\":-2147483649} ] ";
+
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, (uint8_t *)payload, strlen(payload)),
+                      NRF_SUCCESS);
+
+    // Exponent, and labels that are skipped.
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_FLOAT);
+    ck_assert(record.value.fp == 25.0f);
+    ck_assert_uint_eq(record.path[2], 5700);
+
+    // Unicode escapes, to UTF-8.
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.value.string.len, 9);
+    ck_assert_int_eq(memcmp(record.value.string.p_val, "caf\xc3\xa9 \xe2\x82\xac", 9), 0);
+
+    // base64url, and base64 with padding.
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path[2], 1);
+    ck_assert_uint_eq(record.value.opaque.len, 4);
+    ck_assert_int_eq(memcmp(record.value.opaque.p_val, opaque, 4), 0);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path[2], 2);
+    ck_assert_uint_eq(record.value.opaque.len, 4);
+    ck_assert_int_eq(memcmp(record.value.opaque.p_val, opaque, 4), 0);
+
+    // A new base name.
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path_len, 2);
+    ck_assert_uint_eq(record.path[0], 1);
+    ck_assert_uint_eq(record.path[1], 2);
+    ck_assert(!record.value.boolean);
+
+    // An integer beyond int32_t is read as a float.
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path_len, 3);
+    ck_assert_uint_eq(record.path[2], 3);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_FLOAT);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+
+    // An empty pack.
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, (uint8_t *)"[]", 2), NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_json_malformed)
+{
+    static const char * malformed[] =
+    {
+        "[{\"n\":\"/1/2\"}]",                         // No value.
+        "[{\"n\":\"/1/2\",\"v\":1,\"vb\":true}]",     // Two values.
+        "[{\"n\":\"1/2\",\"v\":1}]",                  // No leading slash.
+        "[{\"n\":\"/1//2\",\"v\":1}]",                // Empty path segment.
+        "[{\"n\":\"/1/2/3/4/5\",\"v\":1}]",           // Path too long.
+        "[{\"n\":\"/65536\",\"v\":1}]",               // Identifier too large.
+        "[{\"n\":\"/1\",\"v\":1,\"x_\":1}]",          // Label that must be understood.
+        "[{\"n\":\"/1\",\"v\":1,\"x\":[1]}]",         // Value that is not a scalar.
+        "[{\"n\":\"/1\",\"vs\":\"\\ud800\"}]",        // Lone surrogate.
+        "[{\"n\":\"/1\",\"vd\":\"A\"}]",              // Truncated base64.
+        "[{\"n\":\"/1\",\"v\":1}",                    // Unterminated pack.
+        "[{\"n\":\"/1\",\"v\":1} {}]",                // Missing comma.
+        "[{\"n\":\"/1\",\"v\":1e}]",                  // Exponent without digits.
+    };
+
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+    char                 payload[128];
+
+    for (uint32_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+    {
+        uint32_t len = (uint32_t)strlen(malformed[i]);
+        uint32_t err_code;
+
+        memcpy(payload, malformed[i], len);
+
+        err_code = lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, (uint8_t *)payload, len);
+        if (err_code == NRF_SUCCESS)
+        {
+            err_code = lwm2m_senml_record_next(&reader, &record);
+        }
+        if (err_code == NRF_SUCCESS)
+        {
+            err_code = lwm2m_senml_record_next(&reader, &record);
+        }
+
+        ck_assert_uint_eq(err_code, (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE));
+    }
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_JSON, (uint8_t *)"{}", 2),
+                      (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_cbor_other_encoders)
+{
+    // Indefinite array and map, a text label that is skipped, a tag, a double, and a negative
+    // integer beyond int32_t.
+    uint8_t payload[] =
+    {
+        0x9F,
+        0xBF, 0x21, 0x62, '/', '5', 0x63, 'f', 'o', 'o', 0xC1, 0x01, 0x06, 0x1A, 0, 0, 0, 1,
+        0x02, 0xFB, 0x40, 0x09, 0x21, 0xFB, 0x54, 0x44, 0x2D, 0x18, 0xFF,
+        0xA2, 0x00, 0x62, '/', '7', 0x02, 0x3B, 0, 0, 0, 1, 0, 0, 0, 0,
+        0xFF
+    };
+
+    // A text label that must be understood.
+    uint8_t malformed[] = { 0x81, 0xA2, 0x00, 0x62, '/', '5', 0x63, 'x', 'x', '_', 0x01 };
+
+    lwm2m_senml_reader_t reader;
+    lwm2m_senml_record_t record;
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_CBOR, payload, sizeof(payload)), NRF_SUCCESS);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path_len, 1);
+    ck_assert_uint_eq(record.path[0], 5);
+    ck_assert(record.value.fp == 3.14159265f);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), NRF_SUCCESS);
+    ck_assert_uint_eq(record.path_len, 2);
+    ck_assert_uint_eq(record.path[1], 7);
+    ck_assert_uint_eq(record.type, LWM2M_SENML_TYPE_FLOAT);
+    ck_assert(record.value.fp == -4294967297.0f);
+
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_NOT_FOUND | IOT_LWM2M_ERR_BASE));
+
+    ck_assert_uint_eq(lwm2m_senml_reader_init(&reader, COAP_CT_APP_SENML_CBOR, malformed, sizeof(malformed)),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(lwm2m_senml_record_next(&reader, &record), (NRF_ERROR_INVALID_DATA | IOT_LWM2M_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_writer_init)
+{
+    lwm2m_senml_writer_t writer;
+    uint16_t             path[2] = { 3303, 0 };
+
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_JSON, m_buffer, sizeof(m_buffer), path, 2),
+                      (NRF_ERROR_NOT_SUPPORTED | IOT_LWM2M_ERR_BASE));
+    ck_assert_uint_eq(lwm2m_senml_writer_init(&writer, COAP_CT_APP_SENML_JSON, m_buffer, 1, path, 2),
+                      (NRF_ERROR_DATA_SIZE | IOT_LWM2M_ERR_BASE));
+}
+END_TEST
+
+
+static Suite * lwm2m_senml_suite(void)
+{
+    Suite * p_suite = suite_create("lwm2m_senml");
+    TCase * p_case  = tcase_create("lwm2m_senml");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_json_round_trip);
+    tcase_add_test(p_case, test_cbor_round_trip);
+    tcase_add_test(p_case, test_json_truncated_buffer);
+    tcase_add_test(p_case, test_cbor_truncated_buffer);
+    tcase_add_test(p_case, test_json_float_format);
+    tcase_add_test(p_case, test_json_float_random);
+    tcase_add_test(p_case, test_json_strings_and_multiple_instances);
+    tcase_add_test(p_case, test_cbor_encoding);
+    tcase_add_test(p_case, test_cbor_long_array);
+    tcase_add_test(p_case, test_json_other_encoders);
+    tcase_add_test(p_case, test_json_malformed);
+    tcase_add_test(p_case, test_cbor_other_encoders);
+    tcase_add_test(p_case, test_writer_init);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(lwm2m_senml_suite());
+}
@@ -0,0 +1,279 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the Memory Manager, built with MEM_MANAGER_ENABLE_STATISTICS and without
+ *        MEM_MANAGER_ENABLE_DIAGNOSTICS.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "sdk_config.h"
+#include "mem_manager.h"
+
+#define BLOCK_CAT_SMALL       2                                                                     /**< Index of the small block category. */
+#define BLOCK_CAT_MEDIUM      3                                                                     /**< Index of the medium block category. */
+#define BLOCK_CAT_XXLARGE     6                                                                     /**< Index of the xxlarge block category. */
+
+
+static void setup(void)
+{
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    nrf_mem_stats_reset();
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_reserve_rounds_up_to_block_size)
+{
+    uint8_t * p_buffer;
+    uint32_t  size = 100;
+
+    ck_assert_uint_eq(nrf_mem_reserve(&p_buffer, &size), NRF_SUCCESS);
+    ck_assert_ptr_ne(p_buffer, NULL);
+    ck_assert_uint_eq(size, MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+
+    size = MEMORY_MANAGER_SMALL_BLOCK_SIZE + 1;
+    ck_assert_uint_eq(nrf_mem_reserve(&p_buffer, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+
+    size = MEMORY_MANAGER_XXLARGE_BLOCK_SIZE + 1;
+    ck_assert_uint_ne(nrf_mem_reserve(&p_buffer, &size), NRF_SUCCESS);
+}
+END_TEST
+
+
+START_TEST(test_reserve_spills_into_larger_category)
+{
+    void * p_blocks[MEMORY_MANAGER_SMALL_BLOCK_COUNT];
+
+    for (uint32_t i = 0; i < MEMORY_MANAGER_SMALL_BLOCK_COUNT; i++)
+    {
+        p_blocks[i] = nrf_malloc(1);
+        ck_assert_ptr_ne(p_blocks[i], NULL);
+    }
+
+    nrf_mem_cat_stats_t stats;
+
+    // The small blocks are used up, the next small request gets a medium block.
+    uint8_t * p_buffer;
+    uint32_t  size = 1;
+
+    ck_assert_uint_eq(nrf_mem_reserve(&p_buffer, &size), NRF_SUCCESS);
+    ck_assert_uint_eq(size, MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_MEDIUM, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 1);
+
+    // A freed small block is used again first.
+    nrf_free(p_blocks[3]);
+    ck_assert_ptr_eq(nrf_malloc(1), p_blocks[3]);
+}
+END_TEST
+
+
+START_TEST(test_free_of_unknown_pointer_is_ignored)
+{
+    uint8_t * p_block = nrf_malloc(10);
+    uint8_t   not_managed;
+
+    ck_assert_ptr_ne(p_block, NULL);
+
+    // Neither a pointer inside a block nor a pointer outside the pool releases anything.
+    nrf_free(p_block + 1);
+    nrf_free(&not_managed);
+
+    nrf_mem_cat_stats_t stats;
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 1);
+
+    nrf_free(p_block);
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 0);
+}
+END_TEST
+
+
+START_TEST(test_realloc_in_place_and_moved)
+{
+    uint8_t * p_block = nrf_malloc(10);
+
+    ck_assert_ptr_ne(p_block, NULL);
+    memset(p_block, 0xA5, MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+
+    // Within the block: same pointer.
+    ck_assert_ptr_eq(nrf_realloc(p_block, MEMORY_MANAGER_SMALL_BLOCK_SIZE), p_block);
+
+    // Larger than the block: contents move to a larger block.
+    uint8_t * p_moved = nrf_realloc(p_block, MEMORY_MANAGER_MEDIUM_BLOCK_SIZE + 1);
+
+    ck_assert_ptr_ne(p_moved, NULL);
+    ck_assert_ptr_ne(p_moved, p_block);
+
+    for (uint32_t i = 0; i < MEMORY_MANAGER_SMALL_BLOCK_SIZE; i++)
+    {
+        ck_assert_uint_eq(p_moved[i], 0xA5);
+    }
+
+    nrf_mem_cat_stats_t stats;
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 0);
+
+    // Too large: the original block is kept.
+    ck_assert_ptr_eq(nrf_realloc(p_moved, MEMORY_MANAGER_XXLARGE_BLOCK_SIZE + 1), NULL);
+    ck_assert_uint_eq(p_moved[0], 0xA5);
+
+    // NULL behaves as nrf_malloc.
+    ck_assert_ptr_ne(nrf_realloc(NULL, 10), NULL);
+}
+END_TEST
+
+
+START_TEST(test_category_statistics)
+{
+    nrf_mem_cat_stats_t stats;
+
+    void * p_first  = nrf_malloc(100);
+    void * p_second = nrf_malloc(20);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.block_size, MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+    ck_assert_uint_eq(stats.block_count, MEMORY_MANAGER_SMALL_BLOCK_COUNT);
+    ck_assert_uint_eq(stats.in_use, 2);
+    ck_assert_uint_eq(stats.peak_in_use, 2);
+    ck_assert_uint_eq(stats.min_request, 20);
+    ck_assert_uint_eq(stats.max_request, 100);
+    ck_assert_uint_eq(stats.requested_bytes, 120);
+    ck_assert_uint_eq(stats.granted_bytes, 2 * MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+
+    nrf_free(p_first);
+    nrf_free(p_second);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 0);
+    ck_assert_uint_eq(stats.peak_in_use, 2);
+    ck_assert_uint_eq(stats.requested_bytes, 0);
+
+    // Failures are accounted to the category of the requested size.
+    for (uint32_t i = 0; i < MEMORY_MANAGER_XXLARGE_BLOCK_COUNT; i++)
+    {
+        ck_assert_ptr_ne(nrf_malloc(MEMORY_MANAGER_XXLARGE_BLOCK_SIZE), NULL);
+    }
+
+    ck_assert_ptr_eq(nrf_malloc(MEMORY_MANAGER_XXLARGE_BLOCK_SIZE), NULL);
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_XXLARGE, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.failed_count, 1);
+
+    nrf_mem_stats_reset();
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_XXLARGE, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.failed_count, 0);
+    ck_assert_uint_eq(stats.peak_in_use, MEMORY_MANAGER_XXLARGE_BLOCK_COUNT);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(NRF_MEM_BLOCK_CAT_COUNT, &stats),
+                      (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_init_clears_statistics)
+{
+    nrf_mem_cat_stats_t stats;
+
+    ck_assert_ptr_ne(nrf_malloc(100), NULL);
+
+    // Initialization alone, without nrf_mem_stats_reset, starts the statistics over.
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 0);
+    ck_assert_uint_eq(stats.peak_in_use, 0);
+    ck_assert_uint_eq(stats.min_request, UINT32_MAX);
+    ck_assert_uint_eq(stats.max_request, 0);
+    ck_assert_uint_eq(stats.requested_bytes, 0);
+
+    ck_assert_ptr_ne(nrf_malloc(90), NULL);
+
+    ck_assert_uint_eq(nrf_mem_cat_stats_get(BLOCK_CAT_SMALL, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.min_request, 90);
+    ck_assert_uint_eq(stats.max_request, 90);
+}
+END_TEST
+
+
+START_TEST(test_tag_statistics)
+{
+    nrf_mem_tag_stats_t stats;
+
+    void * p_coap = nrf_malloc_tagged(100, NRF_MEM_TAG_COAP);
+    void * p_mqtt = nrf_malloc_tagged(200, NRF_MEM_TAG_MQTT);
+
+    ck_assert_ptr_ne(p_coap, NULL);
+    ck_assert_ptr_ne(p_mqtt, NULL);
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(NRF_MEM_TAG_COAP, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 1);
+    ck_assert_uint_eq(stats.requested_bytes, 100);
+    ck_assert_uint_eq(stats.granted_bytes, MEMORY_MANAGER_SMALL_BLOCK_SIZE);
+    ck_assert_uint_eq(stats.reserve_count, 1);
+
+    // A block moved by nrf_realloc keeps its tag.
+    p_coap = nrf_realloc(p_coap, MEMORY_MANAGER_SMALL_BLOCK_SIZE + 1);
+    ck_assert_ptr_ne(p_coap, NULL);
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(NRF_MEM_TAG_COAP, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 1);
+    ck_assert_uint_eq(stats.granted_bytes, MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+    ck_assert_uint_eq(stats.peak_granted_bytes,
+                      MEMORY_MANAGER_SMALL_BLOCK_SIZE + MEMORY_MANAGER_MEDIUM_BLOCK_SIZE);
+
+    nrf_free(p_coap);
+    nrf_free(p_mqtt);
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(NRF_MEM_TAG_MQTT, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.in_use, 0);
+    ck_assert_uint_eq(stats.peak_in_use, 1);
+    ck_assert_uint_eq(stats.granted_bytes, 0);
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(0xFF, &stats),
+                      (NRF_ERROR_INVALID_PARAM | MEMORY_MANAGER_ERR_BASE));
+}
+END_TEST
+
+
+static Suite * mem_manager_suite(void)
+{
+    Suite * p_suite = suite_create("mem_manager");
+    TCase * p_case  = tcase_create("mem_manager");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_reserve_rounds_up_to_block_size);
+    tcase_add_test(p_case, test_reserve_spills_into_larger_category);
+    tcase_add_test(p_case, test_free_of_unknown_pointer_is_ignored);
+    tcase_add_test(p_case, test_realloc_in_place_and_moved);
+    tcase_add_test(p_case, test_category_statistics);
+    tcase_add_test(p_case, test_init_clears_statistics);
+    tcase_add_test(p_case, test_tag_statistics);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(mem_manager_suite());
+}
@@ -0,0 +1,345 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the streaming receive decoder of the MQTT client (mqtt_rx_decode).
+ *
+ * @details Streams of packets of random type and length are fed to the decoder in segments of
+ *          random size, down to a single byte, as TCP hands them over. The packets handed to
+ *          mqtt_handle_rx_data, stubbed here, are checked byte for byte against the packets in the
+ *          stream. Packets too large for the Memory Manager must be skipped without losing the
+ *          framing of the stream, a malformed remaining length must be reported, and random
+ *          garbage must neither crash the decoder nor leak reassembly buffers.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "mqtt_internal.h"
+
+#define STREAM_SIZE           (64 * 1024)                                                           /**< Size of the largest stream of packets. */
+#define MAX_PACKETS           64                                                                    /**< Largest number of packets in a stream. */
+#define MAX_BODY_SIZE         1000                                                                  /**< Largest remaining length of a packet that can be reassembled. */
+#define OVERSIZE_BODY_SIZE    5000                                                                  /**< Remaining length of a packet larger than any Memory Manager block. */
+#define ROUNDS                2000                                                                  /**< Number of random streams. */
+
+/**@brief Packet in a stream, by its position. */
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} packet_t;
+
+static mqtt_client_t m_client;
+static uint8_t       m_stream[STREAM_SIZE];                                                         /**< Packets fed to the decoder. */
+static uint32_t      m_stream_size;
+static packet_t      m_packets[MAX_PACKETS];                                                        /**< Packets in the stream, in order. */
+static uint32_t      m_packet_count;
+static uint8_t       m_received[STREAM_SIZE];                                                       /**< Packets handed to mqtt_handle_rx_data, in order. */
+static uint32_t      m_received_size;
+static uint32_t      m_received_count;
+static uint32_t      m_disconnect_after;                                                            /**< Number of packets after which the handler disconnects the client, zero for never. */
+static uint32_t      m_seed;                                                                        /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+uint32_t mqtt_handle_rx_data(mqtt_client_t * p_client, uint8_t * p_data, uint32_t datalen)
+{
+    ck_assert_ptr_eq(p_client, &m_client);
+    ck_assert_uint_le(m_received_size + datalen, STREAM_SIZE);
+
+    memcpy(&m_received[m_received_size], p_data, datalen);
+    m_received_size += datalen;
+    m_received_count++;
+
+    if (m_received_count == m_disconnect_after)
+    {
+        p_client->state = MQTT_STATE_IDLE;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Append a packet of the given remaining length, with random type and contents. */
+static void packet_add(uint32_t body_size)
+{
+    uint32_t offset = m_stream_size;
+    uint32_t length = body_size;
+
+    m_stream[m_stream_size++] = (uint8_t)(((rand_get() % 14) + 1) << 4);
+
+    do
+    {
+        uint8_t encoded = (uint8_t)(length % 0x80);
+
+        length /= 0x80;
+
+        if (length != 0)
+        {
+            encoded |= 0x80;
+        }
+
+        m_stream[m_stream_size++] = encoded;
+    } while (length != 0);
+
+    for (uint32_t i = 0; i < body_size; i++)
+    {
+        m_stream[m_stream_size++] = (uint8_t)rand_get();
+    }
+
+    m_packets[m_packet_count].offset = offset;
+    m_packets[m_packet_count].length = m_stream_size - offset;
+    m_packet_count++;
+}
+
+
+/**@brief Feed the stream to the decoder in segments of random size. */
+static void stream_feed(void)
+{
+    uint32_t offset = 0;
+
+    while (offset < m_stream_size)
+    {
+        uint32_t size = ((rand_get() % 3) == 0) ? (1 + (rand_get() % 4)) : (1 + (rand_get() % 600));
+
+        size = MIN(size, m_stream_size - offset);
+
+        ck_assert_uint_eq(mqtt_rx_decode(&m_client, &m_stream[offset], size), NRF_SUCCESS);
+        offset += size;
+    }
+}
+
+
+static void decoder_idle_check(void)
+{
+    ck_assert_ptr_eq(m_client.rx.p_buffer, NULL);
+    ck_assert_uint_eq(m_client.rx.header_len, 0);
+    ck_assert_uint_eq(m_client.rx.discard, 0);
+}
+
+
+static void client_reset(void)
+{
+    memset(&m_client, 0, sizeof(m_client));
+    m_client.state = MQTT_STATE_CONNECTED;
+
+    m_stream_size      = 0;
+    m_packet_count     = 0;
+    m_received_size    = 0;
+    m_received_count   = 0;
+    m_disconnect_after = 0;
+}
+
+
+static void setup(void)
+{
+    m_seed = 1;
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    client_reset();
+}
+
+
+static void teardown(void)
+{
+    nrf_mem_cat_stats_t stats;
+
+    // Every reassembly buffer was returned to the Memory Manager.
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+
+
+START_TEST(test_random_segments)
+{
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        client_reset();
+
+        // Mostly short packets, as acknowledgements and small publishes are, some that span
+        // segments.
+        uint32_t count    = 1 + (rand_get() % 20);
+        uint32_t max_body = ((round % 3) == 0) ? MAX_BODY_SIZE : 200;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            packet_add(rand_get() % (max_body + 1));
+        }
+
+        stream_feed();
+
+        ck_assert_uint_eq(m_received_count, m_packet_count);
+        ck_assert_uint_eq(m_received_size, m_stream_size);
+        ck_assert_int_eq(memcmp(m_received, m_stream, m_stream_size), 0);
+        ck_assert_uint_eq(m_client.stats.rx_packets, m_packet_count);
+        ck_assert_uint_eq(m_client.stats.rx_bytes, m_stream_size);
+        ck_assert_uint_eq(m_client.stats.rx_dropped, 0);
+        decoder_idle_check();
+    }
+}
+END_TEST
+
+
+START_TEST(test_in_place_without_copy)
+{
+    // Packets held entirely in one segment are decoded in place.
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        packet_add(i * 10);
+    }
+
+    ck_assert_uint_eq(mqtt_rx_decode(&m_client, m_stream, m_stream_size), NRF_SUCCESS);
+
+    ck_assert_uint_eq(m_received_count, 10);
+    ck_assert_uint_eq(m_client.stats.rx_reassembled, 0);
+    ck_assert_int_eq(memcmp(m_received, m_stream, m_stream_size), 0);
+    decoder_idle_check();
+}
+END_TEST
+
+
+START_TEST(test_oversize_packet_dropped)
+{
+    // A packet that no Memory Manager block can hold is skipped, the packets around it are kept.
+    packet_add(20);
+    packet_add(OVERSIZE_BODY_SIZE);
+    packet_add(30);
+
+    const packet_t first = m_packets[0];
+    const packet_t last  = m_packets[2];
+
+    stream_feed();
+
+    ck_assert_uint_eq(m_received_count, 2);
+    ck_assert_uint_eq(m_received_size, first.length + last.length);
+    ck_assert_int_eq(memcmp(m_received, &m_stream[first.offset], first.length), 0);
+    ck_assert_int_eq(memcmp(&m_received[first.length], &m_stream[last.offset], last.length), 0);
+    ck_assert_uint_eq(m_client.stats.rx_dropped, 1);
+    decoder_idle_check();
+}
+END_TEST
+
+
+START_TEST(test_malformed_length)
+{
+    // Remaining length with a continuation bit on all four bytes, split within the fixed header.
+    static const uint8_t malformed[] = { 0x30, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    uint8_t              data[sizeof(malformed)];
+
+    memcpy(data, malformed, sizeof(malformed));
+
+    ck_assert_uint_eq(mqtt_rx_decode(&m_client, data, 3), NRF_SUCCESS);
+    ck_assert_uint_eq(mqtt_rx_decode(&m_client, &data[3], 3),
+                      (NRF_ERROR_INVALID_DATA | IOT_MQTT_ERR_BASE));
+    ck_assert_uint_eq(m_client.stats.rx_dropped, 1);
+    decoder_idle_check();
+
+    // The same in one segment.
+    ck_assert_uint_eq(mqtt_rx_decode(&m_client, data, sizeof(data)),
+                      (NRF_ERROR_INVALID_DATA | IOT_MQTT_ERR_BASE));
+    ck_assert_uint_eq(m_received_count, 0);
+    decoder_idle_check();
+}
+END_TEST
+
+
+START_TEST(test_disconnect_in_handler)
+{
+    // Decoding stops once the client is disconnected while handling a packet.
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        packet_add(10);
+    }
+
+    m_disconnect_after = 2;
+
+    ck_assert_uint_eq(mqtt_rx_decode(&m_client, m_stream, m_stream_size), NRF_SUCCESS);
+    ck_assert_uint_eq(m_received_count, 2);
+}
+END_TEST
+
+
+START_TEST(test_random_garbage)
+{
+    for (uint32_t round = 0; round < 20 * ROUNDS; round++)
+    {
+        client_reset();
+
+        m_stream_size = rand_get() % 300;
+
+        for (uint32_t i = 0; i < m_stream_size; i++)
+        {
+            m_stream[i] = (uint8_t)rand_get();
+        }
+
+        uint32_t offset = 0;
+
+        while (offset < m_stream_size)
+        {
+            uint32_t size = MIN(1 + (rand_get() % 50), m_stream_size - offset);
+
+            if (mqtt_rx_decode(&m_client, &m_stream[offset], size) != NRF_SUCCESS)
+            {
+                decoder_idle_check();
+                break;
+            }
+
+            offset += size;
+        }
+
+        // The connection is closed with a packet still in reassembly.
+        mqtt_rx_decoder_reset(&m_client);
+        decoder_idle_check();
+    }
+}
+END_TEST
+
+
+static Suite * mqtt_decoder_suite(void)
+{
+    Suite * p_suite = suite_create("mqtt_decoder");
+    TCase * p_case  = tcase_create("mqtt_decoder");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_random_segments);
+    tcase_add_test(p_case, test_in_place_without_copy);
+    tcase_add_test(p_case, test_oversize_packet_dropped);
+    tcase_add_test(p_case, test_malformed_length);
+    tcase_add_test(p_case, test_disconnect_in_handler);
+    tcase_add_test(p_case, test_random_garbage);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(mqtt_decoder_suite());
+}
@@ -0,0 +1,628 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the transmit path of the MQTT client (mqtt_client_tcp_write,
+ *        mqtt_client_tcp_flush) and of the tracking of publish messages in flight.
+ *
+ * @details The lwIP functions used by the client are stubbed: tcp_write appends to a stream the
+ *          data handed to it, within the room in the send buffer set by the test through the
+ *          snd_buf field read by tcp_sndbuf. Packets are written directly while the transmit ring
+ *          is empty, the remainder is queued in the ring and flushed as the send buffer is acked.
+ *          The stream must always be the packets accepted, in order, whole and each once.
+ *          Acknowledgements are fed to the receive path in any order and must each complete the
+ *          message they belong to.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "mqtt_internal.h"
+#include "lwip/tcp.h"
+
+#define STREAM_SIZE           (256 * 1024)                                                          /**< Size of the largest stream of packets. */
+#define SNDBUF_SIZE           2048                                                                  /**< Size of the TCP send buffer when it is empty. */
+#define ROUNDS                5000                                                                  /**< Number of random writes and acks. */
+#define WINDOW_SIZE           200                                                                   /**< Size of the TCP send buffer in the ring test. */
+
+static mqtt_client_t     m_client;
+static struct tcp_pcb    m_pcb;
+static uint8_t           m_stream[STREAM_SIZE];                                                     /**< Data handed to tcp_write, in order. */
+static uint32_t          m_stream_size;
+static uint32_t          m_write_count;                                                             /**< Number of calls to tcp_write. */
+static err_t             m_write_result;                                                            /**< Result of the next call to tcp_write. */
+static tcp_connected_fn  m_connected_cb;
+static tcp_sent_fn       m_sent_cb;
+static void            * mp_arg;                                                                    /**< Argument of the callbacks, the client. */
+static mqtt_evt_t        m_evt;                                                                     /**< Last event notified to the application. */
+static uint32_t          m_evt_count;
+static uint32_t          m_seed;                                                                    /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+struct tcp_pcb * tcp_new_ip6(void)
+{
+    return &m_pcb;
+}
+
+
+err_t tcp_connect(struct tcp_pcb * pcb, const ip_addr_t * ipaddr, u16_t port, tcp_connected_fn connected)
+{
+    m_connected_cb = connected;
+
+    return ERR_OK;
+}
+
+
+err_t tcp_write(struct tcp_pcb * pcb, const void * dataptr, u16_t len, u8_t apiflags)
+{
+    err_t result = m_write_result;
+
+    ck_assert_ptr_eq(pcb, &m_pcb);
+    ck_assert_uint_ne(len, 0);
+    ck_assert_uint_le(len, pcb->snd_buf);
+    ck_assert_uint_le(m_stream_size + len, STREAM_SIZE);
+
+    m_write_count++;
+    m_write_result = ERR_OK;
+
+    if (result == ERR_OK)
+    {
+        memcpy(&m_stream[m_stream_size], dataptr, len);
+        m_stream_size += len;
+        pcb->snd_buf  -= len;
+    }
+
+    return result;
+}
+
+
+err_t tcp_output(struct tcp_pcb * pcb)
+{
+    return ERR_OK;
+}
+
+
+void tcp_arg(struct tcp_pcb * pcb, void * arg)
+{
+    mp_arg = arg;
+}
+
+
+void tcp_sent(struct tcp_pcb * pcb, tcp_sent_fn sent)
+{
+    m_sent_cb = sent;
+}
+
+
+void tcp_recv(struct tcp_pcb * pcb, tcp_recv_fn recv)
+{
+}
+
+
+void tcp_err(struct tcp_pcb * pcb, tcp_err_fn err)
+{
+}
+
+
+void tcp_poll(struct tcp_pcb * pcb, tcp_poll_fn poll, u8_t interval)
+{
+}
+
+
+void tcp_accept(struct tcp_pcb * pcb, tcp_accept_fn accept)
+{
+}
+
+
+void tcp_recved(struct tcp_pcb * pcb, u16_t len)
+{
+}
+
+
+void tcp_abort(struct tcp_pcb * pcb)
+{
+}
+
+
+err_t tcp_close(struct tcp_pcb * pcb)
+{
+    return ERR_OK;
+}
+
+
+u8_t pbuf_free(struct pbuf * p)
+{
+    return 0;
+}
+
+
+uint32_t iot_timer_wall_clock_get(iot_timer_time_in_ms_t * p_elapsed_time)
+{
+    *p_elapsed_time = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t iot_timer_wall_clock_delta_get(iot_timer_time_in_ms_t * p_past_time,
+                                        iot_timer_time_in_ms_t * p_delta_time)
+{
+    *p_delta_time = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_tls_init(void)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_tls_alloc(nrf_tls_instance_t * p_instance, nrf_tls_options_t const * p_options)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t nrf_tls_free(nrf_tls_instance_t const * p_instance)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_tls_write(nrf_tls_instance_t const * p_instance,
+                       uint8_t            const * p_data,
+                       uint32_t                 * p_datalen)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t nrf_tls_read(nrf_tls_instance_t const * p_instance,
+                      uint8_t                  * p_data,
+                      uint32_t                 * p_datalen)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+uint32_t nrf_tls_input(nrf_tls_instance_t const * p_instance,
+                       uint8_t            const * p_data,
+                       uint32_t                   datalen)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+void nrf_tls_process(void)
+{
+}
+
+
+static void evt_handler(mqtt_client_t * const p_client, const mqtt_evt_t * p_evt)
+{
+    m_evt = *p_evt;
+    m_evt_count++;
+}
+
+
+/**@brief The TCP stack acknowledges data, making room in the send buffer. */
+static void sndbuf_ack(uint32_t len)
+{
+    m_pcb.snd_buf += len;
+    ck_assert_int_eq(m_sent_cb(mp_arg, &m_pcb, (u16_t)len), ERR_OK);
+}
+
+
+/**@brief Build a packet of the given length with random contents. */
+static void packet_build(uint8_t * p_packet, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        p_packet[i] = (uint8_t)rand_get();
+    }
+}
+
+
+/**@brief Feed a packet to the receive path. */
+static void packet_receive(uint8_t * p_packet, uint32_t len)
+{
+    ck_assert_uint_eq(mqtt_client_tcp_read(&m_client, p_packet, len), NRF_SUCCESS);
+}
+
+
+/**@brief Feed an acknowledgement to the receive path, and check the event it notifies, if any. */
+static void ack_receive(uint8_t pkt_type, uint16_t message_id, bool expected, mqtt_evt_id_t evt_id)
+{
+    uint8_t  packet[]  = { pkt_type, 0x02, (uint8_t)(message_id >> 8), (uint8_t)message_id };
+    uint32_t evt_count = m_evt_count;
+
+    packet_receive(packet, sizeof(packet));
+
+    if (expected)
+    {
+        ck_assert_uint_eq(m_evt_count, evt_count + 1);
+        ck_assert_int_eq(m_evt.id, evt_id);
+        ck_assert_uint_eq(m_evt.result, NRF_SUCCESS);
+        ck_assert_uint_eq(m_evt.param.ack.message_id, message_id);
+    }
+    else
+    {
+        ck_assert_uint_eq(m_evt_count, evt_count);
+    }
+}
+
+
+static uint32_t memory_in_use_get(void)
+{
+    nrf_mem_tag_stats_t stats;
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(NRF_MEM_TAG_MQTT, &stats), NRF_SUCCESS);
+
+    return stats.in_use;
+}
+
+
+static void setup(void)
+{
+    static const char client_id[] = "test";
+    uint8_t           connack[]   = { MQTT_PKT_TYPE_CONNACK, 0x02, 0x00, 0x00 };
+
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(mqtt_init(), NRF_SUCCESS);
+
+    memset(&m_pcb, 0, sizeof(m_pcb));
+    memset(&m_client, 0, sizeof(m_client));
+    mqtt_client_init(&m_client);
+
+    m_client.client_id.p_utf_str  = (uint8_t *)client_id;
+    m_client.client_id.utf_strlen = sizeof(client_id) - 1;
+    m_client.evt_cb               = evt_handler;
+    m_client.broker_port          = 1883;
+    m_client.transport_type       = MQTT_TRANSPORT_NON_SECURE;
+
+    m_pcb.snd_buf  = SNDBUF_SIZE;
+    m_stream_size  = 0;
+    m_write_count  = 0;
+    m_write_result = ERR_OK;
+    m_evt_count    = 0;
+    m_seed         = 0x2F6E2B1;
+
+    // Connect, then drop the CONNECT packet from the stream.
+    ck_assert_uint_eq(mqtt_connect(&m_client), NRF_SUCCESS);
+    ck_assert_ptr_eq(mp_arg, &m_client);
+    ck_assert_int_eq(m_connected_cb(mp_arg, &m_pcb, ERR_OK), ERR_OK);
+    ck_assert_uint_ne(m_stream_size, 0);
+
+    packet_receive(connack, sizeof(connack));
+    ck_assert_int_eq(m_evt.id, MQTT_EVT_CONNECT);
+    ck_assert_uint_eq(m_evt.result, NRF_SUCCESS);
+
+    m_pcb.snd_buf = SNDBUF_SIZE;
+    m_stream_size = 0;
+    m_write_count = 0;
+    memset(&m_client.stats, 0, sizeof(m_client.stats));
+}
+
+
+static void teardown(void)
+{
+    ck_assert_uint_eq(mqtt_abort(&m_client), NRF_SUCCESS);
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+}
+
+
+START_TEST(test_direct_write)
+{
+    uint8_t             packet[MQTT_MAX_PACKET_LENGTH];
+    mqtt_client_stats_t stats;
+
+    packet_build(packet, sizeof(packet));
+
+    // With the ring empty and room in the send buffer, nothing is copied to the ring.
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packet, sizeof(packet)), NRF_SUCCESS);
+    ck_assert_uint_eq(m_write_count, 1);
+    ck_assert_uint_eq(m_stream_size, sizeof(packet));
+    ck_assert_int_eq(memcmp(m_stream, packet, sizeof(packet)), 0);
+    ck_assert_uint_eq(m_client.tx_ring_len, 0);
+    ck_assert(!MQTT_VERIFY_STATE(&m_client, MQTT_STATE_PENDING_WRITE));
+
+    ck_assert_uint_eq(mqtt_client_stats_get(&m_client, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.tx_packets, 1);
+    ck_assert_uint_eq(stats.tx_bytes, sizeof(packet));
+    ck_assert_uint_eq(stats.tx_ring_peak, 0);
+}
+END_TEST
+
+
+START_TEST(test_partial_write_flush)
+{
+    uint8_t             packet[100];
+    mqtt_client_stats_t stats;
+
+    packet_build(packet, sizeof(packet));
+
+    // The send buffer takes 30 bytes, the ring the remaining 70.
+    m_pcb.snd_buf = 30;
+
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packet, sizeof(packet)), NRF_SUCCESS);
+    ck_assert_uint_eq(m_stream_size, 30);
+    ck_assert_uint_eq(m_client.tx_ring_len, 70);
+    ck_assert(MQTT_VERIFY_STATE(&m_client, MQTT_STATE_PENDING_WRITE));
+
+    // Acks of 20 bytes, then 30, move the rest of the packet out of the ring.
+    sndbuf_ack(20);
+    ck_assert_uint_eq(m_stream_size, 50);
+    ck_assert_uint_eq(m_client.tx_ring_len, 50);
+    ck_assert(MQTT_VERIFY_STATE(&m_client, MQTT_STATE_PENDING_WRITE));
+
+    sndbuf_ack(SNDBUF_SIZE - 20);
+    ck_assert_uint_eq(m_stream_size, sizeof(packet));
+    ck_assert_int_eq(memcmp(m_stream, packet, sizeof(packet)), 0);
+    ck_assert_uint_eq(m_client.tx_ring_len, 0);
+    ck_assert(!MQTT_VERIFY_STATE(&m_client, MQTT_STATE_PENDING_WRITE));
+
+    ck_assert_uint_eq(mqtt_client_stats_get(&m_client, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.tx_packets, 1);
+    ck_assert_uint_eq(stats.tx_bytes, sizeof(packet));
+    ck_assert_uint_eq(stats.tx_acked_bytes, SNDBUF_SIZE);
+    ck_assert_uint_eq(stats.tx_ring_peak, 70);
+}
+END_TEST
+
+
+START_TEST(test_write_refused_queued)
+{
+    uint8_t packet[40];
+
+    packet_build(packet, sizeof(packet));
+
+    // A write refused by TCP puts the whole packet in the ring.
+    m_write_result = ERR_MEM;
+
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packet, sizeof(packet)), NRF_SUCCESS);
+    ck_assert_uint_eq(m_stream_size, 0);
+    ck_assert_uint_eq(m_client.tx_ring_len, sizeof(packet));
+
+    sndbuf_ack(0);
+    ck_assert_uint_eq(m_stream_size, sizeof(packet));
+    ck_assert_int_eq(memcmp(m_stream, packet, sizeof(packet)), 0);
+    ck_assert_uint_eq(m_client.tx_ring_len, 0);
+}
+END_TEST
+
+
+START_TEST(test_ring_full)
+{
+    uint8_t             packets[MQTT_TX_RING_SIZE / MQTT_MAX_PACKET_LENGTH + 1][MQTT_MAX_PACKET_LENGTH];
+    uint32_t            count = sizeof(packets) / sizeof(packets[0]);
+    mqtt_client_stats_t stats;
+
+    packet_build(packets[0], sizeof(packets));
+
+    // Packets fill the ring while the send buffer is full, the last one is refused whole.
+    m_pcb.snd_buf = 0;
+
+    for (uint32_t i = 0; i < count - 1; i++)
+    {
+        ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packets[i], MQTT_MAX_PACKET_LENGTH),
+                          NRF_SUCCESS);
+    }
+
+    ck_assert_uint_eq(m_client.tx_ring_len, (count - 1) * MQTT_MAX_PACKET_LENGTH);
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packets[count - 1], MQTT_MAX_PACKET_LENGTH),
+                      (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE));
+    ck_assert_uint_eq(m_client.tx_ring_len, (count - 1) * MQTT_MAX_PACKET_LENGTH);
+    ck_assert_uint_eq(m_write_count, 0);
+
+    // Room in the send buffer does not let a packet overtake the ring.
+    m_pcb.snd_buf = SNDBUF_SIZE;
+
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packets[count - 1], MQTT_MAX_PACKET_LENGTH),
+                      (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE));
+    ck_assert_uint_eq(m_write_count, 0);
+
+    sndbuf_ack(0);
+    ck_assert_uint_eq(mqtt_client_tcp_write(&m_client, packets[count - 1], MQTT_MAX_PACKET_LENGTH),
+                      NRF_SUCCESS);
+    ck_assert_uint_eq(m_stream_size, sizeof(packets));
+    ck_assert_int_eq(memcmp(m_stream, packets, sizeof(packets)), 0);
+
+    ck_assert_uint_eq(mqtt_client_stats_get(&m_client, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.tx_packets, count);
+    ck_assert_uint_eq(stats.tx_ring_full, 2);
+    ck_assert_uint_eq(stats.tx_ring_peak, (count - 1) * MQTT_MAX_PACKET_LENGTH);
+}
+END_TEST
+
+
+START_TEST(test_ring_wrap)
+{
+    static uint8_t expected[STREAM_SIZE];
+    uint32_t       expected_size = 0;
+    uint32_t       wraps         = 0;
+    uint32_t       refused       = 0;
+    uint32_t       acked         = 0;
+
+    // A send buffer smaller than a few packets keeps the ring in use.
+    m_pcb.snd_buf = WINDOW_SIZE;
+
+    for (uint32_t round = 0; (round < ROUNDS) && (expected_size + MQTT_MAX_PACKET_LENGTH <= STREAM_SIZE); round++)
+    {
+        uint16_t read = m_client.tx_ring_read;
+
+        if ((rand_get() % 2) == 0)
+        {
+            uint8_t  packet[MQTT_MAX_PACKET_LENGTH];
+            uint32_t len     = 2 + (rand_get() % (MQTT_MAX_PACKET_LENGTH - 1));
+            uint16_t ring    = m_client.tx_ring_len;
+            uint32_t room    = m_pcb.snd_buf;
+            uint32_t written = m_stream_size;
+
+            packet_build(packet, len);
+
+            uint32_t err_code = mqtt_client_tcp_write(&m_client, packet, len);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                memcpy(&expected[expected_size], packet, len);
+                expected_size += len;
+            }
+            else
+            {
+                // Only refused when it does not fit behind the data already queued.
+                ck_assert_uint_eq(err_code, (NRF_ERROR_BUSY | IOT_MQTT_ERR_BASE));
+                ck_assert_uint_ne(ring, 0);
+                ck_assert_uint_gt(len, MQTT_TX_RING_SIZE - ring);
+                ck_assert_uint_eq(m_client.tx_ring_len, ring);
+                ck_assert_uint_eq(m_stream_size, written);
+                ck_assert_uint_eq(m_pcb.snd_buf, room);
+                refused++;
+            }
+        }
+        else
+        {
+            // The peer only acknowledges what TCP has taken.
+            uint32_t len = rand_get() % (MQTT_MAX_PACKET_LENGTH * 2);
+
+            len = MIN(len, m_stream_size - acked);
+
+            acked += len;
+            sndbuf_ack(len);
+        }
+
+        if ((m_client.tx_ring_read < read) && (m_client.tx_ring_len != 0))
+        {
+            wraps++;
+        }
+
+        // What TCP took is always the start of what was accepted.
+        ck_assert_uint_eq(m_stream_size + m_client.tx_ring_len, expected_size);
+        ck_assert_int_eq(memcmp(m_stream, expected, m_stream_size), 0);
+    }
+
+    while (m_client.tx_ring_len != 0)
+    {
+        uint32_t len = m_stream_size - acked;
+
+        acked += len;
+        sndbuf_ack(len);
+    }
+
+    ck_assert_uint_eq(m_stream_size, expected_size);
+    ck_assert_int_eq(memcmp(m_stream, expected, expected_size), 0);
+
+    ck_assert_uint_gt(wraps, 10);
+    ck_assert_uint_gt(refused, 10);
+}
+END_TEST
+
+
+START_TEST(test_inflight_out_of_order)
+{
+    mqtt_client_stats_t stats;
+
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 1, MQTT_QoS_1_ATLEAST_ONCE, 0), NRF_SUCCESS);
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 2, MQTT_QoS_2_EACTLY_ONCE, 0), NRF_SUCCESS);
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 3, MQTT_QoS_1_ATLEAST_ONCE, 0), NRF_SUCCESS);
+
+    // An id in use is refused, unless the message is a retransmission.
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 2, MQTT_QoS_2_EACTLY_ONCE, 0),
+                      (NRF_ERROR_INVALID_PARAM | IOT_MQTT_ERR_BASE));
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 2, MQTT_QoS_2_EACTLY_ONCE, 1), NRF_SUCCESS);
+
+    // Acknowledgements of the wrong kind, or of no message in flight, notify nothing.
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 2, false, MQTT_EVT_PUBLISH_ACK);
+    ack_receive(MQTT_PKT_TYPE_PUBCOMP, 2, false, MQTT_EVT_PUBLISH_COMP);
+    ack_receive(MQTT_PKT_TYPE_PUBREC, 1, false, MQTT_EVT_PUBLISH_REC);
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 4, false, MQTT_EVT_PUBLISH_ACK);
+
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 3, true, MQTT_EVT_PUBLISH_ACK);
+    ack_receive(MQTT_PKT_TYPE_PUBREC, 2, true, MQTT_EVT_PUBLISH_REC);
+    ack_receive(MQTT_PKT_TYPE_PUBREC, 2, false, MQTT_EVT_PUBLISH_REC);
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 1, true, MQTT_EVT_PUBLISH_ACK);
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 3, false, MQTT_EVT_PUBLISH_ACK);
+    ack_receive(MQTT_PKT_TYPE_PUBCOMP, 2, true, MQTT_EVT_PUBLISH_COMP);
+    ack_receive(MQTT_PKT_TYPE_PUBCOMP, 2, false, MQTT_EVT_PUBLISH_COMP);
+
+    ck_assert_uint_eq(mqtt_client_stats_get(&m_client, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.publish_completed, 3);
+    ck_assert_uint_eq(stats.inflight_peak, 3);
+
+    for (uint32_t index = 0; index < MQTT_MAX_INFLIGHT; index++)
+    {
+        ck_assert_uint_eq(m_client.inflight[index].state, MQTT_INFLIGHT_FREE);
+    }
+}
+END_TEST
+
+
+START_TEST(test_inflight_full)
+{
+    mqtt_client_stats_t stats;
+
+    for (uint16_t id = 1; id <= MQTT_MAX_INFLIGHT; id++)
+    {
+        ck_assert_uint_eq(mqtt_inflight_add(&m_client, id, MQTT_QoS_1_ATLEAST_ONCE, 0), NRF_SUCCESS);
+    }
+
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 100, MQTT_QoS_1_ATLEAST_ONCE, 0),
+                      (NRF_ERROR_NO_MEM | IOT_MQTT_ERR_BASE));
+
+    // Any acknowledged entry is reused.
+    ack_receive(MQTT_PKT_TYPE_PUBACK, 2, true, MQTT_EVT_PUBLISH_ACK);
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 100, MQTT_QoS_1_ATLEAST_ONCE, 0), NRF_SUCCESS);
+    ck_assert_uint_eq(mqtt_inflight_add(&m_client, 101, MQTT_QoS_1_ATLEAST_ONCE, 0),
+                      (NRF_ERROR_NO_MEM | IOT_MQTT_ERR_BASE));
+
+    ck_assert_uint_eq(mqtt_client_stats_get(&m_client, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.inflight_peak, MQTT_MAX_INFLIGHT);
+}
+END_TEST
+
+
+static Suite * mqtt_transport_suite(void)
+{
+    Suite * p_suite = suite_create("mqtt_transport");
+    TCase * p_case  = tcase_create("mqtt_transport");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_direct_write);
+    tcase_add_test(p_case, test_partial_write_flush);
+    tcase_add_test(p_case, test_write_refused_queued);
+    tcase_add_test(p_case, test_ring_full);
+    tcase_add_test(p_case, test_ring_wrap);
+    tcase_add_test(p_case, test_inflight_out_of_order);
+    tcase_add_test(p_case, test_inflight_full);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(mqtt_transport_suite());
+}
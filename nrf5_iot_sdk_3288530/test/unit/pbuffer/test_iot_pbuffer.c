@@ -0,0 +1,358 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the packet buffer pool of the IPv6 stack (iot_pbuffer).
+ *
+ * @details Packet buffers are allocated until the pool is exhausted, freed and allocated again
+ *          from the free list, and the pool statistics are checked after each step. Reallocation
+ *          must keep the headroom and payload, both when the memory block is large enough and when
+ *          the data has to be moved to a larger block. Every test must leave all Memory Manager
+ *          blocks reserved for packet buffers free.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "iot_errors.h"
+#include "mem_manager.h"
+#include "iot_pbuffer.h"
+
+#define UDP6_HEADROOM         48                                                                    /**< Headroom of a UDP packet buffer, for the IPv6 and UDP headers. */
+#define OVERSIZE_LENGTH       5000                                                                  /**< Length larger than any Memory Manager block. */
+
+
+/**@brief Number of Memory Manager blocks reserved for packet buffers. */
+static uint32_t memory_in_use_get(void)
+{
+    nrf_mem_tag_stats_t stats;
+
+    ck_assert_uint_eq(nrf_mem_tag_stats_get(NRF_MEM_TAG_PBUFFER, &stats), NRF_SUCCESS);
+
+    return stats.in_use;
+}
+
+
+static iot_pbuffer_stats_t stats_get(void)
+{
+    iot_pbuffer_stats_t stats;
+
+    ck_assert_uint_eq(iot_pbuffer_stats_get(&stats), NRF_SUCCESS);
+
+    return stats;
+}
+
+
+static iot_pbuffer_t * buffer_allocate(iot_pbuffer_type_t type, uint32_t length)
+{
+    iot_pbuffer_alloc_param_t param =
+    {
+        .type   = type,
+        .flags  = PBUFFER_FLAG_DEFAULT,
+        .length = length
+    };
+    iot_pbuffer_t * p_buffer = NULL;
+
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_ne(p_buffer, NULL);
+    ck_assert_ptr_ne(p_buffer->p_memory, NULL);
+    ck_assert_uint_eq(p_buffer->type, type);
+    ck_assert_uint_eq(p_buffer->length, length);
+
+    return p_buffer;
+}
+
+
+static void setup(void)
+{
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_init(), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+}
+
+
+START_TEST(test_headroom)
+{
+    static const struct
+    {
+        iot_pbuffer_type_t type;
+        uint32_t           headroom;
+    } types[] =
+    {
+        { RAW_PACKET_TYPE,   0  },
+        { IPV6_PACKET_TYPE,  40 },
+        { ICMP6_PACKET_TYPE, 44 },
+        { UDP6_PACKET_TYPE,  48 },
+        { COAP_PACKET_TYPE,  52 }
+    };
+
+    for (uint32_t i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+    {
+        iot_pbuffer_t * p_buffer = buffer_allocate(types[i].type, 10);
+
+        ck_assert_ptr_eq(p_buffer->p_payload, p_buffer->p_memory + types[i].headroom);
+        ck_assert_uint_eq(iot_pbuffer_free(p_buffer, true), NRF_SUCCESS);
+    }
+}
+END_TEST
+
+
+START_TEST(test_allocate_free_reuse)
+{
+    iot_pbuffer_t             * p_buffers[IOT_PBUFFER_MAX_COUNT];
+    iot_pbuffer_t             * p_buffer;
+    iot_pbuffer_alloc_param_t   param = { UDP6_PACKET_TYPE, PBUFFER_FLAG_DEFAULT, 16 };
+
+    // Every descriptor of the pool is handed out once.
+    for (uint32_t i = 0; i < IOT_PBUFFER_MAX_COUNT; i++)
+    {
+        p_buffers[i] = buffer_allocate(UDP6_PACKET_TYPE, 16);
+
+        for (uint32_t j = 0; j < i; j++)
+        {
+            ck_assert_ptr_ne(p_buffers[i], p_buffers[j]);
+        }
+    }
+
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE));
+    ck_assert_uint_eq(memory_in_use_get(), IOT_PBUFFER_MAX_COUNT);
+
+    // The descriptor freed last is handed out first.
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[2], true), NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[7], true), NRF_SUCCESS);
+
+    ck_assert_ptr_eq(buffer_allocate(UDP6_PACKET_TYPE, 16), p_buffers[7]);
+    ck_assert_ptr_eq(buffer_allocate(UDP6_PACKET_TYPE, 16), p_buffers[2]);
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE));
+
+    // A buffer freed twice, or not from the pool, is refused and the free list is unchanged.
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[0], true), NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[0], true), (NRF_ERROR_INVALID_ADDR | IOT_PBUFFER_ERR_BASE));
+
+    iot_pbuffer_t outside = *p_buffers[1];
+
+    ck_assert_uint_eq(iot_pbuffer_free(&outside, false), (NRF_ERROR_INVALID_ADDR | IOT_PBUFFER_ERR_BASE));
+
+    ck_assert_ptr_eq(buffer_allocate(UDP6_PACKET_TYPE, 16), p_buffers[0]);
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE));
+
+    for (uint32_t i = 0; i < IOT_PBUFFER_MAX_COUNT; i++)
+    {
+        ck_assert_uint_eq(iot_pbuffer_free(p_buffers[i], true), NRF_SUCCESS);
+    }
+}
+END_TEST
+
+
+START_TEST(test_no_mem_allocation)
+{
+    iot_pbuffer_alloc_param_t   param  = { IPV6_PACKET_TYPE, PBUFFER_FLAG_NO_MEM_ALLOCATION, 80 };
+    uint8_t                     packet[80];
+    iot_pbuffer_t             * p_buffer;
+
+    // Only the descriptor is taken, for a packet that already exists.
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_buffer->p_memory, NULL);
+    ck_assert_ptr_eq(p_buffer->p_payload, NULL);
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+    ck_assert_uint_eq(stats_get().in_use, 1);
+
+    p_buffer->p_memory  = packet;
+    p_buffer->p_payload = packet;
+
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffer, false), NRF_SUCCESS);
+    ck_assert_uint_eq(stats_get().in_use, 0);
+}
+END_TEST
+
+
+START_TEST(test_stats)
+{
+    iot_pbuffer_t             * p_buffers[IOT_PBUFFER_MAX_COUNT];
+    iot_pbuffer_t             * p_buffer;
+    iot_pbuffer_alloc_param_t   param = { UDP6_PACKET_TYPE, PBUFFER_FLAG_DEFAULT, OVERSIZE_LENGTH };
+    iot_pbuffer_stats_t         stats = stats_get();
+
+    ck_assert_uint_eq(stats.pool_size, IOT_PBUFFER_MAX_COUNT);
+    ck_assert_uint_eq(stats.in_use, 0);
+    ck_assert_uint_eq(stats.peak_in_use, 0);
+    ck_assert_uint_eq(stats.alloc_failures, 0);
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        p_buffers[i] = buffer_allocate(RAW_PACKET_TYPE, 32);
+    }
+
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[3], true), NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffers[2], true), NRF_SUCCESS);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.in_use, 2);
+    ck_assert_uint_eq(stats.peak_in_use, 4);
+
+    // A request too large for the Memory Manager fails without taking a descriptor.
+    ck_assert_uint_ne(iot_pbuffer_allocate(&param, &p_buffer), NRF_SUCCESS);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.in_use, 2);
+    ck_assert_uint_eq(stats.alloc_failures, 1);
+
+    // The high-water mark follows the pool to its end, and exhaustion is counted.
+    for (uint32_t i = 2; i < IOT_PBUFFER_MAX_COUNT; i++)
+    {
+        p_buffers[i] = buffer_allocate(RAW_PACKET_TYPE, 32);
+    }
+
+    param.length = 32;
+    ck_assert_uint_eq(iot_pbuffer_allocate(&param, &p_buffer), (NRF_ERROR_NO_MEM | IOT_PBUFFER_ERR_BASE));
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.in_use, IOT_PBUFFER_MAX_COUNT);
+    ck_assert_uint_eq(stats.peak_in_use, IOT_PBUFFER_MAX_COUNT);
+    ck_assert_uint_eq(stats.alloc_failures, 2);
+
+    for (uint32_t i = 0; i < IOT_PBUFFER_MAX_COUNT; i++)
+    {
+        ck_assert_uint_eq(iot_pbuffer_free(p_buffers[i], true), NRF_SUCCESS);
+    }
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.in_use, 0);
+    ck_assert_uint_eq(stats.peak_in_use, IOT_PBUFFER_MAX_COUNT);
+
+    // Initialization clears the statistics.
+    ck_assert_uint_eq(iot_pbuffer_init(), NRF_SUCCESS);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.peak_in_use, 0);
+    ck_assert_uint_eq(stats.alloc_failures, 0);
+}
+END_TEST
+
+
+START_TEST(test_reallocate_keeps_payload)
+{
+    iot_pbuffer_alloc_param_t   param    = { UDP6_PACKET_TYPE, PBUFFER_FLAG_DEFAULT, 40 };
+    iot_pbuffer_t             * p_buffer = buffer_allocate(UDP6_PACKET_TYPE, 40);
+    uint8_t                     headroom[UDP6_HEADROOM];
+    uint8_t                     payload[40];
+    iot_pbuffer_stats_t         stats;
+
+    for (uint32_t i = 0; i < sizeof(headroom); i++)
+    {
+        headroom[i] = (uint8_t)(0xA0 + i);
+    }
+
+    for (uint32_t i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (uint8_t)i;
+    }
+
+    memcpy(p_buffer->p_memory, headroom, sizeof(headroom));
+    memcpy(p_buffer->p_payload, payload, sizeof(payload));
+
+    // Growing within the 128 byte block leaves the data in place.
+    uint8_t * p_memory = p_buffer->p_memory;
+
+    param.length = 80;
+    ck_assert_uint_eq(iot_pbuffer_reallocate(&param, p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_buffer->p_memory, p_memory);
+    ck_assert_ptr_eq(p_buffer->p_payload, p_memory + UDP6_HEADROOM);
+    ck_assert_uint_eq(p_buffer->length, 80);
+    ck_assert_int_eq(memcmp(p_buffer->p_payload, payload, sizeof(payload)), 0);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.realloc_count, 1);
+    ck_assert_uint_eq(stats.realloc_copies, 0);
+
+    // Growing past the block moves headroom and payload to a larger block, and frees the old one.
+    param.length = 400;
+    ck_assert_uint_eq(iot_pbuffer_reallocate(&param, p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_ne(p_buffer->p_memory, p_memory);
+    ck_assert_ptr_eq(p_buffer->p_payload, p_buffer->p_memory + UDP6_HEADROOM);
+    ck_assert_uint_eq(p_buffer->length, 400);
+    ck_assert_int_eq(memcmp(p_buffer->p_memory, headroom, sizeof(headroom)), 0);
+    ck_assert_int_eq(memcmp(p_buffer->p_payload, payload, sizeof(payload)), 0);
+    ck_assert_uint_eq(memory_in_use_get(), 1);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.realloc_count, 2);
+    ck_assert_uint_eq(stats.realloc_copies, 1);
+
+    // A reallocation that cannot be served leaves the buffer as it was.
+    p_memory     = p_buffer->p_memory;
+    param.length = OVERSIZE_LENGTH;
+    ck_assert_uint_ne(iot_pbuffer_reallocate(&param, p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_buffer->p_memory, p_memory);
+    ck_assert_uint_eq(p_buffer->length, 400);
+    ck_assert_int_eq(memcmp(p_buffer->p_payload, payload, sizeof(payload)), 0);
+
+    stats = stats_get();
+    ck_assert_uint_eq(stats.realloc_count, 3);
+    ck_assert_uint_eq(stats.realloc_copies, 1);
+    ck_assert_uint_eq(stats.alloc_failures, 1);
+
+    // Shrinking keeps the block.
+    param.length = 20;
+    ck_assert_uint_eq(iot_pbuffer_reallocate(&param, p_buffer), NRF_SUCCESS);
+    ck_assert_ptr_eq(p_buffer->p_memory, p_memory);
+    ck_assert_uint_eq(p_buffer->length, 20);
+    ck_assert_int_eq(memcmp(p_buffer->p_payload, payload, 20), 0);
+
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffer, true), NRF_SUCCESS);
+}
+END_TEST
+
+
+START_TEST(test_reallocate_invalid)
+{
+    iot_pbuffer_alloc_param_t   param    = { UDP6_PACKET_TYPE, PBUFFER_FLAG_DEFAULT, 400 };
+    iot_pbuffer_t             * p_buffer = buffer_allocate(UDP6_PACKET_TYPE, 40);
+    iot_pbuffer_t               outside  = *p_buffer;
+
+    ck_assert_uint_eq(iot_pbuffer_reallocate(&param, &outside),
+                      (NRF_ERROR_INVALID_ADDR | IOT_PBUFFER_ERR_BASE));
+    ck_assert_uint_eq(iot_pbuffer_free(p_buffer, true), NRF_SUCCESS);
+    ck_assert_uint_eq(iot_pbuffer_reallocate(&param, p_buffer),
+                      (NRF_ERROR_INVALID_ADDR | IOT_PBUFFER_ERR_BASE));
+    ck_assert_uint_eq(memory_in_use_get(), 0);
+}
+END_TEST
+
+
+static Suite * iot_pbuffer_suite(void)
+{
+    Suite * p_suite = suite_create("iot_pbuffer");
+    TCase * p_case  = tcase_create("iot_pbuffer");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_headroom);
+    tcase_add_test(p_case, test_allocate_free_reuse);
+    tcase_add_test(p_case, test_no_mem_allocation);
+    tcase_add_test(p_case, test_stats);
+    tcase_add_test(p_case, test_reallocate_keeps_payload);
+    tcase_add_test(p_case, test_reallocate_invalid);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(iot_pbuffer_suite());
+}
@@ -0,0 +1,245 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the scheduler, built with three priority levels.
+ *
+ * @details Built with APP_SCHEDULER_WITH_PROFILER and APP_SCHEDULER_WITH_BUDGET, and again with
+ *          APP_SCHEDULER_WITH_BUDGET alone, where the statistics are not checked.
+ */
+
+#include "sdk_check.h"
+#include "app_scheduler.h"
+#include "app_util_platform.h"
+
+#define EVENT_SIZE            sizeof(uint32_t)                                                      /**< Maximum event size. */
+#define QUEUE_SIZE            4                                                                     /**< Number of entries in each queue. */
+
+static uint32_t m_buffer[CEIL_DIV(APP_SCHED_BUF_SIZE(EVENT_SIZE, QUEUE_SIZE), sizeof(uint32_t))];
+static uint32_t m_executed[4 * QUEUE_SIZE];                                                         /**< Event data of the executed events, in order of execution. */
+static uint32_t m_executed_count;
+static uint32_t m_now;                                                                              /**< Current time of the scheduler, in ticks. */
+
+
+static uint32_t timestamp_get(void)
+{
+    return m_now;
+}
+
+
+static void event_handler(void * p_event_data, uint16_t event_size)
+{
+    ck_assert_uint_eq(event_size, EVENT_SIZE);
+    ck_assert_uint_lt(m_executed_count, sizeof(m_executed) / sizeof(m_executed[0]));
+
+    m_executed[m_executed_count++] = *(uint32_t *)p_event_data;
+
+    // Each event takes ten ticks to handle.
+    m_now += 10;
+}
+
+
+static void event_put(uint32_t value, uint8_t priority)
+{
+    ck_assert_uint_eq(app_sched_event_put_prio(&value, EVENT_SIZE, event_handler, priority),
+                      NRF_SUCCESS);
+}
+
+
+static void setup(void)
+{
+    m_executed_count = 0;
+    m_now            = 0;
+
+    ck_assert_uint_eq(app_sched_init(EVENT_SIZE, QUEUE_SIZE, m_buffer), NRF_SUCCESS);
+    app_sched_timestamp_handler_set(timestamp_get);
+}
+
+
+static void teardown(void)
+{
+    // Every critical region entered has been left.
+    ck_assert_uint_eq(host_critical_region_nesting, 0);
+}
+
+
+START_TEST(test_execute_in_priority_order)
+{
+    event_put(1, APP_SCHED_PRIORITY_LOWEST);
+    event_put(2, 1);
+    event_put(3, APP_SCHED_PRIORITY_HIGHEST);
+    event_put(4, APP_SCHED_PRIORITY_LOWEST);
+    event_put(5, APP_SCHED_PRIORITY_HIGHEST);
+
+    app_sched_execute();
+
+    ck_assert_uint_eq(m_executed_count, 5);
+    ck_assert_uint_eq(m_executed[0], 3);
+    ck_assert_uint_eq(m_executed[1], 5);
+    ck_assert_uint_eq(m_executed[2], 2);
+    ck_assert_uint_eq(m_executed[3], 1);
+    ck_assert_uint_eq(m_executed[4], 4);
+}
+END_TEST
+
+
+START_TEST(test_queue_full)
+{
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        event_put(i, 1);
+    }
+
+    ck_assert_uint_eq(app_sched_event_put_prio(&value, EVENT_SIZE, event_handler, 1),
+                      NRF_ERROR_NO_MEM);
+
+    // Other priority levels have queues of their own.
+    event_put(100, APP_SCHED_PRIORITY_HIGHEST);
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    app_sched_prio_stats_t stats;
+
+    ck_assert_uint_eq(app_sched_prio_stats_get(1, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.depth, QUEUE_SIZE);
+    ck_assert_uint_eq(stats.max_depth, QUEUE_SIZE);
+    ck_assert_uint_eq(stats.put_count, QUEUE_SIZE);
+    ck_assert_uint_eq(stats.drop_count, 1);
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+    ck_assert_uint_eq(app_sched_event_put_prio(&value, EVENT_SIZE + 1, event_handler, 1),
+                      NRF_ERROR_INVALID_LENGTH);
+    ck_assert_uint_eq(app_sched_event_put_prio(&value, EVENT_SIZE, event_handler,
+                                               APP_SCHED_PRIORITY_COUNT),
+                      NRF_ERROR_INVALID_PARAM);
+}
+END_TEST
+
+
+START_TEST(test_reserved_event_holds_back_later_events)
+{
+    app_sched_slot_t slot;
+
+    ck_assert_uint_eq(app_sched_event_reserve(EVENT_SIZE, event_handler, &slot), NRF_SUCCESS);
+    event_put(2, APP_SCHED_PRIORITY_HIGHEST);
+
+    app_sched_execute();
+    ck_assert_uint_eq(m_executed_count, 0);
+
+    *(uint32_t *)slot.p_event_data = 1;
+    app_sched_event_commit(&slot);
+
+    app_sched_execute();
+    ck_assert_uint_eq(m_executed_count, 2);
+    ck_assert_uint_eq(m_executed[0], 1);
+    ck_assert_uint_eq(m_executed[1], 2);
+}
+END_TEST
+
+
+START_TEST(test_cancel_releases_entry)
+{
+    app_sched_slot_t slots[QUEUE_SIZE];
+
+    // Fill the queue with reservations, and cancel all but the third.
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        ck_assert_uint_eq(app_sched_event_reserve(EVENT_SIZE, event_handler, &slots[i]),
+                          NRF_SUCCESS);
+    }
+
+    app_sched_event_cancel(&slots[0]);
+    app_sched_event_cancel(&slots[1]);
+    app_sched_event_cancel(&slots[3]);
+
+    *(uint32_t *)slots[2].p_event_data = 3;
+    app_sched_event_commit(&slots[2]);
+
+    app_sched_execute();
+    ck_assert_uint_eq(m_executed_count, 1);
+    ck_assert_uint_eq(m_executed[0], 3);
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    app_sched_prio_stats_t stats;
+
+    ck_assert_uint_eq(app_sched_prio_stats_get(APP_SCHED_PRIORITY_HIGHEST, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.depth, 0);
+    ck_assert_uint_eq(stats.exec_count, 1);
+    ck_assert_uint_eq(stats.cancel_count, 3);
+#endif // APP_SCHEDULER_WITH_PROFILER
+
+    // The full capacity of the queue is available again.
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        event_put(10 + i, APP_SCHED_PRIORITY_HIGHEST);
+    }
+
+    app_sched_execute();
+    ck_assert_uint_eq(m_executed_count, 1 + QUEUE_SIZE);
+    ck_assert_uint_eq(m_executed[1], 10);
+    ck_assert_uint_eq(m_executed[QUEUE_SIZE], 10 + QUEUE_SIZE - 1);
+}
+END_TEST
+
+
+START_TEST(test_execute_budget)
+{
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        event_put(i, 1);
+    }
+
+    ck_assert_uint_eq(app_sched_execute_budget(1, 0), 1);
+
+    // Budget of 15 ticks: execution stops after the event that uses up the budget.
+    ck_assert_uint_eq(app_sched_execute_budget(UINT32_MAX, 15), 2);
+
+    // An event of higher priority is executed next.
+    event_put(100, APP_SCHED_PRIORITY_HIGHEST);
+    ck_assert_uint_eq(app_sched_execute_budget(1, 0), 1);
+    ck_assert_uint_eq(m_executed[3], 100);
+
+#ifdef APP_SCHEDULER_WITH_PROFILER
+    app_sched_prio_stats_t stats;
+
+    ck_assert_uint_eq(app_sched_prio_stats_get(1, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.depth, 1);
+    ck_assert_uint_eq(stats.exec_count, 3);
+    ck_assert_uint_eq(stats.max_latency, 20);
+#endif // APP_SCHEDULER_WITH_PROFILER
+}
+END_TEST
+
+
+static Suite * app_scheduler_suite(void)
+{
+    Suite * p_suite = suite_create("app_scheduler");
+    TCase * p_case  = tcase_create("app_scheduler");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_execute_in_priority_order);
+    tcase_add_test(p_case, test_queue_full);
+    tcase_add_test(p_case, test_reserved_event_holds_back_later_events);
+    tcase_add_test(p_case, test_cancel_releases_entry);
+    tcase_add_test(p_case, test_execute_budget);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(app_scheduler_suite());
+}
@@ -0,0 +1,47 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file sdk_check.h
+ *
+ * @brief Common header of the SDK unit tests using the check framework.
+ *
+ * @details Each unit test is a program of its own that runs one suite, so that modules which
+ *          replace each other on the host, such as app_timer.c and app_timer_host.c, can each be
+ *          tested.
+ */
+
+#ifndef SDK_CHECK_H__
+#define SDK_CHECK_H__
+
+#include <check.h>
+#include <stdlib.h>
+
+/**@brief Run a test suite.
+ *
+ * @param[in] p_suite Suite to run.
+ *
+ * @return EXIT_SUCCESS if all tests passed, else EXIT_FAILURE.
+ */
+static inline int sdk_check_run(Suite * p_suite)
+{
+    SRunner * p_runner = srunner_create(p_suite);
+
+    srunner_run_all(p_runner, CK_NORMAL);
+
+    int failed = srunner_ntests_failed(p_runner);
+
+    srunner_free(p_runner);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+#endif // SDK_CHECK_H__
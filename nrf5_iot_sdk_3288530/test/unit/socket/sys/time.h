@@ -0,0 +1,29 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file time.h
+ *
+ * @brief Host stand-in for sys/time.h, included by socket_api.h for struct timeval.
+ *
+ * @details The sys/time.h of the host C library declares select() and fd_set, which socket_api.h
+ *          declares itself.
+ */
+
+#ifndef SYS_TIME_H__
+#define SYS_TIME_H__
+
+struct timeval {
+    long tv_sec;                                            /**< Seconds. */
+    long tv_usec;                                           /**< Microseconds. */
+};
+
+#endif // SYS_TIME_H__
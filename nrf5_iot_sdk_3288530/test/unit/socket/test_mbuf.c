@@ -0,0 +1,406 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the receive queue of the socket layer (mbuf).
+ *
+ * @details Data is queued as chains of segments of random size, as the transports do for chained
+ *          packets, and read back with random mixes of scatter reads, peeks, reads, borrows and
+ *          releases. The data read is checked against the data queued, and every segment must be
+ *          handed back to the free function of the queue exactly once.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "mem_manager.h"
+#include "mbuf.h"
+
+#define DATA_SIZE             4096                                                                  /**< Largest amount of data queued in a round. */
+#define MAX_SEGMENTS          24                                                                    /**< Largest number of segments queued in a round. */
+#define MAX_SEGMENT_SIZE      40                                                                    /**< Largest size of a segment. */
+#define ROUNDS                500                                                                   /**< Number of random rounds. */
+
+/**@brief Segment handed to the queue, with the state needed to check that it is freed once. */
+typedef struct
+{
+    uint8_t data[MAX_SEGMENT_SIZE];
+    bool    queued;
+} segment_t;
+
+static segment_t m_segments[MAX_SEGMENTS];
+static uint32_t  m_segment_count;                                                                   /**< Number of segments used in the round. */
+static uint32_t  m_free_count;                                                                      /**< Number of segments given to the free function. */
+static uint32_t  m_free_errors;                                                                     /**< Number of segments freed while not queued. */
+static uint8_t   m_data[DATA_SIZE];                                                                 /**< All data queued in the round, in order. */
+static uint32_t  m_data_size;                                                                       /**< Amount of data queued in the round. */
+static uint32_t  m_seed;                                                                            /**< State of the pseudo random number generator. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+static void segment_free(void * p_ctx)
+{
+    segment_t * p_segment = (segment_t *)p_ctx;
+
+    if (!p_segment->queued)
+    {
+        m_free_errors++;
+    }
+
+    p_segment->queued = false;
+    m_free_count++;
+}
+
+
+/**@brief Queue a chain of segments of the given sizes, filled with random data. */
+static void chain_write(mbuf_head_t * p_head, const uint32_t * p_sizes, uint32_t count)
+{
+    mbuf_t * p_first = NULL;
+    mbuf_t * p_last  = NULL;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        segment_t * p_segment = &m_segments[m_segment_count++];
+        mbuf_t    * p_mbuf;
+
+        for (uint32_t j = 0; j < p_sizes[i]; j++)
+        {
+            p_segment->data[j]       = (uint8_t)rand_get();
+            m_data[m_data_size + j] = p_segment->data[j];
+        }
+
+        m_data_size       += p_sizes[i];
+        p_segment->queued  = true;
+
+        ck_assert_uint_eq(mbuf_alloc(&p_mbuf, p_segment, p_segment->data, p_sizes[i]), NRF_SUCCESS);
+
+        if (p_first == NULL)
+        {
+            p_first = p_mbuf;
+        }
+        else
+        {
+            p_last->p_next = p_mbuf;
+        }
+
+        p_last = p_mbuf;
+    }
+
+    mbuf_write(p_head, p_first);
+}
+
+
+static void setup(void)
+{
+    ck_assert_uint_eq(nrf_mem_init(), NRF_SUCCESS);
+
+    memset(m_segments, 0, sizeof(m_segments));
+
+    m_seed          = 1;
+    m_segment_count = 0;
+    m_free_count    = 0;
+    m_free_errors   = 0;
+    m_data_size     = 0;
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_read_across_segments)
+{
+    static const uint32_t sizes[] = { 3, 0, 5, 1, 7 };
+    mbuf_head_t           head;
+    uint8_t               buffer[16];
+
+    mbuf_init(&head, segment_free);
+    chain_write(&head, sizes, 5);
+    ck_assert_uint_eq(mbuf_size_total(&head), 16);
+
+    // A peek spans all segments and leaves them queued.
+    ck_assert_uint_eq(mbuf_peek(&head, buffer, sizeof(buffer)), 16);
+    ck_assert_mem_eq(buffer, m_data, 16);
+    ck_assert_uint_eq(m_free_count, 0);
+
+    // Each segment is freed as soon as it has been read, the empty one with the segment before.
+    ck_assert_uint_eq(mbuf_read(&head, buffer, 4), 4);
+    ck_assert_mem_eq(buffer, m_data, 4);
+    ck_assert_uint_eq(m_free_count, 2);
+
+    ck_assert_uint_eq(mbuf_read(&head, buffer, sizeof(buffer)), 12);
+    ck_assert_mem_eq(buffer, &m_data[4], 12);
+    ck_assert_uint_eq(m_free_count, 5);
+    ck_assert(mbuf_empty(&head));
+
+    ck_assert_uint_eq(mbuf_read(&head, buffer, sizeof(buffer)), 0);
+    ck_assert_uint_eq(m_free_errors, 0);
+}
+END_TEST
+
+
+START_TEST(test_readv_scatter)
+{
+    static const uint32_t sizes[] = { 10, 10, 10 };
+    mbuf_head_t           head;
+    uint8_t               first[4];
+    uint8_t               second[13];
+    uint8_t               third[20];
+    const struct iovec    iov[] = { { first, sizeof(first) },
+                                    { NULL, 0 },
+                                    { second, sizeof(second) },
+                                    { third, sizeof(third) } };
+
+    mbuf_init(&head, segment_free);
+    chain_write(&head, sizes, 3);
+
+    // Peeked data is scattered in order, an empty buffer is skipped.
+    ck_assert_uint_eq(mbuf_readv(&head, iov, 4, MSG_PEEK), 30);
+    ck_assert_mem_eq(first, m_data, 4);
+    ck_assert_mem_eq(second, &m_data[4], 13);
+    ck_assert_mem_eq(third, &m_data[17], 13);
+    ck_assert_uint_eq(mbuf_size_total(&head), 30);
+
+    // Read the first bytes, then the rest is scattered from the new read position.
+    ck_assert_uint_eq(mbuf_readv(&head, iov, 1, 0), 4);
+    ck_assert_uint_eq(mbuf_readv(&head, &iov[1], 3, 0), 26);
+    ck_assert_mem_eq(second, &m_data[4], 13);
+    ck_assert_mem_eq(third, &m_data[17], 13);
+
+    ck_assert(mbuf_empty(&head));
+    ck_assert_uint_eq(m_free_count, 3);
+    ck_assert_uint_eq(m_free_errors, 0);
+}
+END_TEST
+
+
+START_TEST(test_borrow_and_release)
+{
+    static const uint32_t sizes[] = { 0, 6, 8 };
+    mbuf_head_t           head;
+    uint8_t             * p_data;
+
+    mbuf_init(&head, segment_free);
+    chain_write(&head, sizes, 3);
+
+    // The empty segment is skipped, and the data of the next one is lent in place.
+    ck_assert_uint_eq(mbuf_borrow(&head, &p_data), 6);
+    ck_assert_ptr_eq(p_data, m_segments[1].data);
+    ck_assert_uint_eq(m_free_count, 1);
+
+    ck_assert_uint_eq(mbuf_release(&head, 2), 2);
+    ck_assert_uint_eq(mbuf_borrow(&head, &p_data), 4);
+    ck_assert_ptr_eq(p_data, &m_segments[1].data[2]);
+
+    // A release spanning segments consumes no more than is queued.
+    ck_assert_uint_eq(mbuf_release(&head, 100), 12);
+    ck_assert_uint_eq(mbuf_borrow(&head, &p_data), 0);
+    ck_assert_ptr_eq(p_data, NULL);
+    ck_assert_uint_eq(m_free_count, 3);
+}
+END_TEST
+
+
+START_TEST(test_flush_pending)
+{
+    static const uint32_t sizes[] = { 10, 20, 30 };
+    mbuf_head_t           head;
+    uint8_t               buffer[15];
+
+    mbuf_init(&head, segment_free);
+    chain_write(&head, sizes, 3);
+
+    ck_assert_uint_eq(mbuf_read(&head, buffer, sizeof(buffer)), 15);
+
+    // Closing a socket with data pending releases every segment still queued.
+    mbuf_flush(&head);
+    ck_assert(mbuf_empty(&head));
+    ck_assert_ptr_eq(head.p_first, NULL);
+    ck_assert_uint_eq(m_free_count, 3);
+    ck_assert_uint_eq(m_free_errors, 0);
+
+    // The queue can be used again.
+    chain_write(&head, sizes, 1);
+    ck_assert_uint_eq(mbuf_read(&head, buffer, sizeof(buffer)), 10);
+    ck_assert_mem_eq(buffer, &m_data[60], 10);
+}
+END_TEST
+
+
+START_TEST(test_random_operations)
+{
+    for (uint32_t round = 0; round < ROUNDS; round++)
+    {
+        mbuf_head_t head;
+
+        m_segment_count = 0;
+        m_free_count    = 0;
+        m_data_size     = 0;
+
+        mbuf_init(&head, segment_free);
+
+        // Several chains of up to eight segments, some of them empty.
+        uint32_t chains = 1 + (rand_get() % 3);
+
+        for (uint32_t chain = 0; chain < chains; chain++)
+        {
+            uint32_t sizes[8];
+            uint32_t count = 1 + (rand_get() % 8);
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                sizes[i] = rand_get() % (MAX_SEGMENT_SIZE + 1);
+            }
+
+            chain_write(&head, sizes, count);
+        }
+
+        ck_assert_uint_eq(mbuf_size_total(&head), m_data_size);
+
+        uint32_t position = 0;
+
+        while (position < m_data_size)
+        {
+            uint8_t  buffer[100];
+            uint32_t size = rand_get() % sizeof(buffer);
+            uint32_t count;
+
+            switch (rand_get() % 4)
+            {
+                case 0:
+                {
+                    uint8_t            first[7];
+                    uint8_t            second[13];
+                    uint8_t            third[29];
+                    const struct iovec iov[] = { { first, rand_get() % (sizeof(first) + 1) },
+                                                 { second, rand_get() % (sizeof(second) + 1) },
+                                                 { third, rand_get() % (sizeof(third) + 1) } };
+                    const bool         peek  = ((rand_get() % 3) == 0);
+                    uint32_t           checked = 0;
+
+                    count = mbuf_readv(&head, iov, 3, peek ? MSG_PEEK : 0);
+
+                    for (uint32_t i = 0; i < 3; i++)
+                    {
+                        uint32_t length = MIN(iov[i].iov_len, count - checked);
+
+                        ck_assert_mem_eq(iov[i].iov_base, &m_data[position + checked], length);
+                        checked += length;
+                    }
+
+                    ck_assert_uint_eq(checked, count);
+
+                    if (!peek)
+                    {
+                        position += count;
+                    }
+                    break;
+                }
+
+                case 1:
+                    count = mbuf_peek(&head, buffer, size);
+                    ck_assert_uint_eq(count, MIN(size, m_data_size - position));
+                    ck_assert_mem_eq(buffer, &m_data[position], count);
+                    break;
+
+                case 2:
+                {
+                    uint8_t * p_data;
+
+                    count = mbuf_borrow(&head, &p_data);
+
+                    if (count != 0)
+                    {
+                        uint32_t release = rand_get() % (count + 1);
+
+                        ck_assert_mem_eq(p_data, &m_data[position], count);
+                        ck_assert_uint_eq(mbuf_release(&head, release), release);
+                        position += release;
+                    }
+                    break;
+                }
+
+                default:
+                    count = mbuf_read(&head, buffer, size);
+                    ck_assert_uint_eq(count, MIN(size, m_data_size - position));
+                    ck_assert_mem_eq(buffer, &m_data[position], count);
+                    position += count;
+                    break;
+            }
+
+            ck_assert_uint_eq(mbuf_size_total(&head), m_data_size - position);
+        }
+
+        // Empty segments at the end are released by a flush or by the next borrow.
+        if ((rand_get() % 2) == 0)
+        {
+            mbuf_flush(&head);
+        }
+        else
+        {
+            uint8_t * p_data;
+
+            ck_assert_uint_eq(mbuf_borrow(&head, &p_data), 0);
+        }
+
+        ck_assert_ptr_eq(head.p_first, NULL);
+        ck_assert_uint_eq(m_free_count, m_segment_count);
+    }
+
+    ck_assert_uint_eq(m_free_errors, 0);
+
+    // All queue elements were returned to the Memory Manager.
+    nrf_mem_cat_stats_t stats;
+
+    for (uint32_t category = 0; category < NRF_MEM_BLOCK_CAT_COUNT; category++)
+    {
+        if (nrf_mem_cat_stats_get(category, &stats) == NRF_SUCCESS)
+        {
+            ck_assert_uint_eq(stats.in_use, 0);
+        }
+    }
+}
+END_TEST
+
+
+static Suite * mbuf_suite(void)
+{
+    Suite * p_suite = suite_create("mbuf");
+    TCase * p_case  = tcase_create("mbuf");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_read_across_segments);
+    tcase_add_test(p_case, test_readv_scatter);
+    tcase_add_test(p_case, test_borrow_and_release);
+    tcase_add_test(p_case, test_flush_pending);
+    tcase_add_test(p_case, test_random_operations);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(mbuf_suite());
+}
@@ -0,0 +1,466 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of poll() and select() of the socket layer.
+ *
+ * @details The test provides the transport handler, which marks sockets readable, writable or hung
+ *          up on request, and sd_app_evt_wait, which stands for the sleep of the application: it
+ *          moves the simulated clock of app_timer_host to the next scripted transport event or to
+ *          the expiry of the next timer, whichever comes first, and runs it. Time-outs are checked
+ *          against the simulated clock, so a poll that returns early or late fails the test, and a
+ *          poll that would sleep with neither an event nor a timer pending fails instead of hanging.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "sdk_config.h"
+#include "nrf_soc.h"
+#include "app_timer_host.h"
+#include "nrf_platform_port.h"
+#include "socket_api.h"
+#include "socket_handler.h"
+#include "socket.h"
+
+#define TIMER_OP_QUEUE_SIZE   4                                                                     /**< Size of the timer operation queues. */
+#define WAIT_CHUNK_MS         3600000                                                               /**< Longest interval of the wait timer of the socket layer. */
+
+#define MS_TO_TICKS(MS)       APP_TIMER_TICKS((MS), NRF_DRIVER_TIMER_PRESCALER)                     /**< Ticks of the simulated clock in a time in milliseconds. */
+
+/**@brief Change of the state of a socket made by the transport. */
+typedef void (* transport_event_t)(int sock);
+
+static uint32_t          m_timer_buffer[CEIL_DIV(APP_TIMER_BUF_SIZE(TIMER_OP_QUEUE_SIZE), sizeof(uint32_t))];
+
+static socket_handle_t * mp_created;                                                                /**< Handle given to the last call of the create handler. */
+static socket_handle_t * mp_handles[SOCKET_MAX_SOCKET_COUNT];                                       /**< Handle of each open socket. */
+static uint8_t           m_rx_data[] = "hello";                                                     /**< Data received by the sockets. */
+
+static transport_event_t m_event;                                                                   /**< Next transport event, or NULL. */
+static int               m_event_sock;                                                              /**< Socket of the next transport event. */
+static uint64_t          m_event_tick;                                                              /**< Time of the next transport event. */
+static uint32_t          m_wait_count;                                                              /**< Number of calls to sd_app_evt_wait. */
+static bool              m_timer_running_in_event;                                                  /**< A timer was running when the last transport event occurred. */
+
+
+/**@brief Free function of the receive queues, the data received is static. */
+static void rx_data_free(void * p_ctx)
+{
+}
+
+
+static uint32_t transport_create(socket_handle_t * p_socket_handle)
+{
+    mp_created = p_socket_handle;
+    mbuf_init(&p_socket_handle->mbuf_head, rx_data_free);
+
+    return NRF_SUCCESS;
+}
+
+
+static uint32_t transport_connect(socket_handle_t * p_socket_handle,
+                                  const void      * p_addr,
+                                  socklen_t         addrlen)
+{
+    return NRF_SUCCESS;
+}
+
+
+static uint32_t transport_close(socket_handle_t * p_socket_handle)
+{
+    mbuf_flush(&p_socket_handle->mbuf_head);
+
+    return NRF_SUCCESS;
+}
+
+
+socket_handler_t transport_handler =
+{
+    .create_handler  = transport_create,
+    .connect_handler = transport_connect,
+    .close_handler   = transport_close
+};
+
+
+void transport_handler_init(void)
+{
+}
+
+
+static void data_received(int sock)
+{
+    mbuf_t * p_mbuf;
+
+    ck_assert_uint_eq(mbuf_alloc(&p_mbuf, NULL, m_rx_data, sizeof(m_rx_data)), NRF_SUCCESS);
+    mbuf_write(&mp_handles[sock]->mbuf_head, p_mbuf);
+    mp_handles[sock]->read_events++;
+    socket_readiness_update(mp_handles[sock]);
+}
+
+
+static void write_ready(int sock)
+{
+    mp_handles[sock]->write_ready = true;
+    socket_readiness_update(mp_handles[sock]);
+}
+
+
+static void hung_up(int sock)
+{
+    mp_handles[sock]->hangup      = true;
+    mp_handles[sock]->write_ready = false;
+    socket_readiness_update(mp_handles[sock]);
+}
+
+
+/**@brief Schedule a transport event on a socket, a time in milliseconds from now. */
+static void event_schedule(transport_event_t event, int sock, uint32_t delay_ms)
+{
+    m_event      = event;
+    m_event_sock = sock;
+    m_event_tick = app_timer_host_ticks_get() + MS_TO_TICKS(delay_ms);
+}
+
+
+uint32_t sd_app_evt_wait(void)
+{
+    uint32_t ticks;
+    uint64_t now           = app_timer_host_ticks_get();
+    bool     timer_running = (app_timer_host_next_expiry_get(&ticks) == NRF_SUCCESS);
+
+    m_wait_count++;
+
+    if ((m_event != NULL) && ((!timer_running) || (m_event_tick <= now + ticks)))
+    {
+        // Timers expiring at the time of the event expire in the same wake-up.
+        transport_event_t event = m_event;
+
+        m_event                  = NULL;
+        m_timer_running_in_event = timer_running;
+
+        app_timer_host_advance((uint32_t)(m_event_tick - now));
+        event(m_event_sock);
+    }
+    else
+    {
+        // Nothing would ever wake the application up.
+        ck_assert(timer_running);
+
+        app_timer_host_advance(ticks);
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Open and connect a socket. */
+static int socket_open(void)
+{
+    sockaddr_in6_t addr;
+
+    memset(&addr, 0, sizeof(addr));
+
+    int sock = socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+
+    ck_assert_int_ge(sock, 0);
+    ck_assert_int_eq(connect(sock, &addr, sizeof(addr)), 0);
+
+    mp_handles[sock] = mp_created;
+
+    return sock;
+}
+
+
+/**@brief Check that the simulated time elapsed since a given time is a time in milliseconds. */
+static void elapsed_check(uint64_t start, uint32_t elapsed_ms)
+{
+    ck_assert_uint_eq(app_timer_host_ticks_get() - start, MS_TO_TICKS(elapsed_ms));
+}
+
+
+/**@brief Check that poll() left its wait timer stopped. */
+static void timer_stopped_check(void)
+{
+    uint32_t ticks;
+
+    ck_assert_uint_eq(app_timer_host_next_expiry_get(&ticks), NRF_ERROR_NOT_FOUND);
+}
+
+
+static void setup(void)
+{
+    ck_assert_uint_eq(app_timer_init(0, TIMER_OP_QUEUE_SIZE, m_timer_buffer, NULL), NRF_SUCCESS);
+    ck_assert_uint_eq(socket_init(), NRF_SUCCESS);
+
+    memset(mp_handles, 0, sizeof(mp_handles));
+
+    m_event                  = NULL;
+    m_wait_count             = 0;
+    m_timer_running_in_event = false;
+}
+
+
+static void teardown(void)
+{
+    for (int sock = 0; sock < SOCKET_MAX_SOCKET_COUNT; sock++)
+    {
+        if (mp_handles[sock] != NULL)
+        {
+            ck_assert_int_eq(close(sock), 0);
+        }
+    }
+}
+
+
+START_TEST(test_poll_timeout)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[1] = { { .fd = sock, .events = (POLLIN | POLLOUT) } };
+    uint64_t      start  = app_timer_host_ticks_get();
+
+    // A zero time-out only scans.
+    ck_assert_int_eq(poll(fds, 1, 0), 0);
+    ck_assert_uint_eq(m_wait_count, 0);
+    ck_assert_int_eq(fds[0].revents, 0);
+
+    ck_assert_int_eq(poll(fds, 1, 250), 0);
+    ck_assert_int_eq(fds[0].revents, 0);
+    elapsed_check(start, 250);
+    timer_stopped_check();
+}
+END_TEST
+
+
+START_TEST(test_poll_long_timeout)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[1] = { { .fd = sock, .events = POLLIN } };
+    uint64_t      start  = app_timer_host_ticks_get();
+
+    // Waited for in two intervals of the wait timer.
+    ck_assert_int_eq(poll(fds, 1, WAIT_CHUNK_MS + 500), 0);
+    elapsed_check(start, WAIT_CHUNK_MS + 500);
+    ck_assert_uint_eq(m_wait_count, 2);
+    timer_stopped_check();
+}
+END_TEST
+
+
+START_TEST(test_poll_readable)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[1] = { { .fd = sock, .events = (POLLIN | POLLOUT) } };
+    uint64_t      start  = app_timer_host_ticks_get();
+    uint8_t       buf[sizeof(m_rx_data)];
+
+    event_schedule(data_received, sock, 40);
+
+    ck_assert_int_eq(poll(fds, 1, 1000), 1);
+    ck_assert_int_eq(fds[0].revents, POLLIN);
+    elapsed_check(start, 40);
+    timer_stopped_check();
+
+    // Reading the data clears the readiness.
+    ck_assert_int_eq(recv(sock, buf, sizeof(buf), 0), sizeof(m_rx_data));
+    ck_assert_int_eq(poll(fds, 1, 0), 0);
+    ck_assert_int_eq(fds[0].revents, 0);
+}
+END_TEST
+
+
+START_TEST(test_poll_readable_at_timeout)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[1] = { { .fd = sock, .events = POLLIN } };
+
+    // The data and the time-out wake the application up together, the data wins.
+    event_schedule(data_received, sock, 100);
+
+    ck_assert_int_eq(poll(fds, 1, 100), 1);
+    ck_assert_int_eq(fds[0].revents, POLLIN);
+    ck_assert_uint_eq(m_wait_count, 1);
+    timer_stopped_check();
+}
+END_TEST
+
+
+START_TEST(test_poll_writable_no_timeout)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[2] = { { .fd = sock, .events = POLLIN },
+                             { .fd = sock, .events = POLLOUT } };
+    uint64_t      start  = app_timer_host_ticks_get();
+
+    event_schedule(write_ready, sock, 5000);
+
+    // No timer is needed to wait without a time-out.
+    ck_assert_int_eq(poll(fds, 2, -1), 1);
+    ck_assert_int_eq(fds[0].revents, 0);
+    ck_assert_int_eq(fds[1].revents, POLLOUT);
+    ck_assert(!m_timer_running_in_event);
+    elapsed_check(start, 5000);
+}
+END_TEST
+
+
+START_TEST(test_poll_hangup)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[1] = { { .fd = sock, .events = POLLOUT } };
+    uint8_t       buf[8];
+
+    write_ready(sock);
+    ck_assert_int_eq(poll(fds, 1, 0), 1);
+    ck_assert_int_eq(fds[0].revents, POLLOUT);
+
+    // POLLHUP is reported without being asked for, and the socket stops being writable.
+    hung_up(sock);
+    ck_assert_int_eq(poll(fds, 1, 0), 1);
+    ck_assert_int_eq(fds[0].revents, POLLHUP);
+
+    fds[0].events = POLLIN;
+    ck_assert_int_eq(poll(fds, 1, 0), 1);
+    ck_assert_int_eq(fds[0].revents, (POLLIN | POLLHUP));
+
+    // The end of the stream is read without blocking.
+    ck_assert_int_eq(recv(sock, buf, sizeof(buf), 0), 0);
+    ck_assert_int_eq(poll(fds, 1, 0), 1);
+    ck_assert_int_eq(fds[0].revents, (POLLIN | POLLHUP));
+}
+END_TEST
+
+
+START_TEST(test_poll_invalid)
+{
+    int           sock   = socket_open();
+    struct pollfd fds[3] = { { .fd = -1,                      .events = POLLIN },
+                             { .fd = sock + 1,                .events = POLLIN },
+                             { .fd = SOCKET_MAX_SOCKET_COUNT, .events = POLLIN } };
+
+    fds[0].revents = POLLIN;
+
+    ck_assert_int_eq(poll(fds, 3, 1000), 2);
+    ck_assert_int_eq(fds[0].revents, 0);
+    ck_assert_int_eq(fds[1].revents, POLLNVAL);
+    ck_assert_int_eq(fds[2].revents, POLLNVAL);
+    ck_assert_uint_eq(m_wait_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_select_timeout)
+{
+    int            sock    = socket_open();
+    fd_set         readset;
+    struct timeval timeout = { .tv_sec = 0, .tv_usec = 15500 };
+    uint64_t       start   = app_timer_host_ticks_get();
+
+    FD_ZERO(&readset);
+    FD_SET(sock, &readset);
+
+    // Rounded up to whole milliseconds.
+    ck_assert_int_eq(select(sock + 1, &readset, NULL, NULL, &timeout), 0);
+    ck_assert_uint_eq(readset, 0);
+    elapsed_check(start, 16);
+    timer_stopped_check();
+
+    timeout.tv_usec = 1000000;
+    FD_SET(sock, &readset);
+    ck_assert_int_eq(select(sock + 1, &readset, NULL, NULL, &timeout), -1);
+    ck_assert_int_eq(errno, EINVAL);
+}
+END_TEST
+
+
+START_TEST(test_select_readiness)
+{
+    int            sock_a  = socket_open();
+    int            sock_b  = socket_open();
+    fd_set         readset;
+    fd_set         writeset;
+    fd_set         exceptset;
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    uint64_t       start   = app_timer_host_ticks_get();
+
+    FD_ZERO(&readset);
+    FD_ZERO(&writeset);
+    FD_SET(sock_a, &readset);
+    FD_SET(sock_b, &readset);
+    FD_SET(sock_a, &writeset);
+    exceptset = readset;
+
+    event_schedule(data_received, sock_b, 30);
+
+    ck_assert_int_eq(select(sock_b + 1, &readset, &writeset, &exceptset, &timeout), 1);
+    ck_assert(!FD_ISSET(sock_a, &readset));
+    ck_assert(FD_ISSET(sock_b, &readset));
+    ck_assert_uint_eq(writeset, 0);
+    ck_assert_uint_eq(exceptset, 0);
+    elapsed_check(start, 30);
+    timer_stopped_check();
+
+    // A hung up socket is both readable and writable.
+    hung_up(sock_a);
+
+    FD_ZERO(&readset);
+    FD_SET(sock_a, &readset);
+    writeset = readset;
+
+    ck_assert_int_eq(select(sock_a + 1, &readset, &writeset, NULL, NULL), 2);
+    ck_assert(FD_ISSET(sock_a, &readset));
+    ck_assert(FD_ISSET(sock_a, &writeset));
+}
+END_TEST
+
+
+START_TEST(test_select_closed)
+{
+    int            sock    = socket_open();
+    fd_set         readset;
+    struct timeval timeout = { .tv_sec = 0, .tv_usec = 0 };
+
+    FD_ZERO(&readset);
+    FD_SET(sock + 1, &readset);
+
+    ck_assert_int_eq(select(sock + 2, &readset, NULL, NULL, &timeout), -1);
+    ck_assert_int_eq(errno, EBADF);
+}
+END_TEST
+
+
+static Suite * socket_poll_suite(void)
+{
+    Suite * p_suite = suite_create("socket_poll");
+    TCase * p_case  = tcase_create("socket_poll");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_poll_timeout);
+    tcase_add_test(p_case, test_poll_long_timeout);
+    tcase_add_test(p_case, test_poll_readable);
+    tcase_add_test(p_case, test_poll_readable_at_timeout);
+    tcase_add_test(p_case, test_poll_writable_no_timeout);
+    tcase_add_test(p_case, test_poll_hangup);
+    tcase_add_test(p_case, test_poll_invalid);
+    tcase_add_test(p_case, test_select_timeout);
+    tcase_add_test(p_case, test_select_readiness);
+    tcase_add_test(p_case, test_select_closed);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(socket_poll_suite());
+}
@@ -0,0 +1,356 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of app_timer on an emulated RTC1, built once for the sorted list and once for
+ *        the timer wheel (APP_TIMER_WITH_WHEEL).
+ *
+ * @details Every time-out is checked against the tick it is due at. A timer may expire up to
+ *          three ticks after that tick, as app_timer keeps the compare register that far ahead of
+ *          the counter. With the sorted list, a periodic timer may expire one tick later still when
+ *          the time-outs of many timers are handled together.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "sdk_check.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "host_rtc.h"
+
+#define TIMER_COUNT           1000                                                                  /**< Number of timers. */
+#define OP_QUEUE_SIZE         32                                                                    /**< Size of the timer operation queues. */
+#ifdef APP_TIMER_WITH_WHEEL
+#define MAX_LATE_TICKS        3                                                                     /**< Largest number of ticks a timer may expire after it is due. */
+#else
+#define MAX_LATE_TICKS        4                                                                     /**< Largest number of ticks a timer may expire after it is due. */
+#endif // APP_TIMER_WITH_WHEEL
+#define MAX_ERRORS_PRINTED    10                                                                    /**< Number of errors printed, further errors are only counted. */
+
+static uint32_t       m_buffer[CEIL_DIV(APP_TIMER_BUF_SIZE(OP_QUEUE_SIZE + 1), sizeof(uint32_t))];
+static app_timer_t    m_timer_data[TIMER_COUNT];
+static app_timer_id_t m_timers[TIMER_COUNT];
+
+static uint64_t m_now;                                                                              /**< Ticks since the start of the test. */
+static uint32_t m_seed;                                                                             /**< State of the pseudo random number generator. */
+static bool     m_restart_from_handler;                                                             /**< True if time-out handlers restart other timers. */
+
+static bool     m_running[TIMER_COUNT];                                                             /**< True if the timer is expected to be running. */
+static uint64_t m_due[TIMER_COUNT];                                                                 /**< Tick the next time-out of the timer is due at. */
+static bool     m_periodic[TIMER_COUNT];                                                            /**< True if the timer is periodic. */
+static uint32_t m_period[TIMER_COUNT];                                                              /**< Period of the timer. */
+
+static uint32_t m_expired_count;                                                                    /**< Number of time-outs. */
+static uint32_t m_error_count;                                                                      /**< Number of time-outs that were not due. */
+static uint64_t m_last_due;                                                                         /**< Tick the previous time-out was due at. */
+static uint32_t m_order_error_count;                                                                /**< Number of time-outs due before the previous time-out. */
+
+
+static uint32_t rand_get(void)
+{
+    // xorshift32.
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    return m_seed;
+}
+
+
+static void error_report(uint32_t index, const char * p_error)
+{
+    if (m_error_count++ < MAX_ERRORS_PRINTED)
+    {
+        printf("tick %llu: timer %u %s, due at %llu\n",
+               (unsigned long long)m_now,
+               (unsigned int)index,
+               p_error,
+               (unsigned long long)m_due[index]);
+    }
+}
+
+
+static uint32_t timer_start(uint32_t index, uint32_t timeout)
+{
+    uint32_t err_code = app_timer_start(m_timers[index], timeout, (void *)(uintptr_t)index);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        m_running[index] = true;
+        m_due[index]     = m_now + timeout;
+        m_period[index]  = timeout;
+    }
+
+    return err_code;
+}
+
+
+static void timer_stop(uint32_t index)
+{
+    ck_assert_uint_eq(app_timer_stop(m_timers[index]), NRF_SUCCESS);
+    m_running[index] = false;
+}
+
+
+static void timeout_handler(void * p_context)
+{
+    uint32_t index = (uint32_t)(uintptr_t)p_context;
+
+    m_expired_count++;
+
+    if (!m_running[index])
+    {
+        error_report(index, "expired while stopped");
+        return;
+    }
+
+    if ((m_now < m_due[index]) || (m_now > m_due[index] + MAX_LATE_TICKS))
+    {
+        error_report(index, "expired");
+    }
+
+    if (m_due[index] < m_last_due)
+    {
+        m_order_error_count++;
+    }
+
+    m_last_due = m_due[index];
+
+    if (m_periodic[index])
+    {
+        m_due[index] += m_period[index];
+    }
+    else
+    {
+        m_running[index] = false;
+    }
+
+    if (m_restart_from_handler && ((rand_get() % 4) == 0))
+    {
+        uint32_t other = rand_get() % TIMER_COUNT;
+
+        if (!m_running[other])
+        {
+            // The operation queue of the interrupt level may be full, the timer is not started then.
+            (void)timer_start(other, APP_TIMER_MIN_TIMEOUT_TICKS + (rand_get() % 1000));
+        }
+    }
+}
+
+
+static void ticks_run(uint64_t ticks)
+{
+    for (uint64_t i = 0; i < ticks; i++)
+    {
+        m_now++;
+        host_rtc1_tick();
+    }
+}
+
+
+static void timers_create(uint32_t periodic_divisor)
+{
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        bool periodic = (periodic_divisor != 0) && ((i % periodic_divisor) == 0);
+
+        m_timers[i]   = &m_timer_data[i];
+        m_periodic[i] = periodic;
+        ck_assert_uint_eq(app_timer_create(&m_timers[i],
+                                           periodic ? APP_TIMER_MODE_REPEATED
+                                                    : APP_TIMER_MODE_SINGLE_SHOT,
+                                           timeout_handler),
+                          NRF_SUCCESS);
+    }
+}
+
+
+static uint32_t missed_count_get(void)
+{
+    uint32_t missed = 0;
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        if (m_running[i] && (m_due[i] + MAX_LATE_TICKS < m_now))
+        {
+            error_report(i, "missed");
+            missed++;
+        }
+    }
+
+    return missed;
+}
+
+
+static void setup(void)
+{
+    memset(m_running, 0, sizeof(m_running));
+    memset(m_periodic, 0, sizeof(m_periodic));
+    memset(m_timer_data, 0, sizeof(m_timer_data));
+
+    m_now                  = 0;
+    m_seed                 = 1;
+    m_restart_from_handler = false;
+    m_expired_count        = 0;
+    m_error_count          = 0;
+    m_last_due             = 0;
+    m_order_error_count    = 0;
+
+    host_rtc1_reset();
+    ck_assert_uint_eq(app_timer_init(0, OP_QUEUE_SIZE + 1, m_buffer, NULL), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+    ck_assert_uint_eq(host_critical_region_nesting, 0);
+}
+
+
+START_TEST(test_expiry_order)
+{
+    timers_create(0);
+
+    // Time-outs from a few ticks to more than a 24-bit counter period, started in random order.
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        uint32_t timeout = APP_TIMER_MIN_TIMEOUT_TICKS + (rand_get() % ((i % 2) ? 5000 : 0xFFFF00));
+
+        ck_assert_uint_eq(timer_start(i, timeout), NRF_SUCCESS);
+        host_irq_handle();
+    }
+
+    ticks_run(0x1000000);
+
+    ck_assert_uint_eq(m_expired_count, TIMER_COUNT);
+    ck_assert_uint_eq(m_error_count, 0);
+    ck_assert_uint_eq(m_order_error_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_periodic_and_stop)
+{
+    timers_create(1);
+
+    ck_assert_uint_eq(timer_start(0, 10), NRF_SUCCESS);
+    ck_assert_uint_eq(timer_start(1, 33), NRF_SUCCESS);
+    ck_assert_uint_eq(timer_start(2, 1000), NRF_SUCCESS);
+    host_irq_handle();
+
+    ticks_run(995);
+    ck_assert_uint_eq(m_expired_count, 99 + 30);
+
+    // A stopped timer does not expire, and may be started again.
+    timer_stop(2);
+    host_irq_handle();
+    ticks_run(10);
+    ck_assert_uint_eq(m_expired_count, 100 + 30);
+
+    ck_assert_uint_eq(timer_start(2, 5), NRF_SUCCESS);
+    host_irq_handle();
+
+    // Stop all running timers.
+    ck_assert_uint_eq(app_timer_stop_all(), NRF_SUCCESS);
+    host_irq_handle();
+    m_running[0] = false;
+    m_running[1] = false;
+    m_running[2] = false;
+
+    ticks_run(2000);
+    ck_assert_uint_eq(m_expired_count, 100 + 30);
+    ck_assert_uint_eq(m_error_count, 0);
+}
+END_TEST
+
+
+START_TEST(test_churn)
+{
+    const uint64_t duration = 0x1200000;
+
+    // A third of the timers are periodic. Timers are started, stopped and restarted at random from
+    // thread mode, and started from time-out handlers.
+    timers_create(3);
+    m_restart_from_handler = true;
+
+    while (m_now < duration)
+    {
+        ticks_run(1 + (rand_get() % 64));
+
+        uint32_t index = rand_get() % TIMER_COUNT;
+
+        if (m_running[index])
+        {
+            timer_stop(index);
+
+            if ((rand_get() % 2) == 0)
+            {
+                host_irq_handle();
+                continue;
+            }
+        }
+
+        uint32_t range;
+
+        switch (rand_get() % 4)
+        {
+            case 0:
+                range = 64;
+                break;
+
+            case 1:
+            case 2:
+                range = 50000;
+                break;
+
+            default:
+                range = 2000000;
+                break;
+        }
+
+        ck_assert_uint_eq(timer_start(index, APP_TIMER_MIN_TIMEOUT_TICKS + (rand_get() % range)),
+                          NRF_SUCCESS);
+        host_irq_handle();
+    }
+
+    printf("churn: %u time-outs in %llu ticks\n",
+           (unsigned int)m_expired_count,
+           (unsigned long long)m_now);
+
+    ck_assert_uint_gt(m_expired_count, 100000);
+    ck_assert_uint_eq(missed_count_get(), 0);
+    ck_assert_uint_eq(m_error_count, 0);
+}
+END_TEST
+
+
+static Suite * app_timer_suite(void)
+{
+    Suite * p_suite = suite_create("app_timer");
+    TCase * p_case  = tcase_create("app_timer");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_set_timeout(p_case, 60);
+    tcase_add_test(p_case, test_expiry_order);
+    tcase_add_test(p_case, test_periodic_and_stop);
+    tcase_add_test(p_case, test_churn);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(app_timer_suite());
+}
@@ -0,0 +1,417 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/** @file
+ *
+ * @brief Unit tests of the socket table of udp6.
+ *
+ * @details Datagrams are fed to udp_input directly, and the socket they are delivered to is
+ *          checked. The tests cover allocation from the free list and the reuse of freed sockets,
+ *          binding, the removal of a freed or rebound socket from its port hash bucket, sockets
+ *          whose ports share a bucket, and the receive statistics. The IPv6 layer is not linked,
+ *          udp6 only calls it to send.
+ */
+
+#include <string.h>
+#include "sdk_check.h"
+#include "iot_errors.h"
+#include "ipv6_api.h"
+#include "udp_api.h"
+#include "udp.h"
+#include "ipv6_utils.h"
+
+#define UDP_HEADER_SIZE       8                                                                     /**< Size of the UDP header. */
+#define PAYLOAD_SIZE          16                                                                    /**< Size of the payload of the datagrams. */
+#define PEER_PORT             40000                                                                 /**< Source port of the datagrams. */
+#define BUCKET_STRIDE         0x0800                                                                /**< Distance between ports hashed to the same bucket, for up to 8 buckets. */
+
+static const ipv6_addr_t m_local_addr = {{0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01}};
+static const ipv6_addr_t m_peer_addr  = {{0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02}};
+static const ipv6_addr_t m_other_addr = {{0xFE, 0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x03}};
+
+ipv6_addr_t              ipv6_addr_any;                                                             /**< Unspecified address, defined by the IPv6 layer. */
+
+static iot_interface_t   m_interface;
+static uint32_t          m_rx_count;                                                                /**< Number of datagrams given to the receive callback. */
+static uint32_t          m_rx_socket_id;                                                            /**< Socket of the last datagram given to the receive callback. */
+static uint32_t          m_rx_result;                                                               /**< Process result of the last datagram given to the receive callback. */
+static uint32_t          m_rx_length;                                                               /**< Payload length of the last datagram given to the receive callback. */
+
+
+uint32_t ipv6_address_find_best_match(iot_interface_t     ** pp_interface,
+                                      ipv6_addr_t          * p_addr_r,
+                                      const ipv6_addr_t    * p_addr_f)
+{
+    return NRF_ERROR_NOT_FOUND;
+}
+
+
+uint32_t ipv6_send(const iot_interface_t * p_interface, iot_pbuffer_t * p_packet)
+{
+    return NRF_ERROR_NOT_SUPPORTED;
+}
+
+
+static uint32_t rx_handler(const udp6_socket_t * p_socket,
+                           const ipv6_header_t * p_ip_header,
+                           const udp6_header_t * p_udp_header,
+                           uint32_t              process_result,
+                           iot_pbuffer_t       * p_rx_packet)
+{
+    m_rx_count++;
+    m_rx_socket_id = p_socket->socket_id;
+    m_rx_result    = process_result;
+    m_rx_length    = p_rx_packet->length;
+
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Feed a datagram from the peer to udp_input.
+ *
+ * @param[in] p_dest_addr Destination address of the datagram.
+ * @param[in] src_port    Source port, in host byte order.
+ * @param[in] dest_port   Destination port, in host byte order.
+ * @param[in] valid       Give the datagram a valid checksum, else a wrong one.
+ *
+ * @retval Result of udp_input.
+ */
+static uint32_t datagram_input(const ipv6_addr_t * p_dest_addr,
+                               uint16_t            src_port,
+                               uint16_t            dest_port,
+                               bool                valid)
+{
+    uint8_t         datagram[UDP_HEADER_SIZE + PAYLOAD_SIZE];
+    udp6_header_t * p_udp_header = (udp6_header_t *)datagram;
+    ipv6_header_t   ip_header;
+    iot_pbuffer_t   packet;
+    uint16_t        checksum     = sizeof(datagram) + IPV6_NEXT_HEADER_UDP;
+
+    memset(&ip_header, 0, sizeof(ip_header));
+    ip_header.length      = HTONS(sizeof(datagram));
+    ip_header.next_header = IPV6_NEXT_HEADER_UDP;
+    ip_header.srcaddr     = m_peer_addr;
+    ip_header.destaddr    = (*p_dest_addr);
+
+    for (uint32_t i = 0; i < PAYLOAD_SIZE; i++)
+    {
+        datagram[UDP_HEADER_SIZE + i] = (uint8_t)(i + dest_port);
+    }
+
+    p_udp_header->srcport  = HTONS(src_port);
+    p_udp_header->destport = HTONS(dest_port);
+    p_udp_header->length   = HTONS(sizeof(datagram));
+    p_udp_header->checksum = 0;
+
+    ipv6_checksum_calculate(ip_header.srcaddr.u8, IPV6_ADDR_SIZE, &checksum, false);
+    ipv6_checksum_calculate(ip_header.destaddr.u8, IPV6_ADDR_SIZE, &checksum, false);
+    ipv6_checksum_calculate(datagram, sizeof(datagram), &checksum, true);
+
+    p_udp_header->checksum = HTONS((uint16_t)(valid ? ~checksum : checksum));
+
+    packet.type      = UDP6_PACKET_TYPE;
+    packet.p_memory  = datagram;
+    packet.p_payload = datagram;
+    packet.length    = sizeof(datagram);
+
+    return udp_input(&m_interface, &ip_header, &packet);
+}
+
+
+/**@brief Check that a datagram to a port is given to a socket, or to none. */
+static void delivery_check(uint16_t dest_port, const udp6_socket_t * p_socket)
+{
+    const uint32_t rx_count = m_rx_count;
+    const uint32_t err_code = datagram_input(&m_local_addr, PEER_PORT, dest_port, true);
+
+    if (p_socket != NULL)
+    {
+        ck_assert_uint_eq(err_code, NRF_SUCCESS);
+        ck_assert_uint_eq(m_rx_count, rx_count + 1);
+        ck_assert_uint_eq(m_rx_socket_id, p_socket->socket_id);
+        ck_assert_uint_eq(m_rx_result, NRF_SUCCESS);
+        ck_assert_uint_eq(m_rx_length, PAYLOAD_SIZE);
+    }
+    else
+    {
+        ck_assert_uint_eq(err_code, (NRF_ERROR_NOT_FOUND | IOT_UDP6_ERR_BASE));
+        ck_assert_uint_eq(m_rx_count, rx_count);
+    }
+}
+
+
+/**@brief Allocate a socket, bind it to a port of any local address and receive on it. */
+static void socket_open(udp6_socket_t * p_socket, uint16_t port)
+{
+    ck_assert_uint_eq(udp6_socket_allocate(p_socket), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_bind(p_socket, IPV6_ADDR_ANY, port), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_recv(p_socket, rx_handler), NRF_SUCCESS);
+}
+
+
+static void setup(void)
+{
+    m_rx_count     = 0;
+    m_rx_socket_id = UDP6_MAX_SOCKET_COUNT;
+    m_rx_result    = NRF_SUCCESS;
+    m_rx_length    = 0;
+
+    ck_assert_uint_eq(udp_init(), NRF_SUCCESS);
+}
+
+
+static void teardown(void)
+{
+}
+
+
+START_TEST(test_allocate_free_reuse)
+{
+    udp6_socket_t sockets[UDP6_MAX_SOCKET_COUNT];
+    udp6_socket_t socket;
+    bool          taken[UDP6_MAX_SOCKET_COUNT];
+
+    memset(taken, 0, sizeof(taken));
+
+    // Each socket is handed out once, bound or not.
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i++)
+    {
+        ck_assert_uint_eq(udp6_socket_allocate(&sockets[i]), NRF_SUCCESS);
+        ck_assert_uint_lt(sockets[i].socket_id, UDP6_MAX_SOCKET_COUNT);
+        ck_assert(!taken[sockets[i].socket_id]);
+
+        taken[sockets[i].socket_id] = true;
+    }
+
+    ck_assert_uint_eq(udp6_socket_allocate(&socket), (NRF_ERROR_NO_MEM | IOT_UDP6_ERR_BASE));
+
+    // A freed socket is the next one handed out, and freeing it twice does not add it twice.
+    ck_assert_uint_eq(udp6_socket_free(&sockets[3]), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_free(&sockets[3]), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_allocate(&socket), NRF_SUCCESS);
+    ck_assert_uint_eq(socket.socket_id, sockets[3].socket_id);
+    ck_assert_uint_eq(udp6_socket_allocate(&socket), (NRF_ERROR_NO_MEM | IOT_UDP6_ERR_BASE));
+
+    // Sockets freed in any order are all handed out again.
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i += 2)
+    {
+        ck_assert_uint_eq(udp6_socket_free(&sockets[i]), NRF_SUCCESS);
+        taken[sockets[i].socket_id] = false;
+    }
+
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i += 2)
+    {
+        ck_assert_uint_eq(udp6_socket_allocate(&socket), NRF_SUCCESS);
+        ck_assert(!taken[socket.socket_id]);
+
+        taken[socket.socket_id] = true;
+    }
+
+    ck_assert_uint_eq(udp6_socket_allocate(&socket), (NRF_ERROR_NO_MEM | IOT_UDP6_ERR_BASE));
+}
+END_TEST
+
+
+START_TEST(test_bind)
+{
+    udp6_socket_t first;
+    udp6_socket_t second;
+    udp6_socket_t unallocated;
+
+    socket_open(&first, 5683);
+    ck_assert_uint_eq(udp6_socket_allocate(&second), NRF_SUCCESS);
+
+    // A port is bound by one socket only.
+    ck_assert_uint_eq(udp6_socket_bind(&second, IPV6_ADDR_ANY, 5683), UDP_PORT_IN_USE);
+    ck_assert_uint_eq(udp6_socket_bind(&second, &m_local_addr, 5683), UDP_PORT_IN_USE);
+    ck_assert_uint_eq(udp6_socket_bind(&second, &m_local_addr, 5684), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_recv(&second, rx_handler), NRF_SUCCESS);
+
+    delivery_check(5683, &first);
+    delivery_check(5684, &second);
+    delivery_check(5685, NULL);
+
+    // A socket bound to a local address only receives datagrams to that address.
+    ck_assert_uint_eq(datagram_input(&m_other_addr, PEER_PORT, 5684, true),
+                      (NRF_ERROR_NOT_FOUND | IOT_UDP6_ERR_BASE));
+
+    // Rebinding moves the socket to its new port.
+    ck_assert_uint_eq(udp6_socket_bind(&first, IPV6_ADDR_ANY, 5685), NRF_SUCCESS);
+
+    delivery_check(5683, NULL);
+    delivery_check(5685, &first);
+
+    // A socket that is not allocated cannot be bound.
+    ck_assert_uint_eq(udp6_socket_allocate(&unallocated), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_free(&unallocated), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_bind(&unallocated, IPV6_ADDR_ANY, 5686),
+                      (NRF_ERROR_INVALID_PARAM | IOT_UDP6_ERR_BASE));
+
+    delivery_check(5686, NULL);
+}
+END_TEST
+
+
+START_TEST(test_connect)
+{
+    udp6_socket_t socket;
+
+    socket_open(&socket, 5683);
+    ck_assert_uint_eq(udp6_socket_connect(&socket, &m_peer_addr, PEER_PORT), NRF_SUCCESS);
+
+    // A connected socket only receives datagrams from its remote port.
+    delivery_check(5683, &socket);
+
+    ck_assert_uint_eq(datagram_input(&m_local_addr, PEER_PORT + 1, 5683, true),
+                      (NRF_ERROR_NOT_FOUND | IOT_UDP6_ERR_BASE));
+    ck_assert_uint_eq(m_rx_count, 1);
+}
+END_TEST
+
+
+START_TEST(test_free_unlinks)
+{
+    udp6_socket_t sockets[3];
+    udp6_socket_t socket;
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        socket_open(&sockets[i], (uint16_t)(5683 + i * BUCKET_STRIDE));
+    }
+
+    // Freeing a socket removes it from its bucket, first, middle or last.
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const uint32_t freed = (i + 1) % 3;
+
+        ck_assert_uint_eq(udp6_socket_free(&sockets[freed]), NRF_SUCCESS);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            delivery_check((uint16_t)(5683 + j * BUCKET_STRIDE), (j == freed) ? NULL : &sockets[j]);
+        }
+
+        // The port can be bound again, by the socket handed out next.
+        socket_open(&socket, (uint16_t)(5683 + freed * BUCKET_STRIDE));
+        ck_assert_uint_eq(socket.socket_id, sockets[freed].socket_id);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            delivery_check((uint16_t)(5683 + j * BUCKET_STRIDE), &sockets[j]);
+        }
+    }
+
+    // A socket that is allocated but not bound is freed without touching any bucket.
+    ck_assert_uint_eq(udp6_socket_allocate(&socket), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_free(&socket), NRF_SUCCESS);
+
+    for (uint32_t j = 0; j < 3; j++)
+    {
+        delivery_check((uint16_t)(5683 + j * BUCKET_STRIDE), &sockets[j]);
+    }
+}
+END_TEST
+
+
+START_TEST(test_port_hash_collisions)
+{
+    udp6_socket_t sockets[UDP6_MAX_SOCKET_COUNT];
+
+    // Every socket bound to a port of the same bucket, in both byte orders of the port.
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i++)
+    {
+        const uint16_t port = (uint16_t)((i % 2) ? (0x0033 + i * BUCKET_STRIDE) :
+                                                   (0x3300 + (i / 2) * (BUCKET_STRIDE >> 8)));
+
+        socket_open(&sockets[i], port);
+    }
+
+    for (uint32_t i = 0; i < UDP6_MAX_SOCKET_COUNT; i++)
+    {
+        const uint16_t port = (uint16_t)((i % 2) ? (0x0033 + i * BUCKET_STRIDE) :
+                                                   (0x3300 + (i / 2) * (BUCKET_STRIDE >> 8)));
+
+        delivery_check(port, &sockets[i]);
+    }
+
+    // Other ports of the bucket are not delivered.
+    delivery_check(0x0033 + 2 * BUCKET_STRIDE, NULL);
+    delivery_check(0x3340, NULL);
+}
+END_TEST
+
+
+START_TEST(test_stats)
+{
+    udp6_socket_t       socket;
+    udp6_socket_t       silent;
+    udp6_socket_stats_t stats;
+
+    socket_open(&socket, 5683);
+    ck_assert_uint_eq(udp6_socket_allocate(&silent), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_bind(&silent, IPV6_ADDR_ANY, 5684), NRF_SUCCESS);
+
+    delivery_check(5683, &socket);
+    delivery_check(5683, &socket);
+
+    // A datagram with a bad checksum is given to the application, with the error.
+    ck_assert_uint_eq(datagram_input(&m_local_addr, PEER_PORT, 5683, false), NRF_SUCCESS);
+    ck_assert_uint_eq(m_rx_result, UDP_BAD_CHECKSUM);
+
+    // A datagram to a socket without a receive callback is dropped.
+    ck_assert_uint_eq(datagram_input(&m_local_addr, PEER_PORT, 5684, true), NRF_SUCCESS);
+    ck_assert_uint_eq(m_rx_count, 3);
+
+    ck_assert_uint_eq(udp6_socket_stats_get(&socket, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.rx_packets, 3);
+    ck_assert_uint_eq(stats.rx_bytes, 3 * PAYLOAD_SIZE);
+    ck_assert_uint_eq(stats.rx_errors, 1);
+    ck_assert_uint_eq(stats.rx_dropped, 0);
+
+    ck_assert_uint_eq(udp6_socket_stats_get(&silent, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.rx_packets, 1);
+    ck_assert_uint_eq(stats.rx_bytes, PAYLOAD_SIZE);
+    ck_assert_uint_eq(stats.rx_errors, 0);
+    ck_assert_uint_eq(stats.rx_dropped, 1);
+
+    // The counters are cleared when the socket is freed.
+    ck_assert_uint_eq(udp6_socket_free(&socket), NRF_SUCCESS);
+    ck_assert_uint_eq(udp6_socket_stats_get(&socket, &stats), NRF_SUCCESS);
+    ck_assert_uint_eq(stats.rx_packets, 0);
+    ck_assert_uint_eq(stats.rx_bytes, 0);
+    ck_assert_uint_eq(stats.rx_errors, 0);
+}
+END_TEST
+
+
+static Suite * udp6_suite(void)
+{
+    Suite * p_suite = suite_create("udp6");
+    TCase * p_case  = tcase_create("udp6");
+
+    tcase_add_checked_fixture(p_case, setup, teardown);
+    tcase_add_test(p_case, test_allocate_free_reuse);
+    tcase_add_test(p_case, test_bind);
+    tcase_add_test(p_case, test_connect);
+    tcase_add_test(p_case, test_free_unlinks);
+    tcase_add_test(p_case, test_port_hash_collisions);
+    tcase_add_test(p_case, test_stats);
+    suite_add_tcase(p_suite, p_case);
+
+    return p_suite;
+}
+
+
+int main(void)
+{
+    return sdk_check_run(udp6_suite());
+}